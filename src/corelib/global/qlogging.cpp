@@ -45,6 +45,7 @@
 #include "qbytearray.h"
 #include "qstring.h"
 #include "qvarlengtharray.h"
+#include "qvector.h"
 #include "qdebug.h"
 #include "qmutex.h"
 #include "qloggingcategory.h"
@@ -53,6 +54,7 @@
 #include "qdatetime.h"
 #include "qcoreapplication.h"
 #include "qthread.h"
+#include "qwaitcondition.h"
 #include "private/qloggingregistry_p.h"
 #include "private/qcoreapplication_p.h"
 #include "private/qsimd_p.h"
@@ -142,7 +144,9 @@ static QT_PREPEND_NAMESPACE(qint64) qt_gettid()
 #endif // !QT_BOOTSTRAPPED
 
 #include <cstdlib>
+#include <utility>
 
+#include <limits.h>
 #include <stdio.h>
 
 QT_BEGIN_NAMESPACE
@@ -992,7 +996,6 @@ static const char ifWarningTokenC[] = "%{if-warning}";
 static const char ifCriticalTokenC[] = "%{if-critical}";
 static const char ifFatalTokenC[] = "%{if-fatal}";
 static const char endifTokenC[] = "%{endif}";
-static const char emptyTokenC[] = "";
 
 static const char defaultPattern[] = "%{if-category}%{category}: %{endif}%{message}";
 
@@ -1003,19 +1006,56 @@ struct QMessagePattern {
 
     void setPattern(const QString &pattern);
 
-    // 0 terminated arrays of literal tokens / literal or placeholder tokens
-    const char **literals;
-    const char **tokens;
-    QList<QString> timeArgs;   // timeFormats in sequence of %{time
-#ifndef QT_BOOTSTRAPPED
-    QElapsedTimer timer;
-#endif
 #ifdef QLOGGING_HAVE_BACKTRACE
     struct BacktraceParams {
         QString backtraceSeparator;
         int backtraceDepth;
     };
-    QVector<BacktraceParams> backtraceArgs; // backtrace argumens in sequence of %{backtrace
+#endif
+
+    // The pattern is compiled once into a list of instructions, so that
+    // formatting a message neither compares tokens nor takes the mutex.
+    struct Instruction {
+        enum Op {
+            Literal,        // arg: index into literals
+            Message,
+            Category,
+            Type,
+            File,
+            Line,
+            Function,
+            Pid,
+            AppName,
+            ThreadId,
+            QThreadPtr,
+            TimeProcess,
+            TimeBoot,
+            TimeDate,       // arg: index of the format in literals, or -1 for Qt::ISODate
+            Backtrace,      // arg: index into backtraceArgs
+            IfCategory,     // next: the instruction following the matching %{endif}
+            IfType,         // arg: the QtMsgType, next: as for IfCategory
+            EndIf
+        };
+        Op op;
+        int arg;
+        int next;
+    };
+
+    struct Program {
+        QVector<Instruction> instructions;
+        QVector<QString> literals;
+#ifdef QLOGGING_HAVE_BACKTRACE
+        QVector<BacktraceParams> backtraceArgs; // backtrace arguments in sequence of %{backtrace
+#endif
+    };
+
+    QAtomicPointer<const Program> program;
+    // programs replaced by setPattern() are kept while other threads may
+    // still be formatting a message with them
+    QVector<const Program *> oldPrograms;
+    QAtomicInt formatting;      // number of qFormatLogMessage() calls in progress
+#ifndef QT_BOOTSTRAPPED
+    QElapsedTimer timer;
 #endif
 
     bool fromEnvironment;
@@ -1024,13 +1064,12 @@ struct QMessagePattern {
 #ifdef QLOGGING_HAVE_BACKTRACE
 Q_DECLARE_TYPEINFO(QMessagePattern::BacktraceParams, Q_MOVABLE_TYPE);
 #endif
+Q_DECLARE_TYPEINFO(QMessagePattern::Instruction, Q_PRIMITIVE_TYPE);
 
 QBasicMutex QMessagePattern::mutex;
 
 QMessagePattern::QMessagePattern()
-    : literals(0)
-    , tokens(0)
-    , fromEnvironment(false)
+    : fromEnvironment(false)
 {
 #ifndef QT_BOOTSTRAPPED
     timer.start();
@@ -1046,27 +1085,12 @@ QMessagePattern::QMessagePattern()
 
 QMessagePattern::~QMessagePattern()
 {
-    for (int i = 0; literals[i]; ++i)
-        delete [] literals[i];
-    delete [] literals;
-    literals = 0;
-    delete [] tokens;
-    tokens = 0;
+    delete program.load();
+    qDeleteAll(oldPrograms);
 }
 
 void QMessagePattern::setPattern(const QString &pattern)
 {
-    if (literals) {
-        for (int i = 0; literals[i]; ++i)
-            delete [] literals[i];
-        delete [] literals;
-    }
-    delete [] tokens;
-    timeArgs.clear();
-#ifdef QLOGGING_HAVE_BACKTRACE
-    backtraceArgs.clear();
-#endif
-
     // scanner
     QList<QString> lexemes;
     QString lexeme;
@@ -1098,50 +1122,62 @@ void QMessagePattern::setPattern(const QString &pattern)
     if (!lexeme.isEmpty())
         lexemes.append(lexeme);
 
-    // tokenizer
-    QVarLengthArray<const char*> literalsVar;
-    tokens = new const char*[lexemes.size() + 1];
-    tokens[lexemes.size()] = 0;
+    // compiler
+    Program *compiled = new Program;
+    QVector<Instruction> &instructions = compiled->instructions;
+    instructions.reserve(lexemes.size());
 
     bool nestedIfError = false;
-    bool inIf = false;
+    int ifIndex = -1;
     QString error;
 
+    const auto addInstruction = [&instructions](Instruction::Op op, int arg = 0) {
+        const Instruction instruction = { op, arg, 0 };
+        instructions.append(instruction);
+    };
+
     for (int i = 0; i < lexemes.size(); ++i) {
         const QString lexeme = lexemes.at(i);
         if (lexeme.startsWith(QLatin1String("%{"))
                 && lexeme.endsWith(QLatin1Char('}'))) {
             // placeholder
             if (lexeme == QLatin1String(typeTokenC)) {
-                tokens[i] = typeTokenC;
+                addInstruction(Instruction::Type);
             } else if (lexeme == QLatin1String(categoryTokenC))
-                tokens[i] = categoryTokenC;
+                addInstruction(Instruction::Category);
             else if (lexeme == QLatin1String(messageTokenC))
-                tokens[i] = messageTokenC;
+                addInstruction(Instruction::Message);
             else if (lexeme == QLatin1String(fileTokenC))
-                tokens[i] = fileTokenC;
+                addInstruction(Instruction::File);
             else if (lexeme == QLatin1String(lineTokenC))
-                tokens[i] = lineTokenC;
+                addInstruction(Instruction::Line);
             else if (lexeme == QLatin1String(functionTokenC))
-                tokens[i] = functionTokenC;
+                addInstruction(Instruction::Function);
             else if (lexeme == QLatin1String(pidTokenC))
-                tokens[i] = pidTokenC;
+                addInstruction(Instruction::Pid);
             else if (lexeme == QLatin1String(appnameTokenC))
-                tokens[i] = appnameTokenC;
+                addInstruction(Instruction::AppName);
             else if (lexeme == QLatin1String(threadidTokenC))
-                tokens[i] = threadidTokenC;
+                addInstruction(Instruction::ThreadId);
             else if (lexeme == QLatin1String(qthreadptrTokenC))
-                tokens[i] = qthreadptrTokenC;
+                addInstruction(Instruction::QThreadPtr);
             else if (lexeme.startsWith(QLatin1String(timeTokenC))) {
-                tokens[i] = timeTokenC;
                 int spaceIdx = lexeme.indexOf(QChar::fromLatin1(' '));
-                if (spaceIdx > 0)
-                    timeArgs.append(lexeme.mid(spaceIdx + 1, lexeme.length() - spaceIdx - 2));
-                else
-                    timeArgs.append(QString());
+                const QString timeFormat = spaceIdx > 0
+                        ? lexeme.mid(spaceIdx + 1, lexeme.length() - spaceIdx - 2)
+                        : QString();
+                if (timeFormat == QLatin1String("process")) {
+                    addInstruction(Instruction::TimeProcess);
+                } else if (timeFormat == QLatin1String("boot")) {
+                    addInstruction(Instruction::TimeBoot);
+                } else if (timeFormat.isEmpty()) {
+                    addInstruction(Instruction::TimeDate, -1);
+                } else {
+                    addInstruction(Instruction::TimeDate, compiled->literals.size());
+                    compiled->literals.append(timeFormat);
+                }
             } else if (lexeme.startsWith(QLatin1String(backtraceTokenC))) {
 #ifdef QLOGGING_HAVE_BACKTRACE
-                tokens[i] = backtraceTokenC;
                 QString backtraceSeparator = QStringLiteral("|");
                 int backtraceDepth = 5;
                 QRegularExpression depthRx(QStringLiteral(" depth=(?|\"([^\"]*)\"|([^ }]*))"));
@@ -1160,49 +1196,57 @@ void QMessagePattern::setPattern(const QString &pattern)
                 BacktraceParams backtraceParams;
                 backtraceParams.backtraceDepth = backtraceDepth;
                 backtraceParams.backtraceSeparator = backtraceSeparator;
-                backtraceArgs.append(backtraceParams);
+                addInstruction(Instruction::Backtrace, compiled->backtraceArgs.size());
+                compiled->backtraceArgs.append(backtraceParams);
 #else
                 error += QLatin1String("QT_MESSAGE_PATTERN: %{backtrace} is not supported by this Qt build\n");
-                tokens[i] = "";
 #endif
             }
 
-#define IF_TOKEN(LEVEL) \
+#define IF_TOKEN(LEVEL, OP, TYPE) \
             else if (lexeme == QLatin1String(LEVEL)) { \
-                if (inIf) \
+                if (ifIndex >= 0) \
                     nestedIfError = true; \
-                tokens[i] = LEVEL; \
-                inIf = true; \
+                ifIndex = instructions.size(); \
+                addInstruction(OP, TYPE); \
             }
-            IF_TOKEN(ifCategoryTokenC)
-            IF_TOKEN(ifDebugTokenC)
-            IF_TOKEN(ifInfoTokenC)
-            IF_TOKEN(ifWarningTokenC)
-            IF_TOKEN(ifCriticalTokenC)
-            IF_TOKEN(ifFatalTokenC)
+            IF_TOKEN(ifCategoryTokenC, Instruction::IfCategory, 0)
+            IF_TOKEN(ifDebugTokenC, Instruction::IfType, QtDebugMsg)
+            IF_TOKEN(ifInfoTokenC, Instruction::IfType, QtInfoMsg)
+            IF_TOKEN(ifWarningTokenC, Instruction::IfType, QtWarningMsg)
+            IF_TOKEN(ifCriticalTokenC, Instruction::IfType, QtCriticalMsg)
+            IF_TOKEN(ifFatalTokenC, Instruction::IfType, QtFatalMsg)
 #undef IF_TOKEN
             else if (lexeme == QLatin1String(endifTokenC)) {
-                tokens[i] = endifTokenC;
-                if (!inIf && !nestedIfError)
+                addInstruction(Instruction::EndIf);
+                if (ifIndex < 0 && !nestedIfError)
                     error += QLatin1String("QT_MESSAGE_PATTERN: %{endif} without an %{if-*}\n");
-                inIf = false;
+                ifIndex = -1;
             } else {
-                tokens[i] = emptyTokenC;
                 error += QStringLiteral("QT_MESSAGE_PATTERN: Unknown placeholder %1\n")
                         .arg(lexeme);
             }
         } else {
-            char *literal = new char[lexeme.size() + 1];
-            strncpy(literal, lexeme.toLatin1().constData(), lexeme.size());
-            literal[lexeme.size()] = '\0';
-            literalsVar.append(literal);
-            tokens[i] = literal;
+            addInstruction(Instruction::Literal, compiled->literals.size());
+            compiled->literals.append(lexeme);
         }
     }
     if (nestedIfError)
         error += QLatin1String("QT_MESSAGE_PATTERN: %{if-*} cannot be nested\n");
-    else if (inIf)
+    else if (ifIndex >= 0)
         error += QLatin1String("QT_MESSAGE_PATTERN: missing %{endif}\n");
+
+    // A condition that does not apply skips everything up to and including
+    // the next %{endif}, including nested conditions.
+    int next = instructions.size();
+    for (int i = instructions.size() - 1; i >= 0; --i) {
+        Instruction &instruction = instructions[i];
+        if (instruction.op == Instruction::EndIf)
+            next = i + 1;
+        else if (instruction.op == Instruction::IfCategory || instruction.op == Instruction::IfType)
+            instruction.next = next;
+    }
+
     if (!error.isEmpty()) {
 #if defined(Q_OS_WINRT)
         OutputDebugString(reinterpret_cast<const wchar_t*>(error.utf16()));
@@ -1217,9 +1261,16 @@ void QMessagePattern::setPattern(const QString &pattern)
             fflush(stderr);
         }
     }
-    literals = new const char*[literalsVar.size() + 1];
-    literals[literalsVar.size()] = 0;
-    memcpy(literals, literalsVar.constData(), literalsVar.size() * sizeof(const char*));
+
+    if (const Program *old = program.fetchAndStoreOrdered(compiled))
+        oldPrograms.append(old);
+    // Without a message being formatted, nobody can see the old programs
+    // any more. Both operations are ordered, so a thread that starts
+    // formatting after this check uses the new program.
+    if (formatting.testAndSetOrdered(0, 0)) {
+        qDeleteAll(oldPrograms);
+        oldPrograms.clear();
+    }
 }
 
 #if defined(QLOGGING_HAVE_BACKTRACE) && !defined(QT_BOOTSTRAPPED)
@@ -1377,8 +1428,6 @@ QString qFormatLogMessage(QtMsgType type, const QMessageLogContext &context, con
 {
     QString message;
 
-    QMutexLocker lock(&QMessagePattern::mutex);
-
     QMessagePattern *pattern = qMessagePattern();
     if (!pattern) {
         // after destruction of static QMessagePattern instance
@@ -1386,36 +1435,26 @@ QString qFormatLogMessage(QtMsgType type, const QMessageLogContext &context, con
         return message;
     }
 
-    bool skip = false;
-
-#ifndef QT_BOOTSTRAPPED
-    int timeArgsIdx = 0;
-#ifdef QLOGGING_HAVE_BACKTRACE
-    int backtraceArgsIdx = 0;
-#endif
-#endif
+    typedef QMessagePattern::Instruction Instruction;
+    pattern->formatting.ref();
+    const QMessagePattern::Program *program = pattern->program.loadAcquire();
+    const Instruction *instructions = program->instructions.constData();
+    const int count = program->instructions.size();
 
     // we do not convert file, function, line literals to local encoding due to overhead
-    for (int i = 0; pattern->tokens[i] != 0; ++i) {
-        const char *token = pattern->tokens[i];
-        if (token == endifTokenC) {
-            skip = false;
-        } else if (skip) {
-            // we skip adding messages, but we have to iterate over
-            // timeArgsIdx and backtraceArgsIdx anyway
-#ifndef QT_BOOTSTRAPPED
-            if (token == timeTokenC)
-                timeArgsIdx++;
-#ifdef QLOGGING_HAVE_BACKTRACE
-            else if (token == backtraceTokenC)
-                backtraceArgsIdx++;
-#endif
-#endif
-        } else if (token == messageTokenC) {
+    for (int i = 0; i < count; ) {
+        const Instruction &instruction = instructions[i++];
+        switch (instruction.op) {
+        case Instruction::Literal:
+            message.append(program->literals.at(instruction.arg));
+            break;
+        case Instruction::Message:
             message.append(str);
-        } else if (token == categoryTokenC) {
+            break;
+        case Instruction::Category:
             message.append(QLatin1String(context.category));
-        } else if (token == typeTokenC) {
+            break;
+        case Instruction::Type:
             switch (type) {
             case QtDebugMsg:   message.append(QLatin1String("debug")); break;
             case QtInfoMsg:    message.append(QLatin1String("info")); break;
@@ -1423,72 +1462,81 @@ QString qFormatLogMessage(QtMsgType type, const QMessageLogContext &context, con
             case QtCriticalMsg:message.append(QLatin1String("critical")); break;
             case QtFatalMsg:   message.append(QLatin1String("fatal")); break;
             }
-        } else if (token == fileTokenC) {
+            break;
+        case Instruction::File:
             if (context.file)
                 message.append(QLatin1String(context.file));
             else
                 message.append(QLatin1String("unknown"));
-        } else if (token == lineTokenC) {
+            break;
+        case Instruction::Line:
             message.append(QString::number(context.line));
-        } else if (token == functionTokenC) {
+            break;
+        case Instruction::Function:
             if (context.function)
                 message.append(QString::fromLatin1(qCleanupFuncinfo(context.function)));
             else
                 message.append(QLatin1String("unknown"));
+            break;
 #ifndef QT_BOOTSTRAPPED
-        } else if (token == pidTokenC) {
+        case Instruction::Pid:
             message.append(QString::number(QCoreApplication::applicationPid()));
-        } else if (token == appnameTokenC) {
+            break;
+        case Instruction::AppName:
             message.append(QCoreApplication::applicationName());
-        } else if (token == threadidTokenC) {
+            break;
+        case Instruction::ThreadId:
             // print the TID as decimal
             message.append(QString::number(qt_gettid()));
-        } else if (token == qthreadptrTokenC) {
+            break;
+        case Instruction::QThreadPtr:
             message.append(QLatin1String("0x"));
             message.append(QString::number(qlonglong(QThread::currentThread()->currentThread()), 16));
+            break;
 #ifdef QLOGGING_HAVE_BACKTRACE
-        } else if (token == backtraceTokenC) {
-            QMessagePattern::BacktraceParams backtraceParams = pattern->backtraceArgs.at(backtraceArgsIdx);
-            backtraceArgsIdx++;
-            message.append(formatBacktraceForLogMessage(backtraceParams, context.function));
+        case Instruction::Backtrace: {
+            QMutexLocker lock(&QMessagePattern::mutex);
+            message.append(formatBacktraceForLogMessage(program->backtraceArgs.at(instruction.arg),
+                                                        context.function));
+            break;
+        }
 #endif
-        } else if (token == timeTokenC) {
-            QString timeFormat = pattern->timeArgs.at(timeArgsIdx);
-            timeArgsIdx++;
-            if (timeFormat == QLatin1String("process")) {
-                    quint64 ms = pattern->timer.elapsed();
-                    message.append(QString::asprintf("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
-            } else if (timeFormat ==  QLatin1String("boot")) {
-                // just print the milliseconds since the elapsed timer reference
-                // like the Linux kernel does
-                QElapsedTimer now;
-                now.start();
-                uint ms = now.msecsSinceReference();
-                message.append(QString::asprintf("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
+        case Instruction::TimeProcess: {
+            quint64 ms = pattern->timer.elapsed();
+            message.append(QString::asprintf("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
+            break;
+        }
+        case Instruction::TimeBoot: {
+            // just print the milliseconds since the elapsed timer reference
+            // like the Linux kernel does
+            QElapsedTimer now;
+            now.start();
+            uint ms = now.msecsSinceReference();
+            message.append(QString::asprintf("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
+            break;
+        }
 #if QT_CONFIG(datestring)
-            } else if (timeFormat.isEmpty()) {
-                    message.append(QDateTime::currentDateTime().toString(Qt::ISODate));
-            } else {
-                message.append(QDateTime::currentDateTime().toString(timeFormat));
+        case Instruction::TimeDate:
+            if (instruction.arg < 0)
+                message.append(QDateTime::currentDateTime().toString(Qt::ISODate));
+            else
+                message.append(QDateTime::currentDateTime().toString(program->literals.at(instruction.arg)));
+            break;
 #endif // QT_CONFIG(datestring)
-            }
 #endif // !QT_BOOTSTRAPPED
-        } else if (token == ifCategoryTokenC) {
+        case Instruction::IfCategory:
             if (!context.category || (strcmp(context.category, "default") == 0))
-                skip = true;
-#define HANDLE_IF_TOKEN(LEVEL)  \
-        } else if (token == if##LEVEL##TokenC) { \
-            skip = type != Qt##LEVEL##Msg;
-        HANDLE_IF_TOKEN(Debug)
-        HANDLE_IF_TOKEN(Info)
-        HANDLE_IF_TOKEN(Warning)
-        HANDLE_IF_TOKEN(Critical)
-        HANDLE_IF_TOKEN(Fatal)
-#undef HANDLE_IF_TOKEN
-        } else {
-            message.append(QLatin1String(token));
+                i = instruction.next;
+            break;
+        case Instruction::IfType:
+            if (type != instruction.arg)
+                i = instruction.next;
+            break;
+        default:
+            break;
         }
     }
+    pattern->formatting.deref();
     return message;
 }
 
@@ -1588,17 +1636,13 @@ static void android_default_message_handler(QtMsgType type,
 
 /*!
     \internal
+
+    Writes the formatted \a logMessage to the console or to the platform's
+    logging facility.
 */
-static void qDefaultMessageHandler(QtMsgType type, const QMessageLogContext &context,
-                                   const QString &buf)
+static void qt_message_write(QtMsgType type, const QMessageLogContext &context,
+                             QString &logMessage)
 {
-    QString logMessage = qFormatLogMessage(type, context, buf);
-
-    // print nothing if message pattern didn't apply / was empty.
-    // (still print empty lines, e.g. because message itself was empty)
-    if (logMessage.isNull())
-        return;
-
     if (!qt_logging_to_console()) {
 #if defined(Q_OS_WIN)
         logMessage.append(QLatin1Char('\n'));
@@ -1619,10 +1663,347 @@ static void qDefaultMessageHandler(QtMsgType type, const QMessageLogContext &con
         return;
 #endif
     }
+    Q_UNUSED(type);
+    Q_UNUSED(context);
     fprintf(stderr, "%s\n", logMessage.toLocal8Bit().constData());
     fflush(stderr);
 }
 
+#if !defined(QT_BOOTSTRAPPED) && !defined(QT_NO_THREAD) && defined(Q_COMPILER_THREAD_LOCAL)
+#  define QLOGGING_HAVE_ASYNC_OUTPUT
+#endif
+
+#ifdef QLOGGING_HAVE_ASYNC_OUTPUT
+namespace {
+struct QAsyncLogRecord
+{
+    QtMsgType type;
+    int line;
+    QString message;
+    // only filled in for the platform loggers, the console doesn't need them
+    QByteArray file;
+    QByteArray function;
+    QByteArray category;
+};
+
+// Single producer, single consumer ring. The producer is the thread that
+// logs, the consumer is the writer thread. Both hold a reference; the
+// thread's reference is dropped when it exits.
+class QAsyncLogRing
+{
+public:
+    enum { Capacity = 256 };
+
+    QAsyncLogRing() : ref(2), head(0), tail(0) {}
+
+    bool push(QAsyncLogRecord &record)
+    {
+        const uint t = tail.load();
+        if (t - head.loadAcquire() == Capacity)
+            return false;
+        records[t % Capacity] = std::move(record);
+        tail.storeRelease(t + 1);
+        return true;
+    }
+
+    bool pop(QAsyncLogRecord &record)
+    {
+        const uint h = head.load();
+        if (h == tail.loadAcquire())
+            return false;
+        record = std::move(records[h % Capacity]);
+        head.storeRelease(h + 1);
+        return true;
+    }
+
+    bool isOrphaned() const { return ref.load() == 1; }
+
+    QAtomicInt ref;
+    QAtomicInteger<uint> head;
+    QAtomicInteger<uint> tail;
+    QAsyncLogRecord records[Capacity];
+};
+
+struct QAsyncLogRingOwner
+{
+    QAsyncLogRing *ring;
+    ~QAsyncLogRingOwner();
+};
+
+static thread_local QAsyncLogRingOwner logRingOwner = { nullptr };
+// set once logRingOwner was destroyed, or for the writer thread itself
+static thread_local bool logRingUnavailable = false;
+
+QAsyncLogRingOwner::~QAsyncLogRingOwner()
+{
+    logRingUnavailable = true;
+    if (ring && !ring->ref.deref())
+        delete ring;
+}
+
+/*
+    Writes messages from a dedicated thread, so that logging threads only
+    format the message and never wait for the output device or for each
+    other. Each logging thread queues its messages in its own ring; the
+    order of messages from different threads is therefore not preserved
+    exactly.
+*/
+class QAsyncMessageSink : public QThread
+{
+public:
+    QAsyncMessageSink();
+    ~QAsyncMessageSink();
+
+    bool post(QtMsgType type, const QMessageLogContext &context, QString &message);
+    void flush();
+
+protected:
+    void run() override;
+
+private:
+    QMutex mutex;
+    QWaitCondition wakeUp;
+    QWaitCondition drained;
+    QVector<QAsyncLogRing *> rings;
+    enum { Closed = INT_MIN / 2 };
+
+    QAtomicInt queued;          // messages posted, but not written yet; Closed once stopped
+    QAtomicInt accepting;       // cleared once the writer thread has stopped
+    int flushWaiters;
+    bool quit;
+};
+} // unnamed namespace
+
+Q_GLOBAL_STATIC(QAsyncMessageSink, asyncMessageSink)
+
+static QBasicAtomicInt asyncMessageOutput = Q_BASIC_ATOMIC_INITIALIZER(-1);
+
+static bool useAsyncMessageOutput()
+{
+    int async = asyncMessageOutput.load();
+    if (Q_UNLIKELY(async < 0)) {
+        async = checked_var_value("QT_LOGGING_ASYNC") != 0;
+        asyncMessageOutput.store(async);
+    }
+    return async;
+}
+
+/*!
+    \internal
+
+    Enables or disables writing messages of the default message handler
+    from a separate thread, overriding the QT_LOGGING_ASYNC environment
+    variable. Disabling it writes out all queued messages first.
+*/
+Q_CORE_EXPORT void qt_logging_set_async(bool enable)
+{
+    asyncMessageOutput.store(enable);
+    if (!enable && asyncMessageSink.exists()) {
+        if (QAsyncMessageSink *sink = asyncMessageSink())
+            sink->flush();
+    }
+}
+
+QAsyncMessageSink::QAsyncMessageSink()
+    : accepting(1), flushWaiters(0), quit(false)
+{
+    setObjectName(QStringLiteral("Qt log writer"));
+    start();
+    if (!isRunning()) {
+        queued.storeRelease(Closed);
+        accepting.storeRelease(0);
+    }
+}
+
+QAsyncMessageSink::~QAsyncMessageSink()
+{
+    {
+        QMutexLocker locker(&mutex);
+        quit = true;
+        wakeUp.wakeOne();
+    }
+    wait();
+    for (QAsyncLogRing *ring : qAsConst(rings)) {
+        if (!ring->ref.deref())
+            delete ring;
+    }
+}
+
+/*
+    Queues the formatted \a message for the writer thread. Returns \c false
+    if the message needs to be written synchronously instead.
+*/
+bool QAsyncMessageSink::post(QtMsgType type, const QMessageLogContext &context, QString &message)
+{
+    if (logRingUnavailable || !accepting.loadAcquire())
+        return false;
+
+    QAsyncLogRing *ring = logRingOwner.ring;
+    if (Q_UNLIKELY(!ring)) {
+        ring = new QAsyncLogRing;
+        logRingOwner.ring = ring;
+        QMutexLocker locker(&mutex);
+        rings.append(ring);
+    }
+
+    QAsyncLogRecord record;
+    record.type = type;
+    record.line = context.line;
+    record.message = std::move(message);
+    if (!qt_logging_to_console()) {
+        record.file = context.file;
+        record.function = context.function;
+        record.category = context.category;
+    }
+
+    // Count the message before queuing it: the writer only stops once it
+    // has seen the count drop to zero, so it cannot exit while we push.
+    const int previous = queued.fetchAndAddOrdered(1);
+    if (Q_UNLIKELY(previous < 0)) {
+        queued.fetchAndSubRelaxed(1);
+        message = std::move(record.message);
+        return false;
+    }
+
+    // the ring can only be full while the writer is busy with it
+    while (Q_UNLIKELY(!ring->push(record)))
+        QThread::yieldCurrentThread();
+
+    if (previous == 0) {
+        // the writer may be waiting
+        QMutexLocker locker(&mutex);
+        wakeUp.wakeOne();
+    }
+    return true;
+}
+
+/*
+    Blocks until all messages queued so far have been written.
+*/
+void QAsyncMessageSink::flush()
+{
+    if (currentThread() == this)
+        return;
+
+    QMutexLocker locker(&mutex);
+    ++flushWaiters;
+    while (queued.loadAcquire() > 0 && isRunning())
+        drained.wait(&mutex);
+    --flushWaiters;
+}
+
+static inline const char *nullOrData(const QByteArray &ba)
+{
+    return ba.isNull() ? nullptr : ba.constData();
+}
+
+void QAsyncMessageSink::run()
+{
+    logRingUnavailable = true;
+
+    QVector<QAsyncLogRing *> current;
+    QAsyncLogRecord record;
+    QByteArray batch;
+    forever {
+        // Messages tend to come in bursts: look for more for a moment
+        // before going to sleep, so that not every message has to wake us.
+        for (int i = 0; i < 64 && queued.loadAcquire() <= 0; ++i)
+            QThread::yieldCurrentThread();
+
+        {
+            QMutexLocker locker(&mutex);
+            if (flushWaiters)
+                drained.wakeAll();
+            while (queued.loadAcquire() <= 0 && !quit)
+                wakeUp.wait(&mutex);
+            if (quit && queued.testAndSetOrdered(0, Closed)) {
+                accepting.storeRelease(0);
+                break;
+            }
+
+            // rings of threads that have exited are released once empty
+            for (int i = rings.size() - 1; i >= 0; --i) {
+                QAsyncLogRing *ring = rings.at(i);
+                if (ring->isOrphaned() && ring->head.load() == ring->tail.loadAcquire()) {
+                    rings.remove(i);
+                    delete ring;
+                }
+            }
+            current = rings;
+        }
+
+        // Console output of all available messages is written in one go;
+        // the platform loggers get one call per message.
+        const bool toConsole = qt_logging_to_console();
+        int written = 0;
+        for (QAsyncLogRing *ring : qAsConst(current)) {
+            while (ring->pop(record)) {
+                if (toConsole) {
+                    batch += record.message.toLocal8Bit();
+                    batch += '\n';
+                } else {
+                    QMessageLogContext context(nullOrData(record.file), record.line,
+                                               nullOrData(record.function),
+                                               nullOrData(record.category));
+                    qt_message_write(record.type, context, record.message);
+                }
+                record.message.clear();
+                ++written;
+            }
+        }
+        if (!batch.isEmpty()) {
+            fwrite(batch.constData(), 1, batch.size(), stderr);
+            fflush(stderr);
+            batch.resize(0);
+        }
+        queued.fetchAndSubRelease(written);
+    }
+}
+#else
+Q_CORE_EXPORT void qt_logging_set_async(bool)
+{
+}
+#endif // QLOGGING_HAVE_ASYNC_OUTPUT
+
+/*!
+    \internal
+
+    Waits until the messages queued by the default message handler have
+    been written.
+*/
+static void qt_message_flush()
+{
+#ifdef QLOGGING_HAVE_ASYNC_OUTPUT
+    if (asyncMessageSink.exists()) {
+        if (QAsyncMessageSink *sink = asyncMessageSink())
+            sink->flush();
+    }
+#endif
+}
+
+/*!
+    \internal
+*/
+static void qDefaultMessageHandler(QtMsgType type, const QMessageLogContext &context,
+                                   const QString &buf)
+{
+    QString logMessage = qFormatLogMessage(type, context, buf);
+
+    // print nothing if message pattern didn't apply / was empty.
+    // (still print empty lines, e.g. because message itself was empty)
+    if (logMessage.isNull())
+        return;
+
+#ifdef QLOGGING_HAVE_ASYNC_OUTPUT
+    if (useAsyncMessageOutput()) {
+        QAsyncMessageSink *sink = asyncMessageSink();
+        if (sink && sink->post(type, context, logMessage))
+            return;
+    }
+#endif
+    qt_message_write(type, context, logMessage);
+}
+
 /*!
     \internal
 */
@@ -1717,8 +2098,10 @@ static void qt_message_fatal(QtMsgType, const QMessageLogContext &context, const
 void qt_message_output(QtMsgType msgType, const QMessageLogContext &context, const QString &message)
 {
     qt_message_print(msgType, context, message);
-    if (isFatal(msgType))
+    if (isFatal(msgType)) {
+        qt_message_flush();
         qt_message_fatal(msgType, context, message);
+    }
 }
 
 void qErrnoWarning(const char *msg, ...)
@@ -1797,6 +2180,14 @@ void qErrnoWarning(int code, const char *msg, ...)
     output under X11 or to the debugger under Windows. If it is a
     fatal message, the application aborts immediately.
 
+    If the environment variable \c QT_LOGGING_ASYNC is set to a non-zero
+    value, the default message handler only formats the message in the
+    calling thread and leaves writing it to a separate thread. Messages
+    from one thread keep their order, but messages from different threads
+    may be interleaved differently than they were generated. Pending
+    messages are written before a fatal message aborts the application,
+    and when the application exits normally.
+
     Only one message handler can be defined, since this is usually
     done on an application-wide basis to control debug output.
 
@@ -40,7 +40,10 @@
 // these might be defined via precompiled headers
 #include <QtCore/qatomic.h>
 
-#define FORKFD_NO_SPAWNFD
+#ifdef __FreeBSD__
+// spawnfd() is not available together with pdfork()'s process descriptors
+#  define FORKFD_NO_SPAWNFD
+#endif
 
 #if defined(QT_NO_DEBUG) && !defined(NDEBUG)
 #  define NDEBUG
@@ -2,6 +2,8 @@
 
 HEADERS +=  \
         io/qabstractfileengine_p.h \
+        io/qasyncfile.h \
+        io/qasyncfile_p.h \
         io/qbuffer.h \
         io/qdatastream.h \
         io/qdatastream_p.h \
@@ -56,6 +58,7 @@ HEADERS +=  \
 
 SOURCES += \
         io/qabstractfileengine.cpp \
+        io/qasyncfile.cpp \
         io/qbuffer.cpp \
         io/qdatastream.cpp \
         io/qdataurl.cpp \
@@ -0,0 +1,465 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qasyncfile.h"
+#include "private/qasyncfile_p.h"
+
+#if !defined(QT_NO_THREAD) && !defined(QT_NO_QFUTURE)
+
+#include "qthread.h"
+#include "qthreadpool.h"
+#include "private/qbytearray_p.h"
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+// Requests block on the file system, so they get threads of their own
+// instead of competing with the computations on the global instance
+class QAsyncFilePool : public QThreadPool
+{
+public:
+    QAsyncFilePool() { setMaxThreadCount(qMax(2, QThread::idealThreadCount())); }
+};
+}
+
+Q_GLOBAL_STATIC(QAsyncFilePool, asyncFilePool)
+
+class QAsyncFileRunner : public QRunnable
+{
+public:
+    explicit QAsyncFileRunner(QAsyncFilePrivate *d) : d(d) {}
+    void run() Q_DECL_OVERRIDE { d->processRequests(); }
+
+private:
+    QAsyncFilePrivate *d;
+};
+
+QAsyncFilePrivate::QAsyncFilePrivate()
+    : openMode(QIODevice::NotOpen),
+      queuedRunner(0),
+      running(false),
+      error(QFileDevice::NoError)
+{
+}
+
+void QAsyncFilePrivate::enqueue(const Request &request)
+{
+    QMutexLocker locker(&mutex);
+    requests.enqueue(request);
+    if (!running) {
+        QThreadPool *pool = asyncFilePool();
+        if (!pool) {
+            // application shutdown: there is nowhere to run asynchronously
+            locker.unlock();
+            processRequests();
+            return;
+        }
+        // one pool job drains all requests queued while it runs, so a
+        // burst of submissions costs a single thread pool round-trip
+        running = true;
+        queuedRunner = new QAsyncFileRunner(this);
+        pool->start(queuedRunner);
+    }
+}
+
+void QAsyncFilePrivate::processRequests()
+{
+    QMutexLocker locker(&mutex);
+    queuedRunner = 0;
+    running = true;
+    while (!requests.isEmpty()) {
+        Request request = requests.dequeue();
+        locker.unlock();
+        execute(request);
+        locker.relock();
+    }
+    running = false;
+    idle.wakeAll();
+}
+
+void QAsyncFilePrivate::execute(Request &request)
+{
+    if (request.type == Request::Read) {
+        QFutureInterface<QByteArray> &result = request.readInterface;
+        if (result.isCanceled()) {
+            result.reportFinished();
+            return;
+        }
+
+        QByteArray buffer;
+        if (!file.seek(request.offset)) {
+            setError(QFileDevice::ReadError, file.errorString());
+        } else {
+            // don't allocate more than what is left in the file
+            const qint64 available = qMax(Q_INT64_C(0), file.size() - request.offset);
+            const qint64 size = qMin(request.size, available);
+            if (size >= MaxByteArraySize) {
+                setError(QFileDevice::ReadError, QAsyncFile::tr("Read request is too large"));
+            } else if (size > 0) {
+                buffer.resize(int(size));
+                const qint64 readBytes = file.read(buffer.data(), size);
+                if (readBytes < 0) {
+                    setError(QFileDevice::ReadError, file.errorString());
+                    buffer.clear();
+                } else {
+                    buffer.resize(int(readBytes));
+                }
+            }
+        }
+        result.reportFinished(&buffer);
+    } else {
+        QFutureInterface<qint64> &result = request.writeInterface;
+        if (result.isCanceled()) {
+            result.reportFinished();
+            return;
+        }
+
+        qint64 writtenBytes = -1;
+        if (!file.seek(request.offset)) {
+            setError(QFileDevice::WriteError, file.errorString());
+        } else {
+            writtenBytes = file.write(request.data);
+            if (writtenBytes < 0)
+                setError(file.error(), file.errorString());
+        }
+        result.reportFinished(&writtenBytes);
+    }
+}
+
+void QAsyncFilePrivate::waitForIdle(QMutexLocker *locker)
+{
+    // If no thread has picked up the job yet (the pool may be busy with
+    // other files), execute the requests here rather than wait for one.
+    QThreadPool *pool = asyncFilePool();
+    if (queuedRunner && pool && pool->tryTake(queuedRunner)) {
+        delete queuedRunner;
+        queuedRunner = 0;
+        locker->unlock();
+        processRequests();
+        locker->relock();
+    }
+    while (running)
+        idle.wait(locker->mutex());
+}
+
+void QAsyncFilePrivate::setError(QFileDevice::FileError err, const QString &errStr)
+{
+    QMutexLocker locker(&mutex);
+    error = err;
+    errorString = errStr;
+}
+
+/*!
+    \class QAsyncFile
+    \inmodule QtCore
+    \brief The QAsyncFile class provides non-blocking positional reads and
+    writes on a file.
+
+    \ingroup io
+
+    \since 5.10
+
+    QAsyncFile performs the actual I/O of read() and write() requests on
+    a thread pool of its own, so that the calling thread, typically the
+    GUI thread, never blocks on a slow disk or network file system, and
+    so that blocking I/O does not hold up QThreadPool::globalInstance().
+    Each request returns a QFuture; use QFutureWatcher to be notified in
+    the event loop when it completes.
+
+    \snippet code/src_corelib_io_qasyncfile.cpp 0
+
+    Requests on the same QAsyncFile are executed one after the other, in
+    the order they were submitted. All requests that are pending when the
+    file is processed are handled by the same thread pool job, so
+    submitting many small requests in a row does not cost one thread pool
+    round-trip per request, and no thread is dedicated to a single file.
+
+    Every request carries its own file offset; there is no notion of a
+    current position. Opening and closing the file are synchronous.
+    close() and the destructor wait for all pending requests to finish.
+
+    \sa QFile, QFuture, QFutureWatcher
+*/
+
+/*!
+    Constructs a new QAsyncFile object with the given \a parent.
+*/
+QAsyncFile::QAsyncFile(QObject *parent)
+    : QObject(*new QAsyncFilePrivate, parent)
+{
+}
+
+/*!
+    Constructs a new QAsyncFile object with the given \a parent to
+    represent the file with the specified \a name.
+*/
+QAsyncFile::QAsyncFile(const QString &name, QObject *parent)
+    : QObject(*new QAsyncFilePrivate, parent)
+{
+    Q_D(QAsyncFile);
+    d->fileName = name;
+    d->file.setFileName(name);
+}
+
+/*!
+    Destroys the QAsyncFile object, waiting for all pending requests to
+    finish and closing the file if necessary.
+*/
+QAsyncFile::~QAsyncFile()
+{
+    close();
+}
+
+/*!
+    Returns the name set by setFileName() or to the QAsyncFile constructor.
+*/
+QString QAsyncFile::fileName() const
+{
+    Q_D(const QAsyncFile);
+    return d->fileName;
+}
+
+/*!
+    Sets the \a name of the file. Do not call this function if the file
+    has already been opened.
+*/
+void QAsyncFile::setFileName(const QString &name)
+{
+    Q_D(QAsyncFile);
+    if (isOpen()) {
+        qWarning("QAsyncFile::setFileName: File (%s) is already opened",
+                 qPrintable(fileName()));
+        close();
+    }
+    d->fileName = name;
+    d->file.setFileName(name);
+}
+
+/*!
+    Opens the file using the OpenMode \a mode, returning true if
+    successful; otherwise false. QIODevice::Text is not supported and
+    QIODevice::Unbuffered is implied.
+
+    \sa error(), close()
+*/
+bool QAsyncFile::open(QIODevice::OpenMode mode)
+{
+    Q_D(QAsyncFile);
+    if (isOpen()) {
+        qWarning("QAsyncFile::open: File (%s) already open", qPrintable(fileName()));
+        return false;
+    }
+    if (mode & QIODevice::Text) {
+        qWarning("QAsyncFile::open: Text mode is not supported");
+        return false;
+    }
+    unsetError();
+
+    // requests come with their own offsets, so buffering in QIODevice
+    // would only add copies
+    if (!d->file.open(mode | QIODevice::Unbuffered)) {
+        d->setError(QFileDevice::OpenError, d->file.errorString());
+        return false;
+    }
+    d->openMode = mode & ~QIODevice::Unbuffered;
+    return true;
+}
+
+/*!
+    Returns \c true if the file is open; otherwise returns \c false.
+*/
+bool QAsyncFile::isOpen() const
+{
+    Q_D(const QAsyncFile);
+    return d->openMode != QIODevice::NotOpen;
+}
+
+/*!
+    Returns the mode in which the file was opened, or QIODevice::NotOpen
+    if it is not open.
+*/
+QIODevice::OpenMode QAsyncFile::openMode() const
+{
+    Q_D(const QAsyncFile);
+    return d->openMode;
+}
+
+/*!
+    Waits for all pending requests to finish, then closes the file.
+*/
+void QAsyncFile::close()
+{
+    Q_D(QAsyncFile);
+    waitForFinished();
+    d->file.close();
+    d->openMode = QIODevice::NotOpen;
+}
+
+/*!
+    Returns the last error that occurred, either when opening the file or
+    while executing a request.
+
+    \sa unsetError(), errorString()
+*/
+QFileDevice::FileError QAsyncFile::error() const
+{
+    Q_D(const QAsyncFile);
+    QMutexLocker locker(&d->mutex);
+    return d->error;
+}
+
+/*!
+    Returns a human-readable description of the last error that occurred.
+
+    \sa error()
+*/
+QString QAsyncFile::errorString() const
+{
+    Q_D(const QAsyncFile);
+    QMutexLocker locker(&d->mutex);
+    return d->errorString;
+}
+
+/*!
+    Sets the file's error to QFileDevice::NoError.
+
+    \sa error()
+*/
+void QAsyncFile::unsetError()
+{
+    Q_D(QAsyncFile);
+    d->setError(QFileDevice::NoError, QString());
+}
+
+/*!
+    Queues a request to read at most \a maxSize bytes starting at \a offset
+    and returns a future for the data.
+
+    The result is empty if \a offset is at or past the end of the file, or
+    if an error occurred; in the latter case, error() is set.
+
+    Cancelling the future before the request is executed discards it.
+*/
+QFuture<QByteArray> QAsyncFile::read(qint64 offset, qint64 maxSize)
+{
+    Q_D(QAsyncFile);
+    QAsyncFilePrivate::Request request;
+    request.type = QAsyncFilePrivate::Request::Read;
+    request.offset = offset;
+    request.size = maxSize;
+    request.readInterface.reportStarted();
+    QFuture<QByteArray> future = request.readInterface.future();
+
+    if (!(openMode() & QIODevice::ReadOnly) || offset < 0 || maxSize < 0) {
+        if (!isOpen())
+            qWarning("QAsyncFile::read: File (%s) not open", qPrintable(fileName()));
+        else if (!(openMode() & QIODevice::ReadOnly))
+            qWarning("QAsyncFile::read: File (%s) not open for reading", qPrintable(fileName()));
+        else
+            qWarning("QAsyncFile::read: Invalid offset or size");
+        const QByteArray empty;
+        request.readInterface.reportFinished(&empty);
+        return future;
+    }
+
+    d->enqueue(request);
+    return future;
+}
+
+/*!
+    Queues a request to write \a data starting at \a offset and returns a
+    future for the number of bytes written, or -1 if an error occurred; in
+    the latter case, error() is set.
+
+    Cancelling the future before the request is executed discards it.
+*/
+QFuture<qint64> QAsyncFile::write(qint64 offset, const QByteArray &data)
+{
+    Q_D(QAsyncFile);
+    QAsyncFilePrivate::Request request;
+    request.type = QAsyncFilePrivate::Request::Write;
+    request.offset = offset;
+    request.size = data.size();
+    request.data = data;
+    request.writeInterface.reportStarted();
+    QFuture<qint64> future = request.writeInterface.future();
+
+    if (!(openMode() & QIODevice::WriteOnly) || offset < 0) {
+        if (!isOpen())
+            qWarning("QAsyncFile::write: File (%s) not open", qPrintable(fileName()));
+        else if (!(openMode() & QIODevice::WriteOnly))
+            qWarning("QAsyncFile::write: File (%s) not open for writing", qPrintable(fileName()));
+        else
+            qWarning("QAsyncFile::write: Invalid offset");
+        const qint64 failed = -1;
+        request.writeInterface.reportFinished(&failed);
+        return future;
+    }
+
+    d->enqueue(request);
+    return future;
+}
+
+/*!
+    Returns the number of requests that have been queued but not executed
+    yet.
+*/
+int QAsyncFile::pendingRequestCount() const
+{
+    Q_D(const QAsyncFile);
+    QMutexLocker locker(&d->mutex);
+    return d->requests.size();
+}
+
+/*!
+    Blocks until all pending requests have been executed.
+*/
+void QAsyncFile::waitForFinished()
+{
+    Q_D(QAsyncFile);
+    QMutexLocker locker(&d->mutex);
+    d->waitForIdle(&locker);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qasyncfile.cpp"
+
+#endif // !QT_NO_THREAD && !QT_NO_QFUTURE
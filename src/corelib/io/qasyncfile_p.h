@@ -0,0 +1,116 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QASYNCFILE_P_H
+#define QASYNCFILE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qasyncfile.h"
+
+#if !defined(QT_NO_THREAD) && !defined(QT_NO_QFUTURE)
+
+#include "qfile.h"
+#include "qfutureinterface.h"
+#include "qmutex.h"
+#include "qqueue.h"
+#include "qrunnable.h"
+#include "qwaitcondition.h"
+#include "private/qobject_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QAsyncFilePrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QAsyncFile)
+
+public:
+    struct Request
+    {
+        enum Type { Read, Write };
+
+        Type type;
+        qint64 offset;
+        qint64 size;
+        QByteArray data;
+        QFutureInterface<QByteArray> readInterface;
+        QFutureInterface<qint64> writeInterface;
+    };
+
+    QAsyncFilePrivate();
+
+    void enqueue(const Request &request);
+    void processRequests();
+    void execute(Request &request);
+    void waitForIdle(QMutexLocker *locker);
+    void setError(QFileDevice::FileError err, const QString &errorString);
+
+    // only touched by the runner while requests are pending, and by the
+    // owner's thread while the queue is idle
+    QFile file;
+
+    // the owner's view of the file, so that it never has to look at
+    // file while a request is executed
+    QString fileName;
+    QIODevice::OpenMode openMode;
+
+    mutable QMutex mutex;
+    QWaitCondition idle;
+    QQueue<Request> requests;
+    QRunnable *queuedRunner; // started, but not picked up by a thread yet
+    bool running;
+    QFileDevice::FileError error;
+    QString errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // !QT_NO_THREAD && !QT_NO_QFUTURE
+
+#endif // QASYNCFILE_P_H
@@ -47,7 +47,9 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <limits>
 #include "qendian.h"
+#include "private/qsimd_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -1413,6 +1415,116 @@ int QDataStream::skipRawData(int len)
     }
 }
 
+namespace QtPrivate {
+
+#if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+QT_FUNCTION_TARGET(SSSE3)
+static int bswapArraySsse3(uchar *dst, const uchar *src, int count, int size)
+{
+    // one pshufb per 16 bytes reverses every 2, 4 or 8 byte group
+    const __m128i mask = size == 2 ? _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1)
+                       : size == 4 ? _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)
+                       : _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    const int perVector = 16 / size;
+    int i = 0;
+    for ( ; i + perVector <= count; i += perVector) {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * size));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * size), _mm_shuffle_epi8(data, mask));
+    }
+    return i;
+}
+#endif
+
+// Byte-swaps count elements of size bytes each from src to dst, which may
+// be the same buffer.
+static void bswapArray(uchar *dst, const uchar *src, int count, int size)
+{
+    int i = 0;
+#if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    if (qCpuHasFeature(SSSE3))
+        i = bswapArraySsse3(dst, src, count, size);
+#endif
+    switch (size) {
+    case 2:
+        for ( ; i < count; ++i)
+            qToUnaligned(qbswap(qFromUnaligned<quint16>(src + i * 2)), dst + i * 2);
+        break;
+    case 4:
+        for ( ; i < count; ++i)
+            qToUnaligned(qbswap(qFromUnaligned<quint32>(src + i * 4)), dst + i * 4);
+        break;
+    case 8:
+        for ( ; i < count; ++i)
+            qToUnaligned(qbswap(qFromUnaligned<quint64>(src + i * 8)), dst + i * 8);
+        break;
+    default:
+        Q_UNREACHABLE();
+    }
+}
+
+static inline bool needsByteSwap(const QDataStream &s, int size)
+{
+    return size > 1 && s.byteOrder() != QDataStream::ByteOrder(QSysInfo::ByteOrder);
+}
+
+/*!
+    \internal
+
+    Reads \a count elements of \a size bytes each into \a data, converting
+    them from the byte order of \a s. Sets ReadPastEnd on \a s if there is
+    not enough data.
+*/
+void readBulkData(QDataStream &s, void *data, int count, int size)
+{
+    uchar *p = static_cast<uchar *>(data);
+    const int maxChunk = std::numeric_limits<int>::max() / size;
+    while (count > 0 && s.status() == QDataStream::Ok) {
+        const int chunk = qMin(count, maxChunk);
+        const int len = chunk * size;
+        if (s.readRawData(reinterpret_cast<char *>(p), len) != len) {
+            s.setStatus(QDataStream::ReadPastEnd);
+            return;
+        }
+        if (needsByteSwap(s, size))
+            bswapArray(p, p, chunk, size);
+        p += len;
+        count -= chunk;
+    }
+}
+
+/*!
+    \internal
+
+    Writes \a count elements of \a size bytes each from \a data, converting
+    them to the byte order of \a s.
+*/
+void writeBulkData(QDataStream &s, const void *data, int count, int size)
+{
+    const uchar *p = static_cast<const uchar *>(data);
+    if (!needsByteSwap(s, size)) {
+        const int maxChunk = std::numeric_limits<int>::max() / size;
+        while (count > 0 && s.status() == QDataStream::Ok) {
+            const int chunk = qMin(count, maxChunk);
+            s.writeRawData(reinterpret_cast<const char *>(p), chunk * size);
+            p += chunk * size;
+            count -= chunk;
+        }
+        return;
+    }
+
+    uchar buffer[16384];
+    const int maxChunk = int(sizeof(buffer)) / size;
+    while (count > 0 && s.status() == QDataStream::Ok) {
+        const int chunk = qMin(count, maxChunk);
+        bswapArray(buffer, p, chunk, size);
+        s.writeRawData(reinterpret_cast<const char *>(buffer), chunk * size);
+        p += chunk * size;
+        count -= chunk;
+    }
+}
+
+} // namespace QtPrivate
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_DATASTREAM
@@ -320,6 +320,90 @@ QDataStream &writeAssociativeContainer(QDataStream &s, const Container &c)
     return s;
 }
 
+// The types whose QDataStream representation is their in-memory one,
+// possibly byte-swapped, so that arrays of them can be streamed in bulk.
+template <typename T>
+struct IsBulkStreamable
+    : std::integral_constant<bool,
+                             std::is_same<T, qint8>::value || std::is_same<T, quint8>::value
+                             || std::is_same<T, qint16>::value || std::is_same<T, quint16>::value
+                             || std::is_same<T, qint32>::value || std::is_same<T, quint32>::value
+                             || std::is_same<T, qint64>::value || std::is_same<T, quint64>::value
+                             || std::is_same<T, float>::value || std::is_same<T, double>::value>
+{};
+
+template <typename T>
+bool canStreamInBulk(const QDataStream &s)
+{
+    // floating point values are written with the stream's precision and
+    // old streams split 64-bit integers in two 32-bit halves
+    if (std::is_same<T, float>::value) {
+        return s.version() < QDataStream::Qt_4_6
+                || s.floatingPointPrecision() == QDataStream::SinglePrecision;
+    }
+    if (std::is_same<T, double>::value) {
+        return s.version() < QDataStream::Qt_4_6
+                || s.floatingPointPrecision() == QDataStream::DoublePrecision;
+    }
+    return sizeof(T) < 8 || s.version() >= QDataStream::Qt_3_3;
+}
+
+Q_CORE_EXPORT void readBulkData(QDataStream &s, void *data, int count, int size);
+Q_CORE_EXPORT void writeBulkData(QDataStream &s, const void *data, int count, int size);
+
+template <typename T>
+QDataStream &readVector(QDataStream &s, QVector<T> &v, std::false_type)
+{
+    return readArrayBasedContainer(s, v);
+}
+
+template <typename T>
+QDataStream &readVector(QDataStream &s, QVector<T> &v, std::true_type)
+{
+    if (!canStreamInBulk<T>(s))
+        return readArrayBasedContainer(s, v);
+
+    StreamStateSaver stateSaver(&s);
+
+    v.clear();
+    quint32 n;
+    s >> n;
+    if (s.status() == QDataStream::Ok && qint32(n) < 0)
+        s.setStatus(QDataStream::ReadCorruptData);
+
+    // Grow the vector as the data arrives instead of trusting n, which
+    // could come from a corrupt stream.
+    const int stepSize = 1024 * 1024 / sizeof(T);
+    int count = 0;
+    while (count < int(n) && s.status() == QDataStream::Ok) {
+        const int step = qMin(int(n) - count, stepSize);
+        v.resize(count + step);
+        readBulkData(s, v.data() + count, step, sizeof(T));
+        count += step;
+    }
+    if (s.status() != QDataStream::Ok)
+        v.clear();
+
+    return s;
+}
+
+template <typename T>
+QDataStream &writeVector(QDataStream &s, const QVector<T> &v, std::false_type)
+{
+    return writeSequentialContainer(s, v);
+}
+
+template <typename T>
+QDataStream &writeVector(QDataStream &s, const QVector<T> &v, std::true_type)
+{
+    if (!canStreamInBulk<T>(s))
+        return writeSequentialContainer(s, v);
+
+    s << quint32(v.size());
+    writeBulkData(s, v.constData(), v.size(), sizeof(T));
+    return s;
+}
+
 } // QtPrivate namespace
 
 /*****************************************************************************
@@ -397,13 +481,13 @@ inline QDataStream &operator<<(QDataStream &s, const QLinkedList<T> &l)
 template<typename T>
 inline QDataStream &operator>>(QDataStream &s, QVector<T> &v)
 {
-    return QtPrivate::readArrayBasedContainer(s, v);
+    return QtPrivate::readVector(s, v, QtPrivate::IsBulkStreamable<T>());
 }
 
 template<typename T>
 inline QDataStream &operator<<(QDataStream &s, const QVector<T> &v)
 {
-    return QtPrivate::writeSequentialContainer(s, v);
+    return QtPrivate::writeVector(s, v, QtPrivate::IsBulkStreamable<T>());
 }
 
 template <typename T>
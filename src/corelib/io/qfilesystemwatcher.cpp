@@ -45,6 +45,7 @@
 #include <qdatetime.h>
 #include <qdebug.h>
 #include <qdir.h>
+#include <qdiriterator.h>
 #include <qfileinfo.h>
 #include <qset.h>
 #include <qtimer.h>
@@ -88,7 +89,7 @@ QFileSystemWatcherEngine *QFileSystemWatcherPrivate::createNativeEngine(QObject
 }
 
 QFileSystemWatcherPrivate::QFileSystemWatcherPrivate()
-    : native(0), poller(0)
+    : native(0), poller(0), coalescingInterval(0), coalescingTimer(0)
 {
 }
 
@@ -136,28 +137,142 @@ void QFileSystemWatcherPrivate::initPollerEngine()
                      SLOT(_q_directoryChanged(QString,bool)));
 }
 
-void QFileSystemWatcherPrivate::_q_fileChanged(const QString &path, bool removed)
+// the engines append the paths they could watch to files and directories
+void QFileSystemWatcherPrivate::pathsAdded(int oldFileCount, int oldDirectoryCount)
+{
+    for (int i = oldFileCount; i < files.size(); ++i)
+        fileSet.insert(files.at(i));
+    for (int i = oldDirectoryCount; i < directories.size(); ++i)
+        directorySet.insert(directories.at(i));
+}
+
+// the engines removed \a paths from files and directories, except \a notRemoved
+void QFileSystemWatcherPrivate::pathsRemoved(const QStringList &paths, const QStringList &notRemoved)
+{
+    const QSet<QString> kept = notRemoved.toSet();
+    for (const QString &path : paths) {
+        if (!kept.contains(path)) {
+            fileSet.remove(path);
+            directorySet.remove(path);
+            recursiveDirectories.remove(path);
+            // don't report the changes that are still pending for it
+            if (changedFileSet.remove(path))
+                changedFiles.removeOne(path);
+            if (changedDirectorySet.remove(path))
+                changedDirectories.removeOne(path);
+        }
+    }
+}
+
+// watches the subdirectories of \a path that appeared since it was added
+void QFileSystemWatcherPrivate::watchNewSubdirectories(const QString &path)
+{
+    Q_Q(QFileSystemWatcher);
+    QStringList added;
+    QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::NoSymLinks);
+    while (it.hasNext()) {
+        const QString subdirectory = it.next();
+        if (!directorySet.contains(subdirectory))
+            added.append(subdirectory);
+    }
+    if (added.isEmpty())
+        return;
+
+    q->addPaths(added, QFileSystemWatcher::WatchSubdirectories);
+
+    // files may have been created in them before we watched them
+    for (const QString &subdirectory : qAsConst(added)) {
+        if (directorySet.contains(subdirectory))
+            pathChanged(subdirectory, true);
+    }
+}
+
+void QFileSystemWatcherPrivate::pathChanged(const QString &path, bool isDirectory)
+{
+    Q_Q(QFileSystemWatcher);
+    if (coalescingInterval <= 0) {
+        if (isDirectory) {
+            emit q->directoryChanged(path, QFileSystemWatcher::QPrivateSignal());
+            emit q->pathsChanged(QStringList(), QStringList(path), QFileSystemWatcher::QPrivateSignal());
+        } else {
+            emit q->fileChanged(path, QFileSystemWatcher::QPrivateSignal());
+            emit q->pathsChanged(QStringList(path), QStringList(), QFileSystemWatcher::QPrivateSignal());
+        }
+        return;
+    }
+
+    if (isDirectory) {
+        if (!changedDirectorySet.contains(path)) {
+            changedDirectorySet.insert(path);
+            changedDirectories.append(path);
+        }
+    } else {
+        if (!changedFileSet.contains(path)) {
+            changedFileSet.insert(path);
+            changedFiles.append(path);
+        }
+    }
+
+    if (!coalescingTimer) {
+        coalescingTimer = new QTimer(q);
+        coalescingTimer->setSingleShot(true);
+        QObject::connect(coalescingTimer, &QTimer::timeout, q, [this] { emitChanges(); });
+    }
+    // the window starts with the first change, so that a steady stream of
+    // changes is still reported every coalescingInterval milliseconds
+    if (!coalescingTimer->isActive())
+        coalescingTimer->start(coalescingInterval);
+}
+
+void QFileSystemWatcherPrivate::emitChanges()
 {
     Q_Q(QFileSystemWatcher);
-    if (!files.contains(path)) {
+    // the slots may add and remove paths, which changes these
+    const QStringList files = changedFiles;
+    const QStringList directories = changedDirectories;
+    changedFiles.clear();
+    changedDirectories.clear();
+    changedFileSet.clear();
+    changedDirectorySet.clear();
+    if (coalescingTimer)
+        coalescingTimer->stop();
+
+    if (files.isEmpty() && directories.isEmpty())
+        return;
+    for (const QString &path : files)
+        emit q->fileChanged(path, QFileSystemWatcher::QPrivateSignal());
+    for (const QString &path : directories)
+        emit q->directoryChanged(path, QFileSystemWatcher::QPrivateSignal());
+    emit q->pathsChanged(files, directories, QFileSystemWatcher::QPrivateSignal());
+}
+
+void QFileSystemWatcherPrivate::_q_fileChanged(const QString &path, bool removed)
+{
+    if (!fileSet.contains(path)) {
         // the path was removed after a change was detected, but before we delivered the signal
         return;
     }
-    if (removed)
-        files.removeAll(path);
-    emit q->fileChanged(path, QFileSystemWatcher::QPrivateSignal());
+    if (removed) {
+        fileSet.remove(path);
+        files.removeOne(path);
+    }
+    pathChanged(path, false);
 }
 
 void QFileSystemWatcherPrivate::_q_directoryChanged(const QString &path, bool removed)
 {
-    Q_Q(QFileSystemWatcher);
-    if (!directories.contains(path)) {
+    if (!directorySet.contains(path)) {
         // perhaps the path was removed after a change was detected, but before we delivered the signal
         return;
     }
-    if (removed)
-        directories.removeAll(path);
-    emit q->directoryChanged(path, QFileSystemWatcher::QPrivateSignal());
+    if (removed) {
+        directorySet.remove(path);
+        directories.removeOne(path);
+        recursiveDirectories.remove(path);
+    }
+    pathChanged(path, true);
+    if (!removed && recursiveDirectories.contains(path))
+        watchNewSubdirectories(path);
 }
 
 #if defined(Q_OS_WIN) && !defined(Q_OS_WINRT)
@@ -313,6 +428,30 @@ bool QFileSystemWatcher::addPath(const QString &path)
     return paths.isEmpty();
 }
 
+/*!
+    \since 5.10
+    \overload
+
+    Adds \a path to the file system watcher, as specified by \a flags.
+
+    If \a flags contains WatchSubdirectories and \a path is a directory,
+    its subdirectories are watched as well, and so are the ones that
+    are created in it later. This returns \c false if \a path or one
+    of its subdirectories could not be watched.
+
+    \sa addPaths(), removePath()
+*/
+bool QFileSystemWatcher::addPath(const QString &path, WatchFlags flags)
+{
+    if (path.isEmpty()) {
+        qWarning("QFileSystemWatcher::addPath: path is empty");
+        return true;
+    }
+
+    QStringList paths = addPaths(QStringList(path), flags);
+    return paths.isEmpty();
+}
+
 /*!
     Adds each path in \a paths to the file system watcher. Paths are
     not added if they not exist, or if they are already being
@@ -337,6 +476,30 @@ bool QFileSystemWatcher::addPath(const QString &path)
     \sa addPath(), removePaths()
 */
 QStringList QFileSystemWatcher::addPaths(const QStringList &paths)
+{
+    return addPaths(paths, NoWatchFlags);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Adds each path in \a paths to the file system watcher, as specified
+    by \a flags.
+
+    If \a flags contains WatchSubdirectories, the subdirectories of the
+    directories in \a paths are watched as well, and so are the ones that
+    are created in them later. The directoryChanged() signal is emitted for
+    a new subdirectory once it is watched, since files may have been
+    created in it before. Removing one of these directories with
+    removePath() or removePaths() also stops watching its subdirectories.
+
+    The return value is a list of paths, including subdirectories,
+    that could not be watched.
+
+    \sa addPath(), removePaths(), directories()
+*/
+QStringList QFileSystemWatcher::addPaths(const QStringList &paths, WatchFlags flags)
 {
     Q_D(QFileSystemWatcher);
 
@@ -354,6 +517,25 @@ QStringList QFileSystemWatcher::addPaths(const QStringList &paths)
         return QStringList();
     }
 
+    QSet<QString> recursive;
+    if (flags & WatchSubdirectories) {
+        const int count = p.size();
+        for (int i = 0; i < count; ++i) {
+            if (!QFileInfo(p.at(i)).isDir())
+                continue;
+            recursive.insert(p.at(i));
+            QDirIterator subdirectories(p.at(i),
+                                        QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::NoSymLinks,
+                                        QDirIterator::Subdirectories);
+            while (subdirectories.hasNext()) {
+                const QString subdirectory = subdirectories.next();
+                if (!d->directorySet.contains(subdirectory))
+                    p.append(subdirectory);
+                recursive.insert(subdirectory);
+            }
+        }
+    }
+
     QFileSystemWatcherEngine *engine = 0;
 
     const QString on = objectName();
@@ -380,8 +562,17 @@ QStringList QFileSystemWatcher::addPaths(const QStringList &paths)
         }
     }
 
-    if(engine)
+    if(engine) {
+        const int oldFileCount = d->files.size();
+        const int oldDirectoryCount = d->directories.size();
         p = engine->addPaths(p, &d->files, &d->directories);
+        d->pathsAdded(oldFileCount, oldDirectoryCount);
+    }
+
+    for (const QString &path : qAsConst(recursive)) {
+        if (d->directorySet.contains(path))
+            d->recursiveDirectories.insert(path);
+    }
 
     return p;
 }
@@ -436,14 +627,77 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
         return QStringList();
     }
 
+    // stop watching the subdirectories that were added with their parent
+    if (!d->recursiveDirectories.isEmpty()) {
+        QSet<QString> requestedSet = p.toSet();
+        const int count = p.size();
+        for (int i = 0; i < count; ++i) {
+            if (!d->recursiveDirectories.contains(p.at(i)))
+                continue;
+            const QString prefix = p.at(i) + QLatin1Char('/');
+            for (const QString &path : qAsConst(d->recursiveDirectories)) {
+                if (path.startsWith(prefix) && !requestedSet.contains(path)) {
+                    requestedSet.insert(path);
+                    p.append(path);
+                }
+            }
+        }
+    }
+
+    const QStringList requested = p;
     if (d->native)
         p = d->native->removePaths(p, &d->files, &d->directories);
     if (d->poller)
         p = d->poller->removePaths(p, &d->files, &d->directories);
+    d->pathsRemoved(requested, p);
 
     return p;
 }
 
+/*!
+    \enum QFileSystemWatcher::WatchFlag
+    \since 5.10
+
+    This enum describes how addPath() and addPaths() watch a path.
+
+    \value NoWatchFlags          Only watch the path itself.
+    \value WatchSubdirectories   If the path is a directory, also watch its
+                                 subdirectories, including the ones created
+                                 later.
+*/
+
+/*!
+    \property QFileSystemWatcher::coalescingInterval
+    \since 5.10
+    \brief how long, in milliseconds, changes are gathered before they are reported
+
+    If this property is 0 (the default), the fileChanged(),
+    directoryChanged() and pathsChanged() signals are emitted as soon as a
+    change is detected.
+
+    Otherwise, the first change starts a window of this many
+    milliseconds. The paths that change during the window are reported
+    together when it ends: fileChanged() and directoryChanged() are
+    emitted once for each path, however many times it changed, and
+    pathsChanged() is emitted once with all of them. This keeps a large
+    number of changes, as made by a build in a watched source tree,
+    from turning into a large number of signal emissions.
+*/
+int QFileSystemWatcher::coalescingInterval() const
+{
+    Q_D(const QFileSystemWatcher);
+    return d->coalescingInterval;
+}
+
+void QFileSystemWatcher::setCoalescingInterval(int msecs)
+{
+    Q_D(QFileSystemWatcher);
+    d->coalescingInterval = msecs;
+    // report what was gathered so far right away
+    if (msecs <= 0)
+        d->emitChanges();
+}
+
 /*!
     \fn void QFileSystemWatcher::fileChanged(const QString &path)
 
@@ -466,6 +720,19 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
     \sa fileChanged()
 */
 
+/*!
+    \fn void QFileSystemWatcher::pathsChanged(const QStringList &files, const QStringList &directories)
+    \since 5.10
+
+    This signal is emitted after fileChanged() and directoryChanged(),
+    with the \a files and \a directories they were emitted for. If
+    coalescingInterval is 0, it is emitted for every change, with a single
+    path. Otherwise it is emitted once for all the changes made during the
+    coalescing window.
+
+    \sa coalescingInterval
+*/
+
 /*!
     \fn QStringList QFileSystemWatcher::directories() const
 
@@ -53,29 +53,45 @@ class Q_CORE_EXPORT QFileSystemWatcher : public QObject
 {
     Q_OBJECT
     Q_DECLARE_PRIVATE(QFileSystemWatcher)
+    Q_PROPERTY(int coalescingInterval READ coalescingInterval WRITE setCoalescingInterval)
 
 public:
+    enum WatchFlag {
+        NoWatchFlags = 0x0,
+        WatchSubdirectories = 0x1
+    };
+    Q_DECLARE_FLAGS(WatchFlags, WatchFlag)
+    Q_FLAG(WatchFlags)
+
     QFileSystemWatcher(QObject *parent = Q_NULLPTR);
     QFileSystemWatcher(const QStringList &paths, QObject *parent = Q_NULLPTR);
     ~QFileSystemWatcher();
 
     bool addPath(const QString &file);
+    bool addPath(const QString &file, WatchFlags flags);
     QStringList addPaths(const QStringList &files);
+    QStringList addPaths(const QStringList &files, WatchFlags flags);
     bool removePath(const QString &file);
     QStringList removePaths(const QStringList &files);
 
     QStringList files() const;
     QStringList directories() const;
 
+    int coalescingInterval() const;
+    void setCoalescingInterval(int msecs);
+
 Q_SIGNALS:
     void fileChanged(const QString &path, QPrivateSignal);
     void directoryChanged(const QString &path, QPrivateSignal);
+    void pathsChanged(const QStringList &files, const QStringList &directories, QPrivateSignal);
 
 private:
     Q_PRIVATE_SLOT(d_func(), void _q_fileChanged(const QString &path, bool removed))
     Q_PRIVATE_SLOT(d_func(), void _q_directoryChanged(const QString &path, bool removed))
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QFileSystemWatcher::WatchFlags)
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_FILESYSTEMWATCHER
@@ -48,9 +48,12 @@
 #include <qdebug.h>
 #include <qfile.h>
 #include <qfileinfo.h>
+#include <qset.h>
 #include <qsocketnotifier.h>
 #include <qvarlengtharray.h>
 
+#include <algorithm>
+
 #if defined(Q_OS_LINUX)
 #include <sys/syscall.h>
 #include <sys/ioctl.h>
@@ -266,15 +269,13 @@ QStringList QInotifyFileSystemWatcherEngine::addPaths(const QStringList &paths,
     QMutableListIterator<QString> it(p);
     while (it.hasNext()) {
         QString path = it.next();
+        // every path we watch is in pathToID, so this avoids scanning the
+        // (possibly very long) files and directories lists
+        if (pathToID.contains(path))
+            continue;
+
         QFileInfo fi(path);
         bool isDir = fi.isDir();
-        if (isDir) {
-            if (directories->contains(path))
-                continue;
-        } else {
-            if (files->contains(path))
-                continue;
-        }
 
         int wd = inotify_add_watch(inotifyFd,
                                    QFile::encodeName(path),
@@ -314,11 +315,21 @@ QStringList QInotifyFileSystemWatcherEngine::addPaths(const QStringList &paths,
     return p;
 }
 
+static void removeAll(QStringList *list, const QSet<QString> &paths)
+{
+    if (paths.isEmpty())
+        return;
+    const auto isRemoved = [&paths](const QString &path) { return paths.contains(path); };
+    list->erase(std::remove_if(list->begin(), list->end(), isRemoved), list->end());
+}
+
 QStringList QInotifyFileSystemWatcherEngine::removePaths(const QStringList &paths,
                                                          QStringList *files,
                                                          QStringList *directories)
 {
     QStringList p = paths;
+    QSet<QString> removedFiles;
+    QSet<QString> removedDirectories;
     QMutableListIterator<QString> it(p);
     while (it.hasNext()) {
         QString path = it.next();
@@ -333,12 +344,16 @@ QStringList QInotifyFileSystemWatcherEngine::removePaths(const QStringList &path
 
         it.remove();
         if (id < 0) {
-            directories->removeAll(path);
+            removedDirectories.insert(path);
         } else {
-            files->removeAll(path);
+            removedFiles.insert(path);
         }
     }
 
+    // remove all paths in one pass over each list instead of once per path
+    removeAll(files, removedFiles);
+    removeAll(directories, removedDirectories);
+
     return p;
 }
 
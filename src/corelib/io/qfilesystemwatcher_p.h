@@ -59,9 +59,12 @@
 
 #include <QtCore/qstringlist.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qset.h>
 
 QT_BEGIN_NAMESPACE
 
+class QTimer;
+
 class QFileSystemWatcherEngine : public QObject
 {
     Q_OBJECT
@@ -103,6 +106,24 @@ public:
 
     QFileSystemWatcherEngine *native, *poller;
     QStringList files, directories;
+    // the same paths as files and directories, for fast lookups
+    QSet<QString> fileSet, directorySet;
+
+    // directories added with QFileSystemWatcher::WatchSubdirectories, and
+    // the subdirectories found in them
+    QSet<QString> recursiveDirectories;
+
+    // changes not reported yet, if coalescingInterval > 0
+    int coalescingInterval;
+    QTimer *coalescingTimer;
+    QStringList changedFiles, changedDirectories;
+    QSet<QString> changedFileSet, changedDirectorySet;
+
+    void pathsAdded(int oldFileCount, int oldDirectoryCount);
+    void pathsRemoved(const QStringList &paths, const QStringList &notRemoved);
+    void watchNewSubdirectories(const QString &path);
+    void pathChanged(const QString &path, bool isDirectory);
+    void emitChanges();
 
     // private slots
     void _q_fileChanged(const QString &path, bool removed);
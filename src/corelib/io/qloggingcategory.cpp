@@ -120,6 +120,24 @@ static void setBoolLane(QBasicAtomicInt *atomic, bool enable, int shift)
 
     If no argument is passed, all messages will be logged.
 
+    \section1 Compiling Out Categories
+
+    Defining \c QT_LOGGING_MINIMUM_LEVEL as one of \c QtDebugMsg,
+    \c QtInfoMsg, \c QtWarningMsg or \c QtCriticalMsg when compiling removes
+    all qCDebug(), qCInfo() and qCWarning() statements of a lower severity
+    from the code. Neither the category nor the arguments are evaluated, and
+    no logging rule can enable these messages again. In a qmake project,
+    this is done by setting the \c QT_LOGGING_MINIMUM_LEVEL variable to
+    \c debug, \c info, \c warning, or \c critical:
+
+    \code
+    QT_LOGGING_MINIMUM_LEVEL = warning
+    \endcode
+
+    qDebug(), qInfo() and qWarning() are not affected; use
+    \c QT_NO_DEBUG_OUTPUT, \c QT_NO_INFO_OUTPUT and \c QT_NO_WARNING_OUTPUT
+    for them.
+
     \section1 Configuring Categories
 
     The default configuration of categories can be overridden either by setting logging
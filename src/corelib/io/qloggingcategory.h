@@ -164,6 +164,31 @@ private:
 #  define qCWarning(category) QT_NO_QDEBUG_MACRO()
 #endif
 
+// QT_LOGGING_MINIMUM_LEVEL compiles out all category logging of a lower severity
+#if defined(QT_LOGGING_MINIMUM_LEVEL)
+#  define QT_LOGGING_SEVERITY_QtDebugMsg 1
+#  define QT_LOGGING_SEVERITY_QtInfoMsg 2
+#  define QT_LOGGING_SEVERITY_QtWarningMsg 3
+#  define QT_LOGGING_SEVERITY_QtCriticalMsg 4
+#  define QT_LOGGING_SEVERITY_HELPER(level) QT_LOGGING_SEVERITY_ ## level
+#  define QT_LOGGING_SEVERITY(level) QT_LOGGING_SEVERITY_HELPER(level)
+#  if QT_LOGGING_SEVERITY(QT_LOGGING_MINIMUM_LEVEL) == 0
+#    error "QT_LOGGING_MINIMUM_LEVEL must be one of QtDebugMsg, QtInfoMsg, QtWarningMsg or QtCriticalMsg"
+#  endif
+#  if QT_LOGGING_SEVERITY(QT_LOGGING_MINIMUM_LEVEL) > QT_LOGGING_SEVERITY_QtDebugMsg
+#    undef qCDebug
+#    define qCDebug(...) QT_NO_QDEBUG_MACRO()
+#  endif
+#  if QT_LOGGING_SEVERITY(QT_LOGGING_MINIMUM_LEVEL) > QT_LOGGING_SEVERITY_QtInfoMsg
+#    undef qCInfo
+#    define qCInfo(...) QT_NO_QDEBUG_MACRO()
+#  endif
+#  if QT_LOGGING_SEVERITY(QT_LOGGING_MINIMUM_LEVEL) > QT_LOGGING_SEVERITY_QtWarningMsg
+#    undef qCWarning
+#    define qCWarning(...) QT_NO_QDEBUG_MACRO()
+#  endif
+#endif
+
 QT_END_NAMESPACE
 
 #endif // QLOGGINGCATEGORY_H
@@ -253,7 +253,8 @@ void QLoggingSettingsParser::parseNextLine(QStringRef line)
     QLoggingRegistry constructor
  */
 QLoggingRegistry::QLoggingRegistry()
-    : categoryFilter(defaultCategoryFilter)
+    : generation(0),
+      categoryFilter(defaultCategoryFilter)
 {
 }
 
@@ -336,7 +337,9 @@ void QLoggingRegistry::registerCategory(QLoggingCategory *cat, QtMsgType enableF
     QMutexLocker locker(&registryMutex);
 
     if (!categories.contains(cat)) {
-        categories.insert(cat, enableForLevel);
+        const CategoryData data = { enableForLevel, generation };
+        categories.insert(cat, data);
+        categoriesByName.insert(QLatin1String(cat->categoryName()), cat);
         (*categoryFilter)(cat);
     }
 }
@@ -348,7 +351,36 @@ void QLoggingRegistry::registerCategory(QLoggingCategory *cat, QtMsgType enableF
 void QLoggingRegistry::unregisterCategory(QLoggingCategory *cat)
 {
     QMutexLocker locker(&registryMutex);
-    categories.remove(cat);
+    if (categories.remove(cat))
+        categoriesByName.remove(QLatin1String(cat->categoryName()), cat);
+}
+
+/*
+    Returns the rules of \a newRules that differ from \a oldRules, and the
+    rules of \a oldRules that are no longer there. Rules in the same
+    position at the start or end of both lists can't change the outcome
+    for any category.
+*/
+static QVector<QLoggingRule> changedRules(const QVector<QLoggingRule> &oldRules,
+                                          const QVector<QLoggingRule> &newRules)
+{
+    int begin = 0;
+    int oldEnd = oldRules.size();
+    int newEnd = newRules.size();
+    while (begin < oldEnd && begin < newEnd && oldRules.at(begin) == newRules.at(begin))
+        ++begin;
+    while (begin < oldEnd && begin < newEnd && oldRules.at(oldEnd - 1) == newRules.at(newEnd - 1)) {
+        --oldEnd;
+        --newEnd;
+    }
+
+    QVector<QLoggingRule> changed;
+    changed.reserve(oldEnd - begin + newEnd - begin);
+    for (int i = begin; i < oldEnd; ++i)
+        changed.append(oldRules.at(i));
+    for (int i = begin; i < newEnd; ++i)
+        changed.append(newRules.at(i));
+    return changed;
 }
 
 /*!
@@ -364,11 +396,14 @@ void QLoggingRegistry::setApiRules(const QString &content)
     if (qtLoggingDebug())
         debugMsg("Loading logging rules set by QLoggingCategory::setFilterRules ...");
 
+    const QVector<QLoggingRule> rules = parser.rules();
+
     const QMutexLocker locker(&registryMutex);
 
-    ruleSets[ApiRules] = parser.rules();
+    const QVector<QLoggingRule> changed = changedRules(ruleSets[ApiRules], rules);
+    ruleSets[ApiRules] = rules;
 
-    updateRules();
+    updateRules(changed);
 }
 
 /*!
@@ -379,8 +414,61 @@ void QLoggingRegistry::setApiRules(const QString &content)
 */
 void QLoggingRegistry::updateRules()
 {
-    for (auto it = categories.keyBegin(), end = categories.keyEnd(); it != end; ++it)
-        (*categoryFilter)(*it);
+    ++generation;
+    for (auto it = categories.begin(), end = categories.end(); it != end; ++it) {
+        it->generation = generation;
+        (*categoryFilter)(it.key());
+    }
+}
+
+/*!
+    \internal
+    Activates a new set of logging rules for the default filter, where only
+    \a changedRules were added or removed. Only the categories these rules
+    apply to are filtered again.
+
+    (The caller must lock registryMutex to make sure the API is thread safe.)
+*/
+void QLoggingRegistry::updateRules(const QVector<QLoggingRule> &changedRules)
+{
+    // a custom filter might depend on anything
+    if (categoryFilter != defaultCategoryFilter) {
+        updateRules();
+        return;
+    }
+
+    ++generation;
+    for (const QLoggingRule &rule : changedRules) {
+        if (rule.flags == QLoggingRule::FullText) {
+            for (auto it = categoriesByName.constFind(rule.category), end = categoriesByName.constEnd();
+                 it != end && it.key() == rule.category; ++it) {
+                updateCategory(it.value());
+            }
+        } else if (rule.flags == QLoggingRule::LeftFilter) {
+            for (auto it = categoriesByName.lowerBound(rule.category), end = categoriesByName.end();
+                 it != end && it.key().startsWith(rule.category); ++it) {
+                updateCategory(it.value());
+            }
+        } else {
+            // no index for matches at the end or in the middle of the name
+            for (auto it = categories.keyBegin(), end = categories.keyEnd(); it != end; ++it)
+                updateCategory(*it);
+            return;
+        }
+    }
+}
+
+/*!
+    \internal
+    Filters \a cat, unless it was filtered already in the current update.
+*/
+void QLoggingRegistry::updateCategory(QLoggingCategory *cat)
+{
+    CategoryData &data = categories[cat];
+    if (data.generation == generation)
+        return;
+    data.generation = generation;
+    (*categoryFilter)(cat);
 }
 
 /*!
@@ -418,7 +506,7 @@ void QLoggingRegistry::defaultCategoryFilter(QLoggingCategory *cat)
 {
     const QLoggingRegistry *reg = QLoggingRegistry::instance();
     Q_ASSERT(reg->categories.contains(cat));
-    QtMsgType enableForLevel = reg->categories.value(cat);
+    QtMsgType enableForLevel = reg->categories.value(cat).enableForLevel;
 
     // NB: note that the numeric values of the Qt*Msg constants are
     //     not in severity order.
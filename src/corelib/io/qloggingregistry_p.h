@@ -90,6 +90,14 @@ private:
 Q_DECLARE_OPERATORS_FOR_FLAGS(QLoggingRule::PatternFlags)
 Q_DECLARE_TYPEINFO(QLoggingRule, Q_MOVABLE_TYPE);
 
+inline bool operator==(const QLoggingRule &lhs, const QLoggingRule &rhs)
+{
+    return lhs.messageType == rhs.messageType && lhs.flags == rhs.flags
+            && lhs.enabled == rhs.enabled && lhs.category == rhs.category;
+}
+inline bool operator!=(const QLoggingRule &lhs, const QLoggingRule &rhs)
+{ return !(lhs == rhs); }
+
 class Q_AUTOTEST_EXPORT QLoggingSettingsParser
 {
 public:
@@ -127,6 +135,8 @@ public:
 
 private:
     void updateRules();
+    void updateRules(const QVector<QLoggingRule> &changedRules);
+    void updateCategory(QLoggingCategory *category);
 
     static void defaultCategoryFilter(QLoggingCategory *category);
 
@@ -144,7 +154,14 @@ private:
 
     // protected by mutex:
     QVector<QLoggingRule> ruleSets[NumRuleSets];
-    QHash<QLoggingCategory*,QtMsgType> categories;
+    struct CategoryData {
+        QtMsgType enableForLevel;
+        uint generation;    // the last update that filtered the category
+    };
+    QHash<QLoggingCategory*,CategoryData> categories;
+    // allows updating only the categories that changed rules apply to
+    QMultiMap<QString,QLoggingCategory*> categoriesByName;
+    uint generation;
     QLoggingCategory::CategoryFilter categoryFilter;
 
     friend class ::tst_QLoggingRegistry;
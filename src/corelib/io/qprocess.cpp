@@ -1951,6 +1951,10 @@ void QProcess::setProcessState(ProcessState state)
 
     \warning This function is called by QProcess on Unix and \macos
     only. On Windows and QNX, it is not called.
+
+    \note Where possible, QProcess starts programs without calling \c fork(),
+    which is considerably faster for parents with a large address space. A
+    reimplementation of this function makes QProcess fork the child instead.
 */
 void QProcess::setupChildProcess()
 {
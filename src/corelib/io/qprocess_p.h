@@ -354,6 +354,8 @@ public:
     void startProcess();
 #if defined(Q_OS_UNIX)
     void execChild(const char *workingDirectory, char **argv, char **envp);
+    bool canSpawnChild(const char *workingDirectory);
+    int spawnChild(const char *workingDirectory, char **argv, char **envp, pid_t *pid);
 #endif
     bool processStarted(QString *errorMessage = Q_NULLPTR);
     void terminateProcess();
@@ -116,6 +116,18 @@ QT_END_NAMESPACE
 
 #if QT_CONFIG(process)
 #include <forkfd.h>
+
+// Starting the child with posix_spawn() instead of fork() avoids copying the
+// parent's page tables, which dominates the start-up time when the parent has
+// a large address space. glibc implements it with clone(CLONE_VM|CLONE_VFORK)
+// and, since 2.24, reports exec() failures to the caller. Such a child cannot
+// run setupChildProcess(), so we need to find out whether it was reimplemented,
+// which only GCC lets us do (see canSpawnChild()).
+#if defined(Q_OS_LINUX) && defined(__GLIBC__) && defined(Q_CC_GNU) && !defined(Q_CC_CLANG) && !defined(Q_CC_INTEL)
+#  if __GLIBC_PREREQ(2, 24) && _POSIX_SPAWN > 0
+#    define QPROCESS_USE_SPAWN
+#  endif
+#endif
 #endif
 
 QT_BEGIN_NAMESPACE
@@ -457,8 +469,14 @@ void QProcessPrivate::startProcess()
     }
 
     // Start the process manager, and fork off the child process.
+    // If spawning fails, fork anyway: execChild() then reports the error the
+    // usual way (e.g. "chdir: No such file or directory").
     pid_t childPid;
-    forkfd = ::forkfd(FFD_CLOEXEC, &childPid);
+    forkfd = -1;
+    if (canSpawnChild(workingDirPtr))
+        forkfd = spawnChild(workingDirPtr, argv, envp, &childPid);
+    if (forkfd == -1)
+        forkfd = ::forkfd(FFD_CLOEXEC, &childPid);
     int lastForkErrno = errno;
     if (forkfd != FFD_CHILD_PROCESS) {
         // Parent process.
@@ -592,6 +610,106 @@ report_errno:
     childStartedPipe[1] = -1;
 }
 
+/*!
+    \internal
+    Returns \c true if the child can be started by spawnChild(): nothing in
+    execChild() may need to run in the child other than what posix_spawn()
+    can do, and setupChildProcess() must not be reimplemented.
+*/
+bool QProcessPrivate::canSpawnChild(const char *workingDir)
+{
+#ifdef QPROCESS_USE_SPAWN
+    Q_Q(QProcess);
+#  if !__GLIBC_PREREQ(2, 29)
+    if (workingDir)
+        return false; // no posix_spawn_file_actions_addchdir_np()
+#  else
+    Q_UNUSED(workingDir);
+#  endif
+
+    // GCC can resolve a virtual function for an object to the function pointer
+    // that would be called. Compare with what a plain QProcess calls.
+QT_WARNING_PUSH
+QT_WARNING_DISABLE_GCC("-Wpmf-conversions")
+    typedef void (*SetupFunction)(QProcess *);
+    static const SetupFunction defaultSetup = [] {
+        QProcess process;
+        return SetupFunction(process.*(&QProcess::setupChildProcess));
+    }();
+    return SetupFunction(q->*(&QProcess::setupChildProcess)) == defaultSetup;
+QT_WARNING_POP
+#else
+    Q_UNUSED(workingDir);
+    return false;
+#endif
+}
+
+/*!
+    \internal
+    Starts the child with posix_spawn(), doing what execChild() does in a
+    forked child. Returns the forkfd for the child, or -1 if it could not be
+    started.
+*/
+int QProcessPrivate::spawnChild(const char *workingDir, char **argv, char **envp, pid_t *pid)
+{
+#ifdef QPROCESS_USE_SPAWN
+    posix_spawn_file_actions_t fileActions;
+    if (posix_spawn_file_actions_init(&fileActions) != 0)
+        return -1;
+    posix_spawnattr_t attributes;
+    if (posix_spawnattr_init(&attributes) != 0) {
+        posix_spawn_file_actions_destroy(&fileActions);
+        return -1;
+    }
+
+    bool ok = true;
+
+    // copy the stdin socket if asked to
+    if (inputChannelMode != QProcess::ForwardedInputChannel)
+        ok = ok && posix_spawn_file_actions_adddup2(&fileActions, stdinChannel.pipe[0], STDIN_FILENO) == 0;
+
+    // copy the stdout and stderr if asked to
+    if (processChannelMode != QProcess::ForwardedChannels) {
+        if (processChannelMode != QProcess::ForwardedOutputChannel)
+            ok = ok && posix_spawn_file_actions_adddup2(&fileActions, stdoutChannel.pipe[1], STDOUT_FILENO) == 0;
+
+        // merge stdout and stderr if asked to
+        if (processChannelMode == QProcess::MergedChannels)
+            ok = ok && posix_spawn_file_actions_adddup2(&fileActions, STDOUT_FILENO, STDERR_FILENO) == 0;
+        else if (processChannelMode != QProcess::ForwardedErrorChannel)
+            ok = ok && posix_spawn_file_actions_adddup2(&fileActions, stderrChannel.pipe[1], STDERR_FILENO) == 0;
+    }
+
+    // all our other file descriptors are close-on-exec, including childStartedPipe
+
+#  if __GLIBC_PREREQ(2, 29)
+    if (workingDir)
+        ok = ok && posix_spawn_file_actions_addchdir_np(&fileActions, workingDir) == 0;
+#  endif
+
+    // reset the signal that we ignored
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGPIPE);
+    ok = ok && posix_spawnattr_setsigdefault(&attributes, &defaultSignals) == 0
+            && posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF) == 0;
+
+    int ffd = -1;
+    if (ok)
+        ffd = ::spawnfd(FFD_CLOEXEC, pid, argv[0], &fileActions, &attributes, argv, envp ? envp : environ);
+
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&fileActions);
+    return ffd;
+#else
+    Q_UNUSED(workingDir);
+    Q_UNUSED(argv);
+    Q_UNUSED(envp);
+    Q_UNUSED(pid);
+    return -1;
+#endif
+}
+
 bool QProcessPrivate::processStarted(QString *errorMessage)
 {
     char buf[errorBufferMax];
@@ -52,6 +52,7 @@
 #include "qlibraryinfo.h"
 #include "qtemporaryfile.h"
 #include "qstandardpaths.h"
+#include "qendian.h"
 #include <qdatastream.h>
 
 #ifndef QT_NO_TEXTCODEC
@@ -66,6 +67,11 @@
 
 #ifndef QT_NO_QOBJECT
 #include "qcoreapplication.h"
+#include "qmetaobject.h"
+#endif
+
+#ifdef QSETTINGS_USE_FILESYSTEMWATCHER
+#include "qfilesystemwatcher.h"
 #endif
 
 #ifndef QT_BOOTSTRAPPED
@@ -152,7 +158,8 @@ static QBasicMutex settingsGlobalMutex;
 static QSettings::Format globalDefaultFormat = QSettings::NativeFormat;
 
 QConfFile::QConfFile(const QString &fileName, bool _userPerms)
-    : name(fileName), size(0), ref(1), userPerms(_userPerms)
+    : name(fileName), size(0), ref(1), userPerms(_userPerms),
+      logGeneration(0), logSize(0), logRecordCount(0), logChanges(0)
 {
     usedHashFunc()->insert(name, this);
 }
@@ -175,6 +182,64 @@ ParsedSettingsMap QConfFile::mergedKeyMap() const
     return result;
 }
 
+/*
+    Returns \a value the way writeIniFile() stores it.
+*/
+static QByteArray iniValueText(const QVariant &value)
+{
+    QByteArray result;
+    if (value.type() == QVariant::StringList
+            || (value.type() == QVariant::List && value.toList().size() != 1)) {
+        QSettingsPrivate::iniEscapedStringList(
+                QSettingsPrivate::variantListToStringList(value.toList()), result, 0);
+    } else {
+        QSettingsPrivate::iniEscapedString(QSettingsPrivate::variantToString(value), result, 0);
+    }
+    return result;
+}
+
+/*
+    Drops the added keys whose value is already stored on disk and the
+    removed keys that are not stored on disk anymore. Returns \c true if
+    some pending change is left.
+
+    INI files store every value as text, so if \a iniFormat is true, two
+    values are the same if they are written the same way (e.g. the integer
+    1 and the string "1" read back from the file). Otherwise they must
+    have the same type and compare equal.
+*/
+bool QConfFile::pruneRedundantChanges(bool iniFormat)
+{
+    ParsedSettingsMap::iterator i = addedKeys.begin();
+    while (i != addedKeys.end()) {
+        ParsedSettingsMap::iterator j = originalKeys.find(i.key());
+        bool redundant = false;
+        if (j != originalKeys.end()) {
+            if (iniFormat)
+                redundant = iniValueText(j.value()) == iniValueText(i.value());
+            else
+                redundant = j.value().userType() == i.value().userType() && j.value() == i.value();
+        }
+        if (redundant) {
+            // keep the value (and its type) the application set
+            j.value() = i.value();
+            i = addedKeys.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    i = removedKeys.begin();
+    while (i != removedKeys.end()) {
+        if (!originalKeys.contains(i.key()))
+            i = removedKeys.erase(i);
+        else
+            ++i;
+    }
+
+    return !addedKeys.isEmpty() || !removedKeys.isEmpty();
+}
+
 bool QConfFile::isWritable() const
 {
     QFileInfo fileInfo(name);
@@ -348,6 +413,15 @@ void QSettingsPrivate::update()
     pendingChanges = false;
 }
 
+/*
+    Called the first time something connects to QSettings::changed().
+    Only the backends that can tell when another process changed the
+    settings do something here.
+*/
+void QSettingsPrivate::watchForChanges()
+{
+}
+
 void QSettingsPrivate::requestUpdate()
 {
     if (!pendingChanges) {
@@ -925,7 +999,10 @@ QStringList QSettingsPrivate::splitArgs(const QString &s, int idx)
 
 void QConfFileSettingsPrivate::initFormat()
 {
-    extension = (format == QSettings::NativeFormat) ? QLatin1String(".conf") : QLatin1String(".ini");
+    if (format == QSettings::LogFormat)
+        extension = QLatin1String(".conflog");
+    else
+        extension = (format == QSettings::NativeFormat) ? QLatin1String(".conf") : QLatin1String(".ini");
     readFunc = 0;
     writeFunc = 0;
 #if defined(Q_OS_MAC)
@@ -952,7 +1029,7 @@ void QConfFileSettingsPrivate::initFormat()
 void QConfFileSettingsPrivate::initAccess()
 {
     if (!confFiles.isEmpty()) {
-        if (format > QSettings::IniFormat) {
+        if (format >= QSettings::CustomFormat1) {
             if (!readFunc)
                 setStatus(QSettings::AccessError);
         }
@@ -1129,6 +1206,9 @@ QConfFileSettingsPrivate::QConfFileSettingsPrivate(QSettings::Format format,
                                                    const QString &application)
     : QSettingsPrivate(format, scope, organization, application),
       nextPosition(0x40000000) // big positive number
+#ifdef QSETTINGS_USE_FILESYSTEMWATCHER
+      , logWatcher(0), seenLogChanges(0)
+#endif
 {
     initFormat();
 
@@ -1188,6 +1268,9 @@ QConfFileSettingsPrivate::QConfFileSettingsPrivate(const QString &fileName,
                                                    QSettings::Format format)
     : QSettingsPrivate(format),
       nextPosition(0x40000000) // big positive number
+#ifdef QSETTINGS_USE_FILESYSTEMWATCHER
+      , logWatcher(0), seenLogChanges(0)
+#endif
 {
     initFormat();
 
@@ -1382,7 +1465,7 @@ QString QConfFileSettingsPrivate::fileName() const
 
 bool QConfFileSettingsPrivate::isWritable() const
 {
-    if (format > QSettings::IniFormat && !writeFunc)
+    if (format >= QSettings::CustomFormat1 && !writeFunc)
         return false;
 
     if (confFiles.isEmpty())
@@ -1393,6 +1476,11 @@ bool QConfFileSettingsPrivate::isWritable() const
 
 void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
 {
+    if (format == QSettings::LogFormat) {
+        syncLogFile(confFile);
+        return;
+    }
+
     bool readOnly = confFile->addedKeys.isEmpty() && confFile->removedKeys.isEmpty();
 
     /*
@@ -1485,13 +1573,28 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
         confFile->timeStamp = fileInfo.lastModified();
     }
 
+    /*
+        Now that we know what is on disk, drop the pending changes that
+        would not alter it. If nothing is left, there is no need to
+        rewrite the whole file (but we still create it if it is missing).
+    */
+    if (!readOnly) {
+        ensureAllSectionsParsed(confFile);
+        bool iniFormat = format <= QSettings::IniFormat;
+#ifdef Q_OS_MAC
+        if (format == QSettings::NativeFormat)
+            iniFormat = false;
+#endif
+        if (!confFile->pruneRedundantChanges(iniFormat) && !createFile)
+            return;
+    }
+
     /*
         We also need to save the file. We still hold the file lock,
         so everything is under control.
     */
     if (!readOnly) {
         bool ok = false;
-        ensureAllSectionsParsed(confFile);
         ParsedSettingsMap mergedKeys = confFile->mergedKeyMap();
 
 #if !defined(QT_BOOTSTRAPPED) && QT_CONFIG(temporaryfile)
@@ -1550,6 +1653,351 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
     }
 }
 
+/*
+    A LogFormat file starts with a header (the magic "QSLg", the format
+    version and a generation number) followed by records. A record is
+    the big-endian length of its payload, the qChecksum() of the payload,
+    and the payload itself: the record type, then the key and, for
+    LogSet, the value, in QDataStream format. The records only take
+    effect once a LogCommit record follows them, so a batch that was cut
+    short by a crash is ignored.
+
+    sync() appends the pending changes as one batch, and only reads the
+    batches that were appended since the last sync(). When the file holds
+    many more records than keys, it is rewritten with one record per key
+    and a new generation number, which tells the readers to start over.
+*/
+enum LogRecordType {
+    LogSet = 1,
+    LogRemove,
+    LogCommit
+};
+
+enum {
+    LogVersion = 1,
+    LogHeaderSize = 16,
+    LogRecordHeaderSize = 6,
+    LogCompactionSlack = 256
+};
+
+static const char logMagic[4] = { 'Q', 'S', 'L', 'g' };
+
+static QByteArray logHeader(quint64 generation)
+{
+    QByteArray header(LogHeaderSize, Qt::Uninitialized);
+    memcpy(header.data(), logMagic, sizeof(logMagic));
+    qToBigEndian<quint32>(LogVersion, header.data() + 4);
+    qToBigEndian<quint64>(generation, header.data() + 8);
+    return header;
+}
+
+static bool readLogHeader(const QByteArray &header, quint64 *generation)
+{
+    if (header.size() != LogHeaderSize || memcmp(header.constData(), logMagic, sizeof(logMagic)) != 0
+            || qFromBigEndian<quint32>(header.constData() + 4) != LogVersion)
+        return false;
+    *generation = qFromBigEndian<quint64>(header.constData() + 8);
+    return true;
+}
+
+static void appendLogRecord(QByteArray &log, LogRecordType type, const QString &key = QString(),
+                            const QVariant *value = 0)
+{
+    QByteArray payload;
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_6);
+        stream << quint8(type);
+        if (type != LogCommit)
+            stream << key;
+        if (value)
+            stream << *value;
+    }
+
+    char header[LogRecordHeaderSize];
+    qToBigEndian<quint32>(payload.size(), header);
+    qToBigEndian<quint16>(qChecksum(payload.constData(), payload.size()), header + 4);
+    log.append(header, LogRecordHeaderSize);
+    log.append(payload);
+}
+
+/*
+    Applies the complete batches found in the \a size bytes at \a data to
+    \a map, and adds the number of records they hold to \a recordCount.
+    Returns the number of bytes they take; what follows is a batch that
+    is still being written or that was cut short.
+*/
+static qint64 readLogRecords(const char *data, qint64 size, ParsedSettingsMap *map,
+                             Qt::CaseSensitivity cs, int *recordCount)
+{
+    ParsedSettingsMap batchSet;
+    ParsedSettingsMap batchRemoved;
+    int batchRecords = 0;
+    qint64 committed = 0;
+    qint64 pos = 0;
+
+    while (size - pos >= LogRecordHeaderSize) {
+        const quint32 length = qFromBigEndian<quint32>(data + pos);
+        const char *payload = data + pos + LogRecordHeaderSize;
+        if (length == 0 || length > quint64(size - pos - LogRecordHeaderSize)
+                || qChecksum(payload, length) != qFromBigEndian<quint16>(data + pos + 4))
+            break;
+        pos += LogRecordHeaderSize + length;
+
+        QDataStream stream(QByteArray::fromRawData(payload, length));
+        stream.setVersion(QDataStream::Qt_5_6);
+        quint8 type;
+        QString key;
+        stream >> type;
+        if (type == LogCommit) {
+            for (auto i = batchRemoved.cbegin(); i != batchRemoved.cend(); ++i)
+                map->remove(i.key());
+            for (auto i = batchSet.cbegin(); i != batchSet.cend(); ++i)
+                map->insert(i.key(), i.value());
+            batchSet.clear();
+            batchRemoved.clear();
+            *recordCount += batchRecords;
+            batchRecords = 0;
+            committed = pos;
+            continue;
+        }
+
+        stream >> key;
+        if (stream.status() != QDataStream::Ok || (type != LogSet && type != LogRemove))
+            break;
+        ++batchRecords;
+
+        QSettingsKey settingsKey(key, cs);
+        batchSet.remove(settingsKey);
+        batchRemoved.remove(settingsKey);
+        if (type == LogSet) {
+            QVariant value;
+            stream >> value;
+            // skip values of types that are not registered in this process
+            if (stream.status() == QDataStream::Ok)
+                batchSet.insert(settingsKey, value);
+        } else {
+            batchRemoved.insert(settingsKey, QVariant());
+        }
+    }
+    return committed;
+}
+
+void QConfFileSettingsPrivate::syncLogFile(QConfFile *confFile)
+{
+    bool readOnly = confFile->addedKeys.isEmpty() && confFile->removedKeys.isEmpty();
+
+    if (readOnly && confFile->size > 0) {
+        QFileInfo fileInfo(confFile->name);
+        if (confFile->size == fileInfo.size() && confFile->timeStamp == fileInfo.lastModified())
+            return;
+    }
+
+#ifndef QT_BOOTSTRAPPED
+    QLockFile lockFile(confFile->name + QLatin1String(".lock"));
+#endif
+    if (!readOnly) {
+        if (!confFile->isWritable()
+#ifndef QT_BOOTSTRAPPED
+            || !lockFile.lock()
+#endif
+            ) {
+            setStatus(QSettings::AccessError);
+            return;
+        }
+    }
+
+    QFileInfo fileInfo(confFile->name);
+    const bool createFile = !fileInfo.exists();
+    const qint64 fileSize = fileInfo.size();
+
+    QFile file(confFile->name);
+    if (!createFile && !file.open(QFile::ReadOnly)) {
+        setStatus(QSettings::AccessError);
+        return;
+    }
+
+    quint64 generation = 0;
+    bool validHeader = false;
+    if (fileSize >= LogHeaderSize)
+        validHeader = readLogHeader(file.read(LogHeaderSize), &generation);
+    if (fileSize != 0 && !validHeader)
+        setStatus(QSettings::FormatError);
+
+    /*
+        Start over if the file was rewritten since we last read it,
+        otherwise only read what was appended since then.
+    */
+    if (!validHeader || generation != confFile->logGeneration
+            || confFile->logSize == 0 || fileSize < confFile->logSize) {
+        if (confFile->logSize != 0)
+            ++confFile->logChanges;
+        confFile->originalKeys.clear();
+        confFile->logGeneration = generation;
+        confFile->logSize = validHeader ? LogHeaderSize : 0;
+        confFile->logRecordCount = 0;
+    }
+
+    if (validHeader && fileSize > confFile->logSize) {
+        const qint64 offset = confFile->logSize;
+        qint64 length = fileSize - offset;
+        QByteArray buffer;
+        uchar *map = file.map(offset, length);
+        const char *data = reinterpret_cast<const char *>(map);
+        if (!map) {
+            file.seek(offset);
+            buffer = file.read(length);
+            data = buffer.constData();
+            length = buffer.size();
+        }
+
+        const qint64 read = readLogRecords(data, length, &confFile->originalKeys,
+                                           caseSensitivity, &confFile->logRecordCount);
+        if (map)
+            file.unmap(map);
+        if (read > 0) {
+            confFile->logSize += read;
+            ++confFile->logChanges;
+        }
+    }
+    file.close();
+
+    confFile->size = fileSize;
+    confFile->timeStamp = fileInfo.lastModified();
+
+    if (readOnly || (!confFile->pruneRedundantChanges(false) && validHeader))
+        return;
+
+    /*
+        We hold the file lock, so anything after the last complete batch
+        was left behind by a writer that crashed: write over it.
+    */
+    bool ok = false;
+    ParsedSettingsMap mergedKeys = confFile->mergedKeyMap();
+    const int changes = confFile->addedKeys.size() + confFile->removedKeys.size();
+
+    if (!validHeader
+            || confFile->logRecordCount + changes > 2 * mergedKeys.size() + LogCompactionSlack) {
+        generation = qMax(confFile->logGeneration + 1, quint64(QDateTime::currentMSecsSinceEpoch()));
+        QByteArray log = logHeader(generation);
+        for (auto i = mergedKeys.cbegin(); i != mergedKeys.cend(); ++i)
+            appendLogRecord(log, LogSet, i.key().originalCaseKey(), &i.value());
+        appendLogRecord(log, LogCommit);
+
+#if !defined(QT_BOOTSTRAPPED) && QT_CONFIG(temporaryfile)
+        QSaveFile sf(confFile->name);
+#else
+        QFile sf(confFile->name);
+#endif
+        ok = sf.open(QIODevice::WriteOnly) && sf.write(log) == log.size();
+#if !defined(QT_BOOTSTRAPPED) && QT_CONFIG(temporaryfile)
+        if (ok)
+            ok = sf.commit();
+#endif
+        if (ok) {
+            confFile->logGeneration = generation;
+            confFile->logSize = log.size();
+            confFile->logRecordCount = mergedKeys.size();
+        }
+    } else {
+        QByteArray log;
+        for (auto i = confFile->removedKeys.cbegin(); i != confFile->removedKeys.cend(); ++i)
+            appendLogRecord(log, LogRemove, i.key().originalCaseKey());
+        for (auto i = confFile->addedKeys.cbegin(); i != confFile->addedKeys.cend(); ++i)
+            appendLogRecord(log, LogSet, i.key().originalCaseKey(), &i.value());
+        appendLogRecord(log, LogCommit);
+
+        QFile f(confFile->name);
+        ok = f.open(QIODevice::ReadWrite);
+        if (ok && f.size() != confFile->logSize)
+            ok = f.resize(confFile->logSize);
+        ok = ok && f.seek(confFile->logSize) && f.write(log) == log.size() && f.flush();
+        if (ok) {
+            confFile->logSize += log.size();
+            confFile->logRecordCount += changes;
+        }
+    }
+
+    if (ok) {
+        confFile->originalKeys = mergedKeys;
+        confFile->addedKeys.clear();
+        confFile->removedKeys.clear();
+
+        QFileInfo fileInfo(confFile->name);
+        confFile->size = fileInfo.size();
+        confFile->timeStamp = fileInfo.lastModified();
+
+        if (createFile) {
+            QFile::Permissions perms = fileInfo.permissions() | QFile::ReadOwner | QFile::WriteOwner;
+            if (!confFile->userPerms)
+                perms |= QFile::ReadGroup | QFile::ReadOther;
+            QFile(confFile->name).setPermissions(perms);
+        }
+    } else {
+        setStatus(QSettings::AccessError);
+    }
+}
+
+#ifdef QSETTINGS_USE_FILESYSTEMWATCHER
+int QConfFileSettingsPrivate::logChanges() const
+{
+    int result = 0;
+    for (auto confFile : qAsConst(confFiles)) {
+        QMutexLocker locker(&confFile->mutex);
+        result += confFile->logChanges;
+    }
+    return result;
+}
+
+void QConfFileSettingsPrivate::watchForChanges()
+{
+    if (format != QSettings::LogFormat || logWatcher)
+        return;
+
+    // Q_Q() is private to QSettingsPrivate
+    QSettings *q = static_cast<QSettings *>(q_ptr);
+    logWatcher = new QFileSystemWatcher(q);
+    QObject::connect(logWatcher, &QFileSystemWatcher::fileChanged, q, [this] { logFileChanged(); });
+    QObject::connect(logWatcher, &QFileSystemWatcher::directoryChanged, q, [this] { logFileChanged(); });
+    watchLogFiles();
+    seenLogChanges = logChanges();
+}
+
+/*
+    Watches the files, and their directories so that we notice when a
+    file is created or replaced (compaction does that, and the watcher
+    then drops the file).
+*/
+void QConfFileSettingsPrivate::watchLogFiles()
+{
+    const QStringList watched = logWatcher->files() + logWatcher->directories();
+    QStringList paths;
+    for (auto confFile : qAsConst(confFiles)) {
+        const QFileInfo fileInfo(confFile->name);
+        const QString dir = fileInfo.absolutePath();
+        if (fileInfo.exists() && !watched.contains(confFile->name))
+            paths.append(confFile->name);
+        if (!watched.contains(dir) && !paths.contains(dir) && QFileInfo(dir).isDir())
+            paths.append(dir);
+    }
+    if (!paths.isEmpty())
+        logWatcher->addPaths(paths);
+}
+
+void QConfFileSettingsPrivate::logFileChanged()
+{
+    QSettings *q = static_cast<QSettings *>(q_ptr);
+    watchLogFiles();
+    q->sync();
+
+    const int changes = logChanges();
+    if (changes != seenLogChanges) {
+        seenLogChanges = changes;
+        emit q->changed();
+    }
+}
+#endif // QSETTINGS_USE_FILESYSTEMWATCHER
+
 enum { Space = 0x1, Special = 0x2 };
 
 static const char charTraits[256] =
@@ -2426,6 +2874,12 @@ void QConfFileSettingsPrivate::ensureSectionParsed(QConfFile *confFile,
                             this works the same as specifying NativeFormat.
                             This enum value was added in Qt 5.7.
     \value IniFormat        Store the settings in INI files.
+    \value LogFormat        Store the settings in binary \c .conflog files to
+                            which sync() appends the changes, rather than
+                            rewriting the whole file. The files are compacted from time
+                            to time, and other processes can follow the
+                            changes with the changed() signal.
+                            This enum value was added in Qt 5.10.
     \value InvalidFormat    Special value returned by registerFormat().
     \omitvalue CustomFormat1
     \omitvalue CustomFormat2
@@ -3281,6 +3735,31 @@ bool QSettings::event(QEvent *event)
     }
     return QObject::event(event);
 }
+
+/*!
+    \reimp
+*/
+void QSettings::connectNotify(const QMetaMethod &signal)
+{
+    Q_D(QSettings);
+    if (signal == QMetaMethod::fromSignal(&QSettings::changed))
+        d->watchForChanges();
+}
+
+/*!
+    \fn void QSettings::changed()
+    \since 5.10
+
+    This signal is emitted when another process has changed the settings
+    stored in the files of this QSettings object. The new values are
+    already loaded when it is emitted.
+
+    Only LogFormat settings emit this signal. The files are watched from
+    the first connection to it on, so the QSettings object must live in
+    a thread that runs an event loop.
+
+    \sa sync()
+*/
 #endif
 
 /*!
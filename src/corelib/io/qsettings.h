@@ -93,6 +93,8 @@ public:
         Registry64Format,
 #endif
 
+        LogFormat = 4,
+
         InvalidFormat = 16,
         CustomFormat1,
         CustomFormat2,
@@ -195,9 +197,15 @@ public:
     static Format registerFormat(const QString &extension, ReadFunc readFunc, WriteFunc writeFunc,
                                  Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive);
 
+#ifndef QT_NO_QOBJECT
+Q_SIGNALS:
+    void changed();
+#endif
+
 protected:
 #ifndef QT_NO_QOBJECT
     bool event(QEvent *event) Q_DECL_OVERRIDE;
+    void connectNotify(const QMetaMethod &signal) Q_DECL_OVERRIDE;
 #endif
 
 private:
@@ -72,6 +72,10 @@ QT_BEGIN_NAMESPACE
 #define QT_QTSETTINGS_FORGET_ORIGINAL_KEY_ORDER
 #endif
 
+#if !defined(QT_NO_QOBJECT) && !defined(QT_BOOTSTRAPPED) && !defined(QT_NO_FILESYSTEMWATCHER)
+#define QSETTINGS_USE_FILESYSTEMWATCHER
+#endif
+
 // used in testing framework
 #define QSETTINGS_P_H_VERSION 3
 
@@ -154,6 +158,7 @@ public:
     ~QConfFile();
 
     ParsedSettingsMap mergedKeyMap() const;
+    bool pruneRedundantChanges(bool iniFormat);
     bool isWritable() const;
 
     static QConfFile *fromName(const QString &name, bool _userPerms);
@@ -170,6 +175,12 @@ public:
     QMutex mutex;
     bool userPerms;
 
+    // LogFormat only: what we know of the file on disk
+    quint64 logGeneration;
+    qint64 logSize;         // end of the last complete batch
+    int logRecordCount;
+    int logChanges;         // batches read that were written by someone else
+
 private:
 #ifdef Q_DISABLE_COPY
     QConfFile(const QConfFile &);
@@ -208,6 +219,7 @@ public:
     virtual void flush() = 0;
     virtual bool isWritable() const = 0;
     virtual QString fileName() const = 0;
+    virtual void watchForChanges();
 
     QString actualKey(const QString &key) const;
     void beginGroupOrArray(const QSettingsGroup &group);
@@ -252,6 +264,10 @@ protected:
     mutable QSettings::Status status;
 };
 
+#ifdef QSETTINGS_USE_FILESYSTEMWATCHER
+class QFileSystemWatcher;
+#endif
+
 class QConfFileSettingsPrivate : public QSettingsPrivate
 {
 public:
@@ -271,6 +287,9 @@ public:
     void flush() Q_DECL_OVERRIDE;
     bool isWritable() const Q_DECL_OVERRIDE;
     QString fileName() const Q_DECL_OVERRIDE;
+#ifdef QSETTINGS_USE_FILESYSTEMWATCHER
+    void watchForChanges() Q_DECL_OVERRIDE;
+#endif
 
     bool readIniFile(const QByteArray &data, UnparsedSettingsMap *unparsedIniSections);
     static bool readIniSection(const QSettingsKey &section, const QByteArray &data,
@@ -282,6 +301,12 @@ private:
     void initFormat();
     void initAccess();
     void syncConfFile(QConfFile *confFile);
+    void syncLogFile(QConfFile *confFile);
+#ifdef QSETTINGS_USE_FILESYSTEMWATCHER
+    void watchLogFiles();
+    void logFileChanged();
+    int logChanges() const;
+#endif
     bool writeIniFile(QIODevice &device, const ParsedSettingsMap &map);
 #ifdef Q_OS_MAC
     bool readPlistFile(const QByteArray &data, ParsedSettingsMap *map) const;
@@ -296,6 +321,10 @@ private:
     QString extension;
     Qt::CaseSensitivity caseSensitivity;
     int nextPosition;
+#ifdef QSETTINGS_USE_FILESYSTEMWATCHER
+    QFileSystemWatcher *logWatcher;
+    int seenLogChanges;
+#endif
 };
 
 QT_END_NAMESPACE
@@ -235,6 +235,7 @@ static const int QTEXTSTREAM_BUFFERSIZE = 16384;
 #include "private/qlocale_p.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <new>
 
@@ -484,6 +485,22 @@ bool QTextStreamPrivate::fillReadBuffer(qint64 maxBytes)
            qt_prettyDebug(buf, qMin(32,int(bytesRead)) , int(bytesRead)).constData(), int(sizeof(buf)), int(bytesRead));
 #endif
 
+    // In encodings where every character is made of whole bytes and '\r'
+    // is the byte 0x0d, a chunk without that byte decodes to text without
+    // carriage returns. Look for it in the raw data, which is much cheaper
+    // than looking at every decoded character.
+    bool mayContainCR = true;
+    if (textModeEnabled) {
+#ifndef QT_NO_TEXTCODEC
+        const int mib = codec ? codec->mibEnum() : 4;
+        const bool byteBasedCodec = mib == 106 || mib == 4 || mib == 3; // UTF-8, Latin-1, ASCII
+#else
+        const bool byteBasedCodec = true;
+#endif
+        if (byteBasedCodec)
+            mayContainCR = memchr(buf, '\r', bytesRead) != 0;
+    }
+
     int oldReadBufferSize = readBuffer.size();
 #ifndef QT_NO_TEXTCODEC
     // convert to unicode
@@ -494,20 +511,22 @@ bool QTextStreamPrivate::fillReadBuffer(qint64 maxBytes)
 #endif
 
     // remove all '\r\n' in the string.
-    if (readBuffer.size() > oldReadBufferSize && textModeEnabled) {
+    if (readBuffer.size() > oldReadBufferSize && textModeEnabled && mayContainCR) {
         QChar CR = QLatin1Char('\r');
         QChar *writePtr = readBuffer.data() + oldReadBufferSize;
         QChar *readPtr = readBuffer.data() + oldReadBufferSize;
         QChar *endPtr = readBuffer.data() + readBuffer.size();
 
         int n = oldReadBufferSize;
-        if (readPtr < endPtr) {
-            // Cut-off to avoid unnecessary self-copying.
-            while (*readPtr++ != CR) {
-                ++n;
-                if (++writePtr == endPtr)
-                    break;
-            }
+        // Cut-off to avoid unnecessary self-copying.
+        const int firstCR = QStringRef(&readBuffer, oldReadBufferSize,
+                                       readBuffer.size() - oldReadBufferSize).indexOf(CR);
+        if (firstCR == -1) {
+            readPtr = writePtr = endPtr;
+        } else {
+            n += firstCR;
+            writePtr += firstCR;
+            readPtr += firstCR;
         }
         while (readPtr < endPtr) {
             QChar ch = *readPtr++;
@@ -667,6 +686,33 @@ bool QTextStreamPrivate::scan(const QChar **ptr, int *length, int maxlen, TokenD
         }
         chPtr += startOffset;
 
+        if (delimiter == EndOfLine) {
+            // Let QStringRef::indexOf() find the line feed; unlike the
+            // loop below, it compares several characters at a time.
+            int scanLength = endOffset - startOffset;
+            if (maxlen)
+                scanLength = qMin(scanLength, maxlen - totalSize);
+            if (scanLength <= 0)
+                continue;
+
+            const QString *buffer = device ? &readBuffer : string;
+            const int lf = QStringRef(buffer, startOffset, scanLength).indexOf(QLatin1Char('\n'));
+            if (lf == -1) {
+                totalSize += scanLength;
+                startOffset += scanLength;
+                lastChar = chPtr[scanLength - 1];
+            } else {
+                const QChar previousChar = lf > 0 ? chPtr[lf - 1] : lastChar;
+                totalSize += lf + 1;
+                startOffset += lf + 1;
+                foundToken = true;
+                delimSize = (previousChar == QLatin1Char('\r')) ? 2 : 1;
+                consumeDelimiter = true;
+                lastChar = QLatin1Char('\n');
+            }
+            continue;
+        }
+
         for (; !foundToken && startOffset < endOffset && (!maxlen || totalSize < maxlen); ++startOffset) {
             const QChar ch = *chPtr++;
             ++totalSize;
@@ -4,14 +4,20 @@ HEADERS += \
     json/qjsonobject.h \
     json/qjsonvalue.h \
     json/qjsonarray.h \
+    json/qjsonbuilder.h \
     json/qjsonwriter_p.h \
-    json/qjsonparser_p.h
+    json/qjsonparser_p.h \
+    json/qjsonstream.h \
+    json/qcborstream.h
 
 SOURCES += \
     json/qjson.cpp \
     json/qjsondocument.cpp \
     json/qjsonobject.cpp \
     json/qjsonarray.cpp \
+    json/qjsonbuilder.cpp \
     json/qjsonvalue.cpp \
     json/qjsonwriter.cpp \
-    json/qjsonparser.cpp
+    json/qjsonparser.cpp \
+    json/qjsonstream.cpp \
+    json/qcborstream.cpp
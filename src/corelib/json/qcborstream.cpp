@@ -0,0 +1,2373 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcborstream.h"
+#include "qjson_p.h"
+#include "qjsonbuilder.h"
+#include "qjsondocument.h"
+
+#include <qcoreapplication.h>
+#include <qdatetime.h>
+#include <qendian.h>
+#include <qiodevice.h>
+#include <qlocale.h>
+#include <qnumeric.h>
+#include <qstringlist.h>
+#include <qurl.h>
+#include <quuid.h>
+#include <qvarlengtharray.h>
+#include <private/qutfcodec_p.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+static const int nestingLimit = 1024;
+static const int readChunkSize = 64 * 1024;
+static const int writeBufferSize = 64 * 1024;
+
+// strings have to fit into a QString after decoding
+static const quint64 maxStringSize = std::numeric_limits<int>::max() / 2;
+
+namespace {
+enum MajorType {
+    UnsignedIntegerType = 0,
+    NegativeIntegerType = 1,
+    ByteStringType = 2,
+    TextStringType = 3,
+    ArrayType = 4,
+    MapType = 5,
+    TagType = 6,
+    SimpleTypesType = 7
+};
+
+enum AdditionalInformation {
+    Value8Bit = 24,
+    Value16Bit = 25,
+    Value32Bit = 26,
+    Value64Bit = 27,
+    IndefiniteLength = 31,
+
+    FalseValue = 20,
+    TrueValue = 21,
+    NullValue = 22,
+    UndefinedValue = 23,
+    SimpleTypeInNextByte = 24,
+    HalfPrecisionFloat = 25,
+    SinglePrecisionFloat = 26,
+    DoublePrecisionFloat = 27
+};
+
+enum {
+    BreakByte = 0xff,
+    AdditionalInformationMask = 0x1f,
+    MajorTypeShift = 5
+};
+
+enum KnownTags {
+    DateTimeStringTag = 0,
+    UnixTimeTag = 1,
+    ExpectedBase64urlTag = 21,
+    ExpectedBase64Tag = 22,
+    ExpectedBase16Tag = 23,
+    UrlTag = 32,
+    UuidTag = 37
+};
+}
+
+#define CBORERR_OK          QT_TRANSLATE_NOOP("QCborStreamReader", "no error occurred")
+#define CBORERR_END         QT_TRANSLATE_NOOP("QCborStreamReader", "unexpected end of data")
+#define CBORERR_NUMBER      QT_TRANSLATE_NOOP("QCborStreamReader", "illegal number encoding")
+#define CBORERR_TYPE        QT_TRANSLATE_NOOP("QCborStreamReader", "illegal type")
+#define CBORERR_BREAK       QT_TRANSLATE_NOOP("QCborStreamReader", "unexpected break")
+#define CBORERR_UTF8        QT_TRANSLATE_NOOP("QCborStreamReader", "invalid UTF8 string")
+#define CBORERR_NESTING     QT_TRANSLATE_NOOP("QCborStreamReader", "too deeply nested")
+#define CBORERR_TOO_LARGE   QT_TRANSLATE_NOOP("QCborStreamReader", "data too large")
+
+/*
+    Decodes the argument of the item header at \a p into \a value. Returns
+    the first byte after the header, or \nullptr if the header is not
+    complete.
+*/
+static inline const uchar *decodeArgument(const uchar *p, const uchar *end, quint64 *value)
+{
+    const uint info = *p++ & AdditionalInformationMask;
+    switch (info) {
+    case Value8Bit:
+        if (end - p < 1)
+            return nullptr;
+        *value = *p;
+        return p + 1;
+    case Value16Bit:
+        if (end - p < 2)
+            return nullptr;
+        *value = qFromBigEndian<quint16>(p);
+        return p + 2;
+    case Value32Bit:
+        if (end - p < 4)
+            return nullptr;
+        *value = qFromBigEndian<quint32>(p);
+        return p + 4;
+    case Value64Bit:
+        if (end - p < 8)
+            return nullptr;
+        *value = qFromBigEndian<quint64>(p);
+        return p + 8;
+    default:
+        *value = info;
+        return p;
+    }
+}
+
+static inline double halfToDouble(quint16 bits)
+{
+    qfloat16 half;
+    memcpy(&half, &bits, sizeof(half));
+    return double(float(half));
+}
+
+class QCborStreamReaderPrivate
+{
+public:
+    struct Container {
+        // items still expected in a container of known length; items read
+        // so far in one of unknown length. Map keys and values count
+        // separately.
+        quint64 count;
+        bool isMap;
+        bool lengthKnown;
+    };
+
+    enum Result {
+        Done,
+        NeedMoreData,
+        Failed
+    };
+
+    QCborStreamReaderPrivate()
+        : device(nullptr), pos(0), pendingSkip(0), discarded(0), afterTag(false),
+          type(QCborStreamReader::NoToken), value(0), lengthKnown(false),
+          error(QCborStreamReader::NoError), errorIsRecoverable(false), exhausted(false),
+          jsonTooLarge(false)
+    {}
+
+    QCborStreamReader::TokenType readNext();
+    Result scanToken();
+    Result scanString(const uchar *p, const uchar *end, int major, uint info, quint64 length);
+    bool fetchMoreData();
+    void discardConsumedData();
+    void itemRead();
+    void endContainer();
+    template <typename Chunk> bool forEachChunk(Chunk chunk) const;
+
+    double toDouble() const;
+    QString readString();
+    QByteArray readByteArray() const;
+
+    QJsonValue readJsonValue();
+    QString readJsonKey();
+    bool writeJsonContainer(QByteArray &json);
+    bool writeJsonValue(QByteArray &json, QJsonPrivate::Value *v, int baseOffset);
+    bool writeJsonString(QByteArray &json, bool *latin1);
+    void writeJsonString(QByteArray &json, const QString &string, bool *latin1);
+
+    inline Result fail(QCborStreamReader::Error e)
+    {
+        error = e;
+        errorIsRecoverable = false;
+        return Failed;
+    }
+
+    inline const uchar *data() const
+    { return reinterpret_cast<const uchar *>(buffer.constData()); }
+
+    QIODevice *device;
+    QByteArray buffer;
+    int pos;
+    int pendingSkip;
+    qint64 discarded;
+    QVarLengthArray<Container, 64> stack;
+    bool afterTag;
+
+    QCborStreamReader::TokenType type;
+    quint64 value;
+    bool lengthKnown;
+
+    QCborStreamReader::Error error;
+    bool errorIsRecoverable;
+    bool exhausted;
+    bool jsonTooLarge;
+};
+
+void QCborStreamReaderPrivate::discardConsumedData()
+{
+    if (pos == 0)
+        return;
+    if (pos == buffer.size())
+        buffer.clear();
+    else
+        buffer.remove(0, pos);
+    discarded += pos;
+    pos = 0;
+}
+
+bool QCborStreamReaderPrivate::fetchMoreData()
+{
+    if (!device)
+        return false;
+    discardConsumedData();
+    const int oldSize = buffer.size();
+    buffer.resize(oldSize + readChunkSize);
+    const qint64 bytesRead = device->read(buffer.data() + oldSize, readChunkSize);
+    buffer.resize(oldSize + int(qMax(bytesRead, qint64(0))));
+    return bytesRead > 0;
+}
+
+void QCborStreamReaderPrivate::itemRead()
+{
+    afterTag = false;
+    if (stack.isEmpty())
+        return;
+    Container &c = stack.last();
+    if (c.lengthKnown)
+        --c.count;
+    else
+        ++c.count;
+}
+
+void QCborStreamReaderPrivate::endContainer()
+{
+    type = stack.last().isMap ? QCborStreamReader::EndMap : QCborStreamReader::EndArray;
+    stack.removeLast();
+}
+
+/*
+    Calls \a chunk for each piece of the current string, which starts at
+    the read position and spans pendingSkip bytes.
+*/
+template <typename Chunk>
+bool QCborStreamReaderPrivate::forEachChunk(Chunk chunk) const
+{
+    const uchar *p = data() + pos;
+    if (lengthKnown)
+        return chunk(p, int(value));
+
+    const uchar *const end = p + pendingSkip - 1;   // without the break
+    while (p < end) {
+        quint64 length = 0;
+        p = decodeArgument(p, end, &length);
+        if (!chunk(p, int(length)))
+            return false;
+        p += length;
+    }
+    return true;
+}
+
+/*
+    Checks that the complete string, including all chunks of a string of
+    unknown length, is in the buffer. The string data itself is skipped
+    only by the next call to readNext(), so that it can be decoded on
+    demand.
+*/
+QCborStreamReaderPrivate::Result
+QCborStreamReaderPrivate::scanString(const uchar *p, const uchar *end, int major, uint info,
+                                     quint64 length)
+{
+    if (info != IndefiniteLength) {
+        if (length > maxStringSize)
+            return fail(QCborStreamReader::DataTooLarge);
+        if (quint64(end - p) < length)
+            return NeedMoreData;
+        lengthKnown = true;
+        value = length;
+        pendingSkip = int(length);
+        return Done;
+    }
+
+    const uchar *chunk = p;
+    quint64 total = 0;
+    while (true) {
+        if (chunk == end)
+            return NeedMoreData;
+        if (*chunk == BreakByte)
+            break;
+        if ((*chunk >> MajorTypeShift) != major
+                || (*chunk & AdditionalInformationMask) == IndefiniteLength)
+            return fail(QCborStreamReader::IllegalType);
+        if ((*chunk & AdditionalInformationMask) > Value64Bit)
+            return fail(QCborStreamReader::IllegalNumber);
+        quint64 chunkLength = 0;
+        chunk = decodeArgument(chunk, end, &chunkLength);
+        if (!chunk)
+            return NeedMoreData;
+        if (chunkLength > maxStringSize - total)
+            return fail(QCborStreamReader::DataTooLarge);
+        if (quint64(end - chunk) < chunkLength)
+            return NeedMoreData;
+        chunk += chunkLength;
+        total += chunkLength;
+    }
+    lengthKnown = false;
+    value = total;
+    pendingSkip = int(chunk + 1 - p);
+    return Done;
+}
+
+/*
+    Scans the next item header. The read position is only advanced past
+    complete items, so an item can be rescanned once more data is
+    available.
+*/
+QCborStreamReaderPrivate::Result QCborStreamReaderPrivate::scanToken()
+{
+    if (!stack.isEmpty() && stack.last().lengthKnown && stack.last().count == 0) {
+        endContainer();
+        return Done;
+    }
+
+    const uchar *const end = data() + buffer.size();
+    const uchar *p = data() + pos;
+    if (p == end)
+        return NeedMoreData;
+
+    if (*p == BreakByte) {
+        if (stack.isEmpty() || stack.last().lengthKnown || afterTag)
+            return fail(QCborStreamReader::UnexpectedBreak);
+        if (stack.last().isMap && stack.last().count % 2)
+            return fail(QCborStreamReader::UnexpectedBreak);
+        ++pos;
+        endContainer();
+        return Done;
+    }
+
+    const int major = *p >> MajorTypeShift;
+    const uint info = *p & AdditionalInformationMask;
+    if (info > Value64Bit && info < IndefiniteLength)
+        return fail(QCborStreamReader::IllegalNumber);
+    if (info == IndefiniteLength && major != ByteStringType && major != TextStringType
+            && major != ArrayType && major != MapType)
+        return fail(QCborStreamReader::IllegalNumber);
+
+    quint64 argument;
+    const uchar *const payload = decodeArgument(p, end, &argument);
+    if (!payload)
+        return NeedMoreData;
+
+    switch (major) {
+    case UnsignedIntegerType:
+    case NegativeIntegerType:
+        type = major == UnsignedIntegerType ? QCborStreamReader::UnsignedInteger
+                                            : QCborStreamReader::NegativeInteger;
+        value = argument;
+        break;
+
+    case ByteStringType:
+    case TextStringType: {
+        const Result result = scanString(payload, end, major, info, argument);
+        if (result != Done)
+            return result;
+        type = major == ByteStringType ? QCborStreamReader::ByteString
+                                       : QCborStreamReader::TextString;
+        break;
+    }
+
+    case ArrayType:
+    case MapType: {
+        if (stack.size() >= nestingLimit)
+            return fail(QCborStreamReader::NestingTooDeep);
+        if (major == MapType && info != IndefiniteLength
+                && argument > std::numeric_limits<quint64>::max() / 2)
+            return fail(QCborStreamReader::DataTooLarge);
+        itemRead();
+        Container c;
+        c.isMap = major == MapType;
+        c.lengthKnown = info != IndefiniteLength;
+        c.count = c.lengthKnown ? (c.isMap ? 2 * argument : argument) : 0;
+        stack.append(c);
+        type = c.isMap ? QCborStreamReader::StartMap : QCborStreamReader::StartArray;
+        lengthKnown = c.lengthKnown;
+        value = c.lengthKnown ? argument : 0;
+        pos = int(payload - data());
+        return Done;
+    }
+
+    case TagType:
+        type = QCborStreamReader::Tag;
+        value = argument;
+        afterTag = true;
+        pos = int(payload - data());
+        return Done;
+
+    case SimpleTypesType:
+        switch (info) {
+        case FalseValue:
+        case TrueValue:
+            type = QCborStreamReader::Bool;
+            value = info == TrueValue;
+            break;
+        case NullValue:
+            type = QCborStreamReader::Null;
+            break;
+        case UndefinedValue:
+            type = QCborStreamReader::Undefined;
+            break;
+        case SimpleTypeInNextByte:
+            // values below 32 must use the short form
+            if (argument < 32)
+                return fail(QCborStreamReader::IllegalType);
+            type = QCborStreamReader::SimpleType;
+            value = argument;
+            break;
+        case HalfPrecisionFloat:
+            type = QCborStreamReader::HalfFloat;
+            value = argument;
+            break;
+        case SinglePrecisionFloat:
+            type = QCborStreamReader::Float;
+            value = argument;
+            break;
+        case DoublePrecisionFloat:
+            type = QCborStreamReader::Double;
+            value = argument;
+            break;
+        default:
+            type = QCborStreamReader::SimpleType;
+            value = argument;
+            break;
+        }
+        break;
+    }
+
+    pos = int(payload - data());
+    itemRead();
+    return Done;
+}
+
+QCborStreamReader::TokenType QCborStreamReaderPrivate::readNext()
+{
+    if (error != QCborStreamReader::NoError) {
+        if (!errorIsRecoverable)
+            return type;
+        error = QCborStreamReader::NoError;
+        errorIsRecoverable = false;
+    }
+
+    pos += pendingSkip;
+    pendingSkip = 0;
+    value = 0;
+    lengthKnown = false;
+
+    while (true) {
+        const Result result = scanToken();
+        if (result == Done) {
+            exhausted = false;
+            return type;
+        }
+        if (result == Failed) {
+            type = QCborStreamReader::Invalid;
+            return type;
+        }
+        if (!fetchMoreData())
+            break;
+    }
+
+    discardConsumedData();
+    if (stack.isEmpty() && !afterTag && buffer.isEmpty()) {
+        // between two items, so there is nothing to complain about
+        exhausted = true;
+        type = QCborStreamReader::NoToken;
+        return type;
+    }
+
+    error = QCborStreamReader::UnexpectedEnd;
+    errorIsRecoverable = true;
+    type = QCborStreamReader::Invalid;
+    return type;
+}
+
+double QCborStreamReaderPrivate::toDouble() const
+{
+    switch (type) {
+    case QCborStreamReader::UnsignedInteger:
+        return double(value);
+    case QCborStreamReader::NegativeInteger:
+        return -1. - double(value);
+    case QCborStreamReader::HalfFloat:
+        return halfToDouble(quint16(value));
+    case QCborStreamReader::Float: {
+        const quint32 bits = quint32(value);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return double(f);
+    }
+    case QCborStreamReader::Double: {
+        double d;
+        memcpy(&d, &value, sizeof(d));
+        return d;
+    }
+    default:
+        return 0;
+    }
+}
+
+QString QCborStreamReaderPrivate::readString()
+{
+    if (type != QCborStreamReader::TextString)
+        return QString();
+
+    QString result;
+    if (!lengthKnown)
+        result.reserve(int(value));
+    const bool ok = forEachChunk([&result](const uchar *p, int length) {
+        QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+        const QString chunk = QUtf8::convertToUnicode(reinterpret_cast<const char *>(p), length, &state);
+        if (state.invalidChars || state.remainingChars)
+            return false;
+        if (result.isNull())
+            result = chunk;
+        else
+            result += chunk;
+        return true;
+    });
+    if (!ok) {
+        fail(QCborStreamReader::InvalidUtf8String);
+        type = QCborStreamReader::Invalid;
+        return QString();
+    }
+    if (result.isNull())
+        result = QLatin1String("");
+    return result;
+}
+
+QByteArray QCborStreamReaderPrivate::readByteArray() const
+{
+    if (type != QCborStreamReader::ByteString && type != QCborStreamReader::TextString)
+        return QByteArray();
+
+    QByteArray result;
+    result.reserve(int(value));
+    forEachChunk([&result](const uchar *p, int length) {
+        result.append(reinterpret_cast<const char *>(p), length);
+        return true;
+    });
+    return result;
+}
+
+QJsonValue QCborStreamReaderPrivate::readJsonValue()
+{
+    switch (type) {
+    case QCborStreamReader::UnsignedInteger:
+    case QCborStreamReader::NegativeInteger:
+    case QCborStreamReader::HalfFloat:
+    case QCborStreamReader::Float:
+    case QCborStreamReader::Double:
+        return toDouble();
+    case QCborStreamReader::Bool:
+        return bool(value);
+    case QCborStreamReader::Null:
+    case QCborStreamReader::Undefined:
+    case QCborStreamReader::SimpleType:
+        return QJsonValue(QJsonValue::Null);
+    case QCborStreamReader::TextString: {
+        const QString string = readString();
+        if (error != QCborStreamReader::NoError)
+            return QJsonValue(QJsonValue::Undefined);
+        return string;
+    }
+    case QCborStreamReader::ByteString:
+        return QString::fromLatin1(readByteArray().toBase64(QByteArray::Base64UrlEncoding
+                                                            | QByteArray::OmitTrailingEquals));
+    case QCborStreamReader::Tag: {
+        // only the innermost of a chain of tags is used; walk the chain
+        // here instead of recursing once per tag
+        quint64 tag;
+        do {
+            tag = value;
+            if (readNext() == QCborStreamReader::Invalid)
+                return QJsonValue(QJsonValue::Undefined);
+        } while (type == QCborStreamReader::Tag);
+        if (type == QCborStreamReader::ByteString && tag == ExpectedBase64Tag)
+            return QString::fromLatin1(readByteArray().toBase64());
+        if (type == QCborStreamReader::ByteString && tag == ExpectedBase16Tag)
+            return QString::fromLatin1(readByteArray().toHex());
+        return readJsonValue();
+    }
+    case QCborStreamReader::StartArray:
+    case QCborStreamReader::StartMap: {
+        // Write the binary JSON format directly, like QJsonDocument::fromJson()
+        // does, instead of building nested QJsonValues that would be copied
+        // into their parents again.
+        const bool isObject = type == QCborStreamReader::StartMap;
+        QByteArray json;
+        json.reserve(256);
+        json.resize(sizeof(QJsonPrivate::Header));
+        QJsonPrivate::Header *h = reinterpret_cast<QJsonPrivate::Header *>(json.data());
+        h->tag = QJsonDocument::BinaryFormatTag;
+        h->version = 1u;
+        // a map key that is a container reads a document of its own while
+        // the outer one is being written
+        const bool outerTooLarge = jsonTooLarge;
+        jsonTooLarge = false;
+        const bool ok = writeJsonContainer(json);
+        const bool tooLarge = jsonTooLarge;
+        jsonTooLarge = outerTooLarge;
+        if (!ok)
+            return QJsonValue(QJsonValue::Undefined);
+        if (tooLarge) {
+            qWarning("QJson: Document too large to store in data structure");
+            return QJsonValue(QJsonValue::Undefined);
+        }
+        const QJsonDocument document =
+                QJsonDocument::fromBinaryData(json, QJsonDocument::BypassValidation);
+        if (isObject)
+            return document.object();
+        return document.array();
+    }
+    default:
+        return QJsonValue(QJsonValue::Undefined);
+    }
+}
+
+/*
+    Returns the current map key as a string. Keys that are not text
+    strings are converted to their JSON representation.
+*/
+QString QCborStreamReaderPrivate::readJsonKey()
+{
+    switch (type) {
+    case QCborStreamReader::TextString:
+        return readString();
+    case QCborStreamReader::UnsignedInteger:
+        return QString::number(value);
+    case QCborStreamReader::NegativeInteger:
+        if (value <= quint64(std::numeric_limits<qint64>::max()))
+            return QString::number(-1 - qint64(value));
+        break;
+    default:
+        break;
+    }
+
+    const QJsonValue key = readJsonValue();
+    switch (key.type()) {
+    case QJsonValue::String:
+        return key.toString();
+    case QJsonValue::Double:
+        return QString::number(key.toDouble(), 'g', QLocale::FloatingPointShortest);
+    case QJsonValue::Bool:
+        return key.toBool() ? QStringLiteral("true") : QStringLiteral("false");
+    case QJsonValue::Array:
+        return QString::fromUtf8(QJsonDocument(key.toArray()).toJson(QJsonDocument::Compact));
+    case QJsonValue::Object:
+        return QString::fromUtf8(QJsonDocument(key.toObject()).toJson(QJsonDocument::Compact));
+    default:
+        return QStringLiteral("null");
+    }
+}
+
+/*
+    Writes the array or map starting at the current token in the binary
+    JSON format, see qjson_p.h. Returns \c false if reading fails.
+*/
+bool QCborStreamReaderPrivate::writeJsonContainer(QByteArray &json)
+{
+    const bool isObject = type == QCborStreamReader::StartMap;
+    const int baseOffset = json.size();
+    json.resize(baseOffset + int(sizeof(QJsonPrivate::Base)));
+
+    QVarLengthArray<QJsonPrivate::Value, 64> values;   // for arrays
+    QVarLengthArray<uint, 64> offsets;                 // for objects
+    const QCborStreamReader::TokenType endToken = isObject ? QCborStreamReader::EndMap
+                                                           : QCborStreamReader::EndArray;
+    while (readNext() != endToken) {
+        if (type == QCborStreamReader::Invalid)
+            return false;
+
+        QJsonPrivate::Value v;
+        if (!isObject) {
+            if (!writeJsonValue(json, &v, baseOffset))
+                return false;
+            values.append(v);
+            continue;
+        }
+
+        const int entryOffset = json.size();
+        json.resize(entryOffset + int(sizeof(QJsonPrivate::Entry)));
+        bool latinKey;
+        if (type == QCborStreamReader::TextString) {
+            if (!writeJsonString(json, &latinKey))
+                return false;
+        } else {
+            const QString key = readJsonKey();
+            if (error != QCborStreamReader::NoError)
+                return false;
+            writeJsonString(json, key, &latinKey);
+        }
+        if (readNext() == QCborStreamReader::Invalid)
+            return false;
+        if (!writeJsonValue(json, &v, baseOffset))
+            return false;
+        v.latinKey = latinKey;
+        reinterpret_cast<QJsonPrivate::Entry *>(json.data() + entryOffset)->value = v;
+
+        offsets.append(uint(entryOffset - baseOffset));
+    }
+
+    if (isObject) {
+        // sort the table by key once all entries are known; of the entries
+        // with the same key, the last one wins
+        const char *const base = json.constData() + baseOffset;
+        const auto entryAt = [base](uint offset) {
+            return reinterpret_cast<const QJsonPrivate::Entry *>(base + offset);
+        };
+        std::stable_sort(offsets.begin(), offsets.end(), [&entryAt](uint lhs, uint rhs) {
+            return !(*entryAt(lhs) >= *entryAt(rhs));
+        });
+        int unique = 0;
+        for (int i = 0; i < offsets.size(); ++i) {
+            if (i + 1 < offsets.size() && *entryAt(offsets.at(i)) == *entryAt(offsets.at(i + 1)))
+                continue;
+            offsets[unique++] = offsets.at(i);
+        }
+        offsets.resize(unique);
+    }
+
+    const int length = isObject ? offsets.size() : values.size();
+    const int tableOffset = json.size();
+    if (isObject) {
+        json.resize(tableOffset + length * int(sizeof(QJsonPrivate::offset)));
+        QJsonPrivate::offset *table = reinterpret_cast<QJsonPrivate::offset *>(json.data() + tableOffset);
+        for (int i = 0; i < length; ++i)
+            table[i] = offsets[i];
+    } else if (length) {
+        json.resize(tableOffset + length * int(sizeof(QJsonPrivate::Value)));
+        memcpy(json.data() + tableOffset, values.constData(), length * sizeof(QJsonPrivate::Value));
+    }
+
+    QJsonPrivate::Base *b = reinterpret_cast<QJsonPrivate::Base *>(json.data() + baseOffset);
+    b->size = json.size() - baseOffset;
+    b->_dummy = 0;
+    b->is_object = isObject;
+    b->length = length;
+    b->tableOffset = length ? tableOffset - baseOffset : 0;
+    return true;
+}
+
+/*
+    Writes the data of the item at the current token and fills in \a v,
+    with offsets relative to the array or object at \a baseOffset.
+*/
+bool QCborStreamReaderPrivate::writeJsonValue(QByteArray &json, QJsonPrivate::Value *v, int baseOffset)
+{
+    v->_dummy = 0;
+    const int offset = json.size() - baseOffset;
+    if (offset >= QJsonPrivate::Value::MaxSize)
+        jsonTooLarge = true;
+
+    bool latin1;
+    switch (type) {
+    case QCborStreamReader::UnsignedInteger:
+    case QCborStreamReader::NegativeInteger:
+    case QCborStreamReader::HalfFloat:
+    case QCborStreamReader::Float:
+    case QCborStreamReader::Double: {
+        const double d = toDouble();
+        v->type = QJsonValue::Double;
+        const int compressed = QJsonPrivate::compressedNumber(d);
+        if (compressed != INT_MAX) {
+            v->latinOrIntValue = true;
+            v->int_value = compressed;
+        } else {
+            quint64 bits;
+            memcpy(&bits, &d, sizeof(bits));
+            json.resize(json.size() + int(sizeof(bits)));
+            qToLittleEndian(bits, json.data() + baseOffset + offset);
+            v->value = offset;
+        }
+        return true;
+    }
+    case QCborStreamReader::Bool:
+        v->type = QJsonValue::Bool;
+        v->value = uint(value);
+        return true;
+    case QCborStreamReader::Null:
+    case QCborStreamReader::Undefined:
+    case QCborStreamReader::SimpleType:
+        v->type = QJsonValue::Null;
+        return true;
+    case QCborStreamReader::TextString:
+        if (!writeJsonString(json, &latin1))
+            return false;
+        v->type = QJsonValue::String;
+        v->latinOrIntValue = latin1;
+        v->value = offset;
+        return true;
+    case QCborStreamReader::ByteString:
+        writeJsonString(json, readJsonValue().toString(), &latin1);
+        v->type = QJsonValue::String;
+        v->latinOrIntValue = latin1;
+        v->value = offset;
+        return true;
+    case QCborStreamReader::Tag: {
+        quint64 tag;
+        do {
+            tag = value;
+            if (readNext() == QCborStreamReader::Invalid)
+                return false;
+        } while (type == QCborStreamReader::Tag);
+        if (type == QCborStreamReader::ByteString
+                && (tag == ExpectedBase64Tag || tag == ExpectedBase16Tag)) {
+            const QByteArray bytes = readByteArray();
+            writeJsonString(json, QString::fromLatin1(tag == ExpectedBase64Tag ? bytes.toBase64()
+                                                                               : bytes.toHex()),
+                            &latin1);
+            v->type = QJsonValue::String;
+            v->latinOrIntValue = latin1;
+            v->value = offset;
+            return true;
+        }
+        return writeJsonValue(json, v, baseOffset);
+    }
+    case QCborStreamReader::StartArray:
+    case QCborStreamReader::StartMap:
+        v->type = type == QCborStreamReader::StartMap ? QJsonValue::Object : QJsonValue::Array;
+        v->value = offset;
+        return writeJsonContainer(json);
+    default:
+        return false;
+    }
+}
+
+/*
+    Writes the current text string in the binary JSON format. ASCII
+    strings are copied as they are, all others are decoded first.
+*/
+bool QCborStreamReaderPrivate::writeJsonString(QByteArray &json, bool *latin1)
+{
+    bool ascii = value < 0x8000;
+    if (ascii) {
+        forEachChunk([&ascii](const uchar *p, int length) {
+            uchar bits = 0;
+            for (int i = 0; i < length; ++i)
+                bits |= p[i];
+            ascii = bits < 0x80;
+            return ascii;
+        });
+    }
+    if (!ascii) {
+        const QString string = readString();
+        if (error != QCborStreamReader::NoError)
+            return false;
+        writeJsonString(json, string, latin1);
+        return true;
+    }
+
+    const int pos = json.size();
+    json.resize(pos + QJsonPrivate::alignedSize(int(sizeof(ushort) + value)));
+    char *out = json.data() + pos;
+    *reinterpret_cast<QJsonPrivate::qle_ushort *>(out) = ushort(value);
+    out += sizeof(ushort);
+    forEachChunk([&out](const uchar *p, int length) {
+        memcpy(out, p, length);
+        out += length;
+        return true;
+    });
+    memset(out, 0, json.size() - (out - json.constData()));
+    *latin1 = true;
+    return true;
+}
+
+void QCborStreamReaderPrivate::writeJsonString(QByteArray &json, const QString &string, bool *latin1)
+{
+    *latin1 = QJsonPrivate::useCompressed(string);
+    const int pos = json.size();
+    const int size = QJsonPrivate::qStringSize(string, *latin1);
+    json.resize(pos + size);
+    memset(json.data() + pos, 0, size);
+    QJsonPrivate::copyString(json.data() + pos, string, *latin1);
+}
+
+/*!
+    \class QCborStreamReader
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.10
+
+    \brief The QCborStreamReader class provides a pull parser for the
+    Concise Binary Object Representation (CBOR).
+
+    CBOR, specified in \l{RFC 7049}, is a binary data format with a data
+    model that is a superset of JSON. It is more compact than JSON text and
+    much cheaper to decode: numbers are stored in binary and strings are
+    prefixed with their length, so nothing has to be escaped or scanned
+    for delimiters.
+
+    QCborStreamReader reports the items of a CBOR stream one at a time. It
+    has the same structure as QJsonStreamReader: it reads from a QIODevice
+    set with setDevice(), or from data supplied in chunks with addData(),
+    and readNext() is called in a loop:
+
+    \snippet code/src_corelib_json_qcborstream.cpp 0
+
+    Integers, floating point numbers, booleans and other simple values are
+    decoded into the reader itself, so retrieving them with toInteger(),
+    toUnsignedInteger(), toDouble() or toBool() never allocates memory.
+    Strings are only decoded when readString() or readByteArray() is
+    called, so strings that are not needed cost nothing but the time to
+    skip them.
+
+    Arrays start with a StartArray token, followed by their elements, and
+    end with an EndArray token. Maps start with StartMap and end with
+    EndMap; in between, each key is followed by its value. In CBOR, map
+    keys can be of any type. A Tag token adds semantics to the item that
+    follows it, like marking a string as a date and time.
+
+    readJsonValue() and readVariant() read a complete item, including
+    nested arrays and maps, and convert it to a QJsonValue or a QVariant.
+    QCborStreamWriter::appendJsonValue() and
+    QCborStreamWriter::appendVariant() perform the opposite conversion.
+
+    The reader accepts any number of top-level items one after the other,
+    so a connection can carry a sequence of messages. If the input ends in
+    the middle of an item, readNext() returns Invalid and error() returns
+    UnexpectedEnd. Such an error is not final: once more data is
+    available, either through addData() or because the device has
+    received more data, the next call to readNext() continues where the
+    reader stopped. All other errors are final.
+
+    \sa QCborStreamWriter, QJsonStreamReader
+*/
+
+/*!
+    \enum QCborStreamReader::TokenType
+
+    This enum specifies the type of token the reader just read.
+
+    \value NoToken The reader has not yet read anything, or has read all
+    available items.
+    \value Invalid An error has occurred, reported in error() and
+    errorString().
+    \value UnsignedInteger A non-negative integer, available from
+    toUnsignedInteger() and toInteger().
+    \value NegativeInteger A negative integer, available from toInteger().
+    \value ByteString A string of bytes, available from readByteArray().
+    \value TextString A UTF-8 string, available from readString().
+    \value StartArray The start of an array.
+    \value EndArray The end of an array.
+    \value StartMap The start of a map.
+    \value EndMap The end of a map.
+    \value Tag A tag for the next item, available from toTag().
+    \value SimpleType A simple type without a predefined meaning, available
+    from toSimpleType().
+    \value Bool The simple types \c false and \c true, available from
+    toBool().
+    \value Null The simple type \c null.
+    \value Undefined The simple type \c undefined.
+    \value HalfFloat A 16-bit floating point number, available from
+    toFloat() and toDouble().
+    \value Float A 32-bit floating point number, available from toFloat()
+    and toDouble().
+    \value Double A 64-bit floating point number, available from
+    toDouble().
+*/
+
+/*!
+    \enum QCborStreamReader::Error
+
+    This enum specifies the error the reader encountered.
+
+    \value NoError No error occurred.
+    \value UnexpectedEnd The data ended in the middle of an item. Reading
+    can continue once more data is available.
+    \value IllegalNumber An item header uses a reserved encoding.
+    \value IllegalType An item is of a type that is not allowed in its
+    position, like an integer inside a byte string of unknown length.
+    \value UnexpectedBreak A break marker appeared outside of an array or
+    map of unknown length, or between a map key and its value.
+    \value InvalidUtf8String A text string is not valid UTF-8.
+    \value NestingTooDeep Arrays and maps are nested more than 1024 levels
+    deep.
+    \value DataTooLarge A string or map is too large to be represented.
+*/
+
+/*!
+    Constructs a stream reader.
+
+    \sa setDevice(), addData()
+*/
+QCborStreamReader::QCborStreamReader()
+    : d_ptr(new QCborStreamReaderPrivate)
+{
+}
+
+/*!
+    Creates a new stream reader that reads from \a device.
+*/
+QCborStreamReader::QCborStreamReader(QIODevice *device)
+    : d_ptr(new QCborStreamReaderPrivate)
+{
+    setDevice(device);
+}
+
+/*!
+    Creates a new stream reader that reads from \a data.
+
+    \sa addData()
+*/
+QCborStreamReader::QCborStreamReader(const QByteArray &data)
+    : d_ptr(new QCborStreamReaderPrivate)
+{
+    d_ptr->buffer = data;
+}
+
+/*!
+    Destructs the reader.
+*/
+QCborStreamReader::~QCborStreamReader()
+{
+}
+
+/*!
+    Sets the current device to \a device. Setting the device resets the
+    reader to its initial state.
+
+    \sa device(), clear()
+*/
+void QCborStreamReader::setDevice(QIODevice *device)
+{
+    clear();
+    d_ptr->device = device;
+}
+
+/*!
+    Returns the current device associated with the reader, or \nullptr if
+    no device has been assigned.
+
+    \sa setDevice()
+*/
+QIODevice *QCborStreamReader::device() const
+{
+    Q_D(const QCborStreamReader);
+    return d->device;
+}
+
+/*!
+    Adds more \a data for the reader to read. This function does nothing
+    if the reader has a device().
+
+    \sa readNext(), clear()
+*/
+void QCborStreamReader::addData(const QByteArray &data)
+{
+    Q_D(QCborStreamReader);
+    if (d->device) {
+        qWarning("QCborStreamReader: addData() with device()");
+        return;
+    }
+    d->discardConsumedData();
+    d->buffer += data;
+    d->exhausted = false;
+}
+
+/*!
+    Removes any device() or data from the reader and resets its internal
+    state to the initial state.
+
+    \sa addData()
+*/
+void QCborStreamReader::clear()
+{
+    d_ptr.reset(new QCborStreamReaderPrivate);
+}
+
+/*!
+    Returns \c true if the reader has read all available items, or if an
+    error() has occurred. Otherwise, it returns \c false.
+
+    \sa hasError(), readNext()
+*/
+bool QCborStreamReader::atEnd() const
+{
+    Q_D(const QCborStreamReader);
+    return d->exhausted || d->error != NoError;
+}
+
+/*!
+    Reads the next token and returns its type.
+
+    If the reader has no more input but is between two top-level items,
+    NoToken is returned and atEnd() becomes \c true. If the input ends
+    inside an item, Invalid is returned; see the class documentation for
+    how to continue once more data is available.
+
+    \sa tokenType(), tokenString()
+*/
+QCborStreamReader::TokenType QCborStreamReader::readNext()
+{
+    Q_D(QCborStreamReader);
+    return d->readNext();
+}
+
+/*!
+    Returns the type of the current token.
+
+    \sa tokenString()
+*/
+QCborStreamReader::TokenType QCborStreamReader::tokenType() const
+{
+    Q_D(const QCborStreamReader);
+    return d->type;
+}
+
+/*!
+    Returns the reader's current token as a string.
+
+    \sa tokenType()
+*/
+QString QCborStreamReader::tokenString() const
+{
+    static const char *const tokenNames[] = {
+        "NoToken", "Invalid", "UnsignedInteger", "NegativeInteger",
+        "ByteString", "TextString", "StartArray", "EndArray", "StartMap",
+        "EndMap", "Tag", "SimpleType", "Bool", "Null", "Undefined",
+        "HalfFloat", "Float", "Double"
+    };
+    return QLatin1String(tokenNames[tokenType()]);
+}
+
+/*!
+    Returns \c true if the length of the current string, array or map is
+    encoded in the stream, and \c false for strings, arrays and maps of
+    unknown length and for all other tokens.
+
+    \sa length()
+*/
+bool QCborStreamReader::isLengthKnown() const
+{
+    Q_D(const QCborStreamReader);
+    return d->lengthKnown;
+}
+
+/*!
+    Returns the length of the current string, array or map if
+    isLengthKnown() is \c true. For strings, the length is in bytes; for
+    maps, it is the number of key-value pairs. For strings of unknown
+    length, the sum of the lengths of all chunks is returned. Otherwise,
+    this function returns 0.
+*/
+quint64 QCborStreamReader::length() const
+{
+    Q_D(const QCborStreamReader);
+    switch (d->type) {
+    case ByteString:
+    case TextString:
+    case StartArray:
+    case StartMap:
+        return d->value;
+    default:
+        return 0;
+    }
+}
+
+/*!
+    Returns the value of an UnsignedInteger token. For a NegativeInteger
+    token, the returned value \c n represents the integer \c{-1 - n},
+    which allows integers down to -2\sup{64} to be represented. For all
+    other tokens, 0 is returned.
+
+    \sa toInteger()
+*/
+quint64 QCborStreamReader::toUnsignedInteger() const
+{
+    Q_D(const QCborStreamReader);
+    return isInteger() ? d->value : 0;
+}
+
+/*!
+    Returns the value of an UnsignedInteger or NegativeInteger token. If
+    \a ok is not \nullptr, \c{*ok} is set to \c true if the value fits
+    into a qint64, and to \c false otherwise. If it does not fit, or for
+    other tokens, 0 is returned.
+
+    \sa toUnsignedInteger(), toDouble()
+*/
+qint64 QCborStreamReader::toInteger(bool *ok) const
+{
+    Q_D(const QCborStreamReader);
+    const bool fits = isInteger() && d->value <= quint64(std::numeric_limits<qint64>::max());
+    if (ok)
+        *ok = fits;
+    if (!fits)
+        return 0;
+    return d->type == UnsignedInteger ? qint64(d->value) : -1 - qint64(d->value);
+}
+
+/*!
+    Returns the value of a HalfFloat, Float or Double token. Integers are
+    converted to double, which loses precision for values above
+    2\sup{53}. For all other tokens, 0 is returned.
+
+    \sa toFloat(), toInteger()
+*/
+double QCborStreamReader::toDouble() const
+{
+    Q_D(const QCborStreamReader);
+    return d->toDouble();
+}
+
+/*!
+    Returns the value of a HalfFloat or Float token. For other numbers, the
+    value of toDouble() is converted to float.
+*/
+float QCborStreamReader::toFloat() const
+{
+    return float(toDouble());
+}
+
+/*!
+    Returns the value of a Bool token, or \c false for all other tokens.
+*/
+bool QCborStreamReader::toBool() const
+{
+    Q_D(const QCborStreamReader);
+    return d->type == Bool && d->value;
+}
+
+/*!
+    Returns the simple type number of a SimpleType, Bool, Null or
+    Undefined token, or 0 for all other tokens.
+*/
+quint8 QCborStreamReader::toSimpleType() const
+{
+    Q_D(const QCborStreamReader);
+    switch (d->type) {
+    case SimpleType:
+        return quint8(d->value);
+    case Bool:
+        return d->value ? TrueValue : FalseValue;
+    case Null:
+        return NullValue;
+    case Undefined:
+        return UndefinedValue;
+    default:
+        return 0;
+    }
+}
+
+/*!
+    Returns the tag number of a Tag token, or 0 for all other tokens.
+*/
+quint64 QCborStreamReader::toTag() const
+{
+    Q_D(const QCborStreamReader);
+    return d->type == Tag ? d->value : 0;
+}
+
+/*!
+    Decodes and returns the current TextString token. For all other
+    tokens, a null QString is returned.
+
+    If the string is not valid UTF-8, a null QString is returned and the
+    reader is set to the InvalidUtf8String error.
+
+    \sa readByteArray()
+*/
+QString QCborStreamReader::readString()
+{
+    Q_D(QCborStreamReader);
+    return d->readString();
+}
+
+/*!
+    Returns the contents of the current ByteString token. For a TextString
+    token, the undecoded UTF-8 data is returned. For all other tokens, a
+    null QByteArray is returned.
+
+    \sa readString()
+*/
+QByteArray QCborStreamReader::readByteArray()
+{
+    Q_D(const QCborStreamReader);
+    return d->readByteArray();
+}
+
+/*!
+    Reads the item that starts at the current token and converts it to a
+    QJsonValue.
+
+    For a StartArray or StartMap token, the complete array or map is read,
+    and the current token becomes the matching EndArray or EndMap token.
+    For a Tag token, the tagged item is read.
+
+    The conversion follows \l{RFC 7049} section 4.1: integers and floating
+    point numbers become numbers, and \c undefined and other simple types
+    become null. Byte strings are encoded as base64url, unless a tag asks
+    for base64 or base16. Map keys that are not strings are converted to
+    their JSON representation.
+
+    If the item is incomplete or not well-formed, an undefined QJsonValue
+    is returned and hasError() is \c true.
+
+    \sa readVariant(), skipCurrentValue()
+*/
+QJsonValue QCborStreamReader::readJsonValue()
+{
+    Q_D(QCborStreamReader);
+    return d->readJsonValue();
+}
+
+/*!
+    Reads the item that starts at the current token and converts it to a
+    QVariant.
+
+    Integers become qint64, or quint64 if they are too large for qint64.
+    Negative integers below the range of qint64 become double, as do all
+    floating point numbers. Text strings become QString, byte strings
+    QByteArray, arrays QVariantList and maps QVariantMap, with keys
+    converted like in readJsonValue(). \c null becomes a QVariant holding
+    \c{std::nullptr_t}, and \c undefined an invalid QVariant.
+
+    The following tags are converted: a date and time string (tag 0) or a
+    number of seconds since the epoch (tag 1) becomes QDateTime, a URI
+    (tag 32) becomes QUrl, and a binary UUID (tag 37) becomes QUuid. Other
+    tags are ignored, and the tagged item is converted on its own.
+
+    If the item is incomplete or not well-formed, an invalid QVariant is
+    returned and hasError() is \c true.
+
+    \sa readJsonValue(), QCborStreamWriter::appendVariant()
+*/
+QVariant QCborStreamReader::readVariant()
+{
+    switch (tokenType()) {
+    case UnsignedInteger: {
+        bool ok;
+        const qint64 i = toInteger(&ok);
+        if (ok)
+            return i;
+        return toUnsignedInteger();
+    }
+    case NegativeInteger: {
+        bool ok;
+        const qint64 i = toInteger(&ok);
+        if (ok)
+            return i;
+        return toDouble();
+    }
+    case HalfFloat:
+    case Float:
+    case Double:
+        return toDouble();
+    case Bool:
+        return toBool();
+    case Null:
+        return QVariant::fromValue(nullptr);
+    case SimpleType:
+        return int(toSimpleType());
+    case TextString: {
+        const QString string = readString();
+        if (hasError())
+            return QVariant();
+        return string;
+    }
+    case ByteString:
+        return readByteArray();
+    case Tag: {
+        quint64 tag;
+        do {
+            tag = toTag();
+            if (readNext() == Invalid)
+                return QVariant();
+        } while (tokenType() == Tag);
+        switch (tag) {
+        case DateTimeStringTag:
+            if (tokenType() == TextString) {
+                const QString string = readString();
+                if (hasError())
+                    return QVariant();
+                return QDateTime::fromString(string, Qt::ISODateWithMs);
+            }
+            break;
+        case UnixTimeTag:
+            if (isInteger() || isFloat())
+                return QDateTime::fromMSecsSinceEpoch(qRound64(toDouble() * 1000), Qt::UTC);
+            break;
+        case UrlTag:
+            if (tokenType() == TextString) {
+                const QString string = readString();
+                if (hasError())
+                    return QVariant();
+                return QUrl(string);
+            }
+            break;
+        case UuidTag:
+            if (tokenType() == ByteString && length() == 16)
+                return QUuid::fromRfc4122(readByteArray());
+            break;
+        }
+        return readVariant();
+    }
+    case StartArray: {
+        QVariantList list;
+        if (isLengthKnown())
+            list.reserve(int(qMin(length(), quint64(readChunkSize))));
+        while (true) {
+            const TokenType token = readNext();
+            if (token == EndArray || token == Invalid)
+                break;
+            const QVariant v = readVariant();
+            if (hasError())
+                return QVariant();
+            list.append(v);
+        }
+        if (tokenType() != EndArray)
+            return QVariant();
+        return list;
+    }
+    case StartMap: {
+        QVariantMap map;
+        while (true) {
+            const TokenType token = readNext();
+            if (token == EndMap || token == Invalid)
+                break;
+            const QString key = d_func()->readJsonKey();
+            readNext();
+            const QVariant v = readVariant();
+            if (hasError())
+                return QVariant();
+            map.insert(key, v);
+        }
+        if (tokenType() != EndMap)
+            return QVariant();
+        return map;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+/*!
+    Skips the item that starts at the current token. For a StartArray or
+    StartMap token, the current token becomes the matching EndArray or
+    EndMap token. For a Tag token, the tagged item is skipped as well.
+
+    \sa readJsonValue()
+*/
+void QCborStreamReader::skipCurrentValue()
+{
+    while (tokenType() == Tag) {
+        if (readNext() == Invalid)
+            return;
+    }
+    switch (tokenType()) {
+    case StartArray:
+    case StartMap: {
+        int level = 1;
+        while (level > 0) {
+            switch (readNext()) {
+            case StartArray:
+            case StartMap:
+                ++level;
+                break;
+            case EndArray:
+            case EndMap:
+                --level;
+                break;
+            case Invalid:
+                return;
+            default:
+                break;
+            }
+        }
+        return;
+    }
+    default:
+        return;
+    }
+}
+
+/*!
+    Returns the number of arrays and maps the current token is nested in.
+    The StartArray and StartMap tokens are counted as inside their
+    container, the EndArray and EndMap tokens as outside of it.
+*/
+int QCborStreamReader::depth() const
+{
+    Q_D(const QCborStreamReader);
+    return d->stack.size();
+}
+
+/*!
+    Returns the offset of the current read position in the input, in
+    bytes.
+*/
+qint64 QCborStreamReader::offset() const
+{
+    Q_D(const QCborStreamReader);
+    return d->discarded + d->pos;
+}
+
+/*!
+    Returns \c true if an error has occurred, otherwise \c false.
+
+    \sa error(), errorString()
+*/
+bool QCborStreamReader::hasError() const
+{
+    Q_D(const QCborStreamReader);
+    return d->error != NoError;
+}
+
+/*!
+    Returns the type of the current error, or NoError if no error
+    occurred.
+
+    \sa errorString(), hasError()
+*/
+QCborStreamReader::Error QCborStreamReader::error() const
+{
+    Q_D(const QCborStreamReader);
+    return d->error;
+}
+
+/*!
+    Returns the human-readable message for the current error().
+*/
+QString QCborStreamReader::errorString() const
+{
+    const char *sz = "";
+    switch (error()) {
+    case NoError:
+        sz = CBORERR_OK;
+        break;
+    case UnexpectedEnd:
+        sz = CBORERR_END;
+        break;
+    case IllegalNumber:
+        sz = CBORERR_NUMBER;
+        break;
+    case IllegalType:
+        sz = CBORERR_TYPE;
+        break;
+    case UnexpectedBreak:
+        sz = CBORERR_BREAK;
+        break;
+    case InvalidUtf8String:
+        sz = CBORERR_UTF8;
+        break;
+    case NestingTooDeep:
+        sz = CBORERR_NESTING;
+        break;
+    case DataTooLarge:
+        sz = CBORERR_TOO_LARGE;
+        break;
+    }
+    return QCoreApplication::translate("QCborStreamReader", sz);
+}
+
+class QCborStreamWriterPrivate
+{
+public:
+    struct Level {
+        // items still expected in a container of known length; items
+        // written so far in one of unknown length
+        quint64 count;
+        bool isMap;
+        bool lengthKnown;
+    };
+
+    QCborStreamWriterPrivate()
+        : device(nullptr), array(nullptr), hasError(false)
+    {}
+
+    inline QByteArray &output() { return array ? *array : buffer; }
+    void appendHeader(int major, quint64 argument);
+    void beginItem();
+    void endItem();
+    void startContainer(bool isMap, bool lengthKnown, quint64 count);
+    bool endContainer(bool isMap, const char *function);
+    void write();
+
+    QIODevice *device;
+    QByteArray *array;
+    QByteArray buffer;
+    QVarLengthArray<Level, 64> stack;
+    bool hasError;
+};
+
+void QCborStreamWriterPrivate::appendHeader(int major, quint64 argument)
+{
+    uchar header[1 + sizeof(quint64)];
+    int size = 1;
+    header[0] = uchar(major << MajorTypeShift);
+    if (argument < Value8Bit) {
+        header[0] |= uchar(argument);
+    } else if (argument <= std::numeric_limits<quint8>::max()) {
+        header[0] |= Value8Bit;
+        header[1] = uchar(argument);
+        size += 1;
+    } else if (argument <= std::numeric_limits<quint16>::max()) {
+        header[0] |= Value16Bit;
+        qToBigEndian(quint16(argument), header + 1);
+        size += 2;
+    } else if (argument <= std::numeric_limits<quint32>::max()) {
+        header[0] |= Value32Bit;
+        qToBigEndian(quint32(argument), header + 1);
+        size += 4;
+    } else {
+        header[0] |= Value64Bit;
+        qToBigEndian(argument, header + 1);
+        size += 8;
+    }
+    output().append(reinterpret_cast<const char *>(header), size);
+}
+
+/*
+    Accounts for an item in the enclosing container. Tags are not items of
+    their own, so they do not call this function.
+*/
+void QCborStreamWriterPrivate::beginItem()
+{
+    if (stack.isEmpty())
+        return;
+    Level &level = stack.last();
+    if (!level.lengthKnown) {
+        ++level.count;
+    } else if (level.count == 0) {
+        qWarning("QCborStreamWriter: more items than announced for the %s",
+                 level.isMap ? "map" : "array");
+    } else {
+        --level.count;
+    }
+}
+
+/*
+    Hands complete top-level items to the device, and large amounts of
+    pending data in between.
+*/
+void QCborStreamWriterPrivate::endItem()
+{
+    if (stack.isEmpty() || buffer.size() >= writeBufferSize)
+        write();
+}
+
+void QCborStreamWriterPrivate::startContainer(bool isMap, bool lengthKnown, quint64 count)
+{
+    beginItem();
+    if (lengthKnown)
+        appendHeader(isMap ? MapType : ArrayType, count);
+    else
+        output() += char((isMap ? MapType : ArrayType) << MajorTypeShift | IndefiniteLength);
+
+    Level level;
+    level.isMap = isMap;
+    level.lengthKnown = lengthKnown;
+    level.count = lengthKnown ? (isMap ? 2 * count : count) : 0;
+    stack.append(level);
+}
+
+bool QCborStreamWriterPrivate::endContainer(bool isMap, const char *function)
+{
+    if (stack.isEmpty() || stack.last().isMap != isMap) {
+        qWarning("QCborStreamWriter::%s: no %s to end", function, isMap ? "map" : "array");
+        return false;
+    }
+
+    const Level level = stack.last();
+    stack.removeLast();
+    bool ok = true;
+    if (!level.lengthKnown) {
+        output() += char(BreakByte);
+        if (isMap && level.count % 2) {
+            qWarning("QCborStreamWriter::endMap: a key has no value");
+            ok = false;
+        }
+    } else if (level.count) {
+        qWarning("QCborStreamWriter::%s: %llu items fewer than announced", function,
+                 level.count);
+        ok = false;
+    }
+    endItem();
+    return ok;
+}
+
+void QCborStreamWriterPrivate::write()
+{
+    if (!device || buffer.isEmpty())
+        return;
+    if (device->write(buffer) != buffer.size())
+        hasError = true;
+    buffer.clear();
+}
+
+/*!
+    \class QCborStreamWriter
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.10
+
+    \brief The QCborStreamWriter class writes the Concise Binary Object
+    Representation (CBOR).
+
+    QCborStreamWriter is the counterpart to QCborStreamReader. It writes
+    CBOR as specified in \l{RFC 7049} incrementally to a QIODevice or a
+    QByteArray. Simple values are written with the append() overloads.
+    Arrays and maps are opened with startArray() and startMap() and closed
+    with endArray() and endMap(); in a map, each key is followed by its
+    value:
+
+    \snippet code/src_corelib_json_qcborstream.cpp 1
+
+    If the number of items is passed to startArray() or startMap(), it is
+    written into the container's header, which saves a byte and lets the
+    reader preallocate. Otherwise the container's end is marked by the
+    break byte that endArray() and endMap() write.
+
+    All integers and lengths are written in the shortest form that the
+    format allows. Floating point numbers written with append(double) or
+    append(float) are stored in the shortest of the half, single and double
+    precision formats that represents them exactly.
+
+    appendJsonValue() and appendVariant() write a QJsonValue or QVariant,
+    including nested arrays and objects, in one call.
+
+    Data is written to the device in blocks and at the end of each
+    top-level item. Call flush() to write pending data earlier.
+
+    \sa QCborStreamReader, QJsonStreamWriter
+*/
+
+/*!
+    Constructs a stream writer.
+
+    \sa setDevice()
+*/
+QCborStreamWriter::QCborStreamWriter()
+    : d_ptr(new QCborStreamWriterPrivate)
+{
+}
+
+/*!
+    Constructs a stream writer that writes into \a device.
+*/
+QCborStreamWriter::QCborStreamWriter(QIODevice *device)
+    : d_ptr(new QCborStreamWriterPrivate)
+{
+    d_ptr->device = device;
+}
+
+/*!
+    Constructs a stream writer that appends to \a array.
+*/
+QCborStreamWriter::QCborStreamWriter(QByteArray *array)
+    : d_ptr(new QCborStreamWriterPrivate)
+{
+    d_ptr->array = array;
+}
+
+/*!
+    Destructor. Writes pending data to the device.
+*/
+QCborStreamWriter::~QCborStreamWriter()
+{
+    flush();
+}
+
+/*!
+    Sets the current device to \a device. Pending data is written to the
+    previous device first.
+
+    \sa device()
+*/
+void QCborStreamWriter::setDevice(QIODevice *device)
+{
+    Q_D(QCborStreamWriter);
+    flush();
+    d->device = device;
+    d->array = nullptr;
+}
+
+/*!
+    Returns the current device associated with the writer, or \nullptr if
+    no device has been assigned.
+
+    \sa setDevice()
+*/
+QIODevice *QCborStreamWriter::device() const
+{
+    Q_D(const QCborStreamWriter);
+    return d->device;
+}
+
+/*!
+    Appends the unsigned integer \a value.
+*/
+void QCborStreamWriter::append(quint64 value)
+{
+    Q_D(QCborStreamWriter);
+    d->beginItem();
+    d->appendHeader(UnsignedIntegerType, value);
+    d->endItem();
+}
+
+/*!
+    \overload
+
+    Appends the integer \a value.
+*/
+void QCborStreamWriter::append(qint64 value)
+{
+    Q_D(QCborStreamWriter);
+    d->beginItem();
+    if (value >= 0)
+        d->appendHeader(UnsignedIntegerType, quint64(value));
+    else
+        d->appendHeader(NegativeIntegerType, ~quint64(value));     // -1 - value
+    d->endItem();
+}
+
+/*!
+    \fn void QCborStreamWriter::append(int value)
+    \overload
+
+    Appends the integer \a value.
+*/
+
+/*!
+    \fn void QCborStreamWriter::append(uint value)
+    \overload
+
+    Appends the unsigned integer \a value.
+*/
+
+/*!
+    \fn void QCborStreamWriter::append(long value)
+    \overload
+
+    Appends the integer \a value.
+*/
+
+/*!
+    \fn void QCborStreamWriter::append(ulong value)
+    \overload
+
+    Appends the unsigned integer \a value.
+*/
+
+/*!
+    Appends the negative integer \c{-1 - n}. This allows writing integers
+    down to -2\sup{64}, which do not fit into a qint64.
+
+    \sa QCborStreamReader::toUnsignedInteger()
+*/
+void QCborStreamWriter::appendNegativeInteger(quint64 n)
+{
+    Q_D(QCborStreamWriter);
+    d->beginItem();
+    d->appendHeader(NegativeIntegerType, n);
+    d->endItem();
+}
+
+/*!
+    \overload
+
+    Appends the boolean \a value.
+*/
+void QCborStreamWriter::append(bool value)
+{
+    appendSimpleType(value ? TrueValue : FalseValue);
+}
+
+/*!
+    \overload
+
+    Appends the 16-bit floating point number \a value.
+*/
+void QCborStreamWriter::append(qfloat16 value)
+{
+    Q_D(QCborStreamWriter);
+    d->beginItem();
+    uchar data[3];
+    data[0] = SimpleTypesType << MajorTypeShift | HalfPrecisionFloat;
+    quint16 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToBigEndian(bits, data + 1);
+    d->output().append(reinterpret_cast<const char *>(data), sizeof(data));
+    d->endItem();
+}
+
+/*!
+    \overload
+
+    Appends the floating point number \a value. If \a value can be
+    represented exactly as a 16-bit floating point number, it is written
+    in that format.
+*/
+void QCborStreamWriter::append(float value)
+{
+    const qfloat16 half(value);
+    if (float(half) == value || qIsNaN(value)) {
+        append(half);
+        return;
+    }
+
+    Q_D(QCborStreamWriter);
+    d->beginItem();
+    uchar data[5];
+    data[0] = SimpleTypesType << MajorTypeShift | SinglePrecisionFloat;
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToBigEndian(bits, data + 1);
+    d->output().append(reinterpret_cast<const char *>(data), sizeof(data));
+    d->endItem();
+}
+
+/*!
+    \overload
+
+    Appends the floating point number \a value. If \a value can be
+    represented exactly with less precision, it is written as a 16-bit or
+    32-bit floating point number.
+*/
+void QCborStreamWriter::append(double value)
+{
+    const float f = float(value);
+    if (double(f) == value || qIsNaN(value)) {
+        append(f);
+        return;
+    }
+
+    Q_D(QCborStreamWriter);
+    d->beginItem();
+    uchar data[9];
+    data[0] = SimpleTypesType << MajorTypeShift | DoublePrecisionFloat;
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToBigEndian(bits, data + 1);
+    d->output().append(reinterpret_cast<const char *>(data), sizeof(data));
+    d->endItem();
+}
+
+/*!
+    \overload
+
+    Appends \a value as a byte string.
+*/
+void QCborStreamWriter::append(const QByteArray &value)
+{
+    Q_D(QCborStreamWriter);
+    d->beginItem();
+    d->appendHeader(ByteStringType, quint64(value.size()));
+    d->output() += value;
+    d->endItem();
+}
+
+/*!
+    \overload
+
+    Appends \a value as a text string.
+*/
+void QCborStreamWriter::append(const QString &value)
+{
+    const QByteArray utf8 = value.toUtf8();
+    appendTextString(utf8.constData(), utf8.size());
+}
+
+/*!
+    \overload
+
+    Appends \a value as a text string.
+*/
+void QCborStreamWriter::append(QLatin1String value)
+{
+    for (const char c : value) {
+        if (uchar(c) >= 0x80) {
+            append(QString(value));
+            return;
+        }
+    }
+    appendTextString(value.data(), value.size());
+}
+
+/*!
+    \overload
+
+    Appends the UTF-8 string \a utf8 of \a length bytes as a text string.
+    If \a length is -1, the string has to be '\\0'-terminated.
+*/
+void QCborStreamWriter::append(const char *utf8, int length)
+{
+    appendTextString(utf8, length < 0 ? int(qstrlen(utf8)) : length);
+}
+
+/*!
+    Appends the UTF-8 string \a utf8 of \a length bytes as a text string.
+    The data is not validated.
+*/
+void QCborStreamWriter::appendTextString(const char *utf8, int length)
+{
+    Q_D(QCborStreamWriter);
+    d->beginItem();
+    d->appendHeader(TextStringType, quint64(length));
+    d->output().append(utf8, length);
+    d->endItem();
+}
+
+/*!
+    Appends \c null.
+*/
+void QCborStreamWriter::appendNull()
+{
+    appendSimpleType(NullValue);
+}
+
+/*!
+    Appends \c undefined.
+*/
+void QCborStreamWriter::appendUndefined()
+{
+    appendSimpleType(UndefinedValue);
+}
+
+/*!
+    Appends the simple type \a value. The values 24 to 31 are reserved and
+    must not be used.
+*/
+void QCborStreamWriter::appendSimpleType(quint8 value)
+{
+    Q_D(QCborStreamWriter);
+    if (value >= Value8Bit && value < 32) {
+        qWarning("QCborStreamWriter::appendSimpleType: simple type %d is reserved", value);
+        return;
+    }
+    d->beginItem();
+    d->appendHeader(SimpleTypesType, value);
+    d->endItem();
+}
+
+/*!
+    Appends the tag \a tag. The tag applies to the item appended next.
+*/
+void QCborStreamWriter::appendTag(quint64 tag)
+{
+    Q_D(QCborStreamWriter);
+    d->appendHeader(TagType, tag);
+}
+
+/*!
+    Starts an array of unknown length. Append the elements and close it
+    with endArray().
+*/
+void QCborStreamWriter::startArray()
+{
+    Q_D(QCborStreamWriter);
+    d->startContainer(false, false, 0);
+}
+
+/*!
+    \overload
+
+    Starts an array with \a count elements. Append exactly \a count
+    elements and close it with endArray().
+*/
+void QCborStreamWriter::startArray(quint64 count)
+{
+    Q_D(QCborStreamWriter);
+    d->startContainer(false, true, count);
+}
+
+/*!
+    Closes the current array. Returns \c false if there is no array to
+    close, or if the number of elements does not match the number passed
+    to startArray().
+*/
+bool QCborStreamWriter::endArray()
+{
+    Q_D(QCborStreamWriter);
+    return d->endContainer(false, "endArray");
+}
+
+/*!
+    Starts a map of unknown length. Append the keys, each followed by its
+    value, and close it with endMap().
+*/
+void QCborStreamWriter::startMap()
+{
+    Q_D(QCborStreamWriter);
+    d->startContainer(true, false, 0);
+}
+
+/*!
+    \overload
+
+    Starts a map with \a count key-value pairs. Append exactly \a count
+    keys, each followed by its value, and close it with endMap().
+*/
+void QCborStreamWriter::startMap(quint64 count)
+{
+    Q_D(QCborStreamWriter);
+    d->startContainer(true, true, count);
+}
+
+/*!
+    Closes the current map. Returns \c false if there is no map to close,
+    or if the number of pairs does not match the number passed to
+    startMap().
+*/
+bool QCborStreamWriter::endMap()
+{
+    Q_D(QCborStreamWriter);
+    return d->endContainer(true, "endMap");
+}
+
+/*!
+    Appends the JSON value \a value. Arrays and objects are written as
+    arrays and maps of known length. Numbers without a fractional part are
+    written as integers.
+
+    \sa QCborStreamReader::readJsonValue()
+*/
+void QCborStreamWriter::appendJsonValue(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Null:
+        appendNull();
+        break;
+    case QJsonValue::Bool:
+        append(value.toBool());
+        break;
+    case QJsonValue::Double: {
+        const double d = value.toDouble();
+        // 2^63 itself is not representable as qint64
+        if (d >= -9223372036854775808.0 && d < 9223372036854775808.0
+                && d == double(qint64(d)) && !(d == 0 && std::signbit(d)))
+            append(qint64(d));
+        else
+            append(d);
+        break;
+    }
+    case QJsonValue::String:
+        append(value.toString());
+        break;
+    case QJsonValue::Array: {
+        const QJsonArray array = value.toArray();
+        startArray(quint64(array.size()));
+        for (const QJsonValue &v : array)
+            appendJsonValue(v);
+        endArray();
+        break;
+    }
+    case QJsonValue::Object: {
+        const QJsonObject object = value.toObject();
+        startMap(quint64(object.size()));
+        for (auto it = object.constBegin(), end = object.constEnd(); it != end; ++it) {
+            append(it.key());
+            appendJsonValue(it.value());
+        }
+        endMap();
+        break;
+    }
+    case QJsonValue::Undefined:
+        appendUndefined();
+        break;
+    }
+}
+
+/*!
+    Appends the variant \a value.
+
+    Numbers, booleans, strings and byte arrays are written as the matching
+    CBOR types. Lists become arrays, and maps and hashes become maps with
+    text string keys. QDateTime, QUrl and QUuid are written with the tags
+    defined for them, and JSON values as by appendJsonValue(). A variant
+    holding \c{std::nullptr_t} is written as \c null, and an invalid
+    variant as \c undefined. Other types are written as text strings if
+    they can be converted to QString, and as \c undefined otherwise.
+
+    \sa QCborStreamReader::readVariant()
+*/
+void QCborStreamWriter::appendVariant(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::UnknownType:
+        appendUndefined();
+        break;
+    case QMetaType::Nullptr:
+        appendNull();
+        break;
+    case QMetaType::Bool:
+        append(value.toBool());
+        break;
+    case QMetaType::Int:
+    case QMetaType::Short:
+    case QMetaType::SChar:
+    case QMetaType::Char:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        append(value.toLongLong());
+        break;
+    case QMetaType::UInt:
+    case QMetaType::UShort:
+    case QMetaType::UChar:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        append(value.toULongLong());
+        break;
+    case QMetaType::Float:
+        append(value.toFloat());
+        break;
+    case QMetaType::Double:
+        append(value.toDouble());
+        break;
+    case QMetaType::QByteArray:
+        append(value.toByteArray());
+        break;
+    case QMetaType::QString:
+        append(value.toString());
+        break;
+    case QMetaType::QStringList: {
+        const QStringList list = value.toStringList();
+        startArray(quint64(list.size()));
+        for (const QString &s : list)
+            append(s);
+        endArray();
+        break;
+    }
+    case QMetaType::QVariantList: {
+        const QVariantList list = value.toList();
+        startArray(quint64(list.size()));
+        for (const QVariant &v : list)
+            appendVariant(v);
+        endArray();
+        break;
+    }
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = value.toMap();
+        startMap(quint64(map.size()));
+        for (auto it = map.constBegin(), end = map.constEnd(); it != end; ++it) {
+            append(it.key());
+            appendVariant(it.value());
+        }
+        endMap();
+        break;
+    }
+    case QMetaType::QVariantHash: {
+        const QVariantHash hash = value.toHash();
+        startMap(quint64(hash.size()));
+        for (auto it = hash.constBegin(), end = hash.constEnd(); it != end; ++it) {
+            append(it.key());
+            appendVariant(it.value());
+        }
+        endMap();
+        break;
+    }
+    case QMetaType::QDateTime:
+        appendTag(DateTimeStringTag);
+        append(value.toDateTime().toString(Qt::ISODateWithMs));
+        break;
+    case QMetaType::QUrl:
+        appendTag(UrlTag);
+        append(value.toUrl().toString(QUrl::FullyEncoded));
+        break;
+    case QMetaType::QUuid:
+        appendTag(UuidTag);
+        append(value.toUuid().toRfc4122());
+        break;
+    case QMetaType::QJsonValue:
+        appendJsonValue(value.toJsonValue());
+        break;
+    case QMetaType::QJsonObject:
+        appendJsonValue(value.toJsonObject());
+        break;
+    case QMetaType::QJsonArray:
+        appendJsonValue(value.toJsonArray());
+        break;
+    case QMetaType::QJsonDocument: {
+        const QJsonDocument document = value.toJsonDocument();
+        if (document.isArray())
+            appendJsonValue(document.array());
+        else if (document.isObject())
+            appendJsonValue(document.object());
+        else
+            appendNull();
+        break;
+    }
+    default:
+        if (value.canConvert<QString>())
+            append(value.toString());
+        else
+            appendUndefined();
+        break;
+    }
+}
+
+/*!
+    Returns the number of arrays and maps that are currently open.
+*/
+int QCborStreamWriter::depth() const
+{
+    Q_D(const QCborStreamWriter);
+    return d->stack.size();
+}
+
+/*!
+    Writes pending data to the device().
+*/
+void QCborStreamWriter::flush()
+{
+    Q_D(QCborStreamWriter);
+    d->write();
+}
+
+/*!
+    Returns \c true if writing to the device failed; otherwise returns
+    \c false.
+*/
+bool QCborStreamWriter::hasError() const
+{
+    Q_D(const QCborStreamWriter);
+    return d->hasError;
+}
+
+QT_END_NAMESPACE
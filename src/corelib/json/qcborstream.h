@@ -0,0 +1,204 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCBORSTREAM_H
+#define QCBORSTREAM_H
+
+#include <QtCore/qjsonvalue.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qfloat16.h>
+#include <QtCore/qscopedpointer.h>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+
+class QCborStreamReaderPrivate;
+class Q_CORE_EXPORT QCborStreamReader
+{
+public:
+    enum TokenType {
+        NoToken = 0,
+        Invalid,
+        UnsignedInteger,
+        NegativeInteger,
+        ByteString,
+        TextString,
+        StartArray,
+        EndArray,
+        StartMap,
+        EndMap,
+        Tag,
+        SimpleType,
+        Bool,
+        Null,
+        Undefined,
+        HalfFloat,
+        Float,
+        Double
+    };
+
+    enum Error {
+        NoError = 0,
+        UnexpectedEnd,
+        IllegalNumber,
+        IllegalType,
+        UnexpectedBreak,
+        InvalidUtf8String,
+        NestingTooDeep,
+        DataTooLarge
+    };
+
+    QCborStreamReader();
+    explicit QCborStreamReader(QIODevice *device);
+    explicit QCborStreamReader(const QByteArray &data);
+    ~QCborStreamReader();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+    void addData(const QByteArray &data);
+    void clear();
+
+    bool atEnd() const;
+    TokenType readNext();
+
+    TokenType tokenType() const;
+    QString tokenString() const;
+
+    inline bool isInteger() const
+    { return tokenType() == UnsignedInteger || tokenType() == NegativeInteger; }
+    inline bool isString() const
+    { return tokenType() == ByteString || tokenType() == TextString; }
+    inline bool isFloat() const
+    { return tokenType() == HalfFloat || tokenType() == Float || tokenType() == Double; }
+    inline bool isStartArray() const { return tokenType() == StartArray; }
+    inline bool isEndArray() const { return tokenType() == EndArray; }
+    inline bool isStartMap() const { return tokenType() == StartMap; }
+    inline bool isEndMap() const { return tokenType() == EndMap; }
+    inline bool isTag() const { return tokenType() == Tag; }
+
+    bool isLengthKnown() const;
+    quint64 length() const;
+
+    quint64 toUnsignedInteger() const;
+    qint64 toInteger(bool *ok = nullptr) const;
+    double toDouble() const;
+    float toFloat() const;
+    bool toBool() const;
+    quint8 toSimpleType() const;
+    quint64 toTag() const;
+
+    QString readString();
+    QByteArray readByteArray();
+
+    QJsonValue readJsonValue();
+    QVariant readVariant();
+    void skipCurrentValue();
+
+    int depth() const;
+    qint64 offset() const;
+
+    bool hasError() const;
+    Error error() const;
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(QCborStreamReader)
+    Q_DECLARE_PRIVATE(QCborStreamReader)
+    QScopedPointer<QCborStreamReaderPrivate> d_ptr;
+};
+
+class QCborStreamWriterPrivate;
+class Q_CORE_EXPORT QCborStreamWriter
+{
+public:
+    QCborStreamWriter();
+    explicit QCborStreamWriter(QIODevice *device);
+    explicit QCborStreamWriter(QByteArray *array);
+    ~QCborStreamWriter();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    void append(quint64 value);
+    void append(qint64 value);
+    inline void append(int value) { append(qint64(value)); }
+    inline void append(uint value) { append(quint64(value)); }
+    inline void append(long value) { append(qint64(value)); }
+    inline void append(ulong value) { append(quint64(value)); }
+    void appendNegativeInteger(quint64 n);
+    void append(bool value);
+    void append(qfloat16 value);
+    void append(float value);
+    void append(double value);
+    void append(const QByteArray &value);
+    void append(const QString &value);
+    void append(QLatin1String value);
+    void append(const char *utf8, int length = -1);
+    void appendTextString(const char *utf8, int length);
+    void appendNull();
+    void appendUndefined();
+    void appendSimpleType(quint8 value);
+    void appendTag(quint64 tag);
+
+    void startArray();
+    void startArray(quint64 count);
+    bool endArray();
+    void startMap();
+    void startMap(quint64 count);
+    bool endMap();
+
+    void appendJsonValue(const QJsonValue &value);
+    void appendVariant(const QVariant &value);
+
+    int depth() const;
+    void flush();
+
+    bool hasError() const;
+
+private:
+    Q_DISABLE_COPY(QCborStreamWriter)
+    Q_DECLARE_PRIVATE(QCborStreamWriter)
+    QScopedPointer<QCborStreamWriterPrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCBORSTREAM_H
@@ -40,6 +40,7 @@
 #include <qjsonobject.h>
 #include <qjsonvalue.h>
 #include <qjsonarray.h>
+#include <qjsonbuilder.h>
 #include <qstringlist.h>
 #include <qvariant.h>
 #include <qdebug.h>
@@ -267,10 +268,11 @@ QJsonArray &QJsonArray::operator =(const QJsonArray &other)
  */
 QJsonArray QJsonArray::fromStringList(const QStringList &list)
 {
-    QJsonArray array;
+    QJsonArrayBuilder builder;
+    builder.reserve(list.size());
     for (QStringList::const_iterator it = list.constBegin(); it != list.constEnd(); ++it)
-        array.append(QJsonValue(*it));
-    return array;
+        builder.append(QJsonValue(*it));
+    return builder.toArray();
 }
 
 /*!
@@ -250,6 +250,7 @@ private:
     friend class QJsonPrivate::Data;
     friend class QJsonValue;
     friend class QJsonDocument;
+    friend class QJsonArrayBuilder;
     friend Q_CORE_EXPORT QDebug operator<<(QDebug, const QJsonArray &);
 
     QJsonArray(QJsonPrivate::Data *data, QJsonPrivate::Array *array);
@@ -0,0 +1,348 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qjsonbuilder.h"
+#include "qjson_p.h"
+
+#include <qpair.h>
+#include <qvector.h>
+
+#include <algorithm>
+#include <numeric>
+
+QT_BEGIN_NAMESPACE
+
+class QJsonObjectBuilderPrivate
+{
+public:
+    QVector<QPair<QString, QJsonValue> > members;
+};
+
+class QJsonArrayBuilderPrivate
+{
+public:
+    QVector<QJsonValue> values;
+};
+
+/*!
+    \class QJsonObjectBuilder
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.10
+
+    \brief The QJsonObjectBuilder class creates a QJsonObject from many
+    members at once.
+
+    QJsonObject stores its members in a single block of memory, sorted by
+    key. Every call to QJsonObject::insert() has to make room for the new
+    member inside that block, so building a large object member by member
+    takes time proportional to the square of its size.
+
+    QJsonObjectBuilder only collects the members. toObject() sorts them
+    once and writes the whole object in a single pass:
+
+    \snippet code/src_corelib_json_qjsonbuilder.cpp 0
+
+    Inserting a key that was already inserted replaces the earlier value,
+    and inserting an undefined QJsonValue removes the key, just like
+    QJsonObject::insert() does.
+
+    \sa QJsonArrayBuilder, QJsonObject
+*/
+
+/*!
+    Constructs an empty builder.
+*/
+QJsonObjectBuilder::QJsonObjectBuilder()
+    : d_ptr(new QJsonObjectBuilderPrivate)
+{
+}
+
+/*!
+    Destroys the builder.
+*/
+QJsonObjectBuilder::~QJsonObjectBuilder()
+{
+}
+
+/*!
+    Reserves space for \a size calls to insert().
+*/
+void QJsonObjectBuilder::reserve(int size)
+{
+    Q_D(QJsonObjectBuilder);
+    d->members.reserve(size);
+}
+
+/*!
+    Adds a member with the key \a key and the value \a value. It replaces
+    a member with the same key that was inserted before.
+
+    \sa toObject()
+*/
+void QJsonObjectBuilder::insert(const QString &key, const QJsonValue &value)
+{
+    Q_D(QJsonObjectBuilder);
+    d->members.append(qMakePair(key, value));
+}
+
+/*!
+    Returns the number of calls to insert() since the builder was created
+    or cleared. Duplicate keys are counted each time.
+*/
+int QJsonObjectBuilder::count() const
+{
+    Q_D(const QJsonObjectBuilder);
+    return d->members.size();
+}
+
+/*!
+    Removes all members from the builder.
+*/
+void QJsonObjectBuilder::clear()
+{
+    Q_D(QJsonObjectBuilder);
+    d->members.clear();
+}
+
+/*!
+    Returns a QJsonObject containing the members inserted so far. The
+    builder keeps its members, so more can be inserted afterwards.
+*/
+QJsonObject QJsonObjectBuilder::toObject() const
+{
+    Q_D(const QJsonObjectBuilder);
+
+    // Sort by key, keeping duplicates in insertion order so that the last
+    // one wins like with QJsonObject::insert().
+    QVector<int> order(d->members.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [d](int a, int b) {
+        return d->members.at(a).first < d->members.at(b).first;
+    });
+
+    struct Member {
+        int index;
+        QJsonValue value;
+        bool latinKey;
+        bool latinOrIntValue;
+        int valueOffset;
+        int valueSize;
+    };
+    QVector<Member> members;
+    members.reserve(order.size());
+    qint64 size = 0;
+    for (int i = 0; i < order.size(); ++i) {
+        const QPair<QString, QJsonValue> &member = d->members.at(order.at(i));
+        if (i + 1 < order.size() && d->members.at(order.at(i + 1)).first == member.first)
+            continue;
+        if (member.second.type() == QJsonValue::Undefined)
+            continue;
+
+        Member m;
+        m.index = order.at(i);
+        m.value = member.second;
+        m.latinKey = QJsonPrivate::useCompressed(member.first);
+        m.valueOffset = sizeof(QJsonPrivate::Entry) + QJsonPrivate::qStringSize(member.first, m.latinKey);
+        m.valueSize = QJsonPrivate::Value::requiredStorage(m.value, &m.latinOrIntValue);
+        size += m.valueOffset + m.valueSize + sizeof(QJsonPrivate::offset);
+        members.append(m);
+    }
+
+    QJsonObject object;
+    if (members.isEmpty())
+        return object;
+    if (size >= QJsonPrivate::Value::MaxSize) {
+        qWarning("QJson: Document too large to store in data structure");
+        return object;
+    }
+    if (!object.detach2(uint(size)))
+        return QJsonObject();
+
+    QJsonPrivate::Object *o = object.o;
+    uint currentOffset = sizeof(QJsonPrivate::Base);
+    o->tableOffset = uint(size - members.size() * sizeof(QJsonPrivate::offset)) + sizeof(QJsonPrivate::Base);
+    for (int i = 0; i < members.size(); ++i) {
+        const Member &m = members.at(i);
+        const QString &key = d->members.at(m.index).first;
+
+        o->table()[i] = currentOffset;
+        QJsonPrivate::Entry *e = reinterpret_cast<QJsonPrivate::Entry *>(reinterpret_cast<char *>(o) + currentOffset);
+        e->value.type = m.value.type();
+        e->value.latinKey = m.latinKey;
+        e->value.latinOrIntValue = m.latinOrIntValue;
+        e->value.value = QJsonPrivate::Value::valueToStore(m.value, currentOffset + m.valueOffset);
+        QJsonPrivate::copyString(reinterpret_cast<char *>(e + 1), key, m.latinKey);
+        if (m.valueSize)
+            QJsonPrivate::Value::copyData(m.value, reinterpret_cast<char *>(e) + m.valueOffset, m.latinOrIntValue);
+        currentOffset += m.valueOffset + m.valueSize;
+    }
+    Q_ASSERT(currentOffset == o->tableOffset);
+    o->length = members.size();
+    o->size = currentOffset + members.size() * sizeof(QJsonPrivate::offset);
+
+    return object;
+}
+
+/*!
+    \class QJsonArrayBuilder
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.10
+
+    \brief The QJsonArrayBuilder class creates a QJsonArray from many
+    values at once.
+
+    Like QJsonObjectBuilder, QJsonArrayBuilder collects values and writes
+    the QJsonArray in a single pass when toArray() is called, instead of
+    growing the array's storage with every QJsonArray::append().
+
+    \sa QJsonObjectBuilder, QJsonArray
+*/
+
+/*!
+    Constructs an empty builder.
+*/
+QJsonArrayBuilder::QJsonArrayBuilder()
+    : d_ptr(new QJsonArrayBuilderPrivate)
+{
+}
+
+/*!
+    Destroys the builder.
+*/
+QJsonArrayBuilder::~QJsonArrayBuilder()
+{
+}
+
+/*!
+    Reserves space for \a size values.
+*/
+void QJsonArrayBuilder::reserve(int size)
+{
+    Q_D(QJsonArrayBuilder);
+    d->values.reserve(size);
+}
+
+/*!
+    Appends \a value. Undefined values are stored as null, like with
+    QJsonArray::append().
+
+    \sa toArray()
+*/
+void QJsonArrayBuilder::append(const QJsonValue &value)
+{
+    Q_D(QJsonArrayBuilder);
+    d->values.append(value);
+}
+
+/*!
+    Returns the number of values appended since the builder was created
+    or cleared.
+*/
+int QJsonArrayBuilder::count() const
+{
+    Q_D(const QJsonArrayBuilder);
+    return d->values.size();
+}
+
+/*!
+    Removes all values from the builder.
+*/
+void QJsonArrayBuilder::clear()
+{
+    Q_D(QJsonArrayBuilder);
+    d->values.clear();
+}
+
+/*!
+    Returns a QJsonArray containing the values appended so far. The
+    builder keeps its values, so more can be appended afterwards.
+*/
+QJsonArray QJsonArrayBuilder::toArray() const
+{
+    Q_D(const QJsonArrayBuilder);
+
+    QJsonArray array;
+    if (d->values.isEmpty())
+        return array;
+
+    QVector<QJsonValue> values = d->values;
+    QVector<int> valueSizes(values.size());
+    QVector<QJsonPrivate::Value> table(values.size());
+    qint64 size = qint64(values.size()) * sizeof(QJsonPrivate::Value);
+    for (int i = 0; i < values.size(); ++i) {
+        bool latinOrIntValue;
+        valueSizes[i] = QJsonPrivate::Value::requiredStorage(values[i], &latinOrIntValue);
+        table[i].latinOrIntValue = latinOrIntValue;
+        size += valueSizes.at(i);
+    }
+    if (size >= QJsonPrivate::Value::MaxSize) {
+        qWarning("QJson: Document too large to store in data structure");
+        return array;
+    }
+    if (!array.detach2(uint(size)))
+        return QJsonArray();
+
+    QJsonPrivate::Array *a = array.a;
+    uint currentOffset = sizeof(QJsonPrivate::Base);
+    for (int i = 0; i < values.size(); ++i) {
+        const QJsonValue &val = values.at(i);
+        QJsonPrivate::Value &v = table[i];
+        const bool latinOrIntValue = v.latinOrIntValue;
+        v.type = (val.type() == QJsonValue::Undefined ? QJsonValue::Null : val.type());
+        v.latinKey = false;
+        v.value = QJsonPrivate::Value::valueToStore(val, currentOffset);
+        if (valueSizes.at(i))
+            QJsonPrivate::Value::copyData(val, reinterpret_cast<char *>(a) + currentOffset, latinOrIntValue);
+        currentOffset += valueSizes.at(i);
+    }
+
+    a->tableOffset = currentOffset;
+    memcpy(a->table(), table.constData(), table.size() * sizeof(QJsonPrivate::Value));
+    a->length = table.size();
+    a->size = currentOffset + table.size() * sizeof(QJsonPrivate::Value);
+
+    return array;
+}
+
+QT_END_NAMESPACE
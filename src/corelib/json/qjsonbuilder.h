@@ -0,0 +1,92 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QJSONBUILDER_H
+#define QJSONBUILDER_H
+
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qscopedpointer.h>
+
+QT_BEGIN_NAMESPACE
+
+class QJsonObjectBuilderPrivate;
+class Q_CORE_EXPORT QJsonObjectBuilder
+{
+public:
+    QJsonObjectBuilder();
+    ~QJsonObjectBuilder();
+
+    void reserve(int size);
+    void insert(const QString &key, const QJsonValue &value);
+    int count() const;
+    void clear();
+
+    QJsonObject toObject() const;
+
+private:
+    Q_DISABLE_COPY(QJsonObjectBuilder)
+    Q_DECLARE_PRIVATE(QJsonObjectBuilder)
+    QScopedPointer<QJsonObjectBuilderPrivate> d_ptr;
+};
+
+class QJsonArrayBuilderPrivate;
+class Q_CORE_EXPORT QJsonArrayBuilder
+{
+public:
+    QJsonArrayBuilder();
+    ~QJsonArrayBuilder();
+
+    void reserve(int size);
+    void append(const QJsonValue &value);
+    int count() const;
+    void clear();
+
+    QJsonArray toArray() const;
+
+private:
+    Q_DISABLE_COPY(QJsonArrayBuilder)
+    Q_DECLARE_PRIVATE(QJsonArrayBuilder)
+    QScopedPointer<QJsonArrayBuilderPrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QJSONBUILDER_H
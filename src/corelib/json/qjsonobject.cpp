@@ -40,6 +40,7 @@
 #include <qjsonobject.h>
 #include <qjsonvalue.h>
 #include <qjsonarray.h>
+#include <qjsonbuilder.h>
 #include <qstringlist.h>
 #include <qdebug.h>
 #include <qvariant.h>
@@ -306,12 +307,11 @@ QVariantMap QJsonObject::toVariantMap() const
  */
 QJsonObject QJsonObject::fromVariantHash(const QVariantHash &hash)
 {
-    // ### this is implemented the trivial way, not the most efficient way
-
-    QJsonObject object;
+    QJsonObjectBuilder builder;
+    builder.reserve(hash.size());
     for (QVariantHash::const_iterator it = hash.constBegin(); it != hash.constEnd(); ++it)
-        object.insert(it.key(), QJsonValue::fromVariant(it.value()));
-    return object;
+        builder.insert(it.key(), QJsonValue::fromVariant(it.value()));
+    return builder.toObject();
 }
 
 /*!
@@ -241,6 +241,7 @@ private:
     friend class QJsonPrivate::Data;
     friend class QJsonValue;
     friend class QJsonDocument;
+    friend class QJsonObjectBuilder;
     friend class QJsonValueRef;
 
     friend Q_CORE_EXPORT QDebug operator<<(QDebug, const QJsonObject &);
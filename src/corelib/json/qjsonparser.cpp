@@ -45,6 +45,7 @@
 #include "qjsonparser_p.h"
 #include "qjson_p.h"
 #include "private/qutfcodec_p.h"
+#include "private/qsimd_p.h"
 
 //#define PARSER_DEBUG
 #ifdef PARSER_DEBUG
@@ -256,8 +257,92 @@ void Parser::eatBOM()
         json += 3;
 }
 
+/*
+    The vector scanners below look at 16 or 32 bytes of the input at a
+    time. Each one stops at the first byte it is looking for, or when less
+    than a full vector is left; the caller finishes with the scalar loop.
+*/
+#if defined(__ARM_NEON__)
+// NEON has no movemask: narrow the comparison result to four bits per byte
+static inline quint64 neonByteMask(uint8x16_t bytes)
+{
+    const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(bytes), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+}
+#endif
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static const char *skipSpaceAvx2(const char *p, const char *end)
+{
+    const __m256i space = _mm256_set1_epi8(Space);
+    const __m256i tab = _mm256_set1_epi8(Tab);
+    const __m256i lineFeed = _mm256_set1_epi8(LineFeed);
+    const __m256i ret = _mm256_set1_epi8(Return);
+    for ( ; end - p >= 32; p += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i isSpace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+                                                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lineFeed), _mm256_cmpeq_epi8(chunk, ret)));
+        const uint mask = ~uint(_mm256_movemask_epi8(isSpace));
+        if (mask)
+            return p + qCountTrailingZeroBits(mask);
+    }
+    return p;
+}
+#endif
+
+#if defined(__SSE2__)
+// returns a mask of the bytes at p that are not whitespace
+static inline uint nonSpaceMaskSse2(const char *p)
+{
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i isSpace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(Space)),
+                                                      _mm_cmpeq_epi8(chunk, _mm_set1_epi8(Tab))),
+                                         _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(LineFeed)),
+                                                      _mm_cmpeq_epi8(chunk, _mm_set1_epi8(Return))));
+    return ~uint(_mm_movemask_epi8(isSpace)) & 0xffff;
+}
+#endif
+
+static inline const char *skipSpace(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+    if (end - p >= 16) {
+        if (const uint mask = nonSpaceMaskSse2(p))
+            return p + qCountTrailingZeroBits(mask);
+        p += 16;
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+        // most whitespace is a short indentation; only a run that is
+        // longer than one block is worth the wider vectors
+        if (qCpuHasFeature(AVX2))
+            p = skipSpaceAvx2(p, end);
+#  endif
+    }
+    for ( ; end - p >= 16; p += 16) {
+        if (const uint mask = nonSpaceMaskSse2(p))
+            return p + qCountTrailingZeroBits(mask);
+    }
+#elif defined(__ARM_NEON__)
+    const uint8x16_t space = vdupq_n_u8(Space);
+    const uint8x16_t tab = vdupq_n_u8(Tab);
+    const uint8x16_t lineFeed = vdupq_n_u8(LineFeed);
+    const uint8x16_t ret = vdupq_n_u8(Return);
+    for ( ; end - p >= 16; p += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+        const uint8x16_t isSpace = vorrq_u8(vorrq_u8(vceqq_u8(chunk, space), vceqq_u8(chunk, tab)),
+                                            vorrq_u8(vceqq_u8(chunk, lineFeed), vceqq_u8(chunk, ret)));
+        const quint64 mask = ~neonByteMask(isSpace);
+        if (mask)
+            return p + qCountTrailingZeroBits(mask) / 4;
+    }
+#endif
+    return p;
+}
+
 bool Parser::eatSpace()
 {
+    // skip indentation a vector at a time
+    json = skipSpace(json, end);
     while (json < end) {
         if (*json > Space)
             break;
@@ -732,13 +817,9 @@ bool Parser::parseValue(QJsonPrivate::Value *val, int baseOffset)
 
 */
 
-bool Parser::parseNumber(QJsonPrivate::Value *val, int baseOffset)
+const char *QJsonPrivate::scanNumber(const char *json, const char *end, bool *isInt)
 {
-    BEGIN << "parseNumber" << json;
-    val->type = QJsonValue::Double;
-
-    const char *start = json;
-    bool isInt = true;
+    *isInt = true;
 
     // minus
     if (json < end && *json == '-')
@@ -754,7 +835,7 @@ bool Parser::parseNumber(QJsonPrivate::Value *val, int baseOffset)
 
     // frac = decimal-point 1*DIGIT
     if (json < end && *json == '.') {
-        isInt = false;
+        *isInt = false;
         ++json;
         while (json < end && *json >= '0' && *json <= '9')
             ++json;
@@ -762,7 +843,7 @@ bool Parser::parseNumber(QJsonPrivate::Value *val, int baseOffset)
 
     // exp = e [ minus / plus ] 1*DIGIT
     if (json < end && (*json == 'e' || *json == 'E')) {
-        isInt = false;
+        *isInt = false;
         ++json;
         if (json < end && (*json == '-' || *json == '+'))
             ++json;
@@ -770,6 +851,18 @@ bool Parser::parseNumber(QJsonPrivate::Value *val, int baseOffset)
             ++json;
     }
 
+    return json;
+}
+
+bool Parser::parseNumber(QJsonPrivate::Value *val, int baseOffset)
+{
+    BEGIN << "parseNumber" << json;
+    val->type = QJsonValue::Double;
+
+    const char *start = json;
+    bool isInt;
+    json = scanNumber(json, end, &isInt);
+
     if (json >= end) {
         lastError = QJsonParseError::TerminationByNumber;
         return false;
@@ -838,6 +931,75 @@ bool Parser::parseNumber(QJsonPrivate::Value *val, int baseOffset)
 
         unescaped = %x20-21 / %x23-5B / %x5D-10FFFF
  */
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static const char *skipPlainAsciiAvx2(const char *p, const char *end)
+{
+    const __m256i quote = _mm256_set1_epi8(Quote);
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    for ( ; end - p >= 32; p += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash));
+        const uint mask = _mm256_movemask_epi8(_mm256_or_si256(special, chunk));
+        if (mask)
+            return p + qCountTrailingZeroBits(mask);
+    }
+    return p;
+}
+#endif
+
+#if defined(__SSE2__)
+// returns a mask of the bytes at p that are '"', '\\' or not ASCII
+static inline uint specialMaskSse2(const char *p)
+{
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(Quote)),
+                                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')));
+    // the sign bit is set for the special characters and for non-ASCII ones
+    return _mm_movemask_epi8(_mm_or_si128(special, chunk));
+}
+#endif
+
+/*
+    Returns the number of characters at the beginning of [json, end) that
+    can be copied to the output as they are: ASCII characters other than
+    the quotation mark and the reverse solidus.
+*/
+static inline int plainAsciiLength(const char *json, const char *end)
+{
+    const char *p = json;
+#if defined(__SSE2__)
+    if (end - p >= 16) {
+        if (const uint mask = specialMaskSse2(p))
+            return qCountTrailingZeroBits(mask);
+        p += 16;
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+        if (qCpuHasFeature(AVX2))
+            p = skipPlainAsciiAvx2(p, end);
+#  endif
+    }
+    for ( ; end - p >= 16; p += 16) {
+        if (const uint mask = specialMaskSse2(p))
+            return int(p - json) + qCountTrailingZeroBits(mask);
+    }
+#elif defined(__ARM_NEON__)
+    const uint8x16_t quote = vdupq_n_u8(Quote);
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t maxAscii = vdupq_n_u8(0x7f);
+    for ( ; end - p >= 16; p += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+        const uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                                            vcgtq_u8(chunk, maxAscii));
+        const quint64 mask = neonByteMask(special);
+        if (mask)
+            return int(p - json) + qCountTrailingZeroBits(mask) / 4;
+    }
+#endif
+    while (p < end && uchar(*p) < 0x80 && *p != Quote && *p != '\\')
+        ++p;
+    return int(p - json);
+}
+
 static inline bool addHexDigit(char digit, uint *result)
 {
     *result <<= 4;
@@ -852,7 +1014,7 @@ static inline bool addHexDigit(char digit, uint *result)
     return true;
 }
 
-static inline bool scanEscapeSequence(const char *&json, const char *end, uint *ch)
+bool QJsonPrivate::scanEscapeSequence(const char *&json, const char *end, uint *ch)
 {
     ++json;
     if (json >= end)
@@ -897,7 +1059,7 @@ static inline bool scanEscapeSequence(const char *&json, const char *end, uint *
     return true;
 }
 
-static inline bool scanUtf8Char(const char *&json, const char *end, uint *result)
+bool QJsonPrivate::scanUtf8Char(const char *&json, const char *end, uint *result)
 {
     const uchar *&src = reinterpret_cast<const uchar *&>(json);
     const uchar *uend = reinterpret_cast<const uchar *>(end);
@@ -927,6 +1089,19 @@ bool Parser::parseString(bool *latin1)
 
     BEGIN << "parse string stringPos=" << stringPos << json;
     while (json < end) {
+        // copy runs of plain characters in one go, staying below the
+        // length limit for latin1 strings checked below
+        const int length = qMin(plainAsciiLength(json, end), int(0x7fff - (json - start)));
+        if (length > 0) {
+            int pos = reserveSpace(length);
+            if (pos < 0)
+                return false;
+            memcpy(data + pos, json, length);
+            json += length;
+            if (json >= end)
+                break;
+        }
+
         uint ch = 0;
         if (*json == '"')
             break;
@@ -979,6 +1154,18 @@ bool Parser::parseString(bool *latin1)
     current = outStart + sizeof(int);
 
     while (json < end) {
+        const int length = plainAsciiLength(json, end);
+        if (length > 0) {
+            int pos = reserveSpace(2 * length);
+            if (pos < 0)
+                return false;
+            for (int i = 0; i < length; ++i)
+                *(QJsonPrivate::qle_ushort *)(data + pos + 2 * i) = uchar(json[i]);
+            json += length;
+            if (json >= end)
+                break;
+        }
+
         uint ch = 0;
         if (*json == '"')
             break;
@@ -54,11 +54,18 @@
 #include <QtCore/private/qglobal_p.h>
 #include <qjsondocument.h>
 #include <qvarlengtharray.h>
+#include <qvector.h>
 
 QT_BEGIN_NAMESPACE
 
 namespace QJsonPrivate {
 
+// Low-level scanners, shared with QJsonStreamReader. They advance json past
+// the scanned characters and never read at or beyond end.
+bool scanEscapeSequence(const char *&json, const char *end, uint *ch);
+bool scanUtf8Char(const char *&json, const char *end, uint *result);
+const char *scanNumber(const char *json, const char *end, bool *isInt);
+
 class Parser
 {
 public:
@@ -0,0 +1,1267 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qjsonstream.h"
+#include "qjsonbuilder.h"
+#include "qjsonparser_p.h"
+#include "qjsonwriter_p.h"
+
+#include <qiodevice.h>
+#include <qvarlengtharray.h>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+static const int nestingLimit = 1024;
+static const int readChunkSize = 64 * 1024;
+static const int writeBufferSize = 64 * 1024;
+
+class QJsonStreamReaderPrivate
+{
+public:
+    enum State {
+        ExpectDocument,
+        ExpectFirstMember,
+        ExpectMember,
+        ExpectFirstElement,
+        ExpectElement,
+        ExpectMemberValue,
+        ExpectSeparator
+    };
+
+    enum Result {
+        Done,
+        NeedMoreData,
+        Failed
+    };
+
+    QJsonStreamReaderPrivate()
+        : device(nullptr), pos(0), discarded(0), stringScanned(0), state(ExpectDocument),
+          type(QJsonStreamReader::NoToken), error(QJsonParseError::NoError),
+          incompleteError(QJsonParseError::NoError), errorIsRecoverable(false),
+          exhausted(false), markOffset(-1), markState(ExpectDocument),
+          markType(QJsonStreamReader::NoToken)
+    {}
+
+    QJsonStreamReader::TokenType readNext();
+    Result scanToken();
+    Result scanString(const char *&p, const char *end, QString *string);
+    Result scanValue(const char *&p, const char *end);
+    bool startContainer(char c);
+    void endContainer();
+    bool fetchMoreData();
+    void discardConsumedData();
+    void setMark();
+    void rewindToMark();
+
+    inline Result fail(QJsonParseError::ParseError e)
+    {
+        error = e;
+        errorIsRecoverable = false;
+        return Failed;
+    }
+
+    inline Result needMoreData(QJsonParseError::ParseError e)
+    {
+        incompleteError = e;
+        return NeedMoreData;
+    }
+
+    inline QJsonParseError::ParseError unterminatedContainerError() const
+    {
+        if (stack.isEmpty())
+            return QJsonParseError::IllegalValue;
+        return stack.last() == '{' ? QJsonParseError::UnterminatedObject
+                                   : QJsonParseError::UnterminatedArray;
+    }
+
+    QIODevice *device;
+    QByteArray buffer;
+    int pos;
+    qint64 discarded;
+    // bytes of the string at pos that are known not to contain its end
+    int stringScanned;
+    QVarLengthArray<char, 64> stack;
+    State state;
+
+    QJsonStreamReader::TokenType type;
+    QString name;
+    QJsonValue value;
+
+    QJsonParseError::ParseError error;
+    QJsonParseError::ParseError incompleteError;
+    bool errorIsRecoverable;
+    bool exhausted;
+
+    // the token readCurrentValue() started at; the data after it is kept
+    // until the value is complete, so that it can be read again
+    qint64 markOffset;
+    QVarLengthArray<char, 64> markStack;
+    State markState;
+    QJsonStreamReader::TokenType markType;
+    QString markName;
+};
+
+void QJsonStreamReaderPrivate::discardConsumedData()
+{
+    int consumed = pos;
+    if (markOffset >= 0)
+        consumed = qMin(consumed, int(markOffset - discarded));
+    if (consumed == 0)
+        return;
+    if (consumed == buffer.size())
+        buffer.clear();
+    else
+        buffer.remove(0, consumed);
+    discarded += consumed;
+    pos -= consumed;
+}
+
+void QJsonStreamReaderPrivate::setMark()
+{
+    markOffset = discarded + pos;
+    markStack = stack;
+    markState = state;
+    markType = type;
+    markName = name;
+}
+
+/*
+    Goes back to the token readCurrentValue() started at, keeping the
+    error that made it stop.
+*/
+void QJsonStreamReaderPrivate::rewindToMark()
+{
+    pos = int(markOffset - discarded);
+    stringScanned = 0;
+    stack = markStack;
+    state = markState;
+    type = markType;
+    name = markName;
+    value = QJsonValue();
+}
+
+bool QJsonStreamReaderPrivate::fetchMoreData()
+{
+    if (!device)
+        return false;
+    discardConsumedData();
+    const int oldSize = buffer.size();
+    buffer.resize(oldSize + readChunkSize);
+    const qint64 bytesRead = device->read(buffer.data() + oldSize, readChunkSize);
+    buffer.resize(oldSize + int(qMax(bytesRead, qint64(0))));
+    return bytesRead > 0;
+}
+
+bool QJsonStreamReaderPrivate::startContainer(char c)
+{
+    if (stack.size() >= nestingLimit) {
+        fail(QJsonParseError::DeepNesting);
+        return false;
+    }
+    stack.append(c);
+    if (c == '{') {
+        state = ExpectFirstMember;
+        type = QJsonStreamReader::StartObject;
+    } else {
+        state = ExpectFirstElement;
+        type = QJsonStreamReader::StartArray;
+    }
+    return true;
+}
+
+void QJsonStreamReaderPrivate::endContainer()
+{
+    type = stack.last() == '{' ? QJsonStreamReader::EndObject : QJsonStreamReader::EndArray;
+    stack.removeLast();
+    state = stack.isEmpty() ? ExpectDocument : ExpectSeparator;
+}
+
+static inline const char *skipSpace(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+/*
+    Decodes the string starting after the opening quote at \a p. The whole
+    string has to be in the buffer, so look for the closing quote first.
+    If it is not there yet, remember how far we looked, so that a long
+    string arriving in many chunks is not searched from its start again
+    for every chunk.
+*/
+QJsonStreamReaderPrivate::Result
+QJsonStreamReaderPrivate::scanString(const char *&p, const char *end, QString *string)
+{
+    const char *quote = p + stringScanned;
+    while (true) {
+        quote = static_cast<const char *>(memchr(quote, '"', end - quote));
+        if (!quote) {
+            stringScanned = int(end - p);
+            return needMoreData(QJsonParseError::UnterminatedString);
+        }
+        const char *backslash = quote;
+        while (backslash > p && backslash[-1] == '\\')
+            --backslash;
+        if ((quote - backslash) % 2 == 0)
+            break;
+        ++quote;
+    }
+    stringScanned = 0;
+
+    string->resize(int(quote - p));
+    ushort *out = reinterpret_cast<ushort *>(string->data());
+    ushort *const begin = out;
+    while (p < quote) {
+        uint ch;
+        if (*p == '\\') {
+            if (!QJsonPrivate::scanEscapeSequence(p, quote, &ch))
+                return fail(QJsonParseError::IllegalEscapeSequence);
+        } else if (uchar(*p) < 0x80) {
+            ch = uchar(*p++);
+        } else if (!QJsonPrivate::scanUtf8Char(p, quote, &ch)) {
+            return fail(QJsonParseError::IllegalUTF8String);
+        }
+        if (QChar::requiresSurrogates(ch)) {
+            *out++ = QChar::highSurrogate(ch);
+            *out++ = QChar::lowSurrogate(ch);
+        } else {
+            *out++ = ushort(ch);
+        }
+    }
+    string->truncate(int(out - begin));
+    p = quote + 1;
+    return Done;
+}
+
+static inline bool matchLiteral(const char *p, const char *end, const char *literal, int length,
+                                bool *complete)
+{
+    const int available = int(qMin(ptrdiff_t(length), end - p));
+    *complete = available == length;
+    return memcmp(p, literal, available) == 0;
+}
+
+QJsonStreamReaderPrivate::Result QJsonStreamReaderPrivate::scanValue(const char *&p, const char *end)
+{
+    switch (*p) {
+    case '{':
+    case '[':
+        if (!startContainer(*p))
+            return Failed;
+        ++p;
+        return Done;
+    case '"': {
+        QString string;
+        ++p;
+        const Result result = scanString(p, end, &string);
+        if (result != Done)
+            return result;
+        value = QJsonValue(string);
+        break;
+    }
+    case 't':
+    case 'f':
+    case 'n': {
+        static const char *const literals[] = { "true", "false", "null" };
+        const int index = *p == 't' ? 0 : *p == 'f' ? 1 : 2;
+        const int length = int(strlen(literals[index]));
+        bool complete;
+        if (!matchLiteral(p, end, literals[index], length, &complete))
+            return fail(QJsonParseError::IllegalValue);
+        if (!complete)
+            return needMoreData(QJsonParseError::IllegalValue);
+        p += length;
+        value = index == 2 ? QJsonValue(QJsonValue::Null) : QJsonValue(index == 0);
+        break;
+    }
+    case ',':
+        // Essentially missing value, but after a colon, not after a comma
+        // like the other MissingObject errors.
+        return fail(QJsonParseError::IllegalValue);
+    case '}':
+    case ']':
+        return fail(QJsonParseError::MissingObject);
+    default: {
+        bool isInt;
+        const char *numberEnd = QJsonPrivate::scanNumber(p, end, &isInt);
+        if (numberEnd >= end)
+            return needMoreData(QJsonParseError::TerminationByNumber);
+        bool ok;
+        const double d = QByteArray::fromRawData(p, int(numberEnd - p)).toDouble(&ok);
+        if (!ok)
+            return fail(QJsonParseError::IllegalNumber);
+        p = numberEnd;
+        value = QJsonValue(d);
+        break;
+    }
+    }
+
+    type = QJsonStreamReader::Value;
+    state = ExpectSeparator;
+    return Done;
+}
+
+/*
+    Scans one token from the buffer. The read position is only advanced
+    past complete tokens, so a token can be rescanned once more data is
+    available.
+*/
+QJsonStreamReaderPrivate::Result QJsonStreamReaderPrivate::scanToken()
+{
+    const char *const begin = buffer.constData();
+    const char *const end = begin + buffer.size();
+    const char *p = begin + pos;
+
+    while (true) {
+        p = skipSpace(p, end);
+        pos = int(p - begin);
+        if (p == end)
+            return needMoreData(unterminatedContainerError());
+
+        switch (state) {
+        case ExpectDocument:
+            if (discarded + pos == 0 && uchar(*p) == 0xef) {
+                // eat UTF-8 byte order mark
+                bool complete;
+                if (!matchLiteral(p, end, "\xef\xbb\xbf", 3, &complete))
+                    return fail(QJsonParseError::IllegalValue);
+                if (!complete)
+                    return needMoreData(QJsonParseError::IllegalValue);
+                p += 3;
+                continue;
+            }
+            if (*p != '{' && *p != '[')
+                return fail(QJsonParseError::IllegalValue);
+            if (!startContainer(*p))
+                return Failed;
+            ++p;
+            break;
+
+        case ExpectFirstMember:
+        case ExpectMember:
+            if (*p == '}') {
+                if (state == ExpectMember)
+                    return fail(QJsonParseError::MissingObject);
+                endContainer();
+                ++p;
+                break;
+            }
+            if (*p != '"')
+                return fail(QJsonParseError::UnterminatedObject);
+            {
+                ++p;
+                const Result result = scanString(p, end, &name);
+                if (result != Done)
+                    return result;
+                p = skipSpace(p, end);
+                if (p == end)
+                    return needMoreData(QJsonParseError::UnterminatedObject);
+                if (*p != ':')
+                    return fail(QJsonParseError::MissingNameSeparator);
+                ++p;
+            }
+            type = QJsonStreamReader::Name;
+            state = ExpectMemberValue;
+            break;
+
+        case ExpectFirstElement:
+            if (*p == ']') {
+                endContainer();
+                ++p;
+                break;
+            }
+            Q_FALLTHROUGH();
+        case ExpectElement:
+        case ExpectMemberValue: {
+            const Result result = scanValue(p, end);
+            if (result != Done)
+                return result;
+            break;
+        }
+
+        case ExpectSeparator:
+            if (*p == ',') {
+                state = stack.last() == '{' ? ExpectMember : ExpectElement;
+                ++p;
+                continue;
+            }
+            if (*p == (stack.last() == '{' ? '}' : ']')) {
+                endContainer();
+                ++p;
+                break;
+            }
+            return fail(stack.last() == '{' ? QJsonParseError::UnterminatedObject
+                                            : QJsonParseError::MissingValueSeparator);
+        }
+
+        pos = int(p - begin);
+        return Done;
+    }
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readNext()
+{
+    if (error != QJsonParseError::NoError) {
+        if (!errorIsRecoverable)
+            return type;
+        error = QJsonParseError::NoError;
+        errorIsRecoverable = false;
+    }
+
+    name.clear();
+    value = QJsonValue();
+
+    while (true) {
+        const Result result = scanToken();
+        if (result == Done) {
+            exhausted = false;
+            return type;
+        }
+        if (result == Failed) {
+            type = QJsonStreamReader::Invalid;
+            return type;
+        }
+        if (!fetchMoreData())
+            break;
+    }
+
+    discardConsumedData();
+    if (state == ExpectDocument && buffer.isEmpty()) {
+        // between two documents, so there is nothing to complain about
+        exhausted = true;
+        type = QJsonStreamReader::NoToken;
+        return type;
+    }
+
+    error = incompleteError;
+    errorIsRecoverable = true;
+    type = QJsonStreamReader::Invalid;
+    return type;
+}
+
+/*!
+    \class QJsonStreamReader
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.10
+
+    \brief The QJsonStreamReader class provides a fast pull parser for
+    reading JSON documents incrementally.
+
+    QJsonDocument::fromJson() needs the whole text in memory and builds the
+    complete document before it returns. QJsonStreamReader instead reports
+    the document one token at a time, so arbitrarily large documents can be
+    processed with memory proportional to the largest single string or
+    number in them. Like QXmlStreamReader, it reads from a QIODevice set
+    with setDevice(), or from data supplied in chunks with addData().
+
+    The basic concept is to call readNext() in a loop, and to act on the
+    returned token:
+
+    \snippet code/src_corelib_json_qjsonstream.cpp 0
+
+    Each object starts with a StartObject token and ends with an EndObject
+    token. Every member of an object is reported as a Name token, followed
+    by either a Value token or a nested object or array. Arrays are reported
+    as StartArray, followed by their elements, and EndArray. Strings,
+    numbers, booleans and null are reported as Value tokens; use value() to
+    retrieve them. readCurrentValue() reads a complete nested object or
+    array into a QJsonValue, and skipCurrentValue() skips it.
+
+    As with QJsonDocument, each document has to be an object or an array.
+    The reader accepts any number of documents separated by whitespace, so
+    newline-delimited JSON can be read with a single reader: after the
+    EndObject or EndArray token closing one document, the next call to
+    readNext() starts the following one.
+
+    If the input ends in the middle of a document, readNext() returns
+    Invalid and error() describes what was left unterminated. Such an error
+    is not final: once more data is available, either through addData() or
+    because the device has received more data, the next call to readNext()
+    continues where the reader stopped. All other errors are final.
+
+    \sa QJsonStreamWriter, QJsonDocument, QXmlStreamReader
+*/
+
+/*!
+    \enum QJsonStreamReader::TokenType
+
+    This enum specifies the type of token the reader just read.
+
+    \value NoToken The reader has not yet read anything, or has read all
+    available documents.
+    \value Invalid An error has occurred, reported in error() and
+    errorString().
+    \value StartObject The reader reports the start of an object.
+    \value EndObject The reader reports the end of an object.
+    \value StartArray The reader reports the start of an array.
+    \value EndArray The reader reports the end of an array.
+    \value Name The reader reports the name of an object member in name().
+    \value Value The reader reports a string, number, boolean or null
+    value in value().
+*/
+
+/*!
+    Constructs a stream reader.
+
+    \sa setDevice(), addData()
+*/
+QJsonStreamReader::QJsonStreamReader()
+    : d_ptr(new QJsonStreamReaderPrivate)
+{
+}
+
+/*!
+    Creates a new stream reader that reads from \a device.
+*/
+QJsonStreamReader::QJsonStreamReader(QIODevice *device)
+    : d_ptr(new QJsonStreamReaderPrivate)
+{
+    setDevice(device);
+}
+
+/*!
+    Creates a new stream reader that reads from \a data.
+
+    \sa addData()
+*/
+QJsonStreamReader::QJsonStreamReader(const QByteArray &data)
+    : d_ptr(new QJsonStreamReaderPrivate)
+{
+    d_ptr->buffer = data;
+}
+
+/*!
+    Destructs the reader.
+*/
+QJsonStreamReader::~QJsonStreamReader()
+{
+}
+
+/*!
+    Sets the current device to \a device. Setting the device resets the
+    reader to its initial state.
+
+    \sa device(), clear()
+*/
+void QJsonStreamReader::setDevice(QIODevice *device)
+{
+    clear();
+    d_ptr->device = device;
+}
+
+/*!
+    Returns the current device associated with the reader, or \nullptr if
+    no device has been assigned.
+
+    \sa setDevice()
+*/
+QIODevice *QJsonStreamReader::device() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->device;
+}
+
+/*!
+    Adds more \a data for the reader to read. This function does nothing
+    if the reader has a device().
+
+    \sa readNext(), clear()
+*/
+void QJsonStreamReader::addData(const QByteArray &data)
+{
+    Q_D(QJsonStreamReader);
+    if (d->device) {
+        qWarning("QJsonStreamReader: addData() with device()");
+        return;
+    }
+    d->discardConsumedData();
+    d->buffer += data;
+    d->exhausted = false;
+}
+
+/*!
+    Removes any device() or data from the reader and resets its internal
+    state to the initial state.
+
+    \sa addData()
+*/
+void QJsonStreamReader::clear()
+{
+    d_ptr.reset(new QJsonStreamReaderPrivate);
+}
+
+/*!
+    Returns \c true if the reader has read all available documents, or if
+    an error() has occurred. Otherwise, it returns \c false.
+
+    \sa hasError(), readNext()
+*/
+bool QJsonStreamReader::atEnd() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->exhausted || d->error != QJsonParseError::NoError;
+}
+
+/*!
+    Reads the next token and returns its type.
+
+    If the reader has no more input but is between two documents, NoToken
+    is returned and atEnd() becomes \c true. If the input ends inside a
+    document, Invalid is returned; see the class documentation for how to
+    continue once more data is available.
+
+    \sa tokenType(), tokenString()
+*/
+QJsonStreamReader::TokenType QJsonStreamReader::readNext()
+{
+    Q_D(QJsonStreamReader);
+    return d->readNext();
+}
+
+/*!
+    Returns the type of the current token.
+
+    \sa tokenString()
+*/
+QJsonStreamReader::TokenType QJsonStreamReader::tokenType() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->type;
+}
+
+/*!
+    Returns the reader's current token as a string.
+
+    \sa tokenType()
+*/
+QString QJsonStreamReader::tokenString() const
+{
+    static const char *const tokenNames[] = {
+        "NoToken", "Invalid", "StartObject", "EndObject",
+        "StartArray", "EndArray", "Name", "Value"
+    };
+    return QLatin1String(tokenNames[tokenType()]);
+}
+
+/*!
+    Returns the member name of a Name token; otherwise returns an empty
+    string.
+*/
+QString QJsonStreamReader::name() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->name;
+}
+
+/*!
+    Returns the value of a Value token. For all other tokens, an undefined
+    QJsonValue is returned.
+
+    \sa readCurrentValue()
+*/
+QJsonValue QJsonStreamReader::value() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->value;
+}
+
+/*!
+    Reads the value that starts at the current token and returns it.
+
+    For a StartObject or StartArray token, the complete object or array is
+    read and returned, and the current token becomes the matching
+    EndObject or EndArray token. For a Name token, the member's value is
+    read. For a Value token, value() is returned.
+
+    If the value is not well-formed, an undefined QJsonValue is returned
+    and hasError() is \c true. If the input ends inside the value, an
+    undefined QJsonValue is returned as well, but the reader goes back to
+    the token it started at, so that readCurrentValue() can be called again
+    once more data is available.
+
+    \sa skipCurrentValue()
+*/
+QJsonValue QJsonStreamReader::readCurrentValue()
+{
+    Q_D(QJsonStreamReader);
+    const TokenType token = tokenType();
+    if (d->markOffset < 0 && (token == Name || token == StartObject || token == StartArray)) {
+        d->setMark();
+        const QJsonValue result = readCurrentValue();
+        if (hasError() && d->errorIsRecoverable)
+            d->rewindToMark();
+        d->markOffset = -1;
+        return result;
+    }
+
+    switch (token) {
+    case Name:
+        if (readNext() == Invalid)
+            return QJsonValue(QJsonValue::Undefined);
+        return readCurrentValue();
+    case Value:
+        return value();
+    case StartObject: {
+        QJsonObjectBuilder object;
+        while (readNext() == Name) {
+            const QString key = name();
+            readNext();
+            const QJsonValue v = readCurrentValue();
+            if (hasError())
+                return QJsonValue(QJsonValue::Undefined);
+            object.insert(key, v);
+        }
+        if (tokenType() != EndObject)
+            return QJsonValue(QJsonValue::Undefined);
+        return object.toObject();
+    }
+    case StartArray: {
+        QJsonArrayBuilder array;
+        while (true) {
+            const TokenType token = readNext();
+            if (token == EndArray || token == Invalid)
+                break;
+            const QJsonValue v = readCurrentValue();
+            if (hasError())
+                return QJsonValue(QJsonValue::Undefined);
+            array.append(v);
+        }
+        if (tokenType() != EndArray)
+            return QJsonValue(QJsonValue::Undefined);
+        return array.toArray();
+    }
+    default:
+        return QJsonValue(QJsonValue::Undefined);
+    }
+}
+
+/*!
+    Skips the value that starts at the current token. For a StartObject
+    or StartArray token, everything up to and including the matching
+    EndObject or EndArray token is skipped. For a Name token, the member's
+    value is skipped.
+
+    \sa readCurrentValue()
+*/
+void QJsonStreamReader::skipCurrentValue()
+{
+    if (tokenType() == Name)
+        readNext();
+    if (tokenType() != StartObject && tokenType() != StartArray)
+        return;
+
+    const int level = depth();
+    while (depth() >= level) {
+        if (readNext() == Invalid)
+            return;
+    }
+}
+
+/*!
+    Returns the number of objects and arrays the reader is currently
+    inside of. The StartObject and StartArray tokens already count the
+    container they open.
+*/
+int QJsonStreamReader::depth() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->stack.size();
+}
+
+/*!
+    Returns the offset in bytes from the beginning of the input up to
+    where the reader stopped. After an error, this is the beginning of the
+    token that could not be read.
+*/
+qint64 QJsonStreamReader::characterOffset() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->discarded + d->pos;
+}
+
+/*!
+    Returns \c true if an error has occurred, otherwise \c false.
+
+    \sa error(), errorString()
+*/
+bool QJsonStreamReader::hasError() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->error != QJsonParseError::NoError;
+}
+
+/*!
+    Returns the type of the current error, or QJsonParseError::NoError if
+    no error occurred.
+
+    \sa errorString(), hasError()
+*/
+QJsonParseError::ParseError QJsonStreamReader::error() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->error;
+}
+
+/*!
+    Returns the human-readable message for the current error().
+*/
+QString QJsonStreamReader::errorString() const
+{
+    QJsonParseError e;
+    e.error = error();
+    e.offset = int(characterOffset());
+    return e.errorString();
+}
+
+class QJsonStreamWriterPrivate
+{
+public:
+    struct Level {
+        bool isObject;
+        bool isEmpty;
+    };
+
+    QJsonStreamWriterPrivate()
+        : device(nullptr), array(nullptr), format(QJsonDocument::Indented),
+          hasPendingName(false), hasError(false)
+    {}
+
+    inline QByteArray &output() { return array ? *array : buffer; }
+    bool beginValue(const char *function);
+    bool startContainer(bool isObject, const char *function);
+    void endValue();
+    void indent(QByteArray &json, int level) const;
+    void write();
+
+    QIODevice *device;
+    QByteArray *array;
+    QByteArray buffer;
+    QVarLengthArray<Level, 64> stack;
+    QJsonDocument::JsonFormat format;
+    QString pendingName;
+    bool hasPendingName;
+    bool hasError;
+};
+
+void QJsonStreamWriterPrivate::indent(QByteArray &json, int level) const
+{
+    if (format == QJsonDocument::Indented)
+        json.append(QByteArray(4 * level, ' '));
+}
+
+/*
+    Writes what has to come before a value: the separator and the
+    indentation for array elements. Member values already got theirs from
+    writeName().
+*/
+bool QJsonStreamWriterPrivate::beginValue(const char *function)
+{
+    if (stack.isEmpty())
+        return true;
+
+    Level &level = stack.last();
+    if (level.isObject) {
+        if (!hasPendingName) {
+            qWarning("QJsonStreamWriter::%s: a member needs a name", function);
+            return false;
+        }
+        hasPendingName = false;
+        return true;
+    }
+
+    QByteArray &json = output();
+    if (!level.isEmpty)
+        json += format == QJsonDocument::Compact ? "," : ",\n";
+    level.isEmpty = false;
+    indent(json, stack.size());
+    return true;
+}
+
+/*
+    Terminates a top-level document with a newline, so that several of
+    them form newline-delimited JSON, and hands the data to the device.
+*/
+void QJsonStreamWriterPrivate::endValue()
+{
+    if (!stack.isEmpty()) {
+        if (buffer.size() >= writeBufferSize)
+            write();
+        return;
+    }
+    output() += '\n';
+    write();
+}
+
+bool QJsonStreamWriterPrivate::startContainer(bool isObject, const char *function)
+{
+    if (!beginValue(function))
+        return false;
+    if (isObject)
+        output() += format == QJsonDocument::Compact ? "{" : "{\n";
+    else
+        output() += format == QJsonDocument::Compact ? "[" : "[\n";
+    stack.append({ isObject, true });
+    return true;
+}
+
+void QJsonStreamWriterPrivate::write()
+{
+    if (buffer.isEmpty())
+        return;
+    // without a device, the output is discarded like QXmlStreamWriter does
+    if (device && device->write(buffer) != buffer.size())
+        hasError = true;
+    buffer.clear();
+}
+
+/*!
+    \class QJsonStreamWriter
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.10
+
+    \brief The QJsonStreamWriter class provides a JSON writer with a
+    simple streaming API.
+
+    QJsonStreamWriter is the counterpart to QJsonStreamReader. It writes
+    JSON incrementally to a QIODevice or a QByteArray, so a document does
+    not have to be built as a QJsonDocument first. Objects and arrays are
+    opened with writeStartObject() and writeStartArray() and closed with
+    writeEndObject() and writeEndArray(). Object members are written with
+    writeName() followed by the value, or with writeMember():
+
+    \snippet code/src_corelib_json_qjsonstream.cpp 1
+
+    Values, including complete QJsonObject and QJsonArray values, are
+    written with writeValue(). Strings and numbers are formatted exactly
+    as QJsonDocument::toJson() does, and each document is followed by a
+    newline, so that writing several documents produces newline-delimited
+    JSON. With the default QJsonDocument::Indented format, the output for
+    a single document is identical to the output of
+    QJsonDocument::toJson().
+
+    Data is written to the device in blocks and at the end of each
+    document. Call flush() to write pending data earlier. If there is
+    neither a device nor a QByteArray to write to, the output is
+    discarded.
+
+    \sa QJsonStreamReader, QJsonDocument
+*/
+
+/*!
+    Constructs a stream writer.
+
+    \sa setDevice()
+*/
+QJsonStreamWriter::QJsonStreamWriter()
+    : d_ptr(new QJsonStreamWriterPrivate)
+{
+}
+
+/*!
+    Constructs a stream writer that writes into \a device.
+*/
+QJsonStreamWriter::QJsonStreamWriter(QIODevice *device)
+    : d_ptr(new QJsonStreamWriterPrivate)
+{
+    d_ptr->device = device;
+}
+
+/*!
+    Constructs a stream writer that appends to \a array.
+*/
+QJsonStreamWriter::QJsonStreamWriter(QByteArray *array)
+    : d_ptr(new QJsonStreamWriterPrivate)
+{
+    d_ptr->array = array;
+}
+
+/*!
+    Destructor. Writes pending data to the device.
+*/
+QJsonStreamWriter::~QJsonStreamWriter()
+{
+    flush();
+}
+
+/*!
+    Sets the current device to \a device. Pending data is written to the
+    previous device first.
+
+    \sa device()
+*/
+void QJsonStreamWriter::setDevice(QIODevice *device)
+{
+    Q_D(QJsonStreamWriter);
+    flush();
+    d->device = device;
+    d->array = nullptr;
+}
+
+/*!
+    Returns the current device associated with the writer, or \nullptr if
+    no device has been assigned.
+
+    \sa setDevice()
+*/
+QIODevice *QJsonStreamWriter::device() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->device;
+}
+
+/*!
+    Sets the output format to \a format. The default is
+    QJsonDocument::Indented.
+*/
+void QJsonStreamWriter::setFormat(QJsonDocument::JsonFormat format)
+{
+    Q_D(QJsonStreamWriter);
+    d->format = format;
+}
+
+/*!
+    Returns the output format.
+*/
+QJsonDocument::JsonFormat QJsonStreamWriter::format() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->format;
+}
+
+/*!
+    Opens a new object.
+
+    \sa writeEndObject()
+*/
+void QJsonStreamWriter::writeStartObject()
+{
+    Q_D(QJsonStreamWriter);
+    d->startContainer(true, "writeStartObject");
+}
+
+/*!
+    Closes the object opened last.
+
+    \sa writeStartObject()
+*/
+void QJsonStreamWriter::writeEndObject()
+{
+    Q_D(QJsonStreamWriter);
+    if (d->hasPendingName) {
+        qWarning("QJsonStreamWriter::writeEndObject: member \"%s\" has no value",
+                 qPrintable(d->pendingName));
+        return;
+    }
+    if (d->stack.isEmpty() || !d->stack.last().isObject) {
+        qWarning("QJsonStreamWriter::writeEndObject: no object to close");
+        return;
+    }
+    QByteArray &json = d->output();
+    if (!d->stack.last().isEmpty && d->format == QJsonDocument::Indented)
+        json += '\n';
+    d->stack.removeLast();
+    d->indent(json, d->stack.size());
+    json += '}';
+    d->endValue();
+}
+
+/*!
+    Opens a new array.
+
+    \sa writeEndArray()
+*/
+void QJsonStreamWriter::writeStartArray()
+{
+    Q_D(QJsonStreamWriter);
+    d->startContainer(false, "writeStartArray");
+}
+
+/*!
+    Closes the array opened last.
+
+    \sa writeStartArray()
+*/
+void QJsonStreamWriter::writeEndArray()
+{
+    Q_D(QJsonStreamWriter);
+    if (d->stack.isEmpty() || d->stack.last().isObject) {
+        qWarning("QJsonStreamWriter::writeEndArray: no array to close");
+        return;
+    }
+    QByteArray &json = d->output();
+    if (!d->stack.last().isEmpty && d->format == QJsonDocument::Indented)
+        json += '\n';
+    d->stack.removeLast();
+    d->indent(json, d->stack.size());
+    json += ']';
+    d->endValue();
+}
+
+/*!
+    Writes the \a name of the next member of the current object. It has to
+    be followed by its value.
+
+    \sa writeMember()
+*/
+void QJsonStreamWriter::writeName(const QString &name)
+{
+    Q_D(QJsonStreamWriter);
+    if (d->stack.isEmpty() || !d->stack.last().isObject || d->hasPendingName) {
+        qWarning("QJsonStreamWriter::writeName: not expecting a member name");
+        return;
+    }
+    QJsonStreamWriterPrivate::Level &level = d->stack.last();
+    const bool compact = d->format == QJsonDocument::Compact;
+    QByteArray &json = d->output();
+    if (!level.isEmpty)
+        json += compact ? "," : ",\n";
+    level.isEmpty = false;
+    d->indent(json, d->stack.size());
+    json += '"';
+    QJsonPrivate::Writer::escapedString(name, json);
+    json += compact ? "\":" : "\": ";
+    d->pendingName = name;
+    d->hasPendingName = true;
+}
+
+/*!
+    Writes \a value. Objects and arrays are written completely; at the top
+    level, only objects and arrays can be written.
+*/
+void QJsonStreamWriter::writeValue(const QJsonValue &value)
+{
+    Q_D(QJsonStreamWriter);
+    switch (value.type()) {
+    case QJsonValue::Object: {
+        const QJsonObject object = value.toObject();
+        if (!d->startContainer(true, "writeValue"))
+            return;
+        for (auto it = object.constBegin(), end = object.constEnd(); it != end; ++it)
+            writeMember(it.key(), it.value());
+        writeEndObject();
+        return;
+    }
+    case QJsonValue::Array: {
+        const QJsonArray array = value.toArray();
+        if (!d->startContainer(false, "writeValue"))
+            return;
+        for (const QJsonValue &v : array)
+            writeValue(v);
+        writeEndArray();
+        return;
+    }
+    default:
+        break;
+    }
+
+    if (d->stack.isEmpty()) {
+        qWarning("QJsonStreamWriter::writeValue: a document has to be an object or an array");
+        return;
+    }
+    if (!d->beginValue("writeValue"))
+        return;
+
+    QByteArray &json = d->output();
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        json += value.toBool() ? "true" : "false";
+        break;
+    case QJsonValue::Double:
+        QJsonPrivate::Writer::doubleToJson(value.toDouble(), json);
+        break;
+    case QJsonValue::String:
+        json += '"';
+        QJsonPrivate::Writer::escapedString(value.toString(), json);
+        json += '"';
+        break;
+    default:
+        json += "null";
+        break;
+    }
+    d->endValue();
+}
+
+/*!
+    Writes a member with the given \a name and \a value to the current
+    object. This is a convenience function equivalent to calling
+    writeName() followed by writeValue().
+*/
+void QJsonStreamWriter::writeMember(const QString &name, const QJsonValue &value)
+{
+    writeName(name);
+    writeValue(value);
+}
+
+/*!
+    Returns the number of objects and arrays that are currently open.
+*/
+int QJsonStreamWriter::depth() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->stack.size();
+}
+
+/*!
+    Writes all pending data to the device.
+*/
+void QJsonStreamWriter::flush()
+{
+    Q_D(QJsonStreamWriter);
+    d->write();
+}
+
+/*!
+    Returns \c true if writing to the device failed; otherwise returns
+    \c false.
+*/
+bool QJsonStreamWriter::hasError() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->hasError;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,144 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QJSONSTREAM_H
+#define QJSONSTREAM_H
+
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qscopedpointer.h>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+
+class QJsonStreamReaderPrivate;
+class Q_CORE_EXPORT QJsonStreamReader
+{
+public:
+    enum TokenType {
+        NoToken = 0,
+        Invalid,
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+        Name,
+        Value
+    };
+
+    QJsonStreamReader();
+    explicit QJsonStreamReader(QIODevice *device);
+    explicit QJsonStreamReader(const QByteArray &data);
+    ~QJsonStreamReader();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+    void addData(const QByteArray &data);
+    void clear();
+
+    bool atEnd() const;
+    TokenType readNext();
+
+    TokenType tokenType() const;
+    QString tokenString() const;
+
+    inline bool isStartObject() const { return tokenType() == StartObject; }
+    inline bool isEndObject() const { return tokenType() == EndObject; }
+    inline bool isStartArray() const { return tokenType() == StartArray; }
+    inline bool isEndArray() const { return tokenType() == EndArray; }
+    inline bool isName() const { return tokenType() == Name; }
+    inline bool isValue() const { return tokenType() == Value; }
+
+    QString name() const;
+    QJsonValue value() const;
+
+    QJsonValue readCurrentValue();
+    void skipCurrentValue();
+
+    int depth() const;
+    qint64 characterOffset() const;
+
+    bool hasError() const;
+    QJsonParseError::ParseError error() const;
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(QJsonStreamReader)
+    Q_DECLARE_PRIVATE(QJsonStreamReader)
+    QScopedPointer<QJsonStreamReaderPrivate> d_ptr;
+};
+
+class QJsonStreamWriterPrivate;
+class Q_CORE_EXPORT QJsonStreamWriter
+{
+public:
+    QJsonStreamWriter();
+    explicit QJsonStreamWriter(QIODevice *device);
+    explicit QJsonStreamWriter(QByteArray *array);
+    ~QJsonStreamWriter();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    void setFormat(QJsonDocument::JsonFormat format);
+    QJsonDocument::JsonFormat format() const;
+
+    void writeStartObject();
+    void writeEndObject();
+    void writeStartArray();
+    void writeEndArray();
+    void writeName(const QString &name);
+    void writeValue(const QJsonValue &value);
+    void writeMember(const QString &name, const QJsonValue &value);
+
+    int depth() const;
+    void flush();
+
+    bool hasError() const;
+
+private:
+    Q_DISABLE_COPY(QJsonStreamWriter)
+    Q_DECLARE_PRIVATE(QJsonStreamWriter)
+    QScopedPointer<QJsonStreamWriterPrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QJSONSTREAM_H
@@ -56,13 +56,16 @@ static inline uchar hexdig(uint u)
     return (u < 0xa ? '0' + u : 'a' + u - 0xa);
 }
 
-static QByteArray escapedString(const QString &s)
+void Writer::escapedString(const QString &s, QByteArray &json)
 {
     const uchar replacement = '?';
-    QByteArray ba(s.length(), Qt::Uninitialized);
+    // escape directly into the output, growing it as needed
+    QByteArray &ba = json;
+    const int offset = ba.size();
+    ba.resize(offset + s.length() + 6);
 
-    uchar *cursor = reinterpret_cast<uchar *>(const_cast<char *>(ba.constData()));
-    const uchar *ba_end = cursor + ba.length();
+    uchar *cursor = reinterpret_cast<uchar *>(ba.data()) + offset;
+    const uchar *ba_end = reinterpret_cast<const uchar *>(ba.constData()) + ba.length();
     const ushort *src = reinterpret_cast<const ushort *>(s.constBegin());
     const ushort *const end = reinterpret_cast<const ushort *>(s.constEnd());
 
@@ -70,7 +73,7 @@ static QByteArray escapedString(const QString &s)
         if (cursor >= ba_end - 6) {
             // ensure we have enough space
             int pos = cursor - (const uchar *)ba.constData();
-            ba.resize(ba.size()*2);
+            ba.resize(pos + 2 * (end - src) + 6);
             cursor = (uchar *)ba.data() + pos;
             ba_end = (const uchar *)ba.constData() + ba.length();
         }
@@ -118,7 +121,16 @@ static QByteArray escapedString(const QString &s)
     }
 
     ba.resize(cursor - (const uchar *)ba.constData());
-    return ba;
+}
+
+void Writer::doubleToJson(double d, QByteArray &json)
+{
+    if (qIsFinite(d)) {
+        const double abs = std::abs(d);
+        json += QByteArray::number(d, abs == static_cast<quint64>(abs) ? 'f' : 'g', QLocale::FloatingPointShortest);
+    } else {
+        json += "null"; // +INF || -INF || NaN (see RFC4627#section2.4)
+    }
 }
 
 static void valueToJson(const QJsonPrivate::Base *b, const QJsonPrivate::Value &v, QByteArray &json, int indent, bool compact)
@@ -128,19 +140,12 @@ static void valueToJson(const QJsonPrivate::Base *b, const QJsonPrivate::Value &
     case QJsonValue::Bool:
         json += v.toBoolean() ? "true" : "false";
         break;
-    case QJsonValue::Double: {
-        const double d = v.toDouble(b);
-        if (qIsFinite(d)) { // +2 to format to ensure the expected precision
-            const double abs = std::abs(d);
-            json += QByteArray::number(d, abs == static_cast<quint64>(abs) ? 'f' : 'g', QLocale::FloatingPointShortest);
-        } else {
-            json += "null"; // +INF || -INF || NaN (see RFC4627#section2.4)
-        }
+    case QJsonValue::Double:
+        Writer::doubleToJson(v.toDouble(b), json);
         break;
-    }
     case QJsonValue::String:
         json += '"';
-        json += escapedString(v.toString(b));
+        Writer::escapedString(v.toString(b), json);
         json += '"';
         break;
     case QJsonValue::Array:
@@ -196,7 +201,7 @@ static void objectContentToJson(const QJsonPrivate::Object *o, QByteArray &json,
         QJsonPrivate::Entry *e = o->entryAt(i);
         json += indentString;
         json += '"';
-        json += escapedString(e->key());
+        Writer::escapedString(e->key(), json);
         json += compact ? "\":" : "\": ";
         valueToJson(o, e->value, json, indent, compact);
 
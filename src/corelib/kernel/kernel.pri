@@ -36,6 +36,8 @@ HEADERS += \
         kernel/qcoreglobaldata_p.h \
         kernel/qsharedmemory.h \
         kernel/qsharedmemory_p.h \
+        kernel/qsharedmemorychannel.h \
+        kernel/qsharedmemorychannel_p.h \
         kernel/qsystemsemaphore.h \
         kernel/qsystemsemaphore_p.h \
         kernel/qfunctions_p.h \
@@ -66,6 +68,7 @@ SOURCES += \
         kernel/qvariant.cpp \
         kernel/qcoreglobaldata.cpp \
         kernel/qsharedmemory.cpp \
+        kernel/qsharedmemorychannel.cpp \
         kernel/qsystemsemaphore.cpp \
         kernel/qpointer.cpp \
         kernel/qmath.cpp \
@@ -77,6 +80,7 @@ win32 {
                 kernel/qelapsedtimer_win.cpp \
                 kernel/qwineventnotifier.cpp \
                 kernel/qsharedmemory_win.cpp \
+                kernel/qsharedmemorychannel_win.cpp \
                 kernel/qsystemsemaphore_win.cpp
         HEADERS += \
                 kernel/qwineventnotifier.h
@@ -164,6 +168,8 @@ unix|integrity {
 
    qtConfig(clock-gettime): include($$QT_SOURCE_TREE/config.tests/unix/clock-gettime/clock-gettime.pri)
 
+    SOURCES += kernel/qsharedmemorychannel_unix.cpp
+
     !android {
         SOURCES += kernel/qsharedmemory_posix.cpp \
                    kernel/qsharedmemory_systemv.cpp \
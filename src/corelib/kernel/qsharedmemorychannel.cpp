@@ -0,0 +1,803 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qsharedmemorychannel.h"
+#include "qsharedmemorychannel_p.h"
+#include "qsharedmemory_p.h"
+
+#include <qcryptographichash.h>
+#include <qdeadlinetimer.h>
+#include <qmath.h>
+#include <qmetaobject.h>
+#include <qthread.h>
+
+#include <string.h>
+
+#ifndef QT_NO_SHAREDMEMORY
+
+QT_BEGIN_NAMESPACE
+
+QSharedMemoryChannelPrivate::QSharedMemoryChannelPrivate()
+    : header(Q_NULLPTR), ring(Q_NULLPTR),
+      writeStart(0), writeSpan(0), readStart(0), readSpan(0), lastNotifiedHead(0),
+      error(QSharedMemory::NoError), slot(-1), readNotification(false),
+#ifdef Q_OS_WIN
+      doorbell(Q_NULLPTR),
+#else
+      doorbell(-1), ringer(-1),
+#endif
+      notifier(Q_NULLPTR)
+{
+}
+
+void QSharedMemoryChannelPrivate::setError(QSharedMemory::SharedMemoryError error,
+                                           const QString &errorString)
+{
+    this->error = error;
+    this->errorString = errorString;
+}
+
+bool QSharedMemoryChannelPrivate::setup()
+{
+    ring = reinterpret_cast<char *>(header) + sizeof(QSharedMemoryChannelHeader);
+    writeSpan = 0;
+    readSpan = 0;
+    lastNotifiedHead = header->claimTail.loadAcquire();
+    if (readNotification && initDoorbell())
+        enableDoorbellNotifier();
+    return true;
+}
+
+bool QSharedMemoryChannelPrivate::hasFreeSpace(quint32 span) const
+{
+    const quint32 capacity = header->capacity;
+    const quint32 position = header->reserveHead.loadAcquire();
+    const quint32 offset = position & (capacity - 1);
+    const quint32 needed = offset + span > capacity ? capacity - offset + span : span;
+    return needed <= capacity - (position - header->tail.loadAcquire());
+}
+
+/*!
+    \internal
+
+    Publishes a pending reservation without delivering its contents, so
+    that the producers and consumers behind it are not held up.
+*/
+void QSharedMemoryChannelPrivate::abandonReservation()
+{
+    Q_Q(QSharedMemoryChannel);
+    if (!writeSpan)
+        return;
+    QSharedMemoryChannelRecord *rec = record(writeStart);
+    if (rec->type == QSharedMemoryChannelRecord::Padding)
+        rec = record(writeStart + sizeof(QSharedMemoryChannelRecord) + rec->size);
+    rec->type = QSharedMemoryChannelRecord::Discarded;
+    q->commitMessage();
+}
+
+void QSharedMemoryChannelPrivate::notifyWaiters(QBasicAtomicInteger<quint32> &waiters)
+{
+    // the caller has just published with a full barrier, so a waiter either
+    // sees the update when it rechecks or has its bit set by now
+    if (!waiters.load())
+        return;
+    quint32 waiting = waiters.fetchAndStoreOrdered(0);
+    while (waiting) {
+        ringDoorbell(qCountTrailingZeroBits(waiting));
+        waiting &= waiting - 1;
+    }
+}
+
+void QSharedMemoryChannelPrivate::checkReadyRead()
+{
+    Q_Q(QSharedMemoryChannel);
+    if (!header || slot < 0)
+        return;
+    header->dataWaiters.fetchAndOrOrdered(1u << slot);
+    const quint32 head = header->head.loadAcquire();
+    if (head != lastNotifiedHead && q->hasPendingMessages()) {
+        lastNotifiedHead = head;
+        emit q->readyRead();
+    }
+}
+
+bool QSharedMemoryChannelPrivate::initDoorbell()
+{
+    if (slot >= 0)
+        return true;
+
+    quint32 taken = header->waiterSlots.loadAcquire();
+    forever {
+        if (taken == ~0u) {
+            setError(QSharedMemory::OutOfResources,
+                     QSharedMemoryChannel::tr("%1: too many waiting channels")
+                     .arg(QLatin1String("QSharedMemoryChannel")));
+            return false;
+        }
+        const int candidate = qCountTrailingZeroBits(~taken);
+        if (header->waiterSlots.testAndSetOrdered(taken, taken | (1u << candidate), taken)) {
+            slot = candidate;
+            break;
+        }
+    }
+
+    if (!createDoorbell()) {
+        header->waiterSlots.fetchAndAndOrdered(~(1u << slot));
+        slot = -1;
+        return false;
+    }
+    return true;
+}
+
+void QSharedMemoryChannelPrivate::cleanupDoorbell()
+{
+    if (slot >= 0) {
+        header->dataWaiters.fetchAndAndOrdered(~(1u << slot));
+        header->spaceWaiters.fetchAndAndOrdered(~(1u << slot));
+    }
+    destroyDoorbell();
+    if (slot >= 0)
+        header->waiterSlots.fetchAndAndOrdered(~(1u << slot));
+    slot = -1;
+}
+
+/*!
+    \class QSharedMemoryChannel
+    \inmodule QtCore
+    \since 5.10
+
+    \brief The QSharedMemoryChannel class passes messages between processes
+    through a ring buffer in shared memory.
+
+    QSharedMemoryChannel lays out a message queue in a QSharedMemory
+    segment. Messages are written and read directly in the shared segment,
+    so, unlike QLocalSocket, sending a message does not involve the kernel
+    or any copy other than the one the application makes itself. This makes
+    the class suitable for high-rate transfers of large buffers, such as
+    video frames, between cooperating processes on the same machine.
+
+    One process calls create() with the capacity of the ring, and the other
+    processes attach() to it using the same key:
+
+    \code
+    QSharedMemoryChannel channel("frames");
+    channel.create(64 * 1024 * 1024);
+    ...
+    if (char *frame = channel.reserveMessage(frameSize)) {
+        renderInto(frame);
+        channel.commitMessage();
+    }
+    \endcode
+
+    \code
+    QSharedMemoryChannel channel("frames");
+    channel.attach();
+    connect(&channel, &QSharedMemoryChannel::readyRead, [&channel]() {
+        int size;
+        while (const char *frame = channel.claimMessage(&size)) {
+            display(frame, size);
+            channel.releaseMessage();
+        }
+    });
+    \endcode
+
+    writeMessage() and readMessage() are convenience functions that copy the
+    message into and out of the ring. reserveMessage() and commitMessage(),
+    and claimMessage() and releaseMessage(), give direct access to the
+    memory of a message instead. Messages are delivered in the order they
+    were committed, and a message never wraps around the end of the ring,
+    which limits its size to maximumMessageSize().
+
+    The channel mode is chosen when the channel is created. In
+    \l SingleProducerSingleConsumer mode, at most one QSharedMemoryChannel
+    may write and one may read; neither side uses locks or atomic
+    read-modify-write operations. In \l MultiProducerMultiConsumer mode, any
+    number of channel objects may write and read concurrently; they reserve
+    their messages with atomic operations and publish them in order.
+
+    readyRead() is emitted when new messages arrive, as long as a receiver is
+    connected to it and the channel object lives in a thread with an event
+    loop. Without an event loop, waitForReadyRead() blocks until a message
+    is available, and waitForFreeSpace() blocks until there is room for a
+    new one. Producers only involve the kernel when another channel object
+    is waiting for a message, and then at most once per wake-up.
+
+    Each QSharedMemoryChannel object is meant to be used from one thread.
+    A process that crashes while it holds a reservation or a claimed message
+    in \l MultiProducerMultiConsumer mode stalls the other producers or
+    consumers.
+
+    \sa QSharedMemory, QLocalSocket
+*/
+
+/*!
+    \enum QSharedMemoryChannel::ChannelMode
+
+    \value SingleProducerSingleConsumer One channel object writes to the
+    channel and one reads from it.
+
+    \value MultiProducerMultiConsumer Any number of channel objects write to
+    and read from the channel.
+*/
+
+/*!
+    \fn void QSharedMemoryChannel::readyRead()
+
+    This signal is emitted when new messages have been committed to the
+    channel. It is emitted again only once more messages have arrived, so
+    the receiver should normally read all pending messages.
+*/
+
+/*!
+    Constructs a shared memory channel with the given \a parent. Call
+    setKey() before calling create() or attach().
+*/
+QSharedMemoryChannel::QSharedMemoryChannel(QObject *parent)
+    : QObject(*new QSharedMemoryChannelPrivate, parent)
+{
+}
+
+/*!
+    Constructs a shared memory channel with the given \a parent and
+    sets its key to \a key.
+
+    \sa setKey()
+*/
+QSharedMemoryChannel::QSharedMemoryChannel(const QString &key, QObject *parent)
+    : QObject(*new QSharedMemoryChannelPrivate, parent)
+{
+    setKey(key);
+}
+
+/*!
+    Detaches from the channel and destroys the object. If this was the
+    last object attached to the channel, the shared memory segment is
+    released.
+*/
+QSharedMemoryChannel::~QSharedMemoryChannel()
+{
+    detach();
+}
+
+/*!
+    Sets the platform independent \a key of this channel, detaching from
+    the current channel first.
+
+    Channels do not share a namespace with QSharedMemory: a channel and a
+    QSharedMemory with the same key use different segments.
+*/
+void QSharedMemoryChannel::setKey(const QString &key)
+{
+    Q_D(QSharedMemoryChannel);
+    if (key == d->key)
+        return;
+    if (isAttached())
+        detach();
+    d->key = key;
+    d->keyHash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    d->memory.setNativeKey(QSharedMemoryPrivate::makePlatformSafeKey(key, QLatin1String("qipc_channel_")));
+}
+
+/*!
+    Returns the key of this channel.
+*/
+QString QSharedMemoryChannel::key() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->key;
+}
+
+/*!
+    Creates a channel whose ring holds \a capacity bytes, rounded up to a
+    power of two, and attaches to it. The \a mode determines how many
+    objects may write to and read from the channel at the same time.
+
+    Returns \c true if the channel was created; otherwise returns \c false
+    and sets error(), for instance to QSharedMemory::AlreadyExists if a
+    channel with the same key exists.
+
+    \sa attach()
+*/
+bool QSharedMemoryChannel::create(int capacity, ChannelMode mode)
+{
+    Q_D(QSharedMemoryChannel);
+    if (capacity <= 0 || capacity > (1 << 30)) {
+        d->setError(QSharedMemory::InvalidSize,
+                    tr("%1: invalid capacity").arg(QLatin1String("QSharedMemoryChannel::create")));
+        return false;
+    }
+
+    const quint32 ringSize = qMax(qNextPowerOfTwo(quint32(capacity - 1)), 64u);
+    if (!d->memory.create(int(sizeof(QSharedMemoryChannelHeader) + ringSize))) {
+        d->setError(d->memory.error(), d->memory.errorString());
+        return false;
+    }
+
+    d->header = static_cast<QSharedMemoryChannelHeader *>(d->memory.data());
+    memset(static_cast<void *>(d->header), 0, sizeof(QSharedMemoryChannelHeader));
+    d->header->version = QSharedMemoryChannelHeader::Version;
+    d->header->capacity = ringSize;
+    d->header->mode = mode;
+    d->header->magic.storeRelease(QSharedMemoryChannelHeader::Magic);
+    d->setError(QSharedMemory::NoError, QString());
+    return d->setup();
+}
+
+/*!
+    Attaches to the channel created with the same key by this or another
+    process. Returns \c true on success; otherwise returns \c false and sets
+    error().
+
+    \sa create(), detach()
+*/
+bool QSharedMemoryChannel::attach()
+{
+    Q_D(QSharedMemoryChannel);
+    if (isAttached()) {
+        d->setError(QSharedMemory::AlreadyExists,
+                    tr("%1: already attached").arg(QLatin1String("QSharedMemoryChannel::attach")));
+        return false;
+    }
+    if (!d->memory.attach()) {
+        d->setError(d->memory.error(), d->memory.errorString());
+        return false;
+    }
+
+    QSharedMemoryChannelHeader *header = static_cast<QSharedMemoryChannelHeader *>(d->memory.data());
+    const quint32 capacity = header->capacity;
+    if (d->memory.size() < int(sizeof(QSharedMemoryChannelHeader))
+            || header->magic.loadAcquire() != QSharedMemoryChannelHeader::Magic
+            || header->version != QSharedMemoryChannelHeader::Version
+            || capacity < 64 || (capacity & (capacity - 1))
+            || quint32(d->memory.size()) < sizeof(QSharedMemoryChannelHeader) + capacity) {
+        d->memory.detach();
+        d->setError(QSharedMemory::InvalidSize,
+                    tr("%1: not a shared memory channel").arg(QLatin1String("QSharedMemoryChannel::attach")));
+        return false;
+    }
+
+    d->header = header;
+    d->setError(QSharedMemory::NoError, QString());
+    return d->setup();
+}
+
+/*!
+    Returns \c true if this object is attached to a channel.
+*/
+bool QSharedMemoryChannel::isAttached() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->header;
+}
+
+/*!
+    Detaches from the channel. A pending reservation is discarded and a
+    claimed message is released first.
+
+    Returns \c true if the object was attached.
+*/
+bool QSharedMemoryChannel::detach()
+{
+    Q_D(QSharedMemoryChannel);
+    if (!d->header)
+        return false;
+    d->abandonReservation();
+    if (d->readSpan)
+        releaseMessage();
+    d->cleanupDoorbell();
+    d->header = Q_NULLPTR;
+    d->ring = Q_NULLPTR;
+    return d->memory.detach();
+}
+
+/*!
+    Returns the mode the channel was created with.
+*/
+QSharedMemoryChannel::ChannelMode QSharedMemoryChannel::mode() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->header ? ChannelMode(d->header->mode) : SingleProducerSingleConsumer;
+}
+
+/*!
+    Returns the size of the ring in bytes, or 0 if the object is not
+    attached.
+*/
+int QSharedMemoryChannel::capacity() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->header ? int(d->header->capacity) : 0;
+}
+
+/*!
+    Returns the size of the largest message that can be written to the
+    channel, which is a little less than half of its capacity().
+*/
+int QSharedMemoryChannel::maximumMessageSize() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->header ? int(d->header->capacity / 2 - sizeof(QSharedMemoryChannelRecord)) : 0;
+}
+
+/*!
+    Reserves room for a message of \a size bytes and returns a pointer to
+    it, for the caller to fill in before calling commitMessage(). Other
+    objects do not see the message until it has been committed.
+
+    Returns \c nullptr if there is not enough free space in the ring, in
+    which case error() is QSharedMemory::NoError, or if the message is
+    larger than maximumMessageSize().
+
+    \sa commitMessage(), waitForFreeSpace()
+*/
+char *QSharedMemoryChannel::reserveMessage(int size)
+{
+    Q_D(QSharedMemoryChannel);
+    const QLatin1String function("QSharedMemoryChannel::reserveMessage");
+    if (!d->header) {
+        d->setError(QSharedMemory::NotFound, tr("%1: not attached").arg(function));
+        return Q_NULLPTR;
+    }
+    if (d->writeSpan) {
+        qWarning("QSharedMemoryChannel::reserveMessage: a message is already reserved");
+        return Q_NULLPTR;
+    }
+    if (size < 0 || size > maximumMessageSize()) {
+        d->setError(QSharedMemory::InvalidSize, tr("%1: invalid size").arg(function));
+        return Q_NULLPTR;
+    }
+    d->setError(QSharedMemory::NoError, QString());
+
+    QSharedMemoryChannelHeader *header = d->header;
+    const quint32 capacity = header->capacity;
+    const quint32 span = QSharedMemoryChannelPrivate::recordSpan(size);
+    const bool multi = d->isMultiProducerMultiConsumer();
+
+    quint32 start = header->reserveHead.loadAcquire();
+    quint32 padding;
+    forever {
+        const quint32 offset = start & (capacity - 1);
+        padding = offset + span > capacity ? capacity - offset : 0;
+        if (padding + span > capacity - (start - header->tail.loadAcquire()))
+            return Q_NULLPTR;
+        if (!multi) {
+            header->reserveHead.store(start + padding + span);
+            break;
+        }
+        if (header->reserveHead.testAndSetOrdered(start, start + padding + span, start))
+            break;
+    }
+
+    if (padding) {
+        QSharedMemoryChannelRecord *rec = d->record(start);
+        rec->size = padding - sizeof(QSharedMemoryChannelRecord);
+        rec->type = QSharedMemoryChannelRecord::Padding;
+    }
+    QSharedMemoryChannelRecord *rec = d->record(start + padding);
+    rec->size = size;
+    rec->type = QSharedMemoryChannelRecord::Message;
+
+    d->writeStart = start;
+    d->writeSpan = padding + span;
+    return reinterpret_cast<char *>(rec + 1);
+}
+
+/*!
+    Publishes the message reserved with reserveMessage() to the readers of
+    the channel. Returns \c false if no message was reserved.
+
+    In \l MultiProducerMultiConsumer mode, messages are published in the
+    order they were reserved, so this function waits for producers that
+    reserved earlier to commit their messages.
+*/
+bool QSharedMemoryChannel::commitMessage()
+{
+    Q_D(QSharedMemoryChannel);
+    if (!d->header || !d->writeSpan)
+        return false;
+
+    QSharedMemoryChannelHeader *header = d->header;
+    if (d->isMultiProducerMultiConsumer()) {
+        while (header->head.loadAcquire() != d->writeStart)
+            QThread::yieldCurrentThread();
+    }
+    header->head.fetchAndStoreOrdered(d->writeStart + d->writeSpan);
+    d->writeSpan = 0;
+    d->notifyWaiters(header->dataWaiters);
+    return true;
+}
+
+/*!
+    Copies the \a size bytes at \a data into a new message and commits it.
+    Returns \c false if there is not enough free space in the ring or if
+    the message is larger than maximumMessageSize().
+
+    \sa reserveMessage(), waitForFreeSpace()
+*/
+bool QSharedMemoryChannel::writeMessage(const char *data, int size)
+{
+    char *message = reserveMessage(size);
+    if (!message)
+        return false;
+    memcpy(message, data, size);
+    return commitMessage();
+}
+
+/*!
+    \overload
+
+    Writes \a message to the channel.
+*/
+bool QSharedMemoryChannel::writeMessage(const QByteArray &message)
+{
+    return writeMessage(message.constData(), message.size());
+}
+
+/*!
+    Returns \c true if at least one message is waiting to be read.
+
+    \sa pendingMessageSize(), waitForReadyRead()
+*/
+bool QSharedMemoryChannel::hasPendingMessages() const
+{
+    return pendingMessageSize() >= 0;
+}
+
+/*!
+    Returns the size of the next message to be read, or -1 if there is no
+    pending message. In \l MultiProducerMultiConsumer mode, another
+    consumer may claim the message first.
+*/
+int QSharedMemoryChannel::pendingMessageSize() const
+{
+    Q_D(const QSharedMemoryChannel);
+    if (!d->header)
+        return -1;
+
+    const quint32 capacity = d->header->capacity;
+    const quint32 head = d->header->head.loadAcquire();
+    quint32 position = d->header->claimTail.loadAcquire();
+    while (position != head && head - position <= capacity) {
+        const QSharedMemoryChannelRecord *rec = d->record(position);
+        if (rec->type == QSharedMemoryChannelRecord::Message)
+            return int(rec->size);
+        position += rec->type == QSharedMemoryChannelRecord::Padding
+                ? quint32(sizeof(QSharedMemoryChannelRecord)) + rec->size
+                : QSharedMemoryChannelPrivate::recordSpan(rec->size);
+    }
+    return -1;
+}
+
+/*!
+    Claims the next message and returns a pointer to its contents in the
+    shared segment, storing its size in \a size. The memory stays valid
+    until releaseMessage() is called.
+
+    Returns \c nullptr if there is no pending message.
+
+    \sa releaseMessage(), readMessage()
+*/
+const char *QSharedMemoryChannel::claimMessage(int *size)
+{
+    Q_D(QSharedMemoryChannel);
+    if (!d->header) {
+        d->setError(QSharedMemory::NotFound,
+                    tr("%1: not attached").arg(QLatin1String("QSharedMemoryChannel::claimMessage")));
+        return Q_NULLPTR;
+    }
+    if (d->readSpan) {
+        qWarning("QSharedMemoryChannel::claimMessage: a message is already claimed");
+        return Q_NULLPTR;
+    }
+
+    QSharedMemoryChannelHeader *header = d->header;
+    const bool multi = d->isMultiProducerMultiConsumer();
+    quint32 start = header->claimTail.loadAcquire();
+    forever {
+        if (start == header->head.loadAcquire())
+            return Q_NULLPTR;
+
+        // a padding record is always followed by the record at the start
+        // of the ring that it was reserved with
+        quint32 span = 0;
+        const QSharedMemoryChannelRecord *rec = d->record(start);
+        if (rec->type == QSharedMemoryChannelRecord::Padding) {
+            span = sizeof(QSharedMemoryChannelRecord) + rec->size;
+            rec = d->record(start + span);
+        }
+        span += QSharedMemoryChannelPrivate::recordSpan(rec->size);
+
+        if (!multi)
+            header->claimTail.store(start + span);
+        else if (!header->claimTail.testAndSetOrdered(start, start + span, start))
+            continue;
+
+        d->readStart = start;
+        d->readSpan = span;
+        if (rec->type == QSharedMemoryChannelRecord::Discarded) {
+            releaseMessage();
+            start = header->claimTail.loadAcquire();
+            continue;
+        }
+        if (size)
+            *size = int(rec->size);
+        return reinterpret_cast<const char *>(rec + 1);
+    }
+}
+
+/*!
+    Releases the message claimed with claimMessage(), making its space
+    available to producers. Returns \c false if no message was claimed.
+*/
+bool QSharedMemoryChannel::releaseMessage()
+{
+    Q_D(QSharedMemoryChannel);
+    if (!d->header || !d->readSpan)
+        return false;
+
+    QSharedMemoryChannelHeader *header = d->header;
+    if (d->isMultiProducerMultiConsumer()) {
+        while (header->tail.loadAcquire() != d->readStart)
+            QThread::yieldCurrentThread();
+    }
+    const quint32 tail = d->readStart + d->readSpan;
+    header->tail.fetchAndStoreOrdered(tail);
+    d->readSpan = 0;
+
+    // wake blocked producers once half of the ring is free rather than for
+    // every message, so that both sides work in batches when it is full
+    if (header->reserveHead.load() - tail <= header->capacity / 2)
+        d->notifyWaiters(header->spaceWaiters);
+    return true;
+}
+
+/*!
+    Reads the next message and returns a copy of it, or a null QByteArray
+    if there is no pending message.
+*/
+QByteArray QSharedMemoryChannel::readMessage()
+{
+    int size;
+    const char *message = claimMessage(&size);
+    if (!message)
+        return QByteArray();
+    QByteArray result(message, size);
+    releaseMessage();
+    return result;
+}
+
+/*!
+    Blocks until a message is available or until \a msecs milliseconds
+    have passed. If \a msecs is -1, this function does not time out.
+
+    Returns \c true if a message is available; otherwise returns \c false.
+    This function does not emit readyRead().
+*/
+bool QSharedMemoryChannel::waitForReadyRead(int msecs)
+{
+    Q_D(QSharedMemoryChannel);
+    if (!d->header)
+        return false;
+
+    QDeadlineTimer deadline(msecs);
+    forever {
+        if (hasPendingMessages())
+            return true;
+        if (!d->initDoorbell())
+            return false;
+        d->header->dataWaiters.fetchAndOrOrdered(1u << d->slot);
+        if (hasPendingMessages())
+            return true;
+        if (!d->waitForDoorbell(deadline.remainingTime()))
+            return false;
+    }
+}
+
+/*!
+    Blocks until a message of \a size bytes can be reserved or until
+    \a msecs milliseconds have passed. If \a msecs is -1, this function
+    does not time out.
+
+    Returns \c true if there is enough free space; otherwise returns
+    \c false.
+*/
+bool QSharedMemoryChannel::waitForFreeSpace(int size, int msecs)
+{
+    Q_D(QSharedMemoryChannel);
+    if (!d->header)
+        return false;
+    if (size < 0 || size > maximumMessageSize()) {
+        d->setError(QSharedMemory::InvalidSize,
+                    tr("%1: invalid size").arg(QLatin1String("QSharedMemoryChannel::waitForFreeSpace")));
+        return false;
+    }
+
+    const quint32 span = QSharedMemoryChannelPrivate::recordSpan(size);
+    QDeadlineTimer deadline(msecs);
+    forever {
+        if (d->hasFreeSpace(span))
+            return true;
+        if (!d->initDoorbell())
+            return false;
+        d->header->spaceWaiters.fetchAndOrOrdered(1u << d->slot);
+        if (d->hasFreeSpace(span))
+            return true;
+        if (!d->waitForDoorbell(deadline.remainingTime()))
+            return false;
+    }
+}
+
+/*!
+    Returns the type of the last error that occurred.
+*/
+QSharedMemory::SharedMemoryError QSharedMemoryChannel::error() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->error;
+}
+
+/*!
+    Returns a text description of the last error that occurred.
+*/
+QString QSharedMemoryChannel::errorString() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->errorString;
+}
+
+/*!
+    \reimp
+*/
+void QSharedMemoryChannel::connectNotify(const QMetaMethod &signal)
+{
+    Q_D(QSharedMemoryChannel);
+    static const QMetaMethod readyReadSignal = QMetaMethod::fromSignal(&QSharedMemoryChannel::readyRead);
+    if (signal != readyReadSignal || d->readNotification)
+        return;
+    d->readNotification = true;
+    if (d->header && d->initDoorbell())
+        d->enableDoorbellNotifier();
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_SHAREDMEMORY
+
+#include "moc_qsharedmemorychannel.cpp"
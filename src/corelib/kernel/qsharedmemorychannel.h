@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QSHAREDMEMORYCHANNEL_H
+#define QSHAREDMEMORYCHANNEL_H
+
+#include <QtCore/qsharedmemory.h>
+
+QT_BEGIN_NAMESPACE
+
+
+#ifndef QT_NO_SHAREDMEMORY
+
+class QSharedMemoryChannelPrivate;
+
+class Q_CORE_EXPORT QSharedMemoryChannel : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QSharedMemoryChannel)
+
+public:
+    enum ChannelMode
+    {
+        SingleProducerSingleConsumer,
+        MultiProducerMultiConsumer
+    };
+
+    explicit QSharedMemoryChannel(QObject *parent = Q_NULLPTR);
+    explicit QSharedMemoryChannel(const QString &key, QObject *parent = Q_NULLPTR);
+    ~QSharedMemoryChannel();
+
+    void setKey(const QString &key);
+    QString key() const;
+
+    bool create(int capacity, ChannelMode mode = SingleProducerSingleConsumer);
+    bool attach();
+    bool isAttached() const;
+    bool detach();
+
+    ChannelMode mode() const;
+    int capacity() const;
+    int maximumMessageSize() const;
+
+    char *reserveMessage(int size);
+    bool commitMessage();
+    bool writeMessage(const char *data, int size);
+    bool writeMessage(const QByteArray &message);
+
+    bool hasPendingMessages() const;
+    int pendingMessageSize() const;
+    const char *claimMessage(int *size);
+    bool releaseMessage();
+    QByteArray readMessage();
+
+    bool waitForReadyRead(int msecs = 30000);
+    bool waitForFreeSpace(int size, int msecs = 30000);
+
+    QSharedMemory::SharedMemoryError error() const;
+    QString errorString() const;
+
+Q_SIGNALS:
+    void readyRead();
+
+protected:
+    void connectNotify(const QMetaMethod &signal) Q_DECL_OVERRIDE;
+
+private:
+    Q_DISABLE_COPY(QSharedMemoryChannel)
+};
+
+#endif // QT_NO_SHAREDMEMORY
+
+QT_END_NAMESPACE
+
+#endif // QSHAREDMEMORYCHANNEL_H
@@ -0,0 +1,190 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QSHAREDMEMORYCHANNEL_P_H
+#define QSHAREDMEMORYCHANNEL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qsharedmemorychannel.h"
+
+#ifndef QT_NO_SHAREDMEMORY
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qstring.h>
+#include "private/qobject_p.h"
+
+QT_BEGIN_NAMESPACE
+
+#ifdef Q_OS_WIN
+class QWinEventNotifier;
+#else
+class QSocketNotifier;
+#endif
+
+/*
+    Layout of the shared memory segment: the header below, followed by a
+    ring of capacity bytes. Positions are free-running 32-bit counters;
+    the offset into the ring is position & (capacity - 1).
+
+    The ring holds records of an 8-byte QSharedMemoryChannelRecord
+    followed by the payload, padded to a multiple of 8 bytes. A message
+    never wraps around the end of the ring: if it does not fit, the
+    producer fills the rest of the ring with a padding record and stores
+    the message at offset 0, both in the same reservation.
+
+    Producers reserve [reserveHead, reserveHead + span) and publish it by
+    moving head once all earlier reservations have been published.
+    Consumers do the same with claimTail and tail. With a single producer
+    and a single consumer, each side owns its counters and no
+    read-modify-write operations are needed.
+*/
+struct QSharedMemoryChannelHeader
+{
+    enum {
+        Magic = 0x51534d43,     // 'QSMC'
+        Version = 1,
+        MaximumWaiters = 32
+    };
+
+    QBasicAtomicInteger<quint32> magic;
+    quint32 version;
+    quint32 capacity;
+    quint32 mode;
+
+    Q_DECL_ALIGN(64) QBasicAtomicInteger<quint32> reserveHead;
+    QBasicAtomicInteger<quint32> head;
+
+    Q_DECL_ALIGN(64) QBasicAtomicInteger<quint32> claimTail;
+    QBasicAtomicInteger<quint32> tail;
+
+    // one bit per doorbell slot
+    Q_DECL_ALIGN(64) QBasicAtomicInteger<quint32> dataWaiters;
+    QBasicAtomicInteger<quint32> spaceWaiters;
+    QBasicAtomicInteger<quint32> waiterSlots;
+};
+
+struct QSharedMemoryChannelRecord
+{
+    enum Type {
+        Message,
+        Padding,
+        Discarded
+    };
+
+    quint32 size;
+    quint32 type;
+};
+
+class Q_AUTOTEST_EXPORT QSharedMemoryChannelPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QSharedMemoryChannel)
+
+public:
+    QSharedMemoryChannelPrivate();
+
+    static quint32 recordSpan(quint32 size)
+    { return quint32(sizeof(QSharedMemoryChannelRecord)) + ((size + 7) & ~7u); }
+
+    QSharedMemoryChannelRecord *record(quint32 position) const
+    { return reinterpret_cast<QSharedMemoryChannelRecord *>(ring + (position & (header->capacity - 1))); }
+
+    bool isMultiProducerMultiConsumer() const
+    { return header->mode == QSharedMemoryChannel::MultiProducerMultiConsumer; }
+
+    bool setup();
+    bool hasFreeSpace(quint32 span) const;
+    void abandonReservation();
+    void notifyWaiters(QBasicAtomicInteger<quint32> &waiters);
+    void checkReadyRead();
+
+    bool initDoorbell();
+    void cleanupDoorbell();
+    // platform-specific
+    bool createDoorbell();
+    void destroyDoorbell();
+    void enableDoorbellNotifier();
+    void ringDoorbell(int slot);
+    bool waitForDoorbell(int msecs);
+    void drainDoorbell();
+
+    void setError(QSharedMemory::SharedMemoryError error, const QString &errorString);
+
+    QString key;
+    QByteArray keyHash;
+    QSharedMemory memory;
+    QSharedMemoryChannelHeader *header;
+    char *ring;
+
+    quint32 writeStart;
+    quint32 writeSpan;
+    quint32 readStart;
+    quint32 readSpan;
+    quint32 lastNotifiedHead;
+
+    QSharedMemory::SharedMemoryError error;
+    QString errorString;
+
+    int slot;
+    bool readNotification;
+#ifdef Q_OS_WIN
+    Qt::HANDLE doorbell;
+    QWinEventNotifier *notifier;
+#else
+    int doorbell;
+    int ringer;
+    QSocketNotifier *notifier;
+#endif
+};
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_SHAREDMEMORY
+
+#endif // QSHAREDMEMORYCHANNEL_P_H
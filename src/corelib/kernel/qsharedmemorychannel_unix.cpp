@@ -0,0 +1,194 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qplatformdefs.h"
+
+#include "qsharedmemorychannel.h"
+#include "qsharedmemorychannel_p.h"
+
+#include <qdir.h>
+#include <qfile.h>
+#include <qsocketnotifier.h>
+
+#include "private/qcore_unix_p.h"
+
+#ifndef QT_NO_SHAREDMEMORY
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    On Unix, the doorbell of a waiting channel object is an AF_UNIX datagram
+    socket bound to a path derived from the channel key and the waiter
+    slot. Unlike a pipe or an eventfd, it can be reached from unrelated
+    processes by name, and sending to it fails silently instead of raising
+    SIGPIPE when the waiter has gone away.
+*/
+
+static QByteArray doorbellPath(const QByteArray &keyHash, int slot)
+{
+    return QFile::encodeName(QDir::tempPath()) + "/qipc_channel_" + keyHash
+            + '_' + QByteArray::number(slot);
+}
+
+static bool makeAddress(const QByteArray &path, sockaddr_un *address)
+{
+    if (size_t(path.size()) >= sizeof(address->sun_path))
+        return false;
+    memset(address, 0, sizeof(sockaddr_un));
+    address->sun_family = AF_UNIX;
+    memcpy(address->sun_path, path.constData(), path.size() + 1);
+    return true;
+}
+
+static int createDatagramSocket()
+{
+    int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd == -1)
+        return -1;
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+bool QSharedMemoryChannelPrivate::createDoorbell()
+{
+    const QLatin1String function("QSharedMemoryChannel");
+    const QByteArray path = doorbellPath(keyHash, slot);
+    sockaddr_un address;
+    if (!makeAddress(path, &address)) {
+        setError(QSharedMemory::KeyError,
+                 QSharedMemoryChannel::tr("%1: doorbell path is too long").arg(function));
+        return false;
+    }
+
+    int fd = createDatagramSocket();
+    if (fd != -1) {
+        // a previous owner of the slot may have crashed without removing it
+        ::unlink(path.constData());
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0) {
+            doorbell = fd;
+            return true;
+        }
+        qt_safe_close(fd);
+    }
+    setError(errno == EACCES ? QSharedMemory::PermissionDenied : QSharedMemory::OutOfResources,
+             QSharedMemoryChannel::tr("%1: unable to create doorbell: %2")
+             .arg(function, qt_error_string(errno)));
+    return false;
+}
+
+void QSharedMemoryChannelPrivate::destroyDoorbell()
+{
+    delete notifier;
+    notifier = Q_NULLPTR;
+    if (doorbell != -1) {
+        qt_safe_close(doorbell);
+        ::unlink(doorbellPath(keyHash, slot).constData());
+        doorbell = -1;
+    }
+    if (ringer != -1) {
+        qt_safe_close(ringer);
+        ringer = -1;
+    }
+}
+
+void QSharedMemoryChannelPrivate::enableDoorbellNotifier()
+{
+    Q_Q(QSharedMemoryChannel);
+    if (!notifier) {
+        notifier = new QSocketNotifier(doorbell, QSocketNotifier::Read, q);
+        QObject::connect(notifier, &QSocketNotifier::activated, q, [this]() {
+            drainDoorbell();
+            checkReadyRead();
+        });
+    }
+    // pick up the messages that are already waiting
+    ringDoorbell(slot);
+}
+
+void QSharedMemoryChannelPrivate::ringDoorbell(int slot)
+{
+    if (ringer == -1 && (ringer = createDatagramSocket()) == -1)
+        return;
+
+    sockaddr_un address;
+    if (!makeAddress(doorbellPath(keyHash, slot), &address))
+        return;
+
+    // a full queue means the waiter has not woken up yet, and a missing
+    // socket means it has gone away; neither is an error for the sender
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+#endif
+    const char byte = 0;
+    ssize_t ret;
+    EINTR_LOOP(ret, ::sendto(ringer, &byte, 1, flags,
+                             reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+    Q_UNUSED(ret);
+}
+
+bool QSharedMemoryChannelPrivate::waitForDoorbell(int msecs)
+{
+    pollfd pfd = qt_make_pollfd(doorbell, POLLIN);
+    if (qt_poll_msecs(&pfd, 1, msecs) <= 0)
+        return false;
+    drainDoorbell();
+    return true;
+}
+
+void QSharedMemoryChannelPrivate::drainDoorbell()
+{
+    char buffer[64];
+    ssize_t ret;
+    do {
+        ret = ::recv(doorbell, buffer, sizeof(buffer), 0);
+    } while (ret > 0 || (ret == -1 && errno == EINTR));
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_SHAREDMEMORY
@@ -0,0 +1,119 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qsharedmemorychannel.h"
+#include "qsharedmemorychannel_p.h"
+
+#include <qwineventnotifier.h>
+#include <qt_windows.h>
+
+#ifndef QT_NO_SHAREDMEMORY
+
+QT_BEGIN_NAMESPACE
+
+/*
+    On Windows, the doorbell of a waiting channel object is a named
+    auto-reset event.
+*/
+
+static QString doorbellName(const QByteArray &keyHash, int slot)
+{
+    return QLatin1String("qipc_channel_") + QLatin1String(keyHash)
+            + QLatin1Char('_') + QString::number(slot);
+}
+
+bool QSharedMemoryChannelPrivate::createDoorbell()
+{
+    const QString name = doorbellName(keyHash, slot);
+    doorbell = CreateEvent(0, FALSE, FALSE, reinterpret_cast<const wchar_t *>(name.utf16()));
+    if (doorbell)
+        return true;
+    setError(GetLastError() == ERROR_ACCESS_DENIED ? QSharedMemory::PermissionDenied
+                                                  : QSharedMemory::OutOfResources,
+             QSharedMemoryChannel::tr("%1: unable to create doorbell: %2")
+             .arg(QLatin1String("QSharedMemoryChannel"), qt_error_string()));
+    return false;
+}
+
+void QSharedMemoryChannelPrivate::destroyDoorbell()
+{
+    delete notifier;
+    notifier = Q_NULLPTR;
+    if (doorbell) {
+        CloseHandle(doorbell);
+        doorbell = Q_NULLPTR;
+    }
+}
+
+void QSharedMemoryChannelPrivate::enableDoorbellNotifier()
+{
+    Q_Q(QSharedMemoryChannel);
+    if (!notifier) {
+        notifier = new QWinEventNotifier(doorbell, q);
+        QObject::connect(notifier, &QWinEventNotifier::activated, q, [this]() {
+            checkReadyRead();
+        });
+    }
+    // pick up the messages that are already waiting
+    SetEvent(doorbell);
+}
+
+void QSharedMemoryChannelPrivate::ringDoorbell(int slot)
+{
+    const QString name = doorbellName(keyHash, slot);
+    HANDLE event = OpenEvent(EVENT_MODIFY_STATE, FALSE, reinterpret_cast<const wchar_t *>(name.utf16()));
+    if (!event)
+        return;
+    SetEvent(event);
+    CloseHandle(event);
+}
+
+bool QSharedMemoryChannelPrivate::waitForDoorbell(int msecs)
+{
+    return WaitForSingleObjectEx(doorbell, msecs < 0 ? INFINITE : DWORD(msecs), FALSE) == WAIT_OBJECT_0;
+}
+
+void QSharedMemoryChannelPrivate::drainDoorbell()
+{
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_SHAREDMEMORY
@@ -54,6 +54,12 @@
 #include <QtCore/QBuffer>
 #include <QtCore/QUrl>
 #include <QtCore/QDebug>
+#include <QtCore/QVector>
+#ifndef QT_NO_THREAD
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+#endif
 
 #include <algorithm>
 #include <functional>
@@ -138,24 +144,123 @@ static inline bool isTextFile(const QByteArray &data)
 }
 
 QMimeType QMimeDatabasePrivate::findByData(const QByteArray &data, int *accuracyPtr)
+{
+    provider()->ensureLoaded();
+    return mimeTypeForName(findNameByData(data, accuracyPtr));
+}
+
+/*!
+    \internal
+    Returns the name of the MIME type for \a data.
+
+    This does not touch anything but the magic rules of the provider, so once
+    provider()->ensureLoaded() has been called under the mutex, this function
+    can run in several threads at once.
+ */
+QString QMimeDatabasePrivate::findNameByData(const QByteArray &data, int *accuracyPtr)
 {
     if (data.isEmpty()) {
         *accuracyPtr = 100;
-        return mimeTypeForName(QLatin1String("application/x-zerosize"));
+        return QStringLiteral("application/x-zerosize");
     }
 
     *accuracyPtr = 0;
-    QMimeType candidate = provider()->findByMagic(data, accuracyPtr);
+    const QString candidate = m_provider->findByMagic(data, accuracyPtr);
 
-    if (candidate.isValid())
+    if (!candidate.isEmpty())
         return candidate;
 
     if (isTextFile(data)) {
         *accuracyPtr = 5;
-        return mimeTypeForName(QLatin1String("text/plain"));
+        return QStringLiteral("text/plain");
     }
 
-    return mimeTypeForName(defaultMimeType());
+    return defaultMimeType();
+}
+
+void QMimeDatabasePrivate::findNamesByData(const QList<QByteArray> &dataList, QString *names, int begin, int end)
+{
+    for (int i = begin; i < end; ++i) {
+        int accuracy = 0;
+        names[i] = findNameByData(dataList.at(i), &accuracy);
+    }
+}
+
+#ifndef QT_NO_THREAD
+namespace {
+class QMimeMagicBatchTask : public QRunnable
+{
+public:
+    QMimeMagicBatchTask(QMimeDatabasePrivate *d, const QList<QByteArray> &dataList, QString *names,
+                        int begin, int end, QSemaphore *done)
+        : d(d), dataList(dataList), names(names), begin(begin), end(end), done(done)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        d->findNamesByData(dataList, names, begin, end);
+        done->release();
+    }
+
+private:
+    QMimeDatabasePrivate *d;
+    const QList<QByteArray> &dataList;
+    QString *names;
+    int begin;
+    int end;
+    QSemaphore *done;
+};
+} // unnamed namespace
+#endif
+
+QList<QMimeType> QMimeDatabasePrivate::mimeTypesForData(const QList<QByteArray> &dataList)
+{
+    provider()->ensureLoaded();
+
+    const int count = dataList.size();
+    QVector<QString> names(count);
+    QString *namesData = names.data();
+
+#ifndef QT_NO_THREAD
+    // Split the list into one chunk per pool thread, plus one for the calling thread.
+    // Chunks are only handed to threads that are idle right now (tryStart), anything
+    // else runs here; so this never waits on work queued behind other pool users.
+    static const int minimumChunkSize = 32;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int chunkCount = qMin(count / minimumChunkSize, pool->maxThreadCount() + 1);
+    if (chunkCount > 1) {
+        const int chunkSize = (count + chunkCount - 1) / chunkCount;
+        QSemaphore done;
+        int started = 0;
+        for (int begin = chunkSize; begin < count; begin += chunkSize) {
+            const int end = qMin(begin + chunkSize, count);
+            QMimeMagicBatchTask *task = new QMimeMagicBatchTask(this, dataList, namesData, begin, end, &done);
+            if (pool->tryStart(task)) {
+                ++started;
+            } else {
+                delete task;
+                findNamesByData(dataList, namesData, begin, end);
+            }
+        }
+        findNamesByData(dataList, namesData, 0, chunkSize);
+        done.acquire(started);
+    } else
+#endif
+    {
+        findNamesByData(dataList, namesData, 0, count);
+    }
+
+    // Typically, a few types account for most of the data
+    QHash<QString, QMimeType> mimeTypes;
+    QList<QMimeType> result;
+    result.reserve(count);
+    for (const QString &name : qAsConst(names)) {
+        auto it = mimeTypes.find(name);
+        if (it == mimeTypes.end())
+            it = mimeTypes.insert(name, mimeTypeForName(name));
+        result.append(*it);
+    }
+    return result;
 }
 
 QMimeType QMimeDatabasePrivate::mimeTypeForFileNameAndData(const QString &fileName, QIODevice *device, int *accuracyPtr)
@@ -478,6 +583,28 @@ QMimeType QMimeDatabase::mimeTypeForData(const QByteArray &data) const
     return d->findByData(data, &accuracy);
 }
 
+/*!
+    \since 5.10
+
+    Returns a list with the MIME type for each of the buffers in \a dataList,
+    in the same order. This gives the same results as calling
+    mimeTypeForData() for each buffer, but matches the buffers in parallel
+    on the threads of QThreadPool::globalInstance() that are idle.
+
+    Only the first bytes of each buffer are examined; 16 KiB per buffer,
+    as read by mimeTypeForData(QIODevice*), is plenty.
+
+    Other calls on any QMimeDatabase instance wait until this function returns.
+
+    \sa mimeTypeForData()
+*/
+QList<QMimeType> QMimeDatabase::mimeTypesForData(const QList<QByteArray> &dataList) const
+{
+    QMutexLocker locker(&d->mutex);
+
+    return d->mimeTypesForData(dataList);
+}
+
 /*!
     Returns a MIME type for the data in \a device.
 
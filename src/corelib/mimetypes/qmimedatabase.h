@@ -77,6 +77,7 @@ public:
 
     QMimeType mimeTypeForData(const QByteArray &data) const;
     QMimeType mimeTypeForData(QIODevice *device) const;
+    QList<QMimeType> mimeTypesForData(const QList<QByteArray> &dataList) const;
 
     QMimeType mimeTypeForUrl(const QUrl &url) const;
     QMimeType mimeTypeForFileNameAndData(const QString &fileName, QIODevice *device) const;
@@ -90,6 +90,9 @@ public:
     QMimeType mimeTypeForName(const QString &nameOrAlias);
     QMimeType mimeTypeForFileNameAndData(const QString &fileName, QIODevice *device, int *priorityPtr);
     QMimeType findByData(const QByteArray &data, int *priorityPtr);
+    QString findNameByData(const QByteArray &data, int *priorityPtr);
+    void findNamesByData(const QList<QByteArray> &dataList, QString *names, int begin, int end);
+    QList<QMimeType> mimeTypesForData(const QList<QByteArray> &dataList);
     QStringList mimeTypeForFileName(const QString &fileName);
 
     mutable QMimeProviderBase *m_provider;
@@ -98,24 +98,58 @@ void QMimeGlobMatchResult::addMatch(const QString &mimeType, int weight, const Q
     \sa QMimeType, QMimeDatabase, QMimeMagicRuleMatcher, QMimeMagicRule
 */
 
+QMimeGlobPattern::PatternType QMimeGlobPattern::detectPatternType(const QString &pattern)
+{
+    const int patternLength = pattern.length();
+    if (!patternLength)
+        return OtherPattern;
+
+    const int starCount = pattern.count(QLatin1Char('*'));
+    const bool hasSquareBracket = pattern.indexOf(QLatin1Char('[')) != -1;
+    const bool hasQuestionMark = pattern.indexOf(QLatin1Char('?')) != -1;
+
+    if (!hasSquareBracket && !hasQuestionMark) {
+        if (starCount == 1) {
+            if (pattern.at(0) == QLatin1Char('*'))
+                return SuffixPattern;
+            if (pattern.at(patternLength - 1) == QLatin1Char('*'))
+                return PrefixPattern;
+        } else if (starCount == 2 && patternLength > 2
+                   && pattern.at(0) == QLatin1Char('*') && pattern.at(patternLength - 1) == QLatin1Char('*')) {
+            return SubstringPattern;
+        } else if (starCount == 0) {
+            return LiteralPattern;
+        }
+    }
+    return OtherPattern;
+}
+
 bool QMimeGlobPattern::matchFileName(const QString &inputFilename) const
 {
     // "Applications MUST match globs case-insensitively, except when the case-sensitive
     // attribute is set to true."
     // The constructor takes care of putting case-insensitive patterns in lowercase.
-    const QString filename = m_caseSensitivity == Qt::CaseInsensitive ? inputFilename.toLower() : inputFilename;
+    return matchNormalizedFileName(m_caseSensitivity == Qt::CaseInsensitive ? inputFilename.toLower() : inputFilename);
+}
 
+/*!
+    \internal
+    Same as matchFileName(), but \a filename must already be in lowercase if the
+    pattern is case-insensitive. This lets callers matching many patterns convert
+    the file name only once.
+*/
+bool QMimeGlobPattern::matchNormalizedFileName(const QString &filename) const
+{
     const int pattern_len = m_pattern.length();
     if (!pattern_len)
         return false;
     const int len = filename.length();
 
-    const int starCount = m_pattern.count(QLatin1Char('*'));
-
-    // Patterns like "*~", "*.extension"
-    if (m_pattern[0] == QLatin1Char('*') && m_pattern.indexOf(QLatin1Char('[')) == -1 && starCount == 1)
-    {
-        if (len + 1 < pattern_len) return false;
+    switch (m_patternType) {
+    case SuffixPattern: {
+        // Patterns like "*~", "*.extension"
+        if (len + 1 < pattern_len)
+            return false;
 
         const QChar *c1 = m_pattern.unicode() + pattern_len - 1;
         const QChar *c2 = filename.unicode() + len - 1;
@@ -124,12 +158,10 @@ bool QMimeGlobPattern::matchFileName(const QString &inputFilename) const
             ++cnt;
         return cnt == pattern_len;
     }
-
-    // Patterns like "README*" (well this is currently the only one like that...)
-    if (starCount == 1 && m_pattern.at(pattern_len - 1) == QLatin1Char('*')) {
-        if (len + 1 < pattern_len) return false;
-        if (m_pattern.at(0) == QLatin1Char('*'))
-            return filename.indexOf(m_pattern.midRef(1, pattern_len - 2)) != -1;
+    case PrefixPattern: {
+        // Patterns like "README*" (well this is currently the only one like that...)
+        if (len + 1 < pattern_len)
+            return false;
 
         const QChar *c1 = m_pattern.unicode();
         const QChar *c2 = filename.unicode();
@@ -138,10 +170,14 @@ bool QMimeGlobPattern::matchFileName(const QString &inputFilename) const
            ++cnt;
         return cnt == pattern_len;
     }
-
-    // Names without any wildcards like "README"
-    if (m_pattern.indexOf(QLatin1Char('[')) == -1 && starCount == 0 && m_pattern.indexOf(QLatin1Char('?')))
-        return (m_pattern == filename);
+    case SubstringPattern:
+        return filename.indexOf(m_pattern.midRef(1, pattern_len - 2)) != -1;
+    case LiteralPattern:
+        // Names without any wildcards like "README"
+        return m_pattern == filename;
+    case OtherPattern:
+        break;
+    }
 
     // Other (quite rare) patterns, like "*.anim[1-9j]": use slow but correct method
     QRegExp rx(m_pattern, Qt::CaseSensitive, QRegExp::WildcardUnix);
@@ -196,12 +232,13 @@ void QMimeAllGlobPatterns::removeMimeType(const QString &mimeType)
 void QMimeGlobPatternList::match(QMimeGlobMatchResult &result,
                                  const QString &fileName) const
 {
+    const QString lowerFileName = fileName.toLower();
 
     QMimeGlobPatternList::const_iterator it = this->constBegin();
     const QMimeGlobPatternList::const_iterator endIt = this->constEnd();
     for (; it != endIt; ++it) {
         const QMimeGlobPattern &glob = *it;
-        if (glob.matchFileName(fileName))
+        if (glob.matchNormalizedFileName(glob.isCaseSensitive() ? fileName : lowerFileName))
             result.addMatch(glob.mimeType(), glob.weight(), glob.pattern());
     }
 }
@@ -106,18 +106,23 @@ bool QMimeMagicRule::matchSubstring(const char *dataPtr, int dataSize, int range
     if (!mask) {
         // callgrind says QByteArray::indexOf is much slower, since our strings are typically too
         // short for be worth Boyer-Moore matching (1 to 71 bytes, 11 bytes on average).
-        bool found = false;
-        for (int i = rangeStart; i < rangeStart + rangeLength; ++i) {
-            if (i + valueLength > dataSize)
-                break;
-
-            if (memcmp(valueData, dataPtr + i, valueLength) == 0) {
-                found = true;
-                break;
-            }
-        }
-        if (!found)
+        // Let memchr skip to the positions holding the first byte of the value instead.
+        if (valueLength <= 0)
+            return rangeLength > 0 && rangeStart <= dataSize;
+        const int lastStart = qMin(rangeStart + rangeLength - 1, dataSize - valueLength);
+        if (lastStart < rangeStart)
             return false;
+        const char *p = dataPtr + rangeStart;
+        const char *e = dataPtr + lastStart + 1;
+        while (p < e) {
+            p = static_cast<const char *>(memchr(p, valueData[0], e - p));
+            if (!p)
+                return false;
+            if (memcmp(p + 1, valueData + 1, valueLength - 1) == 0)
+                return true;
+            ++p;
+        }
+        return false;
     } else {
         bool found = false;
         const char *readDataBase = dataPtr + rangeStart;
@@ -126,7 +131,7 @@ bool QMimeMagicRule::matchSubstring(const char *dataPtr, int dataSize, int range
         // maxStartPos = 4 - 3 + 1 = 2, and indeed
         // we need to check for a match a positions 0 and 1 (ABCx and xABC).
         const int maxStartPos = dataNeeded - valueLength + 1;
-        for (int i = 0; i < maxStartPos; ++i) {
+        for (int i = 0; i < maxStartPos && !found; ++i) {
             const char *d = readDataBase + i;
             bool valid = true;
             for (int idx = 0; idx < valueLength; ++idx) {
@@ -148,7 +153,9 @@ bool QMimeMagicRule::matchSubstring(const char *dataPtr, int dataSize, int range
 bool QMimeMagicRule::matchString(const QByteArray &data) const
 {
     const int rangeLength = m_endPos - m_startPos + 1;
-    return QMimeMagicRule::matchSubstring(data.constData(), data.size(), m_startPos, rangeLength, m_pattern.size(), m_pattern.constData(), m_mask.constData());
+    // An empty mask means "compare all bits", which takes the memcmp path
+    const char *mask = m_mask.isEmpty() ? nullptr : m_mask.constData();
+    return QMimeMagicRule::matchSubstring(data.constData(), data.size(), m_startPos, rangeLength, m_pattern.size(), m_pattern.constData(), mask);
 }
 
 template <typename T>
@@ -284,9 +291,13 @@ QMimeMagicRule::QMimeMagicRule(const QString &type,
                     *errorString = QLatin1String("Invalid magic rule mask size \"") + QLatin1String(m_mask) + QLatin1Char('"');
                 return;
             }
-            m_mask = tempMask;
+            // a mask of all ones is the same as no mask at all
+            if (tempMask.count(char(-1)) == tempMask.size())
+                m_mask.clear();
+            else
+                m_mask = tempMask;
         } else {
-            m_mask.fill(char(-1), m_pattern.size());
+            m_mask.clear();
         }
         m_mask.squeeze();
         m_matchFunction = &QMimeMagicRule::matchString;
@@ -337,6 +348,8 @@ QByteArray QMimeMagicRule::mask() const
 {
     QByteArray result = m_mask;
     if (m_type == String) {
+        if (result.isEmpty())
+            result.fill(char(-1), m_pattern.size());
         // restore '0x'
         result = "0x" + result.toHex();
     }
@@ -363,8 +376,49 @@ bool QMimeMagicRule::matches(const QByteArray &data) const
         }
     }
     return false;
+}
 
+/*!
+    \internal
+    Returns \c true if this rule can only match data whose byte at \a offset
+    equals \a byte, and sets both. This holds for fixed-offset rules whose
+    first byte is compared without a mask. Returns \c false otherwise.
+*/
+bool QMimeMagicRule::anchor(int *offset, uchar *byte) const
+{
+    if (!isValid() || m_startPos != m_endPos)
+        return false;
 
+    uchar value[4];
+    uchar mask[4];
+    switch (m_type) {
+    case String:
+        if (m_pattern.isEmpty() || (!m_mask.isEmpty() && uchar(m_mask.at(0)) != 0xff))
+            return false;
+        value[0] = uchar(m_pattern.at(0));
+        mask[0] = 0xff;
+        break;
+    case Byte:
+        value[0] = uchar(m_number);
+        mask[0] = uchar(m_numberMask);
+        break;
+    case Host16:
+    case Big16:
+    case Little16:
+        // m_number is already in the byte order matchNumber() reads the data in
+        qToUnaligned<quint16>(quint16(m_number), value);
+        qToUnaligned<quint16>(quint16(m_numberMask), mask);
+        break;
+    default:
+        qToUnaligned<quint32>(m_number, value);
+        qToUnaligned<quint32>(m_numberMask, mask);
+        break;
+    }
+    if (mask[0] != 0xff)
+        return false;
+    *offset = m_startPos;
+    *byte = value[0];
+    return true;
 }
 
 QT_END_NAMESPACE
@@ -93,6 +93,7 @@ public:
     bool isValid() const { return m_matchFunction != Q_NULLPTR; }
 
     bool matches(const QByteArray &data) const;
+    bool anchor(int *offset, uchar *byte) const;
 
     QList<QMimeMagicRule> m_subMatches;
 
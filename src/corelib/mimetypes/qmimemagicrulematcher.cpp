@@ -45,6 +45,10 @@
 
 #include "qmimetype_p.h"
 
+#include <QtCore/qvarlengtharray.h>
+
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -105,5 +109,118 @@ unsigned QMimeMagicRuleMatcher::priority() const
     return m_priority;
 }
 
+/*!
+    \internal
+    \class QMimeMagicRuleIndex
+    \inmodule QtCore
+
+    \brief The QMimeMagicRuleIndex class finds the best magic match among all rule matchers.
+
+    The matchers are kept sorted by descending priority, so that matching can stop at
+    the first matcher that succeeds, or as soon as no remaining matcher can beat the
+    accuracy found so far.
+
+    Most rules compare bytes at a fixed offset (e.g. "%PDF-" at offset 0). For those,
+    the index records which byte the rule expects at that offset. Before evaluating
+    any rule, match() reads each of these offsets once and only keeps the matchers
+    that can still succeed given the bytes found there.
+
+    The index is not modified by match(), which can therefore be called from several
+    threads at once.
+*/
+
+void QMimeMagicRuleIndex::build(const QList<QMimeMagicRuleMatcher> &matchers)
+{
+    clear();
+
+    m_matchers = matchers;
+    // Stable, so that the first matcher still wins among those with equal priority
+    std::stable_sort(m_matchers.begin(), m_matchers.end(),
+                     [](const QMimeMagicRuleMatcher &lhs, const QMimeMagicRuleMatcher &rhs) {
+                         return lhs.priority() > rhs.priority();
+                     });
+
+    m_unanchored.resize(m_matchers.size());
+    QVarLengthArray<quint64, 16> keys;
+    for (int i = 0; i < m_matchers.size(); ++i) {
+        // A matcher matches if any of its rules does, so it can only be skipped
+        // if every one of its rules is anchored.
+        const QList<QMimeMagicRule> rules = m_matchers.at(i).magicRules();
+        bool anchored = !rules.isEmpty();
+        keys.clear();
+        for (const QMimeMagicRule &rule : rules) {
+            int offset;
+            uchar byte;
+            if (!rule.anchor(&offset, &byte)) {
+                anchored = false;
+                break;
+            }
+            keys.append(anchorKey(offset, byte));
+        }
+        m_unanchored[i] = !anchored;
+        if (!anchored)
+            continue;
+        for (quint64 key : keys) {
+            QVector<int> &indexes = m_anchors[key];
+            if (indexes.isEmpty() || indexes.constLast() != i)
+                indexes.append(i);
+            m_anchorOffsets.append(int(key >> 8));
+        }
+    }
+
+    std::sort(m_anchorOffsets.begin(), m_anchorOffsets.end());
+    m_anchorOffsets.erase(std::unique(m_anchorOffsets.begin(), m_anchorOffsets.end()),
+                          m_anchorOffsets.end());
+    m_anchorOffsets.squeeze();
+}
+
+void QMimeMagicRuleIndex::clear()
+{
+    m_matchers.clear();
+    m_unanchored.clear();
+    m_anchorOffsets.clear();
+    m_anchors.clear();
+}
+
+/*!
+    \internal
+    Returns the name of the highest priority MIME type whose magic matches \a data,
+    provided its priority is above *\a accuracyPtr, which is then updated. Returns
+    an empty string otherwise.
+*/
+QString QMimeMagicRuleIndex::match(const QByteArray &data, int *accuracyPtr) const
+{
+    const int count = m_matchers.size();
+    if (!count || int(m_matchers.constFirst().priority()) <= *accuracyPtr)
+        return QString();
+
+    QVarLengthArray<bool, 1024> candidates(count);
+    memcpy(candidates.data(), m_unanchored.constData(), count * sizeof(bool));
+
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    const int size = data.size();
+    for (int offset : m_anchorOffsets) {
+        if (offset >= size)
+            break;
+        const auto it = m_anchors.constFind(anchorKey(offset, bytes[offset]));
+        if (it == m_anchors.constEnd())
+            continue;
+        for (int i : *it)
+            candidates[i] = true;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const QMimeMagicRuleMatcher &matcher = m_matchers.at(i);
+        const int priority = matcher.priority();
+        if (priority <= *accuracyPtr)
+            break; // sorted: nothing further down can win
+        if (candidates[i] && matcher.matches(data)) {
+            *accuracyPtr = priority;
+            return matcher.mimetype();
+        }
+    }
+    return QString();
+}
+
 QT_END_NAMESPACE
 #endif // QT_NO_MIMETYPE
@@ -56,8 +56,10 @@
 #ifndef QT_NO_MIMETYPE
 
 #include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qstring.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -92,6 +94,23 @@ private:
 };
 Q_DECLARE_SHARED(QMimeMagicRuleMatcher)
 
+class QMimeMagicRuleIndex
+{
+public:
+    void build(const QList<QMimeMagicRuleMatcher> &matchers);
+    void clear();
+
+    QString match(const QByteArray &data, int *accuracyPtr) const;
+
+private:
+    static quint64 anchorKey(int offset, uchar byte) { return (quint64(offset) << 8) | byte; }
+
+    QList<QMimeMagicRuleMatcher> m_matchers; // highest priority first
+    QVector<bool> m_unanchored; // matchers that have to be tried for any data
+    QVector<int> m_anchorOffsets; // sorted, without duplicates
+    QHash<quint64, QVector<int> > m_anchors; // anchorKey() -> indexes into m_matchers
+};
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_MIMETYPE
@@ -266,6 +266,11 @@ void QMimeBinaryProvider::checkCache()
     }
 }
 
+void QMimeBinaryProvider::ensureLoaded()
+{
+    checkCache();
+}
+
 static QMimeType mimeTypeForNameUnchecked(const QString &name)
 {
     QMimeTypePrivate data;
@@ -297,9 +302,9 @@ QMimeGlobMatchResult QMimeBinaryProvider::findByFileName(const QString &fileName
     // TODO this parses in the order (local, global). Check that it handles "NOGLOBS" correctly.
     for (CacheFile *cacheFile : qAsConst(m_cacheFiles)) {
         // Check literals (e.g. "Makefile")
-        matchGlobList(result, cacheFile, cacheFile->getUint32(PosLiteralListOffset), fileName);
+        matchGlobList(result, cacheFile, cacheFile->getUint32(PosLiteralListOffset), fileName, lowerFileName);
         // Check complex globs (e.g. "callgrind.out[0-9]*")
-        matchGlobList(result, cacheFile, cacheFile->getUint32(PosGlobListOffset), fileName);
+        matchGlobList(result, cacheFile, cacheFile->getUint32(PosGlobListOffset), fileName, lowerFileName);
         // Check the very common *.txt cases with the suffix tree
         const int reverseSuffixTreeOffset = cacheFile->getUint32(PosReverseSuffixTreeOffset);
         const int numRoots = cacheFile->getUint32(reverseSuffixTreeOffset);
@@ -311,7 +316,7 @@ QMimeGlobMatchResult QMimeBinaryProvider::findByFileName(const QString &fileName
     return result;
 }
 
-void QMimeBinaryProvider::matchGlobList(QMimeGlobMatchResult &result, CacheFile *cacheFile, int off, const QString &fileName)
+void QMimeBinaryProvider::matchGlobList(QMimeGlobMatchResult &result, CacheFile *cacheFile, int off, const QString &fileName, const QString &lowerFileName)
 {
     const int numGlobs = cacheFile->getUint32(off);
     //qDebug() << "Loading" << numGlobs << "globs from" << cacheFile->file.fileName() << "at offset" << cacheFile->globListOffset;
@@ -328,8 +333,7 @@ void QMimeBinaryProvider::matchGlobList(QMimeGlobMatchResult &result, CacheFile
         //qDebug() << pattern << mimeType << weight << caseSensitive;
         QMimeGlobPattern glob(pattern, QString() /*unused*/, weight, qtCaseSensitive);
 
-        // TODO: this could be done faster for literals where a simple == would do.
-        if (glob.matchFileName(fileName))
+        if (glob.matchNormalizedFileName(caseSensitive ? fileName : lowerFileName))
             result.addMatch(QLatin1String(mimeType), weight, pattern);
     }
 }
@@ -406,9 +410,8 @@ bool QMimeBinaryProvider::matchMagicRule(QMimeBinaryProvider::CacheFile *cacheFi
     return false;
 }
 
-QMimeType QMimeBinaryProvider::findByMagic(const QByteArray &data, int *accuracyPtr)
+QString QMimeBinaryProvider::findByMagic(const QByteArray &data, int *accuracyPtr)
 {
-    checkCache();
     for (CacheFile *cacheFile : qAsConst(m_cacheFiles)) {
         const int magicListOffset = cacheFile->getUint32(PosMagicListOffset);
         const int numMatches = cacheFile->getUint32(magicListOffset);
@@ -425,11 +428,11 @@ QMimeType QMimeBinaryProvider::findByMagic(const QByteArray &data, int *accuracy
                 *accuracyPtr = cacheFile->getUint32(off);
                 // Return the first match. We have no rules for conflicting magic data...
                 // (mime.cache itself is sorted, but what about local overrides with a lower prio?)
-                return mimeTypeForNameUnchecked(QLatin1String(mimeType));
+                return QLatin1String(mimeType);
             }
         }
     }
-    return QMimeType();
+    return QString();
 }
 
 QStringList QMimeBinaryProvider::parents(const QString &mime)
@@ -736,22 +739,9 @@ QMimeGlobMatchResult QMimeXMLProvider::findByFileName(const QString &fileName)
     return m_mimeTypeGlobs.matchingGlobs(fileName);
 }
 
-QMimeType QMimeXMLProvider::findByMagic(const QByteArray &data, int *accuracyPtr)
+QString QMimeXMLProvider::findByMagic(const QByteArray &data, int *accuracyPtr)
 {
-    ensureLoaded();
-
-    QString candidate;
-
-    for (const QMimeMagicRuleMatcher &matcher : qAsConst(m_magicMatchers)) {
-        if (matcher.matches(data)) {
-            const int priority = matcher.priority();
-            if (priority > *accuracyPtr) {
-                *accuracyPtr = priority;
-                candidate = matcher.mimetype();
-            }
-        }
-    }
-    return mimeTypeForName(candidate);
+    return m_magicIndex.match(data, accuracyPtr);
 }
 
 void QMimeXMLProvider::ensureLoaded()
@@ -793,6 +783,9 @@ void QMimeXMLProvider::ensureLoaded()
 
         for (const QString &file : qAsConst(allFiles))
             load(file);
+
+        m_magicIndex.build(m_magicMatchers);
+        m_magicMatchers.clear();
     }
 }
 
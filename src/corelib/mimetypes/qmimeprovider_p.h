@@ -57,14 +57,13 @@
 #ifndef QT_NO_MIMETYPE
 
 #include "qmimeglobpattern_p.h"
+#include "qmimemagicrulematcher_p.h"
 #include <QtCore/qdatetime.h>
 #include <QtCore/qset.h>
 #include <QtCore/qelapsedtimer.h>
 
 QT_BEGIN_NAMESPACE
 
-class QMimeMagicRuleMatcher;
-
 class QMimeProviderBase
 {
 public:
@@ -72,12 +71,15 @@ public:
     virtual ~QMimeProviderBase() {}
 
     virtual bool isValid() = 0;
+    virtual void ensureLoaded() = 0;
     virtual QMimeType mimeTypeForName(const QString &name) = 0;
     virtual QMimeGlobMatchResult findByFileName(const QString &fileName) = 0;
     virtual QStringList parents(const QString &mime) = 0;
     virtual QString resolveAlias(const QString &name) = 0;
     virtual QStringList listAliases(const QString &name) = 0;
-    virtual QMimeType findByMagic(const QByteArray &data, int *accuracyPtr) = 0;
+    // Does not reload anything; requires a prior call to ensureLoaded(), after which
+    // it may be called from several threads at once.
+    virtual QString findByMagic(const QByteArray &data, int *accuracyPtr) = 0;
     virtual QList<QMimeType> allMimeTypes() = 0;
     virtual void loadMimeTypePrivate(QMimeTypePrivate &) {}
     virtual void loadIcon(QMimeTypePrivate &) {}
@@ -99,12 +101,13 @@ public:
     virtual ~QMimeBinaryProvider();
 
     virtual bool isValid() Q_DECL_OVERRIDE;
+    virtual void ensureLoaded() Q_DECL_OVERRIDE;
     virtual QMimeType mimeTypeForName(const QString &name) Q_DECL_OVERRIDE;
     virtual QMimeGlobMatchResult findByFileName(const QString &fileName) Q_DECL_OVERRIDE;
     virtual QStringList parents(const QString &mime) Q_DECL_OVERRIDE;
     virtual QString resolveAlias(const QString &name) Q_DECL_OVERRIDE;
     virtual QStringList listAliases(const QString &name) Q_DECL_OVERRIDE;
-    virtual QMimeType findByMagic(const QByteArray &data, int *accuracyPtr) Q_DECL_OVERRIDE;
+    virtual QString findByMagic(const QByteArray &data, int *accuracyPtr) Q_DECL_OVERRIDE;
     virtual QList<QMimeType> allMimeTypes() Q_DECL_OVERRIDE;
     virtual void loadMimeTypePrivate(QMimeTypePrivate &) Q_DECL_OVERRIDE;
     virtual void loadIcon(QMimeTypePrivate &) Q_DECL_OVERRIDE;
@@ -113,7 +116,7 @@ public:
 private:
     struct CacheFile;
 
-    void matchGlobList(QMimeGlobMatchResult &result, CacheFile *cacheFile, int offset, const QString &fileName);
+    void matchGlobList(QMimeGlobMatchResult &result, CacheFile *cacheFile, int offset, const QString &fileName, const QString &lowerFileName);
     bool matchSuffixTree(QMimeGlobMatchResult &result, CacheFile *cacheFile, int numEntries, int firstOffset, const QString &fileName, int charPos, bool caseSensitiveCheck);
     bool matchMagicRule(CacheFile *cacheFile, int numMatchlets, int firstOffset, const QByteArray &data);
     QLatin1String iconForMime(CacheFile *cacheFile, int posListOffset, const QByteArray &inputMime);
@@ -142,12 +145,13 @@ public:
     ~QMimeXMLProvider();
 
     virtual bool isValid() Q_DECL_OVERRIDE;
+    virtual void ensureLoaded() Q_DECL_OVERRIDE;
     virtual QMimeType mimeTypeForName(const QString &name) Q_DECL_OVERRIDE;
     virtual QMimeGlobMatchResult findByFileName(const QString &fileName) Q_DECL_OVERRIDE;
     virtual QStringList parents(const QString &mime) Q_DECL_OVERRIDE;
     virtual QString resolveAlias(const QString &name) Q_DECL_OVERRIDE;
     virtual QStringList listAliases(const QString &name) Q_DECL_OVERRIDE;
-    virtual QMimeType findByMagic(const QByteArray &data, int *accuracyPtr) Q_DECL_OVERRIDE;
+    virtual QString findByMagic(const QByteArray &data, int *accuracyPtr) Q_DECL_OVERRIDE;
     virtual QList<QMimeType> allMimeTypes() Q_DECL_OVERRIDE;
 
     bool load(const QString &fileName, QString *errorMessage);
@@ -160,7 +164,6 @@ public:
     void addMagicMatcher(const QMimeMagicRuleMatcher &matcher);
 
 private:
-    void ensureLoaded();
     void load(const QString &fileName);
 
     bool m_loaded;
@@ -175,7 +178,8 @@ private:
     ParentsHash m_parents;
     QMimeAllGlobPatterns m_mimeTypeGlobs;
 
-    QList<QMimeMagicRuleMatcher> m_magicMatchers;
+    QList<QMimeMagicRuleMatcher> m_magicMatchers; // filled while parsing
+    QMimeMagicRuleIndex m_magicIndex; // built from m_magicMatchers once loaded
     QStringList m_allFiles;
 };
 
@@ -53,6 +53,10 @@
 #include "qjsonvalue.h"
 #include "qjsonobject.h"
 #include "qjsonarray.h"
+#include "qcryptographichash.h"
+#include "qdatetime.h"
+#include "qsavefile.h"
+#include "qstandardpaths.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -88,6 +92,110 @@ QFactoryLoaderPrivate::~QFactoryLoaderPrivate()
     }
 }
 
+namespace {
+
+/*
+    Remembers the metadata of the files in one plugin directory across
+    runs, so that QFactoryLoader::update() only has to open and parse the
+    files that were added or changed. Entries are keyed by file name and
+    are only used while the size and modification time of the file match.
+    The cache is stored as binary JSON in the user's cache directory. It
+    is only used if the QT_PLUGIN_CACHE environment variable is set to a
+    non-zero value.
+*/
+class QPluginMetaDataCache
+{
+public:
+    explicit QPluginMetaDataCache(const QString &directory);
+    ~QPluginMetaDataCache();
+
+    void resolve(const QString &fileName, const QFileInfo &info, QLibraryPrivate *library);
+
+private:
+    enum { Version = 1 };
+
+    QString directory;
+    QString cacheFileName;
+    QJsonObject entries;
+    QJsonObject updatedEntries;
+    bool modified;
+};
+
+QPluginMetaDataCache::QPluginMetaDataCache(const QString &directory)
+    : directory(directory), modified(false)
+{
+    if (!qEnvironmentVariableIntValue("QT_PLUGIN_CACHE"))
+        return;
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (cacheDir.isEmpty())
+        return;
+
+    const QByteArray hash = QCryptographicHash::hash(directory.toUtf8(), QCryptographicHash::Sha1);
+    cacheFileName = cacheDir + QLatin1String("/qtplugincache/") + QLatin1String(hash.toHex());
+
+    QFile file(cacheFileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    const QJsonObject root = QJsonDocument::fromBinaryData(file.readAll(), QJsonDocument::Validate).object();
+    if (root.value(QLatin1String("version")).toInt() == Version
+            && root.value(QLatin1String("directory")).toString() == directory) {
+        entries = root.value(QLatin1String("plugins")).toObject();
+    }
+    if (qt_debug_component())
+        qDebug() << "QFactoryLoader::QFactoryLoader() read" << entries.size() << "entries from" << cacheFileName;
+}
+
+QPluginMetaDataCache::~QPluginMetaDataCache()
+{
+    // entries of files that were removed are dropped as well
+    if (cacheFileName.isEmpty() || (!modified && updatedEntries.size() == entries.size()))
+        return;
+
+    QJsonObject root;
+    root.insert(QLatin1String("version"), int(Version));
+    root.insert(QLatin1String("directory"), directory);
+    root.insert(QLatin1String("plugins"), updatedEntries);
+
+    QDir().mkpath(QFileInfo(cacheFileName).absolutePath());
+    QSaveFile file(cacheFileName);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(root).toBinaryData());
+        file.commit();
+    }
+}
+
+void QPluginMetaDataCache::resolve(const QString &fileName, const QFileInfo &info,
+                                   QLibraryPrivate *library)
+{
+    if (cacheFileName.isEmpty())
+        return;
+
+    const qint64 size = info.size();
+    const qint64 lastModified = info.lastModified().toMSecsSinceEpoch();
+    const QJsonObject entry = entries.value(fileName).toObject();
+    if (!entry.isEmpty()
+            && qint64(entry.value(QLatin1String("size")).toDouble()) == size
+            && qint64(entry.value(QLatin1String("mtime")).toDouble()) == lastModified) {
+        library->setCachedPluginState(entry.value(QLatin1String("metaData")).toObject(),
+                                      entry.value(QLatin1String("error")).toString());
+        updatedEntries.insert(fileName, entry);
+        return;
+    }
+
+    library->isPlugin();
+    QJsonObject newEntry;
+    newEntry.insert(QLatin1String("size"), double(size));
+    newEntry.insert(QLatin1String("mtime"), double(lastModified));
+    if (!library->metaData.isEmpty())
+        newEntry.insert(QLatin1String("metaData"), library->metaData);
+    else
+        newEntry.insert(QLatin1String("error"), library->errorString);
+    updatedEntries.insert(fileName, newEntry);
+    modified = true;
+}
+
+} // unnamed namespace
+
 void QFactoryLoader::update()
 {
 #ifdef QT_SHARED
@@ -114,6 +222,7 @@ void QFactoryLoader::update()
 #endif
                     QDir::Files);
         QLibraryPrivate *library = 0;
+        QPluginMetaDataCache cache(path);
 
 #ifdef Q_OS_MAC
         // Loading both the debug and release version of the cocoa plugins causes the objective-c runtime
@@ -142,7 +251,9 @@ void QFactoryLoader::update()
             if (qt_debug_component()) {
                 qDebug() << "QFactoryLoader::QFactoryLoader() looking at" << fileName;
             }
-            library = QLibraryPrivate::findOrCreate(QFileInfo(fileName).canonicalFilePath());
+            const QFileInfo info(fileName);
+            library = QLibraryPrivate::findOrCreate(info.canonicalFilePath());
+            cache.resolve(plugins.at(j), info, library);
             if (!library->isPlugin()) {
                 if (qt_debug_component()) {
                     qDebug() << library->errorString << endl
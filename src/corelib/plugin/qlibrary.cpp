@@ -736,6 +736,36 @@ void QLibraryPrivate::updatePluginState()
         return;
     }
 
+    checkPluginMetaData();
+}
+
+/*!
+    \internal
+
+    Sets the plugin state from metadata that was extracted from this
+    library earlier, instead of reading it from the file again. An empty
+    \a cachedMetaData means that the file is not a plugin, for the reason
+    given by \a cachedErrorString.
+*/
+void QLibraryPrivate::setCachedPluginState(const QJsonObject &cachedMetaData,
+                                           const QString &cachedErrorString)
+{
+    if (pluginState != MightBeAPlugin)
+        return;
+
+    if (cachedMetaData.isEmpty()) {
+        errorString = cachedErrorString;
+        pluginState = IsNotAPlugin;
+        return;
+    }
+
+    errorString.clear();
+    metaData = cachedMetaData;
+    checkPluginMetaData();
+}
+
+void QLibraryPrivate::checkPluginMetaData()
+{
     pluginState = IsNotAPlugin; // be pessimistic
 
     uint qt_version = (uint)metaData.value(QLatin1String("version")).toDouble();
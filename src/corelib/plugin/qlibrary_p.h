@@ -107,12 +107,14 @@ public:
     QString errorString;
 
     void updatePluginState();
+    void setCachedPluginState(const QJsonObject &cachedMetaData, const QString &cachedErrorString);
     bool isPlugin();
 
 private:
     explicit QLibraryPrivate(const QString &canonicalFileName, const QString &version, QLibrary::LoadHints loadHints);
     ~QLibraryPrivate();
     void mergeLoadHints(QLibrary::LoadHints loadHints);
+    void checkPluginMetaData();
 
     bool load_sys();
     bool unload_sys();
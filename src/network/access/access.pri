@@ -36,6 +36,7 @@ HEADERS += \
     access/qnetworkdiskcache_p.h \
     access/qnetworkdiskcache.h \
     access/qhttpthreaddelegate_p.h \
+    access/qbytedataqueue_p.h \
     access/qhttpmultipart.h \
     access/qhttpmultipart_p.h \
     access/qnetworkfile_p.h \
@@ -112,6 +112,7 @@ void BitOStream::write(const QByteArray &src, bool compressed)
     }
 
     write(byteLen);
+    buffer.reserve(buffer.size() + byteLen);
 
     if (compressed) {
         huffman_encode_string(src, *this);
@@ -173,6 +174,16 @@ bool BitIStream::hasMoreBits() const
     return offset < bitLength();
 }
 
+const uchar *BitIStream::begin() const
+{
+    return first;
+}
+
+const uchar *BitIStream::end() const
+{
+    return last;
+}
+
 bool BitIStream::skipBits(quint64 nBits)
 {
     if (nBits > bitLength() || bitLength() - nBits < offset)
@@ -117,6 +117,8 @@ public:
 
     quint64 bitLength() const;
     bool hasMoreBits() const;
+    const uchar *begin() const;
+    const uchar *end() const;
 
     // peekBits tries to read 'length' bits from the bitstream into
     // 'dst' ('length' must be <= sizeof(dst) * 8), packing them
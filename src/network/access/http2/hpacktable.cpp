@@ -41,8 +41,6 @@
 
 #include <QtCore/qdebug.h>
 
-#include <algorithm>
-#include <cstring>
 #include <limits>
 
 
@@ -69,81 +67,7 @@ HeaderSize entry_size(const QByteArray &name, const QByteArray &value)
     return HeaderSize(true, quint32(sum + 32));
 }
 
-namespace
-{
-
-int compare(const QByteArray &lhs, const QByteArray &rhs)
-{
-    if (const int minLen = std::min(lhs.size(), rhs.size())) {
-        // We use memcmp, since strings in headers are allowed
-        // to contain '\0'.
-        const int cmp = std::memcmp(lhs.constData(), rhs.constData(), minLen);
-        if (cmp)
-            return cmp;
-    }
-
-    return lhs.size() - rhs.size();
-}
-
-} // unnamed namespace
-
-FieldLookupTable::SearchEntry::SearchEntry()
-    : field(),
-      chunk(),
-      offset(),
-      table()
-{
-}
-
-FieldLookupTable::SearchEntry::SearchEntry(const HeaderField *f,
-                                           const Chunk *c,
-                                           quint32 o,
-                                           const FieldLookupTable *t)
-    : field(f),
-      chunk(c),
-      offset(o),
-      table(t)
-{
-    Q_ASSERT(field);
-}
-
-bool FieldLookupTable::SearchEntry::operator < (const SearchEntry &rhs)const
-{
-    Q_ASSERT(field);
-    Q_ASSERT(rhs.field);
-
-    int cmp = compare(field->name, rhs.field->name);
-    if (cmp)
-        return cmp < 0;
-
-    cmp = compare(field->value, rhs.field->value);
-    if (cmp)
-        return cmp < 0;
-
-    if (!chunk) // 'this' is not in the searchIndex.
-        return rhs.chunk;
-
-    if (!rhs.chunk) // not in the searchIndex.
-        return false;
-
-    Q_ASSERT(table);
-    Q_ASSERT(rhs.table == table);
-
-    const quint32 leftChunkIndex = table->indexOfChunk(chunk);
-    const quint32 rightChunkIndex = rhs.table->indexOfChunk(rhs.chunk);
-
-    // Later added - smaller is chunk index (since we push_front).
-    if (leftChunkIndex != rightChunkIndex)
-        return leftChunkIndex > rightChunkIndex;
-
-    // Later added - smaller is offset.
-    return offset > rhs.offset;
-}
-
-// This data is from HPACK's specs and it's quite
-// conveniently sorted == works with binary search as it is.
-// Later this can probably change and instead of simple
-// vector we'll just reuse FieldLookupTable.
+// This data is from HPACK's specs.
 // TODO: it makes sense to generate this table while ...
 // configuring/building Qt (some script downloading/parsing/generating
 // would be quite handy).
@@ -216,10 +140,38 @@ const std::vector<HeaderField> &staticTable()
     return table;
 }
 
+namespace
+{
+
+// The lowest index of each (name|value) pair and name in the static table.
+struct StaticTableIndex
+{
+    StaticTableIndex()
+    {
+        const auto &table = staticTable();
+        for (quint32 i = quint32(table.size()); i > 0; --i) {
+            fields.insert(table[i - 1], i);
+            names.insert(table[i - 1].name, i);
+        }
+    }
+
+    QHash<HeaderField, quint32> fields;
+    QHash<QByteArray, quint32> names;
+};
+
+const StaticTableIndex &staticTableIndex()
+{
+    static const StaticTableIndex index;
+    return index;
+}
+
+} // unnamed namespace
+
 FieldLookupTable::FieldLookupTable(quint32 maxSize, bool use)
     : maxTableSize(maxSize),
       tableCapacity(maxSize),
       useIndex(use),
+      nInserted(),
       nDynamic(),
       begin(),
       end(),
@@ -259,9 +211,10 @@ bool FieldLookupTable::prependField(const QByteArray &name, const QByteArray &va
     newField.value = value;
 
     if (useIndex) {
-        const auto result = searchIndex.insert(frontKey());
-        Q_UNUSED(result) Q_ASSERT(result.second);
+        fieldIndex.insert(newField, nInserted);
+        nameIndex.insert(name, nInserted);
     }
+    ++nInserted;
 
     return true;
 }
@@ -273,12 +226,20 @@ void FieldLookupTable::evictEntry()
 
     Q_ASSERT(end != begin);
 
+    const HeaderField &field = back();
     if (useIndex) {
-        const auto res = searchIndex.erase(backKey());
-        Q_UNUSED(res) Q_ASSERT(res == 1);
+        // Unless a newer entry has taken its place:
+        const quint32 sequence = nInserted - nDynamic;
+        const auto fieldPos = fieldIndex.find(field);
+        Q_ASSERT(fieldPos != fieldIndex.end());
+        if (fieldPos.value() == sequence)
+            fieldIndex.erase(fieldPos);
+        const auto namePos = nameIndex.find(field.name);
+        Q_ASSERT(namePos != nameIndex.end());
+        if (namePos.value() == sequence)
+            nameIndex.erase(namePos);
     }
 
-    const HeaderField &field = back();
     const auto entrySize = entry_size(field);
     Q_ASSERT(entrySize.first);
     Q_ASSERT(dataSize >= entrySize.second);
@@ -318,7 +279,8 @@ quint32 FieldLookupTable::dynamicDataSize() const
 
 void FieldLookupTable::clearDynamicTable()
 {
-    searchIndex.clear();
+    fieldIndex.clear();
+    nameIndex.clear();
     chunks.clear();
     begin = 0;
     end = 0;
@@ -334,19 +296,9 @@ bool FieldLookupTable::indexIsValid(quint32 index) const
 quint32 FieldLookupTable::indexOf(const QByteArray &name, const QByteArray &value)const
 {
     // Start from the static part first:
-    const auto &table = staticTable();
     const HeaderField field(name, value);
-    const auto staticPos = std::lower_bound(table.begin(), table.end(), field,
-                                            [](const HeaderField &lhs, const HeaderField &rhs) {
-                                                int cmp = compare(lhs.name, rhs.name);
-                                                if (cmp)
-                                                    return cmp < 0;
-                                                return compare(lhs.value, rhs.value) < 0;
-                                            });
-    if (staticPos != table.end()) {
-        if (staticPos->name == name && staticPos->value == value)
-            return staticPos - table.begin() + 1;
-    }
+    if (const quint32 index = staticTableIndex().fields.value(field))
+        return index;
 
     // Now we have to lookup in our dynamic part ...
     if (!useIndex) {
@@ -354,13 +306,9 @@ quint32 FieldLookupTable::indexOf(const QByteArray &name, const QByteArray &valu
         return 0;
     }
 
-    const SearchEntry key(&field, nullptr, 0, this);
-    const auto pos = searchIndex.lower_bound(key);
-    if (pos != searchIndex.end()) {
-        const HeaderField &found = *pos->field;
-        if (found.name == name && found.value == value)
-            return keyToIndex(*pos);
-    }
+    const auto pos = fieldIndex.constFind(field);
+    if (pos != fieldIndex.constEnd())
+        return sequenceToIndex(pos.value());
 
     return 0;
 }
@@ -368,16 +316,8 @@ quint32 FieldLookupTable::indexOf(const QByteArray &name, const QByteArray &valu
 quint32 FieldLookupTable::indexOf(const QByteArray &name) const
 {
     // Start from the static part first:
-    const auto &table = staticTable();
-    const HeaderField field(name, QByteArray());
-    const auto staticPos = std::lower_bound(table.begin(), table.end(), field,
-                                            [](const HeaderField &lhs, const HeaderField &rhs) {
-                                                return compare(lhs.name, rhs.name) < 0;
-                                            });
-    if (staticPos != table.end()) {
-        if (staticPos->name == name)
-            return staticPos - table.begin() + 1;
-    }
+    if (const quint32 index = staticTableIndex().names.value(name))
+        return index;
 
     // Now we have to lookup in our dynamic part ...
     if (!useIndex) {
@@ -385,13 +325,9 @@ quint32 FieldLookupTable::indexOf(const QByteArray &name) const
         return 0;
     }
 
-    const SearchEntry key(&field, nullptr, 0, this);
-    const auto pos = searchIndex.lower_bound(key);
-    if (pos != searchIndex.end()) {
-        const HeaderField &found = *pos->field;
-        if (found.name == name)
-            return keyToIndex(*pos);
-    }
+    const auto pos = nameIndex.constFind(name);
+    if (pos != nameIndex.constEnd())
+        return sequenceToIndex(pos.value());
 
     return 0;
 }
@@ -457,47 +393,12 @@ const HeaderField &FieldLookupTable::back() const
     return (*chunks[chunkIndex])[offset];
 }
 
-quint32 FieldLookupTable::indexOfChunk(const Chunk *chunk) const
+quint32 FieldLookupTable::sequenceToIndex(quint32 sequence) const
 {
-    Q_ASSERT(chunk);
-
-    for (size_type i = 0; i < chunks.size(); ++i) {
-        if (chunks[i].get() == chunk)
-            return quint32(i);
-    }
-
-    Q_UNREACHABLE();
-    return 0;
-}
-
-quint32 FieldLookupTable::keyToIndex(const SearchEntry &key) const
-{
-    Q_ASSERT(key.chunk);
-
-    const auto chunkIndex = indexOfChunk(key.chunk);
-    const auto offset = key.offset;
-    Q_ASSERT(offset < ChunkSize);
-    Q_ASSERT(chunkIndex || offset >= begin);
-
-    return quint32(offset + chunkIndex * ChunkSize - begin + 1 + staticTable().size());
-}
-
-FieldLookupTable::SearchEntry FieldLookupTable::frontKey() const
-{
-    Q_ASSERT(chunks.size() && end != begin);
-    return SearchEntry(&front(), chunks.front().get(), begin, this);
-}
-
-FieldLookupTable::SearchEntry FieldLookupTable::backKey() const
-{
-    Q_ASSERT(chunks.size() && end != begin);
-
-    const HeaderField &field = back();
-    const quint32 absIndex = end - 1;
-    const auto offset = absIndex % ChunkSize;
-    const auto chunk = chunks[absIndex / ChunkSize].get();
-
-    return SearchEntry(&field, chunk, offset, this);
+    // The newest entry (sequence number nInserted - 1) has the
+    // first index after the static table:
+    Q_ASSERT(nInserted - sequence <= nDynamic);
+    return quint32(staticTable().size()) + nInserted - sequence;
 }
 
 bool FieldLookupTable::updateDynamicTableSize(quint32 size)
@@ -53,12 +53,12 @@
 
 #include <QtCore/qbytearray.h>
 #include <QtCore/qglobal.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qpair.h>
 
 #include <vector>
 #include <memory>
 #include <deque>
-#include <set>
 
 QT_BEGIN_NAMESPACE
 
@@ -86,6 +86,11 @@ struct Q_AUTOTEST_EXPORT HeaderField
     QByteArray value;
 };
 
+inline uint qHash(const HeaderField &field, uint seed = 0) Q_DECL_NOTHROW
+{
+    return qHash(field.value, qHash(field.name, seed));
+}
+
 using HeaderSize = QPair<bool, quint32>;
 
 HeaderSize entry_size(const QByteArray &name, const QByteArray &value);
@@ -124,23 +129,19 @@ inline HeaderSize entry_size(const HeaderField &entry)
     offset in this chunk - random access.
 
     Lookup in a static part is straightforward:
-    it's an (immutable) vector, data is sorted,
-    contains no duplicates, we use binary search comparing string values.
+    it's an (immutable) vector, we hash (name|value) pairs and
+    names once, mapping them to their (lowest) indices.
 
     To provide a lookup in dynamic table faster than a linear search,
-    we have an std::set of 'SearchEntries', where each entry contains:
-     - a pointer to a (name|value) pair (to compare
-       name|value strings).
-     - a pointer to a chunk containing this pair and
-     - an offset within this chunk - to calculate a
-       'linear' index.
-
-    Entries in a table can be duplicated (HPACK, 2.3.2),
-    if we evict an entry, we must update our index removing
-    the exactly right key, thus keys in this set are sorted
-    by name|value pairs first, and then by chunk index/offset
-    (so that NewSearchEntryKey < OldSearchEntry even if strings
-    are equal).
+    we hash (name|value) pairs and names as well, mapping them to
+    the sequence number of the entry inserted last with this pair/name.
+    The n-th entry ever prepended has sequence number n, so the
+    newest entry's sequence number gives us its 'linear' index.
+
+    Entries in a table can be duplicated (HPACK, 2.3.2), a lookup
+    must find the newest (smallest index) of them. When we evict
+    an entry (always the oldest), we only remove its key from the
+    hashes if no newer entry has replaced it there.
 */
 
 class Q_AUTOTEST_EXPORT FieldLookupTable
@@ -188,30 +189,14 @@ private:
     std::deque<ChunkPtr> chunks;
     using size_type = std::deque<ChunkPtr>::size_type;
 
-    struct SearchEntry;
-    friend struct SearchEntry;
-
-    struct SearchEntry
-    {
-        SearchEntry();
-        SearchEntry(const HeaderField *f, const Chunk *c,
-                    quint32 o, const FieldLookupTable *t);
-
-        const HeaderField *field;
-        const Chunk *chunk;
-        const quint32 offset;
-        const FieldLookupTable *table;
-
-        bool operator < (const SearchEntry &rhs) const;
-    };
-
     bool useIndex;
-    std::set<SearchEntry> searchIndex;
+    // Sequence numbers of the newest entries with a given (name|value)
+    // pair or name.
+    QHash<HeaderField, quint32> fieldIndex;
+    QHash<QByteArray, quint32> nameIndex;
+    quint32 nInserted; // sequence number of the next entry
 
-    SearchEntry frontKey() const;
-    SearchEntry backKey() const;
-
-    bool fieldAt(quint32 index, HeaderField *field) const;
+    quint32 sequenceToIndex(quint32 sequence) const;
 
     const HeaderField &front() const;
     HeaderField &front();
@@ -222,9 +207,6 @@ private:
     quint32 end;
     quint32 dataSize;
 
-    quint32 indexOfChunk(const Chunk *chunk) const;
-    quint32 keyToIndex(const SearchEntry &key) const;
-
     mutable QByteArray dummyDst;
 
     Q_DISABLE_COPY(FieldLookupTable);
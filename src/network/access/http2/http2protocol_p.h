@@ -130,6 +130,15 @@ enum Http2PredefinedParameters
 // It's int, it has internal linkage, it's ok to have it in headers -
 // no ODR violation is possible.
 const quint32 lastValidStreamID((quint32(1) << 31) - 1); // HTTP/2, 5.1.1
+const qint32 maxWindowSize((quint32(1) << 31) - 1); // HTTP/2, 6.9.1
+
+// Our receive windows, unless configured otherwise. The session window
+// is larger, so that several streams can make progress concurrently:
+const qint32 qtDefaultSessionReceiveWindowSize(defaultSessionWindowSize * 10);
+const qint32 qtDefaultStreamReceiveWindowSize(defaultSessionWindowSize);
+// Receive windows grow with the measured bandwidth-delay product, but not
+// beyond this (unless configured larger to begin with):
+const qint32 maxAutoTunedWindowSize(16 * 1024 * 1024);
 
 extern const Q_AUTOTEST_EXPORT char Http2clientPreface[clientPrefaceLength];
 
@@ -352,30 +352,6 @@ const CodeEntry staticHuffmanCodeTable[]
     {256, 0xfffffffcul, 30}   // EOS 11111111|11111111|11111111|111111
 };
 
-void write_huffman_code(BitOStream &outputStream, const CodeEntry &code)
-{
-    // Append octet by octet.
-    auto bitLength = code.bitLength;
-    const auto hc = code.huffmanCode >> (32 - bitLength);
-
-    if (bitLength > 24) {
-        outputStream.writeBits(uchar(hc >> 24), bitLength - 24);
-        bitLength = 24;
-    }
-
-    if (bitLength > 16) {
-        outputStream.writeBits(uchar(hc >> 16), bitLength - 16);
-        bitLength = 16;
-    }
-
-    if (bitLength > 8) {
-        outputStream.writeBits(uchar(hc >> 8), bitLength - 8);
-        bitLength = 8;
-    }
-
-    outputStream.writeBits(uchar(hc), bitLength);
-}
-
 }
 
 // That's from HPACK's specs - we deal with octets.
@@ -384,16 +360,34 @@ static_assert(std::numeric_limits<uchar>::digits == 8, "octets expected");
 quint64 huffman_encoded_bit_length(const QByteArray &inputData)
 {
     quint64 bitLength = 0;
-    for (int i = 0, e = inputData.size(); i < e; ++i)
-        bitLength += staticHuffmanCodeTable[int(inputData[i])].bitLength;
+    const uchar *src = reinterpret_cast<const uchar *>(inputData.constData());
+    for (const uchar *end = src + inputData.size(); src != end; ++src)
+        bitLength += staticHuffmanCodeTable[*src].bitLength;
 
     return bitLength;
 }
 
 void huffman_encode_string(const QByteArray &inputData, BitOStream &outputStream)
 {
-    for (int i = 0, e = inputData.size(); i < e; ++i)
-        write_huffman_code(outputStream, staticHuffmanCodeTable[int(inputData[i])]);
+    // Collect codes in a 64-bit buffer and write them out
+    // octet by octet, instead of in pieces of each code.
+    // Codes are at most 30 bits long, so 32 free bits are enough.
+    quint64 buffer = 0;
+    quint32 bufferedBits = 0;
+    const uchar *src = reinterpret_cast<const uchar *>(inputData.constData());
+    for (const uchar *end = src + inputData.size(); src != end; ++src) {
+        const CodeEntry &code = staticHuffmanCodeTable[*src];
+        buffer |= quint64(code.huffmanCode) << (32 - bufferedBits);
+        bufferedBits += code.bitLength;
+        while (bufferedBits >= 8) {
+            outputStream.writeBits(uchar(buffer >> 56), 8);
+            buffer <<= 8;
+            bufferedBits -= 8;
+        }
+    }
+
+    if (bufferedBits)
+        outputStream.writeBits(uchar(buffer >> (64 - bufferedBits)), quint8(bufferedBits));
 
     // Pad bits ...
     if (outputStream.bitLength() % 8)
@@ -492,48 +486,74 @@ HuffmanDecoder::HuffmanDecoder()
 
 bool HuffmanDecoder::decodeStream(BitIStream &inputStream, QByteArray &outputBuffer)
 {
+    // We keep up to 64 not yet decoded bits in 'buffer', aligned to its
+    // most significant bit, and refill it octet by octet; each step then
+    // resolves 9 bits (or more, via child tables) through the prefix tables.
+    const quint64 startOffset = inputStream.streamOffset();
+    const uchar *src = inputStream.begin() + startOffset / 8;
+    const uchar *const end = inputStream.end();
+    if (src == end)
+        return true;
+
+    // Every code is at least 5 bits long:
+    outputBuffer.reserve(outputBuffer.size() + int((end - src) * 8 / minCodeLength));
+
+    quint64 buffer = 0;
+    quint32 bufferedBits = 0;
+    quint64 consumedBits = 0;
+    if (const quint32 skipped = startOffset % 8) {
+        buffer = quint64(uchar(*src++ << skipped)) << 56;
+        bufferedBits = 8 - skipped;
+    }
+
+    bool result = false;
     while (true) {
-        quint32 chunk = 0;
-        const quint32 readBits = inputStream.peekBits(inputStream.streamOffset(), 32, &chunk);
-        if (!readBits)
-            return !inputStream.hasMoreBits();
-
-        if (readBits < minCodeLength) {
-            inputStream.skipBits(readBits);
-            return padding_is_valid(chunk, readBits);
+        while (bufferedBits <= 56 && src != end) {
+            buffer |= quint64(*src++) << (56 - bufferedBits);
+            bufferedBits += 8;
         }
 
-        quint32 tableIndex = 0;
-        const PrefixTable *table = &prefixTables[tableIndex];
-        quint32 entryIndex = chunk >> (32 - table->indexLength);
-        PrefixTableEntry entry = tableEntry(*table, entryIndex);
+        if (!bufferedBits) {
+            result = true;
+            break;
+        }
 
-        while (true) {
-            if (entry.nextTable == tableIndex)
-                break;
+        const quint32 chunk = quint32(buffer >> 32);
+        if (bufferedBits < minCodeLength) {
+            consumedBits += bufferedBits;
+            result = padding_is_valid(chunk, bufferedBits);
+            break;
+        }
 
-            tableIndex = entry.nextTable;
+        quint32 tableIndex = 0;
+        const PrefixTable *table = &prefixTables[tableIndex];
+        const PrefixTableEntry *entry = &tableData[table->offset + (chunk >> (32 - table->indexLength))];
+        while (entry->nextTable != tableIndex) {
+            tableIndex = entry->nextTable;
             table = &prefixTables[tableIndex];
-            entryIndex = chunk << table->prefixLength >> (32 - table->indexLength);
-            entry = tableEntry(*table, entryIndex);
+            entry = &tableData[table->offset + (chunk << table->prefixLength >> (32 - table->indexLength))];
         }
 
-        if (entry.bitLength > readBits) {
-            inputStream.skipBits(readBits);
-            return padding_is_valid(chunk, readBits);
+        if (entry->bitLength > bufferedBits) {
+            consumedBits += bufferedBits;
+            result = padding_is_valid(chunk, bufferedBits);
+            break;
         }
 
-        if (!entry.bitLength || entry.byteValue == 256) {
+        if (!entry->bitLength || entry->byteValue == 256) {
             //EOS (256) == compression error (HPACK).
-            inputStream.skipBits(readBits);
-            return false;
+            consumedBits += bufferedBits;
+            break;
         }
 
-        outputBuffer.append(entry.byteValue);
-        inputStream.skipBits(entry.bitLength);
+        outputBuffer.append(char(entry->byteValue));
+        buffer <<= entry->bitLength;
+        bufferedBits -= entry->bitLength;
+        consumedBits += entry->bitLength;
     }
 
-    return false;
+    inputStream.skipBits(consumedBits);
+    return result;
 }
 
 quint32 HuffmanDecoder::addTable(quint32 prefix, quint32 index)
@@ -83,7 +83,7 @@ struct CodeEntry
 class BitOStream;
 
 quint64 huffman_encoded_bit_length(const QByteArray &inputData);
-void huffman_encode_string(const QByteArray &inputData, BitOStream &outputStream);
+Q_AUTOTEST_EXPORT void huffman_encode_string(const QByteArray &inputData, BitOStream &outputStream);
 
 // PrefixTable:
 // Huffman codes with a small bit length
@@ -172,7 +172,7 @@ private:
     quint32 minCodeLength;
 };
 
-bool huffman_decode_string(BitIStream &inputStream, QByteArray *outputBuffer);
+Q_AUTOTEST_EXPORT bool huffman_decode_string(BitIStream &inputStream, QByteArray *outputBuffer);
 
 } // namespace HPack
 
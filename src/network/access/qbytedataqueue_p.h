@@ -0,0 +1,126 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBYTEDATAQUEUE_P_H
+#define QBYTEDATAQUEUE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the Network Access API.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qbytearray.h>
+
+QT_BEGIN_NAMESPACE
+
+// A queue of QByteArray chunks for exactly one producer thread and one
+// consumer thread, which need no lock to pass the data. The producer
+// learns from enqueue() when the consumer has to be woken up: only the
+// first chunk after the consumer called takeWakeUp() asks for it, so one
+// notification covers any number of chunks.
+class QByteDataQueue
+{
+public:
+    QByteDataQueue()
+        : head(new Node), tail(head)
+    {
+    }
+    ~QByteDataQueue()
+    {
+        while (head) {
+            Node *next = head->next.load();
+            delete head;
+            head = next;
+        }
+    }
+
+    // producer side
+    bool enqueue(const QByteArray &data)
+    {
+        Node *node = new Node;
+        node->data = data;
+        tail->next.storeRelease(node);
+        tail = node;
+        return !wakeUpPending.fetchAndStoreOrdered(1);
+    }
+
+    // consumer side, takeWakeUp() before the dequeue() calls it was woken for
+    void takeWakeUp()
+    {
+        wakeUpPending.fetchAndStoreOrdered(0);
+    }
+
+    bool dequeue(QByteArray *data)
+    {
+        Node *next = head->next.loadAcquire();
+        if (!next)
+            return false;
+        data->swap(next->data);
+        next->data.clear();
+        delete head;
+        head = next;
+        return true;
+    }
+
+private:
+    Q_DISABLE_COPY(QByteDataQueue)
+
+    struct Node
+    {
+        QByteArray data;
+        QAtomicPointer<Node> next;
+    };
+
+    // head is a consumed node, its successors hold the queued data
+    Node *head;
+    Node *tail;
+    QAtomicInt wakeUpPending;
+};
+
+QT_END_NAMESPACE
+
+#endif // QBYTEDATAQUEUE_P_H
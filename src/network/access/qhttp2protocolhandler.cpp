@@ -148,6 +148,9 @@ QUrl urlkey_from_request(const QHttpNetworkRequest &request)
     return url;
 }
 
+// Identifies our own PINGs when they are ACKed
+const uchar bdpPingPayload[8] = {'Q', 't', 'B', 'D', 'P', 0, 0, 0};
+
 bool sum_will_overflow(qint32 windowSize, qint32 delta)
 {
     if (windowSize > 0)
@@ -161,8 +164,6 @@ bool sum_will_overflow(qint32 windowSize, qint32 delta)
 using namespace Http2;
 
 const std::deque<quint32>::size_type QHttp2ProtocolHandler::maxRecycledStreams = 10000;
-const qint32 QHttp2ProtocolHandler::sessionMaxRecvWindowSize;
-const qint32 QHttp2ProtocolHandler::streamInitialRecvWindowSize;
 const quint32 QHttp2ProtocolHandler::maxAcceptableTableSize;
 
 QHttp2ProtocolHandler::QHttp2ProtocolHandler(QHttpNetworkConnectionChannel *channel)
@@ -174,6 +175,15 @@ QHttp2ProtocolHandler::QHttp2ProtocolHandler(QHttpNetworkConnectionChannel *chan
     bool ok = false;
     const int env = qEnvironmentVariableIntValue("QT_HTTP2_ENABLE_PUSH_PROMISE", &ok);
     pushPromiseEnabled = ok && env;
+
+    const int disableAutoTuning = qEnvironmentVariableIntValue("QT_HTTP2_DISABLE_WINDOW_AUTOTUNING", &ok);
+    windowAutoTuning = !(ok && disableAutoTuning);
+
+    const QHttpNetworkConnectionPrivate *connection = m_connection->d_func();
+    sessionMaxRecvWindowSize = connection->http2SessionReceiveWindowSize;
+    sessionRecvWindowSize = sessionMaxRecvWindowSize;
+    streamInitialRecvWindowSize = connection->http2StreamReceiveWindowSize;
+    streamMaxRecvWindowSize = streamInitialRecvWindowSize;
 }
 
 void QHttp2ProtocolHandler::_q_uploadDataReadyRead()
@@ -362,6 +372,10 @@ bool QHttp2ProtocolHandler::sendClientPreface()
     frameWriter.append(quint32(Http2::maxFrameSize));
     frameWriter.append(Settings::ENABLE_PUSH_ID);
     frameWriter.append(quint32(pushPromiseEnabled));
+    if (streamInitialRecvWindowSize != defaultSessionWindowSize) {
+        frameWriter.append(Settings::INITIAL_WINDOW_SIZE_ID);
+        frameWriter.append(quint32(streamInitialRecvWindowSize));
+    }
 
     if (!frameWriter.write(*m_socket))
         return false;
@@ -489,6 +503,15 @@ bool QHttp2ProtocolHandler::sendWINDOW_UPDATE(quint32 streamID, quint32 delta)
     return frameWriter.write(*m_socket);
 }
 
+bool QHttp2ProtocolHandler::sendPING()
+{
+    Q_ASSERT(m_socket);
+
+    frameWriter.start(FrameType::PING, FrameFlag::EMPTY, connectionStreamID);
+    frameWriter.append(bdpPingPayload, bdpPingPayload + sizeof bdpPingPayload);
+    return frameWriter.write(*m_socket);
+}
+
 bool QHttp2ProtocolHandler::sendRST_STREAM(quint32 streamID, quint32 errorCode)
 {
     Q_ASSERT(m_socket);
@@ -524,6 +547,17 @@ void QHttp2ProtocolHandler::handleDATA()
 
     sessionRecvWindowSize -= inboundFrame.payloadSize();
 
+    if (windowAutoTuning && inboundFrame.payloadSize()) {
+        bdpBytesReceived += inboundFrame.payloadSize();
+        if (!bdpPingSent && (streamMaxRecvWindowSize < maxAutoTunedWindowSize
+                             || sessionMaxRecvWindowSize < maxAutoTunedWindowSize)) {
+            // Count what arrives from now until the peer ACKs our PING:
+            bdpBytesReceived = 0;
+            bdpPingSent = sendPING();
+            bdpTimer.start();
+        }
+    }
+
     if (activeStreams.contains(streamID)) {
         auto &stream = activeStreams[streamID];
 
@@ -541,11 +575,11 @@ void QHttp2ProtocolHandler::handleDATA()
             if (inboundFrame.flags().testFlag(FrameFlag::END_STREAM)) {
                 finishStream(stream);
                 deleteActiveStream(stream.streamID);
-            } else if (stream.recvWindow < streamInitialRecvWindowSize / 2) {
+            } else if (stream.recvWindow < streamMaxRecvWindowSize / 2) {
                 QMetaObject::invokeMethod(this, "sendWINDOW_UPDATE", Qt::QueuedConnection,
                                           Q_ARG(quint32, stream.streamID),
-                                          Q_ARG(quint32, streamInitialRecvWindowSize - stream.recvWindow));
-                stream.recvWindow = streamInitialRecvWindowSize;
+                                          Q_ARG(quint32, streamMaxRecvWindowSize - stream.recvWindow));
+                stream.recvWindow = streamMaxRecvWindowSize;
             }
         }
     }
@@ -743,16 +777,53 @@ void QHttp2ProtocolHandler::handlePING()
     if (inboundFrame.streamID() != connectionStreamID)
         return connectionError(PROTOCOL_ERROR, "PING on invalid stream");
 
-    if (inboundFrame.flags() & FrameFlag::ACK)
-        return connectionError(PROTOCOL_ERROR, "unexpected PING ACK");
-
     Q_ASSERT(inboundFrame.dataSize() == 8);
 
+    if (inboundFrame.flags() & FrameFlag::ACK) {
+        if (!bdpPingSent || !std::equal(bdpPingPayload, bdpPingPayload + sizeof bdpPingPayload,
+                                        inboundFrame.dataBegin())) {
+            return connectionError(PROTOCOL_ERROR, "unexpected PING ACK");
+        }
+        return estimateBandwidthDelayProduct();
+    }
+
     frameWriter.start(FrameType::PING, FrameFlag::ACK, connectionStreamID);
     frameWriter.append(inboundFrame.dataBegin(), inboundFrame.dataBegin() + 8);
     frameWriter.write(*m_socket);
 }
 
+void QHttp2ProtocolHandler::estimateBandwidthDelayProduct()
+{
+    // This is the approach of gRPC's BDP estimator: bdpBytesReceived is
+    // what our peer managed to send in one round trip. If that came close
+    // to our windows, they are what limits the throughput, so we grow them,
+    // but only as long as the throughput keeps improving as a result (if
+    // it doesn't, it's the network or the peer that limit it, not us).
+    // As we replenish windows once half of them is consumed, a peer limited
+    // by them sends between a half and all of the window per round trip,
+    // so we grow the windows by doubling them rather than by doubling
+    // bdpBytesReceived (gRPC replenishes its windows earlier).
+    Q_ASSERT(bdpPingSent);
+
+    bdpPingSent = false;
+    const qint64 rtt = qMax<qint64>(bdpTimer.nsecsElapsed(), 1);
+    const qint64 bandwidth = bdpBytesReceived * 1000000000 / rtt;
+    const qint32 window = qMin(streamMaxRecvWindowSize, sessionMaxRecvWindowSize);
+    if (bdpBytesReceived < window / 3 || bandwidth <= bdpMaxBandwidth)
+        return;
+
+    bdpMaxBandwidth = bandwidth;
+    const qint32 newWindow = qint32(qMin<qint64>(qint64(window) * 2, maxAutoTunedWindowSize));
+    // Streams pick the new size up when their window is replenished next:
+    streamMaxRecvWindowSize = qMax(streamMaxRecvWindowSize, newWindow);
+    if (newWindow > sessionMaxRecvWindowSize) {
+        const qint32 delta = newWindow - sessionMaxRecvWindowSize;
+        sessionMaxRecvWindowSize = newWindow;
+        sessionRecvWindowSize += delta;
+        sendWINDOW_UPDATE(connectionStreamID, delta);
+    }
+}
+
 void QHttp2ProtocolHandler::handleGOAWAY()
 {
     // 6.8 GOAWAY
@@ -69,6 +69,7 @@
 #include <QtCore/qobject.h>
 #include <QtCore/qflags.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qelapsedtimer.h>
 
 #include <vector>
 #include <limits>
@@ -108,6 +109,7 @@ private:
     Q_INVOKABLE bool sendWINDOW_UPDATE(quint32 streamID, quint32 delta);
     bool sendRST_STREAM(quint32 streamID, quint32 errorCoder);
     bool sendGOAWAY(quint32 errorCode);
+    bool sendPING();
 
     void handleDATA();
     void handleHEADERS();
@@ -176,13 +178,25 @@ private:
     quint32 maxConcurrentStreams = Http2::maxConcurrentStreams;
 
     // Control flow:
-    static const qint32 sessionMaxRecvWindowSize = Http2::defaultSessionWindowSize * 10;
+    qint32 sessionMaxRecvWindowSize = Http2::qtDefaultSessionReceiveWindowSize;
     // Signed integer, it can become negative (it's still a valid window size):
     qint32 sessionRecvWindowSize = sessionMaxRecvWindowSize;
 
-    // We do not negotiate this window size
+    // Announced in our SETTINGS if it's not the default one.
     // We have to send WINDOW_UPDATE frames to our peer also.
-    static const qint32 streamInitialRecvWindowSize = Http2::defaultSessionWindowSize;
+    qint32 streamInitialRecvWindowSize = Http2::qtDefaultStreamReceiveWindowSize;
+    // What we replenish stream windows to, grows past the initial
+    // size when window auto-tuning finds a larger bandwidth-delay product:
+    qint32 streamMaxRecvWindowSize = streamInitialRecvWindowSize;
+
+    // Window auto-tuning: we PING the peer while receiving DATA and count
+    // the bytes that arrive before the ACK; that's one round trip's worth.
+    bool windowAutoTuning = true;
+    bool bdpPingSent = false;
+    qint64 bdpBytesReceived = 0;
+    qint64 bdpMaxBandwidth = 0; // bytes per second
+    QElapsedTimer bdpTimer;
+    void estimateBandwidthDelayProduct();
 
     // Updated by SETTINGS and WINDOW_UPDATE.
     qint32 sessionSendWindowSize = Http2::defaultSessionWindowSize;
@@ -45,6 +45,7 @@
 #include <private/qobject_p.h>
 #include <private/qauthenticator_p.h>
 #include "private/qhostinfo_p.h"
+#include "http2/http2protocol_p.h"
 #include <qnetworkproxy.h>
 #include <qauthenticator.h>
 #include <qcoreapplication.h>
@@ -92,6 +93,9 @@ QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(const QString &host
   , networkProxy(QNetworkProxy::NoProxy)
 #endif
   , preConnectRequests(0)
+  , idleSequence(0)
+  , http2SessionReceiveWindowSize(Http2::qtDefaultSessionReceiveWindowSize)
+  , http2StreamReceiveWindowSize(Http2::qtDefaultStreamReceiveWindowSize)
   , connectionType(type)
 {
     // We allocate all 6 channels even if it's SPDY or HTTP/2 enabled
@@ -106,11 +110,19 @@ QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(quint16 connectionC
                                                              QHttpNetworkConnection::ConnectionType type)
 : state(RunningState), networkLayerState(Unknown),
   hostName(hostName), port(port), encrypt(encrypt), delayIpv4(true),
-  activeChannelCount(connectionCount), channelCount(connectionCount)
+  activeChannelCount(type == QHttpNetworkConnection::ConnectionTypeHTTP2
+#ifndef QT_NO_SSL
+                     || type == QHttpNetworkConnection::ConnectionTypeSPDY
+#endif
+                     ? 1 : connectionCount),
+  channelCount(connectionCount)
 #ifndef QT_NO_NETWORKPROXY
   , networkProxy(QNetworkProxy::NoProxy)
 #endif
   , preConnectRequests(0)
+  , idleSequence(0)
+  , http2SessionReceiveWindowSize(Http2::qtDefaultSessionReceiveWindowSize)
+  , http2StreamReceiveWindowSize(Http2::qtDefaultStreamReceiveWindowSize)
   , connectionType(type)
 {
     channels = new QHttpNetworkConnectionChannel[channelCount];
@@ -622,6 +634,7 @@ QHttpNetworkReply* QHttpNetworkConnectionPrivate::queueRequest(const QHttpNetwor
     reply->setRequest(request);
     reply->d_func()->connection = q;
     reply->d_func()->connectionChannel = &channels[0]; // will have the correct one set later
+    reply->d_func()->queueTimer.start();
     HttpMessagePair pair = qMakePair(request, reply);
 
     if (request.isPreConnect())
@@ -723,6 +736,18 @@ void QHttpNetworkConnectionPrivate::updateChannel(int i, const HttpMessagePair &
     // Now that reply is assigned a channel, correct reply to channel association
     // previously set in queueRequest.
     channels[i].reply->d_func()->connectionChannel = &channels[i];
+
+    QHttpConnectionPoolStatistics &statistics = channels[i].reply->d_func()->poolStatistics;
+    statistics.waitTime = channels[i].reply->d_func()->queueTimer.elapsed();
+    statistics.activeConnections = 0;
+    statistics.idleConnections = 0;
+    for (int j = 0; j < activeChannelCount; ++j) {
+        if (channels[j].reply || channels[j].isSocketBusy())
+            ++statistics.activeConnections;
+        else if (channels[j].socket && channels[j].socket->state() == QAbstractSocket::ConnectedState)
+            ++statistics.idleConnections;
+    }
+    statistics.queuedRequests = highPriorityQueue.size() + lowPriorityQueue.size();
 }
 
 QHttpNetworkRequest QHttpNetworkConnectionPrivate::predictNextRequest() const
@@ -967,7 +992,8 @@ void QHttpNetworkConnectionPrivate::removeReply(QHttpNetworkReply *reply)
         QMultiMap<int, HttpMessagePair>::iterator end = channels[i].spdyRequestsToSend.end();
         for (; it != end; ++it) {
             if (it.value().second == reply) {
-                channels[i].spdyRequestsToSend.remove(it.key());
+                // not remove(it.key()), which drops all requests of that priority
+                channels[i].spdyRequestsToSend.erase(it);
 
                 QMetaObject::invokeMethod(q, "_q_startNextRequest", Qt::QueuedConnection);
                 return;
@@ -1031,17 +1057,27 @@ void QHttpNetworkConnectionPrivate::_q_startNextRequest()
     switch (connectionType) {
     case QHttpNetworkConnection::ConnectionTypeHTTP: {
         // return fast if there is nothing to do
-        if (highPriorityQueue.isEmpty() && lowPriorityQueue.isEmpty())
+        if (highPriorityQueue.isEmpty() && lowPriorityQueue.isEmpty()) {
+            releaseUnusedBudget();
             return;
+        }
 
-        // try to get a free AND connected socket
-        for (int i = 0; i < activeChannelCount; ++i) {
-            if (channels[i].socket) {
-                if (!channels[i].reply && !channels[i].isSocketBusy() && channels[i].socket->state() == QAbstractSocket::ConnectedState) {
-                    if (dequeueRequest(channels[i].socket))
-                        channels[i].sendRequest();
+        // try to get a free AND connected socket, the one that became idle
+        // last first: it is the least likely to have been closed by the
+        // server, and its congestion window is the least likely to have
+        // shrunk back
+        for (int n = 0; n < activeChannelCount; ++n) {
+            int hottest = -1;
+            for (int i = 0; i < activeChannelCount; ++i) {
+                if (channels[i].socket && !channels[i].reply && !channels[i].isSocketBusy()
+                        && channels[i].socket->state() == QAbstractSocket::ConnectedState
+                        && (hottest == -1 || channels[i].idleSince > channels[hottest].idleSince)) {
+                    hottest = i;
                 }
             }
+            if (hottest == -1 || !dequeueRequest(channels[hottest].socket))
+                break;
+            channels[hottest].sendRequest();
         }
         break;
     }
@@ -1071,8 +1107,10 @@ void QHttpNetworkConnectionPrivate::_q_startNextRequest()
     // on the connected sockets
     //tryToFillPipeline(socket);
     // return fast if there is nothing to pipeline
-    if (highPriorityQueue.isEmpty() && lowPriorityQueue.isEmpty())
+    if (highPriorityQueue.isEmpty() && lowPriorityQueue.isEmpty()) {
+        releaseUnusedBudget();
         return;
+    }
     for (int i = 0; i < activeChannelCount; i++)
         if (channels[i].socket && channels[i].socket->state() == QAbstractSocket::ConnectedState)
             fillPipeline(channels[i].socket);
@@ -1106,6 +1144,13 @@ void QHttpNetworkConnectionPrivate::_q_startNextRequest()
         }
 
         if (connectChannel) {
+            // beyond the manager's limit, wait for a socket of another
+            // connection to be closed
+            if (budget && !channels[i].countedInBudget) {
+                if (!budget->tryAcquire(q_func()))
+                    break;
+                channels[i].countedInBudget = true;
+            }
             if (networkLayerState == IPv4)
                 channels[i].networkLayerPreference = QAbstractSocket::IPv4Protocol;
             else if (networkLayerState == IPv6)
@@ -1114,6 +1159,57 @@ void QHttpNetworkConnectionPrivate::_q_startNextRequest()
             neededOpenChannels--;
         }
     }
+    releaseUnusedBudget();
+}
+
+/*
+    Gives back to the budget what this connection holds, but doesn't use:
+    sockets that did not start to connect, and sockets that other
+    connections handed over. While other connections wait, an idle socket
+    is closed, too, unless requests are queued for it.
+*/
+void QHttpNetworkConnectionPrivate::releaseUnusedBudget()
+{
+    if (!budget)
+        return;
+
+    Q_Q(QHttpNetworkConnection);
+    for (int i = 0; i < activeChannelCount; ++i) {
+        QHttpNetworkConnectionChannel &channel = channels[i];
+        if (channel.countedInBudget && networkLayerState != HostLookupPending
+                && (!channel.socket || channel.socket->state() == QAbstractSocket::UnconnectedState)) {
+            channel.countedInBudget = false;
+            budget->release(q);
+        }
+    }
+    const bool queued = !highPriorityQueue.isEmpty() || !lowPriorityQueue.isEmpty();
+    budget->returnUnused(q, queued);
+    if (!queued)
+        _q_closeIdleChannel();
+}
+
+/*
+    Closes the connected HTTP/1 channel that has been idle the longest,
+    if another connection of the manager waits for a socket.
+*/
+void QHttpNetworkConnectionPrivate::_q_closeIdleChannel()
+{
+    if (!budget || !budget->hasWaiters() || connectionType != QHttpNetworkConnection::ConnectionTypeHTTP)
+        return;
+
+    int coldest = -1;
+    for (int i = 0; i < activeChannelCount; ++i) {
+        const QHttpNetworkConnectionChannel &channel = channels[i];
+        if (channel.socket && !channel.reply && !channel.isSocketBusy()
+                && channel.alreadyPipelinedRequests.isEmpty()
+                && channel.socket->state() == QAbstractSocket::ConnectedState
+                && (coldest == -1 || channel.idleSince < channels[coldest].idleSince)) {
+            coldest = i;
+        }
+    }
+    // the socket is given back to the budget once it is unconnected
+    if (coldest != -1)
+        channels[coldest].close();
 }
 
 
@@ -1335,6 +1431,13 @@ QHttpNetworkConnection::QHttpNetworkConnection(quint16 connectionCount, const QS
 
 QHttpNetworkConnection::~QHttpNetworkConnection()
 {
+    Q_D(QHttpNetworkConnection);
+    // QObject's destructor is too late: the budget may post events to us
+    // until we are removed from it
+    if (d->budget) {
+        d->budget->remove(this);
+        d->budget.clear();
+    }
 }
 
 QString QHttpNetworkConnection::hostName() const
@@ -1412,6 +1515,27 @@ void QHttpNetworkConnection::setConnectionType(ConnectionType type)
     d->connectionType = type;
 }
 
+void QHttpNetworkConnection::setHttp2ReceiveWindowSizes(qint32 sessionWindowSize,
+                                                        qint32 streamWindowSize)
+{
+    Q_D(QHttpNetworkConnection);
+    // The session window can only grow past its default size
+    d->http2SessionReceiveWindowSize = qBound<qint32>(Http2::defaultSessionWindowSize,
+                                                      sessionWindowSize, Http2::maxWindowSize);
+    d->http2StreamReceiveWindowSize = qBound<qint32>(1, streamWindowSize, Http2::maxWindowSize);
+}
+
+/*
+    Makes the connection count its sockets against \a budget, which is
+    shared with other connections. Must be called before the first request
+    is sent.
+*/
+void QHttpNetworkConnection::setConnectionBudget(const QSharedPointer<QHttpConnectionBudget> &budget)
+{
+    Q_D(QHttpNetworkConnection);
+    d->budget = budget;
+}
+
 // SSL support below
 #ifndef QT_NO_SSL
 void QHttpNetworkConnection::setSslConfiguration(const QSslConfiguration &config)
@@ -1476,6 +1600,110 @@ void QHttpNetworkConnection::preConnectFinished()
     d_func()->preConnectRequests--;
 }
 
+QHttpConnectionBudget::QHttpConnectionBudget(int maximum)
+    : max(maximum), count(0)
+{
+}
+
+int QHttpConnectionBudget::used() const
+{
+    QMutexLocker locker(&mutex);
+    return count;
+}
+
+/*
+    Takes a socket for \a connection, preferably one that was handed over to
+    it. If none is left, \a connection waits for the next socket that is
+    released, and the other connections are asked to close an idle one.
+*/
+bool QHttpConnectionBudget::tryAcquire(QHttpNetworkConnection *connection)
+{
+    QMutexLocker locker(&mutex);
+    const auto grant = granted.find(connection);
+    if (grant != granted.end()) {
+        if (--grant.value() == 0)
+            granted.erase(grant);
+        ++held[connection];
+        return true;
+    }
+    if (count < max) {
+        ++count;
+        ++held[connection];
+        return true;
+    }
+
+    if (!waiting.contains(connection)) {
+        waiting.append(connection);
+        waiterCount.store(waiting.size());
+        for (auto it = held.cbegin(); it != held.cend(); ++it) {
+            if (it.key() != connection)
+                QMetaObject::invokeMethod(it.key(), "_q_closeIdleChannel", Qt::QueuedConnection);
+        }
+    }
+    return false;
+}
+
+/*
+    Counts a socket that \a connection opened without asking first, such
+    as a reconnect. It may exceed the maximum.
+*/
+void QHttpConnectionBudget::acquire(QHttpNetworkConnection *connection)
+{
+    QMutexLocker locker(&mutex);
+    ++count;
+    ++held[connection];
+}
+
+void QHttpConnectionBudget::release(QHttpNetworkConnection *connection)
+{
+    QMutexLocker locker(&mutex);
+    const auto it = held.find(connection);
+    if (it == held.end())
+        return;
+    if (--it.value() == 0)
+        held.erase(it);
+    handOver();
+}
+
+/*
+    Gives back the sockets that were handed over to \a connection, but not
+    used. Unless \a keepWaiting is \c true, \a connection also stops waiting
+    for more.
+*/
+void QHttpConnectionBudget::returnUnused(QHttpNetworkConnection *connection, bool keepWaiting)
+{
+    QMutexLocker locker(&mutex);
+    if (!keepWaiting) {
+        waiting.removeAll(connection);
+        waiterCount.store(waiting.size());
+    }
+    for (int n = granted.take(connection); n > 0; --n)
+        handOver();
+}
+
+void QHttpConnectionBudget::remove(QHttpNetworkConnection *connection)
+{
+    QMutexLocker locker(&mutex);
+    waiting.removeAll(connection);
+    waiterCount.store(waiting.size());
+    for (int n = held.take(connection) + granted.take(connection); n > 0; --n)
+        handOver();
+}
+
+// Passes a released socket on to the connection that waited the longest.
+void QHttpConnectionBudget::handOver()
+{
+    // called with the mutex locked
+    if (count > max || waiting.isEmpty()) {
+        --count;
+        return;
+    }
+    QHttpNetworkConnection *next = waiting.takeFirst();
+    waiterCount.store(waiting.size());
+    ++granted[next];
+    QMetaObject::invokeMethod(next, "_q_startNextRequest", Qt::QueuedConnection);
+}
+
 #ifndef QT_NO_NETWORKPROXY
 // only called from QHttpNetworkConnectionChannel::_q_proxyAuthenticationRequired, not
 // from QHttpNetworkConnectionChannel::handleAuthenticationChallenge
@@ -63,6 +63,9 @@
 #include <qbuffer.h>
 #include <qtimer.h>
 #include <qsharedpointer.h>
+#include <qhash.h>
+#include <qmutex.h>
+#include <qvector.h>
 
 #include <private/qhttpnetworkheader_p.h>
 #include <private/qhttpnetworkrequest_p.h>
@@ -84,6 +87,7 @@ class QSslConfiguration;
 class QSslContext;
 #endif // !QT_NO_SSL
 
+class QHttpConnectionBudget;
 class QHttpNetworkConnectionPrivate;
 class Q_AUTOTEST_EXPORT QHttpNetworkConnection : public QObject
 {
@@ -138,6 +142,10 @@ public:
     ConnectionType connectionType();
     void setConnectionType(ConnectionType type);
 
+    void setHttp2ReceiveWindowSizes(qint32 sessionWindowSize, qint32 streamWindowSize);
+
+    void setConnectionBudget(const QSharedPointer<QHttpConnectionBudget> &budget);
+
 #ifndef QT_NO_SSL
     void setSslConfiguration(const QSslConfiguration &config);
     void ignoreSslErrors(int channel = -1);
@@ -162,6 +170,7 @@ private:
     Q_PRIVATE_SLOT(d_func(), void _q_startNextRequest())
     Q_PRIVATE_SLOT(d_func(), void _q_hostLookupFinished(QHostInfo))
     Q_PRIVATE_SLOT(d_func(), void _q_connectDelayedChannel())
+    Q_PRIVATE_SLOT(d_func(), void _q_closeIdleChannel())
 };
 
 
@@ -230,6 +239,9 @@ public:
 
     void _q_hostLookupFinished(const QHostInfo &info);
     void _q_connectDelayedChannel();
+    void _q_closeIdleChannel();
+
+    void releaseUnusedBudget();
 
     void createAuthorization(QAbstractSocket *socket, QHttpNetworkRequest &request);
 
@@ -269,9 +281,18 @@ public:
     QList<HttpMessagePair> lowPriorityQueue;
 
     int preConnectRequests;
+    // incremented each time a channel becomes idle, see QHttpNetworkConnectionChannel::idleSince
+    quint64 idleSequence;
+
+    // the receive windows QHttp2ProtocolHandler starts with
+    qint32 http2SessionReceiveWindowSize;
+    qint32 http2StreamReceiveWindowSize;
 
     QHttpNetworkConnection::ConnectionType connectionType;
 
+    // shared with the other connections of the QNetworkAccessManager
+    QSharedPointer<QHttpConnectionBudget> budget;
+
 #ifndef QT_NO_SSL
     QSharedPointer<QSslContext> sslContext;
 #endif
@@ -283,6 +304,36 @@ public:
     friend class QHttpNetworkConnectionChannel;
 };
 
+// Limits the number of sockets the connections of a QNetworkAccessManager
+// have open in total. The connections may live in different threads.
+class Q_AUTOTEST_EXPORT QHttpConnectionBudget
+{
+public:
+    explicit QHttpConnectionBudget(int maximum);
+
+    int maximum() const { return max; }
+    int used() const;
+    bool hasWaiters() const { return waiterCount.load() > 0; }
+
+    bool tryAcquire(QHttpNetworkConnection *connection);
+    void acquire(QHttpNetworkConnection *connection);
+    void release(QHttpNetworkConnection *connection);
+    void returnUnused(QHttpNetworkConnection *connection, bool keepWaiting);
+    void remove(QHttpNetworkConnection *connection);
+
+private:
+    Q_DISABLE_COPY(QHttpConnectionBudget)
+    void handOver();
+
+    mutable QMutex mutex;
+    const int max;
+    int count; // held and granted sockets
+    QHash<QHttpNetworkConnection *, int> held;
+    QHash<QHttpNetworkConnection *, int> granted;
+    QVector<QHttpNetworkConnection *> waiting;
+    QAtomicInt waiterCount;
+};
+
 
 
 QT_END_NAMESPACE
@@ -82,6 +82,8 @@ QHttpNetworkConnectionChannel::QHttpNetworkConnectionChannel()
     , lastStatus(0)
     , pendingEncrypt(false)
     , reconnectAttempts(reconnectAttemptsDefault)
+    , idleSince(0)
+    , countedInBudget(false)
     , authMethod(QAuthenticatorPrivate::None)
     , proxyAuthMethod(QAuthenticatorPrivate::None)
     , authenticationCredentialsSent(false)
@@ -144,6 +146,9 @@ void QHttpNetworkConnectionChannel::init()
     QObject::connect(socket, SIGNAL(error(QAbstractSocket::SocketError)),
                      this, SLOT(_q_error(QAbstractSocket::SocketError)),
                      Qt::DirectConnection);
+    QObject::connect(socket, SIGNAL(stateChanged(QAbstractSocket::SocketState)),
+                     this, SLOT(_q_stateChanged(QAbstractSocket::SocketState)),
+                     Qt::DirectConnection);
 
 
 #ifndef QT_NO_NETWORKPROXY
@@ -446,6 +451,7 @@ void QHttpNetworkConnectionChannel::allDone()
     // now the channel can be seen as free/idle again, all signal emissions for the reply have been done
     if (state != QHttpNetworkConnectionChannel::ClosingState)
         state = QHttpNetworkConnectionChannel::IdleState;
+    idleSince = ++connection->d_func()->idleSequence;
 
     // if it does not need to be sent again we can set it to 0
     // the previous code did not do that and we had problems with accidental re-sending of a
@@ -781,6 +787,25 @@ void QHttpNetworkConnectionChannel::_q_disconnected()
     pendingEncrypt = false;
 }
 
+void QHttpNetworkConnectionChannel::_q_stateChanged(QAbstractSocket::SocketState socketState)
+{
+    QHttpConnectionBudget *budget = connection->d_func()->budget.data();
+    if (!budget)
+        return;
+
+    // sockets are counted from the host lookup until they are unconnected
+    // again, however they were opened
+    if (socketState == QAbstractSocket::UnconnectedState) {
+        if (countedInBudget) {
+            countedInBudget = false;
+            budget->release(connection);
+        }
+    } else if (!countedInBudget) {
+        countedInBudget = true;
+        budget->acquire(connection);
+    }
+}
+
 
 void QHttpNetworkConnectionChannel::_q_connected()
 {
@@ -116,6 +116,8 @@ public:
     int lastStatus; // last status received on this channel
     bool pendingEncrypt; // for https (send after encrypted)
     int reconnectAttempts; // maximum 2 reconnection attempts
+    quint64 idleSince; // connection's idleSequence when this channel last became idle
+    bool countedInBudget; // the socket is counted in the connection's QHttpConnectionBudget
     QAuthenticatorPrivate::Method authMethod;
     QAuthenticatorPrivate::Method proxyAuthMethod;
     QAuthenticator authenticator;
@@ -197,6 +199,7 @@ public:
     void _q_disconnected(); // disconnected from host
     void _q_connected(); // start sending request
     void _q_error(QAbstractSocket::SocketError); // error from socket
+    void _q_stateChanged(QAbstractSocket::SocketState socketState); // account for the socket
 #ifndef QT_NO_NETWORKPROXY
     void _q_proxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator *auth); // from transparent proxy
 #endif
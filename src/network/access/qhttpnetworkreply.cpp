@@ -299,6 +299,11 @@ void QHttpNetworkReply::setSpdyWasUsed(bool spdy)
     d_func()->spdyUsed = spdy;
 }
 
+QHttpConnectionPoolStatistics QHttpNetworkReply::connectionPoolStatistics() const
+{
+    return d_func()->poolStatistics;
+}
+
 qint64 QHttpNetworkReply::removedContentLength() const
 {
     return d_func()->removedContentLength;
@@ -69,6 +69,7 @@ struct z_stream_s;
 #include <QtNetwork/qnetworkrequest.h>
 #include <QtNetwork/qnetworkreply.h>
 #include <qbuffer.h>
+#include <qelapsedtimer.h>
 
 #include <private/qobject_p.h>
 #include <private/qhttpnetworkheader_p.h>
@@ -84,6 +85,20 @@ class QHttpNetworkConnectionChannel;
 class QHttpNetworkRequest;
 class QHttpNetworkConnectionPrivate;
 class QHttpNetworkReplyPrivate;
+
+// state of the connection pool when the request was assigned a channel
+struct QHttpConnectionPoolStatistics
+{
+    QHttpConnectionPoolStatistics()
+        : waitTime(-1), activeConnections(-1), idleConnections(-1), queuedRequests(-1)
+    {}
+
+    qint64 waitTime; // milliseconds spent queued before a channel was free
+    int activeConnections;
+    int idleConnections;
+    int queuedRequests;
+};
+
 class Q_AUTOTEST_EXPORT QHttpNetworkReply : public QObject, public QHttpNetworkHeader
 {
     Q_OBJECT
@@ -139,6 +154,7 @@ public:
     bool isPipeliningUsed() const;
     bool isSpdyUsed() const;
     void setSpdyWasUsed(bool spdy);
+    QHttpConnectionPoolStatistics connectionPoolStatistics() const;
     qint64 removedContentLength() const;
 
     bool isRedirecting() const;
@@ -270,6 +286,9 @@ public:
     bool spdyUsed;
     bool downstreamLimited;
 
+    QElapsedTimer queueTimer; // started when the request is queued
+    QHttpConnectionPoolStatistics poolStatistics;
+
     char* userProvidedDownloadBuffer;
     QUrl redirectUrl;
 
@@ -45,10 +45,17 @@
 #include <QAuthenticator>
 #include <QEventLoop>
 #include <QCryptographicHash>
+#include <QSet>
+
+#include <algorithm>
 
 #include "private/qhttpnetworkreply_p.h"
 #include "private/qnetworkaccesscache_p.h"
 #include "private/qnoncontiguousbytedevice_p.h"
+#include "http2/http2protocol_p.h"
+#ifndef QT_NO_OPENSSL
+#include "private/qsslcontext_openssl_p.h"
+#endif
 
 #ifndef QT_NO_HTTP
 
@@ -182,21 +189,43 @@ class QNetworkAccessCachedHttpConnection: public QHttpNetworkConnection,
     // Q_OBJECT
 public:
 #ifdef QT_NO_BEARERMANAGEMENT
-    QNetworkAccessCachedHttpConnection(const QString &hostName, quint16 port, bool encrypt,
+    QNetworkAccessCachedHttpConnection(quint16 connectionCount, const QString &hostName,
+                                       quint16 port, bool encrypt,
                                        QHttpNetworkConnection::ConnectionType connectionType)
-        : QHttpNetworkConnection(hostName, port, encrypt, connectionType)
+        : QHttpNetworkConnection(connectionCount, hostName, port, encrypt, /*parent=*/0,
+                                 connectionType)
 #else
-    QNetworkAccessCachedHttpConnection(const QString &hostName, quint16 port, bool encrypt,
+    QNetworkAccessCachedHttpConnection(quint16 connectionCount, const QString &hostName,
+                                       quint16 port, bool encrypt,
                                        QHttpNetworkConnection::ConnectionType connectionType,
                                        QSharedPointer<QNetworkSession> networkSession)
-        : QHttpNetworkConnection(hostName, port, encrypt, connectionType, /*parent=*/0,
-                                 qMove(networkSession))
+        : QHttpNetworkConnection(connectionCount, hostName, port, encrypt, /*parent=*/0,
+                                 qMove(networkSession), connectionType)
 #endif
     {
         setExpires(true);
         setShareable(true);
     }
 
+    // Whether the manager with connectionCacheTag \a tag may send requests
+    // over this connection, which is shared between managers
+    bool isSharedWith(const QByteArray &tag)
+    {
+        if (!sslErrorsIgnoredBy.isEmpty() && !sslErrorsIgnoredBy.contains(tag))
+            return false;
+        // it may have fallen back to HTTP/1, which is not shared
+        return connectionType() == QHttpNetworkConnection::ConnectionTypeHTTP2
+            || createdBy == tag;
+    }
+
+    QByteArray createdBy;
+    QSet<QByteArray> sslErrorsIgnoredBy;
+
+    void setIdleTimeout(int seconds)
+    {
+        setExpiryTimeout(seconds);
+    }
+
     virtual void dispose() Q_DECL_OVERRIDE
     {
 #if 0  // sample code; do this right with the API
@@ -231,9 +260,14 @@ QHttpThreadDelegate::QHttpThreadDelegate(QObject *parent) :
     , downloadBufferMaximumSize(0)
     , readBufferMaxSize(0)
     , bytesEmitted(0)
-    , pendingDownloadData()
+    , downloadQueue()
     , pendingDownloadProgress()
     , synchronous(false)
+    , maximumConnectionsPerHost(QHttpNetworkConnectionPrivate::defaultHttpChannelCount)
+    , connectionIdleTimeout(120)
+    , http2SessionReceiveWindowSize(Http2::qtDefaultSessionReceiveWindowSize)
+    , http2StreamReceiveWindowSize(Http2::qtDefaultStreamReceiveWindowSize)
+    , shareHttp2Connection(false)
     , incomingStatusCode(0)
     , isPipeliningUsed(false)
     , isSpdyUsed(false)
@@ -321,17 +355,53 @@ void QHttpThreadDelegate::startRequest()
 #endif
         cacheKey = makeCacheKey(urlCopy, 0);
 
+    // connections with a different size can't be shared
+    if (maximumConnectionsPerHost != QHttpNetworkConnectionPrivate::defaultHttpChannelCount)
+        cacheKey += '#' + QByteArray::number(maximumConnectionsPerHost);
+    // nor connections that count against another limit of the manager
+    if (connectionBudget)
+        cacheKey += "#limit" + QByteArray::number(quintptr(connectionBudget.data()), 16);
+    if (connectionType == QHttpNetworkConnection::ConnectionTypeHTTP2
+        && (http2SessionReceiveWindowSize != Http2::qtDefaultSessionReceiveWindowSize
+            || http2StreamReceiveWindowSize != Http2::qtDefaultStreamReceiveWindowSize)) {
+        cacheKey += '#' + QByteArray::number(http2SessionReceiveWindowSize)
+                    + '/' + QByteArray::number(http2StreamReceiveWindowSize);
+    }
+    // HTTP/2 connections can be shared with other managers, but only with
+    // those that would have verified the server the same way
+    const QByteArray unsharedCacheKey = cacheKey + connectionCacheTag;
+    bool shared = shareHttp2Connection && connectionType == QHttpNetworkConnection::ConnectionTypeHTTP2;
+#ifndef QT_NO_SSL
+    if (shared && ssl) {
+#ifndef QT_NO_OPENSSL
+        cacheKey += "#ssl" + QSslContext::computeConfigurationDigest(*incomingSslConfiguration).toHex();
+#else
+        shared = false;
+#endif
+    }
+#endif
+    if (!shared)
+        cacheKey = unsharedCacheKey;
 
     // the http object is actually a QHttpNetworkConnection
     httpConnection = static_cast<QNetworkAccessCachedHttpConnection *>(connections.localData()->requestEntryNow(cacheKey));
+    if (httpConnection && shared && !httpConnection->isSharedWith(connectionCacheTag)) {
+        connections.localData()->releaseEntry(cacheKey);
+        shared = false;
+        cacheKey = unsharedCacheKey;
+        httpConnection = static_cast<QNetworkAccessCachedHttpConnection *>(connections.localData()->requestEntryNow(cacheKey));
+    }
+    shareHttp2Connection = shared;
     if (httpConnection == 0) {
         // no entry in cache; create an object
         // the http object is actually a QHttpNetworkConnection
 #ifdef QT_NO_BEARERMANAGEMENT
-        httpConnection = new QNetworkAccessCachedHttpConnection(urlCopy.host(), urlCopy.port(), ssl,
+        httpConnection = new QNetworkAccessCachedHttpConnection(maximumConnectionsPerHost,
+                                                                urlCopy.host(), urlCopy.port(), ssl,
                                                                 connectionType);
 #else
-        httpConnection = new QNetworkAccessCachedHttpConnection(urlCopy.host(), urlCopy.port(), ssl,
+        httpConnection = new QNetworkAccessCachedHttpConnection(maximumConnectionsPerHost,
+                                                                urlCopy.host(), urlCopy.port(), ssl,
                                                                 connectionType,
                                                                 networkSession);
 #endif
@@ -340,6 +410,10 @@ void QHttpThreadDelegate::startRequest()
         if (ssl)
             httpConnection->setSslConfiguration(*incomingSslConfiguration);
 #endif
+        httpConnection->setHttp2ReceiveWindowSizes(http2SessionReceiveWindowSize,
+                                                   http2StreamReceiveWindowSize);
+        httpConnection->setConnectionBudget(connectionBudget);
+        httpConnection->createdBy = connectionCacheTag;
 
 #ifndef QT_NO_NETWORKPROXY
         httpConnection->setTransparentProxy(transparentProxy);
@@ -361,6 +435,9 @@ void QHttpThreadDelegate::startRequest()
     }
 
 
+    // applies from the moment the last user releases the connection
+    httpConnection->setIdleTimeout(connectionIdleTimeout);
+
     // Send the request to the connection
     httpReply = httpConnection->sendRequest(httpRequest);
     httpReply->setParent(this);
@@ -452,6 +529,12 @@ void QHttpThreadDelegate::readBufferFreed(qint64 size)
     }
 }
 
+void QHttpThreadDelegate::queueDownloadData(const QByteArray &data)
+{
+    if (downloadQueue->enqueue(data))
+        emit downloadDataAvailable();
+}
+
 void QHttpThreadDelegate::readyReadSlot()
 {
     if (!httpReply)
@@ -468,13 +551,11 @@ void QHttpThreadDelegate::readyReadSlot()
                 if (httpReply->sizeNextBlock() > (readBufferMaxSize-bytesEmitted)) {
                     sizeEmitted = readBufferMaxSize-bytesEmitted;
                     bytesEmitted += sizeEmitted;
-                    pendingDownloadData->fetchAndAddRelease(1);
-                    emit downloadData(httpReply->read(sizeEmitted));
+                    queueDownloadData(httpReply->read(sizeEmitted));
                 } else {
                     sizeEmitted = httpReply->sizeNextBlock();
                     bytesEmitted += sizeEmitted;
-                    pendingDownloadData->fetchAndAddRelease(1);
-                    emit downloadData(httpReply->readAny());
+                    queueDownloadData(httpReply->readAny());
                 }
             }
         } else {
@@ -483,8 +564,7 @@ void QHttpThreadDelegate::readyReadSlot()
 
     } else {
         while (httpReply->readAnyAvailable()) {
-            pendingDownloadData->fetchAndAddRelease(1);
-            emit downloadData(httpReply->readAny());
+            queueDownloadData(httpReply->readAny());
         }
     }
 }
@@ -500,8 +580,7 @@ void QHttpThreadDelegate::finishedSlot()
 
     // If there is still some data left emit that now
     while (httpReply->readAnyAvailable()) {
-        pendingDownloadData->fetchAndAddRelease(1);
-        emit downloadData(httpReply->readAny());
+        queueDownloadData(httpReply->readAny());
     }
 
 #ifndef QT_NO_SSL
@@ -632,7 +711,10 @@ void QHttpThreadDelegate::headerChangedSlot()
     incomingContentLength = httpReply->contentLength();
     removedContentLength = httpReply->removedContentLength();
     isSpdyUsed = httpReply->isSpdyUsed();
+    poolStatistics = httpReply->connectionPoolStatistics();
 
+    emit connectionPoolStatistics(poolStatistics.waitTime, poolStatistics.activeConnections,
+                                  poolStatistics.idleConnections, poolStatistics.queuedRequests);
     emit downloadMetaData(incomingHeaders,
                           incomingStatusCode,
                           incomingReasonPhrase,
@@ -658,6 +740,7 @@ void QHttpThreadDelegate::synchronousHeaderChangedSlot()
     isPipeliningUsed = httpReply->isPipeliningUsed();
     isSpdyUsed = httpReply->isSpdyUsed();
     incomingContentLength = httpReply->contentLength();
+    poolStatistics = httpReply->connectionPoolStatistics();
 }
 
 
@@ -698,6 +781,27 @@ void QHttpThreadDelegate::sslErrorsSlot(const QList<QSslError> &errors)
     bool ignoreAll = false;
     QList<QSslError> specificErrors;
     emit sslErrors(errors, &ignoreAll, &specificErrors);
+
+    if (shareHttp2Connection) {
+        bool ignored = ignoreAll;
+        if (!ignored) {
+            ignored = std::all_of(errors.cbegin(), errors.cend(), [&specificErrors](const QSslError &error) {
+                return specificErrors.contains(error);
+            });
+        }
+        if (!ignored) {
+            // The other requests on the shared connection are asked as well,
+            // and another manager may go on despite the errors - without us
+            QHttpNetworkConnectionPrivate *connection = httpConnection->d_func();
+            connection->removeReply(httpReply);
+            finishedWithErrorSlot(QNetworkReply::SslHandshakeFailedError,
+                                  connection->errorDetail(QNetworkReply::SslHandshakeFailedError, 0));
+            return;
+        }
+        // nobody else gets a connection we accepted despite errors
+        httpConnection->sslErrorsIgnoredBy.insert(connectionCacheTag);
+    }
+
     if (ignoreAll)
         httpReply->ignoreSslErrors();
     if (!specificErrors.isEmpty())
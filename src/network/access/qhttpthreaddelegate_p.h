@@ -66,6 +66,7 @@
 #include <QScopedPointer>
 #include "private/qnoncontiguousbytedevice_p.h"
 #include "qnetworkaccessauthenticationmanager_p.h"
+#include "qbytedataqueue_p.h"
 
 #ifndef QT_NO_HTTP
 
@@ -94,8 +95,10 @@ public:
     qint64 downloadBufferMaximumSize;
     qint64 readBufferMaxSize;
     qint64 bytesEmitted;
+    // From backend, we queue the body data there and only emit
+    // downloadDataAvailable() when the backend has drained it before
+    QSharedPointer<QByteDataQueue> downloadQueue;
     // From backend, modified by us for signal compression
-    QSharedPointer<QAtomicInt> pendingDownloadData;
     QSharedPointer<QAtomicInt> pendingDownloadProgress;
 #ifndef QT_NO_NETWORKPROXY
     QNetworkProxy cacheProxy;
@@ -103,6 +106,16 @@ public:
 #endif
     QSharedPointer<QNetworkAccessAuthenticationManager> authenticationManager;
     bool synchronous;
+    int maximumConnectionsPerHost;
+    int connectionIdleTimeout;
+    QSharedPointer<QHttpConnectionBudget> connectionBudget;
+    qint32 http2SessionReceiveWindowSize;
+    qint32 http2StreamReceiveWindowSize;
+    // keeps connections of different managers apart in a shared thread
+    QByteArray connectionCacheTag;
+    // whether the request may use, and once started uses, an HTTP/2
+    // connection shared with other managers
+    bool shareHttp2Connection;
 
     // outgoing, Retrieved in the synchronous HTTP case
     QByteArray synchronousDownloadData;
@@ -113,6 +126,7 @@ public:
     bool isSpdyUsed;
     qint64 incomingContentLength;
     qint64 removedContentLength;
+    QHttpConnectionPoolStatistics poolStatistics;
     QNetworkReply::NetworkError incomingErrorCode;
     QString incomingErrorDetail;
 #ifndef QT_NO_BEARERMANAGEMENT
@@ -143,8 +157,10 @@ signals:
 #endif
     void downloadMetaData(const QList<QPair<QByteArray,QByteArray> > &, int, const QString &, bool,
                           QSharedPointer<char>, qint64, qint64, bool);
+    void connectionPoolStatistics(qint64 waitTime, int activeConnections,
+                                  int idleConnections, int queuedRequests);
     void downloadProgress(qint64, qint64);
-    void downloadData(const QByteArray &);
+    void downloadDataAvailable();
     void error(QNetworkReply::NetworkError, const QString &);
     void downloadFinished();
     void redirected(const QUrl &url, int httpStatus, int maxRedirectsRemainig);
@@ -181,6 +197,8 @@ protected slots:
 #endif
 
 protected:
+    void queueDownloadData(const QByteArray &data);
+
     // Cache for all the QHttpNetworkConnection objects.
     // This is per thread.
     static QThreadStorage<QNetworkAccessCache *> connections;
@@ -77,8 +77,9 @@ struct QNetworkAccessCache::Node
 };
 
 QNetworkAccessCache::CacheableObject::CacheableObject()
+    : expiryTimeout(ExpiryTime)
 {
-    // leave the members uninitialized
+    // leave the other members uninitialized
     // they must be initialized by the derived class's constructor
 }
 
@@ -101,6 +102,15 @@ void QNetworkAccessCache::CacheableObject::setShareable(bool enable)
     shareable = enable;
 }
 
+/*!
+    Sets the number of \a seconds an expiring object is kept in the cache
+    after its last user released it. The default is two minutes.
+*/
+void QNetworkAccessCache::CacheableObject::setExpiryTimeout(int seconds)
+{
+    expiryTimeout = seconds;
+}
+
 QNetworkAccessCache::QNetworkAccessCache()
     : oldest(0), newest(0)
 {
@@ -147,18 +157,24 @@ void QNetworkAccessCache::linkEntry(const QByteArray &key)
     Q_ASSERT(node->older == 0 && node->newer == 0);
     Q_ASSERT(node->useCount == 0);
 
-    if (newest) {
-        Q_ASSERT(newest->newer == 0);
-        newest->newer = node;
-        node->older = newest;
-    }
-    if (!oldest) {
-        // there are no entries, so this is the oldest one too
-        oldest = node;
-    }
+    node->timestamp = QDateTime::currentDateTimeUtc().addSecs(node->object->expiryTimeout);
+
+    // keep the list sorted by expiry time; objects usually share the same
+    // timeout, in which case the new node simply becomes the newest
+    Node *older = newest;
+    while (older && node->timestamp < older->timestamp)
+        older = older->older;
 
-    node->timestamp = QDateTime::currentDateTimeUtc().addSecs(ExpiryTime);
-    newest = node;
+    node->older = older;
+    node->newer = older ? older->newer : oldest;
+    if (node->newer)
+        node->newer->older = node;
+    else
+        newest = node;
+    if (older)
+        older->newer = node;
+    else
+        oldest = node;
 }
 
 /*!
@@ -68,12 +68,61 @@
 #include "qhttpmultipart_p.h"
 
 #include "qnetworkreplyhttpimpl_p.h"
+#include "qhttpnetworkconnection_p.h"
 
 #include "qthread.h"
+#include "qmutex.h"
 
 QT_BEGIN_NAMESPACE
 
 Q_GLOBAL_STATIC(QNetworkAccessFileBackendFactory, fileBackend)
+
+namespace {
+// The threads running the HTTP requests of the managers that share them.
+// Connections are cached per thread, so all requests to a host run in the
+// same thread. Threads are started when first needed.
+class SharedHttpThreads
+{
+public:
+    SharedHttpThreads()
+    {
+        bool ok = false;
+        const int count = qEnvironmentVariableIntValue("QT_NETWORK_HTTP_THREADS", &ok);
+        threads.resize(ok && count > 0 ? count : qBound(1, QThread::idealThreadCount(), 4));
+    }
+    ~SharedHttpThreads()
+    {
+        for (QThread *thread : qAsConst(threads)) {
+            if (thread)
+                thread->quit();
+        }
+        for (QThread *thread : qAsConst(threads)) {
+            // rather leak it than destroy it while running
+            if (thread && thread->wait(5000))
+                delete thread;
+        }
+    }
+
+    QThread *threadForHost(const QString &host)
+    {
+        const int index = int(qHash(host) % uint(threads.size()));
+        QMutexLocker locker(&mutex);
+        QThread *&thread = threads[index];
+        if (!thread) {
+            thread = new QThread;
+            thread->setObjectName(QStringLiteral("QNetworkAccessManager shared thread %1").arg(index));
+            thread->start();
+        }
+        return thread;
+    }
+
+private:
+    QMutex mutex;
+    QVector<QThread *> threads;
+};
+}
+
+Q_GLOBAL_STATIC(SharedHttpThreads, sharedHttpThreadPool)
 #ifndef QT_NO_FTP
 Q_GLOBAL_STATIC(QNetworkAccessFtpBackendFactory, ftpBackend)
 #endif // QT_NO_FTP
@@ -1115,6 +1164,25 @@ QSharedPointer<QNetworkSession> QNetworkAccessManagerPrivate::getNetworkSession(
 void QNetworkAccessManager::connectToHostEncrypted(const QString &hostName, quint16 port,
                                                    const QSslConfiguration &sslConfiguration)
 {
+    connectToHostEncrypted(hostName, port, sslConfiguration, 1);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Initiates \a connectionCount connections to the host given by \a hostName
+    at port \a port, using \a sslConfiguration, to warm up the connection pool
+    before a burst of requests. At most maximumConnectionsPerHost()
+    connections are opened, and at least one.
+
+    \sa connectToHost(), setMaximumConnectionsPerHost()
+*/
+void QNetworkAccessManager::connectToHostEncrypted(const QString &hostName, quint16 port,
+                                                   const QSslConfiguration &sslConfiguration,
+                                                   int connectionCount)
+{
+    Q_D(QNetworkAccessManager);
     QUrl url;
     url.setHost(hostName);
     url.setPort(port);
@@ -1129,7 +1197,10 @@ void QNetworkAccessManager::connectToHostEncrypted(const QString &hostName, quin
                 QSslConfiguration::NextProtocolSpdy3_0))
         request.setAttribute(QNetworkRequest::SpdyAllowedAttribute, true);
 
-    get(request);
+    // each preconnect request opens one more channel of the connection
+    connectionCount = qBound(1, connectionCount, d->maximumConnectionsPerHost);
+    for (int i = 0; i < connectionCount; ++i)
+        get(request);
 }
 #endif
 
@@ -1146,12 +1217,33 @@ void QNetworkAccessManager::connectToHostEncrypted(const QString &hostName, quin
 */
 void QNetworkAccessManager::connectToHost(const QString &hostName, quint16 port)
 {
+    connectToHost(hostName, port, 1);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Initiates \a connectionCount connections to the host given by \a hostName
+    at port \a port, to warm up the connection pool before a burst of
+    requests. At most maximumConnectionsPerHost() connections are opened,
+    and at least one.
+
+    \sa connectToHostEncrypted(), setMaximumConnectionsPerHost()
+*/
+void QNetworkAccessManager::connectToHost(const QString &hostName, quint16 port, int connectionCount)
+{
+    Q_D(QNetworkAccessManager);
     QUrl url;
     url.setHost(hostName);
     url.setPort(port);
     url.setScheme(QLatin1String("preconnect-http"));
     QNetworkRequest request(url);
-    get(request);
+
+    // each preconnect request opens one more channel of the connection
+    connectionCount = qBound(1, connectionCount, d->maximumConnectionsPerHost);
+    for (int i = 0; i < connectionCount; ++i)
+        get(request);
 }
 
 /*!
@@ -1193,6 +1285,273 @@ QNetworkRequest::RedirectPolicy QNetworkAccessManager::redirectPolicy() const
     return d->redirectPolicy;
 }
 
+/*!
+    \since 5.10
+
+    Sets the maximum number of HTTP/1 connections the manager opens in
+    parallel to a single host and port to \a count. Further requests to the
+    same host are queued until one of the connections becomes free; the
+    connection that became idle last is reused first. Values less than 1
+    are treated as 1.
+
+    The setting applies to connections opened after this call; connections
+    that are already open keep their previous limit until they expire. The
+    default is 6. HTTP/2 and SPDY multiplex all requests over a single
+    connection and are not affected.
+
+    \sa maximumConnectionsPerHost(), setConnectionIdleTimeout(),
+    QNetworkRequest::ConnectionWaitTimeAttribute
+*/
+void QNetworkAccessManager::setMaximumConnectionsPerHost(int count)
+{
+    Q_D(QNetworkAccessManager);
+    d->maximumConnectionsPerHost = qBound(1, count, 0xffff);
+}
+
+/*!
+    \since 5.10
+
+    Returns the maximum number of HTTP/1 connections opened in parallel to a
+    single host.
+
+    \sa setMaximumConnectionsPerHost()
+*/
+int QNetworkAccessManager::maximumConnectionsPerHost() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->maximumConnectionsPerHost;
+}
+
+/*!
+    \since 5.10
+
+    Sets the maximum number of connections the manager keeps open to all
+    hosts together to \a count. A request that needs another connection
+    beyond the limit waits until one is closed; while requests wait,
+    connections that are idle are closed early. A \a count of 0, the
+    default, means no limit.
+
+    Reconnects, for example after the server closed an idle connection,
+    are counted but never wait. The setting applies to connections opened
+    after this call.
+
+    \sa maximumConnections(), setMaximumConnectionsPerHost()
+*/
+void QNetworkAccessManager::setMaximumConnections(int count)
+{
+    Q_D(QNetworkAccessManager);
+    d->maximumConnections = qMax(0, count);
+#ifndef QT_NO_HTTP
+    if (d->maximumConnections > 0)
+        d->connectionBudget = QSharedPointer<QHttpConnectionBudget>::create(d->maximumConnections);
+    else
+        d->connectionBudget.clear();
+#endif
+}
+
+/*!
+    \since 5.10
+
+    Returns the maximum number of connections the manager keeps open to all
+    hosts together, or 0 if there is no limit.
+
+    \sa setMaximumConnections()
+*/
+int QNetworkAccessManager::maximumConnections() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->maximumConnections;
+}
+
+/*!
+    \since 5.10
+
+    Sets the number of \a seconds the connections to a host are kept open
+    after the last request to that host finished. Negative values are
+    treated as 0. The default is 120 seconds.
+
+    \sa connectionIdleTimeout(), setMaximumConnectionsPerHost()
+*/
+void QNetworkAccessManager::setConnectionIdleTimeout(int seconds)
+{
+    Q_D(QNetworkAccessManager);
+    d->connectionIdleTimeout = qMax(0, seconds);
+}
+
+/*!
+    \since 5.10
+
+    Returns the number of seconds idle connections are kept open.
+
+    \sa setConnectionIdleTimeout()
+*/
+int QNetworkAccessManager::connectionIdleTimeout() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->connectionIdleTimeout;
+}
+
+/*!
+    \since 5.10
+
+    Sets the HTTP/2 connection-level receive window to \a size bytes. This
+    is how much response data all streams of a connection together may have
+    in flight before the server has to wait for the client to catch up.
+    The default is 655350 bytes; values smaller than 65535 bytes, the
+    protocol's initial window size, are not possible and are raised to it.
+
+    The window starts at this size and grows, up to 16 MB, when the
+    bandwidth-delay product of the connection turns out to be larger.
+    Setting the environment variable \c QT_HTTP2_DISABLE_WINDOW_AUTOTUNING
+    to \c 1 keeps the windows at their configured sizes.
+
+    The setting applies to HTTP/2 connections opened after this call.
+
+    \sa http2SessionReceiveWindowSize(), setHttp2StreamReceiveWindowSize()
+*/
+void QNetworkAccessManager::setHttp2SessionReceiveWindowSize(int size)
+{
+    Q_D(QNetworkAccessManager);
+    d->http2SessionReceiveWindowSize = qMax<int>(Http2::defaultSessionWindowSize, size);
+}
+
+/*!
+    \since 5.10
+
+    Returns the initial HTTP/2 connection-level receive window size.
+
+    \sa setHttp2SessionReceiveWindowSize()
+*/
+int QNetworkAccessManager::http2SessionReceiveWindowSize() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->http2SessionReceiveWindowSize;
+}
+
+/*!
+    \since 5.10
+
+    Sets the HTTP/2 receive window of each stream to \a size bytes. This
+    limits how much data of a single response can be in flight. The default
+    is 65535 bytes, values smaller than 1 are raised to 1.
+
+    Like the connection-level window, stream windows start at this size and
+    grow with the measured bandwidth-delay product.
+
+    \sa http2StreamReceiveWindowSize(), setHttp2SessionReceiveWindowSize()
+*/
+void QNetworkAccessManager::setHttp2StreamReceiveWindowSize(int size)
+{
+    Q_D(QNetworkAccessManager);
+    d->http2StreamReceiveWindowSize = qMax(1, size);
+}
+
+/*!
+    \since 5.10
+
+    Returns the initial HTTP/2 receive window size of each stream.
+
+    \sa setHttp2StreamReceiveWindowSize()
+*/
+int QNetworkAccessManager::http2StreamReceiveWindowSize() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->http2StreamReceiveWindowSize;
+}
+
+/*!
+    \since 5.10
+
+    If \a enabled is \c true, requests of this manager that allow HTTP/2
+    (see QNetworkRequest::HTTP2AllowedAttribute) share their connections
+    with those of all other managers in the process that have this enabled.
+    Several managers talking to the same server then multiplex their
+    requests over one connection instead of opening one each. Only requests
+    with the same proxy, window sizes and SSL configuration share a
+    connection; the SSL configuration counts as the same if it trusts the
+    same certificates and presents the same local certificate.
+
+    Requests that do not allow HTTP/2 keep using connections of their own
+    manager, and so do connections on which the server chose HTTP/1.1. A
+    connection that a manager accepted despite SSL errors is not shared
+    any further; requests of other managers that were waiting for it fail
+    with QNetworkReply::SslHandshakeFailedError unless their manager
+    ignores the errors too. With the SecureTransport and WinRT backends,
+    encrypted connections are not shared at all.
+
+    Authentication state of a shared connection is shared as well, so this
+    should only be enabled for managers that trust each other.
+    clearConnectionCache() does not close shared connections.
+
+    Managers sharing connections run their HTTP requests in the threads
+    described in setSharedHttpThreadsEnabled().
+
+    The setting applies to requests sent after this call. The default is
+    \c false.
+
+    \sa isHttp2ConnectionSharingEnabled()
+*/
+void QNetworkAccessManager::setHttp2ConnectionSharingEnabled(bool enabled)
+{
+    Q_D(QNetworkAccessManager);
+    d->http2ConnectionSharing = enabled;
+}
+
+/*!
+    \since 5.10
+
+    Returns \c true if this manager shares its HTTP/2 connections with
+    other managers.
+
+    \sa setHttp2ConnectionSharingEnabled()
+*/
+bool QNetworkAccessManager::isHttp2ConnectionSharingEnabled() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->http2ConnectionSharing;
+}
+
+/*!
+    \since 5.10
+
+    If \a enabled is \c true, this manager runs its HTTP requests in a
+    pool of threads shared by all managers that have this enabled, instead
+    of starting a thread of its own. Applications using many managers then
+    need far fewer threads. The pool has one thread per processor core, but
+    at most 4; the environment variable \c QT_NETWORK_HTTP_THREADS can be
+    used to choose another number. All requests to a host run in the same
+    thread of the pool.
+
+    Managers sharing threads do not share their connections, unless they
+    have HTTP/2 connection sharing enabled. clearConnectionCache() does not
+    close the connections of a manager using shared threads; they are
+    closed once they have been idle for connectionIdleTimeout() seconds.
+
+    The setting applies to requests sent after this call. The default is
+    \c false.
+
+    \sa isSharedHttpThreadsEnabled(), setHttp2ConnectionSharingEnabled()
+*/
+void QNetworkAccessManager::setSharedHttpThreadsEnabled(bool enabled)
+{
+    Q_D(QNetworkAccessManager);
+    d->sharedHttpThreads = enabled;
+}
+
+/*!
+    \since 5.10
+
+    Returns \c true if this manager runs its HTTP requests in threads
+    shared with other managers.
+
+    \sa setSharedHttpThreadsEnabled()
+*/
+bool QNetworkAccessManager::isSharedHttpThreadsEnabled() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->sharedHttpThreads;
+}
+
 /*!
     \since 4.7
 
@@ -1719,6 +2078,25 @@ void QNetworkAccessManagerPrivate::clearConnectionCache(QNetworkAccessManager *m
     manager->d_func()->destroyThread();
 }
 
+/*
+    Returns the thread \a manager started for its own requests, or 0 if it
+    did not start one.
+*/
+QThread *QNetworkAccessManagerPrivate::ownHttpThread(QNetworkAccessManager *manager)
+{
+    return manager->d_func()->thread;
+}
+
+/*
+    Returns the shared thread the requests to \a host run in.
+*/
+QThread *QNetworkAccessManagerPrivate::sharedHttpThread(const QString &host)
+{
+    if (sharedHttpThreadPool.isDestroyed())
+        return nullptr;
+    return sharedHttpThreadPool()->threadForHost(host);
+}
+
 QNetworkAccessManagerPrivate::~QNetworkAccessManagerPrivate()
 {
     destroyThread();
@@ -1735,6 +2113,30 @@ QThread * QNetworkAccessManagerPrivate::createThread()
     return thread;
 }
 
+/*
+    Returns the thread to run an HTTP request to \a url in.
+*/
+QThread *QNetworkAccessManagerPrivate::httpThread(const QUrl &url)
+{
+    // Connections are cached per thread, so managers sharing them have
+    // to run their requests in the same thread
+    if (usesSharedHttpThreads() && !sharedHttpThreadPool.isDestroyed())
+        return sharedHttpThreadPool()->threadForHost(url.host());
+    return createThread();
+}
+
+/*
+    Returns what to append to the cache key of the connections this manager
+    must not share with other managers running in the same thread.
+*/
+QByteArray QNetworkAccessManagerPrivate::connectionCacheTag()
+{
+    static QBasicAtomicInt nextClientId = Q_BASIC_ATOMIC_INITIALIZER(1);
+    if (!sharedThreadClientId)
+        sharedThreadClientId = nextClientId.fetchAndAddRelaxed(1);
+    return '@' + QByteArray::number(sharedThreadClientId);
+}
+
 void QNetworkAccessManagerPrivate::destroyThread()
 {
     if (thread) {
@@ -152,12 +152,35 @@ public:
 #ifndef QT_NO_SSL
     void connectToHostEncrypted(const QString &hostName, quint16 port = 443,
                                 const QSslConfiguration &sslConfiguration = QSslConfiguration::defaultConfiguration());
+    void connectToHostEncrypted(const QString &hostName, quint16 port,
+                                const QSslConfiguration &sslConfiguration, int connectionCount);
 #endif
     void connectToHost(const QString &hostName, quint16 port = 80);
+    void connectToHost(const QString &hostName, quint16 port, int connectionCount);
 
     void setRedirectPolicy(QNetworkRequest::RedirectPolicy policy);
     QNetworkRequest::RedirectPolicy redirectPolicy() const;
 
+    void setMaximumConnectionsPerHost(int count);
+    int maximumConnectionsPerHost() const;
+
+    void setMaximumConnections(int count);
+    int maximumConnections() const;
+
+    void setConnectionIdleTimeout(int seconds);
+    int connectionIdleTimeout() const;
+
+    void setHttp2SessionReceiveWindowSize(int size);
+    int http2SessionReceiveWindowSize() const;
+    void setHttp2StreamReceiveWindowSize(int size);
+    int http2StreamReceiveWindowSize() const;
+
+    void setHttp2ConnectionSharingEnabled(bool enabled);
+    bool isHttp2ConnectionSharingEnabled() const;
+
+    void setSharedHttpThreadsEnabled(bool enabled);
+    bool isSharedHttpThreadsEnabled() const;
+
 Q_SIGNALS:
 #ifndef QT_NO_NETWORKPROXY
     void proxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator *authenticator);
@@ -61,6 +61,7 @@
 #include "QtNetwork/qnetworkproxy.h"
 #include "QtNetwork/qnetworksession.h"
 #include "qnetworkaccessauthenticationmanager_p.h"
+#include "http2/http2protocol_p.h"
 #ifndef QT_NO_BEARERMANAGEMENT
 #include "QtNetwork/qnetworkconfigmanager.h"
 #endif
@@ -69,6 +70,7 @@ QT_BEGIN_NAMESPACE
 
 class QAuthenticator;
 class QAbstractNetworkCache;
+class QHttpConnectionBudget;
 class QNetworkAuthenticationCredential;
 class QNetworkCookieJar;
 
@@ -113,6 +115,9 @@ public:
 
     QThread * createThread();
     void destroyThread();
+    QThread *httpThread(const QUrl &url);
+    bool usesSharedHttpThreads() const { return sharedHttpThreads || http2ConnectionSharing; }
+    QByteArray connectionCacheTag();
 
     void _q_replyFinished();
     void _q_replyEncrypted();
@@ -209,10 +214,25 @@ public:
 
     Q_AUTOTEST_EXPORT static void clearAuthenticationCache(QNetworkAccessManager *manager);
     Q_AUTOTEST_EXPORT static void clearConnectionCache(QNetworkAccessManager *manager);
+    Q_AUTOTEST_EXPORT static QThread *ownHttpThread(QNetworkAccessManager *manager);
+    Q_AUTOTEST_EXPORT static QThread *sharedHttpThread(const QString &host);
 
     QHstsCache stsCache;
     bool stsEnabled = false;
 
+    int maximumConnectionsPerHost = 6;
+    int connectionIdleTimeout = 120;
+    int maximumConnections = 0;
+    QSharedPointer<QHttpConnectionBudget> connectionBudget; // null without a maximum
+
+    int http2SessionReceiveWindowSize = Http2::qtDefaultSessionReceiveWindowSize;
+    int http2StreamReceiveWindowSize = Http2::qtDefaultStreamReceiveWindowSize;
+    bool http2ConnectionSharing = false;
+    bool sharedHttpThreads = false;
+    // tells this manager's connections apart from those of other managers
+    // in the shared threads, see connectionCacheTag()
+    int sharedThreadClientId = 0;
+
 #ifndef QT_NO_BEARERMANAGEMENT
     Q_AUTOTEST_EXPORT static const QWeakPointer<const QNetworkSession> getNetworkSession(const QNetworkAccessManager *manager);
 #endif
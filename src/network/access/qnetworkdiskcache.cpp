@@ -49,6 +49,9 @@
 #include <qdatastream.h>
 #include <qdatetime.h>
 #include <qdiriterator.h>
+#include <qrunnable.h>
+#include <qsavefile.h>
+#include <qthreadpool.h>
 #include <qurl.h>
 #include <qcryptographichash.h>
 #include <qdebug.h>
@@ -57,8 +60,11 @@
 #define PREPARED_SLASH QLatin1String("prepared/")
 #define CACHE_VERSION 8
 #define DATA_DIR QLatin1String("data")
+#define INDEX_FILE QLatin1String("index")
 
 #define MAX_COMPRESSION_SIZE (1024 * 1024 * 3)
+// expire() leaves anything beyond this to a worker thread
+#define MAX_SYNCHRONOUS_REMOVALS 16
 
 #ifndef QT_NO_NETWORKDISKCACHE
 
@@ -76,6 +82,13 @@ QT_BEGIN_NAMESPACE
     are compressed using qCompress.  Data is written to disk only in insert()
     and updateMetaData().
 
+    The files are spread over subdirectories, and an index of them is kept
+    in memory, so that neither lookups of urls that are not cached nor
+    expire() need to touch the file system. The index is saved to the
+    cacheDirectory when the cache is destroyed, and read back by the next
+    QNetworkDiskCache using that directory; without it, the directory is
+    scanned once.
+
     Currently you cannot share the same cache files with more than
     one disk cache.
 
@@ -115,6 +128,7 @@ QNetworkDiskCache::~QNetworkDiskCache()
 {
     Q_D(QNetworkDiskCache);
     qDeleteAll(d->inserting);
+    d->saveIndex();
 }
 
 /*!
@@ -144,11 +158,15 @@ void QNetworkDiskCache::setCacheDirectory(const QString &cacheDir)
     Q_D(QNetworkDiskCache);
     if (cacheDir.isEmpty())
         return;
-    d->cacheDirectory = cacheDir;
-    QDir dir(d->cacheDirectory);
-    d->cacheDirectory = dir.absolutePath();
-    if (!d->cacheDirectory.endsWith(QLatin1Char('/')))
-        d->cacheDirectory += QLatin1Char('/');
+    QString newDirectory = QDir(cacheDir).absolutePath();
+    if (!newDirectory.endsWith(QLatin1Char('/')))
+        newDirectory += QLatin1Char('/');
+    if (newDirectory != d->cacheDirectory && d->indexLoaded) {
+        d->saveIndex();
+        d->resetIndex();
+        d->currentCacheSize = -1;
+    }
+    d->cacheDirectory = newDirectory;
 
     d->dataDirectory = d->cacheDirectory + DATA_DIR + QString::number(CACHE_VERSION) + QLatin1Char('/');
     d->prepareLayout();
@@ -272,16 +290,20 @@ void QNetworkDiskCachePrivate::storeItem(QCacheItem *cacheItem)
     QString fileName = cacheFileName(cacheItem->metaData.url());
     Q_ASSERT(!fileName.isEmpty());
 
+    loadIndex();
+    cancelRemoval(fileName);
     if (QFile::exists(fileName)) {
-        if (!QFile::remove(fileName)) {
+        if (!removeFile(fileName)) {
             qWarning() << "QNetworkDiskCache: couldn't remove the cache file " << fileName;
             return;
         }
     }
 
+    reservedSize = 1024 + cacheItem->size();
     if (currentCacheSize > 0)
-        currentCacheSize += 1024 + cacheItem->size();
+        currentCacheSize += reservedSize;
     currentCacheSize = q->expire();
+    reservedSize = 0;
     if (!cacheItem->file) {
         QString templateName = tmpCacheFileName();
         cacheItem->file = new QTemporaryFile(templateName, &cacheItem->data);
@@ -296,10 +318,12 @@ void QNetworkDiskCachePrivate::storeItem(QCacheItem *cacheItem)
         && cacheItem->file->error() == QFile::NoError) {
         cacheItem->file->setAutoRemove(false);
         // ### use atomic rename rather then remove & rename
-        if (cacheItem->file->rename(fileName))
+        if (cacheItem->file->rename(fileName)) {
             currentCacheSize += cacheItem->file->size();
-        else
+            addToIndex(indexKey(fileName), cacheItem->file->size());
+        } else {
             cacheItem->file->setAutoRemove(true);
+        }
     }
     if (cacheItem->metaData.url() == lastItem.metaData.url())
         lastItem.reset();
@@ -344,9 +368,11 @@ bool QNetworkDiskCachePrivate::removeFile(const QString &file)
     QString fileName = info.fileName();
     if (!fileName.endsWith(CACHE_POSTFIX))
         return false;
+    cancelRemoval(file);
     qint64 size = info.size();
     if (QFile::remove(file)) {
         currentCacheSize -= size;
+        removeFromIndex(indexKey(file));
         return true;
     }
     return false;
@@ -363,7 +389,10 @@ QNetworkCacheMetaData QNetworkDiskCache::metaData(const QUrl &url)
     Q_D(QNetworkDiskCache);
     if (d->lastItem.metaData.url() == url)
         return d->lastItem.metaData;
-    return fileMetaData(d->cacheFileName(url));
+    const QString fileName = d->cacheFileName(url);
+    if (!d->isIndexed(fileName))
+        return QNetworkCacheMetaData();
+    return fileMetaData(fileName);
 }
 
 /*!
@@ -403,10 +432,15 @@ QIODevice *QNetworkDiskCache::data(const QUrl &url)
     if (d->lastItem.metaData.url() == url && d->lastItem.data.isOpen()) {
         buffer.reset(new QBuffer);
         buffer->setData(d->lastItem.data.data());
+        d->touch(d->cacheFileName(url));
     } else {
-        QScopedPointer<QFile> file(new QFile(d->cacheFileName(url)));
+        const QString fileName = d->cacheFileName(url);
+        if (!d->isIndexed(fileName))
+            return 0;
+        QScopedPointer<QFile> file(new QFile(fileName));
         if (!file->open(QFile::ReadOnly | QIODevice::Unbuffered))
             return 0;
+        d->touch(fileName);
 
         if (!d->lastItem.read(file.data(), true)) {
             file->close();
@@ -502,9 +536,10 @@ void QNetworkDiskCache::setMaximumCacheSize(qint64 size)
     Returns the current size of the cache.
 
     When the current size of the cache is greater than the maximumCacheSize()
-    older cache files are removed until the total size is less then 90% of
-    maximumCacheSize() starting with the oldest ones first using the file
-    creation date to determine how old a cache file is.
+    cache files are removed until the total size is less then 90% of
+    maximumCacheSize(), starting with the least recently used ones. Only
+    the in-memory index of the cache is consulted; when many files have to
+    go, they are removed from the disk by a worker thread.
 
     Subclasses can reimplement this function to change the order that cache
     files are removed taking into account information in the application
@@ -519,7 +554,7 @@ qint64 QNetworkDiskCache::expire()
 {
     Q_D(QNetworkDiskCache);
     if (d->currentCacheSize >= 0 && d->currentCacheSize < maximumCacheSize())
-        return d->currentCacheSize;
+        return d->indexLoaded ? d->indexedSize : d->currentCacheSize;
 
     if (cacheDirectory().isEmpty()) {
         qWarning("QNetworkDiskCache::expire() The cache directory is not set");
@@ -529,54 +564,25 @@ qint64 QNetworkDiskCache::expire()
     // close file handle to prevent "in use" error when QFile::remove() is called
     d->lastItem.reset();
 
-    QDir::Filters filters = QDir::AllDirs | QDir:: Files | QDir::NoDotAndDotDot;
-    QDirIterator it(cacheDirectory(), filters, QDirIterator::Subdirectories);
-
-    QMultiMap<QDateTime, QString> cacheItems;
-    qint64 totalSize = 0;
-    while (it.hasNext()) {
-        QString path = it.next();
-        QFileInfo info = it.fileInfo();
-        QString fileName = info.fileName();
-        if (fileName.endsWith(CACHE_POSTFIX)) {
-            cacheItems.insert(info.created(), path);
-            totalSize += info.size();
-        }
-    }
+    d->loadIndex();
 
-    int removedFiles = 0;
+    QStringList removedFiles;
     qint64 goal = (maximumCacheSize() * 9) / 10;
-    QMultiMap<QDateTime, QString>::const_iterator i = cacheItems.constBegin();
-    while (i != cacheItems.constEnd()) {
-        if (totalSize < goal)
-            break;
-        QString name = i.value();
-        QFile file(name);
-
-        if (name.contains(PREPARED_SLASH)) {
-            for (QCacheItem *item : qAsConst(d->inserting)) {
-                if (item && item->file && item->file->fileName() == name) {
-                    delete item->file;
-                    item->file = 0;
-                    break;
-                }
-            }
-        }
-
-        qint64 size = file.size();
-        file.remove();
-        totalSize -= size;
-        ++removedFiles;
-        ++i;
+    while (d->indexedSize + d->reservedSize >= goal && !d->lruOrder.isEmpty()) {
+        const QString key = d->lruOrder.first();
+        d->removeFromIndex(key);
+        removedFiles.append(d->cacheDirectory + key);
     }
+    // clear() must not return before the files are gone
+    d->removeFiles(removedFiles, maximumCacheSize() == 0);
 #if defined(QNETWORKDISKCACHE_DEBUG)
-    if (removedFiles > 0) {
+    if (!removedFiles.isEmpty()) {
         qDebug() << "QNetworkDiskCache::expire()"
-                << "Removed:" << removedFiles
-                << "Kept:" << cacheItems.count() - removedFiles;
+                << "Removed:" << removedFiles.count()
+                << "Kept:" << d->index.count();
     }
 #endif
-    return totalSize;
+    return d->indexedSize;
 }
 
 /*!
@@ -633,6 +639,250 @@ QString QNetworkDiskCachePrivate::cacheFileName(const QUrl &url) const
     return  fullpath;
 }
 
+namespace {
+class QCacheFileRemover : public QRunnable
+{
+public:
+    QCacheFileRemover(const QSharedPointer<QCacheFileRemovals> &removals, const QStringList &files)
+        : removals(removals), files(files)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        for (const QString &file : qAsConst(files)) {
+            // under the lock, so that storeItem() can take a file back
+            QMutexLocker locker(&removals->mutex);
+            if (removals->files.remove(file))
+                QFile::remove(file);
+        }
+    }
+
+private:
+    QSharedPointer<QCacheFileRemovals> removals;
+    QStringList files;
+};
+
+// One thread for all caches; removing files is about the disk, not the CPU
+class QCacheFileRemovalPool : public QThreadPool
+{
+public:
+    QCacheFileRemovalPool() { setMaxThreadCount(1); }
+};
+}
+
+Q_GLOBAL_STATIC(QCacheFileRemovalPool, cacheFileRemovalPool)
+
+enum
+{
+    IndexMagic = 0xe9
+};
+
+/*!
+    Returns the key of \a fileName in the index: its path relative to the
+    cache directory, or an empty string if it is not inside of it.
+ */
+QString QNetworkDiskCachePrivate::indexKey(const QString &fileName) const
+{
+    if (cacheDirectory.isEmpty() || !fileName.startsWith(cacheDirectory))
+        return QString();
+    return fileName.mid(cacheDirectory.length());
+}
+
+/*!
+    Fills the index from the file saved by the last cache using this
+    directory, or else by walking the directory.
+ */
+void QNetworkDiskCachePrivate::loadIndex()
+{
+    if (indexLoaded || cacheDirectory.isEmpty())
+        return;
+    indexLoaded = true;
+    if (!readIndexFile())
+        scanCacheDirectory();
+    // from now on only the index in memory is up to date
+    QFile::remove(cacheDirectory + INDEX_FILE);
+}
+
+bool QNetworkDiskCachePrivate::readIndexFile()
+{
+    QFile file(cacheDirectory + INDEX_FILE);
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    qint32 marker, version;
+    quint32 count;
+    in >> marker >> version >> count;
+    if (marker != IndexMagic || version != CACHE_VERSION)
+        return false;
+
+    // least recently used first
+    QString key;
+    qint64 size;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        in >> key >> size;
+        if (key.endsWith(CACHE_POSTFIX) && !key.contains(QLatin1String("..")))
+            addToIndex(key, size);
+    }
+    if (in.status() != QDataStream::Ok) {
+        resetIndex();
+        return false;
+    }
+    return true;
+}
+
+void QNetworkDiskCachePrivate::scanCacheDirectory()
+{
+    QDir::Filters filters = QDir::AllDirs | QDir:: Files | QDir::NoDotAndDotDot;
+    QDirIterator it(cacheDirectory, filters, QDirIterator::Subdirectories);
+
+    QMultiMap<QDateTime, QString> cacheItems;
+    QHash<QString, qint64> sizes;
+    while (it.hasNext()) {
+        QString path = it.next();
+        QFileInfo info = it.fileInfo();
+        QString fileName = info.fileName();
+        if (fileName.endsWith(CACHE_POSTFIX)) {
+            // left behind by an earlier process, unless prepare() made it
+            if (path.contains(PREPARED_SLASH)) {
+                bool inUse = false;
+                for (QCacheItem *item : qAsConst(inserting)) {
+                    if (item && item->file && item->file->fileName() == path) {
+                        inUse = true;
+                        break;
+                    }
+                }
+                if (!inUse)
+                    QFile::remove(path);
+                continue;
+            }
+            const QString key = indexKey(path);
+            cacheItems.insert(info.created(), key);
+            sizes.insert(key, info.size());
+        }
+    }
+    for (auto i = cacheItems.cbegin(), end = cacheItems.cend(); i != end; ++i)
+        addToIndex(i.value(), sizes.value(i.value()));
+}
+
+/*!
+    Writes the index to the cache directory, for the next cache to use it.
+ */
+void QNetworkDiskCachePrivate::saveIndex()
+{
+    if (!indexLoaded)
+        return;
+    if (index.isEmpty()) {
+        QFile::remove(cacheDirectory + INDEX_FILE);
+        return;
+    }
+
+    QSaveFile file(cacheDirectory + INDEX_FILE);
+    if (!file.open(QFile::WriteOnly))
+        return;
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << qint32(IndexMagic) << qint32(CACHE_VERSION) << quint32(index.count());
+    for (const QString &key : qAsConst(lruOrder))
+        out << key << index.value(key).size;
+    file.commit();
+}
+
+void QNetworkDiskCachePrivate::resetIndex()
+{
+    indexLoaded = false;
+    index.clear();
+    lruOrder.clear();
+    indexedSize = 0;
+}
+
+void QNetworkDiskCachePrivate::addToIndex(const QString &key, qint64 size)
+{
+    if (key.isEmpty())
+        return;
+    removeFromIndex(key);
+    IndexEntry entry;
+    entry.size = size;
+    entry.sequence = nextSequence++;
+    index.insert(key, entry);
+    lruOrder.insert(entry.sequence, key);
+    indexedSize += size;
+}
+
+void QNetworkDiskCachePrivate::removeFromIndex(const QString &key)
+{
+    const auto it = index.find(key);
+    if (it == index.end())
+        return;
+    indexedSize -= it->size;
+    lruOrder.remove(it->sequence);
+    index.erase(it);
+}
+
+/*!
+    Marks \a fileName as the most recently used cache file.
+ */
+void QNetworkDiskCachePrivate::touch(const QString &fileName)
+{
+    const auto it = index.find(indexKey(fileName));
+    if (it == index.end())
+        return;
+    lruOrder.remove(it->sequence);
+    it->sequence = nextSequence++;
+    lruOrder.insert(it->sequence, it.key());
+}
+
+/*!
+    Returns whether \a fileName may hold a cache item, without going to
+    the file system.
+ */
+bool QNetworkDiskCachePrivate::isIndexed(const QString &fileName) const
+{
+    if (cacheDirectory.isEmpty())
+        return false;
+    const_cast<QNetworkDiskCachePrivate *>(this)->loadIndex();
+    return index.contains(indexKey(fileName));
+}
+
+/*!
+    Removes \a files, in a worker thread if there are many of them, unless
+    \a synchronous is true. In that case, the files still waiting for the
+    worker thread are removed as well.
+ */
+void QNetworkDiskCachePrivate::removeFiles(const QStringList &files, bool synchronous)
+{
+    if (synchronous) {
+        QMutexLocker locker(&removals->mutex);
+        for (const QString &file : qAsConst(removals->files))
+            QFile::remove(file);
+        removals->files.clear();
+    }
+
+    if (synchronous || files.count() <= MAX_SYNCHRONOUS_REMOVALS) {
+        for (const QString &file : files)
+            QFile::remove(file);
+        return;
+    }
+
+    {
+        QMutexLocker locker(&removals->mutex);
+        for (const QString &file : files)
+            removals->files.insert(file);
+    }
+    cacheFileRemovalPool()->start(new QCacheFileRemover(removals, files));
+}
+
+/*!
+    Makes sure the worker thread leaves \a file alone, because we are about
+    to remove or replace it ourselves.
+ */
+void QNetworkDiskCachePrivate::cancelRemoval(const QString &file)
+{
+    QMutexLocker locker(&removals->mutex);
+    removals->files.remove(file);
+}
+
 /*!
     We compress small text and JavaScript files.
  */
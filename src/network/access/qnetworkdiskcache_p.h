@@ -56,6 +56,10 @@
 
 #include <qbuffer.h>
 #include <qhash.h>
+#include <qmap.h>
+#include <qmutex.h>
+#include <qset.h>
+#include <qsharedpointer.h>
 #include <qtemporaryfile.h>
 
 #ifndef QT_NO_NETWORKDISKCACHE
@@ -94,6 +98,14 @@ public:
     bool canCompress() const;
 };
 
+// Cache files evicted by expire() and waiting for a worker thread to
+// remove them. Shared with the worker, which may outlive the cache.
+struct QCacheFileRemovals
+{
+    QMutex mutex;
+    QSet<QString> files;
+};
+
 class QNetworkDiskCachePrivate : public QAbstractNetworkCachePrivate
 {
 public:
@@ -101,8 +113,19 @@ public:
         : QAbstractNetworkCachePrivate()
         , maximumCacheSize(1024 * 1024 * 50)
         , currentCacheSize(-1)
+        , indexLoaded(false)
+        , indexedSize(0)
+        , reservedSize(0)
+        , nextSequence(0)
+        , removals(new QCacheFileRemovals)
         {}
 
+    struct IndexEntry
+    {
+        qint64 size;
+        quint64 sequence; // key in lruOrder
+    };
+
     static QString uniqueFileName(const QUrl &url);
     QString cacheFileName(const QUrl &url) const;
     QString tmpCacheFileName() const;
@@ -111,6 +134,19 @@ public:
     void prepareLayout();
     static quint32 crc32(const char *data, uint len);
 
+    QString indexKey(const QString &fileName) const;
+    void loadIndex();
+    bool readIndexFile();
+    void scanCacheDirectory();
+    void saveIndex();
+    void resetIndex();
+    void addToIndex(const QString &key, qint64 size);
+    void removeFromIndex(const QString &key);
+    void touch(const QString &fileName);
+    bool isIndexed(const QString &fileName) const;
+    void removeFiles(const QStringList &files, bool synchronous = false);
+    void cancelRemoval(const QString &file);
+
     mutable QCacheItem lastItem;
     QString cacheDirectory;
     QString dataDirectory;
@@ -118,6 +154,18 @@ public:
     qint64 currentCacheSize;
 
     QHash<QIODevice*, QCacheItem*> inserting;
+
+    // Every cache file, by its path relative to cacheDirectory, so that
+    // neither lookups nor expire() have to go to the file system to find
+    // out what is in the cache.
+    bool indexLoaded;
+    QHash<QString, IndexEntry> index;
+    QMap<quint64, QString> lruOrder; // least recently used first
+    qint64 indexedSize;
+    qint64 reservedSize; // for the item storeItem() is about to add
+    quint64 nextSequence;
+
+    QSharedPointer<QCacheFileRemovals> removals;
     Q_DECLARE_PUBLIC(QNetworkDiskCache)
 };
 
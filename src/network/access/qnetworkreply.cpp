@@ -56,6 +56,16 @@ QNetworkReplyPrivate::QNetworkReplyPrivate()
     attributes.insert(QNetworkRequest::ConnectionEncryptedAttribute, false);
 }
 
+void QNetworkReplyPrivate::_q_writeToDownloadDevice()
+{
+    Q_Q(QNetworkReply);
+    if (!downloadDevice)
+        return;
+    const QByteArray data = q->readAll();
+    if (downloadDevice->write(data) != data.size())
+        q->abort();
+}
+
 
 /*!
     \class QNetworkReply
@@ -523,6 +533,52 @@ void QNetworkReply::setReadBufferSize(qint64 size)
     d->readBufferMaxSize = size;
 }
 
+/*!
+    \since 5.10
+
+    Returns the device the downloaded data is written to, or \c nullptr if
+    the data is made available for reading from this reply.
+
+    \sa setDownloadDevice()
+*/
+QIODevice *QNetworkReply::downloadDevice() const
+{
+    return d_func()->downloadDevice.data();
+}
+
+/*!
+    \since 5.10
+
+    Makes the reply write the downloaded data to \a device, which must be
+    open for writing, instead of keeping it for QIODevice::read(). Data
+    that was already received is written to \a device immediately. Passing
+    \c nullptr makes the data readable from this reply again.
+
+    Where the backend supports it, as the HTTP backend does, the data goes
+    to \a device as it comes off the network without being buffered in the
+    reply, and readyRead() is not emitted for it. A read buffer size set
+    with setReadBufferSize() then limits how much data is in flight before
+    it is written. If writing to \a device fails, the reply is aborted.
+
+    QNetworkReply does not take ownership of \a device.
+
+    \sa downloadDevice(), setReadBufferSize()
+*/
+void QNetworkReply::setDownloadDevice(QIODevice *device)
+{
+    Q_D(QNetworkReply);
+    if (d->downloadDevice == device)
+        return;
+    if (d->downloadDevice)
+        disconnect(this, SIGNAL(readyRead()), this, SLOT(_q_writeToDownloadDevice()));
+    d->downloadDevice = device;
+    if (device) {
+        connect(this, SIGNAL(readyRead()), this, SLOT(_q_writeToDownloadDevice()));
+        if (bytesAvailable())
+            d->_q_writeToDownloadDevice();
+    }
+}
+
 /*!
     Returns the QNetworkAccessManager that was used to create this
     QNetworkReply object. Initially, it is also the parent object.
@@ -941,3 +997,5 @@ void QNetworkReply::setAttribute(QNetworkRequest::Attribute code, const QVariant
 }
 
 QT_END_NAMESPACE
+
+#include "moc_qnetworkreply.cpp"
@@ -121,6 +121,9 @@ public:
     qint64 readBufferSize() const;
     virtual void setReadBufferSize(qint64 size);
 
+    QIODevice *downloadDevice() const;
+    void setDownloadDevice(QIODevice *device);
+
     QNetworkAccessManager *manager() const;
     QNetworkAccessManager::Operation operation() const;
     QNetworkRequest request() const;
@@ -188,6 +191,7 @@ protected:
 
 private:
     Q_DECLARE_PRIVATE(QNetworkReply)
+    Q_PRIVATE_SLOT(d_func(), void _q_writeToDownloadDevice())
 };
 
 QT_END_NAMESPACE
@@ -87,6 +87,9 @@ public:
     QNetworkAccessManager::Operation operation;
     QNetworkReply::NetworkError errorCode;
     bool isFinished;
+    QPointer<QIODevice> downloadDevice;
+
+    void _q_writeToDownloadDevice();
 
     static inline void setManager(QNetworkReply *reply, QNetworkAccessManager *manager)
     { reply->d_func()->manager = manager; }
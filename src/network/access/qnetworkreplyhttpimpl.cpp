@@ -449,7 +449,6 @@ QNetworkReplyHttpImplPrivate::QNetworkReplyHttpImplPrivate()
     , downloadBufferReadPosition(0)
     , downloadBufferCurrentSize(0)
     , downloadZerocopyBuffer(0)
-    , pendingDownloadDataEmissions(QSharedPointer<QAtomicInt>::create())
     , pendingDownloadProgressEmissions(QSharedPointer<QAtomicInt>::create())
     #ifndef QT_NO_SSL
     , pendingIgnoreAllSslErrors(false)
@@ -617,9 +616,8 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
         QObject::connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
         thread->start();
     } else {
-        // We use the manager-global thread.
-        // At some point we could switch to having multiple threads if it makes sense.
-        thread = managerPrivate->createThread();
+        // We use the manager-global thread, or one shared with other managers.
+        thread = managerPrivate->httpThread(newHttpRequest.url());
     }
 
     QUrl url = newHttpRequest.url();
@@ -800,6 +798,18 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
     // from HTTP thread to user thread in some cases.
     delegate->authenticationManager = managerPrivate->authenticationManager;
 
+    delegate->maximumConnectionsPerHost = managerPrivate->maximumConnectionsPerHost;
+    delegate->connectionIdleTimeout = managerPrivate->connectionIdleTimeout;
+    delegate->connectionBudget = managerPrivate->connectionBudget;
+    delegate->http2SessionReceiveWindowSize = managerPrivate->http2SessionReceiveWindowSize;
+    delegate->http2StreamReceiveWindowSize = managerPrivate->http2StreamReceiveWindowSize;
+    // only HTTP/2 connections are shared with other managers, if at all
+    if (!synchronous && managerPrivate->usesSharedHttpThreads()) {
+        delegate->connectionCacheTag = managerPrivate->connectionCacheTag();
+        delegate->shareHttp2Connection = managerPrivate->http2ConnectionSharing
+                                         && httpRequest.isHTTP2Allowed();
+    }
+
     if (!synchronous) {
         // Tell our zerocopy policy to the delegate
         QVariant downloadBufferMaximumSizeAttribute = newHttpRequest.attribute(QNetworkRequest::MaximumDownloadBufferSizeAttribute);
@@ -813,13 +823,16 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
         }
 
 
-        // These atomic integers are used for signal compression
-        delegate->pendingDownloadData = pendingDownloadDataEmissions;
+        // The body data is passed through this queue, a fresh one per delegate
+        // so that nothing from an earlier (e.g. redirected) request is left in it
+        downloadQueue = QSharedPointer<QByteDataQueue>::create();
+        delegate->downloadQueue = downloadQueue;
+        // This atomic integer is used for signal compression
         delegate->pendingDownloadProgress = pendingDownloadProgressEmissions;
 
         // Connect the signals of the delegate to us
-        QObject::connect(delegate, SIGNAL(downloadData(QByteArray)),
-                q, SLOT(replyDownloadData(QByteArray)),
+        QObject::connect(delegate, SIGNAL(downloadDataAvailable()),
+                q, SLOT(replyDownloadDataAvailable()),
                 Qt::QueuedConnection);
         QObject::connect(delegate, SIGNAL(downloadFinished()),
                 q, SLOT(replyFinished()),
@@ -832,6 +845,9 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
                                               int, QString, bool,
                                               QSharedPointer<char>, qint64, qint64, bool)),
                 Qt::QueuedConnection);
+        QObject::connect(delegate, SIGNAL(connectionPoolStatistics(qint64,int,int,int)),
+                q, SLOT(replyConnectionPoolStatistics(qint64,int,int,int)),
+                Qt::QueuedConnection);
         QObject::connect(delegate, SIGNAL(downloadProgress(qint64,qint64)),
                 q, SLOT(replyDownloadProgressSlot(qint64,qint64)),
                 Qt::QueuedConnection);
@@ -931,6 +947,13 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
     if (synchronous) {
         emit q->startHttpRequestSynchronously(); // This one is BlockingQueuedConnection, so it will return when all work is done
 
+        replyConnectionPoolStatistics(delegate->poolStatistics.waitTime,
+                                      delegate->poolStatistics.activeConnections,
+                                      delegate->poolStatistics.idleConnections,
+                                      delegate->poolStatistics.queuedRequests);
+
+        QByteDataBuffer synchronousDownloadData;
+        synchronousDownloadData.append(delegate->synchronousDownloadData);
         if (delegate->incomingErrorCode != QNetworkReply::NoError) {
             replyDownloadMetaData
                     (delegate->incomingHeaders,
@@ -941,7 +964,7 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
                      delegate->incomingContentLength,
                      delegate->removedContentLength,
                      delegate->isSpdyUsed);
-            replyDownloadData(delegate->synchronousDownloadData);
+            replyDownloadData(synchronousDownloadData);
             httpError(delegate->incomingErrorCode, delegate->incomingErrorDetail);
         } else {
             replyDownloadMetaData
@@ -953,7 +976,7 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
                      delegate->incomingContentLength,
                      delegate->removedContentLength,
                      delegate->isSpdyUsed);
-            replyDownloadData(delegate->synchronousDownloadData);
+            replyDownloadData(synchronousDownloadData);
         }
 
         thread->quit();
@@ -1017,41 +1040,44 @@ void QNetworkReplyHttpImplPrivate::initCacheSaveDevice()
     }
 }
 
-void QNetworkReplyHttpImplPrivate::replyDownloadData(QByteArray d)
+void QNetworkReplyHttpImplPrivate::replyDownloadDataAvailable()
 {
-    Q_Q(QNetworkReplyHttpImpl);
+    // The HTTP thread emits the next notification only after we took this
+    // one, so take it before draining to not miss any data
+    downloadQueue->takeWakeUp();
 
-    // If we're closed just ignore this data
-    if (!q->isOpen())
+    QByteDataBuffer data;
+    QByteArray chunk;
+    while (downloadQueue->dequeue(&chunk))
+        data.append(chunk);
+    // A notification that was still posted when replyFinished() already
+    // drained the queue, nothing to do
+    if (data.isEmpty())
         return;
 
-    int pendingSignals = (int)pendingDownloadDataEmissions->fetchAndAddAcquire(-1) - 1;
+    replyDownloadData(data);
+}
 
-    if (pendingSignals > 0) {
-        // Some more signal emissions to this slot are pending.
-        // Instead of writing the downstream data, we wait
-        // and do it in the next call we get
-        // (signal comppression)
-        pendingDownloadData.append(d);
-        return;
-    }
+void QNetworkReplyHttpImplPrivate::replyDownloadData(QByteDataBuffer &data)
+{
+    Q_Q(QNetworkReplyHttpImpl);
 
-    pendingDownloadData.append(d);
-    d.clear();
-    // We need to usa a copy for calling writeDownstreamData as we could
-    // possibly recurse into this this function when we call
-    // appendDownstreamDataSignalEmissions because the user might call
-    // processEvents() or spin an event loop when this occur.
-    QByteDataBuffer pendingDownloadDataCopy = pendingDownloadData;
-    pendingDownloadData.clear();
+    // If we're closed just ignore this data
+    if (!q->isOpen())
+        return;
 
     if (cacheEnabled && isCachingAllowed() && !cacheSaveDevice) {
         initCacheSaveDevice();
     }
 
+    // If the user wants the data in a device of their own and nothing is
+    // waiting in our buffer, we hand each chunk to that device right away
+    // instead of buffering it and emitting readyRead().
+    QIODevice *device = buffer.isEmpty() ? downloadDevice.data() : 0;
+
     qint64 bytesWritten = 0;
-    for (int i = 0; i < pendingDownloadDataCopy.bufferCount(); i++) {
-        QByteArray const &item = pendingDownloadDataCopy[i];
+    for (int i = 0; i < data.bufferCount(); i++) {
+        QByteArray const &item = data[i];
 
         // This is going to look a little strange. When downloading data while a
         // HTTP redirect is happening (and enabled), we write the redirect
@@ -1061,24 +1087,37 @@ void QNetworkReplyHttpImplPrivate::replyDownloadData(QByteArray d)
         if (cacheSaveDevice)
             cacheSaveDevice->write(item.constData(), item.size());
 
-        if (!isHttpRedirectResponse())
-            buffer.append(item);
+        if (!isHttpRedirectResponse()) {
+            if (!device) {
+                buffer.append(item);
+            } else if (device->write(item) != item.size()) {
+                q->abort();
+                return;
+            }
+        }
 
         bytesWritten += item.size();
     }
-    bytesBuffered += bytesWritten;
-    pendingDownloadDataCopy.clear();
 
     QVariant totalSize = cookedHeaders.value(QNetworkRequest::ContentLengthHeader);
     if (preMigrationDownloaded != Q_INT64_C(-1))
         totalSize = totalSize.toLongLong() + preMigrationDownloaded;
 
-    if (isHttpRedirectResponse())
+    if (isHttpRedirectResponse()) {
+        bytesBuffered += bytesWritten;
         return;
+    }
 
     bytesDownloaded += bytesWritten;
 
-    emit q->readyRead();
+    if (device) {
+        // Nothing was buffered, let the HTTP thread go on right away
+        if (q->readBufferSize())
+            emit q->readBufferFreed(bytesWritten);
+    } else {
+        bytesBuffered += bytesWritten;
+        emit q->readyRead();
+    }
     // emit readyRead before downloadProgress incase this will cause events to be
     // processed and we get into a recursive call (as in QProgressDialog).
     if (downloadProgressSignalChoke.elapsed() >= progressSignalInterval) {
@@ -1096,6 +1135,10 @@ void QNetworkReplyHttpImplPrivate::replyFinished()
     if (loadingFromCache)
         return;
 
+    // Deliver what the HTTP thread queued before it finished
+    if (downloadQueue)
+        replyDownloadDataAvailable();
+
     finished();
 }
 
@@ -1324,6 +1367,23 @@ void QNetworkReplyHttpImplPrivate::replyDownloadMetaData(const QList<QPair<QByte
     _q_metaDataChanged();
 }
 
+void QNetworkReplyHttpImplPrivate::replyConnectionPoolStatistics(qint64 waitTime,
+                                                                 int activeConnections,
+                                                                 int idleConnections,
+                                                                 int queuedRequests)
+{
+    Q_Q(QNetworkReplyHttpImpl);
+
+    // only HTTP/1 requests go through the connection pool
+    if (waitTime < 0)
+        return;
+
+    q->setAttribute(QNetworkRequest::ConnectionWaitTimeAttribute, waitTime);
+    q->setAttribute(QNetworkRequest::ActiveConnectionsAttribute, activeConnections);
+    q->setAttribute(QNetworkRequest::IdleConnectionsAttribute, idleConnections);
+    q->setAttribute(QNetworkRequest::QueuedRequestsAttribute, queuedRequests);
+}
+
 void QNetworkReplyHttpImplPrivate::replyDownloadProgressSlot(qint64 bytesReceived,  qint64 bytesTotal)
 {
     Q_Q(QNetworkReplyHttpImpl);
@@ -64,6 +64,7 @@
 #include <QtNetwork/QNetworkCacheMetaData>
 #include <private/qhttpnetworkrequest_p.h>
 #include <private/qbytedata_p.h>
+#include <private/qbytedataqueue_p.h>
 #include <private/qnetworkreply_p.h>
 #include <QtNetwork/QNetworkProxy>
 #include <QtNetwork/QNetworkSession>
@@ -111,11 +112,12 @@ public:
     Q_PRIVATE_SLOT(d_func(), void _q_error(QNetworkReply::NetworkError, const QString &))
 
     // From reply
-    Q_PRIVATE_SLOT(d_func(), void replyDownloadData(QByteArray))
+    Q_PRIVATE_SLOT(d_func(), void replyDownloadDataAvailable())
     Q_PRIVATE_SLOT(d_func(), void replyFinished())
     Q_PRIVATE_SLOT(d_func(), void replyDownloadMetaData(QList<QPair<QByteArray,QByteArray> >,
                                                         int, QString, bool, QSharedPointer<char>,
                                                         qint64, qint64, bool))
+    Q_PRIVATE_SLOT(d_func(), void replyConnectionPoolStatistics(qint64,int,int,int))
     Q_PRIVATE_SLOT(d_func(), void replyDownloadProgressSlot(qint64,qint64))
     Q_PRIVATE_SLOT(d_func(), void httpAuthenticationRequired(const QHttpNetworkRequest &, QAuthenticator *))
     Q_PRIVATE_SLOT(d_func(), void httpError(QNetworkReply::NetworkError, const QString &))
@@ -244,7 +246,6 @@ public:
     quint64 resumeOffset;
     qint64 preMigrationDownloaded;
 
-    QByteDataBuffer pendingDownloadData; // For signal compression
     qint64 bytesDownloaded;
     qint64 bytesBuffered;
 
@@ -255,8 +256,9 @@ public:
     QSharedPointer<char> downloadBufferPointer;
     char* downloadZerocopyBuffer;
 
+    // Filled by HTTP thread, one per delegate:
+    QSharedPointer<QByteDataQueue> downloadQueue;
     // Will be increased by HTTP thread:
-    QSharedPointer<QAtomicInt> pendingDownloadDataEmissions;
     QSharedPointer<QAtomicInt> pendingDownloadProgressEmissions;
 
 
@@ -281,10 +283,13 @@ public:
 
 public:
     // From HTTP thread:
-    void replyDownloadData(QByteArray);
+    void replyDownloadDataAvailable();
+    void replyDownloadData(QByteDataBuffer &data);
     void replyFinished();
     void replyDownloadMetaData(const QList<QPair<QByteArray,QByteArray> > &, int, const QString &,
                                bool, QSharedPointer<char>, qint64, qint64, bool);
+    void replyConnectionPoolStatistics(qint64 waitTime, int activeConnections,
+                                       int idleConnections, int queuedRequests);
     void replyDownloadProgressSlot(qint64,qint64);
     void httpAuthenticationRequired(const QHttpNetworkRequest &request, QAuthenticator *auth);
     void httpError(QNetworkReply::NetworkError error, const QString &errorString);
@@ -298,6 +298,31 @@ QT_BEGIN_NAMESPACE
         This attribute obsoletes FollowRedirectsAttribute.
         (This value was introduced in 5.9.)
 
+    \value ConnectionWaitTimeAttribute
+        Replies only, type: QMetaType::LongLong
+        Number of milliseconds the request waited for a free connection to
+        its host before it was sent. Only set for HTTP/1 requests.
+        (This value was introduced in 5.10.)
+
+    \value ActiveConnectionsAttribute
+        Replies only, type: QMetaType::Int
+        Number of connections to the host that were handling a request,
+        including this one, when the request was sent. Only set for HTTP/1
+        requests.
+        (This value was introduced in 5.10.)
+
+    \value IdleConnectionsAttribute
+        Replies only, type: QMetaType::Int
+        Number of open connections to the host that were idle when the
+        request was sent. Only set for HTTP/1 requests.
+        (This value was introduced in 5.10.)
+
+    \value QueuedRequestsAttribute
+        Replies only, type: QMetaType::Int
+        Number of requests to the same host still waiting for a connection
+        when the request was sent. Only set for HTTP/1 requests.
+        (This value was introduced in 5.10.)
+
     \value User
         Special type. Additional information can be passed in
         QVariants with types ranging from User to UserMax. The default
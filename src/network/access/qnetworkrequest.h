@@ -92,6 +92,10 @@ public:
         HTTP2WasUsedAttribute,
         OriginalContentLengthAttribute,
         RedirectPolicyAttribute,
+        ConnectionWaitTimeAttribute,
+        ActiveConnectionsAttribute,
+        IdleConnectionsAttribute,
+        QueuedRequestsAttribute,
 
         User = 1000,
         UserMax = 32767
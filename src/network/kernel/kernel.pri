@@ -13,6 +13,7 @@ HEADERS += kernel/qtnetworkglobal.h \
            kernel/qhostaddress_p.h \
            kernel/qhostinfo.h \
            kernel/qhostinfo_p.h \
+           kernel/qhostinforesolver_p.h \
            kernel/qnetworkdatagram.h \
            kernel/qnetworkdatagram_p.h \
            kernel/qnetworkinterface.h \
@@ -30,12 +31,12 @@ SOURCES += kernel/qauthenticator.cpp \
            kernel/qurlinfo.cpp
 
 unix {
-    !integrity: SOURCES += kernel/qdnslookup_unix.cpp
+    !integrity: SOURCES += kernel/qdnslookup_unix.cpp kernel/qhostinforesolver_unix.cpp
     SOURCES += kernel/qhostinfo_unix.cpp kernel/qnetworkinterface_unix.cpp
 }
 
 android {
-    SOURCES -= kernel/qdnslookup_unix.cpp
+    SOURCES -= kernel/qdnslookup_unix.cpp kernel/qhostinforesolver_unix.cpp
     SOURCES += kernel/qdnslookup_android.cpp
 }
 
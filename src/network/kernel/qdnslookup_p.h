@@ -120,6 +120,11 @@ public:
     { }
     void run() Q_DECL_OVERRIDE;
 
+#if defined(Q_OS_UNIX) && !defined(Q_OS_ANDROID)
+    // parses a DNS response message, including its header
+    static void parseReply(const unsigned char *response, int responseLength, QDnsLookupReply *reply);
+#endif
+
 signals:
     void finished(const QDnsLookupReply &reply);
 
@@ -193,8 +193,25 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
     memset(response, 0, sizeof(response));
     const int responseLength = local_res_nquery(&state, requestName, C_IN, requestType, response, sizeof(response));
 
-    // Check the response header.
-    HEADER *header = (HEADER*)response;
+    parseReply(response, responseLength, reply);
+}
+
+// Also used by QHostInfoResolver, which sends its queries itself
+void QDnsLookupRunnable::parseReply(const unsigned char *response, int responseLength, QDnsLookupReply *reply)
+{
+    resolveLibrary();
+    if (!local_dn_expand) {
+        reply->error = QDnsLookup::ResolverError;
+        reply->errorString = tr("Resolver functions not found");
+        return;
+    }
+    const unsigned char *end = response + responseLength;
+
+    // Check the response header. res_nquery returns -1 when the server
+    // answers with an error, but still fills in the header, so this comes
+    // before the length check. Callers always pass a whole header's worth
+    // of buffer.
+    const HEADER *header = (const HEADER*)response;
     const int answerCount = ntohs(header->ancount);
     switch (header->rcode) {
     case NOERROR:
@@ -230,8 +247,8 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
 
     // Skip the query host, type (2 bytes) and class (2 bytes).
     char host[PACKETSZ], answer[PACKETSZ];
-    unsigned char *p = response + sizeof(HEADER);
-    int status = local_dn_expand(response, response + responseLength, p, host, sizeof(host));
+    const unsigned char *p = response + sizeof(HEADER);
+    int status = local_dn_expand(response, end, p, host, sizeof(host));
     if (status < 0) {
         reply->error = QDnsLookup::InvalidReplyError;
         reply->errorString = tr("Could not expand domain name");
@@ -241,8 +258,8 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
 
     // Extract results.
     int answerIndex = 0;
-    while ((p < response + responseLength) && (answerIndex < answerCount)) {
-        status = local_dn_expand(response, response + responseLength, p, host, sizeof(host));
+    while ((p < end) && (answerIndex < answerCount)) {
+        status = local_dn_expand(response, end, p, host, sizeof(host));
         if (status < 0) {
             reply->error = QDnsLookup::InvalidReplyError;
             reply->errorString = tr("Could not expand domain name");
@@ -251,6 +268,11 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
         const QString name = QUrl::fromAce(host);
 
         p += status;
+        if (end - p < 10) {
+            reply->error = QDnsLookup::InvalidReplyError;
+            reply->errorString = tr("Invalid reply received");
+            return;
+        }
         const quint16 type = (p[0] << 8) | p[1];
         p += 2; // RR type
         p += 2; // RR class
@@ -258,6 +280,11 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
         p += 4;
         const quint16 size = (p[0] << 8) | p[1];
         p += 2;
+        if (end - p < size) {
+            reply->error = QDnsLookup::InvalidReplyError;
+            reply->errorString = tr("Invalid reply received");
+            return;
+        }
 
         if (type == QDnsLookup::A) {
             if (size != 4) {
@@ -283,7 +310,7 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
             record.d->value = QHostAddress(p);
             reply->hostAddressRecords.append(record);
         } else if (type == QDnsLookup::CNAME) {
-            status = local_dn_expand(response, response + responseLength, p, answer, sizeof(answer));
+            status = local_dn_expand(response, end, p, answer, sizeof(answer));
             if (status < 0) {
                 reply->error = QDnsLookup::InvalidReplyError;
                 reply->errorString = tr("Invalid canonical name record");
@@ -295,7 +322,7 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
             record.d->value = QUrl::fromAce(answer);
             reply->canonicalNameRecords.append(record);
         } else if (type == QDnsLookup::NS) {
-            status = local_dn_expand(response, response + responseLength, p, answer, sizeof(answer));
+            status = local_dn_expand(response, end, p, answer, sizeof(answer));
             if (status < 0) {
                 reply->error = QDnsLookup::InvalidReplyError;
                 reply->errorString = tr("Invalid name server record");
@@ -307,7 +334,7 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
             record.d->value = QUrl::fromAce(answer);
             reply->nameServerRecords.append(record);
         } else if (type == QDnsLookup::PTR) {
-            status = local_dn_expand(response, response + responseLength, p, answer, sizeof(answer));
+            status = local_dn_expand(response, end, p, answer, sizeof(answer));
             if (status < 0) {
                 reply->error = QDnsLookup::InvalidReplyError;
                 reply->errorString = tr("Invalid pointer record");
@@ -320,7 +347,7 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
             reply->pointerRecords.append(record);
         } else if (type == QDnsLookup::MX) {
             const quint16 preference = (p[0] << 8) | p[1];
-            status = local_dn_expand(response, response + responseLength, p + 2, answer, sizeof(answer));
+            status = local_dn_expand(response, end, p + 2, answer, sizeof(answer));
             if (status < 0) {
                 reply->error = QDnsLookup::InvalidReplyError;
                 reply->errorString = tr("Invalid mail exchange record");
@@ -336,7 +363,7 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
             const quint16 priority = (p[0] << 8) | p[1];
             const quint16 weight = (p[2] << 8) | p[3];
             const quint16 port = (p[4] << 8) | p[5];
-            status = local_dn_expand(response, response + responseLength, p + 6, answer, sizeof(answer));
+            status = local_dn_expand(response, end, p + 6, answer, sizeof(answer));
             if (status < 0) {
                 reply->error = QDnsLookup::InvalidReplyError;
                 reply->errorString = tr("Invalid service record");
@@ -351,7 +378,7 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
             record.d->weight = weight;
             reply->serviceRecords.append(record);
         } else if (type == QDnsLookup::TXT) {
-            unsigned char *txt = p;
+            const unsigned char *txt = p;
             QDnsTextRecord record;
             record.d->name = name;
             record.d->timeToLive = ttl;
@@ -363,7 +390,7 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
                     reply->errorString = tr("Invalid text record");
                     return;
                 }
-                record.d->values << QByteArray((char*)txt, length);
+                record.d->values << QByteArray((const char*)txt, length);
                 txt += length;
             }
             reply->textRecords.append(record);
@@ -384,6 +411,14 @@ void QDnsLookupRunnable::query(const int requestType, const QByteArray &requestN
     return;
 }
 
+void QDnsLookupRunnable::parseReply(const unsigned char *response, int responseLength, QDnsLookupReply *reply)
+{
+    Q_UNUSED(response)
+    Q_UNUSED(responseLength)
+    reply->error = QDnsLookup::ResolverError;
+    reply->errorString = tr("Resolver library can't be loaded: No runtime library loading support");
+}
+
 #endif /* QT_CONFIG(library) */
 
 QT_END_NAMESPACE
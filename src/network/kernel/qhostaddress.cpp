@@ -526,6 +526,7 @@ QHostAddress::QHostAddress(SpecialAddress address)
 */
 void QHostAddress::setAddress(SpecialAddress address)
 {
+    d.detach();
     d->clear();
 
     Q_IPV6ADDR ip6;
@@ -39,6 +39,9 @@
 
 #include "qhostinfo.h"
 #include "qhostinfo_p.h"
+#ifdef QT_HOSTINFO_RESOLVER
+#include "qhostinforesolver_p.h"
+#endif
 
 #include "QtCore/qscopedpointer.h"
 #include <qabstracteventdispatcher.h>
@@ -694,6 +697,15 @@ void QHostInfoRunnable::run()
         hostInfo = QHostInfoAgent::fromName(toBeLookedUp);
     }
 
+    finish(hostInfo);
+
+    // thread goes back to QThreadPool
+}
+
+void QHostInfoRunnable::finish(QHostInfo hostInfo)
+{
+    QHostInfoLookupManager *manager = theHostInfoLookupManager();
+
     // check aborted again
     if (manager->wasAborted(id)) {
         manager->lookupFinished(this);
@@ -721,25 +733,109 @@ void QHostInfoRunnable::run()
     }
 
     manager->lookupFinished(this);
-
-    // thread goes back to QThreadPool
 }
 
-QHostInfoLookupManager::QHostInfoLookupManager() : mutex(QMutex::Recursive), wasDeleted(false)
+QHostInfoLookupManager::QHostInfoLookupManager()
+    :
+#ifdef QT_HOSTINFO_RESOLVER
+      resolver(0),
+      resolverLookups(0),
+#endif
+      mutex(QMutex::Recursive), wasDeleted(false)
 {
     moveToThread(QCoreApplicationPrivate::mainThread());
     connect(QCoreApplication::instance(), SIGNAL(destroyed()), SLOT(waitForThreadPoolDone()), Qt::DirectConnection);
     threadPool.setMaxThreadCount(20); // do up to 20 DNS lookups in parallel
+#ifdef QT_HOSTINFO_RESOLVER
+    resolverThread.setObjectName(QStringLiteral("QHostInfoResolver"));
+    if (qEnvironmentVariableIntValue("QT_HOSTINFO_ASYNC_DNS"))
+        setNameServers(QHostInfoResolver::systemNameServers());
+#endif
 }
 
 QHostInfoLookupManager::~QHostInfoLookupManager()
 {
     wasDeleted = true;
 
+#ifdef QT_HOSTINFO_RESOLVER
+    stopResolver(false);
+#endif
     // don't qDeleteAll currentLookups, the QThreadPool has ownership
     clear();
 }
 
+void QHostInfoLookupManager::waitForThreadPoolDone()
+{
+#ifdef QT_HOSTINFO_RESOLVER
+    stopResolver(false);
+#endif
+    threadPool.waitForDone();
+}
+
+#ifdef QT_HOSTINFO_RESOLVER
+void QHostInfoLookupManager::setNameServers(const QList<QPair<QHostAddress, quint16> > &nameServers)
+{
+    stopResolver(true);
+    if (nameServers.isEmpty())
+        return;
+
+    QMutexLocker locker(&mutex);
+    resolver = new QHostInfoResolver(this, nameServers);
+    resolver->moveToThread(&resolverThread);
+    resolverThread.start();
+}
+
+void QHostInfoLookupManager::stopResolver(bool restartLookups)
+{
+    QHostInfoResolver *oldResolver;
+    {
+        QMutexLocker locker(&mutex);
+        oldResolver = resolver;
+        resolver = 0;
+    }
+    if (!oldResolver)
+        return;
+
+    QMetaObject::invokeMethod(oldResolver, "stop", Qt::BlockingQueuedConnection);
+    resolverThread.quit();
+    resolverThread.wait();
+    const QList<QHostInfoRunnable *> lookups = oldResolver->takeLookups();
+    delete oldResolver;
+
+    QMutexLocker locker(&mutex);
+    resolverLookups -= lookups.size();
+    for (QHostInfoRunnable *r : lookups) {
+        if (restartLookups) {
+            threadPool.start(r);
+        } else {
+            currentLookups.removeOne(r);
+            delete r;
+        }
+    }
+}
+
+void QHostInfoLookupManager::resolverFinished(QHostInfoRunnable *r, const QHostInfo &hostInfo, int ttl)
+{
+    if (cache.isEnabled())
+        cache.put(r->toBeLookedUp, hostInfo, ttl);
+    {
+        QMutexLocker locker(&mutex);
+        --resolverLookups;
+    }
+    r->finish(hostInfo);
+    delete r;
+}
+
+void QHostInfoLookupManager::resolverFailed(QHostInfoRunnable *r)
+{
+    // getaddrinfo() knows more than DNS: hosts files, mDNS, search
+    // domains; let it have a go
+    QMutexLocker locker(&mutex);
+    --resolverLookups;
+    threadPool.start(r);
+}
+#endif
+
 void QHostInfoLookupManager::clear()
 {
     {
@@ -796,7 +892,24 @@ void QHostInfoLookupManager::work()
                                        isAlreadyRunning).second,
                            scheduledLookups.end());
 
+#ifdef QT_HOSTINFO_RESOLVER
+    // The resolver does not need a thread per lookup, give it all it can take
+    if (resolver) {
+        for (auto it = scheduledLookups.begin(); it != scheduledLookups.end(); ) {
+            if (resolver->canResolve((*it)->toBeLookedUp)) {
+                currentLookups.push_back(*it);
+                ++resolverLookups;
+                resolver->resolve(*it);
+                it = scheduledLookups.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    const int availableThreads = threadPool.maxThreadCount() - (currentLookups.size() - resolverLookups);
+#else
     const int availableThreads = threadPool.maxThreadCount() - currentLookups.size();
+#endif
     if (availableThreads > 0) {
         int readyToStartCount = qMin(availableThreads, scheduledLookups.size());
         auto it = scheduledLookups.begin();
@@ -902,6 +1015,17 @@ void qt_qhostinfo_clear_cache()
 }
 
 #ifdef QT_BUILD_INTERNAL
+#ifdef QT_HOSTINFO_RESOLVER
+// Makes lookups go through QHostInfoResolver and the given name servers;
+// an empty list goes back to getaddrinfo() only
+void qt_qhostinfo_set_name_servers(const QList<QPair<QHostAddress, quint16> > &nameServers)
+{
+    QHostInfoLookupManager *manager = theHostInfoLookupManager();
+    if (manager)
+        manager->setNameServers(nameServers);
+}
+#endif
+
 void Q_AUTOTEST_EXPORT qt_qhostinfo_enable_cache(bool e)
 {
     QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
@@ -948,7 +1072,7 @@ QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
 
     *valid = false;
     if (QHostInfoCacheElement *element = cache.object(name)) {
-        if (element->age.elapsed() < max_age*1000)
+        if (element->age.elapsed() < element->ttl * qint64(1000))
             *valid = true;
         return element->info;
 
@@ -960,16 +1084,17 @@ QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
     return QHostInfo();
 }
 
-void QHostInfoCache::put(const QString &name, const QHostInfo &info)
+void QHostInfoCache::put(const QString &name, const QHostInfo &info, int ttl)
 {
     // if the lookup failed, don't cache
-    if (info.error() != QHostInfo::NoError)
+    if (info.error() != QHostInfo::NoError || ttl == 0)
         return;
 
     QHostInfoCacheElement* element = new QHostInfoCacheElement();
     element->info = info;
     element->age = QElapsedTimer();
     element->age.start();
+    element->ttl = ttl < 0 ? max_age : ttl;
 
     QMutexLocker locker(&this->mutex);
     cache.insert(name, element); // cache will take ownership
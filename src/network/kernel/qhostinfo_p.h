@@ -64,6 +64,7 @@
 #include "QtCore/qthreadpool.h"
 #include "QtCore/qrunnable.h"
 #include "QtCore/qlist.h"
+#include "QtCore/qpair.h"
 #include "QtCore/qqueue.h"
 #include <QElapsedTimer>
 #include <QCache>
@@ -72,8 +73,15 @@
 #include <QSharedPointer>
 
 
+#if defined(Q_OS_UNIX) && !defined(Q_OS_ANDROID) && !defined(Q_OS_INTEGRITY) && !defined(QT_NO_UDPSOCKET)
+#  define QT_HOSTINFO_RESOLVER
+#endif
+
 QT_BEGIN_NAMESPACE
 
+#ifdef QT_HOSTINFO_RESOLVER
+class QHostInfoResolver;
+#endif
 
 class QHostInfoResult : public QObject
 {
@@ -163,6 +171,9 @@ QHostInfo Q_NETWORK_EXPORT qt_qhostinfo_lookup(const QString &name, QObject *rec
 void Q_AUTOTEST_EXPORT qt_qhostinfo_clear_cache();
 void Q_AUTOTEST_EXPORT qt_qhostinfo_enable_cache(bool e);
 void Q_AUTOTEST_EXPORT qt_qhostinfo_cache_inject(const QString &hostname, const QHostInfo &resolution);
+#ifdef QT_HOSTINFO_RESOLVER
+void Q_AUTOTEST_EXPORT qt_qhostinfo_set_name_servers(const QList<QPair<QHostAddress, quint16> > &nameServers);
+#endif
 
 class QHostInfoCache
 {
@@ -171,7 +182,8 @@ public:
     const int max_age; // seconds
 
     QHostInfo get(const QString &name, bool *valid);
-    void put(const QString &name, const QHostInfo &info);
+    // ttl in seconds, -1 for max_age
+    void put(const QString &name, const QHostInfo &info, int ttl = -1);
     void clear();
 
     bool isEnabled();
@@ -181,6 +193,7 @@ private:
     struct QHostInfoCacheElement {
         QHostInfo info;
         QElapsedTimer age;
+        int ttl; // seconds
     };
     QCache<QString,QHostInfoCacheElement> cache;
     QMutex mutex;
@@ -195,6 +208,8 @@ public:
     QHostInfoRunnable(const QString &hn, int i, const QObject *receiver,
                       QtPrivate::QSlotObjectBase *slotObj);
     void run() Q_DECL_OVERRIDE;
+    // emits the result to everyone waiting for it
+    void finish(QHostInfo hostInfo);
 
     QString toBeLookedUp;
     int id;
@@ -236,6 +251,13 @@ public:
     void lookupFinished(QHostInfoRunnable *r);
     bool wasAborted(int id);
 
+#ifdef QT_HOSTINFO_RESOLVER
+    void setNameServers(const QList<QPair<QHostAddress, quint16> > &nameServers);
+    // called from QHostInfoResolver, from its thread
+    void resolverFinished(QHostInfoRunnable *r, const QHostInfo &hostInfo, int ttl);
+    void resolverFailed(QHostInfoRunnable *r);
+#endif
+
     friend class QHostInfoRunnable;
 protected:
     QList<QHostInfoRunnable*> currentLookups; // in progress
@@ -246,12 +268,22 @@ protected:
 
     QThreadPool threadPool;
 
+#ifdef QT_HOSTINFO_RESOLVER
+    // resolves host names without blocking a thread each, see
+    // qhostinforesolver_unix.cpp; null unless enabled
+    QHostInfoResolver *resolver;
+    QThread resolverThread;
+    int resolverLookups; // the part of currentLookups the resolver has
+    // the lookups it had are restarted in the thread pool, or dropped
+    void stopResolver(bool restartLookups);
+#endif
+
     QMutex mutex;
 
     bool wasDeleted;
 
 private slots:
-    void waitForThreadPoolDone() { threadPool.waitForDone(); }
+    void waitForThreadPoolDone();
 };
 
 QT_END_NAMESPACE
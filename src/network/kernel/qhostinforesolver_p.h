@@ -0,0 +1,164 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QHOSTINFORESOLVER_P_H
+#define QHOSTINFORESOLVER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the QHostInfo class.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+#include "private/qhostinfo_p.h"
+#include "QtCore/qhash.h"
+#include "QtCore/qmutex.h"
+#include "QtCore/qobject.h"
+#include "QtCore/qset.h"
+#include "QtNetwork/qhostaddress.h"
+
+#ifdef QT_HOSTINFO_RESOLVER
+
+QT_BEGIN_NAMESPACE
+
+class QTcpSocket;
+class QUdpSocket;
+
+// Resolves host names by talking DNS to the name servers itself, over UDP
+// and, for truncated replies, TCP. All lookups run in the event loop of
+// the one thread the resolver lives in, so a slow name server does not
+// tie up a thread per lookup. A and AAAA are queried in parallel; the
+// result honours the smallest TTL of the records and lists the addresses
+// for Happy Eyeballs (RFC 8305). Whatever it cannot answer goes back to
+// QHostInfoLookupManager and getaddrinfo().
+class QHostInfoResolver : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QPair<QHostAddress, quint16> NameServer;
+
+    QHostInfoResolver(QHostInfoLookupManager *manager, const QList<NameServer> &nameServers);
+    ~QHostInfoResolver();
+
+    // from /etc/resolv.conf
+    static QList<NameServer> systemNameServers();
+
+    // thread-safe
+    bool canResolve(const QString &name) const;
+    void resolve(QHostInfoRunnable *r);
+
+    // the lookups not finished yet; only once stop() has run in the
+    // resolver's thread, and that thread has finished
+    QList<QHostInfoRunnable *> takeLookups();
+
+public Q_SLOTS:
+    // closes the sockets and kills the timers, leaving the lookups as they are
+    void stop();
+
+protected:
+    void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE;
+
+private Q_SLOTS:
+    void startLookups();
+    void readDatagrams();
+    void readTcpReply();
+
+private:
+    Q_DISABLE_COPY(QHostInfoResolver)
+
+    enum Family { IPv4, IPv6 };
+
+    struct Query
+    {
+        Query() : id(0), done(false), udpSocket(0), tcpSocket(0) {}
+
+        quint16 id;
+        QByteArray message;
+        bool done;
+        QList<QHostAddress> addresses;
+        QUdpSocket *udpSocket; // a new one for every attempt
+        QTcpSocket *tcpSocket; // for truncated replies
+        QByteArray tcpBuffer;
+    };
+
+    struct Lookup
+    {
+        Lookup() : runnable(0), ttl(0), attempt(0), timerId(0) {}
+
+        QHostInfoRunnable *runnable;
+        Query queries[2]; // by Family
+        quint32 ttl;
+        int attempt;
+        int timerId; // attempt timeout, or the resolution delay
+    };
+
+    void startLookup(QHostInfoRunnable *r);
+    void sendQueries(Lookup *lookup);
+    void startTcpQuery(Lookup *lookup, Family family);
+    void processReply(const QByteArray &reply, bool viaTcp);
+    void checkFinished(Lookup *lookup);
+    void finishLookup(Lookup *lookup, bool complete);
+    void failLookup(Lookup *lookup);
+    void removeLookup(Lookup *lookup);
+    quint16 nextQueryId() const;
+    QUdpSocket *openUdpSocket(const Query &query, const NameServer &server);
+
+    QHostInfoLookupManager *manager;
+    const QList<NameServer> nameServers;
+    QSet<QString> hostsFileNames;
+
+    QMutex mutex;
+    QList<QHostInfoRunnable *> newLookups; // guarded by mutex
+
+    QList<Lookup *> lookups;
+    QHash<quint16, Lookup *> lookupsByQueryId;
+    QHash<int, Lookup *> lookupsByTimerId;
+};
+
+QT_END_NAMESPACE
+
+#endif // QT_HOSTINFO_RESOLVER
+
+#endif // QHOSTINFORESOLVER_P_H
@@ -0,0 +1,565 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qhostinforesolver_p.h"
+#include "qdnslookup_p.h"
+
+#include <QtCore/qdebug.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qurl.h>
+#include <QtNetwork/qnetworkdatagram.h>
+#include <QtNetwork/qtcpsocket.h>
+#include <QtNetwork/qudpsocket.h>
+#include <private/qnet_unix_p.h>
+
+#include <netinet/in.h>
+#ifdef Q_OS_LINUX
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+
+#ifdef QT_HOSTINFO_RESOLVER
+
+QT_BEGIN_NAMESPACE
+
+//#define QHOSTINFORESOLVER_DEBUG
+
+namespace {
+// what glibc does without "options timeout:n attempts:n" in resolv.conf,
+// except that we give up on a name server sooner
+const int attemptTimeout = 2000; // msecs
+const int attemptsPerServer = 2;
+// RFC 8305, section 3: how long to wait for AAAA once A has arrived
+const int resolutionDelay = 50; // msecs
+const quint32 maxTtl = 3600; // secs
+
+// how often to try another random port before the kernel picks one
+const int portAttempts = 8;
+
+const quint16 typeA = 1;
+const quint16 typeAAAA = 28;
+const int headerSize = 12;
+
+QByteArray makeQuery(quint16 id, const QByteArray &name, quint16 type)
+{
+    // RFC 1035, section 4.1: a header asking for recursion, one question
+    static const char header[] = { 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0 };
+    QByteArray query(header, headerSize);
+    qToBigEndian(id, query.data());
+
+    const QList<QByteArray> labels = name.split('.');
+    for (const QByteArray &label : labels) {
+        if (label.isEmpty())
+            continue; // the root, or a trailing dot
+        if (label.size() > 63)
+            return QByteArray();
+        query += char(label.size());
+        query += label;
+    }
+    query += char(0);
+    if (query.size() - headerSize > 255)
+        return QByteArray();
+
+    char typeAndClass[4];
+    qToBigEndian(type, typeAndClass);
+    qToBigEndian(quint16(1), typeAndClass + 2); // IN
+    query.append(typeAndClass, sizeof(typeAndClass));
+    return query;
+}
+
+// Fills data with size bytes of the kernel's cryptographically secure
+// random numbers. The query IDs and source ports are all that stop others
+// from answering in the name server's place (RFC 5452), so qrand() won't do.
+bool systemRandom(void *data, size_t size)
+{
+#if defined(Q_OS_LINUX) && defined(SYS_getrandom)
+    // doesn't return short for up to 256 bytes
+    if (syscall(SYS_getrandom, data, size, 0) == ssize_t(size))
+        return true;
+#endif
+    int randomfd = qt_safe_open("/dev/urandom", O_RDONLY);
+    if (randomfd == -1)
+        return false;
+    const bool ok = qt_safe_read(randomfd, static_cast<char *>(data), size) == qint64(size);
+    qt_safe_close(randomfd);
+    return ok;
+}
+
+// Whether we have a route to address, as in RFC 6724, section 6: connect()
+// on a datagram socket sends nothing but fails without a route.
+bool isReachable(const QHostAddress &address)
+{
+    const int fd = qt_safe_socket(AF_INET6, SOCK_DGRAM, 0);
+    if (fd == -1)
+        return false;
+    sockaddr_in6 sockAddr;
+    memset(&sockAddr, 0, sizeof(sockAddr));
+    sockAddr.sin6_family = AF_INET6;
+    sockAddr.sin6_port = htons(53);
+    const Q_IPV6ADDR ipv6 = address.toIPv6Address();
+    memcpy(&sockAddr.sin6_addr, &ipv6, sizeof(ipv6));
+    const bool reachable = qt_safe_connect(fd, reinterpret_cast<sockaddr *>(&sockAddr), sizeof(sockAddr)) == 0;
+    qt_safe_close(fd);
+    return reachable;
+}
+
+// RFC 8305, section 4: alternate between the families, starting with the
+// preferred one
+QList<QHostAddress> interleave(const QList<QHostAddress> &preferred, const QList<QHostAddress> &other)
+{
+    QList<QHostAddress> addresses;
+    addresses.reserve(preferred.size() + other.size());
+    for (int i = 0; i < qMax(preferred.size(), other.size()); ++i) {
+        if (i < preferred.size())
+            addresses.append(preferred.at(i));
+        if (i < other.size())
+            addresses.append(other.at(i));
+    }
+    return addresses;
+}
+}
+
+QHostInfoResolver::QHostInfoResolver(QHostInfoLookupManager *manager, const QList<NameServer> &nameServers)
+    : manager(manager),
+      nameServers(nameServers)
+{
+    // The hosts file beats DNS, leave its names to getaddrinfo()
+    QFile hosts(QStringLiteral("/etc/hosts"));
+    if (hosts.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!hosts.atEnd()) {
+            QByteArray line = hosts.readLine();
+            const int comment = line.indexOf('#');
+            if (comment != -1)
+                line.truncate(comment);
+            const QList<QByteArray> fields = line.simplified().split(' ');
+            for (int i = 1; i < fields.size(); ++i)
+                hostsFileNames.insert(QString::fromLatin1(fields.at(i)).toLower());
+        }
+    }
+}
+
+QHostInfoResolver::~QHostInfoResolver()
+{
+    qDeleteAll(lookups);
+}
+
+QList<QHostInfoResolver::NameServer> QHostInfoResolver::systemNameServers()
+{
+    QList<NameServer> servers;
+    QFile resolvConf(QStringLiteral("/etc/resolv.conf"));
+    if (resolvConf.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!resolvConf.atEnd()) {
+            const QList<QByteArray> fields = resolvConf.readLine().simplified().split(' ');
+            QHostAddress address;
+            if (fields.size() >= 2 && fields.at(0) == "nameserver"
+                && address.setAddress(QString::fromLatin1(fields.at(1)))) {
+                servers.append(NameServer(address, 53));
+            }
+        }
+    }
+    // like res_init()
+    if (servers.isEmpty())
+        servers.append(NameServer(QHostAddress(QHostAddress::LocalHost), 53));
+    return servers;
+}
+
+bool QHostInfoResolver::canResolve(const QString &name) const
+{
+    // Single labels are subject to search domains, .local to mDNS, and
+    // reverse lookups are for getaddrinfo() too
+    if (!name.contains(QLatin1Char('.')) || name.endsWith(QLatin1String(".local"), Qt::CaseInsensitive))
+        return false;
+    if (QHostAddress().setAddress(name))
+        return false;
+    return !hostsFileNames.contains(name.toLower());
+}
+
+void QHostInfoResolver::resolve(QHostInfoRunnable *r)
+{
+    QMutexLocker locker(&mutex);
+    newLookups.append(r);
+    if (newLookups.size() == 1)
+        QMetaObject::invokeMethod(this, "startLookups", Qt::QueuedConnection);
+}
+
+QList<QHostInfoRunnable *> QHostInfoResolver::takeLookups()
+{
+    QList<QHostInfoRunnable *> runnables;
+    {
+        QMutexLocker locker(&mutex);
+        runnables.swap(newLookups);
+    }
+    for (Lookup *lookup : qAsConst(lookups))
+        runnables.append(lookup->runnable);
+    qDeleteAll(lookups);
+    lookups.clear();
+    lookupsByQueryId.clear();
+    lookupsByTimerId.clear();
+    return runnables;
+}
+
+void QHostInfoResolver::stop()
+{
+    for (Lookup *lookup : qAsConst(lookups)) {
+        for (Query &query : lookup->queries) {
+            delete query.udpSocket;
+            query.udpSocket = 0;
+            delete query.tcpSocket;
+            query.tcpSocket = 0;
+        }
+        if (lookup->timerId) {
+            killTimer(lookup->timerId);
+            lookup->timerId = 0;
+        }
+    }
+    lookupsByTimerId.clear();
+}
+
+void QHostInfoResolver::startLookups()
+{
+    QList<QHostInfoRunnable *> runnables;
+    {
+        QMutexLocker locker(&mutex);
+        runnables.swap(newLookups);
+    }
+    for (QHostInfoRunnable *r : qAsConst(runnables))
+        startLookup(r);
+}
+
+void QHostInfoResolver::startLookup(QHostInfoRunnable *r)
+{
+    Lookup *lookup = new Lookup;
+    lookup->runnable = r;
+    lookup->ttl = maxTtl;
+    lookups.append(lookup);
+
+    const QByteArray name = QUrl::toAce(r->toBeLookedUp);
+    for (int family = IPv4; family <= IPv6; ++family) {
+        Query &query = lookup->queries[family];
+        query.id = nextQueryId();
+        if (query.id)
+            query.message = makeQuery(query.id, name, family == IPv4 ? typeA : typeAAAA);
+        if (query.message.isEmpty()) {
+            failLookup(lookup);
+            return;
+        }
+        lookupsByQueryId.insert(query.id, lookup);
+    }
+
+#if defined(QHOSTINFORESOLVER_DEBUG)
+    qDebug("QHostInfoResolver: looking up %s", name.constData());
+#endif
+    sendQueries(lookup);
+}
+
+void QHostInfoResolver::sendQueries(Lookup *lookup)
+{
+    // rotate through the servers, then do it all again
+    const NameServer &server = nameServers.at(lookup->attempt % nameServers.size());
+    for (Query &query : lookup->queries) {
+        if (query.done)
+            continue;
+        delete query.tcpSocket;
+        query.tcpSocket = 0;
+        query.tcpBuffer.clear();
+        delete query.udpSocket;
+        query.udpSocket = openUdpSocket(query, server);
+        if (query.udpSocket)
+            query.udpSocket->writeDatagram(query.message, server.first, server.second);
+    }
+
+    if (lookup->timerId) {
+        lookupsByTimerId.remove(lookup->timerId);
+        killTimer(lookup->timerId);
+    }
+    lookup->timerId = startTimer(attemptTimeout);
+    lookupsByTimerId.insert(lookup->timerId, lookup);
+}
+
+void QHostInfoResolver::startTcpQuery(Lookup *lookup, Family family)
+{
+    Query &query = lookup->queries[family];
+    if (query.tcpSocket)
+        return;
+
+    // RFC 1035, section 4.2.2: the same message, after its length
+    const NameServer &server = nameServers.at(lookup->attempt % nameServers.size());
+    query.tcpSocket = new QTcpSocket(this);
+    query.tcpSocket->setProperty("_q_queryId", query.id);
+    connect(query.tcpSocket, SIGNAL(readyRead()), this, SLOT(readTcpReply()));
+    query.tcpSocket->connectToHost(server.first, server.second);
+    char length[2];
+    qToBigEndian(quint16(query.message.size()), length);
+    query.tcpSocket->write(length, sizeof(length));
+    query.tcpSocket->write(query.message);
+}
+
+void QHostInfoResolver::readDatagrams()
+{
+    QUdpSocket *socket = qobject_cast<QUdpSocket *>(sender());
+    if (!socket)
+        return;
+    // only the answer to the one query sent from this socket counts
+    const quint16 queryId = quint16(socket->property("_q_queryId").toUInt());
+    while (socket->hasPendingDatagrams()) {
+        const QNetworkDatagram datagram = socket->receiveDatagram();
+        const QByteArray reply = datagram.data();
+        const NameServer from(datagram.senderAddress(), quint16(datagram.senderPort()));
+        if (reply.size() >= headerSize && qFromBigEndian<quint16>(reply.constData()) == queryId
+            && nameServers.contains(from)) {
+            processReply(reply, false);
+        }
+    }
+}
+
+void QHostInfoResolver::readTcpReply()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (!socket)
+        return;
+    Lookup *lookup = lookupsByQueryId.value(quint16(socket->property("_q_queryId").toUInt()));
+    if (!lookup)
+        return;
+    for (Query &query : lookup->queries) {
+        if (query.tcpSocket != socket)
+            continue;
+        query.tcpBuffer += socket->readAll();
+        if (query.tcpBuffer.size() < 2)
+            return;
+        const int length = qFromBigEndian<quint16>(query.tcpBuffer.constData());
+        if (query.tcpBuffer.size() - 2 < length)
+            return;
+        const QByteArray reply = query.tcpBuffer.mid(2, length);
+        query.tcpBuffer.clear();
+        query.tcpSocket = 0;
+        socket->deleteLater();
+        processReply(reply, true);
+        return;
+    }
+}
+
+void QHostInfoResolver::processReply(const QByteArray &reply, bool viaTcp)
+{
+    if (reply.size() < headerSize)
+        return;
+    const quint16 id = qFromBigEndian<quint16>(reply.constData());
+    Lookup *lookup = lookupsByQueryId.value(id);
+    if (!lookup)
+        return;
+    const Family family = lookup->queries[IPv4].id == id ? IPv4 : IPv6;
+    Query &query = lookup->queries[family];
+
+    // a response to exactly the question we asked
+    const uchar flags = uchar(reply.at(2));
+    if (query.done || !(flags & 0x80) || reply.size() < query.message.size()
+        || memcmp(reply.constData() + headerSize, query.message.constData() + headerSize,
+                  query.message.size() - headerSize) != 0) {
+        return;
+    }
+
+    if ((flags & 0x02) && !viaTcp) {
+        // truncated
+        startTcpQuery(lookup, family);
+        return;
+    }
+
+    QDnsLookupReply parsed;
+    QDnsLookupRunnable::parseReply(reinterpret_cast<const uchar *>(reply.constData()), reply.size(), &parsed);
+    if (parsed.error != QDnsLookup::NoError) {
+#if defined(QHOSTINFORESOLVER_DEBUG)
+        qDebug() << "QHostInfoResolver:" << lookup->runnable->toBeLookedUp << parsed.errorString;
+#endif
+        failLookup(lookup);
+        return;
+    }
+
+    // the records of the CNAMEs we went through count as well
+    quint32 ttl = maxTtl;
+    for (const QDnsDomainNameRecord &record : qAsConst(parsed.canonicalNameRecords))
+        ttl = qMin(ttl, record.timeToLive());
+    const QAbstractSocket::NetworkLayerProtocol protocol = family == IPv4
+            ? QAbstractSocket::IPv4Protocol : QAbstractSocket::IPv6Protocol;
+    for (const QDnsHostAddressRecord &record : qAsConst(parsed.hostAddressRecords)) {
+        if (record.value().protocol() != protocol)
+            continue;
+        ttl = qMin(ttl, record.timeToLive());
+        if (!query.addresses.contains(record.value()))
+            query.addresses.append(record.value());
+    }
+    if (!query.addresses.isEmpty())
+        lookup->ttl = qMin(lookup->ttl, ttl);
+    query.done = true;
+
+    checkFinished(lookup);
+}
+
+void QHostInfoResolver::checkFinished(Lookup *lookup)
+{
+    const Query &a = lookup->queries[IPv4];
+    const Query &aaaa = lookup->queries[IPv6];
+    if (a.done && aaaa.done) {
+        if (a.addresses.isEmpty() && aaaa.addresses.isEmpty())
+            failLookup(lookup);
+        else
+            finishLookup(lookup, true);
+    } else if (a.done && !a.addresses.isEmpty()) {
+        // give AAAA a moment to catch up, then go ahead without it
+        lookupsByTimerId.remove(lookup->timerId);
+        killTimer(lookup->timerId);
+        lookup->timerId = startTimer(resolutionDelay);
+        lookupsByTimerId.insert(lookup->timerId, lookup);
+    }
+}
+
+void QHostInfoResolver::timerEvent(QTimerEvent *event)
+{
+    Lookup *lookup = lookupsByTimerId.value(event->timerId());
+    if (!lookup) {
+        killTimer(event->timerId());
+        return;
+    }
+
+    const Query &a = lookup->queries[IPv4];
+    const Query &aaaa = lookup->queries[IPv6];
+    if (!a.addresses.isEmpty() || !aaaa.addresses.isEmpty()) {
+        // one family is enough to connect
+        finishLookup(lookup, false);
+    } else if (++lookup->attempt < attemptsPerServer * nameServers.size()) {
+        sendQueries(lookup);
+    } else {
+        failLookup(lookup);
+    }
+}
+
+void QHostInfoResolver::finishLookup(Lookup *lookup, bool complete)
+{
+    const QList<QHostAddress> &ipv4 = lookup->queries[IPv4].addresses;
+    const QList<QHostAddress> &ipv6 = lookup->queries[IPv6].addresses;
+
+    QHostInfo hostInfo;
+    hostInfo.setHostName(lookup->runnable->toBeLookedUp);
+    if (!ipv6.isEmpty() && isReachable(ipv6.first()))
+        hostInfo.setAddresses(interleave(ipv6, ipv4));
+    else
+        hostInfo.setAddresses(interleave(ipv4, ipv6));
+
+    QHostInfoRunnable *r = lookup->runnable;
+    // a partial answer is good for this lookup, but not for the next one
+    const int ttl = complete ? int(lookup->ttl) : 0;
+    removeLookup(lookup);
+    manager->resolverFinished(r, hostInfo, ttl);
+}
+
+void QHostInfoResolver::failLookup(Lookup *lookup)
+{
+    QHostInfoRunnable *r = lookup->runnable;
+    removeLookup(lookup);
+    manager->resolverFailed(r);
+}
+
+void QHostInfoResolver::removeLookup(Lookup *lookup)
+{
+    for (Query &query : lookup->queries) {
+        if (query.id)
+            lookupsByQueryId.remove(query.id);
+        // we may be in the socket's readyRead()
+        if (query.udpSocket)
+            query.udpSocket->deleteLater();
+        if (query.tcpSocket)
+            query.tcpSocket->deleteLater();
+    }
+    if (lookup->timerId) {
+        lookupsByTimerId.remove(lookup->timerId);
+        killTimer(lookup->timerId);
+    }
+    lookups.removeOne(lookup);
+    delete lookup;
+}
+
+/*
+    Returns an unpredictable query ID that is not in use, or 0 if there is
+    no source of random numbers.
+*/
+quint16 QHostInfoResolver::nextQueryId() const
+{
+    quint16 id;
+    do {
+        if (!systemRandom(&id, sizeof(id)))
+            return 0;
+    } while (!id || lookupsByQueryId.contains(id));
+    return id;
+}
+
+/*
+    Returns a new socket to send \a query to \a server from, bound to a
+    random port, or 0 if none could be opened. With a socket per query, an
+    attacker has to guess the port as well as the query ID.
+*/
+QUdpSocket *QHostInfoResolver::openUdpSocket(const Query &query, const NameServer &server)
+{
+    const QHostAddress any(server.first.protocol() == QAbstractSocket::IPv6Protocol
+                           ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4);
+    QUdpSocket *socket = new QUdpSocket(this);
+    bool bound = false;
+    for (int i = 0; !bound && i < portAttempts; ++i) {
+        quint16 port;
+        if (!systemRandom(&port, sizeof(port)))
+            break;
+        // leave the privileged ports alone
+        port = 1024 + port % (65536 - 1024);
+        bound = socket->bind(any, port, QUdpSocket::DontShareAddress);
+    }
+    // the kernel's choice is still better than no answer
+    if (!bound && !socket->bind(any, 0, QUdpSocket::DontShareAddress)) {
+        delete socket;
+        return 0;
+    }
+    socket->setProperty("_q_queryId", query.id);
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readDatagrams()));
+    return socket;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qhostinforesolver_p.cpp"
+
+#endif // QT_HOSTINFO_RESOLVER
@@ -273,4 +273,57 @@ int QAbstractSocketEngine::outboundStreamCount() const
     return d_func()->outboundStreamCount;
 }
 
+/*!
+    \internal
+
+    Reads up to \a maxCount datagrams into \a buffer, the i-th one at offset
+    i * \a stride and truncated to \a stride bytes. The size and the header
+    fields selected by \a options of each datagram are stored in \a sizes and
+    \a headers, which must have room for \a maxCount entries.
+
+    Returns the number of datagrams read, -2 if none was pending and -1 if an
+    error occurred before the first one could be read. This implementation
+    calls readDatagram() in a loop; engines that can read several datagrams
+    with a single system call reimplement it.
+*/
+int QAbstractSocketEngine::readDatagrams(char *buffer, qint64 stride, int maxCount, qint64 *sizes,
+                                         QIpPacketHeader *headers, PacketHeaderOptions options)
+{
+    int count = 0;
+    while (count < maxCount) {
+#ifndef QT_NO_UDPSOCKET
+        if (!hasPendingDatagrams())
+            break;
+#endif
+        const qint64 readBytes = readDatagram(buffer + count * stride, stride, headers + count, options);
+        if (readBytes < 0)
+            return count ? count : int(readBytes);
+        sizes[count++] = readBytes;
+    }
+    return count ? count : -2;
+}
+
+/*!
+    \internal
+
+    Writes the \a count datagrams in \a datagrams, each to the destination
+    contained in its header. Returns the number of datagrams written, which
+    may be less than \a count if the socket's send buffer filled up, -2 if
+    none could be written without blocking and -1 if an error occurred before
+    the first one was written. This implementation calls writeDatagram() in a
+    loop.
+*/
+int QAbstractSocketEngine::writeDatagrams(const QNetworkDatagramPrivate * const *datagrams, int count)
+{
+    int sent = 0;
+    for ( ; sent < count; ++sent) {
+        const QNetworkDatagramPrivate *datagram = datagrams[sent];
+        const qint64 written = writeDatagram(datagram->data.constData(), datagram->data.size(),
+                                             datagram->header);
+        if (written < 0)
+            return sent ? sent : int(written);
+    }
+    return sent;
+}
+
 QT_END_NAMESPACE
@@ -157,6 +157,9 @@ public:
     virtual qint64 readDatagram(char *data, qint64 maxlen, QIpPacketHeader *header = 0,
                                 PacketHeaderOptions = WantNone) = 0;
     virtual qint64 writeDatagram(const char *data, qint64 len, const QIpPacketHeader &header) = 0;
+    virtual int readDatagrams(char *buffer, qint64 stride, int maxCount, qint64 *sizes,
+                              QIpPacketHeader *headers, PacketHeaderOptions options = WantNone);
+    virtual int writeDatagrams(const QNetworkDatagramPrivate * const *datagrams, int count);
     virtual qint64 bytesToWrite() const = 0;
 
     virtual int option(SocketOption option) const = 0;
@@ -193,7 +193,8 @@ QNativeSocketEnginePrivate::QNativeSocketEnginePrivate() :
     socketDescriptor(-1),
     readNotifier(0),
     writeNotifier(0),
-    exceptNotifier(0)
+    exceptNotifier(0),
+    udpSegmentationUnavailable(false)
 {
 #if defined(Q_OS_WIN) && !defined(Q_OS_WINRT)
     QSysInfo::machineHostName();        // this initializes ws2_32.dll
@@ -902,6 +903,47 @@ qint64 QNativeSocketEngine::writeDatagram(const char *data, qint64 size, const Q
     return d->nativeSendDatagram(data, size, header);
 }
 
+/*!
+    Reads up to \a maxCount datagrams into \a buffer, \a stride bytes
+    apart, and stores their sizes and headers in \a sizes and \a headers.
+    On platforms that support it, all of them are read with a single system
+    call.
+
+    Returns the number of datagrams read, -2 if none was pending, or -1 if
+    an error occurred.
+
+    \sa readDatagram()
+*/
+int QNativeSocketEngine::readDatagrams(char *buffer, qint64 stride, int maxCount, qint64 *sizes,
+                                       QIpPacketHeader *headers, PacketHeaderOptions options)
+{
+    Q_D(QNativeSocketEngine);
+    Q_CHECK_VALID_SOCKETLAYER(QNativeSocketEngine::readDatagrams(), -1);
+    Q_CHECK_STATES(QNativeSocketEngine::readDatagrams(), QAbstractSocket::BoundState,
+                   QAbstractSocket::ConnectedState, -1);
+
+    return d->nativeReceiveDatagrams(buffer, stride, maxCount, sizes, headers, options);
+}
+
+/*!
+    Writes the \a count datagrams in \a datagrams and returns how many of
+    them were written, -2 if the socket could not take any without blocking,
+    or -1 if an error occurred. On platforms that support it, all of them are
+    written with a single system call, and runs of datagrams of the same size
+    going to the same destination are segmented by the kernel.
+
+    \sa writeDatagram()
+*/
+int QNativeSocketEngine::writeDatagrams(const QNetworkDatagramPrivate * const *datagrams, int count)
+{
+    Q_D(QNativeSocketEngine);
+    Q_CHECK_VALID_SOCKETLAYER(QNativeSocketEngine::writeDatagrams(), -1);
+    Q_CHECK_STATES(QNativeSocketEngine::writeDatagrams(), QAbstractSocket::BoundState,
+                   QAbstractSocket::ConnectedState, -1);
+
+    return d->nativeSendDatagrams(datagrams, count);
+}
+
 /*!
     Writes a block of \a size bytes from \a data to the socket.
     Returns the number of bytes written, or -1 if an error occurred.
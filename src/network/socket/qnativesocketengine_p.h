@@ -164,6 +164,9 @@ public:
     qint64 readDatagram(char *data, qint64 maxlen, QIpPacketHeader * = 0,
                         PacketHeaderOptions = WantNone) Q_DECL_OVERRIDE;
     qint64 writeDatagram(const char *data, qint64 len, const QIpPacketHeader &) Q_DECL_OVERRIDE;
+    int readDatagrams(char *buffer, qint64 stride, int maxCount, qint64 *sizes,
+                      QIpPacketHeader *headers, PacketHeaderOptions = WantNone) Q_DECL_OVERRIDE;
+    int writeDatagrams(const QNetworkDatagramPrivate * const *datagrams, int count) Q_DECL_OVERRIDE;
     qint64 bytesToWrite() const Q_DECL_OVERRIDE;
 
     qint64 receiveBufferSize() const;
@@ -210,6 +213,9 @@ public:
 
     QSocketNotifier *readNotifier, *writeNotifier, *exceptNotifier;
 
+    // set once the kernel refused to segment datagrams for this socket
+    bool udpSegmentationUnavailable;
+
 #if defined(Q_OS_WIN)
     LPFN_WSASENDMSG sendmsg;
     LPFN_WSARECVMSG recvmsg;
@@ -275,6 +281,14 @@ public:
     qint64 nativeReceiveDatagram(char *data, qint64 maxLength, QIpPacketHeader *header,
                                  QAbstractSocketEngine::PacketHeaderOptions options);
     qint64 nativeSendDatagram(const char *data, qint64 length, const QIpPacketHeader &header);
+    int nativeReceiveDatagrams(char *buffer, qint64 stride, int maxCount, qint64 *sizes,
+                               QIpPacketHeader *headers,
+                               QAbstractSocketEngine::PacketHeaderOptions options);
+    int nativeSendDatagrams(const QNetworkDatagramPrivate * const *datagrams, int count);
+#ifndef Q_OS_WIN
+    int handleReceiveDatagramError();
+    int handleSendDatagramError();
+#endif
     qint64 nativeRead(char *data, qint64 maxLength);
     qint64 nativeWrite(const char *data, qint64 length);
     int nativeSelect(int timeout, bool selectForRead) const;
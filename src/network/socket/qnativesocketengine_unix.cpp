@@ -68,6 +68,11 @@
 #endif
 
 #include <netinet/tcp.h>
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+// recvmmsg() and sendmmsg()
+#  define QT_HAVE_MMSG
+#  include <netinet/udp.h>
+#endif
 #ifndef QT_NO_SCTP
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -880,11 +885,12 @@ qint64 QNativeSocketEnginePrivate::nativePendingDatagramSize() const
     return qint64(recvResult);
 }
 
-qint64 QNativeSocketEnginePrivate::nativeReceiveDatagram(char *data, qint64 maxSize, QIpPacketHeader *header,
-                                                         QAbstractSocketEngine::PacketHeaderOptions options)
+namespace {
+// Room for the ancillary data we ask for when receiving a datagram and the
+// ancillary data we may pass when sending one; quintptr forces the alignment.
+struct ReceiveControlBuffer
 {
-    // we use quintptr to force the alignment
-    quintptr cbuf[(CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(int))
+    quintptr data[(CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(int))
 #if !defined(IP_PKTINFO) && defined(IP_RECVIF) && defined(Q_OS_BSD4)
                    + CMSG_SPACE(sizeof(sockaddr_dl))
 #endif
@@ -892,158 +898,104 @@ qint64 QNativeSocketEnginePrivate::nativeReceiveDatagram(char *data, qint64 maxS
                    + CMSG_SPACE(sizeof(struct sctp_sndrcvinfo))
 #endif
                    + sizeof(quintptr) - 1) / sizeof(quintptr)];
+};
 
-    struct msghdr msg;
-    struct iovec vec;
-    qt_sockaddr aa;
-    char c;
-    memset(&msg, 0, sizeof(msg));
-    memset(&aa, 0, sizeof(aa));
-
-    // we need to receive at least one byte, even if our user isn't interested in it
-    vec.iov_base = maxSize ? data : &c;
-    vec.iov_len = maxSize ? maxSize : 1;
-    msg.msg_iov = &vec;
-    msg.msg_iovlen = 1;
-    if (options & QAbstractSocketEngine::WantDatagramSender) {
-        msg.msg_name = &aa;
-        msg.msg_namelen = sizeof(aa);
-    }
-    if (options & (QAbstractSocketEngine::WantDatagramHopLimit | QAbstractSocketEngine::WantDatagramDestination
-                   | QAbstractSocketEngine::WantStreamNumber)) {
-        msg.msg_control = cbuf;
-        msg.msg_controllen = sizeof(cbuf);
-    }
-
-    ssize_t recvResult = 0;
-    do {
-        recvResult = ::recvmsg(socketDescriptor, &msg, 0);
-    } while (recvResult == -1 && errno == EINTR);
-
-    if (recvResult == -1) {
-        switch (errno) {
-#if defined(EWOULDBLOCK) && EWOULDBLOCK != EAGAIN
-        case EWOULDBLOCK:
+struct SendControlBuffer
+{
+    quintptr data[(CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(int))
+#ifndef QT_NO_SCTP
+                   + CMSG_SPACE(sizeof(struct sctp_sndrcvinfo))
 #endif
-        case EAGAIN:
-            // No datagram was available for reading
-            recvResult = -2;
-            break;
-        case ECONNREFUSED:
-            setError(QAbstractSocket::ConnectionRefusedError, ConnectionRefusedErrorString);
-            break;
-        default:
-            setError(QAbstractSocket::NetworkError, ReceiveDatagramErrorString);
+#ifdef UDP_SEGMENT
+                   + CMSG_SPACE(sizeof(quint16))
+#endif
+                   + sizeof(quintptr) - 1) / sizeof(quintptr)];
+};
+} // unnamed namespace
+
+/*
+    Fills \a header from the sender address \a aa and the ancillary data of
+    the datagram received in \a msg.
+*/
+static void qt_parsePacketHeader(struct msghdr *msg, const qt_sockaddr *aa, quint16 localPort,
+                                 QIpPacketHeader *header)
+{
+    qt_socket_getPortAndAddress(aa, &header->senderPort, &header->senderAddress);
+    header->destinationPort = localPort;
+    header->endOfRecord = (msg->msg_flags & MSG_EOR) != 0;
+
+    // parse the ancillary data
+    struct cmsghdr *cmsgptr;
+    for (cmsgptr = CMSG_FIRSTHDR(msg); cmsgptr != NULL;
+         cmsgptr = CMSG_NXTHDR(msg, cmsgptr)) {
+        if (cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_PKTINFO
+                && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in6_pktinfo))) {
+            in6_pktinfo *info = reinterpret_cast<in6_pktinfo *>(CMSG_DATA(cmsgptr));
+
+            header->destinationAddress.setAddress(reinterpret_cast<quint8 *>(&info->ipi6_addr));
+            header->ifindex = info->ipi6_ifindex;
+            if (header->ifindex)
+                header->destinationAddress.setScopeId(QString::number(info->ipi6_ifindex));
         }
-        if (header)
-            header->clear();
-    } else if (options != QAbstractSocketEngine::WantNone) {
-        Q_ASSERT(header);
-        qt_socket_getPortAndAddress(&aa, &header->senderPort, &header->senderAddress);
-        header->destinationPort = localPort;
-        header->endOfRecord = (msg.msg_flags & MSG_EOR) != 0;
-
-        // parse the ancillary data
-        struct cmsghdr *cmsgptr;
-        for (cmsgptr = CMSG_FIRSTHDR(&msg); cmsgptr != NULL;
-             cmsgptr = CMSG_NXTHDR(&msg, cmsgptr)) {
-            if (cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_PKTINFO
-                    && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in6_pktinfo))) {
-                in6_pktinfo *info = reinterpret_cast<in6_pktinfo *>(CMSG_DATA(cmsgptr));
-
-                header->destinationAddress.setAddress(reinterpret_cast<quint8 *>(&info->ipi6_addr));
-                header->ifindex = info->ipi6_ifindex;
-                if (header->ifindex)
-                    header->destinationAddress.setScopeId(QString::number(info->ipi6_ifindex));
-            }
 
 #ifdef IP_PKTINFO
-            if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_PKTINFO
-                    && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in_pktinfo))) {
-                in_pktinfo *info = reinterpret_cast<in_pktinfo *>(CMSG_DATA(cmsgptr));
+        if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_PKTINFO
+                && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in_pktinfo))) {
+            in_pktinfo *info = reinterpret_cast<in_pktinfo *>(CMSG_DATA(cmsgptr));
 
-                header->destinationAddress.setAddress(ntohl(info->ipi_addr.s_addr));
-                header->ifindex = info->ipi_ifindex;
-            }
+            header->destinationAddress.setAddress(ntohl(info->ipi_addr.s_addr));
+            header->ifindex = info->ipi_ifindex;
+        }
 #else
 #  ifdef IP_RECVDSTADDR
-            if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_RECVDSTADDR
-                    && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in_addr))) {
-                in_addr *addr = reinterpret_cast<in_addr *>(CMSG_DATA(cmsgptr));
+        if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_RECVDSTADDR
+                && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(in_addr))) {
+            in_addr *addr = reinterpret_cast<in_addr *>(CMSG_DATA(cmsgptr));
 
-                header->destinationAddress.setAddress(ntohl(addr->s_addr));
-            }
+            header->destinationAddress.setAddress(ntohl(addr->s_addr));
+        }
 #  endif
 #  if defined(IP_RECVIF) && defined(Q_OS_BSD4)
-            if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_RECVIF
-                    && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(sockaddr_dl))) {
-                sockaddr_dl *sdl = reinterpret_cast<sockaddr_dl *>(CMSG_DATA(cmsgptr));
-                header->ifindex = sdl->sdl_index;
-            }
+        if (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_RECVIF
+                && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(sockaddr_dl))) {
+            sockaddr_dl *sdl = reinterpret_cast<sockaddr_dl *>(CMSG_DATA(cmsgptr));
+            header->ifindex = sdl->sdl_index;
+        }
 #  endif
 #endif
 
-            if (cmsgptr->cmsg_len == CMSG_LEN(sizeof(int))
-                    && ((cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_HOPLIMIT)
-                        || (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_TTL))) {
-                Q_STATIC_ASSERT(sizeof(header->hopLimit) == sizeof(int));
-                memcpy(&header->hopLimit, CMSG_DATA(cmsgptr), sizeof(header->hopLimit));
-            }
+        if (cmsgptr->cmsg_len == CMSG_LEN(sizeof(int))
+                && ((cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_HOPLIMIT)
+                    || (cmsgptr->cmsg_level == IPPROTO_IP && cmsgptr->cmsg_type == IP_TTL))) {
+            Q_STATIC_ASSERT(sizeof(header->hopLimit) == sizeof(int));
+            memcpy(&header->hopLimit, CMSG_DATA(cmsgptr), sizeof(header->hopLimit));
+        }
 
 #ifndef QT_NO_SCTP
-            if (cmsgptr->cmsg_level == IPPROTO_SCTP && cmsgptr->cmsg_type == SCTP_SNDRCV
-                && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(sctp_sndrcvinfo))) {
-                sctp_sndrcvinfo *rcvInfo = reinterpret_cast<sctp_sndrcvinfo *>(CMSG_DATA(cmsgptr));
+        if (cmsgptr->cmsg_level == IPPROTO_SCTP && cmsgptr->cmsg_type == SCTP_SNDRCV
+            && cmsgptr->cmsg_len >= CMSG_LEN(sizeof(sctp_sndrcvinfo))) {
+            sctp_sndrcvinfo *rcvInfo = reinterpret_cast<sctp_sndrcvinfo *>(CMSG_DATA(cmsgptr));
 
-                header->streamNumber = int(rcvInfo->sinfo_stream);
-            }
-#endif
+            header->streamNumber = int(rcvInfo->sinfo_stream);
         }
-    }
-
-#if defined (QNATIVESOCKETENGINE_DEBUG)
-    qDebug("QNativeSocketEnginePrivate::nativeReceiveDatagram(%p \"%s\", %lli, %s, %i) == %lli",
-           data, qt_prettyDebug(data, qMin(recvResult, ssize_t(16)), recvResult).data(), maxSize,
-           (recvResult != -1 && options != QAbstractSocketEngine::WantNone)
-           ? header->senderAddress.toString().toLatin1().constData() : "(unknown)",
-           (recvResult != -1 && options != QAbstractSocketEngine::WantNone)
-           ? header->senderPort : 0, (qint64) recvResult);
 #endif
-
-    return qint64((maxSize || recvResult < 0) ? recvResult : Q_INT64_C(0));
+    }
 }
 
-qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 len, const QIpPacketHeader &header)
+/*
+    Writes the ancillary data needed to pass the hop limit, source address,
+    interface and stream number in \a header to the kernel into \a buffer and
+    returns its size, which is 0 if none is needed.
+*/
+static size_t qt_writeControlMessages(SendControlBuffer *buffer, const QIpPacketHeader &header,
+                                      bool ipv6)
 {
-    // we use quintptr to force the alignment
-    quintptr cbuf[(CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(int))
-#ifndef QT_NO_SCTP
-                   + CMSG_SPACE(sizeof(struct sctp_sndrcvinfo))
-#endif
-                   + sizeof(quintptr) - 1) / sizeof(quintptr)];
-
-    struct cmsghdr *cmsgptr = reinterpret_cast<struct cmsghdr *>(cbuf);
-    struct msghdr msg;
-    struct iovec vec;
-    qt_sockaddr aa;
+    struct cmsghdr *cmsgptr = reinterpret_cast<struct cmsghdr *>(buffer->data);
+    size_t length = 0;
 
-    memset(&msg, 0, sizeof(msg));
-    memset(&aa, 0, sizeof(aa));
-    vec.iov_base = const_cast<char *>(data);
-    vec.iov_len = len;
-    msg.msg_iov = &vec;
-    msg.msg_iovlen = 1;
-    msg.msg_control = &cbuf;
-
-    if (header.destinationPort != 0) {
-        msg.msg_name = &aa.a;
-        setPortAndAddress(header.destinationPort, header.destinationAddress,
-                          &aa, &msg.msg_namelen);
-    }
-
-    if (msg.msg_namelen == sizeof(aa.a6)) {
+    if (ipv6) {
         if (header.hopLimit != -1) {
-            msg.msg_controllen += CMSG_SPACE(sizeof(int));
+            length += CMSG_SPACE(sizeof(int));
             cmsgptr->cmsg_len = CMSG_LEN(sizeof(int));
             cmsgptr->cmsg_level = IPPROTO_IPV6;
             cmsgptr->cmsg_type = IPV6_HOPLIMIT;
@@ -1053,7 +1005,7 @@ qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 l
         if (header.ifindex != 0 || !header.senderAddress.isNull()) {
             struct in6_pktinfo *data = reinterpret_cast<in6_pktinfo *>(CMSG_DATA(cmsgptr));
             memset(data, 0, sizeof(*data));
-            msg.msg_controllen += CMSG_SPACE(sizeof(*data));
+            length += CMSG_SPACE(sizeof(*data));
             cmsgptr->cmsg_len = CMSG_LEN(sizeof(*data));
             cmsgptr->cmsg_level = IPPROTO_IPV6;
             cmsgptr->cmsg_type = IPV6_PKTINFO;
@@ -1065,7 +1017,7 @@ qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 l
         }
     } else {
         if (header.hopLimit != -1) {
-            msg.msg_controllen += CMSG_SPACE(sizeof(int));
+            length += CMSG_SPACE(sizeof(int));
             cmsgptr->cmsg_len = CMSG_LEN(sizeof(int));
             cmsgptr->cmsg_level = IPPROTO_IP;
             cmsgptr->cmsg_type = IP_TTL;
@@ -1087,7 +1039,7 @@ qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 l
             data->s_addr = htonl(header.senderAddress.toIPv4Address());
 #  endif
             cmsgptr->cmsg_level = IPPROTO_IP;
-            msg.msg_controllen += CMSG_SPACE(sizeof(*data));
+            length += CMSG_SPACE(sizeof(*data));
             cmsgptr->cmsg_len = CMSG_LEN(sizeof(*data));
             cmsgptr = reinterpret_cast<cmsghdr *>(reinterpret_cast<char *>(cmsgptr) + CMSG_SPACE(sizeof(*data)));
         }
@@ -1098,38 +1050,142 @@ qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 l
     if (header.streamNumber != -1) {
         struct sctp_sndrcvinfo *data = reinterpret_cast<sctp_sndrcvinfo *>(CMSG_DATA(cmsgptr));
         memset(data, 0, sizeof(*data));
-        msg.msg_controllen += CMSG_SPACE(sizeof(sctp_sndrcvinfo));
+        length += CMSG_SPACE(sizeof(sctp_sndrcvinfo));
         cmsgptr->cmsg_len = CMSG_LEN(sizeof(sctp_sndrcvinfo));
         cmsgptr->cmsg_level = IPPROTO_SCTP;
         cmsgptr->cmsg_type =  SCTP_SNDRCV;
         data->sinfo_stream = uint16_t(header.streamNumber);
-        cmsgptr = reinterpret_cast<cmsghdr *>(reinterpret_cast<char *>(cmsgptr) + CMSG_SPACE(sizeof(*data)));
     }
 #endif
 
-    if (msg.msg_controllen == 0)
-        msg.msg_control = 0;
-    ssize_t sentBytes = qt_safe_sendmsg(socketDescriptor, &msg, 0);
+    return length;
+}
 
-    if (sentBytes < 0) {
-        switch (errno) {
+qint64 QNativeSocketEnginePrivate::nativeReceiveDatagram(char *data, qint64 maxSize, QIpPacketHeader *header,
+                                                         QAbstractSocketEngine::PacketHeaderOptions options)
+{
+    ReceiveControlBuffer cbuf;
+    struct msghdr msg;
+    struct iovec vec;
+    qt_sockaddr aa;
+    char c;
+    memset(&msg, 0, sizeof(msg));
+    memset(&aa, 0, sizeof(aa));
+
+    // we need to receive at least one byte, even if our user isn't interested in it
+    vec.iov_base = maxSize ? data : &c;
+    vec.iov_len = maxSize ? maxSize : 1;
+    msg.msg_iov = &vec;
+    msg.msg_iovlen = 1;
+    if (options & QAbstractSocketEngine::WantDatagramSender) {
+        msg.msg_name = &aa;
+        msg.msg_namelen = sizeof(aa);
+    }
+    if (options & (QAbstractSocketEngine::WantDatagramHopLimit | QAbstractSocketEngine::WantDatagramDestination
+                   | QAbstractSocketEngine::WantStreamNumber)) {
+        msg.msg_control = cbuf.data;
+        msg.msg_controllen = sizeof(cbuf.data);
+    }
+
+    ssize_t recvResult = 0;
+    do {
+        recvResult = ::recvmsg(socketDescriptor, &msg, 0);
+    } while (recvResult == -1 && errno == EINTR);
+
+    if (recvResult == -1) {
+        recvResult = handleReceiveDatagramError();
+        if (header)
+            header->clear();
+    } else if (options != QAbstractSocketEngine::WantNone) {
+        Q_ASSERT(header);
+        qt_parsePacketHeader(&msg, &aa, localPort, header);
+    }
+
+#if defined (QNATIVESOCKETENGINE_DEBUG)
+    qDebug("QNativeSocketEnginePrivate::nativeReceiveDatagram(%p \"%s\", %lli, %s, %i) == %lli",
+           data, qt_prettyDebug(data, qMin(recvResult, ssize_t(16)), recvResult).data(), maxSize,
+           (recvResult != -1 && options != QAbstractSocketEngine::WantNone)
+           ? header->senderAddress.toString().toLatin1().constData() : "(unknown)",
+           (recvResult != -1 && options != QAbstractSocketEngine::WantNone)
+           ? header->senderPort : 0, (qint64) recvResult);
+#endif
+
+    return qint64((maxSize || recvResult < 0) ? recvResult : Q_INT64_C(0));
+}
+
+/*
+    Maps errno after a failed receive to the socket error, and returns -2 if
+    there simply was no datagram to read or -1 otherwise.
+*/
+int QNativeSocketEnginePrivate::handleReceiveDatagramError()
+{
+    switch (errno) {
 #if defined(EWOULDBLOCK) && EWOULDBLOCK != EAGAIN
-        case EWOULDBLOCK:
+    case EWOULDBLOCK:
 #endif
-        case EAGAIN:
-            sentBytes = -2;
-            break;
-        case EMSGSIZE:
-            setError(QAbstractSocket::DatagramTooLargeError, DatagramTooLargeErrorString);
-            break;
-        case ECONNRESET:
-            setError(QAbstractSocket::RemoteHostClosedError, RemoteHostClosedErrorString);
-            break;
-        default:
-            setError(QAbstractSocket::NetworkError, SendDatagramErrorString);
-        }
+    case EAGAIN:
+        // No datagram was available for reading
+        return -2;
+    case ECONNREFUSED:
+        setError(QAbstractSocket::ConnectionRefusedError, ConnectionRefusedErrorString);
+        break;
+    default:
+        setError(QAbstractSocket::NetworkError, ReceiveDatagramErrorString);
+    }
+    return -1;
+}
+
+/*
+    Same as handleReceiveDatagramError(), for a failed send.
+*/
+int QNativeSocketEnginePrivate::handleSendDatagramError()
+{
+    switch (errno) {
+#if defined(EWOULDBLOCK) && EWOULDBLOCK != EAGAIN
+    case EWOULDBLOCK:
+#endif
+    case EAGAIN:
+        return -2;
+    case EMSGSIZE:
+        setError(QAbstractSocket::DatagramTooLargeError, DatagramTooLargeErrorString);
+        break;
+    case ECONNRESET:
+        setError(QAbstractSocket::RemoteHostClosedError, RemoteHostClosedErrorString);
+        break;
+    default:
+        setError(QAbstractSocket::NetworkError, SendDatagramErrorString);
+    }
+    return -1;
+}
+
+qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 len, const QIpPacketHeader &header)
+{
+    SendControlBuffer cbuf;
+    struct msghdr msg;
+    struct iovec vec;
+    qt_sockaddr aa;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(&aa, 0, sizeof(aa));
+    vec.iov_base = const_cast<char *>(data);
+    vec.iov_len = len;
+    msg.msg_iov = &vec;
+    msg.msg_iovlen = 1;
+
+    if (header.destinationPort != 0) {
+        msg.msg_name = &aa.a;
+        setPortAndAddress(header.destinationPort, header.destinationAddress,
+                          &aa, &msg.msg_namelen);
     }
 
+    msg.msg_controllen = qt_writeControlMessages(&cbuf, header, msg.msg_namelen == sizeof(aa.a6));
+    if (msg.msg_controllen != 0)
+        msg.msg_control = cbuf.data;
+    ssize_t sentBytes = qt_safe_sendmsg(socketDescriptor, &msg, 0);
+
+    if (sentBytes < 0)
+        sentBytes = handleSendDatagramError();
+
 #if defined (QNATIVESOCKETENGINE_DEBUG)
     qDebug("QNativeSocketEngine::sendDatagram(%p \"%s\", %lli, \"%s\", %i) == %lli", data,
            qt_prettyDebug(data, qMin<int>(len, 16), len).data(), len,
@@ -1140,6 +1196,197 @@ qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 l
     return qint64(sentBytes);
 }
 
+int QNativeSocketEnginePrivate::nativeReceiveDatagrams(char *buffer, qint64 stride, int maxCount,
+                                                       qint64 *sizes, QIpPacketHeader *headers,
+                                                       QAbstractSocketEngine::PacketHeaderOptions options)
+{
+#ifdef QT_HAVE_MMSG
+    const bool wantControl = options & (QAbstractSocketEngine::WantDatagramHopLimit
+                                        | QAbstractSocketEngine::WantDatagramDestination
+                                        | QAbstractSocketEngine::WantStreamNumber);
+    QVarLengthArray<struct mmsghdr, 64> msgs(maxCount);
+    QVarLengthArray<struct iovec, 64> vecs(maxCount);
+    QVarLengthArray<qt_sockaddr, 64> addresses(options & QAbstractSocketEngine::WantDatagramSender
+                                               ? maxCount : 0);
+    QVarLengthArray<ReceiveControlBuffer, 64> cbufs(wantControl ? maxCount : 0);
+    char c;
+
+    memset(msgs.data(), 0, maxCount * sizeof(struct mmsghdr));
+    for (int i = 0; i < maxCount; ++i) {
+        struct msghdr &msg = msgs[i].msg_hdr;
+        // we need to receive at least one byte, even if our user isn't interested in it
+        vecs[i].iov_base = stride ? buffer + i * stride : &c;
+        vecs[i].iov_len = stride ? stride : 1;
+        msg.msg_iov = &vecs[i];
+        msg.msg_iovlen = 1;
+        if (!addresses.isEmpty()) {
+            memset(&addresses[i], 0, sizeof(qt_sockaddr));
+            msg.msg_name = &addresses[i];
+            msg.msg_namelen = sizeof(qt_sockaddr);
+        }
+        if (wantControl) {
+            msg.msg_control = cbufs[i].data;
+            msg.msg_controllen = sizeof(cbufs[i].data);
+        }
+    }
+
+    int received;
+    EINTR_LOOP(received, ::recvmmsg(socketDescriptor, msgs.data(), maxCount, 0, 0));
+    if (received < 0)
+        return handleReceiveDatagramError();
+
+    for (int i = 0; i < received; ++i) {
+        sizes[i] = stride ? qint64(msgs[i].msg_len) : 0;
+        if (options != QAbstractSocketEngine::WantNone) {
+            qt_sockaddr unknown;
+            if (addresses.isEmpty())
+                memset(&unknown, 0, sizeof(unknown));
+            qt_parsePacketHeader(&msgs[i].msg_hdr, addresses.isEmpty() ? &unknown : &addresses[i],
+                                 localPort, &headers[i]);
+        }
+    }
+
+#if defined (QNATIVESOCKETENGINE_DEBUG)
+    qDebug("QNativeSocketEnginePrivate::nativeReceiveDatagrams(%p, %lli, %i) == %i",
+           buffer, stride, maxCount, received);
+#endif
+
+    return received;
+#else
+    int count = 0;
+    for ( ; count < maxCount; ++count) {
+        const qint64 readBytes = nativeReceiveDatagram(buffer + count * stride, stride,
+                                                       headers + count, options);
+        if (readBytes < 0)
+            return count ? count : int(readBytes);
+        sizes[count] = readBytes;
+    }
+    return count;
+#endif
+}
+
+#if defined(QT_HAVE_MMSG) && defined(UDP_SEGMENT)
+static bool qt_canSegment(const QIpPacketHeader &header)
+{
+    return header.hopLimit == -1 && header.ifindex == 0 && header.senderAddress.isNull()
+            && header.streamNumber == -1;
+}
+#endif
+
+int QNativeSocketEnginePrivate::nativeSendDatagrams(const QNetworkDatagramPrivate * const *datagrams,
+                                                    int count)
+{
+#ifdef QT_HAVE_MMSG
+    QVarLengthArray<struct mmsghdr, 64> msgs(count);
+    QVarLengthArray<struct iovec, 64> vecs(count);
+    QVarLengthArray<qt_sockaddr, 64> addresses(count);
+    QVarLengthArray<SendControlBuffer, 64> cbufs(count);
+    // index of the first datagram carried by each message
+    QVarLengthArray<int, 64> firstDatagram(count + 1);
+#  ifdef UDP_SEGMENT
+    bool segment = !udpSegmentationUnavailable;
+#  endif
+
+    for (;;) {
+        int messageCount = 0;
+        for (int i = 0; i < count; ++messageCount) {
+            const QIpPacketHeader &header = datagrams[i]->header;
+            const QByteArray &data = datagrams[i]->data;
+            struct msghdr &msg = msgs[messageCount].msg_hdr;
+            memset(&msgs[messageCount], 0, sizeof(struct mmsghdr));
+            vecs[i].iov_base = const_cast<char *>(data.constData());
+            vecs[i].iov_len = data.size();
+            msg.msg_iov = &vecs[i];
+            msg.msg_iovlen = 1;
+
+            if (header.destinationPort != 0) {
+                msg.msg_name = &addresses[messageCount].a;
+                setPortAndAddress(header.destinationPort, header.destinationAddress,
+                                  &addresses[messageCount], &msg.msg_namelen);
+            }
+            msg.msg_controllen = qt_writeControlMessages(&cbufs[messageCount], header,
+                                                         msg.msg_namelen == sizeof(qt_sockaddr::a6));
+            firstDatagram[messageCount] = i++;
+
+#  ifdef UDP_SEGMENT
+            // Hand a run of datagrams of the same size going to the same
+            // destination to the kernel as one message, and let it (or the
+            // network card) cut it into datagrams again. Only the last
+            // datagram of the run may be shorter.
+            enum { MaxSegments = 64, MaxPayload = 65507 };
+            const int segmentSize = data.size();
+            int payload = segmentSize;
+            if (segment && msg.msg_controllen == 0 && segmentSize > 0) {
+                while (i < count && int(msg.msg_iovlen) < MaxSegments) {
+                    const QNetworkDatagramPrivate *next = datagrams[i];
+                    const int size = next->data.size();
+                    if (size == 0 || size > segmentSize || payload + size > MaxPayload
+                            || next->header.destinationPort != header.destinationPort
+                            || next->header.destinationAddress != header.destinationAddress
+                            || !qt_canSegment(next->header)) {
+                        break;
+                    }
+                    vecs[i].iov_base = const_cast<char *>(next->data.constData());
+                    vecs[i].iov_len = size;
+                    ++msg.msg_iovlen;
+                    payload += size;
+                    ++i;
+                    if (size < segmentSize)
+                        break;
+                }
+            }
+            if (msg.msg_iovlen > 1) {
+                struct cmsghdr *cmsgptr = reinterpret_cast<struct cmsghdr *>(cbufs[messageCount].data);
+                const quint16 gsoSize = quint16(segmentSize);
+                cmsgptr->cmsg_len = CMSG_LEN(sizeof(gsoSize));
+                cmsgptr->cmsg_level = SOL_UDP;
+                cmsgptr->cmsg_type = UDP_SEGMENT;
+                memcpy(CMSG_DATA(cmsgptr), &gsoSize, sizeof(gsoSize));
+                msg.msg_controllen = CMSG_SPACE(sizeof(gsoSize));
+            }
+#  endif
+            if (msg.msg_controllen != 0)
+                msg.msg_control = cbufs[messageCount].data;
+        }
+        firstDatagram[messageCount] = count;
+
+        int sent;
+        EINTR_LOOP(sent, ::sendmmsg(socketDescriptor, msgs.data(), messageCount, MSG_NOSIGNAL));
+        if (sent >= 0) {
+#  if defined (QNATIVESOCKETENGINE_DEBUG)
+            qDebug("QNativeSocketEnginePrivate::nativeSendDatagrams(%p, %i) == %i",
+                   datagrams, count, firstDatagram[sent]);
+#  endif
+            return firstDatagram[sent];
+        }
+
+#  ifdef UDP_SEGMENT
+        // The first message was segmented and the kernel refused: EIO means
+        // the outgoing device cannot checksum segmented datagrams, so stop
+        // trying on this socket; EINVAL means the segments do not fit the
+        // path MTU, so just send this batch one datagram at a time.
+        if (segment && msgs[0].msg_hdr.msg_iovlen > 1 && (errno == EIO || errno == EINVAL)) {
+            if (errno == EIO)
+                udpSegmentationUnavailable = true;
+            segment = false;
+            continue;
+        }
+#  endif
+        return handleSendDatagramError();
+    }
+#else
+    int sent = 0;
+    for ( ; sent < count; ++sent) {
+        const QNetworkDatagramPrivate *datagram = datagrams[sent];
+        const qint64 written = nativeSendDatagram(datagram->data.constData(), datagram->data.size(),
+                                                  datagram->header);
+        if (written < 0)
+            return sent ? sent : int(written);
+    }
+    return sent;
+#endif
+}
+
 bool QNativeSocketEnginePrivate::fetchConnectionParameters()
 {
     localPort = 0;
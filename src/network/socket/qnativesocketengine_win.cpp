@@ -1403,6 +1403,37 @@ qint64 QNativeSocketEnginePrivate::nativeSendDatagram(const char *data, qint64 l
 }
 
 
+int QNativeSocketEnginePrivate::nativeReceiveDatagrams(char *buffer, qint64 stride, int maxCount,
+                                                       qint64 *sizes, QIpPacketHeader *headers,
+                                                       QAbstractSocketEngine::PacketHeaderOptions options)
+{
+    // Winsock has no batched receive; read one datagram at a time
+    int count = 0;
+    for ( ; count < maxCount && nativeHasPendingDatagrams(); ++count) {
+        const qint64 readBytes = nativeReceiveDatagram(buffer + count * stride, stride,
+                                                       headers + count, options);
+        if (readBytes < 0)
+            return count ? count : -1;
+        sizes[count] = readBytes;
+    }
+    return count ? count : -2;
+}
+
+int QNativeSocketEnginePrivate::nativeSendDatagrams(const QNetworkDatagramPrivate * const *datagrams,
+                                                    int count)
+{
+    int sent = 0;
+    for ( ; sent < count; ++sent) {
+        const QNetworkDatagramPrivate *datagram = datagrams[sent];
+        const qint64 written = nativeSendDatagram(datagram->data.constData(), datagram->data.size(),
+                                                  datagram->header);
+        if (written < 0)
+            return sent ? sent : int(written);
+    }
+    return sent;
+}
+
+
 qint64 QNativeSocketEnginePrivate::nativeWrite(const char *data, qint64 len)
 {
     Q_Q(QNativeSocketEngine);
@@ -101,7 +101,10 @@
 #include "qhostaddress.h"
 #include "qnetworkdatagram.h"
 #include "qnetworkinterface.h"
+#include "qvarlengtharray.h"
+#include "qvector.h"
 #include "qabstractsocket_p.h"
+#include <private/qtools_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -125,6 +128,10 @@ public:
 
     inline bool ensureInitialized(const QHostAddress &remoteAddress)
     { return doEnsureInitialized(QHostAddress(), 0, remoteAddress); }
+
+    // reused by receiveDatagrams()
+    QByteArray receiveBuffer;
+    QVector<QIpPacketHeader> receiveHeaders;
 };
 
 bool QUdpSocketPrivate::doEnsureInitialized(const QHostAddress &bindAddress, quint16 bindPort,
@@ -420,6 +427,70 @@ qint64 QUdpSocket::writeDatagram(const QNetworkDatagram &datagram)
     return sent;
 }
 
+/*!
+    \since 5.10
+
+    Sends the datagrams in \a datagrams, each to the host address and port
+    and with the options contained in it, just like writeDatagram() would.
+    Returns the number of datagrams sent, or -1 if an error occurred before
+    the first one could be sent. If the socket's send buffer fills up, fewer
+    datagrams than were passed may be sent; the rest can be passed again once
+    bytesWritten() has been emitted.
+
+    On Linux, all the datagrams are handed to the kernel with a single system
+    call, and consecutive datagrams of the same size going to the same
+    destination are sent with UDP segmentation offload where the kernel and
+    the network device support it.
+
+    The bytesWritten() signal is emitted once, with the total size of the
+    datagrams that were sent.
+
+    \sa writeDatagram(), receiveDatagrams()
+*/
+int QUdpSocket::writeDatagrams(const QVector<QNetworkDatagram> &datagrams)
+{
+    Q_D(QUdpSocket);
+#if defined QUDPSOCKET_DEBUG
+    qDebug("QUdpSocket::writeDatagrams(%d)", datagrams.size());
+#endif
+    if (datagrams.isEmpty())
+        return 0;
+
+    // the socket has to reach the destinations of all datagrams, not just
+    // that of the first one
+    QHostAddress remoteAddress = datagrams.first().destinationAddress();
+    for (const QNetworkDatagram &datagram : datagrams) {
+        if (datagram.destinationAddress().protocol() != remoteAddress.protocol()) {
+            remoteAddress = QHostAddress::Any;
+            break;
+        }
+    }
+    if (!d->doEnsureInitialized(QHostAddress::Any, 0, remoteAddress))
+        return -1;
+    if (state() == UnconnectedState)
+        bind();
+
+    QVarLengthArray<const QNetworkDatagramPrivate *, 64> privates(datagrams.size());
+    for (int i = 0; i < datagrams.size(); ++i)
+        privates[i] = datagrams.at(i).d;
+
+    int sent = d->socketEngine->writeDatagrams(privates.constData(), privates.size());
+    d->cachedSocketDescriptor = d->socketEngine->socketDescriptor();
+
+    if (sent == -2) {
+        // the send buffer is full; try again after bytesWritten()
+        sent = 0;
+    } else if (sent < 0) {
+        d->setErrorAndEmit(d->socketEngine->error(), d->socketEngine->errorString());
+    } else {
+        qint64 bytes = 0;
+        for (int i = 0; i < sent; ++i)
+            bytes += privates[i]->data.size();
+        emit bytesWritten(bytes);
+    }
+    return sent;
+}
+
 /*!
     Receives a datagram no larger than \a maxSize bytes and returns it in the
     QNetworkDatagram object, along with the sender's host address and port. If
@@ -461,6 +532,75 @@ QNetworkDatagram QUdpSocket::receiveDatagram(qint64 maxSize)
     return result;
 }
 
+/*!
+    \since 5.10
+
+    Receives up to \a maxCount datagrams that are already pending on the
+    socket, each no larger than \a maxSize bytes, and returns them along with
+    their sender's host address and port and, where possible, their
+    destination address, port and hop count. Returns an empty list if no
+    datagram was pending or an error occurred.
+
+    Unlike calling receiveDatagram() in a loop, this function reads all the
+    datagrams with as few system calls as the platform allows (on Linux, a
+    single one) into a buffer that the socket keeps between calls, so the only
+    allocations left are those for the returned datagrams themselves.
+
+    If a datagram is larger than \a maxSize bytes, the rest of it is lost. If
+    \a maxSize is -1 (the default), datagrams of up to 65536 bytes are read in
+    full. The socket's buffer is \a maxCount times \a maxSize bytes large, so
+    pass a smaller \a maxSize when the largest datagram you expect is known.
+
+    \sa receiveDatagram(), writeDatagrams(), hasPendingDatagrams()
+*/
+QVector<QNetworkDatagram> QUdpSocket::receiveDatagrams(int maxCount, qint64 maxSize)
+{
+    Q_D(QUdpSocket);
+
+#if defined QUDPSOCKET_DEBUG
+    qDebug("QUdpSocket::receiveDatagrams(%d, %lld)", maxCount, maxSize);
+#endif
+    QT_CHECK_BOUND("QUdpSocket::receiveDatagrams()", QVector<QNetworkDatagram>());
+
+    QVector<QNetworkDatagram> result;
+    if (maxCount <= 0)
+        return result;
+    if (maxSize < 0)
+        maxSize = 65536;
+    if (maxSize > (MaxAllocSize - qint64(sizeof(QArrayData))) / maxCount) {
+        qWarning("QUdpSocket::receiveDatagrams: %d datagrams of %lld bytes do not fit in memory",
+                 maxCount, maxSize);
+        return result;
+    }
+
+    const qint64 bufferSize = maxSize ? maxSize * maxCount : 1;
+    if (d->receiveBuffer.size() < bufferSize)
+        d->receiveBuffer.resize(int(bufferSize));
+    if (d->receiveHeaders.size() < maxCount)
+        d->receiveHeaders.resize(maxCount);
+    QVarLengthArray<qint64, 64> sizes(maxCount);
+
+    const int count = d->socketEngine->readDatagrams(d->receiveBuffer.data(), maxSize, maxCount,
+                                                     sizes.data(), d->receiveHeaders.data(),
+                                                     QAbstractSocketEngine::WantAll);
+    d->hasPendingData = false;
+    d->socketEngine->setReadNotificationEnabled(true);
+    if (count == -1) {
+        d->setErrorAndEmit(d->socketEngine->error(), d->socketEngine->errorString());
+        return result;
+    }
+
+    result.reserve(qMax(count, 0));
+    const char *data = d->receiveBuffer.constData();
+    for (int i = 0; i < count; ++i, data += maxSize) {
+        QIpPacketHeader &header = d->receiveHeaders[i];
+        result.append(QNetworkDatagram(*new QNetworkDatagramPrivate(QByteArray(data, int(sizes[i])),
+                                                                    header)));
+        header.clear();
+    }
+    return result;
+}
+
 /*!
     Receives a datagram no larger than \a maxSize bytes and stores
     it in \a data. The sender's host address and port is stored in
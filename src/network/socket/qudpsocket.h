@@ -75,9 +75,11 @@ public:
     bool hasPendingDatagrams() const;
     qint64 pendingDatagramSize() const;
     QNetworkDatagram receiveDatagram(qint64 maxSize = -1);
+    QVector<QNetworkDatagram> receiveDatagrams(int maxCount, qint64 maxSize = -1);
     qint64 readDatagram(char *data, qint64 maxlen, QHostAddress *host = Q_NULLPTR, quint16 *port = Q_NULLPTR);
 
     qint64 writeDatagram(const QNetworkDatagram &datagram);
+    int writeDatagrams(const QVector<QNetworkDatagram> &datagrams);
     qint64 writeDatagram(const char *data, qint64 len, const QHostAddress &host, quint16 port);
     inline qint64 writeDatagram(const QByteArray &datagram, const QHostAddress &host, quint16 port)
         { return writeDatagram(datagram.constData(), datagram.size(), host, port); }
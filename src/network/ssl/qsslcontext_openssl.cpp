@@ -50,9 +50,38 @@
 #include "private/qsslsocket_openssl_p.h"
 #include "private/qsslsocket_openssl_symbols_p.h"
 #include "private/qssldiffiehellmanparameters_p.h"
+#include "private/qsslsessioncache_openssl_p.h"
+
+#include <QtCore/qcache.h>
+#include <QtCore/qcryptographichash.h>
 
 QT_BEGIN_NAMESPACE
 
+namespace {
+// Contexts only differ in the configuration they were made from, so a
+// handful covers what a process talks to
+const int maxCachedContexts = 32;
+
+struct QSslContextCache
+{
+    QSslContextCache() : contexts(maxCachedContexts) {}
+
+    QMutex mutex;
+    QCache<QByteArray, QSharedPointer<QSslContext> > contexts;
+};
+}
+
+Q_GLOBAL_STATIC(QSslContextCache, globalContextCache)
+
+static void addCertificateDigest(QCryptographicHash *hash, const QSslCertificate &certificate)
+{
+    // Much cheaper than toDer(), which encodes the certificate anew
+    if (X509 * const x509 = reinterpret_cast<X509 *>(certificate.handle())) {
+        (void)q_X509_cmp(x509, x509); // populate x509->sha1_hash
+        hash->addData(reinterpret_cast<const char *>(x509->sha1_hash), SHA_DIGEST_LENGTH);
+    }
+}
+
 // defined in qsslsocket_openssl.cpp:
 extern int q_X509Callback(int ok, X509_STORE_CTX *ctx);
 extern QString getErrorsFromOpenSsl();
@@ -61,7 +90,8 @@ QSslContext::QSslContext()
     : ctx(0),
     pkey(0),
     session(0),
-    m_sessionTicketLifeTimeHint(-1)
+    m_sessionTicketLifeTimeHint(-1),
+    m_cached(false)
 {
 }
 
@@ -306,6 +336,15 @@ init_context:
     if (sslContext->sslConfiguration.peerVerifyDepth() != 0)
         q_SSL_CTX_set_verify_depth(sslContext->ctx, sslContext->sslConfiguration.peerVerifyDepth());
 
+    // Share sessions with the other sockets through the process-wide cache
+    if (!configuration.testSslOption(QSsl::SslOptionDisableSessionSharing)) {
+        sslContext->m_configurationDigest = computeConfigurationDigest(sslContext->sslConfiguration);
+        if (!client) {
+            QSslSessionCache::instance()->setupServerContext(sslContext->ctx, sslContext->m_configurationDigest,
+                                                             !configuration.testSslOption(QSsl::SslOptionDisableSessionTickets));
+        }
+    }
+
     // set persisted session if the user set it
     if (!configuration.sessionTicket().isEmpty())
         sslContext->setSessionASN1(configuration.sessionTicket());
@@ -387,6 +426,42 @@ QSharedPointer<QSslContext> QSslContext::sharedFromConfiguration(QSslSocket::Ssl
     return sslContext;
 }
 
+QSharedPointer<QSslContext> QSslContext::cachedFromConfiguration(QSslSocket::SslMode mode, const QSslConfiguration &configuration, bool allowRootCertOnDemandLoading)
+{
+    const QByteArray key = computeContextCacheKey(mode, configuration, allowRootCertOnDemandLoading);
+    if (key.isEmpty())
+        return sharedFromConfiguration(mode, configuration, allowRootCertOnDemandLoading);
+
+    QSslContextCache *cache = globalContextCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        if (QSharedPointer<QSslContext> *sslContext = cache->contexts.object(key))
+            return *sslContext;
+    }
+
+    // Loading the certificates is the expensive part, don't block the
+    // other threads meanwhile; if two of them race, one context wins.
+    QSharedPointer<QSslContext> sslContext = sharedFromConfiguration(mode, configuration, allowRootCertOnDemandLoading);
+    if (sslContext->error() != QSslError::NoError)
+        return sslContext;
+    sslContext->m_cached = true;
+
+    QMutexLocker locker(&cache->mutex);
+    if (QSharedPointer<QSslContext> *cached = cache->contexts.object(key))
+        return *cached;
+    cache->contexts.insert(key, new QSharedPointer<QSslContext>(sslContext));
+    return sslContext;
+}
+
+void QSslContext::clearContextCache()
+{
+    QSslContextCache *cache = globalContextCache();
+    if (!cache)
+        return;
+    QMutexLocker locker(&cache->mutex);
+    cache->contexts.clear();
+}
+
 #if OPENSSL_VERSION_NUMBER >= 0x1000100fL && !defined(OPENSSL_NO_NEXTPROTONEG)
 
 static int next_proto_cb(SSL *, unsigned char **out, unsigned char *outlen,
@@ -530,6 +605,72 @@ int QSslContext::sessionTicketLifeTimeHint() const
     return m_sessionTicketLifeTimeHint;
 }
 
+QByteArray QSslContext::configurationDigest() const
+{
+    return m_configurationDigest;
+}
+
+bool QSslContext::isCached() const
+{
+    return m_cached;
+}
+
+QByteArray QSslContext::computeConfigurationDigest(const QSslConfiguration &configuration)
+{
+    // Everything that decides whether we trust the peer or what the peer
+    // learns about us: a session must not be resumed with a configuration
+    // that would not have accepted the full handshake.
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArray::number(int(configuration.protocol())) + ' '
+                 + QByteArray::number(int(configuration.peerVerifyMode())) + ' '
+                 + QByteArray::number(configuration.peerVerifyDepth()) + ' '
+                 + QByteArray::number(int(configuration.d->sslOptions)));
+    QList<QSslCipher> ciphers = configuration.ciphers();
+    if (ciphers.isEmpty())
+        ciphers = QSslSocketPrivate::defaultCiphers();
+    for (const QSslCipher &cipher : qAsConst(ciphers))
+        hash.addData(cipher.name().toLatin1() + ':');
+    const QList<QSslCertificate> caCertificates = configuration.caCertificates();
+    for (const QSslCertificate &certificate : caCertificates)
+        addCertificateDigest(&hash, certificate);
+    addCertificateDigest(&hash, configuration.localCertificate());
+    const QList<QByteArray> protocols = configuration.allowedNextProtocols();
+    for (const QByteArray &protocol : protocols)
+        hash.addData(protocol + ',');
+    return hash.result();
+}
+
+// Empty if a context made from the configuration cannot be shared
+// between sockets: ours keep the session they negotiated and the state of
+// protocol negotiation, so persisted sessions and NPN/ALPN rule it out.
+QByteArray QSslContext::computeContextCacheKey(QSslSocket::SslMode mode, const QSslConfiguration &configuration,
+                                               bool allowRootCertOnDemandLoading)
+{
+    if (!configuration.testSslOption(QSsl::SslOptionDisableSessionPersistence)
+        || !configuration.sessionTicket().isEmpty()
+        || !configuration.allowedNextProtocols().isEmpty()
+        || (!configuration.d->privateKey.isNull()
+            && configuration.d->privateKey.algorithm() == QSsl::Opaque)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(computeConfigurationDigest(configuration));
+    hash.addData(QByteArray::number(int(mode)) + ' '
+                 + QByteArray::number(int(QSslSocketPrivate::s_loadRootCertsOnDemand
+                                          && allowRootCertOnDemandLoading)));
+    for (const QSslCertificate &certificate : qAsConst(configuration.d->localCertificateChain))
+        addCertificateDigest(&hash, certificate);
+    if (!configuration.d->privateKey.isNull())
+        hash.addData(configuration.d->privateKey.toDer());
+    hash.addData(configuration.diffieHellmanParameters().d->derData);
+    const QVector<QSslEllipticCurve> curves = configuration.ellipticCurves();
+    hash.addData(reinterpret_cast<const char *>(curves.constData()),
+                 curves.size() * int(sizeof(QSslEllipticCurve)));
+    hash.addData(configuration.preSharedKeyIdentityHint());
+    return hash.result();
+}
+
 QSslError::SslError QSslContext::error() const
 {
     return errorCode;
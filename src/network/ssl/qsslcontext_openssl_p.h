@@ -75,6 +75,11 @@ public:
                                           bool allowRootCertOnDemandLoading);
     static QSharedPointer<QSslContext> sharedFromConfiguration(QSslSocket::SslMode mode, const QSslConfiguration &configuration,
                                                                bool allowRootCertOnDemandLoading);
+    // Like sharedFromConfiguration(), but returns the context an earlier
+    // call made for an equivalent configuration, if there is one
+    static QSharedPointer<QSslContext> cachedFromConfiguration(QSslSocket::SslMode mode, const QSslConfiguration &configuration,
+                                                               bool allowRootCertOnDemandLoading);
+    static void clearContextCache();
 
     QSslError::SslError error() const;
     QString errorString() const;
@@ -85,6 +90,15 @@ public:
     QByteArray sessionASN1() const;
     void setSessionASN1(const QByteArray &sessionASN1);
     int sessionTicketLifeTimeHint() const;
+    // empty if this context does not share sessions with others
+    QByteArray configurationDigest() const;
+    // true if this context came from the process-wide cache; it is then
+    // used by sockets in any thread and must not be modified
+    bool isCached() const;
+
+    // the same for configurations that trust the same peers and show them
+    // the same certificate
+    static QByteArray computeConfigurationDigest(const QSslConfiguration &configuration);
 
 #if OPENSSL_VERSION_NUMBER >= 0x1000100fL && !defined(OPENSSL_NO_NEXTPROTONEG)
     // must be public because we want to use it from an OpenSSL callback
@@ -107,6 +121,8 @@ protected:
 private:
     static void initSslContext(QSslContext* sslContext, QSslSocket::SslMode mode, const QSslConfiguration &configuration,
                                bool allowRootCertOnDemandLoading);
+    static QByteArray computeContextCacheKey(QSslSocket::SslMode mode, const QSslConfiguration &configuration,
+                                             bool allowRootCertOnDemandLoading);
 
 private:
     SSL_CTX* ctx;
@@ -114,6 +130,8 @@ private:
     SSL_SESSION *session;
     QByteArray m_sessionASN1;
     int m_sessionTicketLifeTimeHint;
+    QByteArray m_configurationDigest;
+    bool m_cached;
     QSslError::SslError errorCode;
     QString errorStr;
     QSslConfiguration sslConfiguration;
@@ -0,0 +1,339 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qsslsessioncache_openssl_p.h"
+#include "qsslsocket_openssl_symbols_p.h"
+#include "qssl_p.h"
+
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qurl.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+#ifndef QT_NO_SSL
+
+namespace {
+// QCache evicts the least recently used sessions beyond these
+const int maxClientSessions = 1024;
+const int maxServerSessions = SSL_SESSION_CACHE_MAX_SIZE_DEFAULT;
+
+const quint32 sessionCacheMagic = 0x51534331; // "QSC1"
+const quint32 sessionCacheVersion = 1;
+
+int modeIndex(QSslSocket::SslMode mode)
+{
+    return mode == QSslSocket::SslServerMode ? 1 : 0;
+}
+
+QByteArray toAsn1(SSL_SESSION *session)
+{
+    const int size = q_i2d_SSL_SESSION(session, 0);
+    if (size <= 0)
+        return QByteArray();
+    QByteArray asn1(size, Qt::Uninitialized);
+    unsigned char *data = reinterpret_cast<unsigned char *>(asn1.data());
+    if (!q_i2d_SSL_SESSION(session, &data)) {
+        qCWarning(lcSsl, "could not serialize SSL session for the session cache");
+        return QByteArray();
+    }
+    return asn1;
+}
+
+SSL_SESSION *fromAsn1(const QByteArray &asn1)
+{
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(asn1.constData());
+    return q_d2i_SSL_SESSION(0, &data, asn1.size());
+}
+}
+
+Q_GLOBAL_STATIC(QSslSessionCache, globalSessionCache)
+
+QSslSessionCache::QSslSessionCache()
+    : clientSessions(maxClientSessions),
+      serverSessions(maxServerSessions)
+{
+    handshakes[0] = handshakes[1] = 0;
+    resumedHandshakes[0] = resumedHandshakes[1] = 0;
+}
+
+QSslSessionCache::~QSslSessionCache()
+{
+}
+
+QSslSessionCache *QSslSessionCache::instance()
+{
+    return globalSessionCache();
+}
+
+QByteArray QSslSessionCache::clientSessionKey(const QString &peerName, quint16 port,
+                                              const QByteArray &configurationDigest)
+{
+    return QUrl::toAce(peerName) + ':' + QByteArray::number(port) + ':' + configurationDigest;
+}
+
+bool QSslSessionCache::resumeClientSession(SSL *ssl, const QByteArray &key)
+{
+    QByteArray asn1;
+    {
+        QMutexLocker locker(&mutex);
+        const ClientSession *entry = clientSessions.object(key);
+        if (!entry)
+            return false;
+        if (entry->expiresAt <= QDateTime::currentMSecsSinceEpoch()) {
+            clientSessions.remove(key);
+            return false;
+        }
+        asn1 = entry->asn1;
+    }
+
+    SSL_SESSION *session = fromAsn1(asn1);
+    if (!session)
+        return false;
+    const bool resumable = q_SSL_set_session(ssl, session) == 1;
+    // SSL_set_session() took its own reference
+    q_SSL_SESSION_free(session);
+    return resumable;
+}
+
+void QSslSessionCache::storeClientSession(const QByteArray &key, SSL_SESSION *session)
+{
+    if (!session || (!session->session_id_length && !session->tlsext_tick))
+        return; // nothing the server could resume
+
+    ClientSession *entry = new ClientSession;
+    entry->asn1 = toAsn1(session);
+    entry->expiresAt = (qint64(session->time) + session->timeout) * 1000;
+    if (entry->asn1.isEmpty()) {
+        delete entry;
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    clientSessions.insert(key, entry);
+}
+
+void QSslSessionCache::setupServerContext(SSL_CTX *ctx, const QByteArray &configurationDigest,
+                                          bool useTickets)
+{
+    // OpenSSL does not resume a session in a context with another ID, so
+    // the sessions of differently configured servers are kept apart:
+    q_SSL_CTX_set_session_id_context(ctx,
+                                     reinterpret_cast<const unsigned char *>(configurationDigest.constData()),
+                                     uint(qMin(configurationDigest.size(), SSL_MAX_SID_CTX_LENGTH)));
+    // Every socket has its own context, its internal cache would only ever
+    // see one handshake; we keep the sessions for all of them instead.
+    q_SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+    q_SSL_CTX_sess_set_new_cb(ctx, newServerSession);
+    q_SSL_CTX_sess_set_get_cb(ctx, getServerSession);
+    q_SSL_CTX_sess_set_remove_cb(ctx, removeServerSession);
+
+    if (!useTickets)
+        return;
+
+    // The same goes for the key the tickets are encrypted with, which
+    // OpenSSL would otherwise pick at random per context
+    QByteArray key;
+    {
+        QMutexLocker locker(&mutex);
+        if (ticketKey.isEmpty()) {
+            ticketKey.resize(SessionTicketKeyLength);
+            if (q_RAND_bytes(reinterpret_cast<unsigned char *>(ticketKey.data()), ticketKey.size()) != 1) {
+                qCWarning(lcSsl, "could not generate a session ticket key");
+                ticketKey.clear();
+                return;
+            }
+        }
+        key = ticketKey;
+    }
+    q_SSL_CTX_set_tlsext_ticket_keys(ctx, key.data(), key.size());
+}
+
+void QSslSessionCache::setSessionTicketKey(const QByteArray &key)
+{
+    QMutexLocker locker(&mutex);
+    // an empty key makes setupServerContext() generate a new one
+    ticketKey = key;
+}
+
+int QSslSessionCache::newServerSession(SSL *ssl, SSL_SESSION *session)
+{
+    Q_UNUSED(ssl);
+    QSslSessionCache *cache = instance();
+    if (!cache || !session->session_id_length)
+        return 0;
+
+    const QByteArray asn1 = toAsn1(session);
+    if (asn1.isEmpty())
+        return 0;
+    const QByteArray id(reinterpret_cast<const char *>(session->session_id),
+                        int(session->session_id_length));
+
+    QMutexLocker locker(&cache->mutex);
+    cache->serverSessions.insert(id, new QByteArray(asn1));
+    // we did not keep a reference to session
+    return 0;
+}
+
+SSL_SESSION *QSslSessionCache::getServerSession(SSL *ssl, unsigned char *id, int len, int *copy)
+{
+    Q_UNUSED(ssl);
+    // OpenSSL takes over the reference d2i_SSL_SESSION() gives us
+    *copy = 0;
+    QSslSessionCache *cache = instance();
+    if (!cache)
+        return 0;
+
+    QByteArray asn1;
+    {
+        QMutexLocker locker(&cache->mutex);
+        const QByteArray *entry =
+                cache->serverSessions.object(QByteArray::fromRawData(reinterpret_cast<const char *>(id), len));
+        if (!entry)
+            return 0;
+        asn1 = *entry;
+    }
+    return fromAsn1(asn1);
+}
+
+void QSslSessionCache::removeServerSession(SSL_CTX *ctx, SSL_SESSION *session)
+{
+    Q_UNUSED(ctx);
+    QSslSessionCache *cache = instance();
+    if (!cache)
+        return;
+
+    const QByteArray id = QByteArray::fromRawData(reinterpret_cast<const char *>(session->session_id),
+                                                  int(session->session_id_length));
+    QMutexLocker locker(&cache->mutex);
+    cache->serverSessions.remove(id);
+}
+
+void QSslSessionCache::recordHandshake(QSslSocket::SslMode mode, bool resumed)
+{
+    QMutexLocker locker(&mutex);
+    ++handshakes[modeIndex(mode)];
+    if (resumed)
+        ++resumedHandshakes[modeIndex(mode)];
+}
+
+qint64 QSslSessionCache::handshakeCount(QSslSocket::SslMode mode) const
+{
+    if (mode == QSslSocket::UnencryptedMode)
+        return 0;
+    QMutexLocker locker(&mutex);
+    return handshakes[modeIndex(mode)];
+}
+
+qint64 QSslSessionCache::resumedHandshakeCount(QSslSocket::SslMode mode) const
+{
+    if (mode == QSslSocket::UnencryptedMode)
+        return 0;
+    QMutexLocker locker(&mutex);
+    return resumedHandshakes[modeIndex(mode)];
+}
+
+void QSslSessionCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    clientSessions.clear();
+    serverSessions.clear();
+}
+
+// Only the client sessions are saved: they are what lets a restarted
+// process skip the full handshakes with the servers it talked to before.
+bool QSslSessionCache::save(QIODevice *device) const
+{
+    QDataStream stream(device);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    QMutexLocker locker(&mutex);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVector<QByteArray> keys;
+    const QList<QByteArray> allKeys = clientSessions.keys();
+    for (const QByteArray &key : allKeys) {
+        if (clientSessions.object(key)->expiresAt > now)
+            keys.append(key);
+    }
+
+    stream << sessionCacheMagic << sessionCacheVersion << quint32(keys.size());
+    for (const QByteArray &key : qAsConst(keys)) {
+        const ClientSession *entry = clientSessions.object(key);
+        stream << key << entry->asn1 << entry->expiresAt;
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+bool QSslSessionCache::load(QIODevice *device)
+{
+    QDataStream stream(device);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != sessionCacheMagic
+        || version != sessionCacheVersion) {
+        return false;
+    }
+
+    QVector<QPair<QByteArray, ClientSession> > sessions;
+    for (quint32 i = 0; i < count; ++i) {
+        QByteArray key;
+        ClientSession entry;
+        stream >> key >> entry.asn1 >> entry.expiresAt;
+        if (stream.status() != QDataStream::Ok)
+            return false;
+        sessions.append(qMakePair(key, entry));
+    }
+
+    QMutexLocker locker(&mutex);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (const auto &session : qAsConst(sessions)) {
+        if (session.second.expiresAt > now)
+            clientSessions.insert(session.first, new ClientSession(session.second));
+    }
+    return true;
+}
+
+#endif // QT_NO_SSL
+
+QT_END_NAMESPACE
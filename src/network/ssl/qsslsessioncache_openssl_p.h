@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSSLSESSIONCACHE_OPENSSL_P_H
+#define QSSLSESSIONCACHE_OPENSSL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+#include <QtNetwork/qsslsocket.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qcache.h>
+#include <QtCore/qmutex.h>
+#include <openssl/ssl.h>
+
+QT_BEGIN_NAMESPACE
+
+#ifndef QT_NO_SSL
+
+class QIODevice;
+
+// The process-wide TLS session store:
+// - client sessions, keyed by peer name, port and the digest of the
+//   configuration they were established with (see QSslContext), so that a
+//   later socket to the same peer can resume them;
+// - server sessions, looked up by session ID from the callbacks that
+//   setupServerContext() installs on every server SSL_CTX;
+// - the session ticket key all server contexts share;
+// - handshake counters.
+class QSslSessionCache
+{
+public:
+    enum { SessionTicketKeyLength = 48 };
+
+    QSslSessionCache();
+    ~QSslSessionCache();
+
+    static QSslSessionCache *instance();
+
+    static QByteArray clientSessionKey(const QString &peerName, quint16 port,
+                                       const QByteArray &configurationDigest);
+    // returns true if a cached session was set on ssl
+    bool resumeClientSession(SSL *ssl, const QByteArray &key);
+    void storeClientSession(const QByteArray &key, SSL_SESSION *session);
+
+    void setupServerContext(SSL_CTX *ctx, const QByteArray &configurationDigest, bool useTickets);
+    void setSessionTicketKey(const QByteArray &key);
+
+    void recordHandshake(QSslSocket::SslMode mode, bool resumed);
+    qint64 handshakeCount(QSslSocket::SslMode mode) const;
+    qint64 resumedHandshakeCount(QSslSocket::SslMode mode) const;
+
+    void clear();
+    bool save(QIODevice *device) const;
+    bool load(QIODevice *device);
+
+private:
+    Q_DISABLE_COPY(QSslSessionCache)
+
+    struct ClientSession
+    {
+        QByteArray asn1;
+        qint64 expiresAt; // msecs since epoch
+    };
+
+    static int newServerSession(SSL *ssl, SSL_SESSION *session);
+    static SSL_SESSION *getServerSession(SSL *ssl, unsigned char *id, int len, int *copy);
+    static void removeServerSession(SSL_CTX *ctx, SSL_SESSION *session);
+
+    mutable QMutex mutex;
+    QCache<QByteArray, ClientSession> clientSessions;
+    QCache<QByteArray, QByteArray> serverSessions;
+    QByteArray ticketKey;
+    qint64 handshakes[2];
+    qint64 resumedHandshakes[2];
+};
+
+#endif // QT_NO_SSL
+
+QT_END_NAMESPACE
+
+#endif // QSSLSESSIONCACHE_OPENSSL_P_H
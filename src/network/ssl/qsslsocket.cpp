@@ -314,6 +314,7 @@
 #include "qsslcipher.h"
 #ifndef QT_NO_OPENSSL
 #include "qsslsocket_openssl_p.h"
+#include "qsslsessioncache_openssl_p.h"
 #endif
 #ifdef Q_OS_WINRT
 #include "qsslsocket_winrt_p.h"
@@ -328,6 +329,7 @@
 #include <QtCore/qmutex.h>
 #include <QtCore/qurl.h>
 #include <QtCore/qelapsedtimer.h>
+#include <QtCore/qsavefile.h>
 #include <QtNetwork/qhostaddress.h>
 #include <QtNetwork/qhostinfo.h>
 
@@ -1778,6 +1780,156 @@ QString QSslSocket::sslLibraryBuildVersionString()
     return QSslSocketPrivate::sslLibraryBuildVersionString();
 }
 
+/*!
+    \since 5.10
+
+    Removes all sessions from the process-wide TLS session cache.
+
+    Unless QSsl::SslOptionDisableSessionSharing is set, every client
+    socket stores the session it negotiated in this cache once the
+    handshake has completed without errors, keyed by the peer name, the
+    port and the SSL configuration in use. A later socket connecting to
+    the same peer with an equivalent configuration offers that session
+    to the server and, if the server accepts it, skips the expensive
+    part of the handshake. Server sockets keep the sessions they hand
+    out in the same cache, so that clients can resume them by session
+    ID as well as by session ticket.
+
+    The cache is only available with the OpenSSL backend; with other
+    backends this function does nothing.
+
+    \sa saveSessionCache(), loadSessionCache(), resumedHandshakeCount()
+*/
+void QSslSocket::clearSessionCache()
+{
+#ifndef QT_NO_OPENSSL
+    QSslSessionCache::instance()->clear();
+#endif
+}
+
+/*!
+    \since 5.10
+
+    Writes the client sessions of the process-wide TLS session cache to
+    the file \a fileName, so that a later run of the application can
+    resume them after calling loadSessionCache(). Since the sessions
+    contain secret key material, the file is only readable by its owner.
+
+    Returns \c true on success; otherwise returns \c false.
+
+    \sa loadSessionCache(), clearSessionCache()
+*/
+bool QSslSocket::saveSessionCache(const QString &fileName)
+{
+#ifndef QT_NO_OPENSSL
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    if (!QSslSessionCache::instance()->save(&file)) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+#else
+    Q_UNUSED(fileName);
+    return false;
+#endif
+}
+
+/*!
+    \since 5.10
+
+    Adds the client sessions stored in \a fileName by saveSessionCache()
+    to the process-wide TLS session cache. Sessions that have expired in
+    the meantime are skipped.
+
+    Returns \c true on success; otherwise returns \c false.
+
+    \sa saveSessionCache(), clearSessionCache()
+*/
+bool QSslSocket::loadSessionCache(const QString &fileName)
+{
+#ifndef QT_NO_OPENSSL
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    return QSslSessionCache::instance()->load(&file);
+#else
+    Q_UNUSED(fileName);
+    return false;
+#endif
+}
+
+/*!
+    \since 5.10
+
+    Sets the key that server sockets use to encrypt and decrypt TLS session
+    tickets to \a key, which must be 48 bytes long. If \a key is empty, a
+    new random key is generated.
+
+    By default, a random key is generated once per process. Setting the
+    same key in several processes lets clients resume their sessions with
+    any of them; calling this function periodically rotates the key. The
+    new key applies to server sockets whose SSL configuration is set up
+    afterwards; tickets issued with an older key are rejected and the
+    client falls back to a full handshake.
+
+    \sa QSsl::SslOptionDisableSessionTickets
+*/
+void QSslSocket::setSessionTicketKey(const QByteArray &key)
+{
+#ifndef QT_NO_OPENSSL
+    if (!key.isEmpty() && key.size() != QSslSessionCache::SessionTicketKeyLength) {
+        qCWarning(lcSsl, "QSslSocket::setSessionTicketKey: the key must be %d bytes long",
+                  int(QSslSessionCache::SessionTicketKeyLength));
+        return;
+    }
+    QSslSessionCache::instance()->setSessionTicketKey(key);
+    // the cached server contexts still have the old key
+    QSslContext::clearContextCache();
+#else
+    Q_UNUSED(key);
+#endif
+}
+
+/*!
+    \since 5.10
+
+    Returns the number of TLS handshakes that sockets in \a mode have
+    completed in this process.
+
+    \sa resumedHandshakeCount()
+*/
+qint64 QSslSocket::handshakeCount(SslMode mode)
+{
+#ifndef QT_NO_OPENSSL
+    return QSslSessionCache::instance()->handshakeCount(mode);
+#else
+    Q_UNUSED(mode);
+    return 0;
+#endif
+}
+
+/*!
+    \since 5.10
+
+    Returns the number of TLS handshakes that sockets in \a mode have
+    completed in this process by resuming an earlier session. Together
+    with handshakeCount(), this gives the session resumption rate.
+
+    \sa handshakeCount(), clearSessionCache()
+*/
+qint64 QSslSocket::resumedHandshakeCount(SslMode mode)
+{
+#ifndef QT_NO_OPENSSL
+    return QSslSessionCache::instance()->resumedHandshakeCount(mode);
+#else
+    Q_UNUSED(mode);
+    return 0;
+#endif
+}
+
 /*!
     Starts a delayed SSL handshake for a client connection. This
     function can be called when the socket is in the \l ConnectedState
@@ -193,6 +193,14 @@ public:
     static long sslLibraryBuildVersionNumber();
     static QString sslLibraryBuildVersionString();
 
+    // TLS session cache
+    static void clearSessionCache();
+    static bool saveSessionCache(const QString &fileName);
+    static bool loadSessionCache(const QString &fileName);
+    static void setSessionTicketKey(const QByteArray &key);
+    static qint64 handshakeCount(SslMode mode);
+    static qint64 resumedHandshakeCount(SslMode mode);
+
     void ignoreSslErrors(const QList<QSslError> &errors);
 
 public Q_SLOTS:
@@ -66,6 +66,7 @@
 #include "qsslellipticcurve.h"
 #include "qsslpresharedkeyauthenticator.h"
 #include "qsslpresharedkeyauthenticator_p.h"
+#include "qsslsessioncache_openssl_p.h"
 
 #include <QtCore/qdatetime.h>
 #include <QtCore/qdebug.h>
@@ -418,7 +419,7 @@ bool QSslSocketBackendPrivate::initSslContext()
         // create a deep copy of our configuration
         QSslConfigurationPrivate *configurationCopy = new QSslConfigurationPrivate(configuration);
         configurationCopy->ref.store(0);              // the QSslConfiguration constructor refs up
-        sslContextPointer = QSslContext::sharedFromConfiguration(mode, configurationCopy, allowRootCertOnDemandLoading);
+        sslContextPointer = QSslContext::cachedFromConfiguration(mode, configurationCopy, allowRootCertOnDemandLoading);
     }
 
     if (sslContextPointer->error() != QSslError::NoError) {
@@ -435,14 +436,15 @@ bool QSslSocketBackendPrivate::initSslContext()
         return false;
     }
 
+    QString tlsHostName = verificationPeerName.isEmpty() ? q->peerName() : verificationPeerName;
+    if (tlsHostName.isEmpty())
+        tlsHostName = hostName;
+
     if (configuration.protocol != QSsl::SslV2 &&
         configuration.protocol != QSsl::SslV3 &&
         configuration.protocol != QSsl::UnknownProtocol &&
         mode == QSslSocket::SslClientMode && q_SSLeay() >= 0x00090806fL) {
         // Set server hostname on TLS extension. RFC4366 section 3.1 requires it in ACE format.
-        QString tlsHostName = verificationPeerName.isEmpty() ? q->peerName() : verificationPeerName;
-        if (tlsHostName.isEmpty())
-            tlsHostName = hostName;
         QByteArray ace = QUrl::toAce(tlsHostName);
         // only send the SNI header if the URL is valid and not an IP
         if (!ace.isEmpty()
@@ -457,6 +459,18 @@ bool QSslSocketBackendPrivate::initSslContext()
         }
     }
 
+    // Offer the session of an earlier socket to the same peer, unless the
+    // context brings its own (e.g. QHttpNetworkConnection shares one
+    // context between its channels)
+    sessionCacheKey.clear();
+    const QByteArray configurationDigest = sslContextPointer->configurationDigest();
+    if (mode == QSslSocket::SslClientMode && !configurationDigest.isEmpty()) {
+        sessionCacheKey = QSslSessionCache::clientSessionKey(tlsHostName, q->peerPort(),
+                                                             configurationDigest);
+        if (!q_SSL_get_session(ssl))
+            QSslSessionCache::instance()->resumeClientSession(ssl, sessionCacheKey);
+    }
+
     // Clear the session.
     errorList.clear();
 
@@ -1585,6 +1599,7 @@ void QSslSocketBackendPrivate::continueHandshake()
 
     if (q_SSL_ctrl((ssl), SSL_CTRL_GET_SESSION_REUSED, 0, NULL))
         configuration.peerSessionShared = true;
+    QSslSessionCache::instance()->recordHandshake(mode, configuration.peerSessionShared);
 
 #ifdef QT_DECRYPT_SSL_TRAFFIC
     if (ssl->session && ssl->s3) {
@@ -1622,7 +1637,13 @@ void QSslSocketBackendPrivate::continueHandshake()
 
     // Cache this SSL session inside the QSslContext
     if (!(configuration.sslOptions & QSsl::SslOptionDisableSessionSharing)) {
-        if (!sslContextPointer->cacheSession(ssl)) {
+        // ... and for later sockets to the same peer, unless we only got
+        // here by ignoring errors
+        if (!sessionCacheKey.isEmpty() && sslErrors.isEmpty() && !configuration.peerSessionShared)
+            QSslSessionCache::instance()->storeClientSession(sessionCacheKey, q_SSL_get_session(ssl));
+        // a cached context serves all peers, in any thread, and keeps no
+        // session of its own
+        if (!sslContextPointer->isCached() && !sslContextPointer->cacheSession(ssl)) {
             sslContextPointer.clear(); // we could not cache the session
         } else {
             // Cache the session for permanent usage as well
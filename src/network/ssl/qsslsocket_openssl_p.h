@@ -126,6 +126,8 @@ public:
     BIO *readBio;
     BIO *writeBio;
     SSL_SESSION *session;
+    // where the session goes in the process-wide cache, if anywhere
+    QByteArray sessionCacheKey;
     QVector<QSslErrorEntry> errorList;
 #if OPENSSL_VERSION_NUMBER >= 0x10001000L
     static int s_indexForSSLExtraData; // index used in SSL_get_ex_data to get the matching QSslSocketBackendPrivate
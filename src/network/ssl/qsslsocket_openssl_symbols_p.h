@@ -328,6 +328,7 @@ int q_PEM_write_bio_EC_PUBKEY(BIO *a, EC_KEY *b);
 #endif
 void q_RAND_seed(const void *a, int b);
 int q_RAND_status();
+int q_RAND_bytes(unsigned char *b, int n);
 RSA *q_RSA_new();
 void q_RSA_free(RSA *a);
 int q_sk_num(STACK *a);
@@ -391,6 +392,13 @@ int q_SSL_set_session(SSL *to, SSL_SESSION *session);
 void q_SSL_SESSION_free(SSL_SESSION *ses);
 SSL_SESSION *q_SSL_get1_session(SSL *ssl);
 SSL_SESSION *q_SSL_get_session(const SSL *ssl);
+typedef int (*q_new_session_callback_t)(SSL *ssl, SSL_SESSION *session);
+void q_SSL_CTX_sess_set_new_cb(SSL_CTX *ctx, q_new_session_callback_t callback);
+typedef SSL_SESSION *(*q_get_session_callback_t)(SSL *ssl, unsigned char *id, int len, int *copy);
+void q_SSL_CTX_sess_set_get_cb(SSL_CTX *ctx, q_get_session_callback_t callback);
+typedef void (*q_remove_session_callback_t)(SSL_CTX *ctx, SSL_SESSION *session);
+void q_SSL_CTX_sess_set_remove_cb(SSL_CTX *ctx, q_remove_session_callback_t callback);
+int q_SSL_CTX_set_session_id_context(SSL_CTX *ctx, const unsigned char *sid_ctx, unsigned int sid_ctx_len);
 #if OPENSSL_VERSION_NUMBER >= 0x10001000L
 int q_SSL_get_ex_new_index(long argl, void *argp, CRYPTO_EX_new *new_func, CRYPTO_EX_dup *dup_func, CRYPTO_EX_free *free_func);
 int q_SSL_set_ex_data(SSL *ssl, int idx, void *arg);
@@ -552,6 +560,8 @@ DSA *q_d2i_DSAPrivateKey(DSA **a, unsigned char **pp, long length);
 #endif
 #define q_SSL_CTX_set_options(ctx,op) q_SSL_CTX_ctrl((ctx),SSL_CTRL_OPTIONS,(op),NULL)
 #define q_SSL_CTX_set_mode(ctx,op) q_SSL_CTX_ctrl((ctx),SSL_CTRL_MODE,(op),NULL)
+#define q_SSL_CTX_set_session_cache_mode(ctx,m) q_SSL_CTX_ctrl((ctx),SSL_CTRL_SET_SESS_CACHE_MODE,(m),NULL)
+#define q_SSL_CTX_set_tlsext_ticket_keys(ctx,keys,keylen) q_SSL_CTX_ctrl((ctx),SSL_CTRL_SET_TLSEXT_TICKET_KEYS,(keylen),(keys))
 #define q_SKM_sk_num(type, st) ((int (*)(const STACK_OF(type) *))q_sk_num)(st)
 #define q_SKM_sk_value(type, st,i) ((type * (*)(const STACK_OF(type) *, int))q_sk_value)(st, i)
 #define q_sk_GENERAL_NAME_num(st) q_SKM_sk_num(GENERAL_NAME, (st))
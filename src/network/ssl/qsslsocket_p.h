@@ -168,7 +168,7 @@ public:
     static void resumeSocketNotifiers(QSslSocket*);
     // ### The 2 methods below should be made member methods once the QSslContext class is made public
     static void checkSettingSslContext(QSslSocket*, QSharedPointer<QSslContext>);
-    static QSharedPointer<QSslContext> sslContext(QSslSocket *socket);
+    Q_AUTOTEST_EXPORT static QSharedPointer<QSslContext> sslContext(QSslSocket *socket);
     bool isPaused() const;
     bool bind(const QHostAddress &address, quint16, QAbstractSocket::BindMode) Q_DECL_OVERRIDE;
     void _q_connectedSlot();
@@ -58,6 +58,7 @@ qtConfig(ssl) {
 
     qtConfig(openssl) {
         HEADERS += ssl/qsslcontext_openssl_p.h \
+                   ssl/qsslsessioncache_openssl_p.h \
                    ssl/qsslsocket_openssl_p.h \
                    ssl/qsslsocket_openssl_symbols_p.h
         SOURCES += ssl/qsslcertificate_openssl.cpp \
@@ -65,6 +66,7 @@ qtConfig(ssl) {
                    ssl/qssldiffiehellmanparameters_openssl.cpp \
                    ssl/qsslellipticcurve_openssl.cpp \
                    ssl/qsslkey_openssl.cpp \
+                   ssl/qsslsessioncache_openssl.cpp \
                    ssl/qsslsocket_openssl.cpp \
                    ssl/qsslsocket_openssl_symbols.cpp
 
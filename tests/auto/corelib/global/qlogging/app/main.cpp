@@ -28,6 +28,8 @@
 
 #include <QCoreApplication>
 #include <QLoggingCategory>
+#include <QThread>
+#include <QVector>
 
 #ifdef Q_CC_GNU
 #define NEVER_INLINE __attribute__((__noinline__))
@@ -60,6 +62,8 @@ void MyClass::myFunction(int a)
     qDebug() << "from_a_function" << a;
 }
 
+static int logAsync();
+
 int main(int argc, char **argv)
 {
     QCoreApplication app(argc, argv);
@@ -82,6 +86,52 @@ int main(int argc, char **argv)
     MyClass cl;
     QMetaObject::invokeMethod(&cl, "mySlot1");
 
+    if (app.arguments().contains(QLatin1String("async")))
+        return logAsync();
+
+    return 0;
+}
+
+QT_BEGIN_NAMESPACE
+Q_CORE_EXPORT void qt_logging_set_async(bool enable);
+QT_END_NAMESPACE
+
+class LoggingThread : public QThread
+{
+public:
+    explicit LoggingThread(int id) : id(id) {}
+
+protected:
+    void run() override
+    {
+        for (int i = 0; i < 1000; ++i)
+            qDebug("async %d %d", id, i);
+    }
+
+private:
+    int id;
+};
+
+// Logs from several threads at once, then switches asynchronous output
+// off again, which has to write out every message queued before.
+static int logAsync()
+{
+    qSetMessagePattern("%{message}");
+    qt_logging_set_async(true);
+
+    QVector<LoggingThread *> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.append(new LoggingThread(i));
+    for (LoggingThread *thread : qAsConst(threads))
+        thread->start();
+    for (int i = 0; i < 1000; ++i)
+        qDebug("async 4 %d", i);
+    for (LoggingThread *thread : qAsConst(threads))
+        thread->wait();
+    qDeleteAll(threads);
+
+    qt_logging_set_async(false);
+    fputs("flushed\n", stderr);
     return 0;
 }
 
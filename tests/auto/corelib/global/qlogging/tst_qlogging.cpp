@@ -58,7 +58,9 @@ private slots:
 
     void qMessagePattern_data();
     void qMessagePattern();
+    void setMessagePattern_data();
     void setMessagePattern();
+    void asyncOutput();
 
     void formatLogMessage_data();
     void formatLogMessage();
@@ -722,16 +724,16 @@ void tst_qmessagehandler::qMessagePattern_data()
 
     // %{file} is tricky because of shadow builds
     QTest::newRow("basic") << "%{type} %{appname} %{line} %{function} %{message}" << true << (QList<QByteArray>()
-            << "debug  39 T::T static constructor"
+            << "debug  41 T::T static constructor"
             //  we can't be sure whether the QT_MESSAGE_PATTERN is already destructed
             << "static destructor"
-            << "debug tst_qlogging 60 MyClass::myFunction from_a_function 34"
-            << "debug tst_qlogging 70 main qDebug"
-            << "info tst_qlogging 71 main qInfo"
-            << "warning tst_qlogging 72 main qWarning"
-            << "critical tst_qlogging 73 main qCritical"
-            << "warning tst_qlogging 76 main qDebug with category"
-            << "debug tst_qlogging 80 main qDebug2");
+            << "debug tst_qlogging 62 MyClass::myFunction from_a_function 34"
+            << "debug tst_qlogging 74 main qDebug"
+            << "info tst_qlogging 75 main qInfo"
+            << "warning tst_qlogging 76 main qWarning"
+            << "critical tst_qlogging 77 main qCritical"
+            << "warning tst_qlogging 80 main qDebug with category"
+            << "debug tst_qlogging 84 main qDebug2");
 
 
     QTest::newRow("invalid") << "PREFIX: %{unknown} %{message}" << false << (QList<QByteArray>()
@@ -855,11 +857,20 @@ void tst_qmessagehandler::qMessagePattern()
 #endif
 }
 
+void tst_qmessagehandler::setMessagePattern_data()
+{
+    QTest::addColumn<bool>("async");
+
+    QTest::newRow("sync") << false;
+    QTest::newRow("async") << true;
+}
+
 void tst_qmessagehandler::setMessagePattern()
 {
 #if !QT_CONFIG(process)
     QSKIP("This test requires QProcess support");
 #else
+    QFETCH(bool, async);
 
     //
     // test qSetMessagePattern
@@ -875,6 +886,8 @@ void tst_qmessagehandler::setMessagePattern()
         if (iter.next().startsWith("QT_MESSAGE_PATTERN"))
             iter.remove();
     }
+    if (async)
+        environment.append(QStringLiteral("QT_LOGGING_ASYNC=1"));
     process.setEnvironment(environment);
 
     process.start(appExe);
@@ -897,6 +910,58 @@ void tst_qmessagehandler::setMessagePattern()
 #endif // QT_CONFIG(process)
 }
 
+void tst_qmessagehandler::asyncOutput()
+{
+#if !QT_CONFIG(process)
+    QSKIP("This test requires QProcess support");
+#else
+    QProcess process;
+    const QString appExe = m_appDir + "/app";
+
+    QStringList environment = m_baseEnvironment;
+    QMutableListIterator<QString> iter(environment);
+    while (iter.hasNext()) {
+        if (iter.next().startsWith("QT_MESSAGE_PATTERN"))
+            iter.remove();
+    }
+    process.setEnvironment(environment);
+
+    process.start(appExe, QStringList() << "async");
+    QVERIFY2(process.waitForStarted(), qPrintable(
+        QString::fromLatin1("Could not start %1: %2").arg(appExe, process.errorString())));
+    QVERIFY(process.waitForFinished());
+    QCOMPARE(process.exitCode(), 0);
+
+    QByteArray output = process.readAllStandardError();
+#ifdef Q_OS_WIN
+    output.replace("\r\n", "\n");
+#endif
+
+    // every message has to be written before qt_logging_set_async(false)
+    // returns, and the messages of each thread in the order they were logged
+    int next[5] = { 0, 0, 0, 0, 0 };
+    bool flushed = false;
+    const QList<QByteArray> lines = output.split('\n');
+    for (const QByteArray &line : lines) {
+        if (line == "flushed") {
+            flushed = true;
+            break;
+        }
+        if (!line.startsWith("async "))
+            continue;
+        const QList<QByteArray> fields = line.split(' ');
+        QCOMPARE(fields.size(), 3);
+        const int thread = fields.at(1).toInt();
+        QVERIFY(thread >= 0 && thread < 5);
+        QCOMPARE(fields.at(2).toInt(), next[thread]);
+        ++next[thread];
+    }
+    QVERIFY2(flushed, output.right(200).constData());
+    for (int thread = 0; thread < 5; ++thread)
+        QCOMPARE(next[thread], 1000);
+#endif // QT_CONFIG(process)
+}
+
 Q_DECLARE_METATYPE(QtMsgType)
 
 void tst_qmessagehandler::formatLogMessage_data()
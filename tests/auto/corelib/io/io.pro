@@ -1,6 +1,7 @@
 TEMPLATE=subdirs
 SUBDIRS=\
     qabstractfileengine \
+    qasyncfile \
     qbuffer \
     qdatastream \
     qdataurl \
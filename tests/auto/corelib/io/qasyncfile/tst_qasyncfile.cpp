@@ -0,0 +1,253 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QAsyncFile>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QTemporaryDir>
+
+class tst_QAsyncFile : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void openClose();
+    void read();
+    void readPastEnd();
+    void write();
+    void requestOrder();
+    void notOpen();
+    void wrongOpenMode();
+    void futureWatcher();
+    void busyGlobalThreadPool();
+
+private:
+    QString writeTestFile(const QByteArray &contents);
+
+    QTemporaryDir tempDir;
+    int fileCount;
+};
+
+void tst_QAsyncFile::initTestCase()
+{
+    QVERIFY2(tempDir.isValid(), qPrintable(tempDir.errorString()));
+    fileCount = 0;
+}
+
+QString tst_QAsyncFile::writeTestFile(const QByteArray &contents)
+{
+    QFile file(tempDir.path() + QLatin1String("/file") + QString::number(fileCount++));
+    if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size())
+        return QString();
+    return file.fileName();
+}
+
+void tst_QAsyncFile::openClose()
+{
+    const QString name = writeTestFile("abc");
+    QVERIFY(!name.isEmpty());
+
+    QAsyncFile file(name);
+    QCOMPARE(file.fileName(), name);
+    QVERIFY(!file.isOpen());
+    QCOMPARE(file.openMode(), QIODevice::NotOpen);
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.isOpen());
+    QCOMPARE(file.openMode(), QIODevice::ReadOnly);
+    QCOMPARE(file.error(), QFileDevice::NoError);
+
+    file.close();
+    QVERIFY(!file.isOpen());
+
+    QAsyncFile missing(tempDir.path() + QLatin1String("/does-not-exist"));
+    QVERIFY(!missing.open(QIODevice::ReadOnly));
+    QCOMPARE(missing.error(), QFileDevice::OpenError);
+    QVERIFY(!missing.errorString().isEmpty());
+}
+
+void tst_QAsyncFile::read()
+{
+    const QString name = writeTestFile("Hello, asynchronous world");
+    QVERIFY(!name.isEmpty());
+
+    QAsyncFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QFuture<QByteArray> hello = file.read(0, 5);
+    QFuture<QByteArray> world = file.read(20, 5);
+    QCOMPARE(hello.result(), QByteArray("Hello"));
+    QCOMPARE(world.result(), QByteArray("world"));
+    QCOMPARE(file.error(), QFileDevice::NoError);
+}
+
+void tst_QAsyncFile::readPastEnd()
+{
+    const QString name = writeTestFile("0123456789");
+    QVERIFY(!name.isEmpty());
+
+    QAsyncFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QCOMPARE(file.read(8, 100).result(), QByteArray("89"));
+    QCOMPARE(file.read(10, 100).result(), QByteArray());
+    QCOMPARE(file.read(1000, 100).result(), QByteArray());
+    QCOMPARE(file.error(), QFileDevice::NoError);
+}
+
+void tst_QAsyncFile::write()
+{
+    const QString name = writeTestFile("..........");
+    QVERIFY(!name.isEmpty());
+
+    {
+        QAsyncFile file(name);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QCOMPARE(file.write(2, "abc").result(), qint64(3));
+        QCOMPARE(file.write(10, "xyz").result(), qint64(3));
+        QCOMPARE(file.read(0, 100).result(), QByteArray("..abc.....xyz"));
+    }
+
+    QFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("..abc.....xyz"));
+}
+
+void tst_QAsyncFile::requestOrder()
+{
+    const QString name = writeTestFile(QByteArray());
+    QVERIFY(!name.isEmpty());
+
+    const int count = 1000;
+    QAsyncFile file(name);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+
+    // overlapping writes must be executed in submission order
+    QVector<QFuture<qint64> > writes;
+    for (int i = 0; i < count; ++i)
+        writes << file.write(0, QByteArray::number(i));
+    QFuture<QByteArray> last = file.read(0, 100);
+
+    file.waitForFinished();
+    QCOMPARE(file.pendingRequestCount(), 0);
+    for (const QFuture<qint64> &future : qAsConst(writes))
+        QVERIFY(future.isFinished());
+    QVERIFY(last.isFinished());
+    QCOMPARE(last.result(), QByteArray::number(count - 1));
+}
+
+void tst_QAsyncFile::notOpen()
+{
+    QAsyncFile file;
+
+    QTest::ignoreMessage(QtWarningMsg, "QAsyncFile::read: File () not open");
+    QFuture<QByteArray> read = file.read(0, 10);
+    QVERIFY(read.isFinished());
+    QCOMPARE(read.result(), QByteArray());
+
+    QTest::ignoreMessage(QtWarningMsg, "QAsyncFile::write: File () not open");
+    QFuture<qint64> write = file.write(0, "abc");
+    QVERIFY(write.isFinished());
+    QCOMPARE(write.result(), qint64(-1));
+}
+
+void tst_QAsyncFile::wrongOpenMode()
+{
+    const QString name = writeTestFile("abc");
+    QVERIFY(!name.isEmpty());
+
+    QAsyncFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QTest::ignoreMessage(QtWarningMsg,
+                         qPrintable(QLatin1String("QAsyncFile::write: File (") + name
+                                    + QLatin1String(") not open for writing")));
+    QCOMPARE(file.write(0, "abc").result(), qint64(-1));
+
+    QTest::ignoreMessage(QtWarningMsg, "QAsyncFile::open: Text mode is not supported");
+    QAsyncFile textFile(name);
+    QVERIFY(!textFile.open(QIODevice::ReadOnly | QIODevice::Text));
+}
+
+void tst_QAsyncFile::futureWatcher()
+{
+    const QString name = writeTestFile("watched");
+    QVERIFY(!name.isEmpty());
+
+    QAsyncFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QFutureWatcher<QByteArray> watcher;
+    QSignalSpy spy(&watcher, &QFutureWatcher<QByteArray>::finished);
+    watcher.setFuture(file.read(0, 7));
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(watcher.result(), QByteArray("watched"));
+}
+
+class ReadJob : public QRunnable
+{
+public:
+    explicit ReadJob(const QString &name) : name(name) {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QAsyncFile file(name);
+        if (file.open(QIODevice::ReadOnly))
+            result = file.read(0, 100).result();
+    }
+
+    QString name;
+    QByteArray result;
+};
+
+void tst_QAsyncFile::busyGlobalThreadPool()
+{
+    const QString name = writeTestFile("busy");
+    QVERIFY(!name.isEmpty());
+
+    // waiting for a request must not depend on a free thread in the
+    // global pool, even when waiting from one of its threads
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int maxThreadCount = pool->maxThreadCount();
+    pool->setMaxThreadCount(1);
+
+    ReadJob job(name);
+    job.setAutoDelete(false);
+    pool->start(&job);
+    const bool done = pool->waitForDone(30000);
+    pool->setMaxThreadCount(maxThreadCount);
+
+    QVERIFY(done);
+    QCOMPARE(job.result, QByteArray("busy"));
+}
+
+QTEST_MAIN(tst_QAsyncFile)
+#include "tst_qasyncfile.moc"
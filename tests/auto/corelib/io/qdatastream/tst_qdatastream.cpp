@@ -168,6 +168,10 @@ private slots:
 
     void status_QLinkedList_QList_QVector();
 
+    void stream_QVector_primitives_data();
+    void stream_QVector_primitives();
+    void status_QVector_primitives();
+
     void streamToAndFromQByteArray();
 
     void streamRealDataTypes();
@@ -2942,6 +2946,152 @@ void tst_QDataStream::status_QLinkedList_QList_QVector()
     }
 }
 
+template <typename T>
+static QVector<T> makeVector(int size)
+{
+    QVector<T> v;
+    v.reserve(size);
+    for (int i = 0; i < size; ++i)
+        v.append(T(quint32(i) * 0x01020305u + 7));
+    return v;
+}
+
+template <typename T>
+static void checkVectorStreaming(int size, int byteOrder, int version, int precision)
+{
+    const QVector<T> vector = makeVector<T>(size);
+
+    // the bulk path must produce the same bytes as streaming each element
+    QByteArray expected;
+    {
+        QDataStream out(&expected, QIODevice::WriteOnly);
+        out.setByteOrder(QDataStream::ByteOrder(byteOrder));
+        out.setVersion(version);
+        out.setFloatingPointPrecision(QDataStream::FloatingPointPrecision(precision));
+        out << quint32(vector.size());
+        for (const T &t : vector)
+            out << t;
+    }
+
+    QByteArray actual;
+    {
+        QDataStream out(&actual, QIODevice::WriteOnly);
+        out.setByteOrder(QDataStream::ByteOrder(byteOrder));
+        out.setVersion(version);
+        out.setFloatingPointPrecision(QDataStream::FloatingPointPrecision(precision));
+        out << vector;
+        QCOMPARE(out.status(), QDataStream::Ok);
+    }
+    QCOMPARE(actual, expected);
+
+    QDataStream in(actual);
+    in.setByteOrder(QDataStream::ByteOrder(byteOrder));
+    in.setVersion(version);
+    in.setFloatingPointPrecision(QDataStream::FloatingPointPrecision(precision));
+    QVector<T> result;
+    in >> result;
+    QCOMPARE(in.status(), QDataStream::Ok);
+    QVERIFY(in.atEnd());
+    if (std::is_same<T, double>::value && precision == QDataStream::SinglePrecision
+            && version >= QDataStream::Qt_4_6) {
+        QCOMPARE(result.size(), vector.size());
+    } else {
+        QCOMPARE(result, vector);
+    }
+}
+
+void tst_QDataStream::stream_QVector_primitives_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("byteOrder");
+    QTest::addColumn<int>("version");
+    QTest::addColumn<int>("precision");
+
+    const int sizes[] = { 0, 1, 7, 16, 1000 };
+    for (int size : sizes) {
+        const QByteArray name = QByteArray::number(size);
+        QTest::newRow((name + " big endian").constData())
+                << size << int(QDataStream::BigEndian) << int(QDataStream::Qt_DefaultCompiledVersion)
+                << int(QDataStream::DoublePrecision);
+        QTest::newRow((name + " little endian").constData())
+                << size << int(QDataStream::LittleEndian) << int(QDataStream::Qt_DefaultCompiledVersion)
+                << int(QDataStream::DoublePrecision);
+        QTest::newRow((name + " single precision").constData())
+                << size << int(QDataStream::BigEndian) << int(QDataStream::Qt_DefaultCompiledVersion)
+                << int(QDataStream::SinglePrecision);
+        QTest::newRow((name + " Qt 4.5").constData())
+                << size << int(QDataStream::BigEndian) << int(QDataStream::Qt_4_5)
+                << int(QDataStream::DoublePrecision);
+        QTest::newRow((name + " Qt 3.3").constData())
+                << size << int(QDataStream::LittleEndian) << int(QDataStream::Qt_3_3)
+                << int(QDataStream::DoublePrecision);
+    }
+}
+
+void tst_QDataStream::stream_QVector_primitives()
+{
+    QFETCH(int, size);
+    QFETCH(int, byteOrder);
+    QFETCH(int, version);
+    QFETCH(int, precision);
+
+    checkVectorStreaming<qint8>(size, byteOrder, version, precision);
+    checkVectorStreaming<quint8>(size, byteOrder, version, precision);
+    checkVectorStreaming<qint16>(size, byteOrder, version, precision);
+    checkVectorStreaming<quint16>(size, byteOrder, version, precision);
+    checkVectorStreaming<qint32>(size, byteOrder, version, precision);
+    checkVectorStreaming<quint32>(size, byteOrder, version, precision);
+    checkVectorStreaming<qint64>(size, byteOrder, version, precision);
+    checkVectorStreaming<quint64>(size, byteOrder, version, precision);
+    checkVectorStreaming<float>(size, byteOrder, version, precision);
+    checkVectorStreaming<double>(size, byteOrder, version, precision);
+}
+
+void tst_QDataStream::status_QVector_primitives()
+{
+    // past end
+    for (int i = 0; i < 12; ++i) {
+        QByteArray data("\x00\x00\x00\x02\x00\x00\x00\x01\x00\x00\x00\x02", i);
+        QDataStream in(data);
+        QVector<qint32> vector;
+        vector.append(42);
+        in >> vector;
+        QCOMPARE(in.status(), QDataStream::ReadPastEnd);
+        QVERIFY(vector.isEmpty());
+    }
+
+    // a huge count must not allocate before the data is there
+    {
+        QByteArray data("\x7f\xff\xff\xff\x00\x00\x00\x01", 8);
+        QDataStream in(data);
+        QVector<qint64> vector;
+        in >> vector;
+        QCOMPARE(in.status(), QDataStream::ReadPastEnd);
+        QVERIFY(vector.isEmpty());
+    }
+
+    // corrupt count
+    {
+        QByteArray data("\xff\xff\xff\xfe\x00\x00\x00\x01", 8);
+        QDataStream in(data);
+        QVector<quint16> vector;
+        in >> vector;
+        QCOMPARE(in.status(), QDataStream::ReadCorruptData);
+        QVERIFY(vector.isEmpty());
+    }
+
+    // previously latched error status is not affected by reading
+    {
+        QByteArray data("\x00\x00\x00\x01\x00\x00\x00\x05", 8);
+        QDataStream in(data);
+        in.setStatus(QDataStream::ReadCorruptData);
+        QVector<qint32> vector;
+        in >> vector;
+        QCOMPARE(in.status(), QDataStream::ReadCorruptData);
+        QCOMPARE(vector, QVector<qint32>() << 5);
+    }
+}
+
 void tst_QDataStream::streamToAndFromQByteArray()
 {
     QByteArray data;
@@ -75,6 +75,9 @@ private slots:
 
     void watchUnicodeCharacters();
 
+    void watchSubdirectories();
+    void coalesceChanges();
+
 private:
     QString m_tempDirPattern;
 #endif // QT_NO_FILESYSTEMWATCHER
@@ -769,6 +772,103 @@ void tst_QFileSystemWatcher::watchUnicodeCharacters()
     QVERIFY(testDir.mkdir("creme"));
     QTRY_COMPARE(changedSpy.count(), 1);
 }
+
+void tst_QFileSystemWatcher::watchSubdirectories()
+{
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+
+    QDir testDir(temporaryDirectory.path());
+    QVERIFY(testDir.mkpath("a/b/c"));
+    QVERIFY(testDir.mkpath("d"));
+    const QString root = testDir.path();
+
+    QFileSystemWatcher watcher;
+    QVERIFY(watcher.addPath(root, QFileSystemWatcher::WatchSubdirectories));
+    QStringList directories = watcher.directories();
+    std::sort(directories.begin(), directories.end());
+    QCOMPARE(directories, QStringList() << root << root + "/a" << root + "/a/b"
+                                        << root + "/a/b/c" << root + "/d");
+
+    QSignalSpy changedSpy(&watcher, &QFileSystemWatcher::directoryChanged);
+    QVERIFY(changedSpy.isValid());
+
+    QFile file(root + "/a/b/c/file");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+    QTRY_VERIFY(changedSpy.contains(QVariantList() << root + "/a/b/c"));
+
+    // new subdirectories are watched too
+    changedSpy.clear();
+    QVERIFY(testDir.mkpath("a/new/deeper"));
+    QTRY_VERIFY(watcher.directories().contains(root + "/a/new/deeper"));
+    QVERIFY(watcher.directories().contains(root + "/a/new"));
+    QTRY_VERIFY(changedSpy.contains(QVariantList() << root + "/a"));
+
+    changedSpy.clear();
+    QFile newFile(root + "/a/new/deeper/file");
+    QVERIFY(newFile.open(QIODevice::WriteOnly));
+    newFile.close();
+    QTRY_VERIFY(changedSpy.contains(QVariantList() << root + "/a/new/deeper"));
+
+    // removing a directory stops watching its subdirectories
+    QVERIFY(watcher.removePath(root + "/a"));
+    QCOMPARE(watcher.directories().size(), 2);
+    QVERIFY(watcher.removePath(root));
+    QVERIFY(watcher.directories().isEmpty());
+}
+
+void tst_QFileSystemWatcher::coalesceChanges()
+{
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+
+    QStringList paths;
+    for (int i = 0; i < 20; ++i) {
+        QFile file(temporaryDirectory.path() + QLatin1String("/file") + QString::number(i));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        paths << file.fileName();
+    }
+
+    QFileSystemWatcher watcher;
+    QCOMPARE(watcher.coalescingInterval(), 0);
+    watcher.setCoalescingInterval(500);
+    QCOMPARE(watcher.coalescingInterval(), 500);
+    QVERIFY(watcher.addPaths(paths).isEmpty());
+
+    QSignalSpy fileSpy(&watcher, &QFileSystemWatcher::fileChanged);
+    QSignalSpy pathsSpy(&watcher, &QFileSystemWatcher::pathsChanged);
+    QVERIFY(fileSpy.isValid());
+    QVERIFY(pathsSpy.isValid());
+
+    for (int round = 0; round < 3; ++round) {
+        for (const QString &path : qAsConst(paths)) {
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+            file.write("x", 1);
+        }
+    }
+
+    QTRY_COMPARE(pathsSpy.count(), 1);
+    QStringList files = pathsSpy.at(0).at(0).toStringList();
+    std::sort(files.begin(), files.end());
+    std::sort(paths.begin(), paths.end());
+    QCOMPARE(files, paths);
+    QVERIFY(pathsSpy.at(0).at(1).toStringList().isEmpty());
+    QCOMPARE(fileSpy.count(), paths.size());
+
+    // turning coalescing off reports the pending changes at once
+    pathsSpy.clear();
+    QFile file(paths.first());
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write("x", 1);
+    file.close();
+    QTRY_VERIFY(watcher.findChild<QTimer *>() && watcher.findChild<QTimer *>()->isActive());
+    QCOMPARE(pathsSpy.count(), 0);
+    watcher.setCoalescingInterval(0);
+    QCOMPARE(pathsSpy.count(), 1);
+    QCOMPARE(pathsSpy.at(0).at(0).toStringList(), QStringList(paths.first()));
+}
 #endif // QT_NO_FILESYSTEMWATCHER
 
 QTEST_MAIN(tst_QFileSystemWatcher)
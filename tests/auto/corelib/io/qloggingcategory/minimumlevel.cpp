@@ -0,0 +1,67 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+// This file is built as if the project had set
+// QT_LOGGING_MINIMUM_LEVEL = warning
+#define QT_LOGGING_MINIMUM_LEVEL QtWarningMsg
+
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(lcMinimumLevel, "tst.minimumlevel")
+
+static int evaluations = 0;
+
+static const QLoggingCategory &countingCategory()
+{
+    ++evaluations;
+    return lcMinimumLevel();
+}
+
+static int countingArgument()
+{
+    return ++evaluations;
+}
+
+// Returns how often the category or an argument was evaluated.
+int logBelowMinimumLevel()
+{
+    evaluations = 0;
+    qCDebug(countingCategory) << countingArgument();
+    qCDebug(countingCategory, "%d", countingArgument());
+    qCInfo(countingCategory) << countingArgument();
+    qCInfo(countingCategory, "%d", countingArgument());
+    return evaluations;
+}
+
+int logAtMinimumLevel()
+{
+    evaluations = 0;
+    qCWarning(countingCategory) << countingArgument();
+    qCCritical(countingCategory, "%d", countingArgument());
+    return evaluations;
+}
@@ -4,4 +4,5 @@ TARGET = tst_qloggingcategory
 CONFIG += testcase
 QT = core core-private testlib
 
-SOURCES  += tst_qloggingcategory.cpp
+SOURCES  += tst_qloggingcategory.cpp \
+            minimumlevel.cpp
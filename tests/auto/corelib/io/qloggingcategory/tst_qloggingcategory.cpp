@@ -37,6 +37,10 @@ Q_LOGGING_CATEGORY(Digia_Berlin_Office_com, "Digia.Berlin.Office.com")
 
 QT_USE_NAMESPACE
 
+// minimumlevel.cpp
+int logBelowMinimumLevel();
+int logAtMinimumLevel();
+
 QtMessageHandler oldMessageHandler;
 QString logMessage;
 bool multithreadtest = false;
@@ -937,6 +941,27 @@ private slots:
         }
     }
 
+    void minimumLevel()
+    {
+        multithreadtest = true;
+        threadtest.clear();
+        QLoggingCategory::setFilterRules("tst.minimumlevel=true");
+
+        // compiled out: neither the category nor the arguments are
+        // evaluated, and even the rule above does not bring them back
+        QCOMPARE(logBelowMinimumLevel(), 0);
+        QVERIFY(threadtest.isEmpty());
+
+        QVERIFY(logAtMinimumLevel() > 0);
+        QCOMPARE(threadtest.size(), 2);
+        QVERIFY(threadtest.at(0).startsWith("tst.minimumlevel.warning: "));
+        QVERIFY(threadtest.at(1).startsWith("tst.minimumlevel.critical: "));
+
+        multithreadtest = false;
+        threadtest.clear();
+        QLoggingCategory::setFilterRules(QString());
+    }
+
     void cleanupTestCase()
     {
         delete _config;
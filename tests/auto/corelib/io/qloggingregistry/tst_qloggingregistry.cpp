@@ -285,6 +285,57 @@ private slots:
         QVERIFY(!cat.isWarningEnabled());
     }
 
+    void QLoggingRegistry_incrementalUpdate()
+    {
+        QLoggingCategory berlin("Digia.Berlin");
+        QLoggingCategory oslo("Digia.Oslo");
+        QLoggingCategory oulu("Qt.Oulu");
+        QLoggingCategory berlin2("Digia.Berlin");
+        QLoggingRegistry *registry = QLoggingRegistry::instance();
+
+        registry->ruleSets[QLoggingRegistry::ApiRules].clear();
+        registry->ruleSets[QLoggingRegistry::ConfigRules].clear();
+        registry->ruleSets[QLoggingRegistry::EnvironmentRules].clear();
+        registry->updateRules();
+        QVERIFY(berlin.isDebugEnabled());
+        QVERIFY(oulu.isDebugEnabled());
+
+        // prefix rule
+        QLoggingCategory::setFilterRules("Digia.*.debug=false");
+        QVERIFY(!berlin.isDebugEnabled());
+        QVERIFY(!berlin2.isDebugEnabled());
+        QVERIFY(!oslo.isDebugEnabled());
+        QVERIFY(oulu.isDebugEnabled());
+
+        // added exact rule
+        QLoggingCategory::setFilterRules("Digia.*.debug=false\nDigia.Oslo.debug=true");
+        QVERIFY(!berlin.isDebugEnabled());
+        QVERIFY(oslo.isDebugEnabled());
+        QVERIFY(oulu.isDebugEnabled());
+
+        // reordered rules
+        QLoggingCategory::setFilterRules("Digia.Oslo.debug=true\nDigia.*.debug=false");
+        QVERIFY(!oslo.isDebugEnabled());
+
+        // removed prefix rule
+        QLoggingCategory::setFilterRules("Digia.Oslo.debug=true");
+        QVERIFY(berlin.isDebugEnabled());
+        QVERIFY(berlin2.isDebugEnabled());
+        QVERIFY(oslo.isDebugEnabled());
+
+        // suffix rule
+        QLoggingCategory::setFilterRules("Digia.Oslo.debug=true\n*.Oulu.warning=false");
+        QVERIFY(!oulu.isWarningEnabled());
+        QVERIFY(berlin.isWarningEnabled());
+
+        // categories registered later get the current rules
+        QLoggingCategory tampere("Qt.Tampere.Oulu");
+        QVERIFY(!tampere.isWarningEnabled());
+
+        QLoggingCategory::setFilterRules(QString());
+        QVERIFY(oulu.isWarningEnabled());
+        QVERIFY(tampere.isWarningEnabled());
+    }
 
     void QLoggingRegistry_checkErrors()
     {
@@ -147,6 +147,11 @@ private slots:
     void setPath();
     void setDefaultFormat();
     void dontCreateNeedlessPaths();
+    void dontRewriteUnchangedFile();
+    void logFormatAppends();
+    void logFormatIgnoresIncompleteBatch();
+    void logFormatCompacts();
+    void logFormatChanged();
 #if !defined(Q_OS_WIN) && !defined(QT_QSETTINGS_ALWAYS_CASE_SENSITIVE_AND_FORGET_ORIGINAL_KEY_ORDER)
     void dontReorderIniKeysNeedlessly();
 #endif
@@ -280,6 +285,7 @@ static void populateWithFormats()
     QTest::newRow("ini") << QSettings::IniFormat;
     QTest::newRow("custom1") << QSettings::CustomFormat1;
     QTest::newRow("custom2") << QSettings::CustomFormat2;
+    QTest::newRow("log") << QSettings::LogFormat;
 }
 
 tst_QSettings::tst_QSettings()
@@ -1323,7 +1329,7 @@ void tst_QSettings::testVariantTypes()
 
     // We store key sequences as strings instead of binary variant blob, for improved
     // readability in the resulting format.
-    if (format >= QSettings::InvalidFormat) {
+    if (format >= QSettings::InvalidFormat || format == QSettings::LogFormat) {
         testVal("keysequence", QKeySequence(Qt::ControlModifier + Qt::Key_F1), QKeySequence, KeySequence);
     } else {
         testVal("keysequence", QKeySequence(Qt::ControlModifier + Qt::Key_F1), QString, String);
@@ -3401,6 +3407,249 @@ void tst_QSettings::dontCreateNeedlessPaths()
     QVERIFY(!fileInfo.dir().exists());
 }
 
+void tst_QSettings::dontRewriteUnchangedFile()
+{
+    /*
+        Setting values that are already stored, or removing keys that
+        do not exist, must not rewrite the file. A rewrite would drop
+        the comment.
+    */
+    const QByteArray contents = "; comment\n[General]\nalpha=1\nbeta=two\n"
+                                "list=a, b\nsize=@Size(3 4)\n";
+
+    QTemporaryFile file;
+    QVERIFY2(file.open(), qPrintable(file.errorString()));
+    file.write(contents);
+    const QString fileName = file.fileName();
+    file.close();
+
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        settings.setValue("alpha", 1);
+        settings.setValue("beta", QString("two"));
+        settings.setValue("list", QStringList() << "a" << "b");
+        settings.setValue("size", QSize(3, 4));
+        settings.remove("gamma");
+        settings.sync();
+        QCOMPARE(settings.status(), QSettings::NoError);
+        QCOMPARE(settings.value("alpha").type(), QVariant::Int);
+    }
+
+    // QSaveFile replaces the file, so don't reopen the QTemporaryFile
+    QFile savedFile(fileName);
+    QVERIFY(savedFile.open(QIODevice::ReadOnly));
+    QCOMPARE(savedFile.readAll(), contents);
+    savedFile.close();
+
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        settings.setValue("beta", QString("three"));
+        settings.sync();
+        QCOMPARE(settings.status(), QSettings::NoError);
+    }
+
+    QVERIFY(savedFile.open(QIODevice::ReadOnly));
+    QCOMPARE(savedFile.readAll().replace("\r\n", "\n"),
+             QByteArray("[General]\nalpha=1\nbeta=three\nlist=a, b\nsize=@Size(3 4)\n"));
+    savedFile.close();
+}
+
+/*
+    Returns another name for \a fileName, so that a QSettings object opened
+    with it doesn't share its state with the ones opened with \a fileName,
+    like a QSettings object in another process wouldn't.
+*/
+static QString otherLogFileName(const QString &fileName)
+{
+    const QString link = fileName + QLatin1String(".link");
+    QFile::remove(link);
+    return QFile::link(fileName, link) ? link : QString();
+}
+
+static QByteArray fileContents(const QString &fileName)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+void tst_QSettings::logFormatAppends()
+{
+    QDir().mkpath(settingsPath());
+    const QString fileName = settingsPath("appends.conflog");
+    const QString otherFileName = otherLogFileName(fileName);
+    if (otherFileName.isEmpty())
+        QSKIP("This test needs symbolic links");
+
+    QSettings settings(fileName, QSettings::LogFormat);
+    settings.setValue("alpha", 1);
+    settings.beginGroup("group");
+    settings.setValue("size", QSize(3, 4));
+    settings.setValue("list", QVariantList() << 1 << QString("two"));
+    settings.endGroup();
+    settings.beginWriteArray("array");
+    for (int i = 0; i < 3; ++i) {
+        settings.setArrayIndex(i);
+        settings.setValue("value", i * 10);
+    }
+    settings.endArray();
+    settings.sync();
+    QCOMPARE(settings.status(), QSettings::NoError);
+    const QByteArray before = fileContents(fileName);
+
+    settings.setValue("alpha", QStringList() << "a" << "b");
+    settings.remove("group/size");
+    settings.sync();
+    QCOMPARE(settings.status(), QSettings::NoError);
+    const QByteArray after = fileContents(fileName);
+    QVERIFY(after.size() > before.size());
+    QVERIFY(after.startsWith(before));
+
+    QSettings other(otherFileName, QSettings::LogFormat);
+    QCOMPARE(other.status(), QSettings::NoError);
+    QCOMPARE(other.value("alpha").type(), QVariant::StringList);
+    QCOMPARE(other.value("alpha").toStringList(), QStringList() << "a" << "b");
+    QCOMPARE(other.childGroups(), QStringList() << "array" << "group");
+    QVERIFY(!other.contains("group/size"));
+    QCOMPARE(other.value("group/list").toList(), QVariantList() << 1 << QString("two"));
+    QCOMPARE(other.beginReadArray("array"), 3);
+    other.setArrayIndex(2);
+    QCOMPARE(other.value("value").type(), QVariant::Int);
+    QCOMPARE(other.value("value").toInt(), 20);
+    other.endArray();
+
+    other.setValue("beta", 2.5);
+    other.remove("array");
+    other.sync();
+    QCOMPARE(other.status(), QSettings::NoError);
+
+    settings.sync();
+    QCOMPARE(settings.value("beta").type(), QVariant::Double);
+    QCOMPARE(settings.value("beta").toDouble(), 2.5);
+    QCOMPARE(settings.childGroups(), QStringList() << "group");
+}
+
+void tst_QSettings::logFormatIgnoresIncompleteBatch()
+{
+    QDir().mkpath(settingsPath());
+    const QString fileName = settingsPath("incomplete.conflog");
+    const QString writerFileName = otherLogFileName(fileName);
+    if (writerFileName.isEmpty())
+        QSKIP("This test needs symbolic links");
+
+    {
+        QSettings settings(writerFileName, QSettings::LogFormat);
+        settings.setValue("alpha", 1);
+        settings.sync();
+        settings.setValue("alpha", 2);
+        settings.setValue("beta", 2);
+    }
+
+    // a writer that crashed before writing the end of its batch
+    QVERIFY(QFile::resize(fileName, QFileInfo(fileName).size() - 1));
+
+    {
+        QSettings settings(fileName, QSettings::LogFormat);
+        QCOMPARE(settings.status(), QSettings::NoError);
+        QCOMPARE(settings.value("alpha").toInt(), 1);
+        QVERIFY(!settings.contains("beta"));
+
+        settings.setValue("gamma", 3);
+        settings.sync();
+        QCOMPARE(settings.status(), QSettings::NoError);
+    }
+
+    // the next batch must replace the incomplete one, not follow it
+    const QString readerFileName = settingsPath("incomplete.reader");
+    QVERIFY(QFile::link(fileName, readerFileName));
+    QSettings settings(readerFileName, QSettings::LogFormat);
+    QCOMPARE(settings.status(), QSettings::NoError);
+    QCOMPARE(settings.value("alpha").toInt(), 1);
+    QVERIFY(!settings.contains("beta"));
+    QCOMPARE(settings.value("gamma").toInt(), 3);
+}
+
+void tst_QSettings::logFormatCompacts()
+{
+    QDir().mkpath(settingsPath());
+    const QString fileName = settingsPath("compacts.conflog");
+    const QString otherFileName = otherLogFileName(fileName);
+    if (otherFileName.isEmpty())
+        QSKIP("This test needs symbolic links");
+
+    QSettings settings(fileName, QSettings::LogFormat);
+    for (int i = 0; i < 50; ++i)
+        settings.setValue(QString("key%1").arg(i), i);
+    settings.sync();
+
+    QSettings other(otherFileName, QSettings::LogFormat);
+    QCOMPARE(other.value("key49").toInt(), 49);
+
+    const qint64 initialSize = QFileInfo(fileName).size();
+    settings.setValue("counter", 0);
+    settings.sync();
+    const qint64 batchSize = QFileInfo(fileName).size() - initialSize;
+
+    const int count = 2000;
+    for (int i = 1; i < count; ++i) {
+        settings.setValue("counter", i);
+        settings.sync();
+    }
+    QCOMPARE(settings.status(), QSettings::NoError);
+    QVERIFY(QFileInfo(fileName).size() < initialSize + count * batchSize / 4);
+
+    other.sync();
+    QCOMPARE(other.status(), QSettings::NoError);
+    QCOMPARE(other.value("counter").toInt(), count - 1);
+    QCOMPARE(other.value("key0").toInt(), 0);
+    QCOMPARE(other.value("key49").toInt(), 49);
+    QCOMPARE(other.allKeys().size(), 51);
+}
+
+void tst_QSettings::logFormatChanged()
+{
+    QDir().mkpath(settingsPath());
+    const QString fileName = settingsPath("changed.conflog");
+    const QString otherFileName = otherLogFileName(fileName);
+    if (otherFileName.isEmpty())
+        QSKIP("This test needs symbolic links");
+
+    QSettings settings(fileName, QSettings::LogFormat);
+    settings.setValue("alpha", 1);
+    settings.sync();
+
+    QSignalSpy spy(&settings, &QSettings::changed);
+    settings.setValue("alpha", 2);
+    settings.sync();
+
+    QSettings other(otherFileName, QSettings::LogFormat);
+    QCOMPARE(other.value("alpha").toInt(), 2);
+    other.setValue("alpha", 3);
+    other.sync();
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(settings.value("alpha").toInt(), 3);
+
+    // enough changes for the file to be compacted, i.e. replaced
+    for (int i = 0; i < 500; ++i) {
+        other.setValue("beta", i);
+        other.sync();
+    }
+    QTRY_VERIFY(spy.count() > 1);
+    QTRY_COMPARE(settings.value("beta").toInt(), 499);
+
+    const int changes = spy.count();
+    other.setValue("gamma", 1);
+    other.sync();
+    QTRY_VERIFY(spy.count() > changes);
+    QCOMPARE(settings.value("gamma").toInt(), 1);
+
+    // our own changes are not reported
+    spy.clear();
+    settings.setValue("gamma", 2);
+    settings.sync();
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 0);
+}
+
 #if !defined(Q_OS_WIN) && !defined(QT_QSETTINGS_ALWAYS_CASE_SENSITIVE_AND_FORGET_ORIGINAL_KEY_ORDER)
 // This Qt build does not preserve ordering, as a code size optimization.
 void tst_QSettings::dontReorderIniKeysNeedlessly()
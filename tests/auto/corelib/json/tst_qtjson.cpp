@@ -29,12 +29,18 @@
 #include <QtTest>
 
 #include "qjsonarray.h"
+#include "qjsonbuilder.h"
 #include "qjsonobject.h"
 #include "qjsonvalue.h"
 #include "qjsondocument.h"
+#include "qjsonstream.h"
+#include "qcborstream.h"
 #include "qregularexpression.h"
+#include <cmath>
 #include <limits>
 
+Q_DECLARE_METATYPE(QCborStreamReader::Error)
+
 #define INVALID_UNICODE "\xCE\xBA\xE1"
 #define UNICODE_NON_CHARACTER "\xEF\xBF\xBF"
 #define UNICODE_DJE "\320\202" // Character from the Serbian Cyrillic alphabet
@@ -145,6 +151,34 @@ private Q_SLOTS:
     void parseErrorOffset_data();
     void parseErrorOffset();
 
+    void streamReaderTokens();
+    void streamReaderMatchesParser();
+    void streamReaderChunked();
+    void streamReaderMultipleDocuments();
+    void streamReaderIncompleteValue();
+    void streamReaderLongString();
+    void streamReaderErrors_data();
+    void streamReaderErrors();
+    void streamWriterMatchesToJson_data();
+    void streamWriterMatchesToJson();
+    void streamWriterDevice();
+    void streamWriterMisplacedValue();
+    void objectBuilder();
+    void objectBuilderDuplicates();
+    void objectBuilderReuse();
+    void arrayBuilder();
+    void cborReader_data();
+    void cborReader();
+    void cborReaderChunked_data() { cborReader_data(); }
+    void cborReaderChunked();
+    void cborReaderErrors_data();
+    void cborReaderErrors();
+    void cborWriter();
+    void cborJsonRoundTrip();
+    void cborJsonDuplicateKeys();
+    void cborTagChain();
+    void cborVariantRoundTrip();
+
 private:
     QString testDataDir;
 };
@@ -2908,5 +2942,1022 @@ void tst_QtJson::parseErrorOffset()
     QCOMPARE(error.offset, errorOffset);
 }
 
+void tst_QtJson::streamReaderTokens()
+{
+    QJsonStreamReader reader(QByteArray("{ \"a\": [1, \"two\", true, null, {}], \"b\": -2.5e1 }"));
+
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.depth(), 1);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QCOMPARE(reader.name(), QString("a"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+    QCOMPARE(reader.depth(), 2);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Value);
+    QCOMPARE(reader.value(), QJsonValue(1));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Value);
+    QCOMPARE(reader.value(), QJsonValue(QLatin1String("two")));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Value);
+    QCOMPARE(reader.value(), QJsonValue(true));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Value);
+    QCOMPARE(reader.value(), QJsonValue(QJsonValue::Null));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndArray);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QCOMPARE(reader.name(), QString("b"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Value);
+    QCOMPARE(reader.value(), QJsonValue(-25));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndObject);
+    QCOMPARE(reader.depth(), 0);
+    QVERIFY(!reader.atEnd());
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(reader.atEnd());
+    QVERIFY(!reader.hasError());
+}
+
+void tst_QtJson::streamReaderMatchesParser()
+{
+    const QString files[] = { "/test.json", "/test2.json", "/test3.json", "/bom.json" };
+    for (const QString &fileName : files) {
+        QFile file(testDataDir + fileName);
+        QVERIFY(file.open(QFile::ReadOnly));
+        const QByteArray json = file.readAll();
+        const QJsonDocument doc = QJsonDocument::fromJson(json);
+        QVERIFY(!doc.isNull());
+
+        QVERIFY(file.seek(0));
+        QJsonStreamReader reader(&file);
+        reader.readNext();
+        const QJsonValue value = reader.readCurrentValue();
+        QVERIFY2(!reader.hasError(), qPrintable(fileName + ": " + reader.errorString()));
+        if (doc.isObject())
+            QCOMPARE(value.toObject(), doc.object());
+        else
+            QCOMPARE(value.toArray(), doc.array());
+        QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    }
+}
+
+void tst_QtJson::streamReaderChunked()
+{
+    QFile file(testDataDir + "/test.json");
+    QVERIFY(file.open(QFile::ReadOnly));
+    const QByteArray json = file.readAll();
+
+    QJsonStreamReader reference(json);
+    QStringList expected;
+    while (reference.readNext() != QJsonStreamReader::NoToken) {
+        QVERIFY(!reference.hasError());
+        expected << reference.tokenString() + reference.name()
+                    + QString::number(reference.value().type());
+    }
+
+    // feed the document a few bytes at a time, splitting every token
+    QJsonStreamReader reader;
+    QStringList tokens;
+    for (int i = 0; i < json.size(); i += 3) {
+        reader.addData(json.mid(i, 3));
+        while (true) {
+            const QJsonStreamReader::TokenType token = reader.readNext();
+            if (token == QJsonStreamReader::NoToken || token == QJsonStreamReader::Invalid)
+                break;
+            tokens << reader.tokenString() + reader.name() + QString::number(reader.value().type());
+        }
+    }
+    QVERIFY(!reader.hasError());
+    QVERIFY(reader.atEnd());
+    QCOMPARE(tokens, expected);
+}
+
+void tst_QtJson::streamReaderLongString()
+{
+    // a string arriving in many chunks, with escaped quotes and
+    // backslashes split across chunk boundaries
+    QString expected;
+    QByteArray json = "[\"";
+    for (int i = 0; i < 1000; ++i) {
+        expected += QLatin1String("ab\"\\c");
+        json += "ab\\\"\\\\c";
+    }
+    json += "\"]";
+
+    for (int chunkSize : { 1, 2, 3, 7 }) {
+        QJsonStreamReader reader;
+        QJsonStreamReader::TokenType token = QJsonStreamReader::NoToken;
+        int i = 0;
+        QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+        while (token != QJsonStreamReader::Value && i < json.size()) {
+            reader.addData(json.mid(i, chunkSize));
+            i += chunkSize;
+            token = reader.readNext();
+            if (token == QJsonStreamReader::Invalid)
+                QCOMPARE(reader.error(), QJsonParseError::UnterminatedString);
+            else if (token != QJsonStreamReader::StartArray)
+                QCOMPARE(token, QJsonStreamReader::Value);
+        }
+        QCOMPARE(token, QJsonStreamReader::Value);
+        QCOMPARE(reader.value().toString(), expected);
+    }
+}
+
+void tst_QtJson::streamReaderMultipleDocuments()
+{
+    QByteArray json = "{\"id\": 1}\n{\"id\": 2}\n[3]\n";
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QJsonStreamReader reader(&buffer);
+
+    QVector<QJsonValue> documents;
+    while (reader.readNext() != QJsonStreamReader::NoToken) {
+        QVERIFY(!reader.hasError());
+        documents << reader.readCurrentValue();
+    }
+    QCOMPARE(documents.size(), 3);
+    QCOMPARE(documents.at(0).toObject().value("id"), QJsonValue(1));
+    QCOMPARE(documents.at(1).toObject().value("id"), QJsonValue(2));
+    QCOMPARE(documents.at(2).toArray(), QJsonArray({ 3 }));
+
+    // skipping works the same way
+    QVERIFY(buffer.seek(0));
+    reader.setDevice(&buffer);
+    int count = 0;
+    while (reader.readNext() != QJsonStreamReader::NoToken) {
+        reader.skipCurrentValue();
+        QCOMPARE(reader.depth(), 0);
+        ++count;
+    }
+    QCOMPARE(count, 3);
+}
+
+void tst_QtJson::streamReaderErrors_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<int>("error");
+
+    // the same error the parser reports for a document
+    const QByteArray documents[] = {
+        "{ \"value\": false, }",
+        "[ false, ]",
+        "{ \"value\": , }",
+        "[ \"value\" , , ]",
+        "{ ,  \"value\": false}",
+        "[ ,  false]",
+        "  ,  ",
+        "  }  ",
+        "{ \"a\" 1 }",
+        "[ 1 2 ]",
+        "[ tru ]",
+        "[ 1.e ]",
+        "[ \"\\u12\" ]",
+        "[ \"" INVALID_UNICODE "\" ]",
+        "{ \"a\": 1",
+        "[ 1,",
+        "[ \"abc",
+        "[ 12"
+    };
+    for (const QByteArray &json : documents) {
+        QJsonParseError error;
+        QJsonDocument::fromJson(json, &error);
+        QTest::newRow(json.constData()) << json << int(error.error);
+    }
+
+    QByteArray deep(2000, '[');
+    deep += QByteArray(2000, ']');
+    QTest::newRow("deep nesting") << deep << int(QJsonParseError::DeepNesting);
+}
+
+void tst_QtJson::streamReaderErrors()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(int, error);
+    QVERIFY(error != QJsonParseError::NoError);
+
+    QJsonStreamReader reader(json);
+    while (reader.readNext() != QJsonStreamReader::Invalid)
+        QVERIFY(reader.tokenType() != QJsonStreamReader::NoToken);
+    QVERIFY(reader.hasError());
+    QVERIFY(reader.atEnd());
+    QCOMPARE(int(reader.error()), error);
+    QVERIFY(!reader.errorString().isEmpty());
+}
+
+void tst_QtJson::streamWriterMatchesToJson_data()
+{
+    QTest::addColumn<QJsonDocument>("document");
+
+    QFile file(testDataDir + "/test.json");
+    QVERIFY(file.open(QFile::ReadOnly));
+    QTest::newRow("test.json") << QJsonDocument::fromJson(file.readAll());
+
+    QJsonObject object;
+    object.insert("empty object", QJsonObject());
+    object.insert("empty array", QJsonArray());
+    object.insert("escapes", QString::fromUtf8("\"\\\b\f\n\r\t\x01 " UNICODE_DJE));
+    object.insert("numbers", QJsonArray({ 0, -1, 1.5, 1e300, std::numeric_limits<double>::infinity() }));
+    QTest::newRow("object") << QJsonDocument(object);
+    QTest::newRow("nested arrays") << QJsonDocument(QJsonArray({ QJsonArray(), QJsonArray({ 1, QJsonArray({ 2 }) }) }));
+}
+
+void tst_QtJson::streamWriterMatchesToJson()
+{
+    QFETCH(QJsonDocument, document);
+    QVERIFY(!document.isNull());
+    const QJsonValue value = document.isObject() ? QJsonValue(document.object())
+                                                 : QJsonValue(document.array());
+
+    QByteArray indented;
+    {
+        QJsonStreamWriter writer(&indented);
+        writer.writeValue(value);
+        QCOMPARE(writer.depth(), 0);
+    }
+    QCOMPARE(indented, document.toJson(QJsonDocument::Indented));
+
+    QByteArray compact;
+    {
+        QJsonStreamWriter writer(&compact);
+        writer.setFormat(QJsonDocument::Compact);
+        writer.writeValue(value);
+    }
+    QCOMPARE(compact, document.toJson(QJsonDocument::Compact) + '\n');
+}
+
+void tst_QtJson::streamWriterDevice()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    {
+        QJsonStreamWriter writer(&buffer);
+        writer.setFormat(QJsonDocument::Compact);
+        for (int i = 0; i < 3; ++i) {
+            writer.writeStartObject();
+            writer.writeMember("id", i);
+            writer.writeName("values");
+            writer.writeStartArray();
+            writer.writeValue(QString::number(i));
+            writer.writeValue(QJsonObject({ { "x", true } }));
+            writer.writeEndArray();
+            writer.writeEndObject();
+            QVERIFY(!writer.hasError());
+        }
+    }
+    QCOMPARE(buffer.data(), QByteArray("{\"id\":0,\"values\":[\"0\",{\"x\":true}]}\n"
+                                       "{\"id\":1,\"values\":[\"1\",{\"x\":true}]}\n"
+                                       "{\"id\":2,\"values\":[\"2\",{\"x\":true}]}\n"));
+
+    // and it reads back
+    buffer.close();
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QJsonStreamReader reader(&buffer);
+    int count = 0;
+    while (reader.readNext() == QJsonStreamReader::StartObject) {
+        const QJsonObject object = reader.readCurrentValue().toObject();
+        QCOMPARE(object.value("id"), QJsonValue(count++));
+    }
+    QVERIFY(!reader.hasError());
+    QCOMPARE(count, 3);
+}
+
+void tst_QtJson::streamReaderIncompleteValue()
+{
+    const QByteArray json = "{\"a\": {\"b\": [1, 2, {\"c\": \"text\"}], \"d\": null}, \"e\": [true]}";
+    QJsonStreamReader reference(json);
+    reference.readNext();
+    const QJsonValue expected = reference.readCurrentValue();
+    QVERIFY(!reference.hasError());
+
+    // the value is complete only with the last chunk; until then, the
+    // reader goes back to where it started
+    for (int chunkSize : { 1, 4, 9 }) {
+        QJsonStreamReader reader;
+        int i = 0;
+        while (reader.tokenType() != QJsonStreamReader::StartObject) {
+            reader.addData(json.mid(i, chunkSize));
+            i += chunkSize;
+            reader.readNext();
+        }
+        QJsonValue value;
+        while (true) {
+            value = reader.readCurrentValue();
+            if (!reader.hasError())
+                break;
+            QCOMPARE(reader.tokenType(), QJsonStreamReader::StartObject);
+            QCOMPARE(reader.depth(), 1);
+            QVERIFY(i < json.size());
+            reader.addData(json.mid(i, chunkSize));
+            i += chunkSize;
+        }
+        QCOMPARE(value, expected);
+        QCOMPARE(reader.tokenType(), QJsonStreamReader::EndObject);
+        QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    }
+
+    // the same for the value of a member
+    QJsonStreamReader reader("{\"a\": [1, ");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QVERIFY(reader.readCurrentValue().isUndefined());
+    QCOMPARE(reader.error(), QJsonParseError::UnterminatedArray);
+    QCOMPARE(reader.tokenType(), QJsonStreamReader::Name);
+    QCOMPARE(reader.name(), QString("a"));
+    reader.addData("2]}");
+    QCOMPARE(reader.readCurrentValue(), QJsonValue(QJsonArray({ 1, 2 })));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndObject);
+}
+
+void tst_QtJson::streamWriterMisplacedValue()
+{
+    QByteArray json;
+    {
+        QJsonStreamWriter writer(&json);
+        writer.setFormat(QJsonDocument::Compact);
+        writer.writeStartObject();
+        writer.writeMember("a", 1);
+
+        // no name: neither the object nor its members may be written
+        QTest::ignoreMessage(QtWarningMsg, "QJsonStreamWriter::writeValue: a member needs a name");
+        writer.writeValue(QJsonObject({ { "b", 2 } }));
+        QTest::ignoreMessage(QtWarningMsg, "QJsonStreamWriter::writeValue: a member needs a name");
+        writer.writeValue(QJsonArray({ 3 }));
+        QCOMPARE(writer.depth(), 1);
+
+        writer.writeName("c");
+        QTest::ignoreMessage(QtWarningMsg, "QJsonStreamWriter::writeEndObject: member \"c\" has no value");
+        writer.writeEndObject();
+        QCOMPARE(writer.depth(), 1);
+
+        writer.writeValue(4);
+        writer.writeEndObject();
+        QCOMPARE(writer.depth(), 0);
+    }
+    QCOMPARE(json, QByteArray("{\"a\":1,\"c\":4}\n"));
+}
+
+void tst_QtJson::objectBuilder()
+{
+    QJsonObject expected;
+    QJsonObjectBuilder builder;
+    QCOMPARE(builder.count(), 0);
+    QVERIFY(builder.toObject().isEmpty());
+
+    // insert in an order that is neither sorted nor reverse sorted, and
+    // mix compressed (latin1) with uncompressed keys
+    const QString keys[] = {
+        QStringLiteral("m"), QStringLiteral("a"), QStringLiteral("zz"),
+        QString::fromUtf8("\xc3\xa9t\xc3\xa9"), QStringLiteral("b"),
+        QString::fromUtf8("\xe2\x82\xac"), QString(), QStringLiteral("aa")
+    };
+    const QJsonValue values[] = {
+        QJsonValue(1), QJsonValue(-2.5), QJsonValue(true), QJsonValue(QJsonValue::Null),
+        QJsonValue(QStringLiteral("latin1")), QJsonValue(QString::fromUtf8("\xe2\x82\xac")),
+        QJsonValue(QJsonObject({ { "x", 1 }, { "y", QJsonArray({ 1, 2, 3 }) } })),
+        QJsonValue(QJsonArray({ QStringLiteral("a"), QJsonObject(), 1.5 }))
+    };
+    Q_STATIC_ASSERT(sizeof(keys) / sizeof(keys[0]) == sizeof(values) / sizeof(values[0]));
+    for (uint i = 0; i < sizeof(keys) / sizeof(keys[0]); ++i) {
+        expected.insert(keys[i], values[i]);
+        builder.insert(keys[i], values[i]);
+    }
+    QCOMPARE(builder.count(), int(sizeof(keys) / sizeof(keys[0])));
+
+    const QJsonObject object = builder.toObject();
+    QCOMPARE(object, expected);
+    QCOMPARE(object.keys(), expected.keys());
+    for (const QString &key : keys)
+        QCOMPARE(object.value(key), expected.value(key));
+    QCOMPARE(QJsonDocument(object).toJson(), QJsonDocument(expected).toJson());
+    QCOMPARE(QJsonDocument::fromBinaryData(QJsonDocument(object).toBinaryData()).object(), expected);
+
+    // the result is a regular object that can be modified further
+    QJsonObject copy = object;
+    copy.insert(QStringLiteral("new"), 42);
+    copy.remove(QStringLiteral("a"));
+    expected.insert(QStringLiteral("new"), 42);
+    expected.remove(QStringLiteral("a"));
+    QCOMPARE(copy, expected);
+    QCOMPARE(object.value(QStringLiteral("a")), QJsonValue(-2.5));
+}
+
+void tst_QtJson::objectBuilderDuplicates()
+{
+    QJsonObjectBuilder builder;
+    builder.insert(QStringLiteral("key"), 1);
+    builder.insert(QStringLiteral("other"), 2);
+    builder.insert(QStringLiteral("key"), QStringLiteral("two"));
+    builder.insert(QStringLiteral("gone"), 3);
+    builder.insert(QStringLiteral("gone"), QJsonValue(QJsonValue::Undefined));
+    builder.insert(QStringLiteral("back"), QJsonValue(QJsonValue::Undefined));
+    builder.insert(QStringLiteral("back"), false);
+
+    QJsonObject expected;
+    expected.insert(QStringLiteral("key"), 1);
+    expected.insert(QStringLiteral("other"), 2);
+    expected.insert(QStringLiteral("key"), QStringLiteral("two"));
+    expected.insert(QStringLiteral("gone"), 3);
+    expected.insert(QStringLiteral("gone"), QJsonValue(QJsonValue::Undefined));
+    expected.insert(QStringLiteral("back"), QJsonValue(QJsonValue::Undefined));
+    expected.insert(QStringLiteral("back"), false);
+
+    const QJsonObject object = builder.toObject();
+    QCOMPARE(object, expected);
+    QCOMPARE(object.size(), 3);
+    QVERIFY(!object.contains(QStringLiteral("gone")));
+    QCOMPARE(object.value(QStringLiteral("key")), QJsonValue(QStringLiteral("two")));
+
+    QJsonObjectBuilder onlyUndefined;
+    onlyUndefined.insert(QStringLiteral("a"), QJsonValue(QJsonValue::Undefined));
+    QVERIFY(onlyUndefined.toObject().isEmpty());
+}
+
+void tst_QtJson::objectBuilderReuse()
+{
+    QJsonObjectBuilder builder;
+    builder.reserve(1000);
+    QJsonObject expected;
+    for (int i = 999; i >= 0; --i) {
+        const QString key = QString::number(i * 7919 % 1000);
+        builder.insert(key, i);
+        expected.insert(key, i);
+    }
+    const QJsonObject first = builder.toObject();
+    QCOMPARE(first, expected);
+
+    // toObject() does not consume the builder
+    builder.insert(QStringLiteral("extra"), true);
+    QCOMPARE(first.size(), 1000);
+    QCOMPARE(builder.toObject().size(), 1001);
+
+    builder.clear();
+    QCOMPARE(builder.count(), 0);
+    QVERIFY(builder.toObject().isEmpty());
+
+    QVariantHash hash;
+    hash.insert(QStringLiteral("b"), 1);
+    hash.insert(QStringLiteral("a"), QStringLiteral("x"));
+    hash.insert(QStringLiteral("c"), QVariantList() << 1 << 2);
+    expected = QJsonObject();
+    for (auto it = hash.cbegin(); it != hash.cend(); ++it)
+        expected.insert(it.key(), QJsonValue::fromVariant(it.value()));
+    QCOMPARE(QJsonObject::fromVariantHash(hash), expected);
+}
+
+void tst_QtJson::arrayBuilder()
+{
+    QJsonArrayBuilder builder;
+    QVERIFY(builder.toArray().isEmpty());
+
+    QJsonArray expected;
+    const QJsonValue values[] = {
+        QJsonValue(1), QJsonValue(1.5), QJsonValue(qint64(1) << 40), QJsonValue(true),
+        QJsonValue(QJsonValue::Null), QJsonValue(QJsonValue::Undefined),
+        QJsonValue(QStringLiteral("latin1")), QJsonValue(QString::fromUtf8("\xc3\xa9t\xc3\xa9")),
+        QJsonValue(QString()), QJsonValue(QJsonObject({ { "x", 1 } })),
+        QJsonValue(QJsonArray({ 1, QJsonArray({ 2, 3 }) }))
+    };
+    builder.reserve(sizeof(values) / sizeof(values[0]));
+    for (const QJsonValue &value : values) {
+        builder.append(value);
+        expected.append(value);
+    }
+    QCOMPARE(builder.count(), int(sizeof(values) / sizeof(values[0])));
+
+    const QJsonArray array = builder.toArray();
+    QCOMPARE(array, expected);
+    QCOMPARE(QJsonDocument(array).toJson(), QJsonDocument(expected).toJson());
+
+    QJsonArray copy = array;
+    copy.prepend(0);
+    QCOMPARE(copy.size(), array.size() + 1);
+    QCOMPARE(copy.at(1), array.at(0));
+
+    builder.clear();
+    QCOMPARE(builder.count(), 0);
+    QVERIFY(builder.toArray().isEmpty());
+
+    const QStringList list = QStringList() << QStringLiteral("a") << QString() << QStringLiteral("c");
+    QCOMPARE(QJsonArray::fromStringList(list), QJsonArray({ QStringLiteral("a"), QString(), QStringLiteral("c") }));
+}
+
+// RFC 7049 diagnostic notation for the item at the reader's current token
+static QString cborDiagnostic(QCborStreamReader &reader)
+{
+    switch (reader.tokenType()) {
+    case QCborStreamReader::UnsignedInteger:
+        return QString::number(reader.toUnsignedInteger());
+    case QCborStreamReader::NegativeInteger: {
+        bool ok;
+        const qint64 i = reader.toInteger(&ok);
+        if (ok)
+            return QString::number(i);
+        return QLatin1String("-1-") + QString::number(reader.toUnsignedInteger());
+    }
+    case QCborStreamReader::HalfFloat:
+    case QCborStreamReader::Float:
+    case QCborStreamReader::Double: {
+        const double d = reader.toDouble();
+        if (qIsNaN(d))
+            return QStringLiteral("NaN");
+        if (qIsInf(d))
+            return d < 0 ? QStringLiteral("-Infinity") : QStringLiteral("Infinity");
+        if (d == 0)
+            return std::signbit(d) ? QStringLiteral("-0.0") : QStringLiteral("0.0");
+        QString s = QString::number(d, 'g', QLocale::FloatingPointShortest);
+        if (!s.contains(QLatin1Char('.')) && !s.contains(QLatin1Char('e')))
+            s += QLatin1String(".0");
+        return s;
+    }
+    case QCborStreamReader::Bool:
+        return reader.toBool() ? QStringLiteral("true") : QStringLiteral("false");
+    case QCborStreamReader::Null:
+        return QStringLiteral("null");
+    case QCborStreamReader::Undefined:
+        return QStringLiteral("undefined");
+    case QCborStreamReader::SimpleType:
+        return QString::fromLatin1("simple(%1)").arg(reader.toSimpleType());
+    case QCborStreamReader::ByteString:
+        return QLatin1String("h'") + QString::fromLatin1(reader.readByteArray().toHex())
+                + QLatin1Char('\'');
+    case QCborStreamReader::TextString:
+        return QLatin1Char('"') + reader.readString() + QLatin1Char('"');
+    case QCborStreamReader::Tag: {
+        const quint64 tag = reader.toTag();
+        reader.readNext();
+        return QString::number(tag) + QLatin1Char('(') + cborDiagnostic(reader) + QLatin1Char(')');
+    }
+    case QCborStreamReader::StartArray:
+    case QCborStreamReader::StartMap: {
+        const bool isMap = reader.isStartMap();
+        const bool lengthKnown = reader.isLengthKnown();
+        QString result = QLatin1String(isMap ? "{" : "[");
+        if (!lengthKnown)
+            result += QLatin1String("_ ");
+        for (int i = 0; ; ++i) {
+            reader.readNext();
+            if (reader.isEndArray() || reader.isEndMap() || reader.hasError())
+                break;
+            if (i)
+                result += QLatin1String(isMap && i % 2 ? ": " : ", ");
+            result += cborDiagnostic(reader);
+        }
+        return result + QLatin1String(isMap ? "}" : "]");
+    }
+    default:
+        return QStringLiteral("<") + reader.tokenString() + QLatin1Char('>');
+    }
+}
+
+void tst_QtJson::cborReader_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QString>("diagnostic");
+
+    // from RFC 7049, appendix A
+    QTest::newRow("0") << QByteArray::fromHex("00") << "0";
+    QTest::newRow("1") << QByteArray::fromHex("01") << "1";
+    QTest::newRow("23") << QByteArray::fromHex("17") << "23";
+    QTest::newRow("24") << QByteArray::fromHex("1818") << "24";
+    QTest::newRow("100") << QByteArray::fromHex("1864") << "100";
+    QTest::newRow("1000") << QByteArray::fromHex("1903e8") << "1000";
+    QTest::newRow("1000000") << QByteArray::fromHex("1a000f4240") << "1000000";
+    QTest::newRow("1000000000000") << QByteArray::fromHex("1b000000e8d4a51000") << "1000000000000";
+    QTest::newRow("2^64-1") << QByteArray::fromHex("1bffffffffffffffff") << "18446744073709551615";
+    QTest::newRow("-2^64") << QByteArray::fromHex("3bffffffffffffffff") << "-1-18446744073709551615";
+    QTest::newRow("-2^63") << QByteArray::fromHex("3b7fffffffffffffff") << "-9223372036854775808";
+    QTest::newRow("-1") << QByteArray::fromHex("20") << "-1";
+    QTest::newRow("-10") << QByteArray::fromHex("29") << "-10";
+    QTest::newRow("-100") << QByteArray::fromHex("3863") << "-100";
+    QTest::newRow("-1000") << QByteArray::fromHex("3903e7") << "-1000";
+    QTest::newRow("0.0") << QByteArray::fromHex("f90000") << "0.0";
+    QTest::newRow("-0.0") << QByteArray::fromHex("f98000") << "-0.0";
+    QTest::newRow("1.0") << QByteArray::fromHex("f93c00") << "1.0";
+    QTest::newRow("1.1") << QByteArray::fromHex("fb3ff199999999999a") << "1.1";
+    QTest::newRow("1.5") << QByteArray::fromHex("f93e00") << "1.5";
+    QTest::newRow("65504.0") << QByteArray::fromHex("f97bff") << "65504.0";
+    QTest::newRow("100000.0") << QByteArray::fromHex("fa47c35000") << "100000.0";
+    QTest::newRow("3.4028234663852886e+38") << QByteArray::fromHex("fa7f7fffff") << "3.4028234663852886e+38";
+    QTest::newRow("1.0e+300") << QByteArray::fromHex("fb7e37e43c8800759c") << "1e+300";
+    QTest::newRow("5.960464477539063e-8") << QByteArray::fromHex("f90001") << "5.960464477539063e-8";
+    QTest::newRow("0.00006103515625") << QByteArray::fromHex("f90400") << "6.103515625e-5";
+    QTest::newRow("-4.0") << QByteArray::fromHex("f9c400") << "-4.0";
+    QTest::newRow("-4.1") << QByteArray::fromHex("fbc010666666666666") << "-4.1";
+    QTest::newRow("Infinity") << QByteArray::fromHex("f97c00") << "Infinity";
+    QTest::newRow("NaN") << QByteArray::fromHex("f97e00") << "NaN";
+    QTest::newRow("-Infinity") << QByteArray::fromHex("f9fc00") << "-Infinity";
+    QTest::newRow("float Infinity") << QByteArray::fromHex("fa7f800000") << "Infinity";
+    QTest::newRow("double NaN") << QByteArray::fromHex("fb7ff8000000000000") << "NaN";
+    QTest::newRow("false") << QByteArray::fromHex("f4") << "false";
+    QTest::newRow("true") << QByteArray::fromHex("f5") << "true";
+    QTest::newRow("null") << QByteArray::fromHex("f6") << "null";
+    QTest::newRow("undefined") << QByteArray::fromHex("f7") << "undefined";
+    QTest::newRow("simple(16)") << QByteArray::fromHex("f0") << "simple(16)";
+    QTest::newRow("simple(255)") << QByteArray::fromHex("f8ff") << "simple(255)";
+    QTest::newRow("date string") << QByteArray::fromHex("c074323031332d30332d32315432303a30343a30305a")
+                                 << "0(\"2013-03-21T20:04:00Z\")";
+    QTest::newRow("epoch") << QByteArray::fromHex("c11a514b67b0") << "1(1363896240)";
+    QTest::newRow("epoch float") << QByteArray::fromHex("c1fb41d452d9ec200000") << "1(1363896240.5)";
+    QTest::newRow("base16") << QByteArray::fromHex("d74401020304") << "23(h'01020304')";
+    QTest::newRow("encoded cbor") << QByteArray::fromHex("d818456449455446") << "24(h'6449455446')";
+    QTest::newRow("url") << QByteArray::fromHex("d82076687474703a2f2f7777772e6578616d706c652e636f6d")
+                         << "32(\"http://www.example.com\")";
+    QTest::newRow("h''") << QByteArray::fromHex("40") << "h''";
+    QTest::newRow("h'01020304'") << QByteArray::fromHex("4401020304") << "h'01020304'";
+    QTest::newRow("\"\"") << QByteArray::fromHex("60") << "\"\"";
+    QTest::newRow("\"a\"") << QByteArray::fromHex("6161") << "\"a\"";
+    QTest::newRow("\"IETF\"") << QByteArray::fromHex("6449455446") << "\"IETF\"";
+    QTest::newRow("\"\\\"\\\\\"") << QByteArray::fromHex("62225c") << "\"\"\\\"";
+    QTest::newRow("\"\\u00fc\"") << QByteArray::fromHex("62c3bc") << QString::fromUtf8("\"\xc3\xbc\"");
+    QTest::newRow("\"\\u6c34\"") << QByteArray::fromHex("63e6b0b4") << QString::fromUtf8("\"\xe6\xb0\xb4\"");
+    QTest::newRow("\"\\ud800\\udd51\"") << QByteArray::fromHex("64f0908591") << QString::fromUtf8("\"\xf0\x90\x85\x91\"");
+    QTest::newRow("[]") << QByteArray::fromHex("80") << "[]";
+    QTest::newRow("[1, 2, 3]") << QByteArray::fromHex("83010203") << "[1, 2, 3]";
+    QTest::newRow("[1, [2, 3], [4, 5]]") << QByteArray::fromHex("8301820203820405") << "[1, [2, 3], [4, 5]]";
+    QTest::newRow("[1, ..., 25]") << QByteArray::fromHex("98190102030405060708090a0b0c0d0e0f101112131415161718181819")
+                                  << "[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25]";
+    QTest::newRow("{}") << QByteArray::fromHex("a0") << "{}";
+    QTest::newRow("{1: 2, 3: 4}") << QByteArray::fromHex("a201020304") << "{1: 2, 3: 4}";
+    QTest::newRow("{\"a\": 1, \"b\": [2, 3]}") << QByteArray::fromHex("a26161016162820203")
+                                               << "{\"a\": 1, \"b\": [2, 3]}";
+    QTest::newRow("[\"a\", {\"b\": \"c\"}]") << QByteArray::fromHex("826161a161626163")
+                                             << "[\"a\", {\"b\": \"c\"}]";
+    QTest::newRow("(_ h'0102', h'030405')") << QByteArray::fromHex("5f42010243030405ff") << "h'0102030405'";
+    QTest::newRow("(_ \"strea\", \"ming\")") << QByteArray::fromHex("7f657374726561646d696e67ff") << "\"streaming\"";
+    QTest::newRow("(_ )") << QByteArray::fromHex("7fff") << "\"\"";
+    QTest::newRow("[_ ]") << QByteArray::fromHex("9fff") << "[_ ]";
+    QTest::newRow("[_ 1, [2, 3], [_ 4, 5]]") << QByteArray::fromHex("9f018202039f0405ffff")
+                                             << "[_ 1, [2, 3], [_ 4, 5]]";
+    QTest::newRow("[_ 1, [2, 3], [4, 5]]") << QByteArray::fromHex("9f01820203820405ff")
+                                           << "[_ 1, [2, 3], [4, 5]]";
+    QTest::newRow("[1, [2, 3], [_ 4, 5]]") << QByteArray::fromHex("83018202039f0405ff")
+                                           << "[1, [2, 3], [_ 4, 5]]";
+    QTest::newRow("[1, [_ 2, 3], [4, 5]]") << QByteArray::fromHex("83019f0203ff820405")
+                                           << "[1, [_ 2, 3], [4, 5]]";
+    QTest::newRow("{_ \"a\": 1, \"b\": [_ 2, 3]}") << QByteArray::fromHex("bf61610161629f0203ffff")
+                                                   << "{_ \"a\": 1, \"b\": [_ 2, 3]}";
+    QTest::newRow("[\"a\", {_ \"b\": \"c\"}]") << QByteArray::fromHex("826161bf61626163ff")
+                                               << "[\"a\", {_ \"b\": \"c\"}]";
+    QTest::newRow("{_ \"Fun\": true, \"Amt\": -2}") << QByteArray::fromHex("bf6346756ef563416d7421ff")
+                                                    << "{_ \"Fun\": true, \"Amt\": -2}";
+    QTest::newRow("nested tags") << QByteArray::fromHex("c1c2820102") << "1(2([1, 2]))";
+}
+
+void tst_QtJson::cborReader()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QString, diagnostic);
+
+    QCborStreamReader reader(data);
+    QCOMPARE(reader.tokenType(), QCborStreamReader::NoToken);
+    reader.readNext();
+    QCOMPARE(cborDiagnostic(reader), diagnostic);
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    QCOMPARE(reader.depth(), 0);
+    QCOMPARE(reader.readNext(), QCborStreamReader::NoToken);
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.offset(), qint64(data.size()));
+
+    // the same item twice in a row, skipped the first time
+    QCborStreamReader twice(data + data);
+    twice.readNext();
+    twice.skipCurrentValue();
+    QVERIFY(!twice.hasError());
+    twice.readNext();
+    QCOMPARE(cborDiagnostic(twice), diagnostic);
+    QCOMPARE(twice.readNext(), QCborStreamReader::NoToken);
+}
+
+void tst_QtJson::cborReaderChunked()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QString, diagnostic);
+
+    // feed the data one byte at a time; every token that is not complete
+    // yet has to be rescanned
+    QCborStreamReader reader;
+    QStringList tokens;
+    for (char c : qAsConst(data)) {
+        reader.addData(QByteArray(1, c));
+        while (true) {
+            const QCborStreamReader::TokenType token = reader.readNext();
+            if (token == QCborStreamReader::NoToken)
+                break;
+            if (token == QCborStreamReader::Invalid) {
+                QCOMPARE(reader.error(), QCborStreamReader::UnexpectedEnd);
+                break;
+            }
+            if (reader.isString())
+                tokens << QString::fromLatin1(reader.readByteArray().toHex());
+            else
+                tokens << reader.tokenString();
+        }
+    }
+    QVERIFY(reader.atEnd());
+    QVERIFY(!reader.hasError());
+
+    QCborStreamReader whole(data);
+    QStringList expected;
+    while (whole.readNext() != QCborStreamReader::NoToken) {
+        if (whole.isString())
+            expected << QString::fromLatin1(whole.readByteArray().toHex());
+        else
+            expected << whole.tokenString();
+    }
+    QCOMPARE(tokens, expected);
+
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QCborStreamReader device(&buffer);
+    device.readNext();
+    QCOMPARE(cborDiagnostic(device), diagnostic);
+    QCOMPARE(device.readNext(), QCborStreamReader::NoToken);
+}
+
+void tst_QtJson::cborReaderErrors_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QCborStreamReader::Error>("error");
+
+    QTest::newRow("truncated integer") << QByteArray::fromHex("1903") << QCborStreamReader::UnexpectedEnd;
+    QTest::newRow("truncated string") << QByteArray::fromHex("64494554") << QCborStreamReader::UnexpectedEnd;
+    QTest::newRow("truncated array") << QByteArray::fromHex("830102") << QCborStreamReader::UnexpectedEnd;
+    QTest::newRow("unterminated array") << QByteArray::fromHex("9f0102") << QCborStreamReader::UnexpectedEnd;
+    QTest::newRow("dangling tag") << QByteArray::fromHex("c1") << QCborStreamReader::UnexpectedEnd;
+    QTest::newRow("reserved info") << QByteArray::fromHex("1c") << QCborStreamReader::IllegalNumber;
+    QTest::newRow("indefinite integer") << QByteArray::fromHex("1f") << QCborStreamReader::IllegalNumber;
+    QTest::newRow("indefinite tag") << QByteArray::fromHex("df") << QCborStreamReader::IllegalNumber;
+    QTest::newRow("integer chunk") << QByteArray::fromHex("5f00ff") << QCborStreamReader::IllegalType;
+    QTest::newRow("text chunk in bytes") << QByteArray::fromHex("5f6161ff") << QCborStreamReader::IllegalType;
+    QTest::newRow("nested indefinite chunk") << QByteArray::fromHex("5f5fffff") << QCborStreamReader::IllegalType;
+    QTest::newRow("two-byte simple below 32") << QByteArray::fromHex("f814") << QCborStreamReader::IllegalType;
+    QTest::newRow("top-level break") << QByteArray::fromHex("ff") << QCborStreamReader::UnexpectedBreak;
+    QTest::newRow("break in definite array") << QByteArray::fromHex("8201ff") << QCborStreamReader::UnexpectedBreak;
+    QTest::newRow("break after key") << QByteArray::fromHex("bf6161ff") << QCborStreamReader::UnexpectedBreak;
+    QTest::newRow("break after tag") << QByteArray::fromHex("9fc1ff") << QCborStreamReader::UnexpectedBreak;
+    QTest::newRow("invalid utf8") << QByteArray::fromHex("62c328") << QCborStreamReader::InvalidUtf8String;
+    QTest::newRow("truncated utf8") << QByteArray::fromHex("61c3") << QCborStreamReader::InvalidUtf8String;
+    QTest::newRow("utf8 split over chunks") << QByteArray::fromHex("7f61c361bcff") << QCborStreamReader::InvalidUtf8String;
+    QTest::newRow("huge string") << QByteArray::fromHex("5b0000000100000000") << QCborStreamReader::DataTooLarge;
+    QTest::newRow("deep nesting") << QByteArray(2000, char(0x81)) << QCborStreamReader::NestingTooDeep;
+    QTest::newRow("long tag chain") << QByteArray(100000, char(0xc1)) << QCborStreamReader::UnexpectedEnd;
+}
+
+void tst_QtJson::cborReaderErrors()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QCborStreamReader::Error, error);
+
+    QCborStreamReader reader(data);
+    reader.readNext();
+    const QVariant v = reader.readVariant();
+    QVERIFY(reader.hasError());
+    QVERIFY(!v.isValid());
+    QCOMPARE(reader.error(), error);
+    QCOMPARE(reader.tokenType(), QCborStreamReader::Invalid);
+    QVERIFY(!reader.errorString().isEmpty());
+    QVERIFY(reader.atEnd());
+}
+
+template <typename Writer>
+static QByteArray cborEncode(Writer write)
+{
+    QByteArray data;
+    QCborStreamWriter writer(&data);
+    write(writer);
+    return data;
+}
+
+void tst_QtJson::cborWriter()
+{
+#define ENCODE(expr) cborEncode([&](QCborStreamWriter &w) { expr; }).toHex()
+    QCOMPARE(ENCODE(w.append(0)), QByteArray("00"));
+    QCOMPARE(ENCODE(w.append(23)), QByteArray("17"));
+    QCOMPARE(ENCODE(w.append(24)), QByteArray("1818"));
+    QCOMPARE(ENCODE(w.append(1000)), QByteArray("1903e8"));
+    QCOMPARE(ENCODE(w.append(1000000)), QByteArray("1a000f4240"));
+    QCOMPARE(ENCODE(w.append(Q_UINT64_C(1000000000000))), QByteArray("1b000000e8d4a51000"));
+    QCOMPARE(ENCODE(w.append(std::numeric_limits<quint64>::max())), QByteArray("1bffffffffffffffff"));
+    QCOMPARE(ENCODE(w.appendNegativeInteger(std::numeric_limits<quint64>::max())), QByteArray("3bffffffffffffffff"));
+    QCOMPARE(ENCODE(w.append(std::numeric_limits<qint64>::min())), QByteArray("3b7fffffffffffffff"));
+    QCOMPARE(ENCODE(w.append(-1)), QByteArray("20"));
+    QCOMPARE(ENCODE(w.append(-1000)), QByteArray("3903e7"));
+    QCOMPARE(ENCODE(w.append(1000L)), QByteArray("1903e8"));
+    QCOMPARE(ENCODE(w.append(-1000L)), QByteArray("3903e7"));
+    QCOMPARE(ENCODE(w.append(1000UL)), QByteArray("1903e8"));
+    QCOMPARE(ENCODE(w.append(short(-1000))), QByteArray("3903e7"));
+    QCOMPARE(ENCODE(w.append(ushort(1000))), QByteArray("1903e8"));
+
+    // floats are written in the shortest exact form
+    QCOMPARE(ENCODE(w.append(0.0)), QByteArray("f90000"));
+    QCOMPARE(ENCODE(w.append(-0.0)), QByteArray("f98000"));
+    QCOMPARE(ENCODE(w.append(1.5)), QByteArray("f93e00"));
+    QCOMPARE(ENCODE(w.append(65504.0)), QByteArray("f97bff"));
+    QCOMPARE(ENCODE(w.append(100000.0)), QByteArray("fa47c35000"));
+    QCOMPARE(ENCODE(w.append(1.1)), QByteArray("fb3ff199999999999a"));
+    QCOMPARE(ENCODE(w.append(1.0e300)), QByteArray("fb7e37e43c8800759c"));
+    QCOMPARE(ENCODE(w.append(5.960464477539063e-8)), QByteArray("f90001"));
+    QCOMPARE(ENCODE(w.append(qInf())), QByteArray("f97c00"));
+    QCOMPARE(ENCODE(w.append(-qInf())), QByteArray("f9fc00"));
+    QCOMPARE(ENCODE(w.append(1.1f)), QByteArray("fa3f8ccccd"));
+    QCOMPARE(ENCODE(w.append(qfloat16(1.0f))), QByteArray("f93c00"));
+
+    QCOMPARE(ENCODE(w.append(false)), QByteArray("f4"));
+    QCOMPARE(ENCODE(w.append(true)), QByteArray("f5"));
+    QCOMPARE(ENCODE(w.appendNull()), QByteArray("f6"));
+    QCOMPARE(ENCODE(w.appendUndefined()), QByteArray("f7"));
+    QCOMPARE(ENCODE(w.appendSimpleType(16)), QByteArray("f0"));
+    QCOMPARE(ENCODE(w.appendSimpleType(255)), QByteArray("f8ff"));
+
+    QCOMPARE(ENCODE(w.append(QByteArray())), QByteArray("40"));
+    QCOMPARE(ENCODE(w.append(QByteArray::fromHex("01020304"))), QByteArray("4401020304"));
+    QCOMPARE(ENCODE(w.append(QString())), QByteArray("60"));
+    QCOMPARE(ENCODE(w.append("IETF")), QByteArray("6449455446"));
+    QCOMPARE(ENCODE(w.append(QLatin1String("IETF"))), QByteArray("6449455446"));
+    QCOMPARE(ENCODE(w.append(QLatin1String("\xfc"))), QByteArray("62c3bc"));
+    QCOMPARE(ENCODE(w.append(QString::fromUtf8("\xf0\x90\x85\x91"))), QByteArray("64f0908591"));
+
+    QCOMPARE(ENCODE(w.appendTag(0); w.append("2013-03-21T20:04:00Z")),
+             QByteArray("c074323031332d30332d32315432303a30343a30305a"));
+
+    QCOMPARE(ENCODE(w.startArray(0); w.endArray()), QByteArray("80"));
+    QCOMPARE(ENCODE(w.startArray(3); w.append(1); w.append(2); w.append(3); w.endArray()),
+             QByteArray("83010203"));
+    QCOMPARE(ENCODE(w.startArray(); w.append(1);
+                    w.startArray(2); w.append(2); w.append(3); w.endArray();
+                    w.startArray(); w.append(4); w.append(5); w.endArray();
+                    w.endArray()),
+             QByteArray("9f018202039f0405ffff"));
+    QCOMPARE(ENCODE(w.startMap(2); w.append(1); w.append(2); w.append(3); w.append(4); w.endMap()),
+             QByteArray("a201020304"));
+    QCOMPARE(ENCODE(w.startMap(); w.append("Fun"); w.append(true); w.append("Amt"); w.append(-2);
+                    w.endMap()),
+             QByteArray("bf6346756ef563416d7421ff"));
+
+    // mismatched containers
+    QCOMPARE(ENCODE(QTest::ignoreMessage(QtWarningMsg, "QCborStreamWriter::endArray: 1 items fewer than announced");
+                    w.startArray(2); w.append(1); QVERIFY(!w.endArray())),
+             QByteArray("8201"));
+    QCOMPARE(ENCODE(QTest::ignoreMessage(QtWarningMsg, "QCborStreamWriter::endMap: no map to end");
+                    w.startArray(); QVERIFY(!w.endMap()); QVERIFY(w.endArray())),
+             QByteArray("9fff"));
+    QCOMPARE(ENCODE(QTest::ignoreMessage(QtWarningMsg, "QCborStreamWriter::endMap: a key has no value");
+                    w.startMap(); w.append(1); QVERIFY(!w.endMap())),
+             QByteArray("bf01ff"));
+#undef ENCODE
+
+    // writing to a device
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    {
+        QCborStreamWriter writer(&buffer);
+        writer.startMap(1);
+        QCOMPARE(writer.depth(), 1);
+        writer.append("a");
+        writer.append(1);
+        writer.endMap();
+        QCOMPARE(writer.depth(), 0);
+        // complete items go to the device right away
+        QCOMPARE(buffer.data().toHex(), QByteArray("a1616101"));
+        writer.append(2);
+        QVERIFY(!writer.hasError());
+    }
+    QCOMPARE(buffer.data().toHex(), QByteArray("a161610102"));
+}
+
+void tst_QtJson::cborJsonRoundTrip()
+{
+    QFile file(testDataDir + "/test.json");
+    QVERIFY(file.open(QFile::ReadOnly));
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    QVERIFY(!document.isNull());
+
+    QByteArray data;
+    {
+        QCborStreamWriter writer(&data);
+        writer.appendJsonValue(document.array());
+        writer.appendJsonValue(QJsonObject({ { "int", 42 }, { "negative", -7 }, { "big", 1e300 },
+                                             { "fraction", 0.25 }, { "empty", QJsonArray() } }));
+    }
+    // smaller than the equivalent JSON
+    QVERIFY(data.size() < document.toJson(QJsonDocument::Compact).size());
+
+    QCborStreamReader reader(data);
+    reader.readNext();
+    QCOMPARE(reader.readJsonValue(), QJsonValue(document.array()));
+    reader.readNext();
+    const QJsonValue object = reader.readJsonValue();
+    QCOMPARE(object.toObject().value("int"), QJsonValue(42));
+    QCOMPARE(object.toObject().value("negative"), QJsonValue(-7));
+    QCOMPARE(object.toObject().value("big"), QJsonValue(1e300));
+    QCOMPARE(object.toObject().value("fraction"), QJsonValue(0.25));
+    QCOMPARE(object.toObject().value("empty"), QJsonValue(QJsonArray()));
+    QCOMPARE(reader.readNext(), QCborStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+
+    // conversions of CBOR-only types, see RFC 7049 section 4.1
+    QCborStreamReader special(QByteArray::fromHex("a7" "01f5" "f6f7"
+                                                  "4401020304f0"
+                                                  "d64401020304f4"
+                                                  "d7440102030460"
+                                                  "820102c11a514b67b0"
+                                                  "f93e0040"));
+    special.readNext();
+    const QJsonObject converted = special.readJsonValue().toObject();
+    QVERIFY(!special.hasError());
+    QCOMPARE(converted.value("1"), QJsonValue(true));
+    QCOMPARE(converted.value("null"), QJsonValue(QJsonValue::Null));
+    QCOMPARE(converted.value("AQIDBA"), QJsonValue(QJsonValue::Null));
+    QCOMPARE(converted.value("AQIDBA=="), QJsonValue(false));
+    QCOMPARE(converted.value("01020304"), QJsonValue(QString("")));
+    QCOMPARE(converted.value("[1,2]"), QJsonValue(1363896240));
+    QCOMPARE(converted.value("1.5"), QJsonValue(QString("")));
+    QCOMPARE(converted.size(), 7);
+}
+
+void tst_QtJson::cborJsonDuplicateKeys()
+{
+    // {"b": 1, "a": 2, "c": 3, "b": 4, "a": 5}
+    QCborStreamReader reader(QByteArray::fromHex("a5" "616201" "616102" "616303" "616204" "616105"));
+    reader.readNext();
+    const QJsonObject object = reader.readJsonValue().toObject();
+    QVERIFY(!reader.hasError());
+    QCOMPARE(object.size(), 3);
+    QCOMPARE(object.keys(), QStringList() << "a" << "b" << "c");
+    QCOMPARE(object.value("a"), QJsonValue(5));
+    QCOMPARE(object.value("b"), QJsonValue(4));
+    QCOMPARE(object.value("c"), QJsonValue(3));
+}
+
+void tst_QtJson::cborTagChain()
+{
+    // each tag would cost a stack frame if tags were read recursively
+    const QByteArray data = QByteArray(100000, char(0xd6)) + QByteArray::fromHex("4401020304" "01");
+
+    QCborStreamReader variant(data);
+    variant.readNext();
+    QCOMPARE(variant.readVariant(), QVariant(QByteArray("\x01\x02\x03\x04")));
+    QVERIFY(!variant.hasError());
+
+    QCborStreamReader json(data);
+    json.readNext();
+    QCOMPARE(json.readJsonValue(), QJsonValue(QStringLiteral("AQIDBA==")));
+    QVERIFY(!json.hasError());
+
+    QCborStreamReader skipped(data);
+    skipped.readNext();
+    skipped.skipCurrentValue();
+    QVERIFY(!skipped.hasError());
+    QCOMPARE(skipped.readNext(), QCborStreamReader::UnsignedInteger);
+
+    // as an item inside a container
+    QCborStreamReader array(QByteArray::fromHex("81") + data.left(data.size() - 1));
+    array.readNext();
+    QCOMPARE(array.readJsonValue(), QJsonValue(QJsonArray({ QStringLiteral("AQIDBA==") })));
+    QVERIFY(!array.hasError());
+}
+
+void tst_QtJson::cborVariantRoundTrip()
+{
+    QVariantMap map;
+    map.insert("int", -42);
+    map.insert("uint", std::numeric_limits<quint64>::max());
+    map.insert("double", 2.5);
+    map.insert("bool", true);
+    map.insert("null", QVariant::fromValue(nullptr));
+    map.insert("string", QString::fromUtf8("\xc3\xa9t\xc3\xa9"));
+    map.insert("bytes", QByteArray("\x00\x01\xff", 3));
+    map.insert("list", QVariantList() << 1 << QStringLiteral("two") << QVariantList());
+    map.insert("map", QVariantMap({ { "nested", QVariantMap() } }));
+    map.insert("datetime", QDateTime(QDate(2017, 11, 20), QTime(12, 34, 56, 789), Qt::UTC));
+    map.insert("url", QUrl("https://www.qt.io/path?q=%20"));
+    map.insert("uuid", QUuid("{67C8770B-44F1-410A-AB9A-F9B5446F13EE}"));
+
+    QByteArray data;
+    {
+        QCborStreamWriter writer(&data);
+        writer.appendVariant(map);
+        writer.appendVariant(QVariant());
+        writer.appendVariant(QStringList() << "a" << "b");
+    }
+
+    QCborStreamReader reader(data);
+    reader.readNext();
+    QVERIFY(reader.isStartMap());
+    QCOMPARE(reader.length(), quint64(map.size()));
+    const QVariantMap result = reader.readVariant().toMap();
+    QVERIFY(!reader.hasError());
+    QCOMPARE(result.keys(), map.keys());
+    for (auto it = map.cbegin(); it != map.cend(); ++it)
+        QVERIFY2(result.value(it.key()) == it.value(), qPrintable(it.key()));
+    QCOMPARE(result.value("int").userType(), int(QMetaType::LongLong));
+    QCOMPARE(result.value("uint").userType(), int(QMetaType::ULongLong));
+    QCOMPARE(result.value("null").userType(), int(QMetaType::Nullptr));
+
+    reader.readNext();
+    QCOMPARE(reader.tokenType(), QCborStreamReader::Undefined);
+    QVERIFY(!reader.readVariant().isValid());
+    reader.readNext();
+    QCOMPARE(reader.readVariant().toStringList(), QStringList() << "a" << "b");
+    QCOMPARE(reader.readNext(), QCborStreamReader::NoToken);
+}
+
 QTEST_MAIN(tst_QtJson)
 #include "tst_qtjson.moc"
@@ -16,6 +16,7 @@ SUBDIRS=\
     qobject \
     qpointer \
     qsharedmemory \
+    qsharedmemorychannel \
     qsignalblocker \
     qsignalmapper \
     qsocketnotifier \
@@ -40,4 +41,4 @@ SUBDIRS=\
 # This test is only applicable on Windows
 !win32*|winrt: SUBDIRS -= qwineventnotifier
 
-android|uikit: SUBDIRS -= qclipboard qobject qsharedmemory qsystemsemaphore
+android|uikit: SUBDIRS -= qclipboard qobject qsharedmemory qsharedmemorychannel qsystemsemaphore
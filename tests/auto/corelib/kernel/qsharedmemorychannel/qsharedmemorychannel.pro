@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qsharedmemorychannel
+QT = core testlib
+SOURCES = tst_qsharedmemorychannel.cpp
@@ -0,0 +1,408 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QSharedMemoryChannel>
+#include <QThread>
+
+#include <functional>
+
+Q_DECLARE_METATYPE(QSharedMemoryChannel::ChannelMode)
+
+class tst_QSharedMemoryChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void constructor();
+    void createAndAttach();
+    void attachErrors();
+    void writeAndRead();
+    void emptyMessage();
+    void zeroCopy();
+    void wrapAround_data();
+    void wrapAround();
+    void full();
+    void maximumMessageSize();
+    void detachWithReservation();
+    void readyRead();
+    void producerConsumer_data();
+    void producerConsumer();
+
+private:
+    QString uniqueKey() const;
+};
+
+class FunctionThread : public QThread
+{
+public:
+    explicit FunctionThread(const std::function<void()> &function)
+        : function(function) {}
+
+protected:
+    void run() override { function(); }
+
+private:
+    std::function<void()> function;
+};
+
+QString tst_QSharedMemoryChannel::uniqueKey() const
+{
+    return QLatin1String("tst_qsharedmemorychannel_") + QLatin1String(QTest::currentTestFunction())
+            + QLatin1Char('_') + QString::number(QCoreApplication::applicationPid());
+}
+
+void tst_QSharedMemoryChannel::constructor()
+{
+    QSharedMemoryChannel channel;
+    QCOMPARE(channel.key(), QString());
+    QVERIFY(!channel.isAttached());
+    QCOMPARE(channel.capacity(), 0);
+    QCOMPARE(channel.maximumMessageSize(), 0);
+    QVERIFY(!channel.hasPendingMessages());
+    QCOMPARE(channel.pendingMessageSize(), -1);
+    QVERIFY(!channel.writeMessage("x", 1));
+    QCOMPARE(channel.error(), QSharedMemory::NotFound);
+    QVERIFY(channel.readMessage().isNull());
+
+    channel.setKey(QLatin1String("key"));
+    QCOMPARE(channel.key(), QLatin1String("key"));
+}
+
+void tst_QSharedMemoryChannel::createAndAttach()
+{
+    QSharedMemoryChannel producer(uniqueKey());
+    QVERIFY2(producer.create(1000, QSharedMemoryChannel::MultiProducerMultiConsumer),
+             qPrintable(producer.errorString()));
+    QVERIFY(producer.isAttached());
+    QCOMPARE(producer.capacity(), 1024);
+    QCOMPARE(producer.mode(), QSharedMemoryChannel::MultiProducerMultiConsumer);
+
+    QSharedMemoryChannel consumer(uniqueKey());
+    QVERIFY2(consumer.attach(), qPrintable(consumer.errorString()));
+    QCOMPARE(consumer.capacity(), 1024);
+    QCOMPARE(consumer.mode(), QSharedMemoryChannel::MultiProducerMultiConsumer);
+    QVERIFY(!consumer.attach());
+    QCOMPARE(consumer.error(), QSharedMemory::AlreadyExists);
+
+    QSharedMemoryChannel duplicate(uniqueKey());
+    QVERIFY(!duplicate.create(1000));
+    QCOMPARE(duplicate.error(), QSharedMemory::AlreadyExists);
+
+    QVERIFY(consumer.detach());
+    QVERIFY(!consumer.isAttached());
+    QVERIFY(!consumer.detach());
+}
+
+void tst_QSharedMemoryChannel::attachErrors()
+{
+    QSharedMemoryChannel channel(uniqueKey());
+    QVERIFY(!channel.attach());
+    QCOMPARE(channel.error(), QSharedMemory::NotFound);
+
+    QVERIFY(!channel.create(0));
+    QCOMPARE(channel.error(), QSharedMemory::InvalidSize);
+    QVERIFY(!channel.create(-1));
+    QCOMPARE(channel.error(), QSharedMemory::InvalidSize);
+}
+
+void tst_QSharedMemoryChannel::writeAndRead()
+{
+    QSharedMemoryChannel producer(uniqueKey());
+    QVERIFY(producer.create(4096));
+    QSharedMemoryChannel consumer(uniqueKey());
+    QVERIFY(consumer.attach());
+
+    QVERIFY(producer.writeMessage(QByteArray("hello")));
+    QVERIFY(producer.writeMessage("world!", 6));
+    QVERIFY(consumer.hasPendingMessages());
+    QCOMPARE(consumer.pendingMessageSize(), 5);
+    QCOMPARE(consumer.readMessage(), QByteArray("hello"));
+    QCOMPARE(consumer.pendingMessageSize(), 6);
+    QCOMPARE(consumer.readMessage(), QByteArray("world!"));
+    QVERIFY(!consumer.hasPendingMessages());
+    QVERIFY(consumer.readMessage().isNull());
+}
+
+void tst_QSharedMemoryChannel::emptyMessage()
+{
+    QSharedMemoryChannel producer(uniqueKey());
+    QVERIFY(producer.create(4096));
+    QSharedMemoryChannel consumer(uniqueKey());
+    QVERIFY(consumer.attach());
+
+    QVERIFY(producer.writeMessage(QByteArray()));
+    QCOMPARE(consumer.pendingMessageSize(), 0);
+    const QByteArray message = consumer.readMessage();
+    QVERIFY(!message.isNull());
+    QVERIFY(message.isEmpty());
+}
+
+void tst_QSharedMemoryChannel::zeroCopy()
+{
+    QSharedMemoryChannel producer(uniqueKey());
+    QVERIFY(producer.create(4096));
+    QSharedMemoryChannel consumer(uniqueKey());
+    QVERIFY(consumer.attach());
+
+    char *data = producer.reserveMessage(3);
+    QVERIFY(data);
+    memcpy(data, "abc", 3);
+    QVERIFY(!consumer.hasPendingMessages());
+    QTest::ignoreMessage(QtWarningMsg, "QSharedMemoryChannel::reserveMessage: a message is already reserved");
+    QVERIFY(!producer.reserveMessage(3));
+    QVERIFY(producer.commitMessage());
+    QVERIFY(!producer.commitMessage());
+
+    int size = -1;
+    const char *message = consumer.claimMessage(&size);
+    QVERIFY(message);
+    QCOMPARE(QByteArray(message, size), QByteArray("abc"));
+    QVERIFY(!consumer.hasPendingMessages());
+    QVERIFY(consumer.releaseMessage());
+    QVERIFY(!consumer.releaseMessage());
+    QVERIFY(!consumer.claimMessage(&size));
+}
+
+void tst_QSharedMemoryChannel::wrapAround_data()
+{
+    QTest::addColumn<QSharedMemoryChannel::ChannelMode>("mode");
+    QTest::newRow("spsc") << QSharedMemoryChannel::SingleProducerSingleConsumer;
+    QTest::newRow("mpmc") << QSharedMemoryChannel::MultiProducerMultiConsumer;
+}
+
+void tst_QSharedMemoryChannel::wrapAround()
+{
+    QFETCH(QSharedMemoryChannel::ChannelMode, mode);
+
+    QSharedMemoryChannel producer(uniqueKey());
+    QVERIFY(producer.create(256, mode));
+    QSharedMemoryChannel consumer(uniqueKey());
+    QVERIFY(consumer.attach());
+
+    // odd sizes make messages end up at every offset and force padding
+    for (int i = 0; i < 1000; ++i) {
+        const QByteArray message(i % 113, char('a' + i % 26));
+        QVERIFY2(producer.writeMessage(message), qPrintable(QString::number(i)));
+        if (i % 2) {
+            QVERIFY(producer.writeMessage(QByteArray::number(i)));
+            QCOMPARE(consumer.readMessage(), message);
+            QCOMPARE(consumer.readMessage(), QByteArray::number(i));
+        } else {
+            QCOMPARE(consumer.readMessage(), message);
+        }
+    }
+    QVERIFY(!consumer.hasPendingMessages());
+}
+
+void tst_QSharedMemoryChannel::full()
+{
+    QSharedMemoryChannel producer(uniqueKey());
+    QVERIFY(producer.create(256));
+    QSharedMemoryChannel consumer(uniqueKey());
+    QVERIFY(consumer.attach());
+
+    // 16-byte records: 8 bytes of header and 8 bytes of payload
+    for (int i = 0; i < 16; ++i)
+        QVERIFY(producer.writeMessage(QByteArray(8, char(i))));
+    QVERIFY(!producer.writeMessage(QByteArray(8, 'x')));
+    QCOMPARE(producer.error(), QSharedMemory::NoError);
+    QVERIFY(!producer.waitForFreeSpace(8, 10));
+
+    QCOMPARE(consumer.readMessage(), QByteArray(8, char(0)));
+    QVERIFY(producer.waitForFreeSpace(8, 0));
+    QVERIFY(producer.writeMessage(QByteArray(8, 'x')));
+    for (int i = 1; i < 16; ++i)
+        QCOMPARE(consumer.readMessage(), QByteArray(8, char(i)));
+    QCOMPARE(consumer.readMessage(), QByteArray(8, 'x'));
+}
+
+void tst_QSharedMemoryChannel::maximumMessageSize()
+{
+    QSharedMemoryChannel producer(uniqueKey());
+    QVERIFY(producer.create(1024));
+    QSharedMemoryChannel consumer(uniqueKey());
+    QVERIFY(consumer.attach());
+
+    const int maximum = producer.maximumMessageSize();
+    QVERIFY(maximum > 0);
+    QVERIFY(!producer.reserveMessage(maximum + 1));
+    QCOMPARE(producer.error(), QSharedMemory::InvalidSize);
+    QVERIFY(!producer.waitForFreeSpace(maximum + 1, 0));
+
+    // a message of the maximum size fits into an empty ring at any offset
+    for (int offset = 0; offset < producer.capacity(); offset += 8) {
+        const QByteArray message(maximum, char(offset));
+        QVERIFY2(producer.writeMessage(message), qPrintable(QString::number(offset)));
+        QCOMPARE(consumer.readMessage(), message);
+        QVERIFY(producer.writeMessage(QByteArray()));
+        QVERIFY(!consumer.readMessage().isNull());
+    }
+}
+
+void tst_QSharedMemoryChannel::detachWithReservation()
+{
+    QSharedMemoryChannel consumer(uniqueKey());
+    QVERIFY(consumer.create(1024));
+
+    {
+        QSharedMemoryChannel producer(uniqueKey());
+        QVERIFY(producer.attach());
+        QVERIFY(producer.reserveMessage(100));
+    }
+    QVERIFY(!consumer.hasPendingMessages());
+
+    QSharedMemoryChannel producer(uniqueKey());
+    QVERIFY(producer.attach());
+    QVERIFY(producer.writeMessage(QByteArray("after")));
+    QCOMPARE(consumer.readMessage(), QByteArray("after"));
+}
+
+void tst_QSharedMemoryChannel::readyRead()
+{
+    QSharedMemoryChannel consumer(uniqueKey());
+    QVERIFY(consumer.create(4096));
+    QSharedMemoryChannel producer(uniqueKey());
+    QVERIFY(producer.attach());
+
+    // messages written before connecting are announced as well
+    QVERIFY(producer.writeMessage(QByteArray("early")));
+    QSignalSpy spy(&consumer, &QSharedMemoryChannel::readyRead);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(consumer.readMessage(), QByteArray("early"));
+
+    QVERIFY(producer.writeMessage(QByteArray("one")));
+    QVERIFY(producer.writeMessage(QByteArray("two")));
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(consumer.readMessage(), QByteArray("one"));
+    QCOMPARE(consumer.readMessage(), QByteArray("two"));
+
+    // no new messages, no new signal
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 2);
+
+    FunctionThread thread([this]() {
+        QSharedMemoryChannel producer(uniqueKey());
+        if (producer.attach())
+            producer.writeMessage(QByteArray("thread"));
+    });
+    thread.start();
+    QVERIFY(thread.wait(10000));
+    QTRY_COMPARE(spy.count(), 3);
+    QCOMPARE(consumer.readMessage(), QByteArray("thread"));
+}
+
+void tst_QSharedMemoryChannel::producerConsumer_data()
+{
+    QTest::addColumn<QSharedMemoryChannel::ChannelMode>("mode");
+    QTest::addColumn<int>("producers");
+    QTest::addColumn<int>("consumers");
+
+    QTest::newRow("spsc") << QSharedMemoryChannel::SingleProducerSingleConsumer << 1 << 1;
+    QTest::newRow("mpmc-1-1") << QSharedMemoryChannel::MultiProducerMultiConsumer << 1 << 1;
+    QTest::newRow("mpmc-3-1") << QSharedMemoryChannel::MultiProducerMultiConsumer << 3 << 1;
+    QTest::newRow("mpmc-3-2") << QSharedMemoryChannel::MultiProducerMultiConsumer << 3 << 2;
+}
+
+void tst_QSharedMemoryChannel::producerConsumer()
+{
+    QFETCH(QSharedMemoryChannel::ChannelMode, mode);
+    QFETCH(int, producers);
+    QFETCH(int, consumers);
+    const int count = 2000;
+
+    QSharedMemoryChannel owner(uniqueKey());
+    QVERIFY(owner.create(4096, mode));
+    const QString key = uniqueKey();
+
+    QVector<QVector<int> > received(consumers);
+    QAtomicInt remaining(producers * count);
+    QList<FunctionThread *> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads << new FunctionThread([key, p, count]() {
+            QSharedMemoryChannel producer(key);
+            if (!producer.attach())
+                return;
+            for (int i = 0; i < count; ++i) {
+                const int message[2] = { p, i };
+                const int size = sizeof(message) + (i % 50) * 8;
+                char *data;
+                while (!(data = producer.reserveMessage(size)))
+                    producer.waitForFreeSpace(size, 100);
+                memcpy(data, message, sizeof(message));
+                producer.commitMessage();
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        QVector<int> *messages = &received[c];
+        threads << new FunctionThread([key, messages, &remaining]() {
+            QSharedMemoryChannel consumer(key);
+            if (!consumer.attach())
+                return;
+            while (remaining.load() > 0) {
+                int size;
+                if (const char *data = consumer.claimMessage(&size)) {
+                    int message[2];
+                    memcpy(message, data, sizeof(message));
+                    consumer.releaseMessage();
+                    *messages << message[0] << message[1];
+                    remaining.deref();
+                } else {
+                    consumer.waitForReadyRead(100);
+                }
+            }
+        });
+    }
+    for (FunctionThread *thread : qAsConst(threads))
+        thread->start();
+    for (FunctionThread *thread : qAsConst(threads))
+        QVERIFY(thread->wait(60000));
+    qDeleteAll(threads);
+
+    // every message arrives exactly once, and in order per producer
+    QVector<QVector<bool> > seen(producers, QVector<bool>(count));
+    for (const QVector<int> &messages : qAsConst(received)) {
+        QVector<int> last(producers, -1);
+        for (int i = 0; i < messages.size(); i += 2) {
+            const int p = messages.at(i);
+            const int n = messages.at(i + 1);
+            QVERIFY(p >= 0 && p < producers);
+            QVERIFY(n > last.at(p));
+            last[p] = n;
+            QVERIFY(!seen.at(p).at(n));
+            seen[p][n] = true;
+        }
+    }
+    for (const QVector<bool> &flags : qAsConst(seen))
+        QVERIFY(!flags.contains(false));
+}
+
+QTEST_MAIN(tst_QSharedMemoryChannel)
+#include "tst_qsharedmemorychannel.moc"
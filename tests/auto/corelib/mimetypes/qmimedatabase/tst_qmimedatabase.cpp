@@ -562,6 +562,37 @@ void tst_QMimeDatabase::mimeTypeForData()
     QCOMPARE(buffer.pos(), qint64(0));
 }
 
+void tst_QMimeDatabase::mimeTypesForData()
+{
+    const QByteArray samples[] = {
+        QByteArray("\x78\x9f\x3e\x22"),
+        QByteArray("%PDF-1.4\n"),
+        QByteArray("<?php echo 1;"),
+        QByteArray("diff\t"),
+        QByteArray("\001abc?}"),
+        QByteArray("\x89PNG\r\n\x1a\n\0\0\0\rIHDR", 16),
+        QByteArray("GIF89a"),
+        QByteArray("plain text"),
+        QByteArray()
+    };
+    const int sampleCount = int(sizeof(samples) / sizeof(samples[0]));
+
+    // enough buffers for the batch to be split across threads
+    QList<QByteArray> dataList;
+    for (int i = 0; i < 1000; ++i)
+        dataList.append(samples[(i * 7) % sampleCount]);
+
+    QMimeDatabase db;
+    const QList<QMimeType> mimeTypes = db.mimeTypesForData(dataList);
+    QCOMPARE(mimeTypes.size(), dataList.size());
+    for (int i = 0; i < dataList.size(); ++i)
+        QCOMPARE(mimeTypes.at(i).name(), db.mimeTypeForData(dataList.at(i)).name());
+    QCOMPARE(mimeTypes.at(0).name(), QString::fromLatin1("application/vnd.ms-tnef"));
+    QCOMPARE(mimeTypes.at(5).name(), QString::fromLatin1("application/x-zerosize"));
+
+    QVERIFY(db.mimeTypesForData(QList<QByteArray>()).isEmpty());
+}
+
 void tst_QMimeDatabase::mimeTypeForFileAndContent_data()
 {
     QTest::addColumn<QString>("name");
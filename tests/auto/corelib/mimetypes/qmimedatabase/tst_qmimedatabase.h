@@ -60,6 +60,7 @@ private slots:
     void mimeTypeForUrl();
     void mimeTypeForData_data();
     void mimeTypeForData();
+    void mimeTypesForData();
     void mimeTypeForFileAndContent_data();
     void mimeTypeForFileAndContent();
     void allMimeTypes();
@@ -29,7 +29,10 @@
 #include <QtTest/qtest.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qfileinfo.h>
+#include <QtCore/qjsonarray.h>
 #include <QtCore/qplugin.h>
+#include <QtCore/qstandardpaths.h>
+#include <QtCore/qtemporarydir.h>
 #include <private/qfactoryloader_p.h>
 #include "plugin1/plugininterface1.h"
 #include "plugin2/plugininterface2.h"
@@ -44,9 +47,11 @@ class tst_QFactoryLoader : public QObject
     Q_OBJECT
 public slots:
     void initTestCase();
+    void cleanup();
 
 private slots:
     void usingTwoFactoriesFromSameDir();
+    void metaDataCache();
 };
 
 static const char binFolderC[] = "bin";
@@ -60,6 +65,12 @@ void tst_QFactoryLoader::initTestCase()
 #endif
 }
 
+void tst_QFactoryLoader::cleanup()
+{
+    QStandardPaths::setTestModeEnabled(false);
+    qunsetenv("QT_PLUGIN_CACHE");
+}
+
 void tst_QFactoryLoader::usingTwoFactoriesFromSameDir()
 {
     const QString suffix = QLatin1Char('/') + QLatin1String(binFolderC);
@@ -81,5 +92,98 @@ void tst_QFactoryLoader::usingTwoFactoriesFromSameDir()
     QCOMPARE(plugin2->pluginName(), QLatin1String("Plugin2 ok"));
 }
 
+void tst_QFactoryLoader::metaDataCache()
+{
+#if !QT_CONFIG(library)
+    QSKIP("This test requires plugins to be loaded dynamically");
+#else
+    QStandardPaths::setTestModeEnabled(true);
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QLatin1String("/qtplugincache");
+    QDir(cacheDir).removeRecursively();
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(QDir(tempDir.path()).mkdir(QLatin1String("plugins")));
+    const QString pluginDir = tempDir.path() + QLatin1String("/plugins/");
+    QString pluginName;
+    const QFileInfoList binaries = QDir(QFINDTESTDATA(binFolderC)).entryInfoList(QDir::Files);
+    for (const QFileInfo &binary : binaries) {
+        if (binary.fileName().contains(QLatin1String("plugin1"))) {
+            pluginName = binary.fileName();
+            QVERIFY(QFile::copy(binary.filePath(), pluginDir + pluginName));
+        }
+    }
+    QVERIFY(!pluginName.isEmpty());
+    QFile notAPlugin(pluginDir + QLatin1String("notaplugin.txt"));
+    QVERIFY(notAPlugin.open(QIODevice::WriteOnly));
+    notAPlugin.write("text");
+    notAPlugin.close();
+
+    const QStringList libraryPaths = QCoreApplication::libraryPaths();
+    QCoreApplication::setLibraryPaths(QStringList(tempDir.path()));
+    const QString suffix = QLatin1String("/plugins");
+
+    // the cache is opt-in
+    {
+        QFactoryLoader loader(PluginInterface1_iid, suffix);
+        QCOMPARE(loader.metaData().size(), 1);
+    }
+    QVERIFY(!QDir(cacheDir).exists());
+
+    qputenv("QT_PLUGIN_CACHE", "1");
+    {
+        QFactoryLoader loader(PluginInterface1_iid, suffix);
+        QCOMPARE(loader.metaData().size(), 1);
+        QVERIFY(loader.keyMap().isEmpty());
+    }
+
+    // the first scan stores the metadata of both files
+    const QStringList cacheFiles = QDir(cacheDir).entryList(QDir::Files);
+    QCOMPARE(cacheFiles.size(), 1);
+    QFile cacheFile(cacheDir + QLatin1Char('/') + cacheFiles.first());
+    QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+    QJsonObject root = QJsonDocument::fromBinaryData(cacheFile.readAll()).object();
+    QJsonObject plugins = root.value(QLatin1String("plugins")).toObject();
+    QCOMPARE(plugins.size(), 2);
+    QVERIFY(plugins.value(QLatin1String("notaplugin.txt")).toObject().contains(QLatin1String("error")));
+
+    // an unchanged plugin is not read again, so modified cache contents show up
+    QJsonObject entry = plugins.value(pluginName).toObject();
+    QJsonObject metaData = entry.value(QLatin1String("metaData")).toObject();
+    QCOMPARE(metaData.value(QLatin1String("IID")).toString(), QLatin1String(PluginInterface1_iid));
+    QJsonObject keys;
+    keys.insert(QLatin1String("Keys"), QJsonArray() << QLatin1String("cached"));
+    metaData.insert(QLatin1String("MetaData"), keys);
+    entry.insert(QLatin1String("metaData"), metaData);
+    plugins.insert(pluginName, entry);
+    root.insert(QLatin1String("plugins"), plugins);
+    cacheFile.resize(0);
+    cacheFile.write(QJsonDocument(root).toBinaryData());
+    cacheFile.close();
+
+    {
+        QFactoryLoader loader(PluginInterface1_iid, suffix);
+        QCOMPARE(loader.keyMap().values(), QStringList(QLatin1String("cached")));
+    }
+
+    // a plugin that changed is read again
+    QFile plugin(pluginDir + pluginName);
+    QVERIFY(plugin.open(QIODevice::ReadWrite));
+    QVERIFY(plugin.setFileTime(QDateTime::currentDateTime().addSecs(-3600),
+                               QFileDevice::FileModificationTime));
+    plugin.close();
+
+    {
+        QFactoryLoader loader(PluginInterface1_iid, suffix);
+        QCOMPARE(loader.metaData().size(), 1);
+        QVERIFY(loader.keyMap().isEmpty());
+    }
+
+    QCoreApplication::setLibraryPaths(libraryPaths);
+    QDir(cacheDir).removeRecursively();
+#endif
+}
+
 QTEST_MAIN(tst_QFactoryLoader)
 #include "tst_qfactoryloader.moc"
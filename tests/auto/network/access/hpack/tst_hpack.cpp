@@ -53,6 +53,7 @@ private Q_SLOTS:
     void bitstreamWrite();
     void bitstreamReadWrite();
     void bitstreamCompression();
+    void bitstreamHuffmanAllOctets();
     void bitstreamErrors();
 
     void lookupTableConstructor();
@@ -318,6 +319,34 @@ void tst_Hpack::bitstreamCompression()
     }
 }
 
+void tst_Hpack::bitstreamHuffmanAllOctets()
+{
+    // Every octet value, including those of a negative (signed) char,
+    // must survive Huffman compression - alone and all in one string.
+    QByteArray allOctets;
+    std::vector<uchar> buffer;
+    BitOStream out(buffer);
+    for (int i = 0; i < 256; ++i) {
+        const QByteArray octet(1, char(i));
+        allOctets += octet;
+        out.write(octet, true);
+    }
+    out.write(allOctets, true);
+
+    BitIStream in(out.begin(), out.end());
+    for (int i = 0; i < 256; ++i) {
+        QByteArray value;
+        QVERIFY(in.read(&value));
+        QCOMPARE(in.error(), StreamError::NoError);
+        QCOMPARE(value, QByteArray(1, char(i)));
+    }
+    QByteArray value;
+    QVERIFY(in.read(&value));
+    QCOMPARE(in.error(), StreamError::NoError);
+    QCOMPARE(value, allOctets);
+    QCOMPARE(in.streamOffset(), out.bitLength());
+}
+
 void tst_Hpack::bitstreamErrors()
 {
     {
@@ -125,6 +125,11 @@ void Http2Server::emulateGOAWAY(int timeout)
     goawayTimeout = timeout;
 }
 
+void Http2Server::emulateLatency(int ms)
+{
+    latency = ms;
+}
+
 void Http2Server::startServer()
 {
 #ifdef QT_NO_SSL
@@ -394,6 +399,21 @@ void Http2Server::handleIncomingFrame()
         }
     }
 
+    if (latency > 0 && (inboundFrame.type() == FrameType::WINDOW_UPDATE
+                        || inboundFrame.type() == FrameType::PING)) {
+        // Frames that tell us how much we can send (or measure how long
+        // it takes) arrive late, as if the network was slow:
+        const Http2::Frame frame(inboundFrame);
+        QTimer::singleShot(latency, this, [this, frame]() {
+            inboundFrame = frame;
+            if (frame.type() == FrameType::PING)
+                handlePING();
+            else
+                handleWINDOW_UPDATE();
+        });
+        return;
+    }
+
     switch (inboundFrame.type()) {
     case FrameType::SETTINGS:
         handleSETTINGS();
@@ -410,7 +430,7 @@ void Http2Server::handleIncomingFrame()
         // TODO: this is not tested for now.
         break;
     case FrameType::PING:
-        // TODO: this is not tested for now.
+        handlePING();
         break;
     case FrameType::GOAWAY:
         // TODO: this is not tested for now.
@@ -560,6 +580,23 @@ void Http2Server::handleWINDOW_UPDATE()
     sendDATA(streamID, delta);
 }
 
+void Http2Server::handlePING()
+{
+    if (inboundFrame.streamID() != connectionStreamID || inboundFrame.dataSize() != 8
+        || inboundFrame.flags().testFlag(FrameFlag::ACK)) {
+        // We never send PINGs, so we do not expect ACKs either.
+        sendGOAWAY(connectionStreamID, PROTOCOL_ERROR, connectionStreamID);
+        emit invalidFrame();
+        connectionError = true;
+        return;
+    }
+
+    writer.start(FrameType::PING, FrameFlag::ACK, connectionStreamID);
+    writer.append(inboundFrame.dataBegin(), inboundFrame.dataBegin() + 8);
+    writer.write(*socket);
+    emit receivedPING();
+}
+
 void Http2Server::sendResponse(quint32 streamID, bool emptyBody)
 {
     Q_ASSERT(activeRequests.find(streamID) != activeRequests.end());
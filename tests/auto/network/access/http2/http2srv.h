@@ -71,6 +71,7 @@ public:
     void enablePushPromise(bool enabled, const QByteArray &path = QByteArray());
     void setResponseBody(const QByteArray &body);
     void emulateGOAWAY(int timeout);
+    void emulateLatency(int ms);
 
     // Invokables, since we can call them from the main thread,
     // but server (can) work on its own thread.
@@ -87,6 +88,7 @@ public:
     Q_INVOKABLE void handleSETTINGS();
     Q_INVOKABLE void handleDATA();
     Q_INVOKABLE void handleWINDOW_UPDATE();
+    Q_INVOKABLE void handlePING();
 
     Q_INVOKABLE void sendResponse(quint32 streamID, bool emptyBody);
 
@@ -105,6 +107,7 @@ Q_SIGNALS:
     void receivedRequest(quint32 streamID);
     void receivedData(quint32 streamID);
     void windowUpdate(quint32 streamID);
+    void receivedPING();
 
 private slots:
     void connectionEstablished();
@@ -166,6 +169,8 @@ private:
     bool testingGOAWAY = false;
     int goawayTimeout = 0;
 
+    int latency = 0;
+
 protected slots:
     void ignoreErrorSlot();
 };
@@ -71,6 +71,12 @@ private slots:
     void pushPromise();
     void goaway_data();
     void goaway();
+    void receiveWindowSizes();
+    void windowAutoTuning_data();
+    void windowAutoTuning();
+    void connectionSharing();
+    void connectionSharingSslConfiguration();
+    void connectionSharingSslErrors();
 
 protected slots:
     // Slots to listen to our in-process server:
@@ -84,6 +90,7 @@ protected slots:
     void receivedRequest(quint32 streamID);
     void receivedData(quint32 streamID);
     void windowUpdated(quint32 streamID);
+    void receivedPING();
     void replyFinished();
     void replyFinishedWithError();
 
@@ -113,6 +120,7 @@ private:
     int nSentRequests = 0;
 
     int windowUpdates = 0;
+    int nPINGs = 0;
     bool prefaceOK = false;
     bool serverGotSettingsACK = false;
 
@@ -448,6 +456,239 @@ void tst_Http2::goaway()
     QVERIFY(!serverGotSettingsACK);
 }
 
+void tst_Http2::receiveWindowSizes()
+{
+    // The stream window we configure must be announced in client's SETTINGS
+    // (the server checks it) and be used when replenishing the windows.
+    using namespace Http2;
+
+    clearHTTP2State();
+
+    serverPort = 0;
+    nRequests = 1;
+
+    const quint32 streamWindowSize = 1024 * 1024;
+    const Http2Settings clientSettings{{Settings::MAX_FRAME_SIZE_ID, quint32(Http2::maxFrameSize)},
+                                       {Settings::ENABLE_PUSH_ID, quint32(0)},
+                                       {Settings::INITIAL_WINDOW_SIZE_ID, streamWindowSize}};
+
+    ServerPtr srv(newServer(defaultServerSettings, clientSettings));
+    const QByteArray respond(int(streamWindowSize) * 3, 'x');
+    srv->setResponseBody(respond);
+
+    QMetaObject::invokeMethod(srv.data(), "startServer", Qt::QueuedConnection);
+    runEventLoop();
+
+    QVERIFY(serverPort != 0);
+
+    QNetworkAccessManager nam;
+    nam.setHttp2StreamReceiveWindowSize(int(streamWindowSize));
+    nam.setHttp2SessionReceiveWindowSize(int(streamWindowSize) * 4);
+    QCOMPARE(nam.http2StreamReceiveWindowSize(), int(streamWindowSize));
+    QCOMPARE(nam.http2SessionReceiveWindowSize(), int(streamWindowSize) * 4);
+
+    auto url = requestUrl();
+    url.setPath("/index.html");
+
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, QVariant(true));
+
+    auto reply = nam.get(request);
+    connect(reply, &QNetworkReply::finished, this, &tst_Http2::replyFinished);
+    // Since we're using self-signed certificates, ignore SSL errors:
+    reply->ignoreSslErrors();
+
+    runEventLoop(120000);
+
+    QVERIFY(nRequests == 0);
+    QVERIFY(prefaceOK);
+    QVERIFY(serverGotSettingsACK);
+    QVERIFY(windowUpdates > 0);
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->readAll().size(), respond.size());
+}
+
+void tst_Http2::windowAutoTuning_data()
+{
+    QTest::addColumn<bool>("autoTuning");
+    QTest::newRow("AutoTuning") << true;
+    QTest::newRow("NoAutoTuning") << false;
+}
+
+void tst_Http2::windowAutoTuning()
+{
+    // The client estimates the bandwidth-delay product by sending PINGs
+    // while a response arrives, unless told not to tune its windows.
+    QFETCH(const bool, autoTuning);
+
+    clearHTTP2State();
+
+    serverPort = 0;
+    nRequests = 1;
+
+    const EnvVarGuard env("QT_HTTP2_DISABLE_WINDOW_AUTOTUNING", autoTuning ? "0" : "1");
+
+    ServerPtr srv(newServer(defaultServerSettings));
+    srv->setResponseBody(QByteArray(int(Http2::defaultSessionWindowSize) * 100, 'x'));
+
+    QMetaObject::invokeMethod(srv.data(), "startServer", Qt::QueuedConnection);
+    runEventLoop();
+
+    QVERIFY(serverPort != 0);
+
+    sendRequest(0);
+
+    runEventLoop(120000);
+
+    QVERIFY(nRequests == 0);
+    QVERIFY(prefaceOK);
+    QVERIFY(serverGotSettingsACK);
+    QCOMPARE(nPINGs > 0, autoTuning);
+}
+
+void tst_Http2::connectionSharing()
+{
+    // Our server accepts only one connection, so the second manager
+    // can only get its reply using the connection of the first one.
+    clearHTTP2State();
+
+    serverPort = 0;
+
+    ServerPtr srv(newServer(defaultServerSettings));
+
+    QMetaObject::invokeMethod(srv.data(), "startServer", Qt::QueuedConnection);
+    runEventLoop();
+
+    QVERIFY(serverPort != 0);
+
+    QNetworkAccessManager first;
+    first.setHttp2ConnectionSharingEnabled(true);
+    QNetworkAccessManager second;
+    second.setHttp2ConnectionSharingEnabled(true);
+    QVERIFY(second.isHttp2ConnectionSharingEnabled());
+
+    auto url = requestUrl();
+    url.setPath("/index.html");
+
+    // Both managers accept our self-signed certificate, so the connection
+    // stays shared after the first round of requests.
+    for (int round = 0; round < 2; ++round) {
+        nRequests = 2;
+        QList<QNetworkReply *> replies;
+        for (QNetworkAccessManager *nam : {&first, &second}) {
+            QNetworkRequest request(url);
+            request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, QVariant(true));
+
+            auto reply = nam->get(request);
+            connect(reply, &QNetworkReply::finished, this, &tst_Http2::replyFinished);
+            // Since we're using self-signed certificates, ignore SSL errors:
+            reply->ignoreSslErrors();
+            replies << reply;
+        }
+
+        runEventLoop();
+
+        QVERIFY(nRequests == 0);
+        for (QNetworkReply *reply : qAsConst(replies)) {
+            QCOMPARE(reply->error(), QNetworkReply::NoError);
+            QVERIFY(reply->isFinished());
+        }
+    }
+
+    QVERIFY(prefaceOK);
+    QVERIFY(serverGotSettingsACK);
+}
+
+void tst_Http2::connectionSharingSslConfiguration()
+{
+    if (clearTextHTTP2)
+        QSKIP("This test requires TLS");
+
+    // Our server accepts only one connection: a manager that would verify
+    // the server differently must not get the first manager's connection,
+    // even while both wait for the same handshake.
+    clearHTTP2State();
+
+    serverPort = 0;
+
+    ServerPtr srv(newServer(defaultServerSettings));
+
+    QMetaObject::invokeMethod(srv.data(), "startServer", Qt::QueuedConnection);
+    runEventLoop();
+
+    QVERIFY(serverPort != 0);
+
+    auto url = requestUrl();
+    url.setPath("/index.html");
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, QVariant(true));
+
+    QNetworkAccessManager first;
+    first.setHttp2ConnectionSharingEnabled(true);
+    QNetworkAccessManager second;
+    second.setHttp2ConnectionSharingEnabled(true);
+
+    QScopedPointer<QNetworkReply> shared(first.get(request));
+    shared->ignoreSslErrors();
+    QSslConfiguration sslConfiguration = request.sslConfiguration();
+    sslConfiguration.setCaCertificates(QSslCertificate::fromPath(QFINDTESTDATA("certs/fluke.cert")));
+    request.setSslConfiguration(sslConfiguration);
+    QScopedPointer<QNetworkReply> separate(second.get(request));
+    separate->ignoreSslErrors();
+
+    QTRY_VERIFY(shared->isFinished() && separate->isFinished());
+    QCOMPARE(shared->error(), QNetworkReply::NoError);
+    QVERIFY(separate->error() != QNetworkReply::NoError);
+}
+
+void tst_Http2::connectionSharingSslErrors()
+{
+    if (clearTextHTTP2)
+        QSKIP("This test requires TLS");
+
+    // Both managers wait for the same handshake, but only the first one
+    // accepts our self-signed certificate.
+    clearHTTP2State();
+
+    serverPort = 0;
+
+    ServerPtr srv(newServer(defaultServerSettings));
+
+    QMetaObject::invokeMethod(srv.data(), "startServer", Qt::QueuedConnection);
+    runEventLoop();
+
+    QVERIFY(serverPort != 0);
+
+    auto url = requestUrl();
+    url.setPath("/index.html");
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, QVariant(true));
+
+    QNetworkAccessManager first;
+    first.setHttp2ConnectionSharingEnabled(true);
+    QNetworkAccessManager second;
+    second.setHttp2ConnectionSharingEnabled(true);
+
+    QScopedPointer<QNetworkReply> accepting(first.get(request));
+    accepting->ignoreSslErrors();
+    QScopedPointer<QNetworkReply> rejecting(second.get(request));
+    QTRY_VERIFY(accepting->isFinished() && rejecting->isFinished());
+    QCOMPARE(accepting->error(), QNetworkReply::NoError);
+    QCOMPARE(rejecting->error(), QNetworkReply::SslHandshakeFailedError);
+
+    // later requests of the second manager don't get the connection either
+    rejecting.reset(second.get(request));
+    rejecting->ignoreSslErrors();
+    QTRY_VERIFY(rejecting->isFinished());
+    QCOMPARE(rejecting->error(), QNetworkReply::ConnectionRefusedError);
+
+    // but those of the first one still do
+    accepting.reset(first.get(request));
+    QTRY_VERIFY(accepting->isFinished());
+    QCOMPARE(accepting->error(), QNetworkReply::NoError);
+}
+
 void tst_Http2::serverStarted(quint16 port)
 {
     serverPort = port;
@@ -457,6 +698,7 @@ void tst_Http2::serverStarted(quint16 port)
 void tst_Http2::clearHTTP2State()
 {
     windowUpdates = 0;
+    nPINGs = 0;
     prefaceOK = false;
     serverGotSettingsACK = false;
 }
@@ -492,6 +734,7 @@ Http2Server *tst_Http2::newServer(const Http2Settings &serverSettings,
     connect(srv, &Srv::receivedRequest, this, &Cl::receivedRequest);
     connect(srv, &Srv::receivedData, this, &Cl::receivedData);
     connect(srv, &Srv::windowUpdate, this, &Cl::windowUpdated);
+    connect(srv, &Srv::receivedPING, this, &Cl::receivedPING);
 
     srv->moveToThread(workerThread);
 
@@ -586,6 +829,11 @@ void tst_Http2::windowUpdated(quint32 streamID)
     ++windowUpdates;
 }
 
+void tst_Http2::receivedPING()
+{
+    ++nPINGs;
+}
+
 void tst_Http2::replyFinished()
 {
     QVERIFY(nRequests);
@@ -1,4 +1,4 @@
 CONFIG += testcase
 TARGET = tst_qnetworkaccessmanager
 SOURCES += tst_qnetworkaccessmanager.cpp
-QT = core network testlib
+QT = core network-private testlib
@@ -30,12 +30,18 @@
 
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
 #ifndef QT_NO_BEARERMANAGEMENT
 #include <QtNetwork/QNetworkConfigurationManager>
 #endif
 
 #include <QtCore/QDebug>
 
+#ifdef QT_BUILD_INTERNAL
+#include <QtNetwork/private/qnetworkaccessmanager_p.h>
+#endif
+
 #ifndef QT_NO_BEARERMANAGEMENT
 Q_DECLARE_METATYPE(QNetworkAccessManager::NetworkAccessibility)
 #endif
@@ -50,6 +56,11 @@ public:
 private slots:
     void networkAccessible();
     void alwaysCacheRequest();
+    void connectionPoolSettings();
+    void connectionPoolStatistics();
+    void maximumConnections();
+    void preconnect();
+    void sharedHttpThreads();
 };
 
 tst_QNetworkAccessManager::tst_QNetworkAccessManager()
@@ -129,5 +140,187 @@ void tst_QNetworkAccessManager::alwaysCacheRequest()
     delete reply;
 }
 
+void tst_QNetworkAccessManager::connectionPoolSettings()
+{
+    QNetworkAccessManager manager;
+    QCOMPARE(manager.maximumConnectionsPerHost(), 6);
+    QCOMPARE(manager.connectionIdleTimeout(), 120);
+
+    manager.setMaximumConnectionsPerHost(2);
+    QCOMPARE(manager.maximumConnectionsPerHost(), 2);
+    manager.setMaximumConnectionsPerHost(0);
+    QCOMPARE(manager.maximumConnectionsPerHost(), 1);
+
+    manager.setConnectionIdleTimeout(5);
+    QCOMPARE(manager.connectionIdleTimeout(), 5);
+    manager.setConnectionIdleTimeout(-1);
+    QCOMPARE(manager.connectionIdleTimeout(), 0);
+
+    QCOMPARE(manager.maximumConnections(), 0);
+    manager.setMaximumConnections(3);
+    QCOMPARE(manager.maximumConnections(), 3);
+    manager.setMaximumConnections(-1);
+    QCOMPARE(manager.maximumConnections(), 0);
+}
+
+// Answers every request it receives with a small keep-alive response
+class KeepAliveServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    int connectionCount = 0;
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override
+    {
+        ++connectionCount;
+        QTcpSocket *socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(socketDescriptor);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            QByteArray &pending = buffers[socket];
+            pending += socket->readAll();
+            int end;
+            while ((end = pending.indexOf("\r\n\r\n")) != -1) {
+                pending.remove(0, end + 4);
+                socket->write("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+            }
+        });
+    }
+
+private:
+    QHash<QTcpSocket *, QByteArray> buffers;
+};
+
+void tst_QNetworkAccessManager::connectionPoolStatistics()
+{
+    KeepAliveServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QNetworkAccessManager manager;
+    manager.setMaximumConnectionsPerHost(1);
+
+    const QUrl url(QLatin1String("http://127.0.0.1:") + QString::number(server.serverPort()));
+    QList<QNetworkReply *> replies;
+    for (int i = 0; i < 3; ++i)
+        replies << manager.get(QNetworkRequest(url));
+
+    for (QNetworkReply *reply : qAsConst(replies))
+        QTRY_VERIFY(reply->isFinished());
+
+    // all three requests were serialized over a single connection
+    QCOMPARE(server.connectionCount, 1);
+    // The first request may be sent before the others reach the connection,
+    // so only the upper bound of the queue length is known.
+    int previousQueued = replies.size() - 1;
+    for (int i = 0; i < replies.size(); ++i) {
+        QNetworkReply *reply = replies.at(i);
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->readAll(), QByteArray("ok"));
+        QVERIFY(reply->attribute(QNetworkRequest::ConnectionWaitTimeAttribute).toLongLong() >= 0);
+        QCOMPARE(reply->attribute(QNetworkRequest::ActiveConnectionsAttribute).toInt(), 1);
+        QCOMPARE(reply->attribute(QNetworkRequest::IdleConnectionsAttribute).toInt(), 0);
+        const int queued = reply->attribute(QNetworkRequest::QueuedRequestsAttribute).toInt();
+        QVERIFY(queued >= 0);
+        QVERIFY(queued <= replies.size() - 1 - i);
+        QVERIFY(queued <= previousQueued);
+        previousQueued = queued;
+    }
+    QCOMPARE(previousQueued, 0);
+    qDeleteAll(replies);
+}
+
+void tst_QNetworkAccessManager::maximumConnections()
+{
+    KeepAliveServer first;
+    QVERIFY(first.listen(QHostAddress::LocalHost));
+    KeepAliveServer second;
+    QVERIFY(second.listen(QHostAddress::LocalHost));
+
+    QNetworkAccessManager manager;
+    manager.setMaximumConnections(1);
+
+    // Without the limit, each host would get two connections. With it, the
+    // requests to one host wait until the connection to the other one is
+    // idle and closed.
+    QList<QNetworkReply *> replies;
+    for (KeepAliveServer *server : {&first, &first, &second, &second}) {
+        const QUrl url(QLatin1String("http://127.0.0.1:") + QString::number(server->serverPort()));
+        replies << manager.get(QNetworkRequest(url));
+    }
+    for (QNetworkReply *reply : qAsConst(replies)) {
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->readAll(), QByteArray("ok"));
+    }
+    QCOMPARE(first.connectionCount, 1);
+    QCOMPARE(second.connectionCount, 1);
+    qDeleteAll(replies);
+}
+
+void tst_QNetworkAccessManager::preconnect()
+{
+    KeepAliveServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QNetworkAccessManager manager;
+    manager.setMaximumConnectionsPerHost(3);
+    manager.connectToHost(QLatin1String("127.0.0.1"), server.serverPort(), 5);
+    QTRY_COMPARE(server.connectionCount, 3);
+
+    // the requests use the connections that are already open
+    const QUrl url(QLatin1String("http://127.0.0.1:") + QString::number(server.serverPort()));
+    QList<QNetworkReply *> replies;
+    for (int i = 0; i < 3; ++i)
+        replies << manager.get(QNetworkRequest(url));
+    for (QNetworkReply *reply : qAsConst(replies)) {
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+    }
+    QCOMPARE(server.connectionCount, 3);
+    qDeleteAll(replies);
+}
+
+void tst_QNetworkAccessManager::sharedHttpThreads()
+{
+    KeepAliveServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    const QUrl url(QLatin1String("http://127.0.0.1:") + QString::number(server.serverPort()));
+
+    QNetworkAccessManager first;
+    QVERIFY(!first.isSharedHttpThreadsEnabled());
+    first.setSharedHttpThreadsEnabled(true);
+    QVERIFY(first.isSharedHttpThreadsEnabled());
+    QNetworkAccessManager second;
+    second.setSharedHttpThreadsEnabled(true);
+
+    // The managers run their requests in the same thread, but each
+    // uses (and reuses) a connection of its own:
+    for (QNetworkAccessManager *manager : {&first, &second, &first}) {
+        QScopedPointer<QNetworkReply> reply(manager->get(QNetworkRequest(url)));
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->readAll(), QByteArray("ok"));
+    }
+    QCOMPARE(server.connectionCount, 2);
+
+#ifdef QT_BUILD_INTERNAL
+    // Neither manager started a thread of its own, their requests ran in
+    // the shared thread for the host:
+    QThread *thread = QNetworkAccessManagerPrivate::sharedHttpThread(url.host());
+    QVERIFY(thread);
+    QVERIFY(thread->isRunning());
+    QVERIFY(!QNetworkAccessManagerPrivate::ownHttpThread(&first));
+    QVERIFY(!QNetworkAccessManagerPrivate::ownHttpThread(&second));
+
+    QNetworkAccessManager unshared;
+    QScopedPointer<QNetworkReply> reply(unshared.get(QNetworkRequest(url)));
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QThread *ownThread = QNetworkAccessManagerPrivate::ownHttpThread(&unshared);
+    QVERIFY(ownThread);
+    QVERIFY(ownThread != thread);
+#endif
+}
+
 QTEST_MAIN(tst_QNetworkAccessManager)
 #include "tst_qnetworkaccessmanager.moc"
@@ -68,6 +68,8 @@ private slots:
     void updateMetaData();
     void fileMetaData();
     void expire();
+    void expireLeastRecentlyUsed();
+    void persistentIndex();
 
     void oldCacheVersionFile_data();
     void oldCacheVersionFile();
@@ -278,6 +280,19 @@ void tst_QNetworkDiskCache::clear()
     cache.clear();
     QCOMPARE(countFiles(cacheDirectory).count(), NUM_SUBDIRECTORIES + 2);
 
+    // many files are removed in a worker thread by expire(), but not by clear()
+    for (int i = 0; i < 100; ++i) {
+        QNetworkCacheMetaData metaData;
+        metaData.setUrl(QUrl("http://localhost:4/" + QString::number(i)));
+        QIODevice *device = cache.prepare(metaData);
+        QVERIFY(device);
+        device->write("Hello World!");
+        cache.insert(device);
+    }
+    QCOMPARE(countFiles(cacheDirectory).count(), NUM_SUBDIRECTORIES + 102);
+    cache.clear();
+    QCOMPARE(countFiles(cacheDirectory).count(), NUM_SUBDIRECTORIES + 2);
+
     // don't delete files that it didn't create
     QTemporaryFile file(cacheDirectory + "/XXXXXX");
     if (file.open()) {
@@ -527,6 +542,70 @@ void tst_QNetworkDiskCache::expire()
     }
 }
 
+static void insertItem(QNetworkDiskCache &cache, const QUrl &url)
+{
+    QNetworkCacheMetaData metaData;
+    metaData.setUrl(url);
+    QIODevice *d = cache.prepare(metaData);
+    QVERIFY(d);
+    d->write(QByteArray(10000, 'x'));
+    cache.insert(d);
+}
+
+void tst_QNetworkDiskCache::expireLeastRecentlyUsed()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    SubQNetworkDiskCache cache;
+    cache.setCacheDirectory(dir.path());
+
+    insertItem(cache, QUrl("http://localhost:4/a"));
+    insertItem(cache, QUrl("http://localhost:4/b"));
+    insertItem(cache, QUrl("http://localhost:4/c"));
+    delete cache.data(QUrl("http://localhost:4/a"));
+
+    // room for a fourth item only after removing one
+    const qint64 size = cache.cacheSize();
+    cache.setMaximumCacheSize(size + size / 4);
+    insertItem(cache, QUrl("http://localhost:4/d"));
+
+    QVERIFY(cache.metaData(QUrl("http://localhost:4/a")).isValid());
+    QVERIFY(!cache.metaData(QUrl("http://localhost:4/b")).isValid());
+    QVERIFY(cache.metaData(QUrl("http://localhost:4/c")).isValid());
+    QVERIFY(cache.metaData(QUrl("http://localhost:4/d")).isValid());
+    QCOMPARE(cache.cacheSize(), size);
+}
+
+void tst_QNetworkDiskCache::persistentIndex()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString indexFile = dir.path() + "/index";
+    qint64 size;
+    {
+        QNetworkDiskCache cache;
+        cache.setCacheDirectory(dir.path());
+        insertItem(cache, QUrl("http://localhost:4/a"));
+        insertItem(cache, QUrl("http://localhost:4/b"));
+        insertItem(cache, QUrl("http://localhost:4/c"));
+        delete cache.data(QUrl("http://localhost:4/a"));
+        size = cache.cacheSize();
+        QVERIFY(!QFile::exists(indexFile));
+    }
+    QVERIFY(QFile::exists(indexFile));
+
+    SubQNetworkDiskCache cache;
+    cache.setCacheDirectory(dir.path());
+    QCOMPARE(cache.cacheSize(), size);
+    QVERIFY(!QFile::exists(indexFile));
+
+    // the order of use survives, too
+    cache.setMaximumCacheSize(size * 5 / 6);
+    QVERIFY(cache.metaData(QUrl("http://localhost:4/a")).isValid());
+    QVERIFY(!cache.metaData(QUrl("http://localhost:4/b")).isValid());
+    QVERIFY(cache.metaData(QUrl("http://localhost:4/c")).isValid());
+}
+
 void tst_QNetworkDiskCache::oldCacheVersionFile_data()
 {
     QTest::addColumn<int>("pass");
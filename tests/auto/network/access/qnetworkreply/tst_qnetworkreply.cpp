@@ -412,6 +412,8 @@ private Q_SLOTS:
     void getFromHttpIntoBuffer2_data();
     void getFromHttpIntoBuffer2();
     void getFromHttpIntoBufferCanReadLine();
+    void getFromHttpIntoDownloadDevice_data();
+    void getFromHttpIntoDownloadDevice();
 
     void ioGetFromHttpWithoutContentLength();
 
@@ -6608,6 +6610,54 @@ void tst_QNetworkReply::getFromHttpIntoBufferCanReadLine()
     QVERIFY(!reply->canReadLine());
 }
 
+void tst_QNetworkReply::getFromHttpIntoDownloadDevice_data()
+{
+    QTest::addColumn<QByteArray>("body");
+    QTest::addColumn<bool>("withContentLength");
+    QTest::addColumn<qint64>("readBufferSize");
+
+    QByteArray small("small reply body");
+    QByteArray large;
+    for (int i = 0; large.size() < 1024 * 1024; ++i)
+        large += QByteArray::number(i) + ' ';
+
+    QTest::newRow("small") << small << true << qint64(0);
+    QTest::newRow("large") << large << true << qint64(0);
+    QTest::newRow("large-without-content-length") << large << false << qint64(0);
+    QTest::newRow("large-with-read-buffer-size") << large << true << qint64(16384);
+}
+
+void tst_QNetworkReply::getFromHttpIntoDownloadDevice()
+{
+    QFETCH(QByteArray, body);
+    QFETCH(bool, withContentLength);
+    QFETCH(qint64, readBufferSize);
+
+    QByteArray response("HTTP/1.0 200 OK\r\n");
+    if (withContentLength)
+        response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "\r\n" + body;
+
+    MiniHttpServer server(response);
+    server.doClose = true;
+
+    QBuffer device;
+    QVERIFY(device.open(QIODevice::WriteOnly));
+
+    QNetworkRequest request(QUrl("http://localhost:" + QString::number(server.serverPort())));
+    QNetworkReplyPtr reply(manager.get(request));
+    reply->setReadBufferSize(readBufferSize);
+    reply->setDownloadDevice(&device);
+    QCOMPARE(reply->downloadDevice(), &device);
+
+    QVERIFY2(waitForFinish(reply) == Success, msgWaitForFinished(reply));
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->bytesAvailable(), qint64(0));
+    QCOMPARE(device.data().size(), body.size());
+    QCOMPARE(device.data(), body);
+}
+
 
 
 // Is handled somewhere else too, introduced this special test to have it more accessible
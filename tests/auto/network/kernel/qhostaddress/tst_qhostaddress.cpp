@@ -390,6 +390,13 @@ void tst_QHostAddress::assignment()
     address.setAddress((sockaddr *)&sockAddr);
     QCOMPARE(address, addr);
 #endif // !Q_OS_WINRT
+
+    // assigning a special address must not change copies
+    address = "4.2.2.1";
+    QHostAddress copy = address;
+    copy = QHostAddress::Any;
+    QCOMPARE(copy, QHostAddress(QHostAddress::Any));
+    QCOMPARE(address, QHostAddress("4.2.2.1"));
 }
 
 QT_WARNING_POP
@@ -46,6 +46,8 @@
 #include <QTcpSocket>
 #include <private/qthread_p.h>
 #include <QTcpServer>
+#include <QUdpSocket>
+#include <QtEndian>
 
 #ifndef QT_NO_BEARERMANAGEMENT
 #include <QtNetwork/qnetworkconfigmanager.h>
@@ -113,6 +115,9 @@ private slots:
     void multipleDifferentLookups();
 
     void cache();
+#ifdef QT_HOSTINFO_RESOLVER
+    void asyncResolver();
+#endif
 
     void abortHostLookup();
 protected slots:
@@ -649,6 +654,158 @@ void tst_QHostInfo::cache()
     QCOMPARE(lookupsDoneCounter, 2);
 }
 
+#ifdef QT_HOSTINFO_RESOLVER
+// Answers A and AAAA queries for *.example.test with one address each;
+// names starting with "truncated" get their answers over TCP only.
+class FakeNameServer : public QObject
+{
+    Q_OBJECT
+public:
+    FakeNameServer(quint32 ttl) : ttl(ttl), queries(0)
+    {
+        udp.bind(QHostAddress::LocalHost);
+        tcp.listen(QHostAddress::LocalHost, udp.localPort());
+        connect(&udp, SIGNAL(readyRead()), SLOT(readDatagrams()));
+        connect(&tcp, SIGNAL(newConnection()), SLOT(newConnection()));
+    }
+
+    quint32 ttl;
+    int queries;
+    QList<quint16> senderPorts;
+    QList<quint16> queryIds;
+    QUdpSocket udp;
+    QTcpServer tcp;
+
+private slots:
+    void readDatagrams()
+    {
+        while (udp.hasPendingDatagrams()) {
+            QByteArray query(int(udp.pendingDatagramSize()), Qt::Uninitialized);
+            QHostAddress sender;
+            quint16 senderPort;
+            udp.readDatagram(query.data(), query.size(), &sender, &senderPort);
+            senderPorts << senderPort;
+            queryIds << qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(query.constData()));
+            udp.writeDatagram(reply(query, false), sender, senderPort);
+        }
+    }
+
+    void newConnection()
+    {
+        QTcpSocket *socket = tcp.nextPendingConnection();
+        connect(socket, SIGNAL(readyRead()), SLOT(readTcpQuery()));
+    }
+
+    void readTcpQuery()
+    {
+        QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+        if (socket->bytesAvailable() < 2)
+            return;
+        const QByteArray length = socket->peek(2);
+        const int size = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(length.constData()));
+        if (socket->bytesAvailable() < 2 + size)
+            return;
+        socket->read(2);
+        const QByteArray answer = reply(socket->read(size), true);
+        uchar prefix[2];
+        qToBigEndian(quint16(answer.size()), prefix);
+        socket->write(reinterpret_cast<const char *>(prefix), 2);
+        socket->write(answer);
+    }
+
+private:
+    QByteArray reply(const QByteArray &query, bool viaTcp)
+    {
+        ++queries;
+        const int nameEnd = query.indexOf('\0', 12);
+        const QByteArray question = query.mid(12, nameEnd + 5 - 12);
+        const bool truncated = !viaTcp && query.mid(13).startsWith("truncated");
+        const quint16 type = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(question.constData()) + question.size() - 4);
+
+        QByteArray answer = query.left(2);
+        answer += truncated ? "\x83\x80" : "\x81\x80";
+        answer += QByteArray("\0\1\0", 3) + char(truncated ? 0 : 1) + QByteArray(4, '\0');
+        answer += question;
+        if (truncated)
+            return answer;
+        answer += "\xc0\x0c"; // the name in the question
+        answer += question.right(4); // type and class
+        uchar ttlBytes[4];
+        qToBigEndian(ttl, ttlBytes);
+        answer += QByteArray(reinterpret_cast<const char *>(ttlBytes), 4);
+        if (type == 28) {
+            const Q_IPV6ADDR address = QHostAddress("2001:db8::1").toIPv6Address();
+            answer += QByteArray("\0\x10", 2) + QByteArray(reinterpret_cast<const char *>(address.c), 16);
+        } else {
+            answer += QByteArray("\0\x04\xc0\0\2\1", 6);
+        }
+        return answer;
+    }
+};
+
+void tst_QHostInfo::asyncResolver()
+{
+    QFETCH_GLOBAL(bool, cache);
+
+    FakeNameServer server(60);
+    QVERIFY(server.tcp.isListening());
+    QList<QPair<QHostAddress, quint16> > nameServers;
+    nameServers << qMakePair(QHostAddress(QHostAddress::LocalHost), server.udp.localPort());
+    qt_qhostinfo_set_name_servers(nameServers);
+
+    QStringList expected;
+    expected << "192.0.2.1" << "2001:db8::1";
+
+    lookupDone = false;
+    QHostInfo::lookupHost("www.example.test", this, SLOT(resultsReady(QHostInfo)));
+    QTRY_VERIFY(lookupDone);
+    QCOMPARE(lookupResults.error(), QHostInfo::NoError);
+    QStringList addresses;
+    foreach (const QHostAddress &address, lookupResults.addresses())
+        addresses << address.toString();
+    addresses.sort();
+    QCOMPARE(addresses, expected);
+    QCOMPARE(server.queries, 2);
+    // every query comes from a socket of its own, with an ID of its own
+    QCOMPARE(server.senderPorts.size(), 2);
+    QVERIFY(server.senderPorts.at(0) != server.senderPorts.at(1));
+    QVERIFY(server.queryIds.at(0) != server.queryIds.at(1));
+
+    // within the TTL, the answer comes from the cache
+    lookupDone = false;
+    QHostInfo::lookupHost("www.example.test", this, SLOT(resultsReady(QHostInfo)));
+    QTRY_VERIFY(lookupDone);
+    QCOMPARE(lookupResults.addresses().size(), 2);
+    QCOMPARE(server.queries, cache ? 2 : 4);
+
+    // with a TTL of zero, it does not get cached at all
+    server.ttl = 0;
+    server.queries = 0;
+    for (int i = 0; i < 2; ++i) {
+        lookupDone = false;
+        QHostInfo::lookupHost("zero-ttl.example.test", this, SLOT(resultsReady(QHostInfo)));
+        QTRY_VERIFY(lookupDone);
+        QCOMPARE(lookupResults.addresses().size(), 2);
+    }
+    QCOMPARE(server.queries, 4);
+
+    // truncated replies are retried over TCP
+    server.ttl = 60;
+    server.queries = 0;
+    lookupDone = false;
+    QHostInfo::lookupHost("truncated.example.test", this, SLOT(resultsReady(QHostInfo)));
+    QTRY_VERIFY(lookupDone);
+    addresses.clear();
+    foreach (const QHostAddress &address, lookupResults.addresses())
+        addresses << address.toString();
+    addresses.sort();
+    QCOMPARE(addresses, expected);
+    QCOMPARE(server.queries, 4);
+
+    qt_qhostinfo_set_name_servers(QList<QPair<QHostAddress, quint16> >());
+}
+#endif
+
 void tst_QHostInfo::resultsReady(const QHostInfo &hi)
 {
     lookupDone = true;
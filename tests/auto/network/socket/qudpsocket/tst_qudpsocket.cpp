@@ -86,6 +86,8 @@ private slots:
     void bindAndConnectToHost();
     void pendingDatagramSize();
     void writeDatagram();
+    void writeAndReceiveDatagrams();
+    void writeDatagramsMixedFamilies();
     void performance();
     void bindMode();
     void writeDatagramToNonExistingPeer_data();
@@ -818,6 +820,108 @@ void tst_QUdpSocket::writeDatagram()
     }
 }
 
+void tst_QUdpSocket::writeAndReceiveDatagrams()
+{
+    QUdpSocket server;
+#ifdef FORCE_SESSION
+    server.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+#endif
+    QVERIFY2(server.bind(QHostAddress(QHostAddress::LocalHost), 0), server.errorString().toLatin1().constData());
+
+    QUdpSocket client;
+#ifdef FORCE_SESSION
+    client.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+#endif
+    QVERIFY2(client.bind(QHostAddress(QHostAddress::LocalHost), 0), client.errorString().toLatin1().constData());
+
+    // a run of equal sizes ending in a shorter one, an empty datagram and
+    // one carrying a hop limit, which can't be sent as part of such a run
+    QVector<QNetworkDatagram> datagrams;
+    for (int i = 0; i < 10; ++i)
+        datagrams << QNetworkDatagram(QByteArray(512, char('a' + i)), QHostAddress::LocalHost, server.localPort());
+    datagrams << QNetworkDatagram(QByteArray(100, 'k'), QHostAddress::LocalHost, server.localPort());
+    datagrams << QNetworkDatagram(QByteArray(), QHostAddress::LocalHost, server.localPort());
+    datagrams << QNetworkDatagram(QByteArray(512, 'm'), QHostAddress::LocalHost, server.localPort());
+    datagrams.last().setHopLimit(42);
+
+    QSignalSpy bytesspy(&client, SIGNAL(bytesWritten(qint64)));
+    QCOMPARE(client.writeDatagrams(datagrams), datagrams.size());
+    QCOMPARE(bytesspy.count(), 1);
+    QCOMPARE(bytesspy.at(0).at(0).toLongLong(), qint64(10 * 512 + 100 + 512));
+
+    QVector<QNetworkDatagram> received;
+    while (received.size() < datagrams.size()) {
+        if (!server.hasPendingDatagrams())
+            QVERIFY2(server.waitForReadyRead(5000), QtNetworkSettings::msgSocketError(server).constData());
+        const QVector<QNetworkDatagram> batch = server.receiveDatagrams(8, 1024);
+        QVERIFY(!batch.isEmpty());
+        QVERIFY(batch.size() <= 8);
+        received += batch;
+    }
+    QCOMPARE(received.size(), datagrams.size());
+    for (int i = 0; i < datagrams.size(); ++i) {
+        QVERIFY(received.at(i).isValid());
+        QCOMPARE(received.at(i).data(), datagrams.at(i).data());
+        QCOMPARE(received.at(i).senderAddress(), QHostAddress(QHostAddress::LocalHost));
+        QCOMPARE(received.at(i).senderPort(), int(client.localPort()));
+    }
+
+    // datagrams larger than maxSize are truncated, and nothing pending gives nothing
+    QCOMPARE(client.writeDatagrams(datagrams.mid(0, 1)), 1);
+    QVERIFY2(server.waitForReadyRead(5000), QtNetworkSettings::msgSocketError(server).constData());
+    received = server.receiveDatagrams(4, 16);
+    QCOMPARE(received.size(), 1);
+    QCOMPARE(received.at(0).data(), QByteArray(16, 'a'));
+    QVERIFY(server.receiveDatagrams(4).isEmpty());
+    QCOMPARE(server.error(), QUdpSocket::UnknownSocketError);
+}
+
+void tst_QUdpSocket::writeDatagramsMixedFamilies()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        QSKIP("test server SOCKS proxy doesn't support IPv6");
+    if (!QtNetworkSettings::hasIPv6())
+        QSKIP("system doesn't support IPv6");
+
+    QUdpSocket v4Sock;
+    QVERIFY2(v4Sock.bind(QHostAddress(QHostAddress::LocalHost), 0), v4Sock.errorString().toLatin1().constData());
+    QUdpSocket v6Sock;
+    QVERIFY2(v6Sock.bind(QHostAddress(QHostAddress::LocalHostIPv6), 0), v6Sock.errorString().toLatin1().constData());
+
+    // the first datagram alone must not decide which family the
+    // unbound client socket is created for
+    QVector<QNetworkDatagram> datagrams;
+    datagrams << QNetworkDatagram("v4 1", QHostAddress::LocalHost, v4Sock.localPort());
+    datagrams << QNetworkDatagram("v6 1", QHostAddress::LocalHostIPv6, v6Sock.localPort());
+    datagrams << QNetworkDatagram("v4 2", QHostAddress::LocalHost, v4Sock.localPort());
+    datagrams << QNetworkDatagram("v6 2", QHostAddress::LocalHostIPv6, v6Sock.localPort());
+
+    QUdpSocket client;
+    QCOMPARE(client.writeDatagrams(datagrams), datagrams.size());
+
+    QUdpSocket *receivers[] = { &v4Sock, &v6Sock };
+    for (QUdpSocket *receiver : receivers) {
+        QVector<QNetworkDatagram> received;
+        while (received.size() < 2) {
+            if (!receiver->hasPendingDatagrams())
+                QVERIFY2(receiver->waitForReadyRead(5000), QtNetworkSettings::msgSocketError(*receiver).constData());
+            received += receiver->receiveDatagrams(4);
+        }
+        QCOMPARE(received.size(), 2);
+        const QByteArray prefix = receiver == &v4Sock ? "v4 " : "v6 ";
+        QCOMPARE(received.at(0).data(), prefix + '1');
+        QCOMPARE(received.at(1).data(), prefix + '2');
+    }
+
+    // the same with the IPv6 destination first
+    std::swap(datagrams[0], datagrams[1]);
+    QUdpSocket client2;
+    QCOMPARE(client2.writeDatagrams(datagrams), datagrams.size());
+    QVERIFY2(v4Sock.waitForReadyRead(5000), QtNetworkSettings::msgSocketError(v4Sock).constData());
+    QVERIFY2(v6Sock.waitForReadyRead(5000), QtNetworkSettings::msgSocketError(v6Sock).constData());
+}
+
 void tst_QUdpSocket::performance()
 {
     QByteArray arr(8192, '@');
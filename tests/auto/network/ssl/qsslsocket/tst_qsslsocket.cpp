@@ -237,6 +237,9 @@ private slots:
     void ephemeralServerKey();
     void allowedProtocolNegotiation();
     void pskServer();
+    void sessionCache_data();
+    void sessionCache();
+    void sharedContexts();
 #endif
 
     void setEmptyDefaultConfiguration(); // this test should be last
@@ -3731,6 +3734,137 @@ void tst_QSslSocket::allowedProtocolNegotiation()
 #endif // OPENSSL_VERSION_NUMBER
 }
 
+void tst_QSslSocket::sessionCache_data()
+{
+    QTest::addColumn<bool>("useTickets");
+
+    QTest::newRow("session tickets") << true;
+    QTest::newRow("session IDs") << false;
+}
+
+void tst_QSslSocket::sessionCache()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (!QSslSocket::supportsSsl() || setProxy)
+        return;
+
+    QFETCH(bool, useTickets);
+
+    SslServer server(SRCDIR "certs/bogus-server.key", SRCDIR "certs/bogus-server.crt");
+    server.config.setSslOption(QSsl::SslOptionDisableSessionTickets, !useTickets);
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QSslConfiguration clientConfiguration = QSslConfiguration::defaultConfiguration();
+    clientConfiguration.setCaCertificates(QSslCertificate::fromPath(SRCDIR "certs/bogus-ca.crt"));
+
+    // returns the number of handshakes resumed on both ends
+    auto connectClient = [&]() -> qint64 {
+        const qint64 resumedBefore = QSslSocket::resumedHandshakeCount(QSslSocket::SslClientMode)
+                                   + QSslSocket::resumedHandshakeCount(QSslSocket::SslServerMode);
+        QSslSocket client;
+        client.setSslConfiguration(clientConfiguration);
+        client.setPeerVerifyName(QStringLiteral("Bogus Server"));
+        QEventLoop loop;
+        QTimer::singleShot(5000, &loop, SLOT(quit()));
+        connect(&client, SIGNAL(encrypted()), &loop, SLOT(quit()));
+        connect(&client, SIGNAL(error(QAbstractSocket::SocketError)), &loop, SLOT(quit()));
+        client.connectToHostEncrypted(QStringLiteral("127.0.0.1"), server.serverPort());
+        loop.exec();
+        if (!client.isEncrypted())
+            return -1;
+        // the server finishes its handshake after the client
+        QElapsedTimer timer;
+        timer.start();
+        while (!server.socket->isEncrypted() && timer.elapsed() < 5000)
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+        return QSslSocket::resumedHandshakeCount(QSslSocket::SslClientMode)
+             + QSslSocket::resumedHandshakeCount(QSslSocket::SslServerMode) - resumedBefore;
+    };
+
+    QSslSocket::clearSessionCache();
+    const qint64 handshakes = QSslSocket::handshakeCount(QSslSocket::SslClientMode);
+
+    QCOMPARE(connectClient(), qint64(0));
+    QCOMPARE(connectClient(), qint64(2));
+    QCOMPARE(QSslSocket::handshakeCount(QSslSocket::SslClientMode), handshakes + 2);
+
+    // sessions are not shared with sockets that opted out
+    clientConfiguration.setSslOption(QSsl::SslOptionDisableSessionSharing, true);
+    QCOMPARE(connectClient(), qint64(0));
+    clientConfiguration.setSslOption(QSsl::SslOptionDisableSessionSharing, false);
+
+    // nor with sockets that use a different configuration
+    clientConfiguration.setProtocol(QSsl::TlsV1_0);
+    QCOMPARE(connectClient(), qint64(0));
+    clientConfiguration.setProtocol(QSsl::SecureProtocols);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.path() + QLatin1String("/sessions");
+    QVERIFY(QSslSocket::saveSessionCache(fileName));
+    QSslSocket::clearSessionCache();
+    QCOMPARE(connectClient(), qint64(0));
+
+    // clearSessionCache() dropped the server's sessions too, so only a
+    // ticket can be resumed after loading the client sessions back
+    QSslSocket::clearSessionCache();
+    QVERIFY(QSslSocket::loadSessionCache(fileName));
+    QCOMPARE(connectClient(), useTickets ? qint64(2) : qint64(0));
+}
+
+void tst_QSslSocket::sharedContexts()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (!QSslSocket::supportsSsl() || setProxy)
+        return;
+
+    SslServer server(SRCDIR "certs/bogus-server.key", SRCDIR "certs/bogus-server.crt");
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QSslConfiguration clientConfiguration = QSslConfiguration::defaultConfiguration();
+    clientConfiguration.setCaCertificates(QSslCertificate::fromPath(SRCDIR "certs/bogus-ca.crt"));
+
+    QSharedPointer<QSslContext> serverContext;
+    auto connectClient = [&]() -> QSharedPointer<QSslContext> {
+        QSslSocket client;
+        client.setSslConfiguration(clientConfiguration);
+        client.setPeerVerifyName(QStringLiteral("Bogus Server"));
+        QEventLoop loop;
+        QTimer::singleShot(5000, &loop, SLOT(quit()));
+        connect(&client, SIGNAL(encrypted()), &loop, SLOT(quit()));
+        connect(&client, SIGNAL(error(QAbstractSocket::SocketError)), &loop, SLOT(quit()));
+        client.connectToHostEncrypted(QStringLiteral("127.0.0.1"), server.serverPort());
+        loop.exec();
+        serverContext = server.socket ? QSslSocketPrivate::sslContext(server.socket)
+                                      : QSharedPointer<QSslContext>();
+        return QSslSocketPrivate::sslContext(&client);
+    };
+
+    const QSharedPointer<QSslContext> first = connectClient();
+    QVERIFY(first);
+    const QSharedPointer<QSslContext> firstServerContext = serverContext;
+    QVERIFY(firstServerContext);
+    QVERIFY(first != firstServerContext);
+
+    // the same configuration shares the contexts on both ends
+    QCOMPARE(connectClient(), first);
+    QCOMPARE(serverContext, firstServerContext);
+
+    // a different configuration does not
+    clientConfiguration.setPeerVerifyDepth(5);
+    const QSharedPointer<QSslContext> second = connectClient();
+    QVERIFY(second);
+    QVERIFY(second != first);
+    QCOMPARE(connectClient(), second);
+
+    // contexts that keep per-connection state are never shared
+    clientConfiguration.setAllowedNextProtocols(QList<QByteArray>() << QByteArrayLiteral("http/1.1"));
+    const QSharedPointer<QSslContext> third = connectClient();
+    QVERIFY(third);
+    QVERIFY(third != second);
+    QVERIFY(connectClient() != third);
+}
+
 void tst_QSslSocket::pskServer()
 {
     QFETCH_GLOBAL(bool, setProxy);
@@ -0,0 +1,5 @@
+TARGET = tst_bench_qlogging
+QT = core testlib
+CONFIG -= app_bundle
+
+SOURCES += tst_bench_qlogging.cpp
@@ -0,0 +1,153 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest>
+#include <QLoggingCategory>
+#include <QThread>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+Q_CORE_EXPORT void qt_logging_set_async(bool enable); // qlogging.cpp
+QT_END_NAMESPACE
+
+Q_LOGGING_CATEGORY(lcBench, "qt.bench.logging")
+
+static const int MessagesPerThread = 10000;
+
+class LoggingThread : public QThread
+{
+public:
+    void run() override
+    {
+        for (int i = 0; i < MessagesPerThread; ++i)
+            qCDebug(lcBench) << "message" << i << "from a worker";
+    }
+};
+
+class tst_QLogging : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void formatLogMessage_data();
+    void formatLogMessage();
+    void messageOutput_data();
+    void messageOutput();
+};
+
+void tst_QLogging::formatLogMessage_data()
+{
+    QTest::addColumn<QString>("pattern");
+
+    QTest::newRow("default") << QString();
+    QTest::newRow("type-category") << QStringLiteral("%{type} %{category}: %{message}");
+    QTest::newRow("conditions")
+            << QStringLiteral("[%{if-debug}D%{endif}%{if-info}I%{endif}%{if-warning}W%{endif}"
+                              "%{if-critical}C%{endif}%{if-fatal}F%{endif}] "
+                              "%{if-category}%{category}: %{endif}%{message}");
+    QTest::newRow("location") << QStringLiteral("%{file}:%{line} %{function}: %{message}");
+    QTest::newRow("time-process") << QStringLiteral("%{time process} %{message}");
+}
+
+void tst_QLogging::formatLogMessage()
+{
+    QFETCH(QString, pattern);
+
+    qSetMessagePattern(pattern.isNull() ? QStringLiteral("%{if-category}%{category}: %{endif}%{message}")
+                                        : pattern);
+    const QString message = QStringLiteral("a message of typical length, with a number: 42");
+    const QMessageLogContext context(__FILE__, __LINE__, Q_FUNC_INFO, "qt.bench.logging");
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+            qFormatLogMessage(QtDebugMsg, context, message);
+    }
+    qSetMessagePattern(QString());
+}
+
+void tst_QLogging::messageOutput_data()
+{
+    QTest::addColumn<bool>("async");
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("sync-1") << false << 1;
+    QTest::newRow("async-1") << true << 1;
+    QTest::newRow("sync-4") << false << 4;
+    QTest::newRow("async-4") << true << 4;
+}
+
+void tst_QLogging::messageOutput()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("This benchmark needs to redirect stderr");
+#else
+    QFETCH(bool, async);
+    QFETCH(int, threadCount);
+
+    // measure the default message handler, writing to /dev/null
+    const int savedStderr = dup(STDERR_FILENO);
+    const int devNull = open("/dev/null", O_WRONLY);
+    QVERIFY(savedStderr != -1 && devNull != -1);
+    dup2(devNull, STDERR_FILENO);
+    close(devNull);
+    const QtMessageHandler testlibHandler = qInstallMessageHandler(nullptr);
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.bench.logging.debug=true"));
+    qSetMessagePattern(QStringLiteral("%{type} %{category}: %{message}"));
+    qt_logging_set_async(async);
+
+    QBENCHMARK {
+        QVector<LoggingThread *> threads;
+        for (int i = 0; i < threadCount; ++i) {
+            threads.append(new LoggingThread);
+            threads.last()->start();
+        }
+        for (LoggingThread *thread : qAsConst(threads)) {
+            thread->wait();
+            delete thread;
+        }
+        // include writing out what is still queued
+        qt_logging_set_async(false);
+        qt_logging_set_async(async);
+    }
+
+    qt_logging_set_async(false);
+    qSetMessagePattern(QString());
+    QLoggingCategory::setFilterRules(QString());
+    qInstallMessageHandler(testlibHandler);
+    dup2(savedStderr, STDERR_FILENO);
+    close(savedStderr);
+#endif
+}
+
+QTEST_MAIN(tst_QLogging)
+
+#include "tst_bench_qlogging.moc"
@@ -1,9 +1,11 @@
 TEMPLATE = subdirs
 SUBDIRS = \
+        qdatastream \
         qdir \
         qdiriterator \
         qfile \
         qfileinfo \
+        qfilesystemwatcher \
         qiodevice \
         qtemporaryfile \
         qtextstream
@@ -0,0 +1,108 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QBuffer>
+#include <QDataStream>
+#include <QVector>
+#include <qtest.h>
+
+class tst_QDataStream : public QObject
+{
+    Q_OBJECT
+private slots:
+    void writeVector_data();
+    void writeVector();
+    void readVector_data();
+    void readVector();
+};
+
+static const int elementCount = 1024 * 1024;
+
+static void addByteOrderRows()
+{
+    QTest::addColumn<int>("byteOrder");
+
+    QTest::newRow("big endian") << int(QDataStream::BigEndian);
+    QTest::newRow("little endian") << int(QDataStream::LittleEndian);
+}
+
+static QVector<double> makeData()
+{
+    QVector<double> data(elementCount);
+    for (int i = 0; i < elementCount; ++i)
+        data[i] = i * 0.5;
+    return data;
+}
+
+void tst_QDataStream::writeVector_data()
+{
+    addByteOrderRows();
+}
+
+void tst_QDataStream::writeVector()
+{
+    QFETCH(int, byteOrder);
+    const QVector<double> data = makeData();
+    QByteArray bytes;
+    bytes.reserve(elementCount * int(sizeof(double)) + 4);
+
+    QBENCHMARK {
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream out(&buffer);
+        out.setByteOrder(QDataStream::ByteOrder(byteOrder));
+        out << data;
+    }
+}
+
+void tst_QDataStream::readVector_data()
+{
+    addByteOrderRows();
+}
+
+void tst_QDataStream::readVector()
+{
+    QFETCH(int, byteOrder);
+    QByteArray bytes;
+    {
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        out.setByteOrder(QDataStream::ByteOrder(byteOrder));
+        out << makeData();
+    }
+
+    QVector<double> result;
+    QBENCHMARK {
+        QDataStream in(bytes);
+        in.setByteOrder(QDataStream::ByteOrder(byteOrder));
+        in >> result;
+    }
+    QCOMPARE(result.size(), elementCount);
+}
+
+QTEST_MAIN(tst_QDataStream)
+
+#include "main.moc"
@@ -0,0 +1,247 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QDir>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QSignalSpy>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <qtest.h>
+
+class tst_QFileSystemWatcher : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void addRemovePaths_data();
+    void addRemovePaths();
+    void addTree_data();
+    void addTree();
+    void fileChangeStorm_data();
+    void fileChangeStorm();
+    void treeChangeStorm_data();
+    void treeChangeStorm();
+
+private:
+    QStringList createDirectories(int count);
+    QStringList createFiles(int count);
+    QString createTree(int count, QStringList *directories);
+
+    QTemporaryDir tempDir;
+    int directoryCount;
+    int fileCount;
+};
+
+void tst_QFileSystemWatcher::initTestCase()
+{
+    QVERIFY2(tempDir.isValid(), qPrintable(tempDir.errorString()));
+    directoryCount = 0;
+    fileCount = 0;
+}
+
+QStringList tst_QFileSystemWatcher::createDirectories(int count)
+{
+    QDir dir(tempDir.path());
+    QStringList paths;
+    paths.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QString name = QLatin1String("dir") + QString::number(directoryCount++);
+        if (!dir.mkdir(name))
+            return QStringList();
+        paths << dir.filePath(name);
+    }
+    return paths;
+}
+
+QStringList tst_QFileSystemWatcher::createFiles(int count)
+{
+    QDir dir(tempDir.path());
+    QStringList paths;
+    paths.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QFile file(dir.filePath(QLatin1String("file") + QString::number(fileCount++)));
+        if (!file.open(QIODevice::WriteOnly))
+            return QStringList();
+        paths << file.fileName();
+    }
+    return paths;
+}
+
+// creates \a count directories, ten in each, and returns the top one
+QString tst_QFileSystemWatcher::createTree(int count, QStringList *directories)
+{
+    QDir dir(tempDir.path());
+    const QString root = dir.filePath(QLatin1String("tree") + QString::number(directoryCount++));
+    if (!dir.mkdir(root))
+        return QString();
+    directories->append(root);
+    for (int i = 0; directories->size() < count; ++i) {
+        const QString path = directories->at(i / 10) + QLatin1String("/d") + QString::number(i % 10);
+        if (!dir.mkdir(path))
+            return QString();
+        directories->append(path);
+    }
+    return root;
+}
+
+void tst_QFileSystemWatcher::addRemovePaths_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("5000") << 5000;
+}
+
+void tst_QFileSystemWatcher::addRemovePaths()
+{
+    QFETCH(int, count);
+
+    const QStringList paths = createDirectories(count);
+    QCOMPARE(paths.size(), count);
+
+    QBENCHMARK {
+        QFileSystemWatcher watcher;
+        QVERIFY(watcher.addPaths(paths).isEmpty());
+        QCOMPARE(watcher.directories().size(), count);
+        QVERIFY(watcher.removePaths(paths).isEmpty());
+        QVERIFY(watcher.directories().isEmpty());
+    }
+}
+
+void tst_QFileSystemWatcher::addTree_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void tst_QFileSystemWatcher::addTree()
+{
+    QFETCH(int, count);
+
+    QStringList directories;
+    const QString root = createTree(count, &directories);
+    QVERIFY(!root.isEmpty());
+
+    QBENCHMARK {
+        QFileSystemWatcher watcher;
+        QVERIFY(watcher.addPath(root, QFileSystemWatcher::WatchSubdirectories));
+        QCOMPARE(watcher.directories().size(), count);
+        QVERIFY(watcher.removePath(root));
+        QVERIFY(watcher.directories().isEmpty());
+    }
+}
+
+void tst_QFileSystemWatcher::fileChangeStorm_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("interval");
+    QTest::newRow("10") << 10 << 0;
+    QTest::newRow("100") << 100 << 0;
+    QTest::newRow("1000") << 1000 << 0;
+    QTest::newRow("1000-coalesced") << 1000 << 50;
+}
+
+void tst_QFileSystemWatcher::fileChangeStorm()
+{
+    QFETCH(int, count);
+    QFETCH(int, interval);
+
+    const QStringList paths = createFiles(count);
+    QCOMPARE(paths.size(), count);
+
+    QFileSystemWatcher watcher;
+    watcher.setCoalescingInterval(interval);
+    QVERIFY(watcher.addPaths(paths).isEmpty());
+    QSignalSpy spy(&watcher, &QFileSystemWatcher::fileChanged);
+
+    QBENCHMARK {
+        spy.clear();
+        for (const QString &path : paths) {
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+            file.write("x", 1);
+        }
+        QTRY_VERIFY(spy.count() >= count);
+    }
+}
+
+void tst_QFileSystemWatcher::treeChangeStorm_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("interval");
+    QTest::newRow("1000") << 1000 << 0;
+    QTest::newRow("1000-coalesced") << 1000 << 50;
+    QTest::newRow("10000") << 10000 << 0;
+    QTest::newRow("10000-coalesced") << 10000 << 50;
+}
+
+// like a build: files are created all over a recursively watched tree
+void tst_QFileSystemWatcher::treeChangeStorm()
+{
+    QFETCH(int, count);
+    QFETCH(int, interval);
+
+    QStringList directories;
+    const QString root = createTree(count / 10, &directories);
+    QVERIFY(!root.isEmpty());
+
+    QFileSystemWatcher watcher;
+    watcher.setCoalescingInterval(interval);
+    QVERIFY(watcher.addPath(root, QFileSystemWatcher::WatchSubdirectories));
+
+    QSet<QString> changed;
+    int emissions = 0;
+    connect(&watcher, &QFileSystemWatcher::pathsChanged,
+            [&](const QStringList &, const QStringList &paths) {
+        ++emissions;
+        for (const QString &path : paths)
+            changed.insert(path);
+    });
+
+    int round = 0;
+    QBENCHMARK {
+        changed.clear();
+        emissions = 0;
+        for (int i = 0; i < count; ++i) {
+            QFile file(directories.at(i % directories.size()) + QLatin1String("/f")
+                       + QString::number(round) + QLatin1Char('-') + QString::number(i));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+        }
+        ++round;
+        QTRY_COMPARE(changed.size(), directories.size());
+    }
+    qDebug("%d changes reported in %d signal emissions", count, emissions);
+}
+
+QTEST_MAIN(tst_QFileSystemWatcher)
+
+#include "main.moc"
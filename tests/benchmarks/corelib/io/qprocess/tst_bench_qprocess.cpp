@@ -36,6 +36,16 @@ class tst_QProcess : public QObject
 private slots:
 
     void echoTest_performance();
+    void startLatency_data();
+    void startLatency();
+};
+
+// A reimplemented setupChildProcess() has to run in the child, so this
+// makes QProcess fork() instead of using posix_spawn().
+class ForkingProcess : public QProcess
+{
+protected:
+    void setupChildProcess() override {}
 };
 
 void tst_QProcess::echoTest_performance()
@@ -83,5 +93,39 @@ void tst_QProcess::echoTest_performance()
     QVERIFY(process.waitForFinished());
 }
 
+void tst_QProcess::startLatency_data()
+{
+    QTest::addColumn<bool>("fork");
+    QTest::addColumn<int>("parentMegabytes");
+
+    for (int megabytes : {0, 256, 1024}) {
+        QTest::newRow(qPrintable(QString::fromLatin1("default-%1MB").arg(megabytes)))
+                << false << megabytes;
+        QTest::newRow(qPrintable(QString::fromLatin1("fork-%1MB").arg(megabytes)))
+                << true << megabytes;
+    }
+}
+
+void tst_QProcess::startLatency()
+{
+    QFETCH(bool, fork);
+    QFETCH(int, parentMegabytes);
+
+    // Grow the parent's resident set: the cost of fork() grows with it
+    QByteArray ballast(parentMegabytes * 1024 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < ballast.size(); i += 4096)
+        ballast[i] = char(i);
+
+    QProcess defaultProcess;
+    ForkingProcess forkingProcess;
+    QProcess &process = fork ? forkingProcess : defaultProcess;
+    QBENCHMARK {
+        process.start("testProcessLoopback/testProcessLoopback");
+        QVERIFY2(process.waitForStarted(), qPrintable(process.errorString()));
+        process.closeWriteChannel();
+        QVERIFY(process.waitForFinished());
+    }
+}
+
 QTEST_MAIN(tst_QProcess)
 #include "tst_bench_qprocess.moc"
@@ -38,6 +38,8 @@ class tst_qtextstream : public QObject
 private slots:
     void writeSingleChar_data();
     void writeSingleChar();
+    void readLine_data();
+    void readLine();
 
 private:
 };
@@ -115,6 +117,74 @@ void tst_qtextstream::writeSingleChar()
     QCOMPARE(result.left(10), QString("hhhhhhhhhh"));
 }
 
+enum ReadLineMode { ReadLine, ReadLineInto };
+Q_DECLARE_METATYPE(ReadLineMode)
+
+void tst_qtextstream::readLine_data()
+{
+    QTest::addColumn<Input>("input");
+    QTest::addColumn<ReadLineMode>("mode");
+    QTest::addColumn<int>("lineLength");
+    QTest::addColumn<bool>("textMode");
+
+    const int lineLengths[] = { 10, 80, 1000 };
+    for (int lineLength : lineLengths) {
+        const QByteArray suffix = '_' + QByteArray::number(lineLength);
+        QTest::newRow(("string_readLine" + suffix).constData())
+                << QStringInput << ReadLine << lineLength << false;
+        QTest::newRow(("string_readLineInto" + suffix).constData())
+                << QStringInput << ReadLineInto << lineLength << false;
+        QTest::newRow(("device_readLine" + suffix).constData())
+                << CharStarInput << ReadLine << lineLength << false;
+        QTest::newRow(("device_readLineInto" + suffix).constData())
+                << CharStarInput << ReadLineInto << lineLength << false;
+        QTest::newRow(("textdevice_readLine" + suffix).constData())
+                << CharStarInput << ReadLine << lineLength << true;
+    }
+}
+
+void tst_qtextstream::readLine()
+{
+    QFETCH(Input, input);
+    QFETCH(ReadLineMode, mode);
+    QFETCH(int, lineLength);
+    QFETCH(bool, textMode);
+
+    const int totalSize = 4 * 1024 * 1024;
+    QByteArray line(lineLength, 'a');
+    line += '\n';
+    QByteArray data;
+    data.reserve(totalSize + line.size());
+    while (data.size() < totalSize)
+        data += line;
+    const int lineCount = data.size() / line.size();
+    const QString string = QString::fromLatin1(data);
+
+    QBENCHMARK {
+        QBuffer buffer(&data);
+        QTextStream stream;
+        if (input == QStringInput) {
+            stream.setString(const_cast<QString *>(&string), QIODevice::ReadOnly);
+        } else {
+            QVERIFY(buffer.open(textMode ? QIODevice::ReadOnly | QIODevice::Text
+                                         : QIODevice::ReadOnly));
+            stream.setDevice(&buffer);
+            stream.setCodec("UTF-8");
+        }
+
+        int count = 0;
+        if (mode == ReadLine) {
+            while (!stream.readLine().isNull())
+                ++count;
+        } else {
+            QString result;
+            while (stream.readLineInto(&result))
+                ++count;
+        }
+        QCOMPARE(count, lineCount);
+    }
+}
+
 QTEST_MAIN(tst_qtextstream)
 
 #include "main.moc"
@@ -29,6 +29,10 @@
 #include <QtTest>
 #include <qjsondocument.h>
 #include <qjsonobject.h>
+#include <qjsonarray.h>
+#include <qjsonbuilder.h>
+#include <qjsonstream.h>
+#include <qcborstream.h>
 
 class BenchmarkQtBinaryJson: public QObject
 {
@@ -45,12 +49,26 @@ private Q_SLOTS:
     void parseNumbers();
     void parseJson();
     void parseJsonToVariant();
+    void parseCorpus_data();
+    void parseCorpus();
+    void parseCorpusCbor_data() { parseCorpus_data(); }
+    void parseCorpusCbor();
+    void writeTelemetryJson();
+    void writeTelemetryCbor();
+    void readTelemetryJson();
+    void readTelemetryCbor();
 
     void toByteArray();
     void fromByteArray();
 
     void jsonObjectInsert();
     void variantMapInsert();
+    void buildObjectByInsert_data();
+    void buildObjectByInsert();
+    void buildObjectWithBuilder_data() { buildObjectByInsert_data(); }
+    void buildObjectWithBuilder();
+    void buildArrayByAppend();
+    void buildArrayWithBuilder();
 };
 
 BenchmarkQtBinaryJson::BenchmarkQtBinaryJson(QObject *parent) : QObject(parent)
@@ -120,6 +138,143 @@ void BenchmarkQtBinaryJson::parseJsonToVariant()
     }
 }
 
+void BenchmarkQtBinaryJson::parseCorpus_data()
+{
+    QTest::addColumn<QByteArray>("json");
+
+    QString testFile = QFINDTESTDATA("test.json");
+    QVERIFY2(!testFile.isEmpty(), "cannot find test file test.json!");
+    QFile file(testFile);
+    file.open(QFile::ReadOnly);
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+
+    // the same real-world data, repeated to a few megabytes, in both formats
+    QJsonArray array;
+    for (int i = 0; i < 64; ++i)
+        array.append(doc.array());
+    QTest::newRow("indented") << QJsonDocument(array).toJson(QJsonDocument::Indented);
+    QTest::newRow("compact") << QJsonDocument(array).toJson(QJsonDocument::Compact);
+
+    // long string values with the occasional escape, like logs or documents
+    QJsonArray texts;
+    for (int i = 0; i < 10000; ++i) {
+        QString text = QString::number(i) + QStringLiteral(": The quick brown fox jumps over the lazy dog.");
+        text = text.repeated(i % 10 + 1) + QStringLiteral("\t\"quoted\"\n");
+        texts.append(text);
+    }
+    QTest::newRow("strings") << QJsonDocument(texts).toJson(QJsonDocument::Compact);
+}
+
+void BenchmarkQtBinaryJson::parseCorpus()
+{
+    QFETCH(QByteArray, json);
+
+    QBENCHMARK {
+        QJsonDocument doc = QJsonDocument::fromJson(json);
+        QVERIFY(!doc.isNull());
+    }
+}
+
+void BenchmarkQtBinaryJson::parseCorpusCbor()
+{
+    QFETCH(QByteArray, json);
+
+    QByteArray cbor;
+    QCborStreamWriter writer(&cbor);
+    writer.appendJsonValue(QJsonDocument::fromJson(json).array());
+
+    QBENCHMARK {
+        QCborStreamReader reader(cbor);
+        reader.readNext();
+        QJsonValue value = reader.readJsonValue();
+        QVERIFY(value.isArray());
+    }
+}
+
+// a stream of small records, as exchanged between processes
+static const int telemetryCount = 10000;
+
+static QByteArray telemetryJson()
+{
+    QByteArray json;
+    QJsonStreamWriter writer(&json);
+    writer.setFormat(QJsonDocument::Compact);
+    for (int i = 0; i < telemetryCount; ++i) {
+        writer.writeStartObject();
+        writer.writeMember(QStringLiteral("t"), 1511000000000.0 + i);
+        writer.writeMember(QStringLiteral("id"), i % 64);
+        writer.writeMember(QStringLiteral("v"), i * 0.1);
+        writer.writeMember(QStringLiteral("ok"), true);
+        writer.writeEndObject();
+    }
+    return json;
+}
+
+static QByteArray telemetryCbor()
+{
+    QByteArray cbor;
+    QCborStreamWriter writer(&cbor);
+    for (int i = 0; i < telemetryCount; ++i) {
+        writer.startMap(4);
+        writer.append(QLatin1String("t"));
+        writer.append(Q_INT64_C(1511000000000) + i);
+        writer.append(QLatin1String("id"));
+        writer.append(i % 64);
+        writer.append(QLatin1String("v"));
+        writer.append(i * 0.1);
+        writer.append(QLatin1String("ok"));
+        writer.append(true);
+        writer.endMap();
+    }
+    return cbor;
+}
+
+void BenchmarkQtBinaryJson::writeTelemetryJson()
+{
+    QBENCHMARK {
+        QByteArray json = telemetryJson();
+    }
+}
+
+void BenchmarkQtBinaryJson::writeTelemetryCbor()
+{
+    QBENCHMARK {
+        QByteArray cbor = telemetryCbor();
+    }
+}
+
+void BenchmarkQtBinaryJson::readTelemetryJson()
+{
+    const QByteArray json = telemetryJson();
+
+    QBENCHMARK {
+        QJsonStreamReader reader(json);
+        double sum = 0;
+        while (reader.readNext() != QJsonStreamReader::NoToken) {
+            if (reader.isValue())
+                sum += reader.value().toDouble();
+        }
+        QVERIFY(!reader.hasError());
+        QVERIFY(sum > 0);
+    }
+}
+
+void BenchmarkQtBinaryJson::readTelemetryCbor()
+{
+    const QByteArray cbor = telemetryCbor();
+
+    QBENCHMARK {
+        QCborStreamReader reader(cbor);
+        double sum = 0;
+        while (reader.readNext() != QCborStreamReader::NoToken) {
+            if (reader.isInteger() || reader.isFloat())
+                sum += reader.toDouble();
+        }
+        QVERIFY(!reader.hasError());
+        QVERIFY(sum > 0);
+    }
+}
+
 void BenchmarkQtBinaryJson::toByteArray()
 {
     // Example: send information over a datastream to another process
@@ -174,6 +329,71 @@ void BenchmarkQtBinaryJson::variantMapInsert()
     }
 }
 
+void BenchmarkQtBinaryJson::buildObjectByInsert_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("100000") << 100000;
+}
+
+void BenchmarkQtBinaryJson::buildObjectByInsert()
+{
+    QFETCH(int, size);
+    QStringList keys;
+    for (int i = 0; i < size; ++i)
+        keys << "testkey_" + QString::number(i * 7919 % size);
+    QJsonValue value(1.5);
+
+    QBENCHMARK {
+        QJsonObject object;
+        for (const QString &key : qAsConst(keys))
+            object.insert(key, value);
+    }
+}
+
+void BenchmarkQtBinaryJson::buildObjectWithBuilder()
+{
+    QFETCH(int, size);
+    QStringList keys;
+    for (int i = 0; i < size; ++i)
+        keys << "testkey_" + QString::number(i * 7919 % size);
+    QJsonValue value(1.5);
+
+    QBENCHMARK {
+        QJsonObjectBuilder builder;
+        builder.reserve(size);
+        for (const QString &key : qAsConst(keys))
+            builder.insert(key, value);
+        QJsonObject object = builder.toObject();
+    }
+}
+
+void BenchmarkQtBinaryJson::buildArrayByAppend()
+{
+    QJsonValue value(QStringLiteral("testString"));
+
+    QBENCHMARK {
+        QJsonArray array;
+        for (int i = 0; i < 10000; ++i)
+            array.append(value);
+    }
+}
+
+void BenchmarkQtBinaryJson::buildArrayWithBuilder()
+{
+    QJsonValue value(QStringLiteral("testString"));
+
+    QBENCHMARK {
+        QJsonArrayBuilder builder;
+        builder.reserve(10000);
+        for (int i = 0; i < 10000; ++i)
+            builder.append(value);
+        QJsonArray array = builder.toArray();
+    }
+}
+
 QTEST_MAIN(BenchmarkQtBinaryJson)
 #include "tst_bench_qtbinaryjson.moc"
 
@@ -5,8 +5,12 @@ SUBDIRS = \
         qmetatype \
         qobject \
         qvariant \
-        qcoreapplication
+        qcoreapplication \
+        qsharedmemorychannel
 
 !qtHaveModule(widgets): SUBDIRS -= \
     qmetaobject \
     qobject
+
+!qtHaveModule(network): SUBDIRS -= \
+    qsharedmemorychannel
@@ -0,0 +1,243 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSharedMemoryChannel>
+#include <QThread>
+
+#include <functional>
+
+class tst_QSharedMemoryChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void throughput_data();
+    void throughput();
+    void latency_data();
+    void latency();
+};
+
+class FunctionThread : public QThread
+{
+public:
+    explicit FunctionThread(const std::function<void()> &function)
+        : function(function) {}
+
+protected:
+    void run() override { function(); }
+
+private:
+    std::function<void()> function;
+};
+
+static const qint64 totalBytes = 64 * 1024 * 1024;
+static const int roundTrips = 1000;
+
+static QString uniqueName(const char *name)
+{
+    return QLatin1String("tst_bench_qsharedmemorychannel_") + QLatin1String(name)
+            + QLatin1Char('_') + QString::number(QCoreApplication::applicationPid());
+}
+
+void tst_QSharedMemoryChannel::throughput_data()
+{
+    QTest::addColumn<bool>("localSocket");
+    QTest::addColumn<int>("messageSize");
+
+    for (int size : { 64, 4096, 65536, 1024 * 1024 }) {
+        QTest::newRow(qPrintable(QString::fromLatin1("channel-%1").arg(size))) << false << size;
+        QTest::newRow(qPrintable(QString::fromLatin1("localsocket-%1").arg(size))) << true << size;
+    }
+}
+
+// Moves totalBytes from a producer thread to the main thread in messages of
+// messageSize bytes, each of which is copied in and read on the other side.
+void tst_QSharedMemoryChannel::throughput()
+{
+    QFETCH(bool, localSocket);
+    QFETCH(int, messageSize);
+    const int count = int(totalBytes / messageSize);
+    const QByteArray payload(messageSize, 'x');
+
+    if (localSocket) {
+        const QString name = uniqueName("throughput");
+        QLocalServer::removeServer(name);
+        QLocalServer server;
+        QVERIFY(server.listen(name));
+
+        QBENCHMARK {
+            FunctionThread producer([&name, &payload, count]() {
+                QLocalSocket socket;
+                socket.connectToServer(name);
+                if (!socket.waitForConnected())
+                    return;
+                for (int i = 0; i < count; ++i) {
+                    socket.write(payload);
+                    if (socket.bytesToWrite() > 1024 * 1024)
+                        socket.waitForBytesWritten();
+                }
+                while (socket.bytesToWrite())
+                    socket.waitForBytesWritten();
+                socket.disconnectFromServer();
+            });
+            producer.start();
+            QVERIFY(server.waitForNewConnection(10000));
+            QLocalSocket *socket = server.nextPendingConnection();
+            QByteArray buffer(messageSize, Qt::Uninitialized);
+            const qint64 expected = qint64(count) * messageSize;
+            qint64 received = 0;
+            while (received < expected) {
+                if (!socket->bytesAvailable() && !socket->waitForReadyRead(10000))
+                    break;
+                received += socket->read(buffer.data(), buffer.size());
+            }
+            QCOMPARE(received, expected);
+            QVERIFY(producer.wait());
+            delete socket;
+        }
+    } else {
+        const QString key = uniqueName("throughput");
+        QSharedMemoryChannel consumer(key);
+        QVERIFY2(consumer.create(qMax(8 * 1024 * 1024, 4 * messageSize)),
+                 qPrintable(consumer.errorString()));
+        QByteArray buffer(messageSize, Qt::Uninitialized);
+
+        QBENCHMARK {
+            FunctionThread producer([&key, &payload, count]() {
+                QSharedMemoryChannel channel(key);
+                if (!channel.attach())
+                    return;
+                for (int i = 0; i < count; ++i) {
+                    char *data;
+                    while (!(data = channel.reserveMessage(payload.size())))
+                        channel.waitForFreeSpace(payload.size());
+                    memcpy(data, payload.constData(), payload.size());
+                    channel.commitMessage();
+                }
+            });
+            producer.start();
+            for (int i = 0; i < count; ++i) {
+                int size;
+                const char *data;
+                while (!(data = consumer.claimMessage(&size)))
+                    consumer.waitForReadyRead();
+                memcpy(buffer.data(), data, size);
+                consumer.releaseMessage();
+            }
+            QVERIFY(producer.wait());
+        }
+    }
+}
+
+void tst_QSharedMemoryChannel::latency_data()
+{
+    QTest::addColumn<bool>("localSocket");
+
+    QTest::newRow("channel") << false;
+    QTest::newRow("localsocket") << true;
+}
+
+// Round trips of a small message between the main thread and an echo thread.
+void tst_QSharedMemoryChannel::latency()
+{
+    QFETCH(bool, localSocket);
+    const QByteArray ping(64, 'p');
+
+    if (localSocket) {
+        const QString name = uniqueName("latency");
+        QLocalServer::removeServer(name);
+        QLocalServer server;
+        QVERIFY(server.listen(name));
+        FunctionThread echo([&name]() {
+            QLocalSocket socket;
+            socket.connectToServer(name);
+            if (!socket.waitForConnected())
+                return;
+            while (socket.waitForReadyRead(-1)) {
+                socket.write(socket.readAll());
+                socket.flush();
+            }
+        });
+        echo.start();
+        QVERIFY(server.waitForNewConnection(10000));
+        QLocalSocket *socket = server.nextPendingConnection();
+
+        QBENCHMARK {
+            for (int i = 0; i < roundTrips; ++i) {
+                socket->write(ping);
+                socket->flush();
+                qint64 received = 0;
+                while (received < ping.size()) {
+                    if (!socket->bytesAvailable())
+                        socket->waitForReadyRead();
+                    received += socket->read(ping.size() - received).size();
+                }
+            }
+        }
+        delete socket;
+        QVERIFY(echo.wait());
+    } else {
+        const QString requestKey = uniqueName("request");
+        const QString replyKey = uniqueName("reply");
+        QSharedMemoryChannel requests(requestKey);
+        QVERIFY(requests.create(64 * 1024));
+        QSharedMemoryChannel replies(replyKey);
+        QVERIFY(replies.create(64 * 1024));
+        FunctionThread echo([&requestKey, &replyKey]() {
+            QSharedMemoryChannel requests(requestKey);
+            QSharedMemoryChannel replies(replyKey);
+            if (!requests.attach() || !replies.attach())
+                return;
+            forever {
+                requests.waitForReadyRead(-1);
+                const QByteArray message = requests.readMessage();
+                if (message.isEmpty())
+                    break;
+                replies.writeMessage(message);
+            }
+        });
+        echo.start();
+
+        QBENCHMARK {
+            for (int i = 0; i < roundTrips; ++i) {
+                requests.writeMessage(ping);
+                replies.waitForReadyRead(-1);
+                replies.readMessage();
+            }
+        }
+        requests.writeMessage(QByteArray(""));
+        QVERIFY(echo.wait());
+    }
+}
+
+QTEST_MAIN(tst_QSharedMemoryChannel)
+
+#include "main.moc"
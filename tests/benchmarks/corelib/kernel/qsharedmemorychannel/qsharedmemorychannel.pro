@@ -0,0 +1,6 @@
+QT = core network testlib
+
+TEMPLATE = app
+TARGET = tst_bench_qsharedmemorychannel
+
+SOURCES += main.cpp
@@ -35,6 +35,12 @@ class tst_QMimeDatabase: public QObject
 
 private slots:
     void inheritsPerformance();
+    void mimeTypeForFileName();
+    void mimeTypeForData();
+    void mimeTypesForData();
+
+private:
+    static QList<QByteArray> dataCorpus();
 };
 
 void tst_QMimeDatabase::inheritsPerformance()
@@ -70,5 +76,65 @@ void tst_QMimeDatabase::inheritsPerformance()
     // parsing XML, and then keeps being around 4.5 MB for all the in-memory hashes.
 }
 
+void tst_QMimeDatabase::mimeTypeForFileName()
+{
+    const QStringList fileNames = QStringList()
+            << QStringLiteral("report.pdf") << QStringLiteral("photo.JPG") << QStringLiteral("archive.tar.bz2")
+            << QStringLiteral("Makefile") << QStringLiteral("main.cpp") << QStringLiteral("notes.txt~")
+            << QStringLiteral("README.md") << QStringLiteral("unknown.zzz");
+    QMimeDatabase db;
+    QVERIFY(db.mimeTypeForFile(fileNames.first(), QMimeDatabase::MatchExtension).isValid());
+    QBENCHMARK {
+        for (const QString &fileName : fileNames)
+            db.mimeTypeForFile(fileName, QMimeDatabase::MatchExtension);
+    }
+}
+
+// A mix of the headers of common file formats and of data no magic rule matches
+QList<QByteArray> tst_QMimeDatabase::dataCorpus()
+{
+    const QByteArray samples[] = {
+        QByteArray("%PDF-1.4\n%\xe2\xe3\xcf\xd3\n"),
+        QByteArray("\x89PNG\r\n\x1a\n\0\0\0\rIHDR", 16),
+        QByteArray("\xff\xd8\xff\xe0\0\x10JFIF\0", 11),
+        QByteArray("GIF89a\x01\0\x01\0", 10),
+        QByteArray("PK\x03\x04\x14\0\x06\0", 8),
+        QByteArray("<?xml version=\"1.0\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\"/>"),
+        QByteArray("<!DOCTYPE html>\n<html><head></head></html>"),
+        QByteArray("#!/bin/sh\necho hello\n"),
+        QByteArray("Just some plain text that does not match any magic rule.\n"),
+        QByteArray("\x01\x02\x03\x04\x05\x06\x07\x08 binary garbage")
+    };
+    QList<QByteArray> corpus;
+    for (int i = 0; i < 1000; ++i) {
+        // pad to a typical peek() size, so that range searches see realistic data
+        QByteArray data = samples[i % (sizeof(samples) / sizeof(samples[0]))];
+        data.append(QByteArray(1024, 'x'));
+        corpus.append(data);
+    }
+    return corpus;
+}
+
+void tst_QMimeDatabase::mimeTypeForData()
+{
+    const QList<QByteArray> corpus = dataCorpus();
+    QMimeDatabase db;
+    QCOMPARE(db.mimeTypeForData(corpus.first()).name(), QStringLiteral("application/pdf"));
+    QBENCHMARK {
+        for (const QByteArray &data : corpus)
+            db.mimeTypeForData(data);
+    }
+}
+
+void tst_QMimeDatabase::mimeTypesForData()
+{
+    const QList<QByteArray> corpus = dataCorpus();
+    QMimeDatabase db;
+    QCOMPARE(db.mimeTypesForData(corpus).first().name(), QStringLiteral("application/pdf"));
+    QBENCHMARK {
+        db.mimeTypesForData(corpus);
+    }
+}
+
 QTEST_MAIN(tst_QMimeDatabase)
 #include "main.moc"
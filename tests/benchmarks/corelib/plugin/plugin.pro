@@ -1,2 +1,4 @@
 TEMPLATE = subdirs
-SUBDIRS = quuid
+SUBDIRS = \
+    qfactoryloader \
+    quuid
@@ -0,0 +1,115 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/qstandardpaths.h>
+#include <QtCore/qtemporarydir.h>
+#include <private/qfactoryloader_p.h>
+#include "plugin/benchinterface.h"
+
+class tst_QFactoryLoader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void update_data();
+    void update();
+
+private:
+    QTemporaryDir pluginDir;
+    QStringList libraryPaths;
+};
+
+static const int pluginCount = 100;
+
+void tst_QFactoryLoader::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(pluginDir.isValid());
+    QVERIFY(QDir(pluginDir.path()).mkdir(QLatin1String("plugins")));
+
+    // an application directory with many plugins, along with the odd file
+    // that is not a plugin
+    const QFileInfoList binaries = QDir(QFINDTESTDATA("bin")).entryInfoList(QDir::Files);
+    QVERIFY(!binaries.isEmpty());
+    const QFileInfo plugin = binaries.first();
+    for (int i = 0; i < pluginCount; ++i) {
+        const QString target = pluginDir.path() + QLatin1String("/plugins/")
+                + plugin.completeBaseName() + QString::number(i) + QLatin1Char('.') + plugin.suffix();
+        QVERIFY(QFile::copy(plugin.filePath(), target));
+    }
+    QFile readme(pluginDir.path() + QLatin1String("/plugins/README"));
+    QVERIFY(readme.open(QIODevice::WriteOnly));
+    readme.write("not a plugin");
+    readme.close();
+
+    libraryPaths = QCoreApplication::libraryPaths();
+    QCoreApplication::setLibraryPaths(QStringList(pluginDir.path()));
+}
+
+void tst_QFactoryLoader::cleanupTestCase()
+{
+    QCoreApplication::setLibraryPaths(libraryPaths);
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+         + QLatin1String("/qtplugincache")).removeRecursively();
+    qunsetenv("QT_PLUGIN_CACHE");
+    QStandardPaths::setTestModeEnabled(false);
+}
+
+void tst_QFactoryLoader::update_data()
+{
+    QTest::addColumn<bool>("useCache");
+
+    QTest::newRow("uncached") << false;
+    QTest::newRow("cached") << true;
+}
+
+// Scanning the plugin directory, which is what the first use of a plugin
+// type costs at application start-up.
+void tst_QFactoryLoader::update()
+{
+    QFETCH(bool, useCache);
+
+    if (useCache) {
+        qputenv("QT_PLUGIN_CACHE", "1");
+        QFactoryLoader warmUp(BenchInterface_iid, QLatin1String("/plugins"));
+    } else {
+        qunsetenv("QT_PLUGIN_CACHE");
+    }
+
+    QBENCHMARK {
+        QFactoryLoader loader(BenchInterface_iid, QLatin1String("/plugins"));
+        QCOMPARE(loader.metaData().size(), pluginCount);
+    }
+}
+
+QTEST_MAIN(tst_QFactoryLoader)
+
+#include "main.moc"
@@ -0,0 +1,7 @@
+TEMPLATE = lib
+QT = core
+CONFIG += plugin
+HEADERS = benchplugin.h
+SOURCES = benchplugin.cpp
+TARGET = $$qtLibraryTarget(benchplugin)
+DESTDIR = ../bin
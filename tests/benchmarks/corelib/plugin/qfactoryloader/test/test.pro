@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = ../tst_bench_qfactoryloader
+QT = core-private testlib
+
+SOURCES = ../main.cpp
+HEADERS = ../plugin/benchinterface.h
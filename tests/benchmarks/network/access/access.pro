@@ -1,6 +1,8 @@
 TEMPLATE = subdirs
 SUBDIRS = \
         qfile_vs_qnetworkaccessmanager \
+        http2 \
+        hpack \
         qnetworkreply \
         qnetworkreply_from_cache \
         qnetworkdiskcache
@@ -0,0 +1,187 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+// This file contains benchmarks for QNetworkReply functions.
+
+// This file contains benchmarks for the HPACK codec of HTTP/2.
+
+#include <QtTest/QtTest>
+
+#include <QtNetwork/private/bitstreams_p.h>
+#include <QtNetwork/private/hpack_p.h>
+#include <QtNetwork/private/huffman_p.h>
+
+#include <vector>
+
+QT_USE_NAMESPACE
+
+using namespace HPack;
+
+class tst_hpack : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void huffmanEncode();
+    void huffmanDecode();
+    void encodeRequests_data();
+    void encodeRequests();
+    void decodeRequests_data();
+    void decodeRequests();
+    void tableLookup();
+};
+
+namespace {
+
+const QByteArray sampleText("application/grpc+proto; charset=utf-8, "
+                            "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+                            "(KHTML, like Gecko) Chrome/61.0.3163.100 Safari/537.36");
+
+// A gRPC-style call: mostly the same fields for every request,
+// a few of them different each time.
+HttpHeader requestHeader(int n)
+{
+    return {{":method", "POST"},
+            {":scheme", "https"},
+            {":authority", "api.example.com:443"},
+            {":path", "/example.v1.Service/Method" + QByteArray::number(n % 8)},
+            {"content-type", "application/grpc"},
+            {"te", "trailers"},
+            {"grpc-accept-encoding", "identity,deflate,gzip"},
+            {"grpc-timeout", QByteArray::number(n % 1000) + "m"},
+            {"user-agent", "grpc-c++/1.6.0 (linux; chttp2)"},
+            {"x-request-id", QByteArray::number(n * 7919)}};
+}
+
+const int requestCount = 1000;
+
+
+}
+
+void tst_hpack::huffmanEncode()
+{
+    std::vector<uchar> buffer;
+    QBENCHMARK {
+        buffer.clear();
+        BitOStream out(buffer);
+        for (int i = 0; i < 100; ++i)
+            huffman_encode_string(sampleText, out);
+    }
+}
+
+void tst_hpack::huffmanDecode()
+{
+    std::vector<uchar> buffer;
+    BitOStream out(buffer);
+    huffman_encode_string(sampleText, out);
+
+    QByteArray decoded;
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            decoded.clear();
+            BitIStream in(&buffer[0], &buffer[0] + buffer.size());
+            huffman_decode_string(in, &decoded);
+        }
+    }
+    QCOMPARE(decoded, sampleText);
+}
+
+void tst_hpack::encodeRequests_data()
+{
+    QTest::addColumn<bool>("compressStrings");
+    QTest::newRow("plain") << false;
+    QTest::newRow("huffman") << true;
+}
+
+void tst_hpack::encodeRequests()
+{
+    QFETCH(bool, compressStrings);
+
+    std::vector<HttpHeader> headers;
+    for (int i = 0; i < requestCount; ++i)
+        headers.push_back(requestHeader(i));
+
+    std::vector<uchar> buffer;
+    QBENCHMARK {
+        buffer.clear();
+        BitOStream out(buffer);
+        Encoder encoder(FieldLookupTable::DefaultSize, compressStrings);
+        for (const HttpHeader &header : headers)
+            encoder.encodeRequest(out, header);
+    }
+}
+
+void tst_hpack::decodeRequests_data()
+{
+    encodeRequests_data();
+}
+
+void tst_hpack::decodeRequests()
+{
+    QFETCH(bool, compressStrings);
+
+    // Each request in its own block, as in HEADERS frames
+    std::vector<std::vector<uchar> > blocks;
+    {
+        Encoder encoder(FieldLookupTable::DefaultSize, compressStrings);
+        for (int i = 0; i < requestCount; ++i) {
+            blocks.emplace_back();
+            BitOStream out(blocks.back());
+            encoder.encodeRequest(out, requestHeader(i));
+        }
+    }
+
+    QBENCHMARK {
+        Decoder decoder(FieldLookupTable::DefaultSize);
+        for (const auto &block : blocks) {
+            BitIStream in(&block[0], &block[0] + block.size());
+            if (!decoder.decodeHeaderFields(in))
+                QFAIL("failed to decode a header block");
+        }
+    }
+}
+
+void tst_hpack::tableLookup()
+{
+    FieldLookupTable table(FieldLookupTable::DefaultSize, true);
+    for (int i = 0; i < 50; ++i)
+        table.prependField("x-field-" + QByteArray::number(i), QByteArray::number(i));
+
+    const HttpHeader header = requestHeader(0);
+    quint32 found = 0;
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            for (const HeaderField &field : header)
+                found += table.indexOf(field.name, field.value) + table.indexOf(field.name);
+        }
+    }
+    QVERIFY(found);
+}
+
+QTEST_MAIN(tst_hpack)
+
+#include "tst_hpack.moc"
@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = tst_bench_http2
+
+QT = core core-private network network-private testlib
+
+CONFIG += release c++11
+
+# The test server of the HTTP/2 autotest
+HTTP2_SERVER_DIR = $$PWD/../../../../auto/network/access/http2
+INCLUDEPATH += $$HTTP2_SERVER_DIR
+HEADERS += $$HTTP2_SERVER_DIR/http2srv.h
+SOURCES += tst_http2.cpp $$HTTP2_SERVER_DIR/http2srv.cpp
+
+DEFINES += SRCDIR=\\\"$$HTTP2_SERVER_DIR/\\\"
@@ -0,0 +1,113 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+// This file contains benchmarks for QNetworkReply functions.
+// This file contains benchmarks for HTTP/2 downloads over cleartext (h2c).
+
+#include <QtTest/QtTest>
+#include <QtNetwork/qnetworkaccessmanager.h>
+#include <QtNetwork/qnetworkrequest.h>
+#include <QtNetwork/qnetworkreply.h>
+
+#include "http2srv.h"
+
+class tst_http2 : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void download_data();
+    void download();
+};
+
+void tst_http2::download_data()
+{
+    QTest::addColumn<int>("latency");
+    QTest::addColumn<bool>("autoTuning");
+    QTest::addColumn<int>("streamWindowSize");
+
+    const int defaultWindow = Http2::defaultSessionWindowSize;
+    QTest::newRow("no-latency-fixed-window") << 0 << false << defaultWindow;
+    QTest::newRow("no-latency-auto-tuning") << 0 << true << defaultWindow;
+    QTest::newRow("20ms-fixed-window") << 20 << false << defaultWindow;
+    QTest::newRow("20ms-auto-tuning") << 20 << true << defaultWindow;
+    QTest::newRow("20ms-fixed-1MB-window") << 20 << false << 1024 * 1024;
+}
+
+void tst_http2::download()
+{
+    // The server waits 'latency' ms before it acts on WINDOW_UPDATE and PING
+    // frames, so the throughput depends on how much the receive windows
+    // allow to have in flight.
+    using namespace Http2;
+
+    QFETCH(int, latency);
+    QFETCH(bool, autoTuning);
+    QFETCH(int, streamWindowSize);
+
+    qputenv("QT_HTTP2_DISABLE_WINDOW_AUTOTUNING", autoTuning ? "0" : "1");
+
+    Http2Settings clientSettings{{Settings::MAX_FRAME_SIZE_ID, quint32(maxFrameSize)},
+                                 {Settings::ENABLE_PUSH_ID, quint32(0)}};
+    if (streamWindowSize != defaultSessionWindowSize)
+        clientSettings.push_back({Settings::INITIAL_WINDOW_SIZE_ID, quint32(streamWindowSize)});
+
+    Http2Server server(true, {{Settings::MAX_CONCURRENT_STREAMS_ID, 100}}, clientSettings);
+    server.setResponseBody(QByteArray(8 * 1024 * 1024, 'x'));
+    server.emulateLatency(latency);
+    connect(&server, &Http2Server::receivedRequest, [&server](quint32 streamID) {
+        QMetaObject::invokeMethod(&server, "sendResponse", Qt::QueuedConnection,
+                                  Q_ARG(quint32, streamID), Q_ARG(bool, false));
+    });
+    server.startServer();
+    QVERIFY(server.isListening());
+
+    QNetworkAccessManager manager;
+    manager.setHttp2StreamReceiveWindowSize(streamWindowSize);
+    manager.setHttp2SessionReceiveWindowSize(qMax(streamWindowSize * 10,
+                                                  int(qtDefaultSessionReceiveWindowSize)));
+
+    QNetworkRequest request(QUrl(QStringLiteral("http://127.0.0.1:%1/index.html")
+                                 .arg(server.serverPort())));
+    request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+
+    // The server accepts one connection, all iterations reuse it.
+    QBENCHMARK {
+        QScopedPointer<QNetworkReply> reply(manager.get(request));
+        connect(reply.data(), SIGNAL(finished()), &QTestEventLoop::instance(), SLOT(exitLoop()));
+        QTestEventLoop::instance().enterLoop(60);
+        QVERIFY(!QTestEventLoop::instance().timeout());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->readAll().size(), 8 * 1024 * 1024);
+    }
+
+    qunsetenv("QT_HTTP2_DISABLE_WINDOW_AUTOTUNING");
+}
+
+QTEST_MAIN(tst_http2)
+
+#include "tst_http2.moc"
@@ -433,6 +433,16 @@ class HttpDownloadPerformanceClient : QObject {
 
 };
 
+// Throws away what is written to it, like HttpDownloadPerformanceClient
+// does with what it reads
+class DiscardingDevice : public QIODevice {
+public:
+    DiscardingDevice() { open(QIODevice::WriteOnly); }
+protected:
+    qint64 readData(char *, qint64) Q_DECL_OVERRIDE { return -1; }
+    qint64 writeData(const char *, qint64 len) Q_DECL_OVERRIDE { return len; }
+};
+
 
 
 
@@ -724,10 +734,14 @@ void tst_qnetworkreply::httpDownloadPerformance_data()
 {
     QTest::addColumn<bool>("serverSendsContentLength");
     QTest::addColumn<bool>("chunkedEncoding");
+    QTest::addColumn<bool>("useDownloadDevice");
 
-    QTest::newRow("Server sends no Content-Length") << false << false;
-    QTest::newRow("Server sends Content-Length")     << true << false;
-    QTest::newRow("Server uses chunked encoding")     << false << true;
+    QTest::newRow("Server sends no Content-Length") << false << false << false;
+    QTest::newRow("Server sends Content-Length")     << true << false << false;
+    QTest::newRow("Server uses chunked encoding")     << false << true << false;
+    QTest::newRow("Server sends no Content-Length, download device") << false << false << true;
+    QTest::newRow("Server sends Content-Length, download device")     << true << false << true;
+    QTest::newRow("Server uses chunked encoding, download device")     << false << true << true;
 
 }
 
@@ -735,6 +749,7 @@ void tst_qnetworkreply::httpDownloadPerformance()
 {
     QFETCH(bool, serverSendsContentLength);
     QFETCH(bool, chunkedEncoding);
+    QFETCH(bool, useDownloadDevice);
 
     enum {UploadSize = 128*1024*1024}; // 128 MB
 
@@ -742,6 +757,9 @@ void tst_qnetworkreply::httpDownloadPerformance()
 
     QNetworkRequest request(QUrl("http://127.0.0.1:" + QString::number(server.serverPort()) + "/?bare=1"));
     QNetworkReplyPtr reply(manager.get(request));
+    DiscardingDevice downloadDevice;
+    if (useDownloadDevice)
+        reply->setDownloadDevice(&downloadDevice);
 
     connect(reply, SIGNAL(finished()), &QTestEventLoop::instance(), SLOT(exitLoop()), Qt::QueuedConnection);
     HttpDownloadPerformanceClient client(reply.data());
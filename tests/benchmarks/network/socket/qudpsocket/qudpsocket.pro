@@ -0,0 +1,8 @@
+TEMPLATE = app
+TARGET = tst_bench_qudpsocket
+
+QT = core network testlib
+
+CONFIG += release
+
+SOURCES += tst_qudpsocket.cpp
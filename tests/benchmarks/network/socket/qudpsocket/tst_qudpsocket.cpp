@@ -0,0 +1,113 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <qnetworkdatagram.h>
+#include <qudpsocket.h>
+#include <qvector.h>
+
+class tst_QUdpSocket : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void loopback_data();
+    void loopback();
+
+private:
+    QUdpSocket server;
+    QUdpSocket client;
+};
+
+enum { BurstSize = 64, Bursts = 2000 };
+
+void tst_QUdpSocket::initTestCase()
+{
+    QVERIFY2(server.bind(QHostAddress(QHostAddress::LocalHost), 0),
+             server.errorString().toLatin1().constData());
+    // room for a whole burst of the largest datagrams, so that none is dropped
+    server.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4 * 1024 * 1024);
+    QVERIFY2(client.bind(QHostAddress(QHostAddress::LocalHost), 0),
+             client.errorString().toLatin1().constData());
+}
+
+void tst_QUdpSocket::loopback_data()
+{
+    QTest::addColumn<bool>("batched");
+    QTest::addColumn<int>("size");
+
+    for (int size : {64, 512, 1400}) {
+        QTest::addRow("single-%d", size) << false << size;
+        QTest::addRow("batched-%d", size) << true << size;
+    }
+}
+
+// Sends bursts of datagrams over the loopback interface and reads them back,
+// either one at a time with writeDatagram()/receiveDatagram() or with
+// writeDatagrams()/receiveDatagrams(). The result is in datagrams per second
+// (reported as "frames").
+void tst_QUdpSocket::loopback()
+{
+    QFETCH(bool, batched);
+    QFETCH(int, size);
+
+    QVector<QNetworkDatagram> burst;
+    for (int i = 0; i < BurstSize; ++i)
+        burst << QNetworkDatagram(QByteArray(size, char('a' + i % 26)), server.localAddress(),
+                                  server.localPort());
+
+    qint64 received = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < Bursts; ++i) {
+        if (batched) {
+            QCOMPARE(client.writeDatagrams(burst), int(BurstSize));
+            for (int n = 0; n < BurstSize; ) {
+                const int count = server.receiveDatagrams(BurstSize, 2048).size();
+                QVERIFY(count > 0);
+                n += count;
+                received += count;
+            }
+        } else {
+            for (const QNetworkDatagram &datagram : qAsConst(burst))
+                QCOMPARE(client.writeDatagram(datagram), qint64(size));
+            for (int n = 0; n < BurstSize; ++n) {
+                QVERIFY(server.receiveDatagram().isValid());
+                ++received;
+            }
+        }
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+
+    QCOMPARE(received, qint64(BurstSize) * Bursts);
+    QTest::setBenchmarkResult(received * 1e9 / elapsed, QTest::FramesPerSecond);
+}
+
+QTEST_MAIN(tst_QUdpSocket)
+#include "tst_qudpsocket.moc"